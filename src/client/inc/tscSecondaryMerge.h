@@ -36,13 +36,15 @@ extern "C" {
  */
 
 struct SQLFunctionCtx;
+struct SLocalMergeWorker;
 
 typedef struct SLocalDataSource {
-  tExtMemBuffer *pMemBuffer;
-  int32_t        flushoutIdx;
-  int32_t        pageId;
-  int32_t        rowIdx;
-  tFilePage      filePage;
+  tExtMemBuffer *           pMemBuffer;
+  int32_t                   flushoutIdx;
+  int32_t                   pageId;
+  int32_t                   rowIdx;
+  struct SLocalMergeWorker *pWorker;  // pages are produced by merge worker instead of being loaded from buffer
+  tFilePage                 filePage;
 } SLocalDataSource;
 
 enum {
@@ -61,6 +63,9 @@ typedef struct SLocalReducer {
   SLoserTreeInfo *pLoserTree;
   char *          prevRowOfInput;
 
+  struct SLocalMergeWorker **pWorkers;  // workers merge subsets of data sources in parallel
+  int32_t                    numOfWorkers;
+
   tFilePage *pResultBuf;
   int32_t    nResultBufSize;
 
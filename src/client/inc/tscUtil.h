@@ -60,6 +60,21 @@ STableDataBlocks* tscGetDataBlockFromList(void* pHashList, SDataBlockList* pData
                                           int32_t startOffset, int32_t rowSize, char* tableId);
 STableDataBlocks* tscCreateDataBlockEx(size_t size, int32_t rowSize, int32_t startOffset, char* name);
 
+/* the meters whose meter meta are retrieved in one multi-meter-meta msg */
+typedef struct SMultiMeterInfoBuf {
+  char*   pMsg;  // SMultiMeterInfoMsg in network byte order
+  int32_t len;
+  int32_t allocSize;
+  int32_t numOfMeters;
+  void*   pHash;                       // meters already added, duplicated meters are ignored
+  char    meterId[TSDB_METER_ID_LEN];  // the first meter, the db name is extracted from it
+} SMultiMeterInfoBuf;
+
+bool tscIsMeterMetaInCache(char* meterId);
+int32_t tscAddMeterInfo(SMultiMeterInfoBuf* pBuf, char* meterId, STagData* pTag);
+int32_t tscGetMeterMetaInBatch(SSqlObj* pSql, SMultiMeterInfoBuf* pBuf);
+void tscDestroyMultiMeterInfoBuf(SMultiMeterInfoBuf* pBuf);
+
 SVnodeSidList* tscGetVnodeSidList(SMetricMeta* pMetricmeta, int32_t vnodeIdx);
 SMeterSidExtInfo* tscGetMeterSidInfo(SVnodeSidList* pSidList, int32_t idx);
 
@@ -80,8 +95,10 @@ bool tscIsPointInterpQuery(SSqlCmd* pCmd);
 void tscClearInterpInfo(SSqlCmd* pCmd);
 
 int32_t setMeterID(SSqlObj* pSql, SSQLToken* pzTableName);
+int validateTableName(char* tblName, int len);
 
 bool tscIsInsertOrImportData(char* sqlstr);
+bool tscIsMultiCreateTable(char* sqlstr);
 
 /* use for keep current db info temporarily, for handle table with db prefix */
 void tscGetDBInfoFromMeterId(char* meterId, char* db);
@@ -141,6 +158,11 @@ bool tscShouldFreeAsyncSqlObj(SSqlObj* pSql);
 void tscDoQuery(SSqlObj* pSql);
 
 void sortRemoveDuplicates(STableDataBlocks* dataBuf);
+void tsSetBlockInfo(SShellSubmitBlock* pBlocks, const SMeterMeta* pMeterMeta, int32_t numOfRows);
+
+int32_t tsParseStmtInsertSql(SSqlObj* pSql, char* str, SParsedDataColInfo* spd);
+int32_t tsBindColumnsToDataBlock(STableDataBlocks* pDataBlock, SMeterMeta* pMeterMeta, SParsedDataColInfo* spd,
+                                 TAOS_BIND* bind, int32_t numOfRows, char* msg);
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,7 @@ enum _sql_cmd {
   TSDB_SQL_SELECT,
   TSDB_SQL_FETCH,
   TSDB_SQL_INSERT,
+  TSDB_SQL_SUBSCRIBE,
 
   TSDB_SQL_MGMT,  // the SQL below is for mgmt node
   TSDB_SQL_CREATE_DB,
@@ -72,6 +73,7 @@ enum _sql_cmd {
   TSDB_SQL_KILL_QUERY,
   TSDB_SQL_KILL_STREAM,
   TSDB_SQL_KILL_CONNECTION,
+  TSDB_SQL_MULTI_CREATE_TABLE,
 
   TSDB_SQL_READ,  // SQL below is for read operation
   TSDB_SQL_CONNECT,
@@ -79,6 +81,7 @@ enum _sql_cmd {
   TSDB_SQL_META,  // 30
   TSDB_SQL_METRIC,
   TSDB_SQL_HB,
+  TSDB_SQL_MULTI_META,
 
   TSDB_SQL_LOCAL,  // SQL below for client local
   TSDB_SQL_DESCRIBE_TABLE,
@@ -188,6 +191,11 @@ typedef struct STableDataBlocks {
   };
 } STableDataBlocks;
 
+enum {
+  TSDB_USE_SERVER_TS = 0,
+  TSDB_USE_CLI_TS = 1,
+};
+
 typedef struct SDataBlockList {
   int32_t               idx;
   int32_t               nSize;
@@ -203,6 +211,7 @@ typedef struct {
   int             command;
   int             count;
   int16_t         isInsertFromFile;  // load data from file or not
+  int16_t         isInsertBuffered;  // keep the data blocks of each table for the client insert buffer
   int16_t         metricQuery;       // metric query or not
   bool            existsCheck;
   char            msgType;
@@ -233,6 +242,7 @@ typedef struct {
   int64_t      globalLimit;
   SLimitVal    glimit;
   STagCond     tagCond;
+  int16_t      tagFilterPushdown;  // tag condition of metric query is evaluated by vnodes
   int16_t      vnodeIdx;     // vnode index in pMetricMeta for metric query
   int16_t      interpoType;  // interpolate type
 
@@ -271,6 +281,21 @@ typedef struct {
   // Buffer used to put multibytes encoded using unicode (wchar_t)
   char **               buffer;
   struct SLocalReducer *pLocalReducer;
+
+  // compressed columns in pRsp, decompressed into data on the first access of each column
+  char **  pCompCols;
+  int32_t  decompBufSize;
+  char *   pDecompBuf;
+  int64_t  numOfRspBytes;  // total bytes of retrieve responses received from network
+
+  // column-batch results of taos_fetch_columns
+  TAOS_COLUMN *pColumns;
+  int32_t      colBufSize;
+  char *       pColBuf;
+
+  // vgroups failed in multi-vnode insertion, the vgid and error code of each one, see taos_failed_vgroups
+  int32_t  numOfFailedVgroups;
+  int32_t *pFailedVgroups;
 } SSqlRes;
 
 typedef struct _tsc_obj {
@@ -285,10 +310,12 @@ typedef struct _tsc_obj {
   char             sversion[TSDB_VERSION_LEN];
   char             writeAuth : 1;
   char             superAuth : 1;
+  char             retrieveComp : 1;  // retrieve compressed columnar results from vnodes
   struct _sql_obj *pSql;
   struct _sql_obj *pHb;
   struct _sql_obj *sqlList;
   struct _sstream *streamList;
+  struct SInsertBuffer *pInsertBuf;
   pthread_mutex_t  mutex;
 } STscObj;
 
@@ -308,6 +335,7 @@ typedef struct _sql_obj {
   char     retry;
   char     maxRetry;
   char     index;
+  char     prefetch;  // times of batch retrieval of meter meta in async insertion
   char     freed : 4;
   char     listed : 4;
   sem_t    rspSem;
@@ -343,6 +371,9 @@ typedef struct _sstream {
   int16_t precision;
   void *  pTimer;
 
+  // the partial results of the slide-sized panes in current window, NULL if the window is queried as a whole
+  struct SStreamPanes *pPanes;
+
   void (*fp)();
   void *param;
 
@@ -359,15 +390,20 @@ typedef struct {
 
 // tscSql API
 int tsParseSql(SSqlObj *pSql, char *acct, char *db, bool multiVnodeInsertion);
+int tsParseInsertSql(SSqlObj *pSql, char *sql, char *acct, char *db);
+int tsParseMultiCreateTableSql(SSqlObj *pSql, char *str);
 
 void  tscInitMsgs();
 void *tscProcessMsgFromServer(char *msg, void *ahandle, void *thandle);
 int tscProcessSql(SSqlObj *pSql);
 int tscGetMeterMeta(SSqlObj *pSql, char *meterId);
 int tscGetMeterMetaEx(SSqlObj *pSql, char *meterId, bool createIfNotExists);
+int tscGetMultiMeterMeta(SSqlObj *pSql, char *pMsg, int32_t msgLen, char *meterId);
 
 void tscAsyncInsertMultiVnodesProxy(void *param, TAOS_RES *tres, int numOfRows);
 
+void tscDestroyInsertBuffer(STscObj *pObj);
+
 int tscRenewMeterMeta(SSqlObj *pSql, char *meterId);
 void tscQueueAsyncRes(SSqlObj *pSql);
 int tscGetMetricMeta(SSqlObj *pSql, char *meterId);
@@ -384,6 +420,12 @@ int taos_retrieve(TAOS_RES *res);
 void tscTansformSQLFunctionForMetricQuery(SSqlCmd *pCmd);
 void tscRestoreSQLFunctionForMetricQuery(SSqlCmd *pCmd);
 
+/*
+ * replace the function of the index-th expression with its _DST function that outputs the intermediate result,
+ * which is merged later. false is returned if the function has no _DST function
+ */
+bool tscTransformSQLFunctionToDst(SSqlCmd *pCmd, int32_t index);
+
 /**
  * release both metric/meter meta information
  * @param pCmd  SSqlCmd object that contains the metric/meter meta info
@@ -395,6 +437,11 @@ void tscClearSqlMetaInfoForce(SSqlCmd *pCmd);
 int32_t tscCreateResPointerInfo(SSqlCmd *pCmd, SSqlRes *pRes);
 void tscDestroyResPointerInfo(SSqlRes *pRes);
 
+int32_t tscSetCompressedResult(SSqlCmd *pCmd, SSqlRes *pRes, char *pRspData, int32_t rspDataLen);
+void    tscClearCompressedResult(SSqlRes *pRes);
+int32_t tscDecompressResultColumn(SSqlCmd *pCmd, SSqlRes *pRes, int32_t col);
+int32_t tscDecompressResult(SSqlCmd *pCmd, SSqlRes *pRes);
+
 void tscfreeSqlCmdData(SSqlCmd *pCmd);
 
 /**
@@ -424,7 +471,8 @@ void tscCloseTscObj(STscObj *pObj);
 void tscRetrieveDataRes(void *param, TAOS_RES *tres, int numOfRows);
 void tscRetrieveFromVnodeCallBack(void *param, TAOS_RES *tres, int numOfRows);
 
-void tscProcessMultiVnodesInsert(SSqlObj *pSql);
+int32_t tscLaunchMultiVnodesInsert(SSqlObj *pSql, int32_t *pCode);
+void tscMultiVnodesInsertCallBack(void *param, TAOS_RES *tres, int numOfRows);
 void tscProcessMultiVnodesInsertForFile(SSqlObj *pSql);
 void tscKillMetricQuery(SSqlObj *pSql);
 void tscInitResObjForLocalQuery(SSqlObj *pObj, int32_t numOfRes, int32_t rowLen);
@@ -469,6 +469,66 @@ JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_fetchRowImp(JNIEn
   return JNI_SUCCESS;
 }
 
+/*
+ * the data and null bitmap of each column are exposed as direct byte buffers without copy, the buffers are valid
+ * until next fetch or the result set is freed. The length of array should be twice the number of columns.
+ */
+JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_fetchBlockImp(JNIEnv *env, jobject jobj, jlong con,
+                                                                             jlong res, jobjectArray buffers) {
+  TAOS *tscon = (TAOS *)con;
+  if (tscon == NULL) {
+    jniError("jobj:%p, connection is closed", jobj);
+    return JNI_CONNECTION_NULL;
+  }
+
+  TAOS_RES *result = (TAOS_RES *)res;
+  if (result == NULL) {
+    jniError("jobj:%p, taos:%p, resultset is null", jobj, tscon);
+    return JNI_RESULT_SET_NULL;
+  }
+
+  int num_fields = taos_num_fields(result);
+  if (num_fields == 0) {
+    jniError("jobj:%p, taos:%p, resultset:%p, fields size is %d", jobj, tscon, res, num_fields);
+    return JNI_NUM_OF_FIELDS_0;
+  }
+
+  if ((*env)->GetArrayLength(env, buffers) < num_fields * 2) {
+    jniError("jobj:%p, taos:%p, resultset:%p, buffer array is less than %d", jobj, tscon, res, num_fields * 2);
+    return JNI_TDENGINE_ERROR;
+  }
+
+  TAOS_COLUMN *columns = NULL;
+  int          numOfRows = taos_fetch_columns(result, &columns);
+  if (numOfRows <= 0) {
+    int tserrno = taos_errno(tscon);
+    if (tserrno == 0) {
+      jniTrace("jobj:%p, taos:%p, resultset:%p, fields size is %d, fetch block to the end", jobj, tscon, res,
+               num_fields);
+      return JNI_FETCH_END;
+    } else {
+      jniTrace("jobj:%p, taos:%p, interruptted query", jobj, tscon);
+      return JNI_RESULT_SET_NULL;
+    }
+  }
+
+  for (int i = 0; i < num_fields; i++) {
+    jobject data = (*env)->NewDirectByteBuffer(env, columns[i].data, (jlong)columns[i].bytes * numOfRows);
+    jobject bitmap = (*env)->NewDirectByteBuffer(env, columns[i].nullBitmap, (numOfRows + 7) >> 3);
+    if (data == NULL || bitmap == NULL) {
+      jniError("jobj:%p, taos:%p, resultset:%p, failed to create direct buffer", jobj, tscon, res);
+      return JNI_OUT_OF_MEMORY;
+    }
+
+    (*env)->SetObjectArrayElement(env, buffers, i * 2, data);
+    (*env)->SetObjectArrayElement(env, buffers, i * 2 + 1, bitmap);
+    (*env)->DeleteLocalRef(env, data);
+    (*env)->DeleteLocalRef(env, bitmap);
+  }
+
+  return numOfRows;
+}
+
 JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_closeConnectionImp(JNIEnv *env, jobject jobj,
                                                                                   jlong con) {
   TAOS *tscon = (TAOS *)con;
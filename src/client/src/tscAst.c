@@ -48,9 +48,6 @@ static void tSQLSyntaxNodeDestroy(tSQLSyntaxNode *pNode);
 static tSQLSyntaxNode *createSyntaxTree(SSchema *pSchema, int32_t numOfCols, char *str, int32_t *i);
 static void destroySyntaxTree(tSQLSyntaxNode *);
 
-static void tSQLListTraversePrepare(tQueryInfo *colInfo, SSchema *pSchema, int32_t numOfCols, SSchema *pOneColSchema,
-                                    uint8_t optr, tVariant *val);
-
 static uint8_t isQueryOnPrimaryKey(const char *primaryColumnName, const tSQLSyntaxNode *pLeft,
                                    const tSQLSyntaxNode *pRight);
 
@@ -619,56 +616,126 @@ static void setInitialValueForRangeQueryCondition(tSKipListQueryCond *q, int8_t
   }
 }
 
+int32_t tSQLIndexQuery(tSkipList *pSkipList, tQueryInfo *colInfo, tSkipListNode ***pRes) {
+  tSKipListQueryCond q;
+  setInitialValueForRangeQueryCondition(&q, colInfo->q.nType);
+
+  int32_t num = 0;
+  switch (colInfo->optr) {
+    case TSDB_RELATION_EQUAL: {
+      num = tSkipListPointQuery(pSkipList, &colInfo->q, 1, INCLUDE_POINT_QUERY, pRes);
+      break;
+    }
+    case TSDB_RELATION_NOT_EQUAL: {
+      num = tSkipListPointQuery(pSkipList, &colInfo->q, 1, EXCLUDE_POINT_QUERY, pRes);
+      break;
+    }
+    case TSDB_RELATION_LESS_EQUAL: {
+      tVariantAssign(&q.upperBnd, &colInfo->q);
+      q.upperBndRelOptr = colInfo->optr;
+      num = tSkipListQuery(pSkipList, &q, pRes);
+      break;
+    }
+    case TSDB_RELATION_LESS: {
+      tVariantAssign(&q.upperBnd, &colInfo->q);
+      num = tSkipListQuery(pSkipList, &q, pRes);
+      break;
+    }
+    case TSDB_RELATION_LARGE: {
+      tVariantAssign(&q.lowerBnd, &colInfo->q);
+      num = tSkipListQuery(pSkipList, &q, pRes);
+      break;
+    }
+    case TSDB_RELATION_LARGE_EQUAL: {
+      tVariantAssign(&q.lowerBnd, &colInfo->q);
+      q.lowerBndRelOptr = colInfo->optr;
+      num = tSkipListQuery(pSkipList, &q, pRes);
+      break;
+    }
+    default:
+      pTrace("skiplist:%p, unsupport query operator:%d", pSkipList, colInfo->optr);
+  }
+
+  tSkipListDestroyKey(&q.upperBnd);
+  tSkipListDestroyKey(&q.lowerBnd);
+  return num;
+}
+
 static void tSQLDoFilterInitialResult(tSkipList *pSkipList, bool (*fp)(), tQueryInfo *colInfo,
                                       tQueryResultset *result) {
   // primary key, search according to skiplist
   if (colInfo->colIdx == 0 && colInfo->optr != TSDB_RELATION_LIKE) {
-    tSKipListQueryCond q;
-    setInitialValueForRangeQueryCondition(&q, colInfo->q.nType);
+    result->num = tSQLIndexQuery(pSkipList, colInfo, (tSkipListNode ***)&result->pRes);
+  } else {
+    // brutal force search
+    result->num = tSkipListIterateList(pSkipList, (tSkipListNode ***)&result->pRes, fp, colInfo);
+  }
+}
 
-    switch (colInfo->optr) {
-      case TSDB_RELATION_EQUAL: {
-        result->num =
-            tSkipListPointQuery(pSkipList, &colInfo->q, 1, INCLUDE_POINT_QUERY, (tSkipListNode ***)&result->pRes);
+/*
+ * compare the tag value with the query condition prepared by tSQLListTraversePrepare
+ */
+bool tSQLElemFilterOnTagValue(tQueryInfo *pCols, char *val) {
+  int8_t type = (pCols->pSchema[pCols->colIdx].type);
+
+  int32_t ret = 0;
+  if (pCols->q.nType == TSDB_DATA_TYPE_BINARY || pCols->q.nType == TSDB_DATA_TYPE_NCHAR) {
+    ret = pCols->comparator(val, pCols->q.pz);
+  } else {
+    tVariant v = {0};
+    switch (type) {
+      case TSDB_DATA_TYPE_INT:
+        v.i64Key = *(int32_t *)val;
         break;
-      }
-      case TSDB_RELATION_NOT_EQUAL: {
-        result->num =
-            tSkipListPointQuery(pSkipList, &colInfo->q, 1, EXCLUDE_POINT_QUERY, (tSkipListNode ***)&result->pRes);
+      case TSDB_DATA_TYPE_BIGINT:
+        v.i64Key = *(int64_t *)val;
         break;
-      }
-      case TSDB_RELATION_LESS_EQUAL: {
-        tVariantAssign(&q.upperBnd, &colInfo->q);
-        q.upperBndRelOptr = colInfo->optr;
-        result->num = tSkipListQuery(pSkipList, &q, (tSkipListNode ***)&result->pRes);
+      case TSDB_DATA_TYPE_TINYINT:
+        v.i64Key = *(int8_t *)val;
         break;
-      }
-      case TSDB_RELATION_LESS: {
-        tVariantAssign(&q.upperBnd, &colInfo->q);
-        result->num = tSkipListQuery(pSkipList, &q, (tSkipListNode ***)&result->pRes);
+      case TSDB_DATA_TYPE_SMALLINT:
+        v.i64Key = *(int16_t *)val;
         break;
-      }
-      case TSDB_RELATION_LARGE: {
-        tVariantAssign(&q.lowerBnd, &colInfo->q);
-        result->num = tSkipListQuery(pSkipList, &q, (tSkipListNode ***)&result->pRes);
+      case TSDB_DATA_TYPE_DOUBLE:
+        v.dKey = *(double *)val;
         break;
-      }
-      case TSDB_RELATION_LARGE_EQUAL: {
-        tVariantAssign(&q.lowerBnd, &colInfo->q);
-        q.lowerBndRelOptr = colInfo->optr;
-        result->num = tSkipListQuery(pSkipList, &q, (tSkipListNode ***)&result->pRes);
+      case TSDB_DATA_TYPE_FLOAT:
+        v.dKey = *(float *)val;
+        break;
+      case TSDB_DATA_TYPE_BOOL:
+        v.i64Key = *(int8_t *)val;
         break;
-      }
-      default:
-        pTrace("skiplist:%p, unsupport query operator:%d", pSkipList, colInfo->optr);
     }
+    ret = pCols->comparator(&v.i64Key, &pCols->q.i64Key);
+  }
 
-    tSkipListDestroyKey(&q.upperBnd);
-    tSkipListDestroyKey(&q.lowerBnd);
-  } else {
-    // brutal force search
-    result->num = tSkipListIterateList(pSkipList, (tSkipListNode ***)&result->pRes, fp, colInfo);
+  switch (pCols->optr) {
+    case TSDB_RELATION_EQUAL: {
+      return ret == 0;
+    }
+    case TSDB_RELATION_NOT_EQUAL: {
+      return ret != 0;
+    }
+    case TSDB_RELATION_LARGE_EQUAL: {
+      return ret >= 0;
+    }
+    case TSDB_RELATION_LARGE: {
+      return ret > 0;
+    }
+    case TSDB_RELATION_LESS_EQUAL: {
+      return ret <= 0;
+    }
+    case TSDB_RELATION_LESS: {
+      return ret < 0;
+    }
+    case TSDB_RELATION_LIKE: {
+      return ret == 0;
+    }
+
+    default:
+      assert(false);
   }
+  return true;
 }
 
 void tSQLListTraversePrepare(tQueryInfo *colInfo, SSchema *pSchema, int32_t numOfCols, SSchema *pOneColSchema,
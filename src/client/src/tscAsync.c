@@ -299,8 +299,15 @@ void tscProcessAsyncRetrieve(void *param, TAOS_RES *tres, int numOfRows) {
       (*pSql->fetchFp)(pSql->param, pSql, NULL);
     }
   } else {
-    for (int i = 0; i < pCmd->numOfCols; ++i)
+    for (int i = 0; i < pCmd->numOfCols; ++i) {
+      // the error code is kept in pRes, and available through taos_errno
+      if (tscDecompressResultColumn(pCmd, pRes, i) != TSDB_CODE_SUCCESS) {
+        (*pSql->fetchFp)(pSql->param, pSql, NULL);
+        return;
+      }
+
       pRes->tsrow[i] = TSC_GET_RESPTR_BASE(pRes, pCmd, i, pCmd->order) + pRes->bytes[i] * pRes->row;
+    }
     pRes->row++;
 
     (*pSql->fetchFp)(pSql->param, pSql, pSql->res.tsrow);
@@ -312,8 +319,14 @@ void tscProcessFetchRow(SSchedMsg *pMsg) {
   SSqlRes *pRes = &pSql->res;
   SSqlCmd *pCmd = &pSql->cmd;
 
-  for (int i = 0; i < pCmd->numOfCols; ++i)
+  for (int i = 0; i < pCmd->numOfCols; ++i) {
+    if (tscDecompressResultColumn(pCmd, pRes, i) != TSDB_CODE_SUCCESS) {
+      (*pSql->fetchFp)(pSql->param, pSql, NULL);
+      return;
+    }
+
     pRes->tsrow[i] = TSC_GET_RESPTR_BASE(pRes, pCmd, i, pCmd->order) + pRes->bytes[i] * pRes->row;
+  }
   pRes->row++;
 
   (*pSql->fetchFp)(pSql->param, pSql, pRes->tsrow);
@@ -503,6 +516,12 @@ void tscMeterMetaCallBack(void *param, TAOS_RES *res, int code) {
       code = tscGetMetricMeta(pSql, pSql->cmd.name);
       pRes->code = code;
 
+      if (code == TSDB_CODE_ACTION_IN_PROGRESS) return;
+    } else if (pSql->fp == tscMultiVnodesInsertCallBack) {
+      // sub-insertion of multi-vnodes insertion, the submit data block is kept in payload
+      code = tscGetMeterMeta(pSql, pSql->cmd.name);
+      pRes->code = code;
+
       if (code == TSDB_CODE_ACTION_IN_PROGRESS) return;
     } else {  // normal async query continues
       code = tsParseSql(pSql, pObj->acctId, pObj->db, false);
@@ -33,6 +33,8 @@
 #include "tlog.h"
 #include "tscSyntaxtreefunction.h"
 #include "tsqlfunction.h"
+#include "ttdigest.h"
+#include "thyperloglog.h"
 #include "ttypes.h"
 #include "tutil.h"
 
@@ -64,7 +66,7 @@ void getResultInfo(int32_t dataType, int32_t dataBytes, int32_t functionId, int3
     return;
   }
 
-  if (functionId == TSDB_FUNC_COUNT) {
+  if (functionId == TSDB_FUNC_COUNT || functionId == TSDB_FUNC_HLL) {
     *type = TSDB_DATA_TYPE_BIGINT;
     *bytes = sizeof(int64_t);
     return;
@@ -110,12 +112,28 @@ void getResultInfo(int32_t dataType, int32_t dataBytes, int32_t functionId, int3
   } else if (functionId == TSDB_FUNC_AVG_DST) {
     *type = TSDB_DATA_TYPE_BINARY;
     *bytes = sizeof(SAvgRuntime);
+  } else if (functionId == TSDB_FUNC_HLL_DST) {
+    // param is the precision of hyperloglog
+    if (param < HLL_MIN_PRECISION || param > HLL_MAX_PRECISION) {
+      param = HLL_DEFAULT_PRECISION;
+    }
+
+    *type = TSDB_DATA_TYPE_BINARY;
+    *bytes = (int16_t)tHllSize(param);
+  } else if (functionId == TSDB_FUNC_STDDEV_DST) {
+    *type = TSDB_DATA_TYPE_BINARY;
+    *bytes = sizeof(SStddevRuntime);
   } else if (functionId == TSDB_FUNC_TOP_DST || functionId == TSDB_FUNC_BOTTOM_DST) {
     *type = TSDB_DATA_TYPE_BINARY;
     *bytes = sizeof(int64_t) + sizeof(tValuePair) * param;
   } else if (functionId == TSDB_FUNC_APERCT_DST) {
+    // param is the algorithm of apercentile
     *type = TSDB_DATA_TYPE_BINARY;
-    *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo);
+    if (param == TSDB_APERCT_ALGO_TDIGEST) {
+      *bytes = sizeof(STDigest);
+    } else {
+      *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo);
+    }
   } else if (functionId == TSDB_FUNC_LAST_ROW_DST) {
     *type = TSDB_DATA_TYPE_BINARY;
     *bytes = dataBytes + DATA_SET_FLAG_SIZE + TSDB_KEYSIZE;
@@ -568,6 +586,10 @@ static int32_t last_dist_data_req_info(SQLFunctionCtx *pCtx, TSKEY start, TSKEY
  * the average value is calculated in finalize routine, since current routine does not know the exact number of points
  */
 static void avg_finalizer(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {  // intermediate result is not finalized
+    return;
+  }
+
   // pCtx->numOfIteratedElems is the number of not null elements in current
   // query range
   if (pCtx->numOfIteratedElems == 0) {
@@ -1115,137 +1137,408 @@ static bool max_dist_intern_function_f(SQLFunctionCtx *pCtx, int32_t index) {
   return true;
 }
 
-#define LOOP_STDDEV_IMPL(type, r, d, n, delta, tsdbType) \
-  for (int32_t i = 0; i < (n); ++i) {                    \
-    if (isNull((char *)&((type *)d)[i], tsdbType)) {     \
-      continue;                                          \
-    }                                                    \
-    (r) += tPow(((type *)d)[i] - (delta));               \
+/*
+ * stddev is calculated in a single scan. The number of points, the mean value and the sum of squares of differences
+ * from the mean (m2) of each data block are merged into current result by the parallel variance algorithm, so the
+ * results of different blocks, meters and vnodes can be merged in any order.
+ *
+ * For the query on a table, the mean value is kept in intermediateBuf[1], the m2 in output buffer and the number of
+ * points in numOfIteratedElems. For the metric query, all of them are kept in SStddevRuntime in vnode.
+ */
+static FORCE_INLINE void stddev_merge_impl(double *mean, double *m2, int64_t num, double mean1, double m21,
+                                           int64_t num1) {
+  int64_t total = num + num1;
+  double  delta = mean1 - *mean;
+
+  *mean += delta * num1 / total;
+  *m2 += m21 + delta * delta * ((double)num * num1 / total);
+}
+
+#define LOOP_STDDEV_IMPL(type, d, n, hasNull, tsdbType, num, mean, m2) \
+  do {                                                                 \
+    type * _d = (type *)(d);                                           \
+    double _sum = 0;                                                   \
+    for (int32_t i = 0; i < (n); ++i) {                                \
+      if ((hasNull) && isNull((char *)&_d[i], tsdbType)) {             \
+        continue;                                                      \
+      }                                                                \
+      _sum += _d[i];                                                   \
+      (num) += 1;                                                      \
+    }                                                                  \
+    if ((num) == 0) {                                                  \
+      break;                                                           \
+    }                                                                  \
+    (mean) = _sum / (num);                                             \
+    for (int32_t i = 0; i < (n); ++i) {                                \
+      if ((hasNull) && isNull((char *)&_d[i], tsdbType)) {             \
+        continue;                                                      \
+      }                                                                \
+      (m2) += tPow(_d[i] - (mean));                                    \
+    }                                                                  \
+  } while (0)
+
+/*
+ * the number of points, mean and m2 of the data in current block. The block data is in memory, so it is iterated
+ * twice to avoid the precision loss of the sum of squares.
+ */
+static int64_t stddev_block_info(SQLFunctionCtx *pCtx, double *mean, double *m2) {
+  int64_t num = 0;
+  void *  pData = GET_INPUT_CHAR(pCtx);
+
+  *mean = 0;
+  *m2 = 0;
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      LOOP_STDDEV_IMPL(int8_t, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      LOOP_STDDEV_IMPL(int16_t, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      LOOP_STDDEV_IMPL(int32_t, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      LOOP_STDDEV_IMPL(int64_t, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      LOOP_STDDEV_IMPL(float, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      LOOP_STDDEV_IMPL(double, pData, pCtx->size, pCtx->hasNullValue, pCtx->inputType, num, *mean, *m2);
+      break;
+    default:
+      pError("stddev function not support data type:%d", pCtx->inputType);
   }
 
+  return num;
+}
+
+/* return false if the value is null */
+static bool stddev_get_value(SQLFunctionCtx *pCtx, int32_t index, double *v) {
+  char *pData = GET_INPUT_CHAR_INDEX(pCtx, index);
+  if (pCtx->hasNullValue && isNull(pData, pCtx->inputType)) {
+    return false;
+  }
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      *v = *(int8_t *)pData;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *v = *(int16_t *)pData;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *v = *(int32_t *)pData;
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      *v = *(int64_t *)pData;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      *v = *(float *)pData;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *v = *(double *)pData;
+      break;
+    default:
+      pError("stddev function not support data type:%d", pCtx->inputType);
+      return false;
+  }
+
+  return true;
+}
+
+static void stddev_function_setup(SQLFunctionCtx *pCtx) {
+  function_setup(pCtx);
+
+  // the mean value of the table query, or the secondary merge of metric query
+  pCtx->intermediateBuf[1].nType = TSDB_DATA_TYPE_DOUBLE;
+  pCtx->intermediateBuf[1].dKey = 0;
+}
+
 static bool stddev_function(SQLFunctionCtx *pCtx) {
-  if (pCtx->currentStage == 0) {
-    /* the first stage to calculate average value */
-    return sum_function(pCtx);
-  } else {
-    /* the second stage to calculate standard deviation */
-    double *retVal = pCtx->aOutputBuf;
-    double  avg = pCtx->intermediateBuf[1].dKey;
-    void *  pData = GET_INPUT_CHAR(pCtx);
+  double  mean = 0;
+  double  m2 = 0;
+  int64_t num = stddev_block_info(pCtx, &mean, &m2);
 
-    switch (pCtx->inputType) {
-      case TSDB_DATA_TYPE_INT: {
-        for (int32_t i = 0; i < pCtx->size; ++i) {
-          if (isNull(&((int32_t *)pData)[i], pCtx->inputType)) {
-            continue;
-          }
-          *retVal += tPow(((int32_t *)pData)[i] - avg);
-        }
-        break;
-      }
-      case TSDB_DATA_TYPE_FLOAT: {
-        LOOP_STDDEV_IMPL(float, *retVal, pData, pCtx->size, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_DOUBLE: {
-        LOOP_STDDEV_IMPL(double, *retVal, pData, pCtx->size, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_BIGINT: {
-        LOOP_STDDEV_IMPL(int64_t, *retVal, pData, pCtx->size, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_SMALLINT: {
-        LOOP_STDDEV_IMPL(int16_t, *retVal, pData, pCtx->size, avg, pCtx->inputType);
-        break;
-      }
-      case TSDB_DATA_TYPE_TINYINT: {
-        LOOP_STDDEV_IMPL(int8_t, *retVal, pData, pCtx->size, avg, pCtx->inputType);
-        break;
-      }
-      default:
-        pError("stddev function not support data type:%d", pCtx->inputType);
-    }
+  if (num > 0) {
+    stddev_merge_impl(&pCtx->intermediateBuf[1].dKey, (double *)pCtx->aOutputBuf, pCtx->numOfIteratedElems, mean, m2,
+                      num);
+  }
+
+  SET_VAL(pCtx, num, 1);
+  return true;
+}
 
+static bool stddev_function_f(SQLFunctionCtx *pCtx, int32_t index) {
+  double v = 0;
+  if (!stddev_get_value(pCtx, index, &v)) {
     return true;
   }
+
+  stddev_merge_impl(&pCtx->intermediateBuf[1].dKey, (double *)pCtx->aOutputBuf, pCtx->numOfIteratedElems, v, 0, 1);
+  SET_VAL(pCtx, 1, 1);
+  return true;
 }
 
-static bool stddev_function_f(SQLFunctionCtx *pCtx, int32_t index) {
-  if (pCtx->currentStage == 0) {
-    /* the first stage is to calculate average value */
-    return sum_function_f(pCtx, index);
-  } else {
-    /* the second stage to calculate standard deviation */
-    double *retVal = pCtx->aOutputBuf;
-    double  avg = pCtx->intermediateBuf[1].dKey;
+static void stddev_finalizer(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {  // intermediate result is not finalized
+    return;
+  }
 
-    void *pData = GET_INPUT_CHAR_INDEX(pCtx, index);
-    if (pCtx->hasNullValue && isNull(pData, pCtx->inputType)) {
-      return true;
+  if (pCtx->numOfIteratedElems <= 0) {
+    setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
+    return;
+  }
+
+  double *retValue = (double *)pCtx->aOutputBuf;
+  *retValue = sqrt(*retValue / pCtx->numOfIteratedElems);
+
+  pCtx->numOfOutputElems = 1;
+}
+
+static bool stddev_dist_intern_function(SQLFunctionCtx *pCtx) {
+  double  mean = 0;
+  double  m2 = 0;
+  int64_t num = stddev_block_info(pCtx, &mean, &m2);
+
+  if (num > 0) {
+    SStddevRuntime *pOutput = (SStddevRuntime *)pCtx->aOutputBuf;
+    stddev_merge_impl(&pOutput->mean, &pOutput->m2, pOutput->num, mean, m2, num);
+
+    pOutput->num += num;
+    pOutput->valFlag = DATA_SET_FLAG;
+  }
+
+  SET_VAL(pCtx, num, 1);
+  return true;
+}
+
+static bool stddev_dist_intern_function_f(SQLFunctionCtx *pCtx, int32_t index) {
+  double v = 0;
+  if (!stddev_get_value(pCtx, index, &v)) {
+    return true;
+  }
+
+  SStddevRuntime *pOutput = (SStddevRuntime *)pCtx->aOutputBuf;
+  stddev_merge_impl(&pOutput->mean, &pOutput->m2, pOutput->num, v, 0, 1);
+
+  pOutput->num += 1;
+  pOutput->valFlag = DATA_SET_FLAG;
+
+  SET_VAL(pCtx, 1, 1);
+  return true;
+}
+
+static void stddev_dist_merge(SQLFunctionCtx *pCtx) {
+  SStddevRuntime *pDest = (SStddevRuntime *)pCtx->aOutputBuf;
+
+  char *input = GET_INPUT_CHAR(pCtx);
+  for (int32_t i = 0; i < pCtx->size; ++i, input += pCtx->inputBytes) {
+    SStddevRuntime *pInput = (SStddevRuntime *)input;
+    if (pInput->valFlag != DATA_SET_FLAG) {  // current buffer is null
+      continue;
     }
 
-    switch (pCtx->inputType) {
-      case TSDB_DATA_TYPE_INT: {
-        *retVal += tPow((*(int32_t *)pData) - avg);
-        break;
-      }
-      case TSDB_DATA_TYPE_FLOAT: {
-        *retVal += tPow((*(float *)pData) - avg);
-        break;
-      }
-      case TSDB_DATA_TYPE_DOUBLE: {
-        *retVal += tPow((*(double *)pData) - avg);
-        break;
-      }
-      case TSDB_DATA_TYPE_BIGINT: {
-        *retVal += tPow((*(int64_t *)pData) - avg);
-        break;
-      }
-      case TSDB_DATA_TYPE_SMALLINT: {
-        *retVal += tPow((*(int16_t *)pData) - avg);
-        break;
-      }
-      case TSDB_DATA_TYPE_TINYINT: {
-        *retVal += tPow((*(int8_t *)pData) - avg);
-        break;
+    stddev_merge_impl(&pDest->mean, &pDest->m2, pDest->num, pInput->mean, pInput->m2, pInput->num);
+    pDest->num += pInput->num;
+    pDest->valFlag = DATA_SET_FLAG;
+  }
+
+  pCtx->numOfIteratedElems = pDest->num;
+}
+
+static void stddev_dist_second_merge(SQLFunctionCtx *pCtx) {
+  char *input = GET_INPUT_CHAR(pCtx);
+
+  for (int32_t i = 0; i < pCtx->size; ++i, input += pCtx->inputBytes) {
+    SStddevRuntime *pInput = (SStddevRuntime *)input;
+    if (pInput->valFlag != DATA_SET_FLAG) {  // current input is null
+      continue;
+    }
+
+    stddev_merge_impl(&pCtx->intermediateBuf[1].dKey, (double *)pCtx->aOutputBuf, pCtx->numOfIteratedElems,
+                      pInput->mean, pInput->m2, pInput->num);
+    pCtx->numOfIteratedElems += pInput->num;
+  }
+}
+
+/*
+ * the number of distinct values is estimated by hyperloglog. The sketch is kept in output buffer as the intermediate
+ * result of metric query in vnode, otherwise it is created in intermediateBuf[1] for the query on table and the
+ * secondary merge of metric query. The precision of sketch is the first parameter.
+ */
+#define HLL_HASH_BUFFER_SIZE 512
+
+#define LOOP_HLL_HASH_IMPL(type, d, s, e, hasNull, tsdbType, hash, num) \
+  do {                                                                  \
+    type *_d = (type *)(d);                                             \
+    if (!(hasNull)) {                                                   \
+      for (int32_t i = (s); i < (e); ++i) {                             \
+        (hash)[(num)++] = tHllHashInt(_d[i]);                           \
+      }                                                                 \
+    } else {                                                            \
+      for (int32_t i = (s); i < (e); ++i) {                             \
+        if (isNull((char *)&_d[i], tsdbType)) {                         \
+          continue;                                                     \
+        }                                                               \
+        (hash)[(num)++] = tHllHashInt(_d[i]);                           \
+      }                                                                 \
+    }                                                                   \
+  } while (0)
+
+/*
+ * hash the not null values in the range of [start, end) of current block. The values of numeric types are hashed by
+ * the bits of the same width, so the type of input is checked once for a batch of values.
+ */
+static int32_t hll_get_hashes(SQLFunctionCtx *pCtx, int32_t start, int32_t end, uint64_t *hash) {
+  int32_t num = 0;
+  char *  pData = GET_INPUT_CHAR(pCtx);
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      LOOP_HLL_HASH_IMPL(uint8_t, pData, start, end, pCtx->hasNullValue, pCtx->inputType, hash, num);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      LOOP_HLL_HASH_IMPL(uint16_t, pData, start, end, pCtx->hasNullValue, pCtx->inputType, hash, num);
+      break;
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_FLOAT:
+      LOOP_HLL_HASH_IMPL(uint32_t, pData, start, end, pCtx->hasNullValue, pCtx->inputType, hash, num);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_DOUBLE:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      LOOP_HLL_HASH_IMPL(uint64_t, pData, start, end, pCtx->hasNullValue, pCtx->inputType, hash, num);
+      break;
+    default: {  // binary and nchar
+      for (int32_t i = start; i < end; ++i) {
+        char *val = pData + i * pCtx->inputBytes;
+        if (pCtx->hasNullValue && isNull(val, pCtx->inputType)) {
+          continue;
+        }
+
+        hash[num++] = tHllHashBytes(val, pCtx->inputBytes);
       }
-      default:
-        pError("stddev function not support data type:%d", pCtx->inputType);
     }
+  }
 
-    return true;
+  return num;
+}
+
+static SHyperLogLog *hll_get_sketch(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {
+    return (SHyperLogLog *)pCtx->aOutputBuf;
+  } else {
+    return (SHyperLogLog *)pCtx->intermediateBuf[1].pz;
   }
 }
 
-static bool stddev_next_step(SQLFunctionCtx *pCtx) {
-  if (pCtx->currentStage == 0) {
-    /*
-     * stddev is calculated in two stage:
-     * 1. get the average value of all points;
-     * 2. get final result, based on the average values;
-     * so, if this routine is in second stage, no further step is required
-     */
+static void hll_function_setup(SQLFunctionCtx *pCtx) {
+  function_setup(pCtx);
+
+  int32_t precision = (int32_t)pCtx->param[0].i64Key;
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {
+    tHllInit((SHyperLogLog *)pCtx->aOutputBuf, precision);
+    return;
+  }
+
+  // the buffer is reused for the following groups, so the size of maximum precision is allocated
+  if (pCtx->intermediateBuf[1].pz == NULL) {
+    pCtx->intermediateBuf[1].pz = malloc(tHllSize(HLL_MAX_PRECISION));
+  }
+
+  if (pCtx->intermediateBuf[1].pz != NULL) {
+    tHllInit((SHyperLogLog *)pCtx->intermediateBuf[1].pz, precision);
+  }
+}
 
-    ++pCtx->currentStage;
-    avg_finalizer(pCtx);
+static bool hll_function(SQLFunctionCtx *pCtx) {
+  SHyperLogLog *pHll = hll_get_sketch(pCtx);
+  if (pHll == NULL) {
+    return false;
+  }
 
-    // save average value into tmpBuf, for second stage scan
-    pCtx->intermediateBuf[1].dKey = ((double *)pCtx->aOutputBuf)[0];
-    *((double *)pCtx->aOutputBuf) = 0;
+  uint64_t hash[HLL_HASH_BUFFER_SIZE];
+  int32_t  notNullElems = 0;
+
+  for (int32_t i = 0; i < pCtx->size; i += HLL_HASH_BUFFER_SIZE) {
+    int32_t end = (i + HLL_HASH_BUFFER_SIZE < pCtx->size) ? i + HLL_HASH_BUFFER_SIZE : pCtx->size;
+    int32_t num = hll_get_hashes(pCtx, i, end, hash);
+
+    tHllAddBatch(pHll, hash, num);
+    notNullElems += num;
+  }
+
+  SET_VAL(pCtx, notNullElems, 1);
+  return true;
+}
+
+static bool hll_function_f(SQLFunctionCtx *pCtx, int32_t index) {
+  SHyperLogLog *pHll = hll_get_sketch(pCtx);
+  if (pHll == NULL) {
+    return false;
+  }
+
+  uint64_t hash = 0;
+  if (hll_get_hashes(pCtx, index, index + 1, &hash) == 0) {
     return true;
   }
-  return false;
+
+  tHllAdd(pHll, hash);
+  SET_VAL(pCtx, 1, 1);
+  return true;
 }
 
-static void stddev_finalizer(SQLFunctionCtx *pCtx) {
-  if (pCtx->numOfIteratedElems <= 0) {
+static void hll_finalizer(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {  // intermediate result is not finalized
+    return;
+  }
+
+  SHyperLogLog *pHll = (SHyperLogLog *)pCtx->intermediateBuf[1].pz;
+  if (pCtx->numOfIteratedElems <= 0 || pHll == NULL) {
     setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
+  } else {
+    *(int64_t *)pCtx->aOutputBuf = (int64_t)tHllCount(pHll);
+    pCtx->numOfOutputElems = 1;
+  }
+
+  tfree(pCtx->intermediateBuf[1].pz);
+}
+
+static void hll_dist_merge(SQLFunctionCtx *pCtx) {
+  SHyperLogLog *pDest = (SHyperLogLog *)pCtx->aOutputBuf;
+
+  char *input = GET_INPUT_CHAR(pCtx);
+  for (int32_t i = 0; i < pCtx->size; ++i, input += pCtx->inputBytes) {
+    SHyperLogLog *pInput = (SHyperLogLog *)input;
+    if (pInput->numOfElems <= 0) {  // current buffer is null
+      continue;
+    }
+
+    tHllMerge(pDest, pInput);
+  }
+
+  pCtx->numOfIteratedElems = pDest->numOfElems;
+}
+
+static void hll_dist_second_merge(SQLFunctionCtx *pCtx) {
+  SHyperLogLog *pHll = (SHyperLogLog *)pCtx->intermediateBuf[1].pz;
+  if (pHll == NULL) {
     return;
   }
 
-  double *retValue = (double *)pCtx->aOutputBuf;
-  *retValue = sqrt(*retValue / pCtx->numOfIteratedElems);
+  char *input = GET_INPUT_CHAR(pCtx);
+  for (int32_t i = 0; i < pCtx->size; ++i, input += pCtx->inputBytes) {
+    SHyperLogLog *pInput = (SHyperLogLog *)input;
+    if (pInput->numOfElems <= 0) {  // current input is null
+      continue;
+    }
+
+    tHllMerge(pHll, pInput);
+    pCtx->numOfIteratedElems += pInput->numOfElems;
+  }
 }
 
 static bool first_function(SQLFunctionCtx *pCtx) {
@@ -2335,72 +2628,126 @@ static void percentile_finalizer(SQLFunctionCtx *pCtx) {
   pCtx->intermediateBuf[2].pz = NULL;
 }
 
-static bool apercentile_function(SQLFunctionCtx *pCtx) {
+#define LOOP_GET_VALUES_IMPL(type, d, n, hasNull, tsdbType, val, num) \
+  do {                                                                \
+    type *_d = (type *)(d);                                           \
+    for (int32_t i = 0; i < (n); ++i) {                               \
+      if ((hasNull) && isNull((char *)&_d[i], tsdbType)) {            \
+        continue;                                                     \
+      }                                                               \
+      (val)[(num)++] = _d[i];                                         \
+    }                                                                 \
+  } while (0)
+
+/*
+ * convert the not null values in [start, start + n) of current block to double, and return the number of values, so
+ * that the type of input is checked once for each block instead of each value
+ */
+static int32_t apercentile_get_values(SQLFunctionCtx *pCtx, int32_t start, int32_t n, double *val) {
+  int32_t num = 0;
+  char *  pData = (char *)GET_INPUT_CHAR(pCtx) + start * pCtx->inputBytes;
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      LOOP_GET_VALUES_IMPL(int8_t, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      LOOP_GET_VALUES_IMPL(int16_t, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      LOOP_GET_VALUES_IMPL(int64_t, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      LOOP_GET_VALUES_IMPL(float, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      LOOP_GET_VALUES_IMPL(double, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+    default:
+      LOOP_GET_VALUES_IMPL(int32_t, pData, n, pCtx->hasNullValue, pCtx->inputType, val, num);
+      break;
+  }
+
+  return num;
+}
+
+/*
+ * add the not null values of current block into the t-digest, or the histogram if pDigest is null. The values are
+ * converted by every TDIGEST_BATCH_SIZE values in stack, so no buffer is allocated for each block.
+ */
+static int32_t apercentile_add_values(SQLFunctionCtx *pCtx, STDigest *pDigest, SHistogramInfo **pHisto) {
+  double  val[TDIGEST_BATCH_SIZE];
   int32_t notNullElems = 0;
 
-  if (pCtx->hasNullValue) {
-    for (int32_t i = 0; i < pCtx->size; ++i) {
-      char *data = GET_INPUT_CHAR_INDEX(pCtx, i);
-      if (isNull(data, pCtx->inputType)) {
-        continue;
+  for (int32_t start = 0; start < pCtx->size; start += TDIGEST_BATCH_SIZE) {
+    int32_t num = apercentile_get_values(pCtx, start, MIN(pCtx->size - start, TDIGEST_BATCH_SIZE), val);
+
+    if (pDigest != NULL) {
+      tTDigestAddBatch(pDigest, val, num);
+    } else {
+      for (int32_t i = 0; i < num; ++i) {
+        tHistogramAdd(pHisto, val[i]);
       }
+    }
 
-      notNullElems += 1;
-      double v = 0;
+    notNullElems += num;
+  }
 
-      switch (pCtx->inputType) {
-        case TSDB_DATA_TYPE_TINYINT:
-          v = *(int8_t *)data;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          v = *(int16_t *)data;
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          v = *(int64_t *)data;
-          break;
-        case TSDB_DATA_TYPE_FLOAT:
-          v = *(float *)data;
-          break;
-        case TSDB_DATA_TYPE_DOUBLE:
-          v = *(double *)data;
-          break;
-        default:
-          v = *(int32_t *)data;
-          break;
-      }
+  return notNullElems;
+}
+
+static double apercentile_get_value(SQLFunctionCtx *pCtx, char *pData) {
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return *(int8_t *)pData;
+    case TSDB_DATA_TYPE_SMALLINT:
+      return *(int16_t *)pData;
+    case TSDB_DATA_TYPE_BIGINT:
+      return *(int64_t *)pData;
+    case TSDB_DATA_TYPE_FLOAT:
+      return *(float *)pData;
+    case TSDB_DATA_TYPE_DOUBLE:
+      return *(double *)pData;
+    default:
+      return *(int32_t *)pData;
+  }
+}
+
+/*
+ * the approximate percentile is calculated by the histogram, or the t-digest if it is specified by the third
+ * parameter of apercentile, which is passed by param[1]. For the query on a table and the secondary merge of metric
+ * query, the histogram or t-digest is created in intermediateBuf[1], otherwise it is kept in output buffer.
+ */
+#define IS_TDIGEST_APERCT(ctx) ((ctx)->param[1].i64Key == TSDB_APERCT_ALGO_TDIGEST)
 
-      tHistogramAdd(&pCtx->param[1].pz, v);
+static void apercentile_function_setup(SQLFunctionCtx *pCtx) {
+  function_setup(pCtx);
+
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    if (pCtx->intermediateBuf[1].pz == NULL) {
+      pCtx->intermediateBuf[1].pz = malloc(sizeof(STDigest));
+    }
+
+    if (pCtx->intermediateBuf[1].pz != NULL) {
+      tTDigestInit((STDigest *)pCtx->intermediateBuf[1].pz);
     }
   } else {
-    for (int32_t i = 0; i < pCtx->size; ++i) {
-      char * data = GET_INPUT_CHAR_INDEX(pCtx, i);
-      double v = 0;
+    // the histogram is created in the first insertion
+    tHistogramDestroy((SHistogramInfo **)&pCtx->intermediateBuf[1].pz);
+  }
+}
 
-      switch (pCtx->inputType) {
-        case TSDB_DATA_TYPE_TINYINT:
-          v = *(int8_t *)data;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          v = *(int16_t *)data;
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          v = *(int64_t *)data;
-          break;
-        case TSDB_DATA_TYPE_FLOAT:
-          v = *(float *)data;
-          break;
-        case TSDB_DATA_TYPE_DOUBLE:
-          v = *(double *)data;
-          break;
-        default:
-          v = *(int32_t *)data;
-          break;
-      }
+static bool apercentile_function(SQLFunctionCtx *pCtx) {
+  int32_t notNullElems = 0;
 
-      tHistogramAdd(&pCtx->param[1].pz, v);
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    if (pCtx->intermediateBuf[1].pz == NULL) {
+      return false;
     }
 
-    notNullElems += pCtx->size;
+    notNullElems = apercentile_add_values(pCtx, (STDigest *)pCtx->intermediateBuf[1].pz, NULL);
+  } else {
+    notNullElems = apercentile_add_values(pCtx, NULL, (SHistogramInfo **)&pCtx->intermediateBuf[1].pz);
   }
 
   SET_VAL(pCtx, notNullElems, 1);
@@ -2413,127 +2760,74 @@ static bool apercentile_function_f(SQLFunctionCtx *pCtx, int32_t index) {
     return true;
   }
 
-  double v = 0;
-  SET_VAL(pCtx, 1, 1);
+  double v = apercentile_get_value(pCtx, pData);
 
-  switch (pCtx->inputType) {
-    case TSDB_DATA_TYPE_TINYINT:
-      v = *(int8_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_SMALLINT:
-      v = *(int16_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_BIGINT:
-      v = *(int64_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_FLOAT:
-      v = *(float *)pData;
-      break;
-    case TSDB_DATA_TYPE_DOUBLE:
-      v = *(double *)pData;
-      break;
-    default:
-      v = *(int32_t *)pData;
-      break;
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    if (pCtx->intermediateBuf[1].pz == NULL) {
+      return false;
+    }
+
+    tTDigestAdd((STDigest *)pCtx->intermediateBuf[1].pz, v);
+  } else {
+    tHistogramAdd((SHistogramInfo **)&pCtx->intermediateBuf[1].pz, v);
   }
 
-  tHistogramAdd(&pCtx->param[1].pz, v);
+  SET_VAL(pCtx, 1, 1);
   return true;
 }
 
 static void apercentile_finalizer(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {  // intermediate result is not finalized
+    return;
+  }
+
   double v = pCtx->param[0].nType == TSDB_DATA_TYPE_INT ? pCtx->param[0].i64Key : pCtx->param[0].dKey;
 
-  if (pCtx->numOfIteratedElems > 0) {  // check for null
-    double  ratio[] = {v};
-    double *res = tHistogramUniform(pCtx->param[1].pz, ratio, 1);
-    memcpy(pCtx->aOutputBuf, res, sizeof(double));
-    free(res);
+  if (pCtx->numOfIteratedElems > 0 && pCtx->intermediateBuf[1].pz != NULL) {  // check for null
+    if (IS_TDIGEST_APERCT(pCtx)) {
+      *(double *)pCtx->aOutputBuf = tTDigestQuantile((STDigest *)pCtx->intermediateBuf[1].pz, v / 100);
+    } else {
+      double  ratio[] = {v};
+      double *res = tHistogramUniform(pCtx->intermediateBuf[1].pz, ratio, 1);
+      memcpy(pCtx->aOutputBuf, res, sizeof(double));
+      free(res);
+    }
   } else {
     setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
   }
 
   SET_VAL(pCtx, pCtx->numOfIteratedElems, 1);
-  tHistogramDestroy(&(pCtx->param[1].pz));
+
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    tfree(pCtx->intermediateBuf[1].pz);
+  } else {
+    tHistogramDestroy((SHistogramInfo **)&pCtx->intermediateBuf[1].pz);
+  }
 }
 
 static void apercentile_dist_function_setup(SQLFunctionCtx *pCtx) {
+  if (pCtx->outputType != TSDB_DATA_TYPE_BINARY) { /* for secondary merge at client-side */
+    apercentile_function_setup(pCtx);
+    return;
+  }
+
   function_setup(pCtx);
-  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {
+
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    tTDigestInit((STDigest *)pCtx->aOutputBuf);
+  } else {
     tHistogramCreateFrom(pCtx->aOutputBuf, MAX_HISTOGRAM_BIN);
-  } else { /* for secondary merge at client-side */
-    pCtx->param[1].pz = tHistogramCreate(MAX_HISTOGRAM_BIN);
   }
 }
 
 static bool apercentile_dist_intern_function(SQLFunctionCtx *pCtx) {
   int32_t notNullElems = 0;
 
-  SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->aOutputBuf;
-
-  if (pCtx->hasNullValue) {
-    for (int32_t i = 0; i < pCtx->size; ++i) {
-      char *data = GET_INPUT_CHAR_INDEX(pCtx, i);
-      if (isNull(data, pCtx->inputType)) {
-        continue;
-      }
-
-      notNullElems += 1;
-      double v = 0;
-
-      switch (pCtx->inputType) {
-        case TSDB_DATA_TYPE_TINYINT:
-          v = *(int8_t *)data;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          v = *(int16_t *)data;
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          v = *(int64_t *)data;
-          break;
-        case TSDB_DATA_TYPE_FLOAT:
-          v = *(float *)data;
-          break;
-        case TSDB_DATA_TYPE_DOUBLE:
-          v = *(double *)data;
-          break;
-        default:
-          v = *(int32_t *)data;
-          break;
-      }
-
-      tHistogramAdd(&pHisto, v);
-    }
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    notNullElems = apercentile_add_values(pCtx, (STDigest *)pCtx->aOutputBuf, NULL);
   } else {
-    for (int32_t i = 0; i < pCtx->size; ++i) {
-      char * data = GET_INPUT_CHAR_INDEX(pCtx, i);
-      double v = 0;
-
-      switch (pCtx->inputType) {
-        case TSDB_DATA_TYPE_TINYINT:
-          v = *(int8_t *)data;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          v = *(int16_t *)data;
-          break;
-        case TSDB_DATA_TYPE_BIGINT:
-          v = *(int64_t *)data;
-          break;
-        case TSDB_DATA_TYPE_FLOAT:
-          v = *(float *)data;
-          break;
-        case TSDB_DATA_TYPE_DOUBLE:
-          v = *(double *)data;
-          break;
-        default:
-          v = *(int32_t *)data;
-          break;
-      }
-
-      tHistogramAdd(&pHisto, v);
-    }
-
-    notNullElems += pCtx->size;
+    SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->aOutputBuf;
+    notNullElems = apercentile_add_values(pCtx, NULL, &pHisto);
   }
 
   SET_VAL(pCtx, notNullElems, 1);
@@ -2546,36 +2840,31 @@ static bool apercentile_dist_intern_function_f(SQLFunctionCtx *pCtx, int32_t ind
     return true;
   }
 
-  SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->aOutputBuf;
   SET_VAL(pCtx, 1, 1);
+  double v = apercentile_get_value(pCtx, pData);
 
-  double v = 0;
-  switch (pCtx->inputType) {
-    case TSDB_DATA_TYPE_TINYINT:
-      v = *(int8_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_SMALLINT:
-      v = *(int16_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_BIGINT:
-      v = *(int64_t *)pData;
-      break;
-    case TSDB_DATA_TYPE_FLOAT:
-      v = *(float *)pData;
-      break;
-    case TSDB_DATA_TYPE_DOUBLE:
-      v = *(double *)pData;
-      break;
-    default:
-      v = *(int32_t *)pData;
-      break;
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    tTDigestAdd((STDigest *)pCtx->aOutputBuf, v);
+  } else {
+    SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->aOutputBuf;
+    tHistogramAdd(&pHisto, v);
   }
 
-  tHistogramAdd(&pHisto, v);
   return true;
 }
 
 static void apercentile_dist_merge(SQLFunctionCtx *pCtx) {
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    STDigest *pInput = (STDigest *)GET_INPUT_CHAR(pCtx);
+    if (tTDigestSize(pInput) <= 0) {
+      return;
+    }
+
+    tTDigestMerge((STDigest *)pCtx->aOutputBuf, pInput);
+    pCtx->numOfIteratedElems += 1;
+    return;
+  }
+
   SHistogramInfo *pInput = (SHistogramInfo *)GET_INPUT_CHAR(pCtx);
   if (pInput->numOfElems <= 0) {
     return;
@@ -2603,12 +2892,28 @@ static void apercentile_dist_merge(SQLFunctionCtx *pCtx) {
 }
 
 static void apercentile_dist_second_merge(SQLFunctionCtx *pCtx) {
+  if (IS_TDIGEST_APERCT(pCtx)) {
+    STDigest *pInput = (STDigest *)GET_INPUT_CHAR(pCtx);
+    if (tTDigestSize(pInput) <= 0 || pCtx->intermediateBuf[1].pz == NULL) {
+      return;
+    }
+
+    tTDigestMerge((STDigest *)pCtx->intermediateBuf[1].pz, pInput);
+    pCtx->numOfIteratedElems += 1;
+    return;
+  }
+
   SHistogramInfo *pInput = (SHistogramInfo *)GET_INPUT_CHAR(pCtx);
   if (pInput->numOfElems <= 0) {
     return;
   }
 
-  SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->param[1].pz;
+  SHistogramInfo *pHisto = (SHistogramInfo *)pCtx->intermediateBuf[1].pz;
+  if (pHisto == NULL) {
+    pHisto = tHistogramCreate(MAX_HISTOGRAM_BIN);
+    pCtx->intermediateBuf[1].pz = pHisto;
+  }
+
   if (pHisto->numOfElems <= 0) {
     memcpy(pHisto, pInput, sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1));
     pHisto->elems = (char *)pHisto + sizeof(SHistogramInfo);
@@ -2617,8 +2922,8 @@ static void apercentile_dist_second_merge(SQLFunctionCtx *pCtx) {
     pHisto->elems = (char *)pHisto + sizeof(SHistogramInfo);
 
     SHistogramInfo *pRes = tHistogramMerge(pHisto, pInput, MAX_HISTOGRAM_BIN);
-    tHistogramDestroy(&pCtx->param[1].pz);
-    pCtx->param[1].pz = pRes;
+    tHistogramDestroy((SHistogramInfo **)&pCtx->intermediateBuf[1].pz);
+    pCtx->intermediateBuf[1].pz = pRes;
   }
 
   pCtx->numOfIteratedElems += 1;
@@ -3396,6 +3701,10 @@ void spread_function_finalize(SQLFunctionCtx *pCtx) {
    * here we do not check the input data types, because in case of metric query,
    * the type of intermediate data is binary
    */
+  if (pCtx->outputType == TSDB_DATA_TYPE_BINARY) {  // intermediate result is not finalized
+    return;
+  }
+
   if (pCtx->numOfIteratedElems <= 0) {
     setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
     return;
@@ -4456,7 +4765,7 @@ _end:
  *
  * top/bottom is the last one
  */
-int32_t funcCompatList[36] = {
+int32_t funcCompatList[39] = {
     /* count, sum, avg, min, max, stddev, percentile, apercentile, first,
        last, last_row, leastsqr, */
     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 7, 1,
@@ -4469,11 +4778,11 @@ int32_t funcCompatList[36] = {
        wavg_dst, top_dst, bottom_dst, */
     1, 1, 1, 1, 1, 1, 7, 1, 1, 2, 5,
 
-    /*apercentile_dst, interp*/
-    1, 6,
+    /*apercentile_dst, interp, stddev_dst, hyperloglog, hyperloglog_dst*/
+    1, 6, 1, 1, 1,
 };
 
-SQLAggFuncElem aAggs[36] = {
+SQLAggFuncElem aAggs[39] = {
     {
         // 0
         "count", TSDB_FUNC_COUNT, TSDB_FUNC_COUNT, TSDB_BASE_FUNC_SO, function_setup, count_function, count_function_f,
@@ -4501,9 +4810,8 @@ SQLAggFuncElem aAggs[36] = {
     },
     {
         // 5
-        "stddev", TSDB_FUNC_STDDEV, TSDB_FUNC_INVALID_ID, TSDB_FUNCSTATE_SO | TSDB_FUNCSTATE_STREAM | TSDB_FUNCSTATE_OF,
-        function_setup, stddev_function, stddev_function_f, stddev_next_step, stddev_finalizer, noop, noop,
-        data_req_load_info,
+        "stddev", TSDB_FUNC_STDDEV, TSDB_FUNC_STDDEV_DST, TSDB_BASE_FUNC_SO, stddev_function_setup, stddev_function,
+        stddev_function_f, no_next_step, stddev_finalizer, noop, noop, data_req_load_info,
     },
     {
         // 6
@@ -4514,7 +4822,7 @@ SQLAggFuncElem aAggs[36] = {
     {
         // 7
         "apercentile", TSDB_FUNC_APERCT, TSDB_FUNC_APERCT_DST,
-        TSDB_FUNCSTATE_SO | TSDB_FUNCSTATE_STREAM | TSDB_FUNCSTATE_OF, function_setup, apercentile_function,
+        TSDB_FUNCSTATE_SO | TSDB_FUNCSTATE_STREAM | TSDB_FUNCSTATE_OF, apercentile_function_setup, apercentile_function,
         apercentile_function_f, no_next_step, apercentile_finalizer, noop, noop, data_req_load_info,
     },
     {
@@ -4686,4 +4994,20 @@ SQLAggFuncElem aAggs[36] = {
         interp_function,
         sum_function_f,  // todo filter handle
         no_next_step, noop, noop, copy_function, no_data_info,
+    },
+    {
+        // 36
+        "stddev_dst", TSDB_FUNC_STDDEV_DST, TSDB_FUNC_STDDEV_DST, TSDB_BASE_FUNC_SO, stddev_function_setup,
+        stddev_dist_intern_function, stddev_dist_intern_function_f, no_next_step, stddev_finalizer, stddev_dist_merge,
+        stddev_dist_second_merge, data_req_load_info,
+    },
+    {
+        // 37
+        "hyperloglog", TSDB_FUNC_HLL, TSDB_FUNC_HLL_DST, TSDB_BASE_FUNC_SO, hll_function_setup, hll_function,
+        hll_function_f, no_next_step, hll_finalizer, noop, noop, data_req_load_info,
+    },
+    {
+        // 38
+        "hyperloglog_dst", TSDB_FUNC_HLL_DST, TSDB_FUNC_HLL_DST, TSDB_BASE_FUNC_SO, hll_function_setup, hll_function,
+        hll_function_f, no_next_step, hll_finalizer, hll_dist_merge, hll_dist_second_merge, data_req_load_info,
     }};
@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ihash.h"
+#include "taos.h"
+#include "tlog.h"
+#include "tsched.h"
+#include "tscUtil.h"
+#include "tsclient.h"
+#include "ttimer.h"
+#include "tutil.h"
+
+/*
+ * client insert buffer
+ *
+ * Rows of insert statements submitted by taos_insert_buffered are parsed in the caller thread and appended to the
+ * data block of each table. The buffered blocks are flushed once the size of buffered rows exceeds insertBufSize,
+ * or insertBufTime elapses after the first row is buffered, or taos_flush_insert is called. Each flush merges the
+ * table blocks according to vnode and sends one submit message per vnode, then the callback of each buffered
+ * request is invoked with the number of rows it inserted, or the error code of the vnodes it touched.
+ */
+typedef struct {
+  void (*fp)(void *param, TAOS_RES *, int code);
+  void *   param;
+  int32_t  numOfRows;
+  int32_t  numOfVgroups;
+  int32_t *vgid;
+} SInsertBufReq;
+
+struct SInsertBuffer;
+
+typedef struct {
+  struct SInsertBuffer *pBuffer;
+  STscObj *             pObj;
+  SDataBlockList *      pTableBlocks;
+  int32_t               numOfReqs;
+  SInsertBufReq *       pReqs;
+  int32_t               numOfVgroups;
+  int32_t *             pVgid;    // vgroup of each merged data block
+  int32_t *             pCode;    // result of each merged data block
+  int32_t *             pResult;  // optional, result of the batch, set when completed
+} SInsertBatch;
+
+typedef struct SInsertBuffer {
+  pthread_mutex_t mutex;
+  pthread_cond_t  flushCond;      // signaled when a batch is completed, or the timer is processed
+  int32_t         numOfFlushing;  // batches that are scheduled but not completed yet
+  int8_t          closing;
+  void *          pTimer;
+  STscObj *       pObj;
+
+  void *          pTableHashList;  // uid -> data block of table
+  SDataBlockList *pTableBlocks;
+  int32_t         size;            // bytes of buffered rows
+  int32_t         numOfReqs;
+  int32_t         nAllocReqs;
+  SInsertBufReq * pReqs;
+} SInsertBuffer;
+
+extern void *tscQhandle;
+
+static void tscProcessInsertBufferTimer(void *handle, void *tmrId);
+
+static SInsertBuffer *tscCreateInsertBuffer(STscObj *pObj) {
+  SInsertBuffer *pBuffer = calloc(1, sizeof(SInsertBuffer));
+  if (pBuffer == NULL) {
+    return NULL;
+  }
+
+  pBuffer->pObj = pObj;
+  pBuffer->pTableHashList = taosInitIntHash(128, POINTER_BYTES, taosHashInt);
+  pBuffer->pTableBlocks = tscCreateBlockArrayList();
+
+  pthread_mutex_init(&pBuffer->mutex, NULL);
+  pthread_cond_init(&pBuffer->flushCond, NULL);
+
+  return pBuffer;
+}
+
+static SInsertBuffer *tscGetInsertBuffer(STscObj *pObj) {
+  pthread_mutex_lock(&pObj->mutex);
+  if (pObj->pInsertBuf == NULL) {
+    pObj->pInsertBuf = tscCreateInsertBuffer(pObj);
+  }
+  pthread_mutex_unlock(&pObj->mutex);
+
+  return pObj->pInsertBuf;
+}
+
+static void tscFreeInsertBatch(SInsertBatch *pBatch) {
+  tscDestroyBlockArrayList(pBatch->pTableBlocks);
+
+  for (int32_t i = 0; i < pBatch->numOfReqs; ++i) {
+    tfree(pBatch->pReqs[i].vgid);
+  }
+
+  tfree(pBatch->pReqs);
+  tfree(pBatch->pVgid);
+  tfree(pBatch->pCode);
+  free(pBatch);
+}
+
+/* detach the buffered rows and requests as a batch, must be called with the buffer locked */
+static SInsertBatch *tscDetachInsertBatch(SInsertBuffer *pBuffer) {
+  if (pBuffer->numOfReqs == 0) {
+    return NULL;
+  }
+
+  SInsertBatch *pBatch = calloc(1, sizeof(SInsertBatch));
+  if (pBatch == NULL) {
+    return NULL;
+  }
+
+  pBatch->pBuffer = pBuffer;
+  pBatch->pObj = pBuffer->pObj;
+  pBatch->pTableBlocks = pBuffer->pTableBlocks;
+  pBatch->numOfReqs = pBuffer->numOfReqs;
+  pBatch->pReqs = pBuffer->pReqs;
+
+  taosCleanUpIntHash(pBuffer->pTableHashList);
+  pBuffer->pTableHashList = taosInitIntHash(128, POINTER_BYTES, taosHashInt);
+  pBuffer->pTableBlocks = tscCreateBlockArrayList();
+
+  pBuffer->size = 0;
+  pBuffer->numOfReqs = 0;
+  pBuffer->nAllocReqs = 0;
+  pBuffer->pReqs = NULL;
+
+  pBuffer->numOfFlushing++;
+  return pBatch;
+}
+
+static int32_t tscGetVgroupCode(int32_t vgid, int32_t *pVgid, int32_t *pCode, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    if (pVgid[i] == vgid) {
+      return pCode[i];
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/* the batch is released, and the threads waiting for the completion of batches are notified */
+static void tscCompleteInsertBatch(SInsertBatch *pBatch, int32_t code) {
+  SInsertBuffer *pBuffer = pBatch->pBuffer;
+  int32_t *      pResult = pBatch->pResult;
+
+  tscFreeInsertBatch(pBatch);
+
+  pthread_mutex_lock(&pBuffer->mutex);
+  if (pResult != NULL) {
+    *pResult = code;
+  }
+
+  pBuffer->numOfFlushing--;
+  pthread_cond_broadcast(&pBuffer->flushCond);
+  pthread_mutex_unlock(&pBuffer->mutex);
+}
+
+static void tscNotifyInsertBatchError(SInsertBatch *pBatch, int32_t code) {
+  for (int32_t i = 0; i < pBatch->numOfReqs; ++i) {
+    if (pBatch->pReqs[i].fp != NULL) {
+      (*pBatch->pReqs[i].fp)(pBatch->pReqs[i].param, NULL, -code);
+    }
+  }
+
+  tscCompleteInsertBatch(pBatch, code);
+}
+
+/* invoked after the data blocks of all vgroups are submitted, the sql object is released afterwards */
+static void tscInsertBatchCallBack(void *param, TAOS_RES *tres, int code) {
+  SInsertBatch *pBatch = (SInsertBatch *)param;
+
+  tscTrace("%p insert buffer is flushed, requests:%d, vgroups:%d, code:%d", tres, pBatch->numOfReqs,
+           pBatch->numOfVgroups, code);
+
+  for (int32_t i = 0; i < pBatch->numOfReqs; ++i) {
+    SInsertBufReq *pReq = &pBatch->pReqs[i];
+
+    int32_t ret = TSDB_CODE_SUCCESS;
+    for (int32_t j = 0; j < pReq->numOfVgroups && ret == TSDB_CODE_SUCCESS; ++j) {
+      ret = tscGetVgroupCode(pReq->vgid[j], pBatch->pVgid, pBatch->pCode, pBatch->numOfVgroups);
+    }
+
+    if (pReq->fp != NULL) {
+      (*pReq->fp)(pReq->param, NULL, (ret != TSDB_CODE_SUCCESS) ? -ret : pReq->numOfRows);
+    }
+  }
+
+  tscCompleteInsertBatch(pBatch, (code < 0) ? -code : TSDB_CODE_SUCCESS);
+}
+
+/*
+ * the batch is submitted asynchronously, so the thread flushing it is never blocked by the submission, which
+ * is completed in the threads of tscQhandle as well.
+ */
+static void tscSubmitInsertBatch(SInsertBatch *pBatch) {
+  SSqlObj *pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    tscNotifyInsertBatchError(pBatch, TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pBatch->pObj;
+  pSql->fp = tscInsertBatchCallBack;
+  pSql->param = pBatch;
+  sem_init(&pSql->rspSem, 0, 0);
+  sem_init(&pSql->emptyRspSem, 0, 1);
+
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  if (tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pSql);
+    tscNotifyInsertBatchError(pBatch, TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->isInsertFromFile = 0;
+
+  // the table blocks are released in merge
+  tscMergeTableDataBlocks(pSql, pBatch->pTableBlocks);
+  pBatch->pTableBlocks = NULL;
+
+  SDataBlockList *pDataBlocks = pCmd->pDataBlocks;
+  pBatch->numOfVgroups = pDataBlocks->nSize;
+  pBatch->pVgid = calloc(pDataBlocks->nSize, sizeof(int32_t));
+  pBatch->pCode = calloc(pDataBlocks->nSize, sizeof(int32_t));
+
+  if (pBatch->pVgid == NULL || pBatch->pCode == NULL) {
+    tscFreeSqlObj(pSql);
+    tscNotifyInsertBatchError(pBatch, TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  for (int32_t i = 0; i < pBatch->numOfVgroups; ++i) {
+    pBatch->pVgid[i] = ((STableDataBlocks *)pDataBlocks->pData[i])->vgid;
+  }
+
+  // the data blocks of all vgroups are submitted concurrently, the result is handled in tscInsertBatchCallBack
+  tscLaunchMultiVnodesInsert(pSql, pBatch->pCode);
+}
+
+static void tscProcessInsertBatch(SSchedMsg *pMsg) {
+  tscSubmitInsertBatch((SInsertBatch *)pMsg->thandle);
+}
+
+static void tscScheduleInsertBatch(SInsertBuffer *pBuffer, SInsertBatch *pBatch) {
+  if (pBatch == NULL) {
+    return;
+  }
+
+  SSchedMsg schedMsg;
+  schedMsg.fp = tscProcessInsertBatch;
+  schedMsg.ahandle = pBuffer;
+  schedMsg.thandle = pBatch;
+  schedMsg.msg = NULL;
+  taosScheduleTask(tscQhandle, &schedMsg);
+}
+
+static void tscProcessInsertBufferTimer(void *handle, void *tmrId) {
+  SInsertBuffer *pBuffer = (SInsertBuffer *)handle;
+  if (pBuffer == NULL) return;
+
+  pthread_mutex_lock(&pBuffer->mutex);
+  if (pBuffer->pTimer != tmrId) {
+    pthread_mutex_unlock(&pBuffer->mutex);
+    return;
+  }
+
+  // the buffer is being destroyed, which waits for the timer being processed
+  pBuffer->pTimer = NULL;
+  SInsertBatch *pBatch = tscDetachInsertBatch(pBuffer);
+  if (pBuffer->closing) {
+    pthread_cond_broadcast(&pBuffer->flushCond);
+  }
+  pthread_mutex_unlock(&pBuffer->mutex);
+
+  tscScheduleInsertBatch(pBuffer, pBatch);
+}
+
+/*
+ * rows of the same table can be put into one submit block only if the schema of them is identical,
+ * and the client time and server time are not mixed up. The uid is checked as well, since the hash
+ * key is truncated from uid.
+ */
+static bool tscIsDataBlockCompatible(STableDataBlocks *pDst, STableDataBlocks *pSrc) {
+  SShellSubmitBlock *pDstBlock = (SShellSubmitBlock *)pDst->pData;
+  SShellSubmitBlock *pSrcBlock = (SShellSubmitBlock *)pSrc->pData;
+
+  if (pDstBlock->uid != pSrcBlock->uid || pDstBlock->sversion != pSrcBlock->sversion ||
+      pDst->rowSize != pSrc->rowSize) {
+    return false;
+  }
+
+  if (pDst->tsSource != -1 && pSrc->tsSource != -1 && pDst->tsSource != pSrc->tsSource) {
+    return false;
+  }
+
+  return pDstBlock->numOfRows + pSrcBlock->numOfRows <= INT16_MAX;
+}
+
+/* reserve the space of the rows to be appended, so that appending them never fails */
+static int32_t tscReserveDataBlockRows(STableDataBlocks *pDst, STableDataBlocks *pSrc) {
+  SShellSubmitBlock *pSrcBlock = (SShellSubmitBlock *)pSrc->pData;
+
+  size_t required = pDst->size + (size_t)pSrcBlock->numOfRows * pSrc->rowSize;
+  if (required <= pDst->nAllocSize) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  size_t nAllocSize = (pDst->nAllocSize < TSDB_PAYLOAD_SIZE) ? TSDB_PAYLOAD_SIZE : pDst->nAllocSize;
+  while (nAllocSize < required) {
+    nAllocSize = (size_t)(nAllocSize * 1.5);
+  }
+
+  char *tmp = realloc(pDst->pData, nAllocSize);
+  if (tmp == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pDst->pData = tmp;
+  pDst->nAllocSize = (uint32_t)nAllocSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void tscAppendDataBlockRows(STableDataBlocks *pDst, STableDataBlocks *pSrc) {
+  SShellSubmitBlock *pDstBlock = (SShellSubmitBlock *)pDst->pData;
+  SShellSubmitBlock *pSrcBlock = (SShellSubmitBlock *)pSrc->pData;
+
+  int32_t len = pSrcBlock->numOfRows * pSrc->rowSize;
+  assert(pDst->size + len <= pDst->nAllocSize);
+
+  if (pDst->ordered) {
+    TSKEY skey = *(TSKEY *)pSrcBlock->payLoad;
+    if (!pSrc->ordered || (pSrc->tsSource == TSDB_USE_CLI_TS && skey <= pDst->prevTS)) {
+      pDst->ordered = false;
+    }
+  }
+
+  memcpy(pDst->pData + pDst->size, pSrcBlock->payLoad, len);
+
+  pDst->size += len;
+  pDst->prevTS = pSrc->prevTS;
+  if (pDst->tsSource == -1) {
+    pDst->tsSource = pSrc->tsSource;
+  }
+
+  pDstBlock->numOfRows += pSrcBlock->numOfRows;
+}
+
+/* the request is built aside, and added into buffer only after its rows are buffered */
+static int32_t tscBuildBufferedRequest(SInsertBuffer *pBuffer, SInsertBufReq *pReq, SDataBlockList *pList,
+                                       void (*fp)(), void *param) {
+  if (pBuffer->numOfReqs >= pBuffer->nAllocReqs) {
+    int32_t        nAlloc = (pBuffer->nAllocReqs == 0) ? 64 : pBuffer->nAllocReqs << 1;
+    SInsertBufReq *tmp = realloc(pBuffer->pReqs, nAlloc * sizeof(SInsertBufReq));
+    if (tmp == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pBuffer->pReqs = tmp;
+    pBuffer->nAllocReqs = nAlloc;
+  }
+
+  memset(pReq, 0, sizeof(SInsertBufReq));
+
+  pReq->fp = fp;
+  pReq->param = param;
+  pReq->vgid = calloc(pList->nSize, sizeof(int32_t));
+  if (pReq->vgid == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < pList->nSize; ++i) {
+    STableDataBlocks *pDataBlock = pList->pData[i];
+    pReq->numOfRows += ((SShellSubmitBlock *)pDataBlock->pData)->numOfRows;
+
+    int32_t j = 0;
+    while (j < pReq->numOfVgroups && pReq->vgid[j] != pDataBlock->vgid) ++j;
+    if (j == pReq->numOfVgroups) {
+      pReq->vgid[pReq->numOfVgroups++] = pDataBlock->vgid;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/* move the parsed table blocks into insert buffer, the blocks that are taken over are removed from list */
+static int32_t tscMoveToInsertBuffer(SInsertBuffer *pBuffer, SDataBlockList *pList, void (*fp)(), void *param) {
+  SInsertBatch *pBatch[2] = {0};
+  int32_t       code = TSDB_CODE_SUCCESS;
+
+  pthread_mutex_lock(&pBuffer->mutex);
+
+  // flush the buffered rows first if the new rows can not be merged with them
+  for (int32_t i = 0; i < pList->nSize; ++i) {
+    STableDataBlocks * pDataBlock = pList->pData[i];
+    SShellSubmitBlock *pBlock = (SShellSubmitBlock *)pDataBlock->pData;
+
+    STableDataBlocks **p = (STableDataBlocks **)taosGetIntHashData(pBuffer->pTableHashList, pBlock->uid);
+    if (p != NULL && !tscIsDataBlockCompatible(*p, pDataBlock)) {
+      pBatch[0] = tscDetachInsertBatch(pBuffer);
+      break;
+    }
+  }
+
+  // nothing is buffered if any memory can not be allocated, so the request either fails or is buffered entirely
+  SInsertBufReq req;
+  code = tscBuildBufferedRequest(pBuffer, &req, pList, fp, param);
+
+  for (int32_t i = 0; i < pList->nSize && code == TSDB_CODE_SUCCESS; ++i) {
+    STableDataBlocks * pDataBlock = pList->pData[i];
+    SShellSubmitBlock *pBlock = (SShellSubmitBlock *)pDataBlock->pData;
+
+    STableDataBlocks **p = (STableDataBlocks **)taosGetIntHashData(pBuffer->pTableHashList, pBlock->uid);
+    if (p != NULL) {
+      code = tscReserveDataBlockRows(*p, pDataBlock);
+    }
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tfree(req.vgid);
+    pthread_mutex_unlock(&pBuffer->mutex);
+    tscScheduleInsertBatch(pBuffer, pBatch[0]);
+    return code;
+  }
+
+  for (int32_t i = 0; i < pList->nSize; ++i) {
+    STableDataBlocks * pDataBlock = pList->pData[i];
+    SShellSubmitBlock *pBlock = (SShellSubmitBlock *)pDataBlock->pData;
+
+    pBuffer->size += pBlock->numOfRows * pDataBlock->rowSize;
+
+    STableDataBlocks **p = (STableDataBlocks **)taosGetIntHashData(pBuffer->pTableHashList, pBlock->uid);
+    if (p == NULL) {
+      taosAddIntHash(pBuffer->pTableHashList, pBlock->uid, (char *)&pDataBlock);
+      tscAppendDataBlock(pBuffer->pTableBlocks, pDataBlock);
+      pList->pData[i] = NULL;
+    } else {
+      tscAppendDataBlockRows(*p, pDataBlock);
+    }
+  }
+
+  pBuffer->pReqs[pBuffer->numOfReqs++] = req;
+
+  if (pBuffer->size >= tsInsertBufferSize) {
+    pBatch[1] = tscDetachInsertBatch(pBuffer);
+  } else if (pBuffer->pTimer == NULL) {
+    taosTmrReset(tscProcessInsertBufferTimer, tsInsertBufferTime, pBuffer, tscTmr, &pBuffer->pTimer);
+  }
+
+  pthread_mutex_unlock(&pBuffer->mutex);
+
+  // schedule the flush out of lock, since the flushing thread acquires the lock when completed
+  tscScheduleInsertBatch(pBuffer, pBatch[0]);
+  tscScheduleInsertBatch(pBuffer, pBatch[1]);
+  return code;
+}
+
+int taos_insert_buffered(TAOS *taos, char *sqlstr, void (*fp)(void *param, TAOS_RES *, int code), void *param) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  int32_t sqlLen = strlen(sqlstr);
+  if (sqlLen > TSDB_MAX_SQL_LEN) {
+    tscError("sql string too long");
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  SInsertBuffer *pBuffer = tscGetInsertBuffer(pObj);
+  if (pBuffer == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  SSqlObj *pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pObj;
+  sem_init(&pSql->rspSem, 0, 0);
+  sem_init(&pSql->emptyRspSem, 0, 1);
+
+  SSqlCmd *pCmd = &pSql->cmd;
+  int32_t  code = TSDB_CODE_SUCCESS;
+
+  pSql->sqlstr = malloc(sqlLen + 1);
+  if (pSql->sqlstr == NULL || tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pSql);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  strtolower(pSql->sqlstr, sqlstr);
+  tscTrace("%p buffered SQL: %s, pObj:%p", pSql, pSql->sqlstr, pObj);
+
+  if (!tscIsInsertOrImportData(pSql->sqlstr)) {
+    code = TSDB_CODE_INVALID_SQL;
+  } else {
+    tscCleanSqlCmd(pCmd);
+    pCmd->isInsertBuffered = 1;
+
+    code = tsParseInsertSql(pSql, pSql->sqlstr, pObj->acctId, pObj->db);
+    if (code == TSDB_CODE_SUCCESS && pCmd->isInsertFromFile == 1) {
+      code = TSDB_CODE_INVALID_SQL;
+    }
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscMoveToInsertBuffer(pBuffer, pCmd->pDataBlocks, fp, param);
+  } else {
+    tscTrace("%p failed to parse buffered SQL, code:%d", pSql, code);
+  }
+
+  tscFreeSqlObj(pSql);
+  return code;
+}
+
+int taos_flush_insert(TAOS *taos) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  SInsertBuffer *pBuffer = pObj->pInsertBuf;
+  if (pBuffer == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  pthread_mutex_lock(&pBuffer->mutex);
+  SInsertBatch *pBatch = tscDetachInsertBatch(pBuffer);
+  if (pBatch != NULL) {
+    pBatch->pResult = &code;
+  }
+  pthread_mutex_unlock(&pBuffer->mutex);
+
+  if (pBatch != NULL) {
+    tscSubmitInsertBatch(pBatch);
+  }
+
+  // wait for the batch above, and the batches flushed by other threads
+  pthread_mutex_lock(&pBuffer->mutex);
+  while (pBuffer->numOfFlushing > 0) {
+    pthread_cond_wait(&pBuffer->flushCond, &pBuffer->mutex);
+  }
+  pthread_mutex_unlock(&pBuffer->mutex);
+
+  return code;
+}
+
+void tscDestroyInsertBuffer(STscObj *pObj) {
+  SInsertBuffer *pBuffer = pObj->pInsertBuf;
+  if (pBuffer == NULL) {
+    return;
+  }
+
+  taos_flush_insert(pObj);
+
+  /*
+   * the timer is reset to NULL if it is stopped. Otherwise it has been fired, and its callback is blocked by the
+   * lock, so wait until the callback is done and the batch it detached is completed, before the buffer is freed.
+   */
+  pthread_mutex_lock(&pBuffer->mutex);
+  pBuffer->closing = 1;
+  taosTmrStopA(&pBuffer->pTimer);
+  while (pBuffer->pTimer != NULL || pBuffer->numOfFlushing > 0) {
+    pthread_cond_wait(&pBuffer->flushCond, &pBuffer->mutex);
+  }
+  pthread_mutex_unlock(&pBuffer->mutex);
+
+  pObj->pInsertBuf = NULL;
+
+  taosCleanUpIntHash(pBuffer->pTableHashList);
+  tscDestroyBlockArrayList(pBuffer->pTableBlocks);
+  tfree(pBuffer->pReqs);
+
+  pthread_cond_destroy(&pBuffer->flushCond);
+  pthread_mutex_destroy(&pBuffer->mutex);
+  free(pBuffer);
+}
@@ -254,6 +254,9 @@ static int32_t tscProcessDescribeTable(SSqlObj *pSql) {
   int32_t rowLen =
       tscBuildMeterSchemaResultFields(pSql, NUM_OF_DESCRIBE_TABLE_COLUMNS, TYPE_COLUMN_LENGTH, note_field_length);
   tscFieldInfoCalOffset(&pSql->cmd);
+
+  // time precision of the database the table belongs to, available by taos_result_precision
+  pSql->res.precision = pSql->cmd.pMeterMeta->precision;
   return tscSetValueToResObj(pSql, rowLen);
 }
 
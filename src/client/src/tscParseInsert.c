@@ -36,6 +36,7 @@
 
 #include "ihash.h"
 #include "os.h"
+#include "tcache.h"
 #include "tscSecondaryMerge.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
@@ -46,6 +47,13 @@
 #include "tlog.h"
 #include "tstoken.h"
 #include "ttime.h"
+#include "ttimer.h"
+
+// max times of batch retrieval of meter meta in parsing an async insert sql
+#define TSDB_MAX_META_PREFETCH 2
+
+// delay of each retry of the failed sub-insertions, in milliseconds
+#define TSC_INSERT_RETRY_DELAY 500
 
 #define INVALID_SQL_RET_MSG(p, ...) \
   do {                              \
@@ -53,10 +61,6 @@
     return TSDB_CODE_INVALID_SQL;   \
   } while (0)
 
-static enum {
-  TSDB_USE_SERVER_TS = 0,
-  TSDB_USE_CLI_TS = 1,
-};
 
 static void setErrMsg(char *msg, char *sql);
 static int32_t tscAllocateMemIfNeed(STableDataBlocks *pDataBlock, int32_t rowSize);
@@ -200,8 +204,35 @@ static int32_t tsCheckTimestamp(STableDataBlocks* pDataBlocks, const char* start
   return TSDB_CODE_SUCCESS;
 }
 
-int32_t tsParseOneColumnData(SSchema *pSchema, char *value, int valuelen, char *payload, char *msg, char **str,
-                             bool primaryKey, int16_t timePrec) {
+/*
+ * the doubled quotes kept in the string quoted by quote are collapsed into a copy, which is freed by caller.
+ * The sql is not changed in place, since it may be parsed more than once. NULL is returned if nothing to collapse
+ */
+static char *tsCollapseQuotes(char quote, char **value, int *valuelen) {
+  if (quote == 0 || memchr(*value, quote, (size_t)*valuelen) == NULL) {
+    return NULL;
+  }
+
+  char *buf = malloc((size_t)*valuelen);
+  if (buf == NULL) {
+    return NULL;
+  }
+
+  int len = 0;
+  for (int i = 0; i < *valuelen; ++i) {
+    if ((*value)[i] == quote && i + 1 < *valuelen && (*value)[i + 1] == quote) {
+      ++i;
+    }
+    buf[len++] = (*value)[i];
+  }
+
+  *value = buf;
+  *valuelen = len;
+  return buf;
+}
+
+int32_t tsParseOneColumnData(SSchema *pSchema, char *value, int valuelen, char quote, char *payload, char *msg,
+                             char **str, bool primaryKey, int16_t timePrec) {
   int64_t temp;
   int32_t nullInt = *(int32_t *)TSDB_DATA_NULL_STR_L;
   char *  endptr = NULL;
@@ -340,9 +371,12 @@ int32_t tsParseOneColumnData(SSchema *pSchema, char *value, int valuelen, char *
       if (valuelen == 4 && nullInt == *(int32_t *)value) {
         *payload = TSDB_DATA_BINARY_NULL;
       } else {
+        char *collapsed = tsCollapseQuotes(quote, &value, &valuelen);
+
         /* truncate too long string */
         if (valuelen > pSchema->bytes) valuelen = pSchema->bytes;
         strncpy(payload, value, valuelen);
+        free(collapsed);
       }
 
       break;
@@ -351,7 +385,11 @@ int32_t tsParseOneColumnData(SSchema *pSchema, char *value, int valuelen, char *
       if (valuelen == 4 && nullInt == *(int32_t *)value) {
         *(uint32_t *)payload = TSDB_DATA_NCHAR_NULL;
       } else {
-        if (!taosMbsToUcs4(value, valuelen, payload, pSchema->bytes)) {
+        char *collapsed = tsCollapseQuotes(quote, &value, &valuelen);
+        bool  converted = taosMbsToUcs4(value, valuelen, payload, pSchema->bytes);
+        free(collapsed);
+
+        if (!converted) {
           sprintf(msg, "%s", strerror(errno));
           return TSDB_CODE_INVALID_SQL;
         }
@@ -394,6 +432,7 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
                       int16_t timePrec) {
   char *value = NULL;
   int   valuelen = 0;
+  char  quote = 0;
 
   char *payload = pDataBlocks->pData + pDataBlocks->size;
 
@@ -407,7 +446,7 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
 
     int sign = 0;
   _again:
-    *str = tscGetToken(*str, &value, &valuelen);
+    *str = tscGetQuotedToken(*str, &value, &valuelen, &quote);
     if ((valuelen == 0 && value == NULL) || (valuelen == 1 && value[0] == ')')) {
       setErrMsg(error, *str);
       return -1;
@@ -426,7 +465,7 @@ int tsParseOneRowData(char **str, STableDataBlocks *pDataBlocks, SSchema schema[
     }
 
     bool isPrimaryKey = (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX);
-    int32_t ret = tsParseOneColumnData(&schema[colIndex], value, valuelen, start, error, str,
+    int32_t ret = tsParseOneColumnData(&schema[colIndex], value, valuelen, quote, start, error, str,
                                        colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX, timePrec);
     if (ret != TSDB_CODE_SUCCESS) {
       return -1;  // NOTE: here 0 mean error!
@@ -566,7 +605,7 @@ int32_t tscAllocateMemIfNeed(STableDataBlocks *pDataBlock, int32_t rowSize) {
   return (int32_t)(pDataBlock->nAllocSize - pDataBlock->size) / rowSize;
 }
 
-static void tsSetBlockInfo(SShellSubmitBlock *pBlocks, const SMeterMeta *pMeterMeta, int32_t numOfRows) {
+void tsSetBlockInfo(SShellSubmitBlock *pBlocks, const SMeterMeta *pMeterMeta, int32_t numOfRows) {
   pBlocks->sid = pMeterMeta->sid;
   pBlocks->uid = pMeterMeta->uid;
   pBlocks->sversion = pMeterMeta->sversion;
@@ -616,6 +655,62 @@ void sortRemoveDuplicates(STableDataBlocks *dataBuf) {
   }
 }
 
+/*
+ * parse the column list of insert statement: tablename(col1, col2,..., coln) values(v1, v2,... vn),
+ * the leading '(' of the column list has been consumed by caller.
+ */
+static int32_t tscParseBoundColumns(char **str, SMeterMeta *pMeterMeta, SParsedDataColInfo *spd, char *msg) {
+  SSchema *pSchema = tsGetSchema(pMeterMeta);
+  char *   id = NULL;
+  int      idlen = 0;
+
+  spd->numOfCols = pMeterMeta->numOfColumns;
+
+  int16_t offset[TSDB_MAX_COLUMNS] = {0};
+  for (int32_t t = 1; t < pMeterMeta->numOfColumns; ++t) {
+    offset[t] = offset[t - 1] + pSchema[t - 1].bytes;
+  }
+
+  while (1) {
+    *str = tscGetToken(*str, &id, &idlen);
+    if (idlen == 1 && id[0] == ')') {
+      break;
+    }
+
+    bool findColumnIndex = false;
+
+    // todo speedup by using hash list
+    for (int32_t t = 0; t < pMeterMeta->numOfColumns; ++t) {
+      if (strncmp(id, pSchema[t].name, idlen) == 0 && strlen(pSchema[t].name) == idlen) {
+        SParsedColElem *pElem = &spd->elems[spd->numOfAssignedCols++];
+        pElem->offset = offset[t];
+        pElem->colIndex = t;
+
+        if (spd->hasVal[t] == true) {
+          sprintf(msg, "duplicated column name");
+          return TSDB_CODE_INVALID_SQL;
+        }
+
+        spd->hasVal[t] = true;
+        findColumnIndex = true;
+        break;
+      }
+    }
+
+    if (!findColumnIndex) {
+      sprintf(msg, "invalid column name");
+      return TSDB_CODE_INVALID_SQL;
+    }
+  }
+
+  if (spd->numOfAssignedCols == 0 || spd->numOfAssignedCols > pMeterMeta->numOfColumns) {
+    sprintf(msg, "column name expected");
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableHashList, char **str, SParsedDataColInfo *spd,
                                       int32_t *totalNum) {
   SSqlCmd *   pCmd = &pSql->cmd;
@@ -646,6 +741,240 @@ static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableHashList, char
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * parse the tag values of "tags(v1, v2, ...)" according to the tag schema of super table
+ */
+static int32_t tscParseTagValues(char **sqlstr, SMeterMeta *pMetricMeta, char *tagVal, char *msg) {
+  char *  id = NULL;
+  int32_t idlen = 0;
+  char *  sql = *sqlstr;
+
+  SSchema *pTagSchema = tsGetTagSchema(pMetricMeta);
+
+  sql = tscGetToken(sql, &id, &idlen);
+  if (!(strncmp(id, "tags", idlen) == 0 && idlen == 4)) {
+    setErrMsg(msg, sql);
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  int32_t numOfTagValues = 0;
+  char    quote = 0;
+  while (1) {
+    sql = tscGetQuotedToken(sql, &id, &idlen, &quote);
+    if (idlen == 0) {
+      break;
+    } else if (idlen == 1) {
+      if (id[0] == '(') {
+        continue;
+      }
+
+      if (id[0] == ')') {
+        break;
+      }
+
+      if (id[0] == '-' || id[0] == '+') {
+        sql = tscGetQuotedToken(sql, &id, &idlen, &quote);
+
+        id -= 1;
+        idlen += 1;
+      }
+    }
+
+    if (numOfTagValues >= pMetricMeta->numOfTags) {
+      setErrMsg(msg, sql);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    int32_t code = tsParseOneColumnData(&pTagSchema[numOfTagValues], id, idlen, quote, tagVal, msg, &sql, false,
+                                        pMetricMeta->precision);
+    if (code != TSDB_CODE_SUCCESS) {
+      setErrMsg(msg, sql);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    tagVal += pTagSchema[numOfTagValues++].bytes;
+  }
+
+  if (numOfTagValues != pMetricMeta->numOfTags) {
+    setErrMsg(msg, sql);
+    return TSDB_CODE_INVALID_SQL;
+  }
+
+  *sqlstr = sql;
+  return TSDB_CODE_SUCCESS;
+}
+
+/* skip the tokens until the matched right parenthesis, the left one has been consumed */
+static char *tscSkipParenthesis(char *sql) {
+  char *id = NULL;
+  int   idlen = 0;
+
+  while (1) {
+    sql = tscGetToken(sql, &id, &idlen);
+
+    // the quoted string ")" is not the end of parenthesis
+    if (idlen == 0 || (idlen == 1 && id[0] == ')' && id[-1] != '\'' && id[-1] != '"')) {
+      return sql;
+    }
+  }
+}
+
+/* skip the values of "(v1, v2, ...) (v1, v2, ...)" */
+static char *tscSkipValues(char *sql) {
+  char *id = NULL;
+  int   idlen = 0;
+
+  while (1) {
+    char *next = tscGetToken(sql, &id, &idlen);
+    if (idlen != 1 || id[0] != '(') {
+      return sql;
+    }
+
+    sql = tscSkipParenthesis(next);
+  }
+}
+
+/*
+ * collect the meters in the rest of insert sql whose meter meta are absent in cache. The super tables in
+ * USING clause are collected if absent, and the meters created from them are deferred to next round,
+ * since the tag values can not be parsed without the tag schema.
+ */
+static int32_t tscCollectMeterInfo(SSqlObj *pSql, char *sql, SMultiMeterInfoBuf *pBuf, int32_t *numOfDeferred) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  char *   id = NULL;
+  int      idlen = 0;
+  char     meterId[TSDB_METER_ID_LEN] = {0};
+  char     msg[256] = {0};
+
+  *numOfDeferred = 0;
+
+  while (pBuf->numOfMeters < TSDB_MAX_METERS_IN_MULTI_META) {
+    sql = tscGetToken(sql, &id, &idlen);
+    if (idlen == 0 || validateTableName(id, idlen) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    SSQLToken token = {idlen, TK_ID, id};
+    if (setMeterID(pSql, &token) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    strcpy(meterId, pCmd->name);
+
+    sql = tscGetToken(sql, &id, &idlen);
+    if (idlen == 1 && id[0] == '(') {  // column list
+      sql = tscSkipParenthesis(sql);
+      sql = tscGetToken(sql, &id, &idlen);
+    }
+
+    if (idlen == 5 && strncmp(id, "using", 5) == 0) {
+      sql = tscGetToken(sql, &id, &idlen);
+
+      SSQLToken metricToken = {idlen, TK_ID, id};
+      if (setMeterID(pSql, &metricToken) != TSDB_CODE_SUCCESS) {
+        break;
+      }
+
+      SMeterMeta *pMetricMeta = (SMeterMeta *)taosGetDataFromCache(tscCacheHandle, pCmd->name);
+      if (pMetricMeta == NULL) {
+        tscAddMeterInfo(pBuf, pCmd->name, NULL);
+        (*numOfDeferred)++;
+
+        sql = tscGetToken(sql, &id, &idlen);  // tags
+        sql = tscGetToken(sql, &id, &idlen);  // left parenthesis
+        sql = tscSkipParenthesis(sql);
+      } else {
+        STagData tag = {{0}};
+        strcpy(tag.name, pCmd->name);
+
+        int32_t code = TSDB_CODE_INVALID_SQL;
+        if (pMetricMeta->meterType == TSDB_METER_METRIC) {
+          code = tscParseTagValues(&sql, pMetricMeta, tag.data, msg);
+        }
+
+        taosRemoveDataFromCache(tscCacheHandle, (void **)&pMetricMeta, false);
+
+        // the error is reported in parsing sql
+        if (code != TSDB_CODE_SUCCESS) {
+          break;
+        }
+
+        if (!tscIsMeterMetaInCache(meterId)) {
+          tscAddMeterInfo(pBuf, meterId, &tag);
+        }
+      }
+
+      sql = tscGetToken(sql, &id, &idlen);
+      if (idlen == 1 && id[0] == '(') {
+        sql = tscSkipParenthesis(sql);
+        sql = tscGetToken(sql, &id, &idlen);
+      }
+    } else if (!tscIsMeterMetaInCache(meterId)) {
+      tscAddMeterInfo(pBuf, meterId, NULL);
+    }
+
+    if (idlen == 6 && strncmp(id, "values", 6) == 0) {
+      sql = tscSkipValues(sql);
+    } else if (idlen == 4 && strncmp(id, "file", 4) == 0) {
+      sql = tscGetTokenDelimiter(sql, &id, &idlen, " ;");
+    } else {
+      break;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * retrieve the meter meta of all tables in the rest of insert sql in batch, instead of one by one
+ * during parse, when the meter meta of a table is absent in cache. The meters are created on demand
+ * from the super table in USING clause. Errors are not reported here, the meters that failed to
+ * retrieve meter meta are handled by the following tscGetMeterMeta.
+ *
+ * For async insertion, the multi-meter-meta msg is sent asynchronously, and the sql is parsed again
+ * in tscMeterMetaCallBack.
+ */
+static int32_t tscPrefetchMeterMeta(SSqlObj *pSql, char *str) {
+  // the token may be modified during tokenize, so a copy of the sql string is used
+  char *sql = strdup(str);
+  if (sql == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  SMultiMeterInfoBuf buf = {0};
+  int32_t            code = TSDB_CODE_SUCCESS;
+  void *             fp = pSql->fp;
+
+  /*
+   * the meters already retrieved are not collected again, so the loop ends when all meters, including
+   * the deferred ones, are retrieved or failed
+   */
+  while (1) {
+    int32_t numOfDeferred = 0;
+    tscCollectMeterInfo(pSql, sql, &buf, &numOfDeferred);
+
+    if (buf.numOfMeters == 0) {
+      break;
+    }
+
+    if (fp != NULL) {
+      // the data blocks must be released before the meter meta callback function is invoked by another thread
+      tscfreeSqlCmdData(&pSql->cmd);
+      pSql->prefetch++;
+    }
+
+    code = tscGetMeterMetaInBatch(pSql, &buf);
+    if (fp != NULL || code != TSDB_CODE_SUCCESS) {
+      break;
+    }
+  }
+
+  tscDestroyMultiMeterInfoBuf(&buf);
+  free(sql);
+
+  return code;
+}
+
 static int32_t tscParseSqlForCreateTableOnDemand(char **sqlstr, SSqlObj *pSql) {
   char *  id = NULL;
   int32_t idlen = 0;
@@ -708,50 +1037,9 @@ static int32_t tscParseSqlForCreateTableOnDemand(char **sqlstr, SSqlObj *pSql) {
       return TSDB_CODE_INVALID_SQL;
     }
 
-    char *   tagVal = pTag->data;
-    SSchema *pTagSchema = tsGetTagSchema(pCmd->pMeterMeta);
-
-    sql = tscGetToken(sql, &id, &idlen);
-    if (!(strncmp(id, "tags", idlen) == 0 && idlen == 4)) {
-      setErrMsg(pCmd->payload, sql);
-      return TSDB_CODE_INVALID_SQL;
-    }
-
-    int32_t numOfTagValues = 0;
-    while (1) {
-      sql = tscGetToken(sql, &id, &idlen);
-      if (idlen == 0) {
-        break;
-      } else if (idlen == 1) {
-        if (id[0] == '(') {
-          continue;
-        }
-
-        if (id[0] == ')') {
-          break;
-        }
-
-        if (id[0] == '-' || id[0] == '+') {
-          sql = tscGetToken(sql, &id, &idlen);
-
-          id -= 1;
-          idlen += 1;
-        }
-      }
-
-      code = tsParseOneColumnData(&pTagSchema[numOfTagValues], id, idlen, tagVal, pCmd->payload, &sql, false,
-                                  pCmd->pMeterMeta->precision);
-      if (code != TSDB_CODE_SUCCESS) {
-        setErrMsg(pCmd->payload, sql);
-        return TSDB_CODE_INVALID_SQL;
-      }
-
-      tagVal += pTagSchema[numOfTagValues++].bytes;
-    }
-
-    if (numOfTagValues != pCmd->pMeterMeta->numOfTags) {
-      setErrMsg(pCmd->payload, sql);
-      return TSDB_CODE_INVALID_SQL;
+    code = tscParseTagValues(&sql, pCmd->pMeterMeta, pTag->data, pCmd->payload);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
     }
 
     if (tscValidateName(&tableToken) != TSDB_CODE_SUCCESS) {
@@ -835,6 +1123,7 @@ int tsParseInsertStatement(SSqlObj *pSql, char *str, char *acct, char *db) {
   }
 
   void *pTableHashList = taosInitIntHash(128, sizeof(void *), taosHashInt);
+  bool  prefetched = false;
 
   pSql->cmd.pDataBlocks = tscCreateBlockArrayList();
   tscTrace("%p create data block list for submit data, %p", pSql, pSql->cmd.pDataBlocks);
@@ -869,6 +1158,24 @@ int tsParseInsertStatement(SSqlObj *pSql, char *str, char *acct, char *db) {
     }
 
     void *fp = pSql->fp;
+
+    /*
+     * retrieve the meter meta of the rest tables in batch when the first absent one is met, the times
+     * of batch retrieval of async insertion are limited, since the sql is parsed again after retrieval
+     */
+    if (!prefetched && (fp == NULL || pSql->prefetch < TSDB_MAX_META_PREFETCH) && !tscIsMeterMetaInCache(pCmd->name)) {
+      prefetched = true;
+
+      code = tscPrefetchMeterMeta(pSql, str);
+      if (code == TSDB_CODE_ACTION_IN_PROGRESS) {
+        goto _clean;
+      } else if (code != TSDB_CODE_SUCCESS && fp != NULL) {  // data blocks have been released
+        goto _error_clean;
+      }
+
+      setMeterID(pSql, &token);
+    }
+
     if ((code = tscParseSqlForCreateTableOnDemand(&str, pSql)) != TSDB_CODE_SUCCESS) {
       if (fp != NULL) {
         goto _clean;
@@ -960,7 +1267,6 @@ int tsParseInsertStatement(SSqlObj *pSql, char *str, char *acct, char *db) {
     } else if (idlen == 1 && id[0] == '(') {
       /* insert into tablename(col1, col2,..., coln) values(v1, v2,... vn); */
       SMeterMeta *pMeterMeta = pCmd->pMeterMeta;
-      SSchema *   pSchema = tsGetSchema(pMeterMeta);
 
       if (pCmd->isInsertFromFile == -1) {
         pCmd->isInsertFromFile = 0;
@@ -971,50 +1277,7 @@ int tsParseInsertStatement(SSqlObj *pSql, char *str, char *acct, char *db) {
       }
 
       SParsedDataColInfo spd = {0};
-      spd.numOfCols = pMeterMeta->numOfColumns;
-
-      int16_t offset[TSDB_MAX_COLUMNS] = {0};
-      for (int32_t t = 1; t < pMeterMeta->numOfColumns; ++t) {
-        offset[t] = offset[t - 1] + pSchema[t - 1].bytes;
-      }
-
-      while (1) {
-        str = tscGetToken(str, &id, &idlen);
-        if (idlen == 1 && id[0] == ')') {
-          break;
-        }
-
-        bool findColumnIndex = false;
-
-        // todo speedup by using hash list
-        for (int32_t t = 0; t < pMeterMeta->numOfColumns; ++t) {
-          if (strncmp(id, pSchema[t].name, idlen) == 0 && strlen(pSchema[t].name) == idlen) {
-            SParsedColElem *pElem = &spd.elems[spd.numOfAssignedCols++];
-            pElem->offset = offset[t];
-            pElem->colIndex = t;
-
-            if (spd.hasVal[t] == true) {
-              code = TSDB_CODE_INVALID_SQL;
-              sprintf(pCmd->payload, "duplicated column name");
-              goto _error_clean;
-            }
-
-            spd.hasVal[t] = true;
-            findColumnIndex = true;
-            break;
-          }
-        }
-
-        if (!findColumnIndex) {  //
-          code = TSDB_CODE_INVALID_SQL;
-          sprintf(pCmd->payload, "invalid column name");
-          goto _error_clean;
-        }
-      }
-
-      if (spd.numOfAssignedCols == 0 || spd.numOfAssignedCols > pMeterMeta->numOfColumns) {
-        code = TSDB_CODE_INVALID_SQL;
-        sprintf(pCmd->payload, "column name expected");
+      if ((code = tscParseBoundColumns(&str, pMeterMeta, &spd, pCmd->payload)) != TSDB_CODE_SUCCESS) {
         goto _error_clean;
       }
 
@@ -1036,6 +1299,12 @@ int tsParseInsertStatement(SSqlObj *pSql, char *str, char *acct, char *db) {
     }
   }
 
+  // the data blocks of each table are merged by the client insert buffer later
+  if (pCmd->isInsertBuffered) {
+    code = TSDB_CODE_SUCCESS;
+    goto _clean;
+  }
+
   // submit to more than one vnode
   if (pCmd->pDataBlocks->nSize > 0) {
     // merge according to vgid
@@ -1092,33 +1361,430 @@ int tsParseInsertSql(SSqlObj *pSql, char *sql, char *acct, char *db) {
   return code;
 }
 
-int tsParseSql(SSqlObj *pSql, char *acct, char *db, bool multiVnodeInsertion) {
-  int32_t ret = TSDB_CODE_SUCCESS;
-  tscCleanSqlCmd(&pSql->cmd);
-
-  if (tscIsInsertOrImportData(pSql->sqlstr)) {
-    /*
-     * only for async multi-vnode insertion
-     * Set the fp before parse the sql string, in case of getmetermeta failed, in which
-     * the error handle callback function can rightfully restore the user defined function (fp)
-     */
-    if (pSql->fp != NULL && multiVnodeInsertion) {
-      assert(pSql->fetchFp == NULL);
-      pSql->fetchFp = pSql->fp;
-
-      /* replace user defined callback function with multi-insert proxy function */
-      pSql->fp = tscAsyncInsertMultiVnodesProxy;
-    }
-
-    ret = tsParseInsertSql(pSql, pSql->sqlstr, acct, db);
-  } else {
-    SSqlInfo SQLInfo = {0};
-    tSQLParse(&SQLInfo, pSql->sqlstr);
+/*
+ * parse the insert statement of a prepared statement, which has the form of
+ * insert into tablename [(col1, col2,...)] [using metric tags(...)] values(?, ?, ...)
+ * The table meta is retrieved during parse, and the bound columns are kept in spd with the same order of parameters.
+ */
+int32_t tsParseStmtInsertSql(SSqlObj *pSql, char *str, SParsedDataColInfo *spd) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  char *   id = NULL;
+  int      idlen = 0;
+  int32_t  code = TSDB_CODE_SUCCESS;
 
-    tscAllocPayloadWithSize(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE);
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->isInsertFromFile = 0;
+  pCmd->count = 0;
 
-    ret = tscToSQLCmd(pSql, &SQLInfo);
-    SQLInfoDestroy(&SQLInfo);
+  if (!pSql->pTscObj->writeAuth) {
+    return TSDB_CODE_NO_RIGHTS;
+  }
+
+  if ((code = tscAllocPayloadWithSize(pCmd, TSDB_PAYLOAD_SIZE)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  str = tscGetToken(str, &id, &idlen);
+  if (idlen == 6 && strncmp(id, "import", 6) == 0) {
+    pCmd->order.order = TSQL_SO_ASC;
+  } else if (idlen != 6 || strncmp(id, "insert", 6) != 0) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "keyword INSERT or IMPORT is expected");
+  }
+
+  str = tscGetToken(str, &id, &idlen);
+  if (idlen != 4 || strncmp(id, "into", 4) != 0) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "keyword INTO is expected");
+  }
+
+  tscGetToken(str, &id, &idlen);
+  if (validateTableName(id, idlen) != TSDB_CODE_SUCCESS) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "table name is invalid");
+  }
+
+  SSQLToken token = {idlen, TK_ID, id};
+  if ((code = setMeterID(pSql, &token)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if ((code = tscParseSqlForCreateTableOnDemand(&str, pSql)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (UTIL_METER_IS_METRIC(pCmd)) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "insert data into metric is not supported");
+  }
+
+  SMeterMeta *pMeterMeta = pCmd->pMeterMeta;
+  memset(spd, 0, sizeof(SParsedDataColInfo));
+
+  str = tscGetToken(str, &id, &idlen);
+  if (idlen == 1 && id[0] == '(') {
+    if ((code = tscParseBoundColumns(&str, pMeterMeta, spd, pCmd->payload)) != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    str = tscGetToken(str, &id, &idlen);
+  } else {
+    tscSetAssignedColumnInfo(spd, tsGetSchema(pMeterMeta), pMeterMeta->numOfColumns);
+  }
+
+  if (idlen != 6 || strncmp(id, "values", 6) != 0) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "keyword VALUES is expected");
+  }
+
+  if (spd->hasVal[0] == false) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "primary timestamp column can not be null");
+  }
+
+  str = tscGetToken(str, &id, &idlen);
+  if (idlen != 1 || id[0] != '(') {
+    INVALID_SQL_RET_MSG(pCmd->payload, "values are expected");
+  }
+
+  int32_t numOfParams = 0;
+  while (1) {
+    str = tscGetToken(str, &id, &idlen);
+    if (idlen == 1 && id[0] == ')') {
+      break;
+    }
+
+    if (idlen != 1 || id[0] != '?') {
+      INVALID_SQL_RET_MSG(pCmd->payload, "only parameter marker is allowed in values of prepared statement");
+    }
+
+    numOfParams++;
+  }
+
+  if (numOfParams != spd->numOfAssignedCols) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "number of parameters mismatch with columns");
+  }
+
+  tscGetToken(str, &id, &idlen);
+  if (idlen != 0) {
+    INVALID_SQL_RET_MSG(pCmd->payload, "only one table is allowed in prepared statement");
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * write the bound values of numOfRows rows into data block directly, the values of i-th parameter are
+ * stored in bind[i]. Columns that are not assigned in the statement are set to null.
+ */
+int32_t tsBindColumnsToDataBlock(STableDataBlocks *pDataBlock, SMeterMeta *pMeterMeta, SParsedDataColInfo *spd,
+                                 TAOS_BIND *bind, int32_t numOfRows, char *msg) {
+  SSchema *pSchema = tsGetSchema(pMeterMeta);
+  int32_t  rowSize = pMeterMeta->rowSize;
+  size_t   required = pDataBlock->size + (size_t)numOfRows * rowSize;
+
+  if (pDataBlock->nAllocSize < required) {
+    // the block may be created empty, grow from the default payload size
+    size_t nAllocSize = (pDataBlock->nAllocSize < TSDB_PAYLOAD_SIZE) ? TSDB_PAYLOAD_SIZE : pDataBlock->nAllocSize;
+    while (nAllocSize < required) {
+      nAllocSize = (size_t)(nAllocSize * 1.5);
+    }
+
+    if (nAllocSize > UINT32_MAX) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    char *tmp = realloc(pDataBlock->pData, nAllocSize);
+    if (tmp == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pDataBlock->pData = tmp;
+    pDataBlock->nAllocSize = (uint32_t)nAllocSize;
+  }
+
+  char *payload = pDataBlock->pData + pDataBlock->size;
+  memset(payload, 0, (size_t)numOfRows * rowSize);
+
+  for (int32_t i = 0; i < spd->numOfAssignedCols; ++i) {
+    TAOS_BIND *pBind = &bind[i];
+    int16_t    colIndex = spd->elems[i].colIndex;
+    SSchema *  pColSchema = &pSchema[colIndex];
+    char *     start = payload + spd->elems[i].offset;
+
+    if (pBind->buffer_type != pColSchema->type &&
+        !(pColSchema->type == TSDB_DATA_TYPE_TIMESTAMP && pBind->buffer_type == TSDB_DATA_TYPE_BIGINT)) {
+      sprintf(msg, "type of parameter %d mismatch with column %s", i + 1, pColSchema->name);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    int32_t isVarType = (pColSchema->type == TSDB_DATA_TYPE_BINARY || pColSchema->type == TSDB_DATA_TYPE_NCHAR);
+    int32_t elemSize = pBind->buffer_length;
+    if (elemSize <= 0) {
+      if (isVarType) {
+        sprintf(msg, "buffer length of parameter %d is required", i + 1);
+        return TSDB_CODE_INVALID_SQL;
+      }
+      elemSize = pColSchema->bytes;
+    } else if (!isVarType && elemSize < pColSchema->bytes) {
+      sprintf(msg, "buffer length of parameter %d is too small", i + 1);
+      return TSDB_CODE_INVALID_SQL;
+    }
+
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      char *dst = start + j * rowSize;
+      char *src = (char *)pBind->buffer + j * elemSize;
+
+      if (pBind->is_null != NULL && pBind->is_null[j]) {
+        if (colIndex == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          strcpy(msg, "primary timestamp column can not be null");
+          return TSDB_CODE_INVALID_SQL;
+        }
+
+        setNull(dst, pColSchema->type, pColSchema->bytes);
+        continue;
+      }
+
+      if (isVarType) {
+        // the length given by caller can not go beyond the buffer of value
+        int32_t len = (pBind->length != NULL) ? pBind->length[j] : (int32_t)strnlen(src, elemSize);
+        if (len < 0) len = 0;
+        if (len > elemSize) len = elemSize;
+
+        if (pColSchema->type == TSDB_DATA_TYPE_BINARY) {
+          /* truncate too long string */
+          if (len > pColSchema->bytes) len = pColSchema->bytes;
+          memcpy(dst, src, len);
+        } else if (!taosMbsToUcs4(src, len, dst, pColSchema->bytes)) {
+          sprintf(msg, "%s", strerror(errno));
+          return TSDB_CODE_INVALID_SQL;
+        }
+      } else {
+        memcpy(dst, src, pColSchema->bytes);
+      }
+    }
+  }
+
+  /* set the null value for the rest columns */
+  if (spd->numOfAssignedCols < spd->numOfCols) {
+    int32_t offset = 0;
+    for (int32_t i = 0; i < spd->numOfCols; ++i) {
+      if (!spd->hasVal[i]) {
+        for (int32_t j = 0; j < numOfRows; ++j) {
+          setNull(payload + j * rowSize + offset, pSchema[i].type, pSchema[i].bytes);
+        }
+      }
+
+      offset += pSchema[i].bytes;
+    }
+  }
+
+  for (int32_t j = 0; j < numOfRows; ++j) {
+    if (tsCheckTimestamp(pDataBlock, payload + j * rowSize) != TSDB_CODE_SUCCESS) {
+      strcpy(msg, "client time/server time can not be mixed up");
+      return TSDB_CODE_INVALID_SQL;
+    }
+  }
+
+  pDataBlock->size += numOfRows * rowSize;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * parse the statement to create multiple tables from super tables in one request:
+ * create table [if not exists] tb1 using stb1 tags(...) [if not exists] tb2 using stb2 tags(...) ...
+ * SCreateTableMsg and STagData of all tables are packed into SMultiCreateTableMsg, which is kept in payload
+ * until the msg is built.
+ */
+int tsParseMultiCreateTableSql(SSqlObj *pSql, char *str) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  char *   id = NULL;
+  int      idlen = 0;
+  int32_t  code = TSDB_CODE_SUCCESS;
+
+  pCmd->command = TSDB_SQL_MULTI_CREATE_TABLE;
+  pCmd->count = 0;
+
+  if (!pSql->pTscObj->writeAuth) {
+    return TSDB_CODE_NO_RIGHTS;
+  }
+
+  if ((code = tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  const int32_t entrySize = sizeof(SCreateTableMsg) + sizeof(STagData);
+  int32_t       capacity = 16;
+  int32_t       numOfTables = 0;
+  char          firstMeterId[TSDB_METER_ID_LEN] = {0};
+
+  char *pBuf = calloc(1, sizeof(SMultiCreateTableMsg) + capacity * entrySize);
+  if (pBuf == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  // skip the keywords of "create table"
+  str = tscGetToken(str, &id, &idlen);
+  str = tscGetToken(str, &id, &idlen);
+
+  while (1) {
+    str = tscGetToken(str, &id, &idlen);
+    if (idlen == 0 || (idlen == 1 && id[0] == ';')) {
+      break;
+    }
+
+    char igExists = 0;
+    if (idlen == 2 && strncasecmp(id, "if", 2) == 0) {
+      str = tscGetToken(str, &id, &idlen);
+      if (idlen != 3 || strncasecmp(id, "not", 3) != 0) {
+        code = TSDB_CODE_INVALID_SQL;
+        sprintf(pCmd->payload, "keyword NOT EXISTS is expected");
+        goto _clean;
+      }
+
+      str = tscGetToken(str, &id, &idlen);
+      if (idlen != 6 || strncasecmp(id, "exists", 6) != 0) {
+        code = TSDB_CODE_INVALID_SQL;
+        sprintf(pCmd->payload, "keyword EXISTS is expected");
+        goto _clean;
+      }
+
+      igExists = 1;
+      str = tscGetToken(str, &id, &idlen);
+    }
+
+    SSQLToken tableToken = {.z = id, .n = idlen, .type = TK_ID};
+
+    str = tscGetToken(str, &id, &idlen);
+    if (idlen != 5 || strncasecmp(id, "using", 5) != 0) {
+      code = TSDB_CODE_INVALID_SQL;
+      sprintf(pCmd->payload, "keyword USING is expected");
+      goto _clean;
+    }
+
+    if (numOfTables >= TSDB_MAX_TABLES_IN_MULTI_CREATE) {
+      code = TSDB_CODE_INVALID_SQL;
+      sprintf(pCmd->payload, "too many tables, max:%d", TSDB_MAX_TABLES_IN_MULTI_CREATE);
+      goto _clean;
+    }
+
+    if (numOfTables >= capacity) {
+      capacity = capacity << 1;
+      char *tmp = realloc(pBuf, sizeof(SMultiCreateTableMsg) + capacity * entrySize);
+      if (tmp == NULL) {
+        code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+        goto _clean;
+      }
+      pBuf = tmp;
+    }
+
+    SCreateTableMsg *pCreate = (SCreateTableMsg *)(pBuf + sizeof(SMultiCreateTableMsg) + numOfTables * entrySize);
+    STagData *       pTag = (STagData *)pCreate->schema;
+    memset(pCreate, 0, entrySize);
+
+    str = tscGetToken(str, &id, &idlen);
+    SSQLToken metricToken = {.z = id, .n = idlen, .type = TK_ID};
+    if (idlen == 0 || tscValidateName(&metricToken) != TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_INVALID_SQL;
+      sprintf(pCmd->payload, "invalid super table name");
+      goto _clean;
+    }
+
+    if ((code = setMeterID(pSql, &metricToken)) != TSDB_CODE_SUCCESS) {
+      goto _clean;
+    }
+
+    strcpy(pTag->name, pCmd->name);
+
+    // for async sql, the statement is parsed again after the meter meta of super table is retrieved
+    code = tscGetMeterMeta(pSql, pTag->name);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _clean;
+    }
+
+    if (!UTIL_METER_IS_METRIC(pCmd)) {
+      code = TSDB_CODE_INVALID_SQL;
+      sprintf(pCmd->payload, "create table only from super table is allowed");
+      goto _clean;
+    }
+
+    code = tscParseTagValues(&str, pCmd->pMeterMeta, pTag->data, pCmd->payload);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _clean;
+    }
+
+    if (tscValidateName(&tableToken) != TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_INVALID_SQL;
+      sprintf(pCmd->payload, "invalid table name");
+      goto _clean;
+    }
+
+    if ((code = setMeterID(pSql, &tableToken)) != TSDB_CODE_SUCCESS) {
+      goto _clean;
+    }
+
+    strcpy(pCreate->meterId, pCmd->name);
+    pCreate->igExists = igExists;
+
+    if (numOfTables == 0) {
+      strcpy(firstMeterId, pCmd->name);
+    }
+
+    numOfTables++;
+  }
+
+  if (numOfTables == 0) {
+    code = TSDB_CODE_INVALID_SQL;
+    sprintf(pCmd->payload, "no table to create");
+    goto _clean;
+  }
+
+  ((SMultiCreateTableMsg *)pBuf)->numOfTables = htonl(numOfTables);
+
+  // the db info in msg is extracted from the meter id of the first table
+  strcpy(pCmd->name, firstMeterId);
+  taosRemoveDataFromCache(tscCacheHandle, (void **)&(pCmd->pMeterMeta), false);
+
+  int32_t len = sizeof(SMultiCreateTableMsg) + numOfTables * entrySize;
+  int32_t size = len + tsRpcHeadSize + sizeof(SMgmtHead) + sizeof(STaosDigest) + TSDB_EXTRA_PAYLOAD_SIZE;
+  if ((code = tscAllocPayloadWithSize(pCmd, size)) != TSDB_CODE_SUCCESS) {
+    goto _clean;
+  }
+
+  memcpy(pCmd->payload, pBuf, len);
+  pCmd->payloadLen = len;
+  pCmd->count = numOfTables;
+
+  tscTrace("%p %d tables are parsed in multi-create statement", pSql, numOfTables);
+
+_clean:
+  tfree(pBuf);
+  return code;
+}
+
+int tsParseSql(SSqlObj *pSql, char *acct, char *db, bool multiVnodeInsertion) {
+  int32_t ret = TSDB_CODE_SUCCESS;
+  tscCleanSqlCmd(&pSql->cmd);
+
+  if (tscIsInsertOrImportData(pSql->sqlstr)) {
+    /*
+     * only for async multi-vnode insertion
+     * Set the fp before parse the sql string, in case of getmetermeta failed, in which
+     * the error handle callback function can rightfully restore the user defined function (fp)
+     */
+    if (pSql->fp != NULL && multiVnodeInsertion) {
+      assert(pSql->fetchFp == NULL);
+      pSql->fetchFp = pSql->fp;
+
+      /* replace user defined callback function with multi-insert proxy function */
+      pSql->fp = tscAsyncInsertMultiVnodesProxy;
+    }
+
+    ret = tsParseInsertSql(pSql, pSql->sqlstr, acct, db);
+  } else if (tscIsMultiCreateTable(pSql->sqlstr)) {
+    ret = tsParseMultiCreateTableSql(pSql, pSql->sqlstr);
+  } else {
+    SSqlInfo SQLInfo = {0};
+    tSQLParse(&SQLInfo, pSql->sqlstr);
+
+    tscAllocPayloadWithSize(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE);
+
+    ret = tscToSQLCmd(pSql, &SQLInfo);
+    SQLInfoDestroy(&SQLInfo);
   }
 
   /*
@@ -1228,45 +1894,327 @@ static int tscInsertDataFromFile(SSqlObj *pSql, FILE *fp) {
   return numOfRows;
 }
 
-/* multi-vnodes insertion in sync query model
- *
- * modify history
- * 2019.05.10 lihui
- * Remove the code for importing records from files
+typedef struct SInsertSupporter SInsertSupporter;
+
+typedef struct SInsertSubSupporter {
+  SInsertSupporter *pSupporter;
+  int32_t           index;  // index of the data block in parent data block list
+} SInsertSubSupporter;
+
+struct SInsertSupporter {
+  SSqlObj *            pSql;         // parent sql object, which owns the data block list
+  int32_t              numOfVnodes;  // number of data blocks, one block for each vnode
+  int32_t              numOfRemain;  // number of sub-insertions not completed in current round
+  int32_t              numOfRetry;
+  int32_t *            pCode;  // result of each data block
+  int32_t *            pRows;  // affected rows of each data block
+  int32_t *            pOutput;
+  SInsertSubSupporter *pSubs;
+};
+
+static void tscLaunchMultiVnodesInsertRound(SInsertSupporter *pSupporter);
+
+/*
+ * The sub-insertion may be failed because of vnode temporarily unavailable, only the
+ * data blocks failed with these error code are sent again.
  */
-void tscProcessMultiVnodesInsert(SSqlObj *pSql) {
-  SSqlCmd *pCmd = &pSql->cmd;
-  if (pCmd->command != TSDB_SQL_INSERT) {
+static bool tscIsRetriableInsertError(int32_t code) {
+  return code == TSDB_CODE_NETWORK_UNAVAIL || code == TSDB_CODE_NOT_READY || code == TSDB_CODE_SESSION_NOT_READY ||
+         code == TSDB_CODE_NO_RESOURCE || code == TSDB_CODE_ACTION_NOT_ONLINE || code == TSDB_CODE_ACTION_SEND_FAILD ||
+         code == TSDB_CODE_NOT_ACTIVE_SESSION || code == TSDB_CODE_NODE_OFFLINE || code == TSDB_CODE_TOO_SLOW ||
+         code == TSDB_CODE_MAX_SESSIONS || code == TSDB_CODE_MAX_CONNECTIONS;
+}
+
+static void tscRetryMultiVnodesInsert(void *param, void *tmrId) {
+  tscLaunchMultiVnodesInsertRound((SInsertSupporter *)param);
+}
+
+static void tscFreeInsertSupporter(SInsertSupporter *pSupporter) {
+  tfree(pSupporter->pCode);
+  tfree(pSupporter->pRows);
+  tfree(pSupporter->pSubs);
+  tfree(pSupporter);
+}
+
+static void tscMultiVnodesInsertCompleted(SInsertSupporter *pSupporter) {
+  SSqlObj *       pSql = pSupporter->pSql;
+  SSqlCmd *       pCmd = &pSql->cmd;
+  SSqlRes *       pRes = &pSql->res;
+  SDataBlockList *pDataBlocks = pCmd->pDataBlocks;
+
+  int32_t numOfRetriable = 0;
+  for (int32_t i = 0; i < pSupporter->numOfVnodes; ++i) {
+    if (tscIsRetriableInsertError(pSupporter->pCode[i])) {
+      numOfRetriable++;
+    }
+  }
+
+  if (numOfRetriable > 0 && pSupporter->numOfRetry < MAX_NUM_OF_SUBQUERY_RETRY) {
+    pSupporter->numOfRetry++;
+    int32_t delay = TSC_INSERT_RETRY_DELAY * pSupporter->numOfRetry;
+    tscTrace("%p %d of %d vnodes insertion failed, retry:%d in %d ms", pSql, numOfRetriable, pSupporter->numOfVnodes,
+             pSupporter->numOfRetry, delay);
+
+    // the vnode may be changed, e.g., it is not available and another one is elected, so the meter meta is renewed
+    for (int32_t i = 0; i < pSupporter->numOfVnodes; ++i) {
+      if (tscIsRetriableInsertError(pSupporter->pCode[i])) {
+        STableDataBlocks *pDataBlock = pDataBlocks->pData[i];
+        void *            pMeterMeta = taosGetDataFromCache(tscCacheHandle, pDataBlock->meterId);
+        taosRemoveDataFromCache(tscCacheHandle, &pMeterMeta, true);
+      }
+    }
+
+    taosTmrStart(tscRetryMultiVnodesInsert, delay, pSupporter, tscTmr);
     return;
   }
 
-  STableDataBlocks *pDataBlock = NULL;
-  int32_t           affected_rows = 0;
-  int32_t           code = TSDB_CODE_SUCCESS;
+  /*
+   * only the rows of the succeeded vnodes are affected, the first error is reported to user, and the failed
+   * vgroups are kept in pRes, which are retrieved by taos_failed_vgroups
+   */
+  int32_t numOfRows = 0;
+  int32_t numOfFailed = 0;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  tfree(pRes->pFailedVgroups);
+  pRes->numOfFailedVgroups = 0;
 
-  /* the first block has been sent to server in processSQL function */
-  assert(pCmd->isInsertFromFile != -1 && pCmd->vnodeIdx >= 1 && pCmd->pDataBlocks != NULL);
+  for (int32_t i = 0; i < pSupporter->numOfVnodes; ++i) {
+    if (pSupporter->pCode[i] == TSDB_CODE_SUCCESS) {
+      numOfRows += pSupporter->pRows[i];
+      continue;
+    }
 
-  if (pCmd->vnodeIdx < pCmd->pDataBlocks->nSize) {
-    SDataBlockList *pDataBlocks = pCmd->pDataBlocks;
+    STableDataBlocks *pDataBlock = pDataBlocks->pData[i];
+    tscError("%p failed to insert data into vgroup:%d, meter:%s, code:%d", pSql, pDataBlock->vgid,
+             pDataBlock->meterId, pSupporter->pCode[i]);
 
-    for (int32_t i = pCmd->vnodeIdx; i < pDataBlocks->nSize; ++i) {
-      pDataBlock = pDataBlocks->pData[i];
-      if (pDataBlock == NULL) {
-        continue;
-      }
+    if (pRes->pFailedVgroups == NULL) {
+      pRes->pFailedVgroups = malloc(sizeof(int32_t) * 2 * pSupporter->numOfVnodes);
+    }
 
-      if ((code = tscCopyDataBlockToPayload(pSql, pDataBlock)) != TSDB_CODE_SUCCESS) {
-        tscTrace("%p build submit data block failed, vnodeIdx:%d, total:%d", pSql, pCmd->vnodeIdx, pDataBlocks->nSize);
-        continue;
-      }
+    if (pRes->pFailedVgroups != NULL) {
+      pRes->pFailedVgroups[numOfFailed * 2] = pDataBlock->vgid;
+      pRes->pFailedVgroups[numOfFailed * 2 + 1] = pSupporter->pCode[i];
+      pRes->numOfFailedVgroups = numOfFailed + 1;
+    }
 
-      tscProcessSql(pSql);
+    numOfFailed++;
+    if (code == TSDB_CODE_SUCCESS) {
+      code = pSupporter->pCode[i];
     }
   }
 
+  if (pSupporter->pOutput != NULL) {
+    memcpy(pSupporter->pOutput, pSupporter->pCode, sizeof(int32_t) * pSupporter->numOfVnodes);
+  }
+
+  tscTrace("%p multi-vnodes insertion completed, vnodes:%d, failed:%d, affected rows:%d", pSql,
+           pSupporter->numOfVnodes, numOfFailed, numOfRows);
+
+  tscFreeInsertSupporter(pSupporter);
+
+  pRes->numOfRows = numOfRows;
+  pRes->code = code;
+
   // all data have been submit to vnode, release data blocks
   pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+
+  if (pSql->fp == NULL) {
+    sem_post(&pSql->rspSem);
+    return;
+  }
+
+  // restore user defined fp, and the sql object is released if no more data blocks
+  if (pSql->fetchFp != NULL) {
+    pSql->fp = pSql->fetchFp;
+  }
+
+  // the failed vgroups are available through tres in the callback function
+  bool shouldFree = tscShouldFreeAsyncSqlObj(pSql);
+  (*pSql->fp)(pSql->param, pSql, (code != TSDB_CODE_SUCCESS) ? -code : numOfRows);
+
+  if (shouldFree) {
+    tscFreeSqlObj(pSql);
+    tscTrace("%p Async multi-vnodes insertion is automatically freed", pSql);
+  }
+}
+
+static void tscProcessSubInsertRes(SInsertSubSupporter *pSub, int32_t code) {
+  SInsertSupporter *pSupporter = pSub->pSupporter;
+
+  if (code < 0) {
+    pSupporter->pCode[pSub->index] = -code;
+  } else {
+    pSupporter->pCode[pSub->index] = TSDB_CODE_SUCCESS;
+    pSupporter->pRows[pSub->index] = code;
+  }
+
+  if (__sync_add_and_fetch_32(&pSupporter->numOfRemain, -1) > 0) {
+    return;
+  }
+
+  tscMultiVnodesInsertCompleted(pSupporter);
+}
+
+/*
+ * the submit response of sub-insertion is handled in tscProcessMsgFromServer, in which
+ * the sub sql object, instead of its param, is the first parameter
+ */
+void tscMultiVnodesInsertCallBack(void *param, TAOS_RES *tres, int numOfRows) {
+  SSqlObj *pNew = (SSqlObj *)param;
+  tscProcessSubInsertRes((SInsertSubSupporter *)pNew->param, numOfRows);
+}
+
+/* the error occurs before the submit msg being sent, handled in tscProcessAsyncRes */
+static void tscMultiVnodesInsertErrorCallBack(void *param, TAOS_RES *tres, int code) {
+  tscProcessSubInsertRes((SInsertSubSupporter *)param, code);
+}
+
+static void tscLaunchSubInsert(SInsertSupporter *pSupporter, int32_t idx) {
+  SSqlObj *            pSql = pSupporter->pSql;
+  SInsertSubSupporter *pSub = &pSupporter->pSubs[idx];
+  STableDataBlocks *   pDataBlock = pSql->cmd.pDataBlocks->pData[idx];
+
+  SSqlObj *pNew = (SSqlObj *)calloc(1, sizeof(SSqlObj));
+  if (pNew == NULL) {
+    tscProcessSubInsertRes(pSub, -TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  pNew->signature = pNew;
+  pNew->pTscObj = pSql->pTscObj;
+  pNew->sqlstr = strdup((pSql->sqlstr != NULL) ? pSql->sqlstr : "");
+  pNew->fp = tscMultiVnodesInsertCallBack;
+  pNew->fetchFp = tscMultiVnodesInsertErrorCallBack;
+  pNew->param = pSub;
+
+  SSqlCmd *pCmd = &pNew->cmd;
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->isInsertFromFile = 0;
+  pCmd->order = pSql->cmd.order;
+  pCmd->vnodeIdx = 1;
+
+  if (pNew->sqlstr == NULL || tscAllocPayloadWithSize(pCmd, pDataBlock->nAllocSize) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    tscProcessSubInsertRes(pSub, -TSDB_CODE_CLI_OUT_OF_MEMORY);
+    return;
+  }
+
+  tscTrace("%p sub:%p launched to insert into vgroup:%d, index:%d", pSql, pNew, pDataBlock->vgid, idx);
+
+  // the meter meta is retrieved asynchronously, the insertion continues in tscMeterMetaCallBack
+  int32_t code = tscCopyDataBlockToPayload(pNew, pDataBlock);
+  if (code == TSDB_CODE_ACTION_IN_PROGRESS) {
+    return;
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    tscProcessSubInsertRes(pSub, -code);
+    return;
+  }
+
+  // the response is handled in tscMultiVnodesInsertCallBack, pNew is released automatically
+  tscProcessSql(pNew);
+}
+
+static void tscLaunchMultiVnodesInsertRound(SInsertSupporter *pSupporter) {
+  int32_t numOfVnodes = pSupporter->numOfVnodes;
+
+  /*
+   * one more reference is held by current function, so the supporter will not be released
+   * by the sub-insertions that are completed before all sub-insertions are launched.
+   */
+  int32_t numOfRemain = 1;
+  for (int32_t i = 0; i < numOfVnodes; ++i) {
+    if (pSupporter->numOfRetry == 0 || tscIsRetriableInsertError(pSupporter->pCode[i])) {
+      numOfRemain++;
+    }
+  }
+
+  pSupporter->numOfRemain = numOfRemain;
+
+  for (int32_t i = 0; i < numOfVnodes; ++i) {
+    if (pSupporter->numOfRetry == 0 || tscIsRetriableInsertError(pSupporter->pCode[i])) {
+      tscLaunchSubInsert(pSupporter, i);
+    }
+  }
+
+  if (__sync_add_and_fetch_32(&pSupporter->numOfRemain, -1) == 0) {
+    tscMultiVnodesInsertCompleted(pSupporter);
+  }
+}
+
+/**
+ * submit the data blocks of all vnodes concurrently, each data block is sent by a sub sql object.
+ * The affected rows and error codes of all vnodes are aggregated into the parent sql object, and
+ * the data blocks failed due to vnode temporarily unavailable are sent again.
+ *
+ * In sync model, this function returns after all sub-insertions completed. In async model, the user
+ * defined callback function is invoked after all sub-insertions completed, and pSql may be released.
+ *
+ * @param pSql      sql object that owns the data block list
+ * @param pCode     optional, the result code of each data block, which is set before this function returns in
+ *                  sync model, or before the callback function is invoked in async model
+ * @return          result code
+ */
+int32_t tscLaunchMultiVnodesInsert(SSqlObj *pSql, int32_t *pCode) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+  void *   fp = pSql->fp;
+
+  assert(pCmd->command == TSDB_SQL_INSERT && pCmd->pDataBlocks != NULL && pCmd->pDataBlocks->nSize > 0);
+
+  int32_t           numOfVnodes = pCmd->pDataBlocks->nSize;
+  SInsertSupporter *pSupporter = calloc(1, sizeof(SInsertSupporter));
+
+  if (pSupporter != NULL) {
+    pSupporter->pCode = calloc(numOfVnodes, sizeof(int32_t));
+    pSupporter->pRows = calloc(numOfVnodes, sizeof(int32_t));
+    pSupporter->pSubs = calloc(numOfVnodes, sizeof(SInsertSubSupporter));
+  }
+
+  if (pSupporter == NULL || pSupporter->pCode == NULL || pSupporter->pRows == NULL || pSupporter->pSubs == NULL) {
+    if (pSupporter != NULL) {
+      tscFreeInsertSupporter(pSupporter);
+    }
+
+    pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+    pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+
+    for (int32_t i = 0; pCode != NULL && i < numOfVnodes; ++i) {
+      pCode[i] = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    if (fp != NULL) {
+      tscQueueAsyncRes(pSql);
+    }
+
+    return pRes->code;
+  }
+
+  pSupporter->pSql = pSql;
+  pSupporter->numOfVnodes = numOfVnodes;
+  pSupporter->pOutput = pCode;
+
+  for (int32_t i = 0; i < numOfVnodes; ++i) {
+    pSupporter->pSubs[i].pSupporter = pSupporter;
+    pSupporter->pSubs[i].index = i;
+  }
+
+  pRes->code = TSDB_CODE_SUCCESS;
+  pRes->numOfRows = 0;
+
+  tscTrace("%p launch insertion to %d vnodes concurrently", pSql, numOfVnodes);
+  tscLaunchMultiVnodesInsertRound(pSupporter);
+
+  if (fp != NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  sem_wait(&pSql->rspSem);
+  return pRes->code;
 }
 
 /* multi-vnodes insertion in sync query model */
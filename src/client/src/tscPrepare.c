@@ -0,0 +1,710 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <float.h>
+#include <inttypes.h>
+
+#include "taos.h"
+#include "tcache.h"
+#include "tlog.h"
+#include "tscUtil.h"
+#include "tsclient.h"
+#include "tutil.h"
+
+/*
+ * prepared statement
+ *
+ * For insert statement, the sql is parsed and the meter meta is retrieved only once in taos_stmt_prepare, the bound
+ * values are written into the submit block of the table directly, without the conversion to and from sql string.
+ * For query statement, the bound values are substituted for the parameter markers as literals, and the generated sql
+ * is executed in the same way as taos_query.
+ */
+typedef struct {
+  void *             signature;
+  STscObj *          pObj;
+  SSqlObj *          pSql;
+  char *             sqlstr;       // original sql string with parameter markers
+  bool               isInsert;
+  int8_t             import;
+  int32_t            numOfParams;
+
+  SMeterMeta *       pMeterMeta;   // referenced in meter meta cache during the life of statement
+  char               meterId[TSDB_METER_ID_LEN];
+  SParsedDataColInfo spd;
+  STableDataBlocks * pDataBlock;   // submit block of rows bound so far
+  int32_t            numOfRows;    // rows added to batch
+  int32_t            numOfBound;   // rows bound but not added to batch yet
+
+  int32_t *          paramPos;     // position of each parameter marker in sqlstr
+  char *             querySql;     // query sql with bound values
+} STscStmt;
+
+static int32_t tscStmtSetError(STscStmt *pStmt, int32_t code) {
+  pStmt->pSql->res.code = (uint8_t)code;
+  return code;
+}
+
+static int32_t tscStmtSetErrMsg(STscStmt *pStmt, const char *msg) {
+  SSqlCmd *pCmd = &pStmt->pSql->cmd;
+  if (tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) == TSDB_CODE_SUCCESS) {
+    strcpy(pCmd->payload, msg);
+  }
+
+  return tscStmtSetError(pStmt, TSDB_CODE_INVALID_SQL);
+}
+
+static int32_t tscStmtSetSqlStr(SSqlObj *pSql, char *sql) {
+  char *tmp = realloc(pSql->sqlstr, strlen(sql) + 1);
+  if (tmp == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pSql->sqlstr = tmp;
+  strtolower(pSql->sqlstr, sql);
+  return TSDB_CODE_SUCCESS;
+}
+
+static void tscStmtReset(STscStmt *pStmt) {
+  if (pStmt->pDataBlock != NULL) {
+    tscDestroyDataBlock(pStmt->pDataBlock);
+    pStmt->pDataBlock = NULL;
+  }
+
+  taosRemoveDataFromCache(tscCacheHandle, (void **)&pStmt->pMeterMeta, false);
+
+  tfree(pStmt->sqlstr);
+  tfree(pStmt->paramPos);
+  tfree(pStmt->querySql);
+
+  pStmt->isInsert = false;
+  pStmt->import = 0;
+  pStmt->numOfParams = 0;
+  pStmt->numOfRows = 0;
+  pStmt->numOfBound = 0;
+  memset(&pStmt->spd, 0, sizeof(SParsedDataColInfo));
+}
+
+TAOS_STMT *taos_stmt_init(TAOS *taos) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    tscError("connection disconnected");
+    return NULL;
+  }
+
+  STscStmt *pStmt = calloc(1, sizeof(STscStmt));
+  if (pStmt == NULL) {
+    globalCode = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    tscError("failed to allocate memory for statement");
+    return NULL;
+  }
+
+  SSqlObj *pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    free(pStmt);
+    globalCode = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    tscError("failed to allocate memory for statement");
+    return NULL;
+  }
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pObj;
+  if (tscAllocPayloadWithSize(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    free(pSql);
+    free(pStmt);
+    globalCode = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  sem_init(&pSql->rspSem, 0, 0);
+  sem_init(&pSql->emptyRspSem, 0, 1);
+
+  pStmt->signature = pStmt;
+  pStmt->pObj = pObj;
+  pStmt->pSql = pSql;
+
+  tscTrace("%p statement is created, pObj:%p", pSql, pObj);
+  return pStmt;
+}
+
+static int32_t tscStmtPrepareInsert(STscStmt *pStmt) {
+  SSqlObj *pSql = pStmt->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  tscCleanSqlCmd(pCmd);
+
+  int32_t code = tsParseStmtInsertSql(pSql, pSql->sqlstr, &pStmt->spd);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // the statement holds the meter meta until it is closed or prepared again
+  pStmt->pMeterMeta = pCmd->pMeterMeta;
+  pCmd->pMeterMeta = NULL;
+
+  strncpy(pStmt->meterId, pCmd->name, TSDB_METER_ID_LEN);
+  pStmt->import = pCmd->order.order;
+  pStmt->numOfParams = pStmt->spd.numOfAssignedCols;
+  pStmt->isInsert = true;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t tscStmtPrepareQuery(STscStmt *pStmt) {
+  char *  sql = pStmt->sqlstr;
+  char    quote = 0;
+  int32_t num = 0;
+
+  for (char *p = sql; *p != 0; ++p) {
+    if (quote != 0) {
+      if (*p == quote) quote = 0;
+    } else if (*p == '\'' || *p == '"') {
+      quote = *p;
+    } else if (*p == '?') {
+      num++;
+    }
+  }
+
+  pStmt->paramPos = calloc(num + 1, sizeof(int32_t));
+  if (pStmt->paramPos == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  quote = 0;
+  num = 0;
+  for (char *p = sql; *p != 0; ++p) {
+    if (quote != 0) {
+      if (*p == quote) quote = 0;
+    } else if (*p == '\'' || *p == '"') {
+      quote = *p;
+    } else if (*p == '?') {
+      pStmt->paramPos[num++] = (int32_t)(p - sql);
+    }
+  }
+
+  pStmt->numOfParams = num;
+  pStmt->isInsert = false;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int taos_stmt_prepare(TAOS_STMT *stmt, char *sql) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  SSqlObj *pSql = pStmt->pSql;
+  tscStmtReset(pStmt);
+
+  if (sql == NULL || strlen(sql) > TSDB_MAX_SQL_LEN) {
+    tscError("%p sql is null or too long", pSql);
+    return tscStmtSetError(pStmt, TSDB_CODE_INVALID_SQL);
+  }
+
+  pStmt->sqlstr = strdup(sql);
+  if (pStmt->sqlstr == NULL || tscStmtSetSqlStr(pSql, sql) != TSDB_CODE_SUCCESS) {
+    return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+  }
+
+  tscTrace("%p prepare SQL: %s", pSql, sql);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (tscIsInsertOrImportData(pSql->sqlstr)) {
+    code = tscStmtPrepareInsert(pStmt);
+  } else {
+    code = tscStmtPrepareQuery(pStmt);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscTrace("%p failed to prepare SQL, code:%d", pSql, code);
+  }
+
+  return tscStmtSetError(pStmt, code);
+}
+
+int taos_stmt_num_params(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) return 0;
+
+  return pStmt->numOfParams;
+}
+
+static int32_t tscStmtBindInsert(STscStmt *pStmt, TAOS_BIND *bind, int32_t numOfRows) {
+  SSqlCmd *pCmd = &pStmt->pSql->cmd;
+
+  if (pStmt->numOfRows + numOfRows > INT16_MAX) {
+    return tscStmtSetErrMsg(pStmt, "too many rows in one batch");
+  }
+
+  if (pStmt->pDataBlock == NULL) {
+    int32_t size = MAX(TSDB_DEFAULT_PAYLOAD_SIZE, sizeof(SShellSubmitBlock) + pStmt->pMeterMeta->rowSize * numOfRows);
+    pStmt->pDataBlock =
+        tscCreateDataBlockEx((size_t)size, pStmt->pMeterMeta->rowSize, sizeof(SShellSubmitBlock), pStmt->meterId);
+    if (pStmt->pDataBlock == NULL || pStmt->pDataBlock->pData == NULL) {
+      return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+    }
+  }
+
+  // values bound without being added to batch are overwritten
+  STableDataBlocks *pDataBlock = pStmt->pDataBlock;
+  pDataBlock->size = sizeof(SShellSubmitBlock) + pStmt->numOfRows * pDataBlock->rowSize;
+  pStmt->numOfBound = 0;
+
+  if (tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+  }
+
+  int32_t code = tsBindColumnsToDataBlock(pDataBlock, pStmt->pMeterMeta, &pStmt->spd, bind, numOfRows, pCmd->payload);
+  if (code != TSDB_CODE_SUCCESS) {
+    return tscStmtSetError(pStmt, code);
+  }
+
+  pStmt->numOfBound = numOfRows;
+  return tscStmtSetError(pStmt, TSDB_CODE_SUCCESS);
+}
+
+/* convert the bound value into sql literal */
+static int32_t tscStmtPrintParam(char *str, TAOS_BIND *pBind) {
+  if (pBind->is_null != NULL && pBind->is_null[0]) {
+    return sprintf(str, "null");
+  }
+
+  switch (pBind->buffer_type) {
+    case TSDB_DATA_TYPE_BOOL:
+      return sprintf(str, "%s", (*(int8_t *)pBind->buffer) ? "true" : "false");
+    case TSDB_DATA_TYPE_TINYINT:
+      return sprintf(str, "%d", *(int8_t *)pBind->buffer);
+    case TSDB_DATA_TYPE_SMALLINT:
+      return sprintf(str, "%d", *(int16_t *)pBind->buffer);
+    case TSDB_DATA_TYPE_INT:
+      return sprintf(str, "%d", *(int32_t *)pBind->buffer);
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return sprintf(str, "%" PRId64, *(int64_t *)pBind->buffer);
+    case TSDB_DATA_TYPE_FLOAT:
+      return sprintf(str, "%.*g", FLT_DIG + 3, *(float *)pBind->buffer);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return sprintf(str, "%.*g", DBL_DIG + 2, *(double *)pBind->buffer);
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR: {
+      char *  src = (char *)pBind->buffer;
+      int32_t len = (pBind->length != NULL) ? pBind->length[0] : (int32_t)strnlen(src, pBind->buffer_length);
+      char *  p = str;
+
+      *p++ = '\'';
+      for (int32_t i = 0; i < len; ++i) {
+        if (src[i] == '\'') {
+          *p++ = '\'';
+        }
+        *p++ = src[i];
+      }
+      *p++ = '\'';
+      *p = 0;
+
+      return (int32_t)(p - str);
+    }
+    default:
+      return -1;
+  }
+}
+
+static int32_t tscStmtBindQuery(STscStmt *pStmt, TAOS_BIND *bind, int32_t numOfRows) {
+  if (numOfRows != 1) {
+    return tscStmtSetErrMsg(pStmt, "only one row of parameters is allowed for query");
+  }
+
+  // the quoted binary value may be doubled in length at most
+  size_t len = strlen(pStmt->sqlstr) + 1;
+  for (int32_t i = 0; i < pStmt->numOfParams; ++i) {
+    int32_t bytes = (bind[i].length != NULL) ? bind[i].length[0] : bind[i].buffer_length;
+    len += MAX(bytes, 0) * 2 + 64;
+  }
+
+  char *querySql = realloc(pStmt->querySql, len);
+  if (querySql == NULL) {
+    return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+  }
+
+  pStmt->querySql = querySql;
+
+  char *  dst = querySql;
+  int32_t start = 0;
+  for (int32_t i = 0; i < pStmt->numOfParams; ++i) {
+    int32_t pos = pStmt->paramPos[i];
+    memcpy(dst, pStmt->sqlstr + start, pos - start);
+    dst += (pos - start);
+
+    int32_t n = tscStmtPrintParam(dst, &bind[i]);
+    if (n < 0) {
+      tfree(pStmt->querySql);
+      return tscStmtSetErrMsg(pStmt, "invalid type of parameter");
+    }
+
+    dst += n;
+    start = pos + 1;
+  }
+
+  strcpy(dst, pStmt->sqlstr + start);
+
+  if (strlen(querySql) > TSDB_MAX_SQL_LEN) {
+    tfree(pStmt->querySql);
+    return tscStmtSetErrMsg(pStmt, "sql is too long after binding parameters");
+  }
+
+  return tscStmtSetError(pStmt, TSDB_CODE_SUCCESS);
+}
+
+int taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind, int numOfRows) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  if (pStmt->sqlstr == NULL) {
+    return tscStmtSetErrMsg(pStmt, "statement is not prepared");
+  }
+
+  if (numOfRows <= 0 || (bind == NULL && pStmt->numOfParams > 0)) {
+    return tscStmtSetError(pStmt, TSDB_CODE_INVALID_VALUE);
+  }
+
+  if (pStmt->isInsert) {
+    return tscStmtBindInsert(pStmt, bind, numOfRows);
+  } else {
+    return tscStmtBindQuery(pStmt, bind, numOfRows);
+  }
+}
+
+int taos_stmt_add_batch(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  if (!pStmt->isInsert) {
+    return tscStmtSetError(pStmt, TSDB_CODE_OPS_NOT_SUPPORT);
+  }
+
+  if (pStmt->numOfBound <= 0) {
+    return tscStmtSetErrMsg(pStmt, "parameters are not bound");
+  }
+
+  pStmt->numOfRows += pStmt->numOfBound;
+  pStmt->numOfBound = 0;
+
+  return tscStmtSetError(pStmt, TSDB_CODE_SUCCESS);
+}
+
+static int32_t tscStmtExecuteInsert(STscStmt *pStmt) {
+  SSqlObj *pSql = pStmt->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  // rows bound but not added to batch explicitly are submitted as well
+  pStmt->numOfRows += pStmt->numOfBound;
+  pStmt->numOfBound = 0;
+
+  if (pStmt->numOfRows <= 0) {
+    return tscStmtSetErrMsg(pStmt, "no any data points");
+  }
+
+  STableDataBlocks *pDataBlock = pStmt->pDataBlock;
+  int32_t           numOfRows = pStmt->numOfRows;
+
+  pStmt->pDataBlock = NULL;
+  pStmt->numOfRows = 0;
+
+  if (tscStmtSetSqlStr(pSql, pStmt->sqlstr) != TSDB_CODE_SUCCESS) {
+    tscDestroyDataBlock(pDataBlock);
+    return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+  }
+
+  tscCleanSqlCmd(pCmd);
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->isInsertFromFile = 0;
+  pCmd->order.order = pStmt->import;
+
+  pRes->numOfRows = 0;
+  pRes->numOfTotal = 0;
+  pRes->qhandle = 0;
+  pSql->thandle = NULL;
+
+  SShellSubmitBlock *pBlocks = (SShellSubmitBlock *)pDataBlock->pData;
+  tsSetBlockInfo(pBlocks, pStmt->pMeterMeta, numOfRows);
+
+  pDataBlock->vgid = pStmt->pMeterMeta->vgid;
+  pDataBlock->numOfMeters = 1;
+
+  pCmd->pDataBlocks = tscCreateBlockArrayList();
+  tscAppendDataBlock(pCmd->pDataBlocks, pDataBlock);
+
+  tscMergeTableDataBlocks(pSql, pCmd->pDataBlocks);
+
+  int32_t code = tscCopyDataBlockToPayload(pSql, pCmd->pDataBlocks->pData[0]);
+  if (code != TSDB_CODE_SUCCESS) {
+    pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+    return tscStmtSetError(pStmt, code);
+  }
+
+  pCmd->vnodeIdx = 1;
+  tscDoQuery(pSql);
+
+  tscTrace("%p prepared insert, rows:%d, result:%d", pSql, numOfRows, pRes->code);
+  return pRes->code;
+}
+
+static int32_t tscStmtExecuteQuery(STscStmt *pStmt) {
+  SSqlObj *pSql = pStmt->pSql;
+  SSqlRes *pRes = &pSql->res;
+  STscObj *pObj = pStmt->pObj;
+
+  char *sql = (pStmt->numOfParams > 0) ? pStmt->querySql : pStmt->sqlstr;
+  if (sql == NULL) {
+    return tscStmtSetErrMsg(pStmt, "parameters are not bound");
+  }
+
+  if (tscStmtSetSqlStr(pSql, sql) != TSDB_CODE_SUCCESS) {
+    return tscStmtSetError(pStmt, TSDB_CODE_CLI_OUT_OF_MEMORY);
+  }
+
+  tscTrace("%p SQL: %s pObj:%p", pSql, pSql->sqlstr, pObj);
+
+  pRes->numOfRows = 1;
+  pRes->numOfTotal = 0;
+  pRes->numOfRspBytes = 0;
+
+  pRes->code = (uint8_t)tsParseSql(pSql, pObj->acctId, pObj->db, false);
+
+  pRes->qhandle = 0;
+  pSql->thandle = NULL;
+
+  if (pRes->code != TSDB_CODE_SUCCESS) return pRes->code;
+
+  tscDoQuery(pSql);
+
+  tscTrace("%p SQL result:%d pObj:%p", pSql, pRes->code, pObj);
+  if (pRes->code != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObjPartial(pSql);
+  }
+
+  return pRes->code;
+}
+
+int taos_stmt_execute(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  if (pStmt->sqlstr == NULL) {
+    return tscStmtSetErrMsg(pStmt, "statement is not prepared");
+  }
+
+  if (pStmt->isInsert) {
+    return tscStmtExecuteInsert(pStmt);
+  } else {
+    return tscStmtExecuteQuery(pStmt);
+  }
+}
+
+static int32_t tscGetStmtVgroupCode(int32_t vgid, int32_t *pVgid, int32_t *pCode, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    if (pVgid[i] == vgid) {
+      return pCode[i];
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * execute the batches of several prepared insert statements in one round. The submit blocks of all statements are
+ * merged by vgroup and sent to the vnodes concurrently by the sql object of the first statement, so the number of
+ * round trips is the number of vgroups involved rather than the number of tables. The result of each statement is
+ * set to the result of the vgroup its table belongs to, and the first error is returned.
+ */
+int taos_stmt_execute_batch(TAOS_STMT **stmts, int numOfStmts) {
+  if (stmts == NULL || numOfStmts <= 0) {
+    return TSDB_CODE_INVALID_VALUE;
+  }
+
+  for (int32_t i = 0; i < numOfStmts; ++i) {
+    STscStmt *pStmt = (STscStmt *)stmts[i];
+    if (pStmt == NULL || pStmt->signature != pStmt) {
+      globalCode = TSDB_CODE_DISCONNECTED;
+      return TSDB_CODE_DISCONNECTED;
+    }
+
+    if (pStmt->sqlstr == NULL || !pStmt->isInsert) {
+      return tscStmtSetError(pStmt, TSDB_CODE_OPS_NOT_SUPPORT);
+    }
+  }
+
+  STscStmt *pFirst = (STscStmt *)stmts[0];
+  SSqlObj * pSql = pFirst->pSql;
+  SSqlCmd * pCmd = &pSql->cmd;
+  SSqlRes * pRes = &pSql->res;
+
+  tscCleanSqlCmd(pCmd);
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->isInsertFromFile = 0;
+  pCmd->order.order = pFirst->import;
+
+  SDataBlockList *pTableBlocks = tscCreateBlockArrayList();
+  int32_t         numOfTotal = 0;
+
+  for (int32_t i = 0; i < numOfStmts; ++i) {
+    STscStmt *pStmt = (STscStmt *)stmts[i];
+
+    // rows bound but not added to batch explicitly are submitted as well
+    pStmt->numOfRows += pStmt->numOfBound;
+    pStmt->numOfBound = 0;
+    pStmt->pSql->res.numOfRows = 0;
+    pStmt->pSql->res.code = TSDB_CODE_SUCCESS;
+
+    if (pStmt->numOfRows <= 0) {
+      continue;
+    }
+
+    STableDataBlocks *pDataBlock = pStmt->pDataBlock;
+    tsSetBlockInfo((SShellSubmitBlock *)pDataBlock->pData, pStmt->pMeterMeta, pStmt->numOfRows);
+    pDataBlock->vgid = pStmt->pMeterMeta->vgid;
+    pDataBlock->numOfMeters = 1;
+
+    tscAppendDataBlock(pTableBlocks, pDataBlock);
+    numOfTotal += pStmt->numOfRows;
+
+    pStmt->pDataBlock = NULL;
+  }
+
+  if (pTableBlocks->nSize == 0) {
+    tscDestroyBlockArrayList(pTableBlocks);
+    return tscStmtSetErrMsg(pFirst, "no any data points");
+  }
+
+  // the table blocks are released in merge
+  tscMergeTableDataBlocks(pSql, pTableBlocks);
+
+  SDataBlockList *pDataBlocks = pCmd->pDataBlocks;
+  int32_t         numOfVgroups = pDataBlocks->nSize;
+  int32_t *       pVgid = calloc(numOfVgroups, sizeof(int32_t));
+  int32_t *       pCode = calloc(numOfVgroups, sizeof(int32_t));
+  int32_t         code = TSDB_CODE_SUCCESS;
+
+  if (pVgid == NULL || pCode == NULL) {
+    tfree(pVgid);
+    tfree(pCode);
+    pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+    code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+  } else {
+    for (int32_t i = 0; i < numOfVgroups; ++i) {
+      pVgid[i] = ((STableDataBlocks *)pDataBlocks->pData[i])->vgid;
+    }
+
+    pRes->qhandle = 0;
+    pSql->thandle = NULL;
+
+    // the data blocks of all vgroups are submitted concurrently, and released afterwards
+    code = tscLaunchMultiVnodesInsert(pSql, pCode);
+  }
+
+  tscTrace("%p prepared insert of %d statements, vgroups:%d, rows:%d, affected rows:%d, result:%d", pSql, numOfStmts,
+           numOfVgroups, numOfTotal, pRes->numOfRows, code);
+
+  for (int32_t i = 0; i < numOfStmts; ++i) {
+    STscStmt *pStmt = (STscStmt *)stmts[i];
+    if (pStmt->numOfRows <= 0) {
+      continue;
+    }
+
+    int32_t ret = code;
+    if (pCode != NULL) {
+      ret = tscGetStmtVgroupCode(pStmt->pMeterMeta->vgid, pVgid, pCode, numOfVgroups);
+    }
+
+    pStmt->pSql->res.code = (uint8_t)ret;
+    pStmt->pSql->res.numOfRows = (ret == TSDB_CODE_SUCCESS) ? pStmt->numOfRows : 0;
+    pStmt->numOfRows = 0;
+  }
+
+  tfree(pVgid);
+  tfree(pCode);
+
+  return code;
+}
+
+TAOS_RES *taos_stmt_use_result(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return NULL;
+  }
+
+  return pStmt->pSql;
+}
+
+int taos_stmt_affected_rows(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) return 0;
+
+  return pStmt->pSql->res.numOfRows;
+}
+
+int taos_stmt_errno(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) return globalCode;
+
+  return pStmt->pSql->res.code;
+}
+
+char *taos_stmt_errstr(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  char      temp[256] = {0};
+
+  if (pStmt == NULL || pStmt->signature != pStmt) return tsError[globalCode];
+
+  SSqlObj *pSql = pStmt->pSql;
+  uint8_t  code = pSql->res.code;
+
+  if (code == TSDB_CODE_INVALID_SQL && pSql->cmd.payload != NULL) {
+    snprintf(temp, tListLen(temp), "invalid SQL: %s", pSql->cmd.payload);
+    strcpy(pSql->cmd.payload, temp);
+    return pSql->cmd.payload;
+  } else {
+    return tsError[code];
+  }
+}
+
+int taos_stmt_close(TAOS_STMT *stmt) {
+  STscStmt *pStmt = (STscStmt *)stmt;
+  if (pStmt == NULL || pStmt->signature != pStmt) {
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  tscTrace("%p statement is closed", pStmt->pSql);
+
+  tscStmtReset(pStmt);
+  tscFreeSqlObj(pStmt->pSql);
+
+  pStmt->signature = NULL;
+  free(pStmt);
+
+  return TSDB_CODE_SUCCESS;
+}
@@ -109,6 +109,13 @@ void tscRemoveFromSqlList(SSqlObj *pSql) {
   pSql->listed = 0;
 
   tscSaveSlowQuery(pSql);
+
+  SSqlRes *pRes = &pSql->res;
+  if (pRes->numOfTotal > 0 && pRes->numOfRspBytes > 0) {
+    tscTrace("%p retrieved rows:%d, network bytes:%lld, bytes per row:%.2f", pSql, pRes->numOfTotal,
+             pRes->numOfRspBytes, (double)pRes->numOfRspBytes / pRes->numOfTotal);
+  }
+
   tscTrace("%p removed from sqlList", pSql);
 }
 
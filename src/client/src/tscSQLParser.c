@@ -34,6 +34,7 @@
 #include "tschemautil.h"
 #include "tsclient.h"
 #include "tsql.h"
+#include "thyperloglog.h"
 #pragma GCC diagnostic ignored "-Wunused-variable"
 
 typedef struct SColumnIdList {
@@ -1393,7 +1394,8 @@ int32_t buildSelectionClause(SSqlCmd* pCmd, tSQLExprList* pSelection, bool isMet
       if (ret != TSDB_CODE_SUCCESS) {
         return ret;
       }
-    } else if (pItem->pNode->nSQLOptr >= TK_COUNT && pItem->pNode->nSQLOptr <= TK_LAST_ROW) {
+    } else if ((pItem->pNode->nSQLOptr >= TK_COUNT && pItem->pNode->nSQLOptr <= TK_LAST_ROW) ||
+               pItem->pNode->nSQLOptr == TK_HYPERLOGLOG) {
       // sql function optr
       /* sql function in selection clause, append sql function info in pSqlCmd structure sequentially */
       if (addExprAndResultField(pCmd, outputIndex, pItem) == -1) {
@@ -1654,6 +1656,8 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, int32_t colIdx, tSQLExprItem* pItem
   const char* msg1 = "not support column types";
   const char* msg3 = "illegal column name";
   const char* msg5 = "parameter is out of range [0, 100]";
+  const char* msg6 = "invalid algorithm of apercentile, only 'default' and 't-digest' are supported";
+  const char* msg7 = "precision of hyperloglog is out of range [4, 12]";
 
   switch (optr) {
     case TK_COUNT: {
@@ -1836,8 +1840,9 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, int32_t colIdx, tSQLExprItem* pItem
     case TK_BOTTOM:
     case TK_PERCENTILE:
     case TK_APERCENTILE: {
-      // 1. valid the number of parameters
-      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr != 2) {
+      // 1. valid the number of parameters, the algorithm of apercentile is specified by the optional third parameter
+      if (pItem->pNode->pParam == NULL ||
+          (pItem->pNode->pParam->nExpr != 2 && (optr != TK_APERCENTILE || pItem->pNode->pParam->nExpr != 3))) {
         /* no parameters or more than one parameter for function */
         setErrMsg(pCmd, msg);
         return -1;
@@ -1897,8 +1902,29 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, int32_t colIdx, tSQLExprItem* pItem
           return -1;
         }
 
+        int64_t algo = TSDB_APERCT_ALGO_HISTOGRAM;
+        if (pItem->pNode->pParam->nExpr == 3) {
+          tVariant* pAlgo = &pParamElem[2].pNode->val;
+          if (pParamElem[2].pNode->nSQLOptr != TK_STRING || pAlgo->nType != TSDB_DATA_TYPE_BINARY) {
+            setErrMsg(pCmd, msg6);
+            return -1;
+          }
+
+          if (pAlgo->nLen == 8 && strncasecmp(pAlgo->pz, "t-digest", 8) == 0) {
+            algo = TSDB_APERCT_ALGO_TDIGEST;
+          } else if (pAlgo->nLen != 7 || strncasecmp(pAlgo->pz, "default", 7) != 0) {
+            setErrMsg(pCmd, msg6);
+            return -1;
+          }
+        }
+
         SSqlExpr* pExpr = tscSqlExprInsert(pCmd, colIdx, functionId, idx, resultType, resultSize);
         addExprParams(pExpr, val, TSDB_DATA_TYPE_DOUBLE, sizeof(double));
+
+        // the histogram is the default algorithm, which is not sent to vnode to keep compatible
+        if (algo != TSDB_APERCT_ALGO_HISTOGRAM) {
+          addExprParams(pExpr, (char*)&algo, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t));
+        }
       } else {
         tVariantDump(pVariant, val, TSDB_DATA_TYPE_BIGINT);
 
@@ -1927,6 +1953,52 @@ int32_t addExprAndResultField(SSqlCmd* pCmd, int32_t colIdx, tSQLExprItem* pItem
       insertResultField(pCmd, colIdx, &ids, resultSize, resultType, columnName);
       return numOfAddedColumn;
     }
+    case TK_HYPERLOGLOG: {
+      // 1. valid the number of parameters, the precision of sketch is specified by the optional second parameter
+      if (pItem->pNode->pParam == NULL || pItem->pNode->pParam->nExpr < 1 || pItem->pNode->pParam->nExpr > 2) {
+        setErrMsg(pCmd, msg);
+        return -1;
+      }
+
+      tSQLExprItem* pParamElem = &(pItem->pNode->pParam->a[0]);
+      if (pParamElem->pNode->nSQLOptr != TK_ID) {
+        setErrMsg(pCmd, msg);
+        return -1;
+      }
+
+      int32_t idx = getColumnIndexByName(&pParamElem->pNode->colInfo, pSchema, pCmd->pMeterMeta->numOfColumns);
+      if (idx < 0) {
+        setErrMsg(pCmd, msg3);
+        return -1;
+      }
+
+      // 2. valid the precision, all data types are supported
+      int64_t precision = HLL_DEFAULT_PRECISION;
+      if (pItem->pNode->pParam->nExpr == 2) {
+        tSQLExpr* pPrecision = pParamElem[1].pNode;
+        if (pPrecision->nSQLOptr != TK_INTEGER || pPrecision->val.i64Key < HLL_MIN_PRECISION ||
+            pPrecision->val.i64Key > HLL_MAX_PRECISION) {
+          setErrMsg(pCmd, msg7);
+          return -1;
+        }
+
+        precision = pPrecision->val.i64Key;
+      }
+
+      char columnName[TSDB_COL_NAME_LEN] = {0};
+      getColumnName(pItem, columnName, TSDB_COL_NAME_LEN);
+
+      int16_t resultType = 0;
+      int16_t resultSize = 0;
+      getResultInfo(pSchema[idx].type, pSchema[idx].bytes, TSDB_FUNC_HLL, 0, &resultType, &resultSize);
+
+      SSqlExpr* pExpr = tscSqlExprInsert(pCmd, colIdx, TSDB_FUNC_HLL, idx, resultType, resultSize);
+      addExprParams(pExpr, (char*)&precision, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t));
+
+      SColumnList ids = {.numOfCols = 1, .ids = {idx}};
+      insertResultField(pCmd, colIdx, &ids, resultSize, resultType, columnName);
+      return numOfAddedColumn;
+    }
     default:
       return -1;
   }
@@ -2023,6 +2095,9 @@ int32_t changeFunctionID(int32_t optr, int16_t* functionId) {
     case TK_LAST_ROW:
       *functionId = TSDB_FUNC_LAST_ROW;
       break;
+    case TK_HYPERLOGLOG:
+      *functionId = TSDB_FUNC_HLL;
+      break;
     default:
       return -1;
   }
@@ -2183,26 +2258,37 @@ bool validateIpAddress(char* ip) {
   return (ipAddr != 0) && (ipAddr != 0xffffffff);
 }
 
-void tscTansformSQLFunctionForMetricQuery(SSqlCmd* pCmd) {
-  if (pCmd->pMeterMeta == NULL || !UTIL_METER_IS_METRIC(pCmd)) {
-    return;
+bool tscTransformSQLFunctionToDst(SSqlCmd* pCmd, int32_t index) {
+  SSqlExpr*   pExpr = tscSqlExprGet(pCmd, index);
+  TAOS_FIELD* pField = tscFieldInfoGetField(pCmd, index);
+
+  int16_t functionId = aAggs[pExpr->sqlFuncId].stableFuncId;
+  if (!((functionId >= TSDB_FUNC_SUM_DST && functionId <= TSDB_FUNC_APERCT_DST) ||
+        functionId == TSDB_FUNC_STDDEV_DST || functionId == TSDB_FUNC_HLL_DST)) {
+    return false;
   }
 
-  assert(pCmd->pMeterMeta->numOfTags >= 0);
+  int32_t param = pExpr->param[0].i64Key;
+  if (functionId == TSDB_FUNC_APERCT_DST) {  // the size of intermediate result is decided by the algorithm
+    param = (pExpr->numOfParams > 1) ? pExpr->param[1].i64Key : TSDB_APERCT_ALGO_HISTOGRAM;
+  }
 
   int16_t bytes = 0;
   int16_t type = 0;
+  getResultInfo(pField->type, pField->bytes, functionId, param, &type, &bytes);
+  tscSqlExprUpdate(pCmd, index, functionId, pExpr->colInfo.colIdx, TSDB_DATA_TYPE_BINARY, bytes);
+  return true;
+}
 
-  for (int32_t k = 0; k < pCmd->fieldsInfo.numOfOutputCols; ++k) {
-    SSqlExpr*   pExpr = tscSqlExprGet(pCmd, k);
-    TAOS_FIELD* pField = tscFieldInfoGetField(pCmd, k);
+void tscTansformSQLFunctionForMetricQuery(SSqlCmd* pCmd) {
+  if (pCmd->pMeterMeta == NULL || !UTIL_METER_IS_METRIC(pCmd)) {
+    return;
+  }
 
-    int16_t functionId = aAggs[pExpr->sqlFuncId].stableFuncId;
+  assert(pCmd->pMeterMeta->numOfTags >= 0);
 
-    if (functionId >= TSDB_FUNC_SUM_DST && functionId <= TSDB_FUNC_APERCT_DST) {
-      getResultInfo(pField->type, pField->bytes, functionId, pExpr->param[0].i64Key, &type, &bytes);
-      tscSqlExprUpdate(pCmd, k, functionId, pExpr->colInfo.colIdx, TSDB_DATA_TYPE_BINARY, bytes);
-    }
+  for (int32_t k = 0; k < pCmd->fieldsInfo.numOfOutputCols; ++k) {
+    tscTransformSQLFunctionToDst(pCmd, k);
   }
 
   tscFieldInfoRenewOffsetForInterResult(pCmd);
@@ -2218,7 +2304,8 @@ void tscRestoreSQLFunctionForMetricQuery(SSqlCmd* pCmd) {
     SSqlExpr*   pExpr = tscSqlExprGet(pCmd, i);
     TAOS_FIELD* pField = tscFieldInfoGetField(pCmd, i);
 
-    if (pExpr->sqlFuncId >= TSDB_FUNC_SUM_DST && pExpr->sqlFuncId <= TSDB_FUNC_WAVG_DST) {
+    if ((pExpr->sqlFuncId >= TSDB_FUNC_SUM_DST && pExpr->sqlFuncId <= TSDB_FUNC_WAVG_DST) ||
+        pExpr->sqlFuncId == TSDB_FUNC_STDDEV_DST || pExpr->sqlFuncId == TSDB_FUNC_HLL_DST) {
       pExpr->resBytes = pField->bytes;
       pExpr->resType = pField->type;
     }
@@ -2794,8 +2881,8 @@ static bool isValidExpr(tSQLExpr* pLeft, tSQLExpr* pRight, int32_t optr) {
    * However, columnA < 4+12 is valid
    */
   if ((pLeft->nSQLOptr == TK_ID && pRight->nSQLOptr == TK_ID) ||
-      (pLeft->nSQLOptr >= TK_COUNT && pLeft->nSQLOptr <= TK_WAVG) ||
-      (pRight->nSQLOptr >= TK_COUNT && pRight->nSQLOptr <= TK_WAVG) ||
+      (pLeft->nSQLOptr >= TK_COUNT && pLeft->nSQLOptr <= TK_WAVG) || pLeft->nSQLOptr == TK_HYPERLOGLOG ||
+      (pRight->nSQLOptr >= TK_COUNT && pRight->nSQLOptr <= TK_WAVG) || pRight->nSQLOptr == TK_HYPERLOGLOG ||
       (pLeft->nSQLOptr >= TK_BOOL && pLeft->nSQLOptr <= TK_BINARY && pRight->nSQLOptr >= TK_BOOL &&
        pRight->nSQLOptr <= TK_BINARY)) {
     return false;
@@ -62,6 +62,13 @@ int32_t tSQLParse(SSqlInfo *pSQLInfo, const char *pStr) {
         pSQLInfo->validSql = false;
         goto abort_parse;
       }
+      case TK_HYPERLOGLOG: {
+        Parse(pParser, TK_ID, t0, pSQLInfo);
+        if (pSQLInfo->validSql == false) {
+          goto abort_parse;
+        }
+        break;
+      }
       default:
         Parse(pParser, t0.type, t0, pSQLInfo);
         if (pSQLInfo->validSql == false) {
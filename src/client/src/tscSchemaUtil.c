@@ -118,6 +118,26 @@ bool tsMeterMetaIdentical(SMeterMeta* p1, SMeterMeta* p2) {
   return memcmp(p1, p2, size) == 0;
 }
 
+/*
+ * the signature only depends on the layout of tag values, so the tag values of meters with the
+ * same signature can be located by the same tag schema
+ */
+uint32_t tsGetTagSchemaSignature(struct SSchema* pTagSchema, int32_t numOfTags) {
+  char    buf[(TSDB_MAX_TAGS + 1) * (sizeof(int8_t) + sizeof(int16_t))] = {0};
+  int32_t len = 0;
+
+  *(int16_t*)buf = (int16_t)numOfTags;
+  len += sizeof(int16_t);
+
+  for (int32_t i = 0; i < numOfTags && i < TSDB_MAX_TAGS; ++i) {
+    buf[len] = pTagSchema[i].type;
+    *(int16_t*)(buf + len + sizeof(int8_t)) = pTagSchema[i].bytes;
+    len += sizeof(int8_t) + sizeof(int16_t);
+  }
+
+  return MurmurHash3_32(buf, len);
+}
+
 static FORCE_INLINE char* skipSegments(char* input, char delimiter, int32_t num) {
   for (int32_t i = 0; i < num; ++i) {
     while (*input != 0 && *input++ != delimiter) {
@@ -18,7 +18,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 
-#include "tlosertree.h"
+#include "tglobalcfg.h"
 #include "tlosertree.h"
 #include "tscSecondaryMerge.h"
 #include "tscUtil.h"
@@ -58,6 +58,311 @@ int32_t treeComparator(const void *pLeft, const void *pRight, void *param) {
   }
 }
 
+#define TSC_MERGE_WORKER_MIN_SOURCES 4  // the minimum number of data sources merged by one worker
+#define TSC_MERGE_WORKER_QUEUE_SIZE 4   // the number of merged pages queued for the local reducer
+
+/*
+ * the data sources of several vnodes are merged by a worker thread into one sorted output, and the local reducer
+ * merges the outputs of all workers, so the comparison of rows is distributed to multiple threads. The merged pages
+ * are pushed into a bounded queue, which is consumed by the local reducer as soon as they are available.
+ */
+typedef struct SLocalMergeWorker {
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  notEmpty;
+  pthread_cond_t  notFull;
+
+  SLocalDataSource **pDataSrc;
+  int32_t            numOfBuffer;
+  int32_t            numOfCompleted;
+  SLoserTreeInfo *   pLoserTree;
+  SCompareParam      param;
+  tOrderDescriptor * pDesc;  // private copy, since the order columns of local reducer is changed during merge
+  tColModel *        pModel;
+
+  int32_t    pageSize;
+  tFilePage *pPage;  // page in filling
+  tFilePage *pQueue[TSC_MERGE_WORKER_QUEUE_SIZE];
+  int32_t    head;
+  int32_t    numOfPages;
+
+  bool started;
+  bool completed;
+  bool quit;
+} SLocalMergeWorker;
+
+/*
+ * load the next page of data source, return false if the data source is exhausted
+ */
+static bool tscLoadNextPage(SLocalDataSource *pDataSrc);
+
+static void tscPushMergedPage(SLocalMergeWorker *pWorker) {
+  pthread_mutex_lock(&pWorker->mutex);
+
+  while (pWorker->numOfPages == TSC_MERGE_WORKER_QUEUE_SIZE && !pWorker->quit) {
+    pthread_cond_wait(&pWorker->notFull, &pWorker->mutex);
+  }
+
+  if (!pWorker->quit) {
+    int32_t    tail = (pWorker->head + pWorker->numOfPages) % TSC_MERGE_WORKER_QUEUE_SIZE;
+    tFilePage *pTmp = pWorker->pQueue[tail];
+
+    pWorker->pQueue[tail] = pWorker->pPage;
+    pWorker->pPage = pTmp;
+    pWorker->numOfPages += 1;
+
+    pthread_cond_signal(&pWorker->notEmpty);
+  }
+
+  pthread_mutex_unlock(&pWorker->mutex);
+  pWorker->pPage->numOfElems = 0;
+}
+
+static bool tscPopMergedPage(SLocalMergeWorker *pWorker, tFilePage *pPage) {
+  bool ret = false;
+  pthread_mutex_lock(&pWorker->mutex);
+
+  while (pWorker->numOfPages == 0 && !pWorker->completed) {
+    pthread_cond_wait(&pWorker->notEmpty, &pWorker->mutex);
+  }
+
+  if (pWorker->numOfPages > 0) {
+    memcpy(pPage, pWorker->pQueue[pWorker->head], pWorker->pageSize);
+
+    pWorker->head = (pWorker->head + 1) % TSC_MERGE_WORKER_QUEUE_SIZE;
+    pWorker->numOfPages -= 1;
+    ret = true;
+
+    pthread_cond_signal(&pWorker->notFull);
+  }
+
+  pthread_mutex_unlock(&pWorker->mutex);
+  return ret;
+}
+
+static void *tscLocalMergeWorkerMain(void *param) {
+  SLocalMergeWorker *pWorker = (SLocalMergeWorker *)param;
+  SLoserTreeInfo *   pTree = pWorker->pLoserTree;
+  int32_t            capacity = pWorker->param.numOfElems;
+
+  while (pWorker->numOfCompleted < pWorker->numOfBuffer && !pWorker->quit) {
+    SLocalDataSource *pDataSrc = pWorker->pDataSrc[pTree->pNode[0].index];
+
+    tColModelAppend(pWorker->pModel, pWorker->pPage, pDataSrc->filePage.data, pDataSrc->rowIdx, 1, capacity);
+    pDataSrc->rowIdx += 1;
+
+    if (pDataSrc->rowIdx >= pDataSrc->filePage.numOfElems && !tscLoadNextPage(pDataSrc)) {
+      pDataSrc->rowIdx = -1;
+      pDataSrc->pageId = -1;
+      pWorker->numOfCompleted += 1;
+    }
+
+    tLoserTreeAdjust(pTree, pTree->pNode[0].index + pWorker->numOfBuffer);
+
+    if (pWorker->pPage->numOfElems == capacity) {
+      tscPushMergedPage(pWorker);
+    }
+  }
+
+  if (pWorker->pPage->numOfElems > 0) {
+    tscPushMergedPage(pWorker);
+  }
+
+  pthread_mutex_lock(&pWorker->mutex);
+  pWorker->completed = true;
+  pthread_cond_signal(&pWorker->notEmpty);
+  pthread_mutex_unlock(&pWorker->mutex);
+
+  return NULL;
+}
+
+static void tscDestroyLocalMergeWorker(SLocalMergeWorker *pWorker) {
+  if (pWorker == NULL) {
+    return;
+  }
+
+  if (pWorker->started) {
+    pthread_mutex_lock(&pWorker->mutex);
+    pWorker->quit = true;
+    pthread_cond_signal(&pWorker->notFull);
+    pthread_mutex_unlock(&pWorker->mutex);
+
+    pthread_join(pWorker->thread, NULL);
+  }
+
+  for (int32_t i = 0; i < pWorker->numOfBuffer; ++i) {
+    tfree(pWorker->pDataSrc[i]);
+  }
+
+  for (int32_t i = 0; i < TSC_MERGE_WORKER_QUEUE_SIZE; ++i) {
+    tfree(pWorker->pQueue[i]);
+  }
+
+  tfree(pWorker->pPage);
+  tfree(pWorker->pDataSrc);
+  tfree(pWorker->pLoserTree);
+  tfree(pWorker->pDesc);  // the column model is owned by the descriptor of local reducer
+
+  pthread_cond_destroy(&pWorker->notFull);
+  pthread_cond_destroy(&pWorker->notEmpty);
+  pthread_mutex_destroy(&pWorker->mutex);
+
+  free(pWorker);
+}
+
+static SLocalMergeWorker *tscCreateLocalMergeWorker(SLocalDataSource **pDataSrc, int32_t numOfBuffer,
+                                                    tOrderDescriptor *pDesc, int32_t groupOrderType) {
+  SLocalMergeWorker *pWorker = (SLocalMergeWorker *)calloc(1, sizeof(SLocalMergeWorker));
+  if (pWorker == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_init(&pWorker->mutex, NULL);
+  pthread_cond_init(&pWorker->notEmpty, NULL);
+  pthread_cond_init(&pWorker->notFull, NULL);
+
+  tExtMemBuffer *pMemBuffer = pDataSrc[0]->pMemBuffer;
+
+  pWorker->pModel = pMemBuffer->pColModel;
+  pWorker->pageSize = pMemBuffer->nPageSize;
+  pWorker->pDataSrc = (SLocalDataSource **)malloc(POINTER_BYTES * numOfBuffer);
+  pWorker->pPage = (tFilePage *)calloc(1, pWorker->pageSize);
+
+  for (int32_t i = 0; i < TSC_MERGE_WORKER_QUEUE_SIZE; ++i) {
+    pWorker->pQueue[i] = (tFilePage *)calloc(1, pWorker->pageSize);
+    if (pWorker->pQueue[i] == NULL) {
+      tscDestroyLocalMergeWorker(pWorker);
+      return NULL;
+    }
+  }
+
+  size_t descSize = sizeof(tOrderDescriptor) + sizeof(int16_t) * pDesc->orderIdx.numOfOrderedCols;
+  pWorker->pDesc = (tOrderDescriptor *)malloc(descSize);
+
+  if (pWorker->pDataSrc == NULL || pWorker->pPage == NULL || pWorker->pDesc == NULL) {
+    tscDestroyLocalMergeWorker(pWorker);
+    return NULL;
+  }
+
+  memcpy(pWorker->pDesc, pDesc, descSize);
+  memcpy(pWorker->pDataSrc, pDataSrc, POINTER_BYTES * numOfBuffer);
+  pWorker->numOfBuffer = numOfBuffer;
+
+  pWorker->param.pLocalData = pWorker->pDataSrc;
+  pWorker->param.pDesc = pWorker->pDesc;
+  pWorker->param.numOfElems = pMemBuffer->numOfElemsPerPage;
+  pWorker->param.groupOrderType = groupOrderType;
+
+  if (tLoserTreeCreate(&pWorker->pLoserTree, numOfBuffer, &pWorker->param, treeComparator) != TSDB_CODE_SUCCESS) {
+    pWorker->numOfBuffer = 0;  // data sources are still owned by the caller
+    tscDestroyLocalMergeWorker(pWorker);
+    return NULL;
+  }
+
+  return pWorker;
+}
+
+/*
+ * split the data sources into several workers, the data sources of the same vnode are always assigned to the same
+ * worker, since they share one data file. The data sources of local reducer are replaced by the outputs of workers.
+ */
+static int32_t tscCreateLocalMergeWorkers(SLocalReducer *pReducer, int32_t groupOrderType) {
+  int32_t numOfThreads = (tsLocalReduceThreads > 0) ? tsLocalReduceThreads : tsNumOfCores;
+  int32_t numOfWorkers = pReducer->numOfBuffer / TSC_MERGE_WORKER_MIN_SOURCES;
+  if (numOfWorkers > numOfThreads) {
+    numOfWorkers = numOfThreads;
+  }
+
+  if (numOfWorkers < 2) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t *startIdx = (int32_t *)calloc(numOfWorkers + 1, sizeof(int32_t));
+  if (startIdx == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  int32_t numPerWorker = (pReducer->numOfBuffer + numOfWorkers - 1) / numOfWorkers;
+  int32_t numOfGroups = 1;
+
+  for (int32_t i = 1; i < pReducer->numOfBuffer && numOfGroups < numOfWorkers; ++i) {
+    if (i - startIdx[numOfGroups - 1] >= numPerWorker &&
+        pReducer->pLocalDataSrc[i]->pMemBuffer != pReducer->pLocalDataSrc[i - 1]->pMemBuffer) {
+      startIdx[numOfGroups++] = i;
+    }
+  }
+
+  startIdx[numOfGroups] = pReducer->numOfBuffer;
+  if (numOfGroups < 2) {
+    tfree(startIdx);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pReducer->pWorkers = (SLocalMergeWorker **)calloc(numOfGroups, POINTER_BYTES);
+  if (pReducer->pWorkers == NULL) {
+    tfree(startIdx);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SLocalMergeWorker *pWorker =
+        tscCreateLocalMergeWorker(&pReducer->pLocalDataSrc[startIdx[i]], startIdx[i + 1] - startIdx[i],
+                                  pReducer->pDesc, groupOrderType);
+    if (pWorker == NULL) {
+      tfree(startIdx);
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pReducer->pWorkers[pReducer->numOfWorkers++] = pWorker;
+
+    // the data sources are owned by the worker now, so they are released only once if the following ones fail
+    for (int32_t j = startIdx[i]; j < startIdx[i + 1]; ++j) {
+      pReducer->pLocalDataSrc[j] = NULL;
+    }
+  }
+
+  /*
+   * the local reducer merges the outputs of workers instead. The memory buffer of the first data source
+   * is kept to provide the column model of data page.
+   */
+  tExtMemBuffer *pMemBuffer = pReducer->pWorkers[0]->pDataSrc[0]->pMemBuffer;
+  pReducer->numOfBuffer = 0;
+
+  tfree(startIdx);
+
+  for (int32_t i = 0; i < pReducer->numOfWorkers; ++i) {
+    SLocalMergeWorker *pWorker = pReducer->pWorkers[i];
+    if (pthread_create(&pWorker->thread, NULL, tscLocalMergeWorkerMain, pWorker) != 0) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pWorker->started = true;
+  }
+
+  for (int32_t i = 0; i < pReducer->numOfWorkers; ++i) {
+    SLocalDataSource *pDS = (SLocalDataSource *)malloc(sizeof(SLocalDataSource) + pMemBuffer->nPageSize);
+    if (pDS == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pDS->pMemBuffer = pMemBuffer;
+    pDS->pWorker = pReducer->pWorkers[i];
+    pDS->flushoutIdx = -1;
+    pDS->pageId = 0;
+    pDS->rowIdx = 0;
+
+    // wait for the first merged page of each worker
+    if (!tscPopMergedPage(pDS->pWorker, &pDS->filePage)) {
+      tfree(pDS);
+      continue;
+    }
+
+    pReducer->pLocalDataSrc[pReducer->numOfBuffer++] = pDS;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static void tscInitSqlContext(SSqlCmd *pCmd, SSqlRes *pRes, SLocalReducer *pReducer, tOrderDescriptor *pDesc) {
   /*
    * the fields and offset attributes in pCmd and pModel may be different due to
@@ -101,6 +406,12 @@ static void tscInitSqlContext(SSqlCmd *pCmd, SSqlRes *pRes, SLocalReducer *pRedu
       pCtx->param[3].nType = TSDB_DATA_TYPE_BIGINT;
 
       pCtx->param[1].i64Key = pCmd->order.orderColId;
+    } else if (sqlFunction == TSDB_FUNC_APERCT_DST) {
+      /* the algorithm of apercentile is the second parameter */
+      SSqlExpr *pExpr = tscSqlExprGet(pCmd, i);
+
+      pCtx->param[1].i64Key = (pExpr->numOfParams > 1) ? pExpr->param[1].i64Key : TSDB_APERCT_ALGO_HISTOGRAM;
+      pCtx->param[1].nType = TSDB_DATA_TYPE_BIGINT;
     }
   }
 }
@@ -182,6 +493,7 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
       pReducer->pLocalDataSrc[idx] = pDS;
 
       pDS->pMemBuffer = pMemBuffer[i];
+      pDS->pWorker = NULL;
       pDS->flushoutIdx = j;
       pDS->filePage.numOfElems = 0;
       pDS->pageId = 0;
@@ -212,6 +524,16 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
 
   pReducer->numOfBuffer = idx;
 
+  int32_t code = tscCreateLocalMergeWorkers(pReducer, pCmd->groupbyExpr.orderType);
+  if (code != TSDB_CODE_SUCCESS || pReducer->numOfBuffer == 0) {
+    tscError("%p failed to create merge workers", pSqlObjAddr);
+    pRes->code = (code != TSDB_CODE_SUCCESS) ? code : TSDB_CODE_APP_ERROR;
+    return;
+  }
+
+  tscTrace("%p %d merge workers are created, the number of merged leaves is: %d", pSqlObjAddr,
+           pReducer->numOfWorkers, pReducer->numOfBuffer);
+
   SCompareParam *param = malloc(sizeof(SCompareParam));
   param->pLocalData = pReducer->pLocalDataSrc;
   param->pDesc = pReducer->pDesc;
@@ -428,6 +750,12 @@ void tscDestroyLocalReducer(SSqlObj *pSql) {
     tfree(pLocalReducer->pFinalRes);
     tfree(pLocalReducer->discardData);
 
+    // the workers must be stopped before the memory buffers are released
+    for (int32_t i = 0; i < pLocalReducer->numOfWorkers; ++i) {
+      tscDestroyLocalMergeWorker(pLocalReducer->pWorkers[i]);
+    }
+    tfree(pLocalReducer->pWorkers);
+
     tscLocalReducerEnvDestroy(pLocalReducer->pExtMemBuffer, pLocalReducer->pDesc, pLocalReducer->resColModel,
                               pLocalReducer->numOfVnode);
     for (int32_t i = 0; i < pLocalReducer->numOfBuffer; ++i) {
@@ -551,6 +879,10 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
   int32_t capacity = nBufferSizes / rlen;
   pModel = tColModelCreate(pSchema, pCmd->fieldsInfo.numOfOutputCols, capacity);
 
+  // the retrieved results are kept in memory, and spilled to disk only if the local reduce buffer is exhausted
+  int32_t numOfResidentPages =
+      (int32_t)((int64_t)tsLocalReduceBufSize / ((int64_t)DEFAULT_PAGE_SIZE * pCmd->pMetricMeta->numOfVnodes));
+
   for (int32_t i = 0; i < pCmd->pMetricMeta->numOfVnodes; ++i) {
     char tmpPath[512] = {0};
     getExtTmpfilePath("/tv_bf_db_%lld_%lld_%d.d", taosGetPthreadId(), i, 0, tmpPath);
@@ -558,6 +890,8 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
 
     tExtMemBufferCreate(&(*pMemBuffer)[i], nBufferSizes, rlen, tmpPath, pModel);
     (*pMemBuffer)[i]->flushModel = MULTIPLE_APPEND_MODEL;
+    (*pMemBuffer)[i]->nMaxResidentPages = numOfResidentPages;
+    (*pMemBuffer)[i]->compressed = (tsLocalReduceSpillComp != 0);
   }
 
   if (createOrderDescriptor(pOrderDesc, pCmd, pModel) != TSDB_CODE_SUCCESS) {
@@ -604,16 +938,25 @@ void tscLocalReducerEnvDestroy(tExtMemBuffer **pMemBuffer, tOrderDescriptor *pDe
  * @param treeList
  * @return the number of remain input source. if ret == 0, all data has been handled
  */
-int32_t loadNewDataFromDiskFor(SLocalReducer *pLocalReducer, SLocalDataSource *pOneInterDataSrc,
-                               bool *needAdjustLoserTree) {
-  pOneInterDataSrc->rowIdx = 0;
-  pOneInterDataSrc->pageId += 1;
+static bool tscLoadNextPage(SLocalDataSource *pDataSrc) {
+  pDataSrc->rowIdx = 0;
+  pDataSrc->pageId += 1;
 
-  if (pOneInterDataSrc->pageId <
-      pOneInterDataSrc->pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pOneInterDataSrc->flushoutIdx].numOfPages) {
-    tExtMemBufferLoadData(pOneInterDataSrc->pMemBuffer, &(pOneInterDataSrc->filePage), pOneInterDataSrc->flushoutIdx,
-                          pOneInterDataSrc->pageId);
+  if (pDataSrc->pWorker != NULL) {
+    return tscPopMergedPage(pDataSrc->pWorker, &pDataSrc->filePage);
+  }
+
+  tExtMemBuffer *pMemBuffer = pDataSrc->pMemBuffer;
+  if (pDataSrc->pageId >= pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pDataSrc->flushoutIdx].numOfPages) {
+    return false;
+  }
 
+  return tExtMemBufferLoadData(pMemBuffer, &(pDataSrc->filePage), pDataSrc->flushoutIdx, pDataSrc->pageId);
+}
+
+int32_t loadNewDataFromDiskFor(SLocalReducer *pLocalReducer, SLocalDataSource *pOneInterDataSrc,
+                               bool *needAdjustLoserTree) {
+  if (tscLoadNextPage(pOneInterDataSrc)) {
 #if defined(_DEBUG_VIEW)
     printf("new page load to buffer\n");
     tColModelDisplay(pOneInterDataSrc->pMemBuffer->pColModel, pOneInterDataSrc->filePage.data,
@@ -20,12 +20,14 @@
 
 #include "os.h"
 #include "tcache.h"
+#include "tglobalcfg.h"
 #include "trpc.h"
 #include "tscProfile.h"
 #include "tscSecondaryMerge.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
 #include "tsclient.h"
+#include "tscompression.h"
 #include "tsocket.h"
 #include "tsql.h"
 #include "ttime.h"
@@ -373,6 +375,7 @@ void *tscProcessMsgFromServer(char *msg, void *ahandle, void *thandle) {
     pRes->rspLen = pMsg->msgLen - sizeof(SIntMsg);
     pRes->pRsp = (char *)realloc(pRes->pRsp, pRes->rspLen);
     if (pRes->rspLen) memcpy(pRes->pRsp, pMsg->content + 1, pRes->rspLen - 1);
+    tscClearCompressedResult(pRes);
 
     if (pRes->code == TSDB_CODE_DB_ALREADY_EXIST && pCmd->existsCheck && pRes->rspType == TSDB_MSG_TYPE_CREATE_DB_RSP) {
       /* ignore the error information returned from mnode when set ignore flag in sql */
@@ -769,6 +772,13 @@ void tscRetrieveFromVnodeCallBack(void *param, TAOS_RES *tres, int numOfRows) {
     assert(pRes->numOfRows == numOfRows);
     __sync_add_and_fetch_64(trsupport->numOfTotalRetrievedPoints, numOfRows);
 
+    // network statistics of sub-queries are accumulated in the parent query
+    __sync_add_and_fetch_64(&pPObj->res.numOfRspBytes, pRes->rspLen);
+
+    if (tscDecompressResult(pCmd, pRes) != TSDB_CODE_SUCCESS) {
+      return tscAbortFurtherRetryRetrieval(trsupport, tres, TSDB_CODE_APP_ERROR);
+    }
+
     tscTrace("%p sub:%p retrieve numOfRows:%d totalNumOfRows:%d from ip:%u,vid:%d,orderOfSub:%d",
              pPObj, pSql, pRes->numOfRows, *trsupport->numOfTotalRetrievedPoints, pSvd->ip, pSvd->vnode, idx);
 
@@ -1027,6 +1037,8 @@ int tscBuildRetrieveMsg(SSqlObj *pSql) {
   pMsg += 8;
   *pMsg = pSql->cmd.type;
   pMsg += 1;
+  *pMsg = pSql->pTscObj->retrieveComp;
+  pMsg += 1;
 
   msgLen = pMsg - pStart;
   pSql->cmd.payloadLen = msgLen;
@@ -1035,6 +1047,31 @@ int tscBuildRetrieveMsg(SSqlObj *pSql) {
   return msgLen;
 }
 
+/*
+ * the rows after stime are subscribed, vnode holds the request until etime if there is none, and returns at most
+ * limit rows
+ */
+int tscBuildSubscribeMsg(SSqlObj *pSql) {
+  SSqlCmd *      pCmd = &pSql->cmd;
+  SMeterMeta *   pMeterMeta = pCmd->pMeterMeta;
+  SSubscribeMsg *pSubMsg = (SSubscribeMsg *)(pCmd->payload + tsRpcHeadSize);
+
+  int64_t waitTime = pCmd->etime - taosGetTimestampMs();
+  if (waitTime < 0) waitTime = 0;
+
+  pSubMsg->vnode = htons(pMeterMeta->vpeerDesc[pSql->index].vnode);
+  pSubMsg->sid = htonl(pMeterMeta->sid);
+  pSubMsg->uid = htobe64(pMeterMeta->uid);
+  pSubMsg->offset = htobe64(pCmd->stime);
+  pSubMsg->credit = htonl((int32_t)pCmd->limit.limit);
+  pSubMsg->waitTime = htonl((int32_t)waitTime);
+
+  pCmd->payloadLen = sizeof(SSubscribeMsg);
+  pCmd->msgType = TSDB_MSG_TYPE_SUBSCRIBE;
+
+  return pCmd->payloadLen;
+}
+
 void tscUpdateVnodeInSubmitMsg(SSqlObj *pSql, char* buf) {
   SShellSubmitMsg *pShellMsg;
   char *           pMsg;
@@ -1107,8 +1144,46 @@ static int32_t tscEstimateQueryMsgSize(SSqlCmd *pCmd) {
 
   int32_t meterInfoSize = (pMetricMeta->tagLen + sizeof(SMeterSidExtInfo)) * pVnodeSidList->numOfSids;
   int32_t outputColumnSize = pCmd->fieldsInfo.numOfOutputCols * sizeof(SSqlFuncExprMsg);
+  int32_t tagFilterSize = 0;
 
-  return meterInfoSize + outputColumnSize + srcColListSize + exprSize + MIN_QUERY_MSG_PKT_SIZE;
+  if (pCmd->tagFilterPushdown) {
+    tagFilterSize = sizeof(STagFilterMsg) + sizeof(SSchema) * pCmd->pMeterMeta->numOfTags +
+                    sizeof(int16_t) * pCmd->numOfReqTags + pCmd->tagCond.len + 1;
+  }
+
+  return meterInfoSize + outputColumnSize + srcColListSize + exprSize + tagFilterSize + MIN_QUERY_MSG_PKT_SIZE;
+}
+
+/*
+ * the tag condition and the full tag schema of metric are sent to vnode, which selects the meters by itself
+ */
+static char *tscBuildTagFilterMsg(SSqlCmd *pCmd, char *pMsg) {
+  SMeterMeta *   pMeterMeta = pCmd->pMeterMeta;
+  SSchema *      pTagSchema = tsGetTagSchema(pMeterMeta);
+  STagFilterMsg *pFilter = (STagFilterMsg *)pMsg;
+
+  pFilter->metricUid = htobe64(pMeterMeta->uid);
+  pFilter->tagSig = htonl(tsGetTagSchemaSignature(pTagSchema, pMeterMeta->numOfTags));
+  pFilter->numOfTags = htons(pMeterMeta->numOfTags);
+  pFilter->condLen = htonl(pCmd->tagCond.len + 1);
+  pMsg += sizeof(STagFilterMsg);
+
+  memcpy(pMsg, pTagSchema, sizeof(SSchema) * pMeterMeta->numOfTags);
+  pMsg += sizeof(SSchema) * pMeterMeta->numOfTags;
+
+  for (int32_t j = 0; j < pCmd->numOfReqTags; ++j) {
+    *((int16_t *)pMsg) = htons(pCmd->tagColumnIndex[j]);
+    pMsg += sizeof(int16_t);
+  }
+
+  if (pCmd->tagCond.len > 0) {
+    memcpy(pMsg, tsGetMetricQueryCondPos(&pCmd->tagCond), pCmd->tagCond.len);
+  }
+
+  pMsg[pCmd->tagCond.len] = 0;
+  pMsg += pCmd->tagCond.len + 1;
+
+  return pMsg;
 }
 
 int tscBuildQueryMsg(SSqlObj *pSql) {
@@ -1146,8 +1221,9 @@ int tscBuildQueryMsg(SSqlObj *pSql) {
     SVnodeSidList *pVnodeSidList = tscGetVnodeSidList(pMetricMeta, pCmd->vnodeIdx - 1);
     uint32_t       vnodeId = pVnodeSidList->vpeerDesc[pVnodeSidList->index].vnode;
 
+    // the sids are absent if the meters are selected by vnode according to the tag condition
     numOfMeters = pVnodeSidList->numOfSids;
-    if (numOfMeters <= 0) {
+    if (numOfMeters < 0 || (numOfMeters == 0 && !pCmd->tagFilterPushdown)) {
       tscError("%p vid:%d,error numOfMeters in query message:%d", pSql, vnodeId, numOfMeters);
       return -1;  // error
     }
@@ -1383,6 +1459,13 @@ int tscBuildQueryMsg(SSqlObj *pSql) {
     }
   }
 
+  pQueryMsg->tagFilterLen = 0;
+  if (UTIL_METER_IS_METRIC(pCmd) && pCmd->tagFilterPushdown) {
+    char *pFilter = pMsg;
+    pMsg = tscBuildTagFilterMsg(pCmd, pMsg);
+    pQueryMsg->tagFilterLen = htonl(pMsg - pFilter);
+  }
+
   msgLen = pMsg - pStart;
 
   tscTrace("%p msg built success,len:%d bytes", pSql, msgLen);
@@ -1931,6 +2014,25 @@ int tscBuildCreateTableMsg(SSqlObj *pSql) {
   return msgLen;
 }
 
+int tscBuildMultiCreateTableMsg(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  char *   pStart = pCmd->payload + tsRpcHeadSize;
+  int32_t  len = pCmd->payloadLen;
+
+  // SMultiCreateTableMsg is kept in payload during parse
+  memmove(pStart + sizeof(SMgmtHead), pCmd->payload, len);
+
+  SMgmtHead *pMgmt = (SMgmtHead *)pStart;
+  tscGetDBInfoFromMeterId(pCmd->name, pMgmt->db);
+
+  int32_t msgLen = sizeof(SMgmtHead) + len;
+  pCmd->payloadLen = msgLen;
+  pCmd->msgType = TSDB_MSG_TYPE_MULTI_CREATE_TABLE;
+
+  assert(msgLen + minMsgSize() <= pCmd->allocSize);
+  return msgLen;
+}
+
 int tscEstimateAlterTableMsgLength(SSqlCmd *pCmd) {
   return minMsgSize() + sizeof(SMgmtHead) + sizeof(SAlterTableMsg) + sizeof(SSchema) * pCmd->numOfCols +
          TSDB_EXTRA_PAYLOAD_SIZE;
@@ -2240,6 +2342,28 @@ int tscBuildMeterMetaMsg(SSqlObj *pSql) {
   return msgLen;
 }
 
+/*
+ * the SMultiMeterInfoMsg is prepared at the beginning of payload by tscGetMultiMeterMeta,
+ * and payloadLen is the length of it before the msg is built.
+ */
+int tscBuildMultiMeterMetaMsg(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  char *   pStart = pCmd->payload + tsRpcHeadSize;
+  int32_t  len = pCmd->payloadLen;
+
+  memmove(pStart + sizeof(SMgmtHead), pCmd->payload, len);
+
+  SMgmtHead *pMgmt = (SMgmtHead *)pStart;
+  tscGetDBInfoFromMeterId(pCmd->name, pMgmt->db);
+
+  int32_t msgLen = sizeof(SMgmtHead) + len;
+  pCmd->payloadLen = msgLen;
+  pCmd->msgType = TSDB_MSG_TYPE_MULTI_METERINFO;
+
+  assert(msgLen + minMsgSize() <= pCmd->allocSize);
+  return msgLen;
+}
+
 static int32_t tscEstimateMetricMetaMsgSize(SSqlCmd *pCmd) {
   const int32_t defaultSize =
       minMsgSize() + sizeof(SMetricMetaMsg) + sizeof(SMgmtHead) + sizeof(int16_t) * TSDB_MAX_TAGS;
@@ -2273,10 +2397,13 @@ int tscBuildMetricMetaMsg(SSqlObj *pSql) {
   pMetaMsg = (SMetricMetaMsg *)pMsg;
   strcpy(pMetaMsg->meterId, pCmd->name);
 
-  pMetaMsg->type = htons(pCmd->tagCond.type);
-  pMetaMsg->condLength = htonl(pCmd->tagCond.len);
+  int32_t condLen = pCmd->tagFilterPushdown ? 0 : pCmd->tagCond.len;
 
-  if (pCmd->tagCond.len > 0) {
+  // only the vnodes are required if the tag condition is evaluated by vnodes
+  pMetaMsg->type = htons(pCmd->tagFilterPushdown ? TSQL_STABLE_QTYPE_VNODES : pCmd->tagCond.type);
+  pMetaMsg->condLength = htonl(condLen);
+
+  if (condLen > 0) {
     /* convert to unicode before sending to mnode for metric query */
     bool ret = taosMbsToUcs4(tsGetMetricQueryCondPos(&pCmd->tagCond), pCmd->tagCond.len, (char *)pMetaMsg->tags,
                              pCmd->tagCond.len * TSDB_NCHAR_SIZE);
@@ -2287,7 +2414,7 @@ int tscBuildMetricMetaMsg(SSqlObj *pSql) {
   }
 
   pMsg += sizeof(SMetricMetaMsg);
-  pMsg += pCmd->tagCond.len * TSDB_NCHAR_SIZE;
+  pMsg += condLen * TSDB_NCHAR_SIZE;
 
   SSqlGroupbyExpr *pGroupby = &pCmd->groupbyExpr;
 
@@ -2392,21 +2519,13 @@ int tscProcessRetrieveRspFromMgmt(SSqlObj *pSql) {
   return 0;
 }
 
-int tscProcessMeterMetaRsp(SSqlObj *pSql) {
-  SMeterMeta *pMeta;
-  SSchema *   pSchema;
-  uint8_t     ieType;
-
-  char *rsp = pSql->res.pRsp;
-
-  ieType = *rsp;
-  if (ieType != TSDB_IE_TYPE_META) {
-    tscError("invalid ie type:%d", ieType);
-    return TSDB_CODE_INVALID_IE;
-  }
-
-  rsp++;
-  pMeta = (SMeterMeta *)rsp;
+/*
+ * convert the meter meta, which is followed by schema and tags, in response msg into host byte order,
+ * the total length of meter meta, schema and tags is returned by size.
+ */
+static int32_t tscDecodeMeterMeta(SMeterMeta *pMeta, int32_t *size) {
+  SSchema *pSchema;
+  char *   rsp = (char *)pMeta;
 
   pMeta->sid = htonl(pMeta->sid);
   pMeta->sversion = htonl(pMeta->sversion);
@@ -2428,11 +2547,6 @@ int tscProcessMeterMetaRsp(SSqlObj *pSql) {
     return TSDB_CODE_INVALID_VALUE;
   }
 
-  if (pMeta->numOfTags > TSDB_MAX_TAGS || pMeta->numOfTags < 0) {
-    tscError("invalid numOfTags:%d", pMeta->numOfTags);
-    return TSDB_CODE_INVALID_VALUE;
-  }
-
   if (pMeta->numOfColumns > TSDB_MAX_COLUMNS || pMeta->numOfColumns < 0) {
     tscError("invalid numOfColumns:%d", pMeta->numOfColumns);
     return TSDB_CODE_INVALID_VALUE;
@@ -2471,10 +2585,33 @@ int tscProcessMeterMetaRsp(SSqlObj *pSql) {
   }
 
   rsp += tagLen;
-  int32_t size = (int32_t)(rsp - (char *)pMeta);
+  *size = (int32_t)(rsp - (char *)pMeta);
 
   // pMeta->index = rand() % TSDB_VNODES_SUPPORT;
   pMeta->index = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+int tscProcessMeterMetaRsp(SSqlObj *pSql) {
+  SMeterMeta *pMeta;
+  uint8_t     ieType;
+
+  char *rsp = pSql->res.pRsp;
+
+  ieType = *rsp;
+  if (ieType != TSDB_IE_TYPE_META) {
+    tscError("invalid ie type:%d", ieType);
+    return TSDB_CODE_INVALID_IE;
+  }
+
+  rsp++;
+  pMeta = (SMeterMeta *)rsp;
+
+  int32_t size = 0;
+  int32_t code = tscDecodeMeterMeta(pMeta, &size);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
 
   // todo add one more function: taosAddDataIfNotExists();
   taosRemoveDataFromCache(tscCacheHandle, (void **)&(pSql->cmd.pMeterMeta), false);
@@ -2486,57 +2623,241 @@ int tscProcessMeterMetaRsp(SSqlObj *pSql) {
   return TSDB_CODE_OTHERS;
 }
 
-int tscProcessMetricMetaRsp(SSqlObj *pSql) {
-  SMetricMeta *pMeta;
-  uint8_t      ieType;
-  char *       rsp = pSql->res.pRsp;
+/*
+ * the meter meta of all meters in response are put into cache, the failed meters are skipped and
+ * handled by the following tscGetMeterMeta.
+ */
+int tscProcessMultiMeterMetaRsp(SSqlObj *pSql) {
+  SSqlRes *pRes = &pSql->res;
+  char *   rsp = pRes->pRsp;
+  char *   pEnd = pRes->pRsp + pRes->rspLen - 1;
 
-  ieType = *rsp;
+  uint8_t ieType = *rsp;
   if (ieType != TSDB_IE_TYPE_META) {
     tscError("invalid ie type:%d", ieType);
     return TSDB_CODE_INVALID_IE;
   }
 
   rsp++;
-  pMeta = (SMetricMeta *)rsp;
-  size_t size = (size_t)pSql->res.rspLen - 1;
-  rsp = rsp + sizeof(SMetricMeta);
+  SMultiMeterMetaRsp *pRsp = (SMultiMeterMetaRsp *)rsp;
+  int32_t             numOfMeters = htonl(pRsp->numOfMeters);
+  int32_t             numOfRetrieved = 0;
+
+  rsp += sizeof(SMultiMeterMetaRsp);
+
+  for (int32_t i = 0; i < numOfMeters; ++i) {
+    SMultiMeterMeta *pMultiMeta = (SMultiMeterMeta *)rsp;
+    if (rsp + sizeof(SMultiMeterMeta) > pEnd) {
+      tscError("%p invalid multi-meter-meta rsp, meters:%d, index:%d", pSql, numOfMeters, i);
+      break;
+    }
+
+    int32_t code = htonl(pMultiMeta->code);
+    int32_t metaLen = htonl(pMultiMeta->metaLen);
+
+    rsp += sizeof(SMultiMeterMeta) + metaLen;
+    if (rsp > pEnd) {
+      tscError("%p invalid multi-meter-meta rsp, meters:%d, index:%d", pSql, numOfMeters, i);
+      break;
+    }
+
+    if (code != TSDB_CODE_SUCCESS) {
+      tscTrace("%p failed to get meter meta of %s, code:%d", pSql, pMultiMeta->meterId, code);
+      continue;
+    }
+
+    int32_t size = 0;
+    if (tscDecodeMeterMeta((SMeterMeta *)pMultiMeta->meta, &size) != TSDB_CODE_SUCCESS) {
+      continue;
+    }
+
+    SMeterMeta *pMeta = (SMeterMeta *)taosAddDataIntoCache(tscCacheHandle, pMultiMeta->meterId, pMultiMeta->meta,
+                                                            size, tsMeterMetaKeepTimer);
+    taosRemoveDataFromCache(tscCacheHandle, (void **)&pMeta, false);
+    numOfRetrieved++;
+  }
+
+  tscTrace("%p meter meta of %d meters are retrieved, total:%d", pSql, numOfRetrieved, numOfMeters);
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * decode the compressed sids and tags of one vnode, the tags are transposed from column layout to row layout
+ */
+static int32_t tscDecodeVnodeSidList(SVnodeSidListRsp *pRspList, SVnodeSidList *pLists, int32_t numOfTags,
+                                     int16_t *tagBytes, int32_t tagLen, char *pRaw, char *pTemp, int32_t tempSize) {
+  int32_t numOfSids = pLists->numOfSids;
+  int32_t sidLen = htonl(pRspList->sidLen);
+  int32_t compTagLen = htonl(pRspList->tagLen);
+
+  if (numOfSids == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t *sids = (int32_t *)pRaw;
+  if (tsDecompressInt(pRspList->data, sidLen, numOfSids, (char *)sids, numOfSids * sizeof(int32_t), TWO_STAGE_COMP,
+                      pTemp, tempSize) != numOfSids * sizeof(int32_t)) {
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  char *pTags = pRaw + numOfSids * sizeof(int32_t);
+  if (tagLen > 0 && tsDecompressString(pRspList->data + sidLen, compTagLen, numOfSids, pTags, numOfSids * tagLen,
+                                       ONE_STAGE_COMP, NULL, 0) != numOfSids * tagLen) {
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  char * pStr = (char *)pLists + sizeof(SVnodeSidList) + sizeof(SMeterSidExtInfo *) * numOfSids;
+  size_t sidSize = sizeof(SMeterSidExtInfo) + tagLen;
+
+  for (int32_t j = 0; j < numOfSids; ++j, pStr += sidSize) {
+    pLists->pSidExtInfoList[j] = pStr - (char *)pLists;
+
+    SMeterSidExtInfo *pInfo = (SMeterSidExtInfo *)pStr;
+    pInfo->sid = sids[j];
+    pInfo->pObj = NULL;
+
+    char *pCol = pTags;
+    for (int32_t k = 0, offset = 0; k < numOfTags; offset += tagBytes[k], pCol += numOfSids * tagBytes[k], ++k) {
+      memcpy(pInfo->tags + offset, pCol + j * tagBytes[k], (size_t)tagBytes[k]);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the metric meta is decoded vnode by vnode, but the sub-queries are launched only after the whole response is
+ * decoded and cached, since the parser, tscLaunchMetricSubQueries, the local reducer and the projection queries
+ * all size their states from the complete SMetricMeta. So the response is not paged by vnodes.
+ */
+int tscProcessMetricMetaRsp(SSqlObj *pSql) {
+  SMetricMetaRsp *pMeta;
+  uint8_t         ieType;
+  char *          rsp = pSql->res.pRsp;
+  char *          pEnd = rsp + pSql->res.rspLen;
+
+  // the mgmt node of earlier versions sends the metric meta uncompressed, which can not be decoded here
+  ieType = *rsp;
+  if (ieType != TSDB_IE_TYPE_METRIC_META) {
+    tscError("%p invalid ie type:%d of metric meta, the version of mgmt node may be earlier", pSql, ieType);
+    return TSDB_CODE_INVALID_IE;
+  }
+
+  rsp++;
+  pMeta = (SMetricMetaRsp *)rsp;
+
+  int32_t numOfMeters = htonl(pMeta->numOfMeters);
+  int32_t numOfVnodes = htonl(pMeta->numOfVnodes);
+  int32_t tagLen = htons(pMeta->tagLen);
+  int32_t numOfTags = htons(pMeta->numOfTags);
+
+  if (numOfTags < 0 || numOfTags > TSDB_MAX_TAGS + 1 || numOfVnodes < 0 || numOfMeters < 0 ||
+      rsp + sizeof(SMetricMetaRsp) + sizeof(int16_t) * numOfTags > pEnd) {
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  // the tags of each meter are decoded by the bytes of each tag, which shall fill the tag length exactly
+  int16_t tagBytes[TSDB_MAX_TAGS + 1] = {0};
+  int32_t totalBytes = 0;
+  for (int32_t k = 0; k < numOfTags; ++k) {
+    tagBytes[k] = htons(pMeta->tagBytes[k]);
+    if (tagBytes[k] < 0) {
+      return TSDB_CODE_INVALID_MSG_LEN;
+    }
+
+    totalBytes += tagBytes[k];
+  }
+
+  if (totalBytes != tagLen) {
+    tscError("%p invalid metric meta, tag length:%d, sum of tag bytes:%d", pSql, tagLen, totalBytes);
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  rsp += sizeof(SMetricMetaRsp) + sizeof(int16_t) * numOfTags;
 
-  pMeta->numOfMeters = htonl(pMeta->numOfMeters);
-  pMeta->numOfVnodes = htonl(pMeta->numOfVnodes);
-  pMeta->tagLen = htons(pMeta->tagLen);
+  // the sids are absent if the tag condition is evaluated by vnodes
+  int32_t numOfSids = pSql->cmd.tagFilterPushdown ? 0 : numOfMeters;
 
-  size += pMeta->numOfVnodes * sizeof(SVnodeSidList *) + pMeta->numOfMeters * sizeof(SMeterSidExtInfo *);
+  size_t sidSize = sizeof(SMeterSidExtInfo) + tagLen;
+  size_t size = sizeof(SMetricMeta) + numOfVnodes * (sizeof(SVnodeSidList *) + sizeof(SVnodeSidList)) +
+                numOfSids * (sizeof(SMeterSidExtInfo *) + sidSize);
 
   char *pStr = calloc(1, size);
+  if (pStr == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
 
   SMetricMeta *pNewMetricMeta = (SMetricMeta *)pStr;
-  pNewMetricMeta->numOfMeters = pMeta->numOfMeters;
-  pNewMetricMeta->numOfVnodes = pMeta->numOfVnodes;
-  pNewMetricMeta->tagLen = pMeta->tagLen;
+  pNewMetricMeta->numOfMeters = numOfMeters;
+  pNewMetricMeta->numOfVnodes = numOfVnodes;
+  pNewMetricMeta->tagLen = tagLen;
 
   pStr = pStr + sizeof(SMetricMeta) + pNewMetricMeta->numOfVnodes * sizeof(SVnodeSidList *);
 
-  for (int32_t i = 0; i < pMeta->numOfVnodes; ++i) {
-    SVnodeSidList *pSidLists = (SVnodeSidList *)rsp;
-    memcpy(pStr, pSidLists, sizeof(SVnodeSidList));
+  // buffers to decode one vnode, which are enlarged for the vnode with more tables
+  char *  pRaw = NULL;
+  char *  pTemp = NULL;
+  int32_t maxSids = 0;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  for (int32_t i = 0; i < numOfVnodes; ++i) {
+    SVnodeSidListRsp *pRspList = (SVnodeSidListRsp *)rsp;
+    if (pEnd - rsp < (int64_t)sizeof(SVnodeSidListRsp)) {
+      code = TSDB_CODE_INVALID_MSG_LEN;
+      break;
+    }
+
+    // each length is checked against the remaining message, so the sum of them does not overflow
+    int32_t sidLen = (int32_t)htonl(pRspList->sidLen);
+    int32_t compTagLen = (int32_t)htonl(pRspList->tagLen);
+    int64_t remain = pEnd - rsp - (int64_t)sizeof(SVnodeSidListRsp);
+    if (sidLen < 0 || compTagLen < 0 || sidLen > remain || compTagLen > remain - sidLen) {
+      code = TSDB_CODE_INVALID_MSG_LEN;
+      break;
+    }
 
-    pNewMetricMeta->list[i] = pStr - (char *)pNewMetricMeta;  // offset value
     SVnodeSidList *pLists = (SVnodeSidList *)pStr;
+    pLists->vpeerDesc[0].vnode = htonl(pRspList->vnode);
+    pLists->numOfSids = htonl(pRspList->numOfSids);
+    pNewMetricMeta->list[i] = pStr - (char *)pNewMetricMeta;  // offset value
+
+    if (pLists->numOfSids < 0 || (numOfSids -= pLists->numOfSids) < 0) {
+      code = TSDB_CODE_INVALID_MSG_LEN;
+      break;
+    }
 
     tscTrace("%p metricmeta:vid:%d,numOfMeters:%d", pSql, i, pLists->numOfSids);
 
-    pStr += sizeof(SVnodeSidList) + sizeof(SMeterSidExtInfo *) * pSidLists->numOfSids;
-    rsp += sizeof(SVnodeSidList);
+    if (pLists->numOfSids > maxSids) {
+      maxSids = pLists->numOfSids;
+      tfree(pRaw);
+      tfree(pTemp);
 
-    size_t sidSize = sizeof(SMeterSidExtInfo) + pNewMetricMeta->tagLen;
-    for (int32_t j = 0; j < pSidLists->numOfSids; ++j) {
-      pLists->pSidExtInfoList[j] = pStr - (char *)pLists;
-      memcpy(pStr, rsp, sidSize);
+      pRaw = malloc((size_t)maxSids * (sizeof(int32_t) + tagLen));
+      pTemp = malloc((size_t)maxSids * sizeof(int64_t) + 128);
+      if (pRaw == NULL || pTemp == NULL) {
+        code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+        break;
+      }
+    }
 
-      rsp += sidSize;
-      pStr += sidSize;
+    code = tscDecodeVnodeSidList(pRspList, pLists, numOfTags, tagBytes, tagLen, pRaw, pTemp,
+                                 maxSids * sizeof(int64_t) + 128);
+    if (code != TSDB_CODE_SUCCESS) {
+      break;
     }
+
+    pStr += sizeof(SVnodeSidList) + (sizeof(SMeterSidExtInfo *) + sidSize) * pLists->numOfSids;
+    rsp += sizeof(SVnodeSidListRsp) + sidLen + compTagLen;
+  }
+
+  tfree(pRaw);
+  tfree(pTemp);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to decode metric meta, code:%d", pSql, code);
+    tfree(pNewMetricMeta);
+    return code;
   }
 
   char name[TSDB_MAX_TAGS_LEN + 1] = {0};
@@ -2659,6 +2980,22 @@ int tscProcessDropTableRsp(SSqlObj *pSql) {
   return 0;
 }
 
+/*
+ * the error of multi-create is carried in rsp body, with the number of tables before the failed one, which are
+ * created or already exist
+ */
+int tscProcessMultiCreateTableRsp(SSqlObj *pSql) {
+  SSqlRes *             pRes = &pSql->res;
+  SMultiCreateTableRsp *pRsp = (SMultiCreateTableRsp *)pRes->pRsp;
+
+  pRes->code = (uint8_t)htonl(pRsp->code);
+  pRes->numOfRows = htonl(pRsp->numOfCreated);
+
+  tscTrace("%p multi-create table rsp, tables in msg:%d, created:%d, code:%d", pSql, pSql->cmd.count, pRes->numOfRows,
+           pRes->code);
+  return 0;
+}
+
 int tscProcessAlterTableMsgRsp(SSqlObj *pSql) {
   SMeterMeta *pMeterMeta = taosGetDataFromCache(tscCacheHandle, pSql->cmd.name);
   if (pMeterMeta == NULL) { /* not in cache, abort */
@@ -2712,6 +3049,18 @@ int tscProcessRetrieveRspFromVnode(SSqlObj *pSql) {
 
   pRes->data = pRetrieve->data;
   pRes->useconds = pRetrieve->useconds;
+  pRes->numOfRspBytes += pRes->rspLen;
+
+  if (pRetrieve->compressed && pRes->numOfRows > 0) {
+    int32_t code = tscSetCompressedResult(pCmd, pRes, pRetrieve->data,
+                                          pRes->rspLen - 1 - (int32_t)sizeof(SRetrieveMeterRsp));
+    if (code != TSDB_CODE_SUCCESS) {
+      tscError("%p invalid compressed retrieve rsp, len:%d", pSql, pRes->rspLen);
+      pRes->numOfRows = 0;
+      pRes->code = code;
+      return code;
+    }
+  }
 
   tscSetResultPointer(pCmd, pRes);
   pRes->row = 0;
@@ -2814,6 +3163,62 @@ int tscGetMeterMetaEx(SSqlObj *pSql, char *meterId, bool createIfNotExists) {
   return tscGetMeterMeta(pSql, meterId);
 }
 
+/**
+ * retrieve the meter meta of a list of meters in one msg, and put them into cache
+ *
+ * @param pSql          sql object that issues the request
+ * @param pMsg          SMultiMeterInfoMsg in network byte order
+ * @param msgLen        length of pMsg
+ * @param meterId       one of the meters, the db name is extracted from it
+ * @return              status code, TSDB_CODE_ACTION_IN_PROGRESS for async sql object, and
+ *                      tscMeterMetaCallBack is invoked after the response is received
+ */
+int tscGetMultiMeterMeta(SSqlObj *pSql, char *pMsg, int32_t msgLen, char *meterId) {
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+  if (pNew == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  pNew->pTscObj = pSql->pTscObj;
+  pNew->signature = pNew;
+  pNew->cmd.command = TSDB_SQL_MULTI_META;
+
+  int32_t size = msgLen + sizeof(SMgmtHead) + minMsgSize() + TSDB_EXTRA_PAYLOAD_SIZE;
+  if (tscAllocPayloadWithSize(&pNew->cmd, size) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  strncpy(pNew->cmd.name, meterId, TSDB_METER_ID_LEN - 1);
+  memcpy(pNew->cmd.payload, pMsg, msgLen);
+  pNew->cmd.payloadLen = msgLen;
+
+  tscTrace("%p new pSqlObj:%p to get multi-meter meta, msgLen:%d", pSql, pNew, msgLen);
+
+  if (pSql->fp == NULL) {
+    sem_init(&pNew->rspSem, 0, 0);
+    sem_init(&pNew->emptyRspSem, 0, 1);
+
+    code = tscProcessSql(pNew);
+    tscTrace("%p get multi-meter meta complete, code:%d", pSql, code);
+
+    tscFreeSqlObj(pNew);
+  } else {
+    pNew->fp = tscMeterMetaCallBack;
+    pNew->param = pSql;
+    pNew->sqlstr = strdup((pSql->sqlstr != NULL) ? pSql->sqlstr : "");
+
+    code = tscProcessSql(pNew);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_ACTION_IN_PROGRESS;
+    }
+  }
+
+  return code;
+}
+
 /*
  * in handling the renew metermeta problem during insertion,
  * If the meter is created on demand during insertion, the routine usually waits for a short
@@ -2873,6 +3278,10 @@ int tscGetMetricMeta(SSqlObj *pSql, char *meterId) {
   int  code = TSDB_CODE_NETWORK_UNAVAIL;
   char tagstr[TSDB_MAX_TAGS_LEN + 1] = {0};
 
+  // the tag condition is evaluated by vnodes, except for the query on a list of table names
+  pSql->cmd.tagFilterPushdown = (tsTagFilterPushdown != 0 && pSql->cmd.command == TSDB_SQL_SELECT &&
+                                 pSql->cmd.tagCond.type != TSQL_STABLE_QTYPE_SET);
+
   /*
    * the vnode query condition is serialized into pCmd->payload, we need to rebuild key for metricmeta info in cache.
    */
@@ -2896,6 +3305,7 @@ int tscGetMetricMeta(SSqlObj *pSql, char *meterId) {
 
   // the query condition on meter is serialized into payload
   tscTagCondAssign(&pNew->cmd.tagCond, &pSql->cmd.tagCond);
+  pNew->cmd.tagFilterPushdown = pSql->cmd.tagFilterPushdown;
 
   pNew->cmd.groupbyExpr = pSql->cmd.groupbyExpr;
 
@@ -2933,6 +3343,7 @@ void tscInitMsgs() {
   tscBuildMsg[TSDB_SQL_SELECT] = tscBuildQueryMsg;
   tscBuildMsg[TSDB_SQL_INSERT] = tscBuildSubmitMsg;
   tscBuildMsg[TSDB_SQL_FETCH] = tscBuildRetrieveMsg;
+  tscBuildMsg[TSDB_SQL_SUBSCRIBE] = tscBuildSubscribeMsg;
 
   tscBuildMsg[TSDB_SQL_CREATE_DB] = tscBuildCreateDbMsg;
   tscBuildMsg[TSDB_SQL_CREATE_USER] = tscBuildCreateUserMsg;
@@ -2941,6 +3352,7 @@ void tscInitMsgs() {
   tscBuildMsg[TSDB_SQL_ALTER_ACCT] = tscBuildAlterAcctMsg;
 
   tscBuildMsg[TSDB_SQL_CREATE_TABLE] = tscBuildCreateTableMsg;
+  tscBuildMsg[TSDB_SQL_MULTI_CREATE_TABLE] = tscBuildMultiCreateTableMsg;
   tscBuildMsg[TSDB_SQL_DROP_USER] = tscBuildDropUserMsg;
   tscBuildMsg[TSDB_SQL_DROP_ACCT] = tscBuildDropAcctMsg;
   tscBuildMsg[TSDB_SQL_DROP_DB] = tscBuildDropDbMsg;
@@ -2955,6 +3367,7 @@ void tscInitMsgs() {
   tscBuildMsg[TSDB_SQL_CONNECT] = tscBuildConnectMsg;
   tscBuildMsg[TSDB_SQL_USE_DB] = tscBuildUseDbMsg;
   tscBuildMsg[TSDB_SQL_META] = tscBuildMeterMetaMsg;
+  tscBuildMsg[TSDB_SQL_MULTI_META] = tscBuildMultiMeterMetaMsg;
   tscBuildMsg[TSDB_SQL_METRIC] = tscBuildMetricMetaMsg;
 
   tscBuildMsg[TSDB_SQL_HB] = tscBuildHeartBeatMsg;
@@ -2972,6 +3385,7 @@ void tscInitMsgs() {
   tscProcessMsgRsp[TSDB_SQL_CONNECT] = tscProcessConnectRsp;
   tscProcessMsgRsp[TSDB_SQL_USE_DB] = tscProcessUseDbRsp;
   tscProcessMsgRsp[TSDB_SQL_META] = tscProcessMeterMetaRsp;
+  tscProcessMsgRsp[TSDB_SQL_MULTI_META] = tscProcessMultiMeterMetaRsp;
   tscProcessMsgRsp[TSDB_SQL_METRIC] = tscProcessMetricMetaRsp;
 
   tscProcessMsgRsp[TSDB_SQL_SHOW] = tscProcessShowRsp;
@@ -2983,6 +3397,7 @@ void tscInitMsgs() {
   tscProcessMsgRsp[TSDB_SQL_RETRIEVE_METRIC] = tscProcessRetrieveMetricRsp;
 
   tscProcessMsgRsp[TSDB_SQL_ALTER_TABLE] = tscProcessAlterTableMsgRsp;
+  tscProcessMsgRsp[TSDB_SQL_MULTI_CREATE_TABLE] = tscProcessMultiCreateTableRsp;
   tscProcessMsgRsp[TSDB_SQL_ALTER_DB] = tscProcessAlterDbMsgRsp;
 
   tscKeepConn[TSDB_SQL_SHOW] = 1;
@@ -2990,6 +3405,7 @@ void tscInitMsgs() {
   tscKeepConn[TSDB_SQL_SELECT] = 1;
   tscKeepConn[TSDB_SQL_FETCH] = 1;
   tscKeepConn[TSDB_SQL_HB] = 1;
+  tscKeepConn[TSDB_SQL_SUBSCRIBE] = 1;
 
   tscUpdateVnodeMsg[TSDB_SQL_SELECT] = tscUpdateVnodeInQueryMsg;
   tscUpdateVnodeMsg[TSDB_SQL_INSERT] = tscUpdateVnodeInSubmitMsg;
@@ -74,6 +74,7 @@ TAOS *taos_connect_imp(char *ip, char *user, char *pass, char *db, int port, voi
   strncpy(pObj->user, user, TSDB_USER_LEN);
   taosEncryptPass((uint8_t *)pass, strlen(pass), pObj->pass);
   pObj->mgmtPort = port ? port : tsMgmtShellPort;
+  pObj->retrieveComp = (tsRetrieveCompress != 0);
 
   if (db) {
     int32_t len = strlen(db);
@@ -184,6 +185,9 @@ void taos_close(TAOS *taos) {
   if (pObj == NULL) return;
   if (pObj->signature != pObj) return;
 
+  // rows kept in the client insert buffer are flushed before the connection is closed
+  tscDestroyInsertBuffer(pObj);
+
   if (pObj->pHb != NULL) {
     tscSetFreeHeatBeat(pObj);
   } else {
@@ -203,6 +207,11 @@ int taos_query(TAOS *taos, char *sqlstr) {
 
   pRes->numOfRows = 1;
   pRes->numOfTotal = 0;
+  pRes->numOfRspBytes = 0;
+
+  // the failed vgroups are kept after the query fails, until the next query
+  pRes->numOfFailedVgroups = 0;
+  tfree(pRes->pFailedVgroups);
 
   tscTrace("%p SQL: %s pObj:%p", pSql, sqlstr, pObj);
 
@@ -285,6 +294,19 @@ int taos_affected_rows(TAOS *taos) {
   return (pObj->pSql->res.numOfRows);
 }
 
+int taos_failed_vgroups(TAOS_RES *res, int *vgid, int *code, int size) {
+  SSqlObj *pSql = (SSqlObj *)res;
+  if (pSql == NULL || pSql->signature != pSql) return 0;
+
+  SSqlRes *pRes = &pSql->res;
+  for (int32_t i = 0; i < pRes->numOfFailedVgroups && i < size; ++i) {
+    if (vgid != NULL) vgid[i] = pRes->pFailedVgroups[i * 2];
+    if (code != NULL) code[i] = pRes->pFailedVgroups[i * 2 + 1];
+  }
+
+  return pRes->numOfFailedVgroups;
+}
+
 TAOS_FIELD *taos_fetch_fields(TAOS_RES *res) {
   SSqlObj *pSql = (SSqlObj *)res;
   if (pSql == NULL || pSql->signature != pSql) return 0;
@@ -317,7 +339,8 @@ int taos_fetch_block_impl(TAOS_RES *res, TAOS_ROW *rows) {
   SSqlRes *pRes = &pSql->res;
   STscObj *pObj = pSql->pTscObj;
 
-  if (pRes->qhandle == 0 || pObj->pSql != pSql) {
+  // the sql objects of prepared statements are fetched synchronously as well
+  if (pRes->qhandle == 0 || (pObj->pSql != pSql && pSql->fp != NULL)) {
     *rows = NULL;
     return 0;
   }
@@ -341,6 +364,11 @@ int taos_fetch_block_impl(TAOS_RES *res, TAOS_ROW *rows) {
     pRes->numOfTotal += pRes->numOfRows;
   }
 
+  if (tscDecompressResult(pCmd, pRes) != TSDB_CODE_SUCCESS) {
+    *rows = NULL;
+    return 0;
+  }
+
   for (int i = 0; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
     pRes->tsrow[i] = TSC_GET_RESPTR_BASE(pRes, pCmd, i, pCmd->order) +
                      pRes->bytes[i] * (1 - pCmd->order.order) * (pRes->numOfRows - 1);
@@ -361,7 +389,7 @@ TAOS_ROW taos_fetch_row_impl(TAOS_RES *res) {
   if (pRes->qhandle == 0) return NULL;
 
   if (pRes->row >= pRes->numOfRows) {
-    if (pObj->pSql != pSql) return NULL;
+    if (pObj->pSql != pSql && pSql->fp != NULL) return NULL;
 
     pRes->row = 0;
     pRes->numOfRows = 0;
@@ -382,6 +410,11 @@ TAOS_ROW taos_fetch_row_impl(TAOS_RES *res) {
   }
 
   for (int i = 0; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
+    // compressed column is decompressed when it is accessed for the first time
+    if (tscDecompressResultColumn(pCmd, pRes, i) != TSDB_CODE_SUCCESS) {
+      return NULL;
+    }
+
     pRes->tsrow[i] = TSC_GET_RESPTR_BASE(pRes, pCmd, i, pCmd->order) + pRes->bytes[i] * pRes->row;
     // primary key column cannot be null in interval query, no need to check
     if (i == 0 && pCmd->nAggTimeInterval > 0) {
@@ -506,6 +539,93 @@ int taos_fetch_block(TAOS_RES *res, TAOS_ROW *rows) {
   return nRows;
 }
 
+/*
+ * the column data is returned directly from the result buffer in ascending query, the values are reversed into
+ * a separate buffer in descending query since they are kept in reverse order.
+ */
+int taos_fetch_columns(TAOS_RES *res, TAOS_COLUMN **columns) {
+  SSqlObj *pSql = (SSqlObj *)res;
+  TAOS_ROW rows = NULL;
+
+  *columns = NULL;
+  if (pSql == NULL || pSql->signature != pSql) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return 0;
+  }
+
+  taos_fetch_block(res, &rows);
+  if (rows == NULL) {
+    return 0;
+  }
+
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  int32_t numOfCols = pCmd->fieldsInfo.numOfOutputCols;
+  int32_t numOfRows = pRes->numOfRows;
+  int32_t bitmapLen = (numOfRows + 7) >> 3;
+
+  int32_t size = bitmapLen * numOfCols;
+  if (pCmd->order.order == TSQL_SO_DESC) {
+    size += tscGetResRowLength(pCmd) * numOfRows;
+  }
+
+  if (pRes->pColumns == NULL) {
+    pRes->pColumns = calloc(TSDB_MAX_COLUMNS, sizeof(TAOS_COLUMN));
+  }
+
+  if (pRes->colBufSize < size) {
+    char *tmp = realloc(pRes->pColBuf, size);
+    if (tmp != NULL) {
+      pRes->pColBuf = tmp;
+      pRes->colBufSize = size;
+    }
+  }
+
+  if (pRes->pColumns == NULL || pRes->colBufSize < size) {
+    pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return -pRes->code;
+  }
+
+  memset(pRes->pColBuf, 0, bitmapLen * numOfCols);
+  char *pData = pRes->pColBuf + bitmapLen * numOfCols;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    TAOS_FIELD * pField = tscFieldInfoGetField(pCmd, i);
+    TAOS_COLUMN *pCol = &pRes->pColumns[i];
+
+    pCol->type = pField->type;
+    pCol->bytes = pField->bytes;
+    pCol->nullBitmap = (unsigned char *)pRes->pColBuf + bitmapLen * i;
+
+    char *pSrc = pRes->data + tscFieldInfoGetOffset(pCmd, i) * numOfRows;
+    if (pCmd->order.order == TSQL_SO_DESC) {
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        memcpy(pData + j * pField->bytes, pSrc + (numOfRows - 1 - j) * pField->bytes, pField->bytes);
+      }
+
+      pCol->data = pData;
+      pData += pField->bytes * numOfRows;
+    } else {
+      pCol->data = pSrc;
+    }
+
+    // primary key column cannot be null in interval query, no need to check
+    if (i == 0 && pCmd->nAggTimeInterval > 0) {
+      continue;
+    }
+
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      if (isNull((char *)pCol->data + j * pField->bytes, pField->type)) {
+        pCol->nullBitmap[j >> 3] |= (1u << (j & 7u));
+      }
+    }
+  }
+
+  *columns = pRes->pColumns;
+  return numOfRows;
+}
+
 int taos_select_db(TAOS *taos, char *db) {
   char sql[64];
 
@@ -766,3 +886,77 @@ int taos_validate_sql(TAOS *taos, char *sql) {
 
   return code;
 }
+
+/*
+ * retrieve the meter meta of tables in tableNameList, which are separated by comma, in batch
+ * and put them into cache, so the following insertions or queries on these tables are free
+ * from retrieving meter meta one by one.
+ */
+int taos_load_table_info(TAOS *taos, const char *tableNameList) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    globalCode = TSDB_CODE_DISCONNECTED;
+    return TSDB_CODE_DISCONNECTED;
+  }
+
+  SSqlObj *pSql = pObj->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  pRes->numOfTotal = 0;
+  pRes->numOfRows = 0;
+  pRes->code = TSDB_CODE_SUCCESS;
+
+  char *str = malloc(strlen(tableNameList) + 1);
+  if (str == NULL || tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    tfree(str);
+    pRes->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+    return pRes->code;
+  }
+
+  strtolower(str, tableNameList);
+
+  SMultiMeterInfoBuf buf = {0};
+  int32_t            code = TSDB_CODE_SUCCESS;
+  char *             savePtr = NULL;
+
+  for (char *name = strtok_r(str, ",", &savePtr); name != NULL; name = strtok_r(NULL, ",", &savePtr)) {
+    strtrim(name);
+
+    int32_t len = (int32_t)strlen(name);
+    if (len == 0) {
+      continue;
+    }
+
+    SSQLToken token = {len, TK_ID, name};
+    if (validateTableName(name, len) != TSDB_CODE_SUCCESS || setMeterID(pSql, &token) != TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_INVALID_SQL;
+      snprintf(pCmd->payload, pCmd->allocSize, "invalid table name:%s", name);
+      break;
+    }
+
+    if (tscIsMeterMetaInCache(pCmd->name)) {
+      continue;
+    }
+
+    if ((code = tscAddMeterInfo(&buf, pCmd->name, NULL)) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    if (buf.numOfMeters >= TSDB_MAX_METERS_IN_MULTI_META && (code = tscGetMeterMetaInBatch(pSql, &buf)) != 0) {
+      break;
+    }
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscGetMeterMetaInBatch(pSql, &buf);
+  }
+
+  tscTrace("%p load table info completed, code:%d, pObj:%p", pSql, code, pObj);
+
+  tscDestroyMultiMeterInfoBuf(&buf);
+  free(str);
+
+  pRes->code = code;
+  return code;
+}
@@ -58,6 +58,257 @@ static int64_t tscGetRetryDelayTime(int64_t slidingTime, int16_t prec) {
   }
 }
 
+/*
+ * For a sliding window stream on a normal table, the window is made of interval/sliding slide-sized panes. The
+ * partial results of each pane are queried once with the distributed version of the functions, cached here, and
+ * merged through the secondary merge of the functions to produce the result of each window. So each launch only
+ * queries the newest pane, instead of the whole window.
+ */
+#define TSC_STREAM_MAX_PANES 1024
+
+typedef struct SStreamPanes {
+  int32_t         numOfPanes;
+  int32_t         rowSize;      // size of the partial results of one pane
+  int32_t *       offset;       // offset of each column in the partial results of one pane
+  TSKEY *         keys;         // start key of the pane cached in each slot, -1 if not cached
+  int8_t *        hasData;
+  char *          data;
+  TSKEY           qskey;        // start key of the panes queried by current launch
+  TAOS_FIELD *    pFields;      // fields of the final results
+  SQLFunctionCtx *pCtx;
+  char *          pResBuf;
+  int32_t *       resOffset;
+} SStreamPanes;
+
+// wavg is not mergeable, its secondary merge keeps the last partial result instead of accumulating them
+static bool tscIsPaneMergeableFunc(int16_t functionId) {
+  switch (functionId) {
+    case TSDB_FUNC_COUNT:
+    case TSDB_FUNC_SUM:
+    case TSDB_FUNC_AVG:
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX:
+    case TSDB_FUNC_STDDEV:
+    case TSDB_FUNC_APERCT:
+    case TSDB_FUNC_FIRST:
+    case TSDB_FUNC_LAST:
+    case TSDB_FUNC_SPREAD:
+    case TSDB_FUNC_HLL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void tscDestroyStreamPanes(SSqlStream *pStream) {
+  SStreamPanes *pPanes = pStream->pPanes;
+  if (pPanes == NULL) return;
+
+  tfree(pPanes->offset);
+  tfree(pPanes->keys);
+  tfree(pPanes->hasData);
+  tfree(pPanes->data);
+  tfree(pPanes->pFields);
+  tfree(pPanes->pCtx);
+  tfree(pPanes->pResBuf);
+  tfree(pPanes->resOffset);
+  tfree(pStream->pPanes);
+}
+
+/* the fields of query are switched between the partial results of panes and the final results of window */
+static void tscSetStreamPaneFields(SSqlStream *pStream, bool partial) {
+  SStreamPanes *pPanes = pStream->pPanes;
+  SSqlCmd *     pCmd = &pStream->pSql->cmd;
+
+  for (int32_t i = 0; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
+    TAOS_FIELD *pField = tscFieldInfoGetField(pCmd, i);
+    *pField = pPanes->pFields[i];
+
+    if (partial) {
+      SSqlExpr *pExpr = tscSqlExprGet(pCmd, i);
+      pField->type = pExpr->resType;
+      pField->bytes = pExpr->resBytes;
+    }
+  }
+
+  tscFieldInfoCalOffset(pCmd);
+}
+
+static void tscSetupStreamPanes(SSqlStream *pStream) {
+  SSqlObj *pSql = pStream->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  if (isProjectStream(pCmd) || UTIL_METER_IS_METRIC(pCmd) || pCmd->interpoType != TSDB_INTERPO_NONE) return;
+  if (pStream->slidingTime >= pStream->interval || pStream->interval % pStream->slidingTime != 0) return;
+  if (pStream->interval / pStream->slidingTime > TSC_STREAM_MAX_PANES) return;
+
+  int32_t numOfCols = pCmd->fieldsInfo.numOfOutputCols;
+  if (tscSqlExprGet(pCmd, 0)->sqlFuncId != TSDB_FUNC_TS) return;
+
+  for (int32_t i = 1; i < numOfCols; ++i) {
+    SSqlExpr *pExpr = tscSqlExprGet(pCmd, i);
+    if (!tscIsPaneMergeableFunc(pExpr->sqlFuncId) || tscFieldInfoGetField(pCmd, i)->type == TSDB_DATA_TYPE_NCHAR) {
+      return;
+    }
+  }
+
+  SStreamPanes *pPanes = calloc(1, sizeof(SStreamPanes));
+  if (pPanes == NULL) return;
+
+  pStream->pPanes = pPanes;
+  pPanes->numOfPanes = (int32_t)(pStream->interval / pStream->slidingTime);
+  pPanes->offset = calloc(numOfCols, sizeof(int32_t));
+  pPanes->resOffset = calloc(numOfCols, sizeof(int32_t));
+  pPanes->pFields = calloc(numOfCols, sizeof(TAOS_FIELD));
+  pPanes->pCtx = calloc(numOfCols, sizeof(SQLFunctionCtx));
+  pPanes->keys = malloc(pPanes->numOfPanes * sizeof(TSKEY));
+  pPanes->hasData = calloc(pPanes->numOfPanes, sizeof(int8_t));
+
+  if (pPanes->offset == NULL || pPanes->resOffset == NULL || pPanes->pFields == NULL || pPanes->pCtx == NULL ||
+      pPanes->keys == NULL || pPanes->hasData == NULL) {
+    tscDestroyStreamPanes(pStream);
+    return;
+  }
+
+  // the same transformation as the query on metric, the distributed functions output the partial results
+  int32_t resSize = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SSqlExpr *  pExpr = tscSqlExprGet(pCmd, i);
+    TAOS_FIELD *pField = tscFieldInfoGetField(pCmd, i);
+
+    pPanes->pFields[i] = *pField;
+
+    tscTransformSQLFunctionToDst(pCmd, i);
+
+    pPanes->offset[i] = pPanes->rowSize;
+    pPanes->rowSize += pExpr->resBytes;
+
+    // the output buffer keeps the partial results during merge
+    pPanes->resOffset[i] = resSize;
+    resSize += MAX(pExpr->resBytes, pField->bytes);
+  }
+
+  pPanes->data = malloc((size_t)pPanes->numOfPanes * pPanes->rowSize);
+  pPanes->pResBuf = malloc(resSize);
+  if (pPanes->data == NULL || pPanes->pResBuf == NULL) {
+    tscDestroyStreamPanes(pStream);
+    return;
+  }
+
+  for (int32_t i = 0; i < pPanes->numOfPanes; ++i) {
+    pPanes->keys[i] = -1;
+  }
+
+  // each pane is an interval of the query
+  pCmd->nAggTimeInterval = pStream->slidingTime;
+
+  tscTrace("%p stream:%p, window is computed by %d panes", pSql, pStream, pPanes->numOfPanes);
+}
+
+static int32_t tscGetPaneSlot(SSqlStream *pStream, TSKEY key) {
+  return (int32_t)((key / pStream->slidingTime) % pStream->pPanes->numOfPanes);
+}
+
+/* the panes in current window are queried from the first one not cached */
+static TSKEY tscGetPaneQueryStartKey(SSqlStream *pStream) {
+  SStreamPanes *pPanes = pStream->pPanes;
+
+  TSKEY key = pStream->stime - pStream->interval;
+  for (; key < pStream->stime - pStream->slidingTime; key += pStream->slidingTime) {
+    if (pPanes->keys[tscGetPaneSlot(pStream, key)] != key) break;
+  }
+
+  return key;
+}
+
+static void tscSaveStreamPanes(SSqlStream *pStream, SSqlObj *pSql, int32_t numOfRows) {
+  SStreamPanes *pPanes = pStream->pPanes;
+  SSqlCmd *     pCmd = &pSql->cmd;
+  SSqlRes *     pRes = &pSql->res;
+
+  if (tscDecompressResult(pCmd, pRes) != TSDB_CODE_SUCCESS) {
+    tscError("%p stream:%p, failed to decompress partial results", pSql, pStream);
+    return;
+  }
+
+  for (int32_t row = 0; row < numOfRows; ++row) {
+    TSKEY   key = *(TSKEY *)(pRes->data + row * TSDB_KEYSIZE);
+    int32_t slot = tscGetPaneSlot(pStream, key);
+    char *  pDst = pPanes->data + (size_t)slot * pPanes->rowSize;
+
+    for (int32_t i = 0; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
+      int32_t bytes = tscSqlExprGet(pCmd, i)->resBytes;
+      memcpy(pDst + pPanes->offset[i], pRes->data + tscFieldInfoGetOffset(pCmd, i) * numOfRows + row * bytes, bytes);
+    }
+
+    pPanes->keys[slot] = key;
+    pPanes->hasData[slot] = 1;
+  }
+
+  pRes->row = pRes->numOfRows;
+}
+
+/*
+ * merge the partial results of the panes of current window, return false if there is no data in the window
+ */
+static bool tscMergeStreamPanes(SSqlStream *pStream, SSqlObj *pSql, TSKEY *wkey, void **row) {
+  SStreamPanes *pPanes = pStream->pPanes;
+  SSqlCmd *     pCmd = &pSql->cmd;
+  bool          hasData = false;
+
+  *wkey = pStream->stime - pStream->interval;
+
+  // the panes without data in query range are cached as empty
+  for (TSKEY key = pPanes->qskey; key < pStream->stime; key += pStream->slidingTime) {
+    int32_t slot = tscGetPaneSlot(pStream, key);
+    if (pPanes->keys[slot] != key) {
+      pPanes->keys[slot] = key;
+      pPanes->hasData[slot] = 0;
+    }
+  }
+
+  for (int32_t i = 1; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
+    SSqlExpr *      pExpr = tscSqlExprGet(pCmd, i);
+    SQLFunctionCtx *pCtx = &pPanes->pCtx[i];
+
+    memset(pCtx, 0, sizeof(SQLFunctionCtx));
+    pCtx->aOutputBuf = pPanes->pResBuf + pPanes->resOffset[i];
+    pCtx->order = TSQL_SO_ASC;
+    pCtx->inputType = pExpr->resType;
+    pCtx->inputBytes = pExpr->resBytes;
+    pCtx->outputType = pPanes->pFields[i].type;
+    pCtx->outputBytes = pPanes->pFields[i].bytes;
+    pCtx->size = 1;
+    pCtx->hasNullValue = true;
+
+    if (pExpr->sqlFuncId == TSDB_FUNC_APERCT_DST) {
+      pCtx->param[1].i64Key = (pExpr->numOfParams > 1) ? pExpr->param[1].i64Key : TSDB_APERCT_ALGO_HISTOGRAM;
+      pCtx->param[1].nType = TSDB_DATA_TYPE_BIGINT;
+    }
+
+    tVariantAssign(&pCtx->param[0], &pExpr->param[0]);
+    aAggs[pExpr->sqlFuncId].init(pCtx);
+    pCtx->currentStage = SECONDARY_STAGE_MERGE;
+
+    for (TSKEY key = *wkey; key < pStream->stime; key += pStream->slidingTime) {
+      int32_t slot = tscGetPaneSlot(pStream, key);
+      if (!pPanes->hasData[slot]) continue;
+
+      hasData = true;
+      pCtx->aInputElemBuf = pPanes->data + (size_t)slot * pPanes->rowSize + pPanes->offset[i];
+      aAggs[pExpr->sqlFuncId].distSecondaryMergeFunc(pCtx);
+    }
+
+    aAggs[pExpr->sqlFuncId].xFinalize(pCtx);
+    tVariantDestroy(&pCtx->param[0]);
+
+    row[i] = isNull(pCtx->aOutputBuf, pCtx->outputType) ? NULL : pCtx->aOutputBuf;
+  }
+
+  row[0] = wkey;
+  return hasData;
+}
+
 static void tscProcessStreamLaunchQuery(SSchedMsg *pMsg) {
   SSqlStream *pStream = (SSqlStream *)pMsg->ahandle;
   SSqlObj *   pSql = pStream->pSql;
@@ -78,6 +329,9 @@ static void tscProcessStreamLaunchQuery(SSchedMsg *pMsg) {
   }
 
   tscTansformSQLFunctionForMetricQuery(&pSql->cmd);
+  if (pStream->pPanes != NULL) {
+    tscSetStreamPaneFields(pStream, true);
+  }
 
   // failed to get meter/metric meta, retry in 10sec.
   if (code != TSDB_CODE_SUCCESS) {
@@ -117,6 +371,11 @@ static void tscProcessStreamTimer(void *handle, void *tmrId) {
   } else {
     pSql->cmd.stime = pStream->stime - pStream->interval;
     pSql->cmd.etime = pStream->stime - 1;
+
+    if (pStream->pPanes != NULL) {  // only the panes not cached are queried
+      pStream->pPanes->qskey = tscGetPaneQueryStartKey(pStream);
+      pSql->cmd.stime = pStream->pPanes->qskey;
+    }
   }
 
   // launch stream computing in a new thread
@@ -156,6 +415,35 @@ static void tscSetTimestampForRes(SSqlStream *pStream, SSqlObj *pSql, int32_t nu
   }
 }
 
+static void tscProcessStreamPanes(SSqlStream *pStream, SSqlObj *pSql, int32_t numOfRows) {
+  if (numOfRows > 0) {
+    tscSaveStreamPanes(pStream, pSql, numOfRows);
+    taos_fetch_rows_a(pSql, tscProcessStreamRetrieveResult, pStream);
+    return;
+  }
+
+  pStream->useconds += pSql->res.useconds;
+  tscSetStreamPaneFields(pStream, false);
+
+  TSKEY wkey = 0;
+  void *row[TSDB_MAX_COLUMNS] = {0};
+
+  if (tscMergeStreamPanes(pStream, pSql, &wkey, row)) {
+    pStream->numOfRes = 1;
+    tscTrace("%p stream:%p fetch result, panes queried from:%lld", pSql, pStream, pStream->pPanes->qskey);
+
+    // user callback function
+    (*pStream->fp)(pStream->param, pSql, row);
+  }
+
+  tscTrace("%p stream:%p, query on:%s, fetch result completed, fetched rows:%d.", pSql, pStream, pSql->cmd.name,
+           pStream->numOfRes);
+
+  /* release the metric/meter meta information reference, so data in cache can be updated */
+  tscClearSqlMetaInfo(&(pSql->cmd));
+  tscSetNextLaunchTimer(pStream, pSql);
+}
+
 static void tscProcessStreamRetrieveResult(void *param, TAOS_RES *res, int numOfRows) {
   SSqlStream *pStream = (SSqlStream *)param;
   SSqlObj *   pSql = (SSqlObj *)res;
@@ -169,6 +457,11 @@ static void tscProcessStreamRetrieveResult(void *param, TAOS_RES *res, int numOf
     return;
   }
 
+  if (pStream->pPanes != NULL) {
+    tscProcessStreamPanes(pStream, pSql, numOfRows);
+    return;
+  }
+
   if (numOfRows > 0) {  // save
     // when reaching here the first execution of stream computing is successful.
     pStream->numOfRes += numOfRows;
@@ -515,6 +808,7 @@ TAOS_STREAM *taos_open_stream(TAOS *taos, char *sqlstr, void (*fp)(void *param,
   tscAddIntoStreamList(pStream);
 
   tscSetSlidingWindowInfo(pSql, pStream);
+  tscSetupStreamPanes(pStream);
   pStream->stime = tscGetStreamStartTimestamp(pSql, pStream, stime);
 
   int64_t starttime = tscGetLaunchTimestamp(pStream);
@@ -544,6 +838,7 @@ void taos_close_stream(TAOS_STREAM *handle) {
     taosTmrStopA(&(pStream->pTimer));
     tscFreeSqlObj(pSql);
     pStream->pSql = NULL;
+    tscDestroyStreamPanes(pStream);
 
     tscTrace("%p stream:%p is closed", pSql, pStream);
     tfree(pStream);
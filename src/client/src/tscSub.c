@@ -19,11 +19,22 @@
 #include "taos.h"
 #include "tlog.h"
 #include "trpc.h"
+#include "tschemautil.h"
 #include "tsclient.h"
+#include "tscUtil.h"
 #include "tsocket.h"
 #include "ttime.h"
+#include "ttypes.h"
 #include "tutil.h"
 
+/*
+ * The rows of a normal meter are pushed by the vnode: a subscribe request carries the offset(last key consumed) and
+ * the credit(max rows in one response), and the vnode holds the request until new rows arrive or the wait time
+ * elapses. If the offset falls out of the rows kept by vnode, the gap is caught up by one query, then push continues.
+ * Metrics, or any failure on the push path, fall back to the periodical queries.
+ */
+#define TSC_SUB_BUFFER_SIZE (64 * 1024)
+
 typedef struct {
   void *     signature;
   char       name[TSDB_METER_ID_LEN];
@@ -34,8 +45,145 @@ typedef struct {
   int        numOfFields;
   TAOS *     taos;
   TAOS_RES * result;
+  SSqlObj *  pSql;      // sql object for subscribe requests, NULL if rows are polled by queries
+  int32_t    credit;
+  int32_t    numOfRows;  // rows in the last response
+  int32_t    rowIdx;
+  bool       catchup;    // offset is expired in vnode, the gap shall be retrieved by a query
+  char *     buffer;     // converted nchar values of current row
+  void *     row[TSDB_MAX_COLUMNS];
 } SSub;
 
+static void tscFreeSubscribePush(SSub *pSub) {
+  tscFreeSqlObj(pSub->pSql);
+  pSub->pSql = NULL;
+  tfree(pSub->buffer);
+}
+
+static void tscSetupSubscribePush(SSub *pSub) {
+  STscObj *pObj = (STscObj *)pSub->taos;
+  SSqlCmd *pQueryCmd = &pObj->pSql->cmd;
+
+  if (pQueryCmd->pMeterMeta == NULL || UTIL_METER_IS_METRIC(pQueryCmd)) return;
+
+  SSqlObj *pSql = (SSqlObj *)calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) return;
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pObj;
+  pSub->pSql = pSql;
+
+  sem_init(&pSql->rspSem, 0, 0);
+  sem_init(&pSql->emptyRspSem, 0, 1);
+
+  SSqlCmd *pCmd = &pSql->cmd;
+  if (tscAllocPayloadWithSize(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    tscFreeSubscribePush(pSub);
+    return;
+  }
+
+  strcpy(pCmd->name, pQueryCmd->name);
+  if (tscGetMeterMeta(pSql, pCmd->name) != TSDB_CODE_SUCCESS || pCmd->pMeterMeta == NULL ||
+      pCmd->pMeterMeta->numOfColumns != pSub->numOfFields) {
+    tscTrace("%p meter:%s, rows are polled by queries", pSql, pCmd->name);
+    tscFreeSubscribePush(pSub);
+    return;
+  }
+
+  int32_t rowSize = pCmd->pMeterMeta->rowSize;
+  pSub->credit = MAX(1, TSC_SUB_BUFFER_SIZE / rowSize);
+  pSub->buffer = calloc(1, (size_t)(rowSize + pSub->numOfFields));
+  if (pSub->buffer == NULL) {
+    tscFreeSubscribePush(pSub);
+    return;
+  }
+
+  tscTrace("%p meter:%s, rows are pushed by vnode, credit:%d", pSql, pCmd->name, pSub->credit);
+}
+
+/* issue a subscribe request and wait for the response, at most mseconds are waited if no new rows */
+static int tscFetchPushedRows(SSub *pSub) {
+  SSqlObj *pSql = pSub->pSql;
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  pCmd->command = TSDB_SQL_SUBSCRIBE;
+  pCmd->stime = pSub->lastKey;
+  pCmd->etime = taosGetTimestampMs() + pSub->mseconds;
+  pCmd->limit.limit = pSub->credit;
+  pRes->code = TSDB_CODE_SUCCESS;
+
+  int code = tscProcessSql(pSql);
+  if (code != TSDB_CODE_SUCCESS) return code;
+
+  // the first byte of response is the code, the rows follow the head
+  int32_t dataLen = pRes->rspLen - 1 - (int32_t)sizeof(SSubscribeRsp);
+  if (pRes->pRsp == NULL || dataLen < 0) {
+    tscError("%p invalid subscribe rsp, len:%d", pSql, pRes->rspLen);
+    return TSDB_CODE_INVALID_MSG_LEN;
+  }
+
+  SSubscribeRsp *pRsp = (SSubscribeRsp *)pRes->pRsp;
+  if ((int16_t)htons(pRsp->sversion) != pCmd->pMeterMeta->sversion) {
+    tscTrace("%p schema of meter:%s is changed, sversion:%d", pSql, pCmd->name, (int16_t)htons(pRsp->sversion));
+    return TSDB_CODE_WRONG_SCHEMA;
+  }
+
+  pSub->rowIdx = 0;
+  pSub->numOfRows = 0;
+
+  if (pRsp->expired) {
+    tscTrace("%p offset:%ld is expired, catch up by query", pSql, pSub->lastKey);
+    pSub->catchup = true;
+  } else {
+    int32_t numOfRows = htonl(pRsp->numOfRows);
+    if (numOfRows < 0 || (int64_t)numOfRows * pCmd->pMeterMeta->rowSize > dataLen) {
+      tscError("%p invalid subscribe rsp, rows:%d, len:%d", pSql, numOfRows, pRes->rspLen);
+      return TSDB_CODE_INVALID_MSG_LEN;
+    }
+
+    pSub->numOfRows = numOfRows;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/* return NULL if the row is not within the response */
+static TAOS_ROW tscGetPushedRow(SSub *pSub) {
+  SMeterMeta *pMeterMeta = pSub->pSql->cmd.pMeterMeta;
+  SSqlRes *   pRes = &pSub->pSql->res;
+  SSchema *   pSchema = tsGetSchema(pMeterMeta);
+  int32_t     offset = 0;
+
+  if ((int64_t)(pSub->rowIdx + 1) * pMeterMeta->rowSize > pRes->rspLen - 1 - (int32_t)sizeof(SSubscribeRsp)) {
+    tscError("%p invalid subscribe rsp, row:%d, len:%d", pSub->pSql, pSub->rowIdx, pRes->rspLen);
+    return NULL;
+  }
+
+  char *pData = ((SSubscribeRsp *)pRes->pRsp)->data + pSub->rowIdx * pMeterMeta->rowSize;
+
+  for (int i = 0; i < pMeterMeta->numOfColumns; ++i) {
+    char *val = pData + offset;
+
+    if (isNull(val, pSchema[i].type)) {
+      pSub->row[i] = NULL;
+    } else if (pSchema[i].type == TSDB_DATA_TYPE_NCHAR) {
+      char *buf = pSub->buffer + offset + i;
+      memset(buf, 0, pSchema[i].bytes + 1);
+      pSub->row[i] = taosUcs4ToMbs(val, pSchema[i].bytes, buf) ? buf : NULL;
+    } else {
+      pSub->row[i] = val;
+    }
+
+    offset += pSchema[i].bytes;
+  }
+
+  pSub->rowIdx++;
+  pSub->lastKey = *(TSKEY *)pData;
+
+  return pSub->row;
+}
+
 TAOS_SUB *taos_subscribe(char *host, char *user, char *pass, char *db, char *name, int64_t time, int mseconds) {
   SSub *pSub;
 
@@ -74,6 +222,8 @@ TAOS_SUB *taos_subscribe(char *host, char *user, char *pass, char *db, char *nam
       pSub->result = taos_use_result(pSub->taos);
       pSub->numOfFields = taos_num_fields(pSub->result);
       memcpy(pSub->fields, taos_fetch_fields(pSub->result), sizeof(TAOS_FIELD) * pSub->numOfFields);
+
+      tscSetupSubscribePush(pSub);
     }
   }
 
@@ -98,10 +248,34 @@ TAOS_ROW taos_consume(TAOS_SUB *tsub) {
 
       taos_free_result(pSub->result);
       pSub->result = NULL;
-      uint64_t etime = taosGetTimestampMs();
-      int64_t  mseconds = pSub->mseconds - etime + pSub->stime;
-      if (mseconds < 0) mseconds = 0;
-      taosMsleep((int)mseconds);
+
+      if (pSub->catchup) {
+        // the gap is retrieved, new rows are pushed again
+        pSub->catchup = false;
+      } else {
+        uint64_t etime = taosGetTimestampMs();
+        int64_t  mseconds = pSub->mseconds - etime + pSub->stime;
+        if (mseconds < 0) mseconds = 0;
+        taosMsleep((int)mseconds);
+      }
+    }
+
+    if (pSub->pSql != NULL && !pSub->catchup) {
+      int code;
+      if (pSub->rowIdx < pSub->numOfRows) {
+        row = tscGetPushedRow(pSub);
+        if (row != NULL) return row;
+        code = TSDB_CODE_INVALID_MSG_LEN;
+      } else {
+        code = tscFetchPushedRows(pSub);
+      }
+
+      if (code != TSDB_CODE_SUCCESS) {
+        tscError("%p failed to subscribe meter:%s, code:%d, rows are polled by queries", pSub->pSql, pSub->name, code);
+        tscFreeSubscribePush(pSub);
+      }
+
+      continue;
     }
 
     pSub->stime = taosGetTimestampMs();
@@ -129,6 +303,7 @@ void taos_unsubscribe(TAOS_SUB *tsub) {
   if (pSub == NULL) return;
   if (pSub->signature != pSub) return;
 
+  tscFreeSubscribePush(pSub);
   taos_close(pSub->taos);
   free(pSub);
 }
@@ -18,12 +18,14 @@
 #include <time.h>
 
 #include "ihash.h"
+#include "shash.h"
 #include "taosmsg.h"
 #include "tcache.h"
 #include "tkey.h"
 #include "tmd5.h"
 #include "tscProfile.h"
 #include "tscSecondaryMerge.h"
+#include "tscompression.h"
 #include "tscUtil.h"
 #include "tschemautil.h"
 #include "tsclient.h"
@@ -36,6 +38,9 @@
  *
  * if querycond is null, its format is:
  * fullmetername + '.' + '(nil)' + '.' + [tagId1, tagId2,...] + '.' + group_orderType
+ *
+ * if querycond is evaluated by vnodes, only the vnodes of metric are cached, and its format is:
+ * fullmetername + '.' + '(vnodes)' + '.' + [tagId1, tagId2,...] + '.' + group_orderType
  */
 void tscGetMetricMetaCacheKey(SSqlCmd* pCmd, char* keyStr) {
   char*         pTagCondStr = NULL;
@@ -51,7 +56,9 @@ void tscGetMetricMetaCacheKey(SSqlCmd* pCmd, char* keyStr) {
   size_t len = strlen(pCmd->name);
 
   /* for too long key, we use the md5 to generated the key for local cache */
-  if (pCmd->tagCond.len >= TSDB_MAX_TAGS_LEN - RESERVED_SIZE - offset) {
+  if (pCmd->tagFilterPushdown) {
+    pTagCondStr = strdup("(vnodes)");
+  } else if (pCmd->tagCond.len >= TSDB_MAX_TAGS_LEN - RESERVED_SIZE - offset) {
     MD5_CTX ctx;
     MD5Init(&ctx);
     MD5Update(&ctx, (uint8_t*)tsGetMetricQueryCondPos(&pCmd->tagCond), pCmd->tagCond.len);
@@ -249,6 +256,139 @@ void tscDestroyResPointerInfo(SSqlRes* pRes) {
   pRes->numOfnchar = 0;
   pRes->buffer = NULL;
   pRes->bytes = NULL;
+
+  tfree(pRes->pCompCols);
+  tfree(pRes->pDecompBuf);
+  pRes->decompBufSize = 0;
+
+  tfree(pRes->pColumns);
+  tfree(pRes->pColBuf);
+  pRes->colBufSize = 0;
+}
+
+static int (*tscDecompFunc[])(const char *const input, int compressedSize, const int elements, char *const output,
+                              int outputSize, char algorithm, char *const buffer, int bufferSize) = {
+    NULL,
+    tsDecompressBool,
+    tsDecompressTinyint,
+    tsDecompressSmallint,
+    tsDecompressInt,
+    tsDecompressBigint,
+    tsDecompressFloat,
+    tsDecompressDouble,
+    tsDecompressString,
+    tsDecompressTimestamp,
+    tsDecompressString};
+
+/*
+ * locate each compressed column in the retrieve response, the columns are not decompressed until they are
+ * accessed by the fetch functions. pRes->data points to the decompression buffer with the same layout as the
+ * uncompressed result.
+ */
+int32_t tscSetCompressedResult(SSqlCmd* pCmd, SSqlRes* pRes, char* pRspData, int32_t rspDataLen) {
+  int32_t numOfCols = pCmd->fieldsInfo.numOfOutputCols;
+  int32_t maxBytes = 0;
+
+  if (pRes->pCompCols == NULL) {
+    pRes->pCompCols = calloc(TSDB_MAX_COLUMNS, POINTER_BYTES);
+    if (pRes->pCompCols == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+  }
+
+  char* p = pRspData;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (p + sizeof(SRetrieveColHead) > pRspData + rspDataLen) {
+      tscClearCompressedResult(pRes);
+      return TSDB_CODE_APP_ERROR;
+    }
+
+    pRes->pCompCols[i] = p;
+    p += sizeof(SRetrieveColHead) + htonl(((SRetrieveColHead*)p)->len);
+
+    maxBytes = MAX(maxBytes, tscFieldInfoGetField(pCmd, i)->bytes);
+  }
+
+  if (p > pRspData + rspDataLen) {
+    tscClearCompressedResult(pRes);
+    return TSDB_CODE_APP_ERROR;
+  }
+
+  // the decompressed columns are followed by the working buffer of the two-stage decompression
+  int32_t size = tscGetResRowLength(pCmd) * pRes->numOfRows + (maxBytes * pRes->numOfRows * 2 + 2);
+  if (pRes->decompBufSize < size) {
+    char* tmp = realloc(pRes->pDecompBuf, size);
+    if (tmp == NULL) {
+      tscClearCompressedResult(pRes);
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pRes->pDecompBuf = tmp;
+    pRes->decompBufSize = size;
+  }
+
+  pRes->data = pRes->pDecompBuf;
+  return TSDB_CODE_SUCCESS;
+}
+
+void tscClearCompressedResult(SSqlRes* pRes) {
+  if (pRes->pCompCols != NULL) {
+    memset(pRes->pCompCols, 0, POINTER_BYTES * TSDB_MAX_COLUMNS);
+  }
+}
+
+int32_t tscDecompressResultColumn(SSqlCmd* pCmd, SSqlRes* pRes, int32_t col) {
+  if (pRes->pCompCols == NULL || pRes->pCompCols[col] == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SRetrieveColHead* pHead = (SRetrieveColHead*)pRes->pCompCols[col];
+  char*             pSrc = pRes->pCompCols[col] + sizeof(SRetrieveColHead);
+  int32_t           len = htonl(pHead->len);
+
+  int32_t rawLen = tscFieldInfoGetField(pCmd, col)->bytes * pRes->numOfRows;
+  int32_t resLen = tscGetResRowLength(pCmd) * pRes->numOfRows;
+  char*   pDst = pRes->data + tscFieldInfoGetOffset(pCmd, col) * pRes->numOfRows;
+
+  if (pHead->compType == 0) {
+    if (len != rawLen) {
+      tscError("invalid length of column:%d in retrieve rsp, len:%d, expected:%d", col, len, rawLen);
+      pRes->code = TSDB_CODE_APP_ERROR;
+      return pRes->code;
+    }
+
+    memcpy(pDst, pSrc, rawLen);
+  } else if (pHead->compType >= TSDB_DATA_TYPE_BOOL && pHead->compType <= TSDB_DATA_TYPE_NCHAR) {
+    int32_t ret = (*tscDecompFunc[pHead->compType])(pSrc, len, pRes->numOfRows, pDst, rawLen, TWO_STAGE_COMP,
+                                                    pRes->pDecompBuf + resLen, pRes->decompBufSize - resLen);
+    if (ret != rawLen) {
+      tscError("failed to decompress column:%d in retrieve rsp, len:%d, expected:%d", col, ret, rawLen);
+      pRes->code = TSDB_CODE_APP_ERROR;
+      return pRes->code;
+    }
+  } else {
+    tscError("invalid compression type:%d of column:%d in retrieve rsp", pHead->compType, col);
+    pRes->code = TSDB_CODE_APP_ERROR;
+    return pRes->code;
+  }
+
+  pRes->pCompCols[col] = NULL;
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t tscDecompressResult(SSqlCmd* pCmd, SSqlRes* pRes) {
+  if (pRes->pCompCols == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  for (int32_t i = 0; i < pCmd->fieldsInfo.numOfOutputCols; ++i) {
+    int32_t code = tscDecompressResultColumn(pCmd, pRes, i);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
 }
 
 void tscfreeSqlCmdData(SSqlCmd* pCmd) {
@@ -286,6 +426,7 @@ void tscFreeSqlObjPartial(SSqlObj* pSql) {
   pSql->res.row = 0;
   pSql->res.numOfRows = 0;
   pSql->res.numOfTotal = 0;
+  pSql->res.numOfRspBytes = 0;
 
   pSql->res.numOfGroups = 0;
   tfree(pSql->res.pGroupRec);
@@ -314,6 +455,9 @@ void tscFreeSqlObj(SSqlObj* pSql) {
   memset(pCmd->payload, 0, (size_t)tsRpcHeadSize);
   tfree(pCmd->payload);
 
+  pSql->res.numOfFailedVgroups = 0;
+  tfree(pSql->res.pFailedVgroups);
+
   pCmd->allocSize = 0;
 
   if (pSql->res.buffer != NULL) {
@@ -392,6 +536,103 @@ int32_t tscCopyDataBlockToPayload(SSqlObj* pSql, STableDataBlocks* pDataBlock) {
   return tscGetMeterMeta(pSql, pCmd->name);
 }
 
+bool tscIsMeterMetaInCache(char* meterId) {
+  void* pMeterMeta = taosGetDataFromCache(tscCacheHandle, meterId);
+  if (pMeterMeta == NULL) {
+    return false;
+  }
+
+  taosRemoveDataFromCache(tscCacheHandle, &pMeterMeta, false);
+  return true;
+}
+
+/*
+ * add a meter into the multi-meter-meta msg, the meter is created on demand with the tag
+ * values if pTag is not NULL
+ */
+int32_t tscAddMeterInfo(SMultiMeterInfoBuf* pBuf, char* meterId, STagData* pTag) {
+  if (pBuf->pHash == NULL) {
+    pBuf->pHash = taosInitStrHash(256, sizeof(int32_t), taosHashString);
+    if (pBuf->pHash == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+  }
+
+  if (taosGetStrHashData(pBuf->pHash, meterId) != NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t size = sizeof(SMeterInfoMsg) + ((pTag != NULL) ? sizeof(STagData) : 0);
+  if (pBuf->len == 0) {
+    pBuf->len = sizeof(SMultiMeterInfoMsg);
+  }
+
+  if (pBuf->len + size > pBuf->allocSize) {
+    int32_t allocSize = (pBuf->allocSize == 0) ? TSDB_DEFAULT_PAYLOAD_SIZE : pBuf->allocSize * 2;
+    while (allocSize < pBuf->len + size) {
+      allocSize = allocSize * 2;
+    }
+
+    char* tmp = realloc(pBuf->pMsg, allocSize);
+    if (tmp == NULL) {
+      return TSDB_CODE_CLI_OUT_OF_MEMORY;
+    }
+
+    pBuf->pMsg = tmp;
+    pBuf->allocSize = allocSize;
+  }
+
+  SMeterInfoMsg* pInfo = (SMeterInfoMsg*)(pBuf->pMsg + pBuf->len);
+  memset(pInfo, 0, size);
+  strncpy(pInfo->meterId, meterId, TSDB_METER_ID_LEN - 1);
+
+  if (pTag != NULL) {
+    pInfo->createFlag = htons(1);
+    memcpy(pInfo->tags, pTag, sizeof(STagData));
+  }
+
+  if (pBuf->numOfMeters == 0) {
+    strncpy(pBuf->meterId, meterId, TSDB_METER_ID_LEN - 1);
+  }
+
+  int32_t index = pBuf->numOfMeters;
+  taosAddStrHash(pBuf->pHash, meterId, (char*)&index);
+
+  pBuf->len += size;
+  pBuf->numOfMeters += 1;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * send the multi-meter-meta msg and reset the buffer for the following meters. The meters
+ * already sent are not added into buffer again.
+ */
+int32_t tscGetMeterMetaInBatch(SSqlObj* pSql, SMultiMeterInfoBuf* pBuf) {
+  if (pBuf->numOfMeters == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SMultiMeterInfoMsg* pInfo = (SMultiMeterInfoMsg*)pBuf->pMsg;
+  pInfo->numOfMeters = htonl(pBuf->numOfMeters);
+
+  tscTrace("%p retrieve meter meta of %d meters in batch", pSql, pBuf->numOfMeters);
+  int32_t code = tscGetMultiMeterMeta(pSql, pBuf->pMsg, pBuf->len, pBuf->meterId);
+
+  pBuf->len = sizeof(SMultiMeterInfoMsg);
+  pBuf->numOfMeters = 0;
+
+  return code;
+}
+
+void tscDestroyMultiMeterInfoBuf(SMultiMeterInfoBuf* pBuf) {
+  if (pBuf->pHash != NULL) {
+    taosCleanUpStrHash(pBuf->pHash);
+  }
+
+  tfree(pBuf->pMsg);
+  memset(pBuf, 0, sizeof(SMultiMeterInfoBuf));
+}
+
 void tscFreeUnusedDataBlocks(SDataBlockList* pList) {
   /* release additional memory consumption */
   for (int32_t i = 0; i < pList->nSize; ++i) {
@@ -438,6 +679,7 @@ void tscMergeTableDataBlocks(SSqlObj* pSql, SDataBlockList* pTableDataBlockList)
     STableDataBlocks* dataBuf =
         tscGetDataBlockFromList(pVnodeDataBlockHashList, pVnodeDataBlockList, pOneTableBlock->vgid, TSDB_PAYLOAD_SIZE,
                                 tsInsertHeadSize, 0, pOneTableBlock->meterId);
+    dataBuf->vgid = pOneTableBlock->vgid;
 
     int64_t destSize = dataBuf->size + pOneTableBlock->size;
     if (dataBuf->nAllocSize < destSize) {
@@ -507,6 +749,39 @@ bool tscIsInsertOrImportData(char* sqlstr) {
   return t0.type == TK_INSERT || t0.type == TK_IMPORT;
 }
 
+/*
+ * check if the sql creates more than one table from super tables, which has the form of
+ * create table tb1 using stb1 tags(...) tb2 using stb2 tags(...) ...
+ */
+bool tscIsMultiCreateTable(char* sqlstr) {
+  SSQLToken t0 = {0};
+  int32_t   index = 0;
+  int32_t   numOfUsing = 0;
+
+  while (*sqlstr != 0) {
+    t0.n = tSQLGetToken(sqlstr, &t0.type);
+    if (t0.n == 0) {
+      break;
+    }
+
+    sqlstr += t0.n;
+    if (t0.type == TK_SPACE) {
+      continue;
+    }
+
+    if ((index == 0 && t0.type != TK_CREATE) || (index == 1 && t0.type != TK_TABLE)) {
+      return false;
+    }
+
+    index++;
+    if (t0.type == TK_USING) {
+      numOfUsing++;
+    }
+  }
+
+  return numOfUsing > 1;
+}
+
 int tscAllocPayloadWithSize(SSqlCmd* pCmd, int size) {
   assert(size > 0);
 
@@ -1150,14 +1425,17 @@ void tscDoQuery(SSqlObj* pSql) {
 
     if (pCmd->isInsertFromFile == 1) {
       tscProcessMultiVnodesInsertForFile(pSql);
+    } else if (pCmd->command == TSDB_SQL_INSERT && pCmd->pDataBlocks != NULL && pCmd->pDataBlocks->nSize > 1) {
+      // data blocks of different vnodes are submitted concurrently, pSql may be released in async insertion
+      tscLaunchMultiVnodesInsert(pSql, NULL);
     } else {
       // pSql may be released in this function if it is a async insertion.
       tscProcessSql(pSql);
 
-      // handle the multi-vnode insertion for sync model
-      if (fp == NULL) {
+      // the only data block has been submitted in sync model, release it
+      if (fp == NULL && pCmd->command == TSDB_SQL_INSERT) {
         assert(pSql->signature == pSql);
-        tscProcessMultiVnodesInsert(pSql);
+        pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
       }
     }
   }
@@ -14,6 +14,8 @@
  *****************************************************************************/
 package com.taosdata.jdbc;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.sql.SQLException;
 import java.sql.SQLWarning;
 import java.util.List;
@@ -237,6 +239,28 @@ public class TSDBJNIConnector {
 
 	private native int fetchRowImp(long connection, long resultSet, TSDBResultSetRowData rowData);
 
+	/**
+	 * Get one block of data in columnar format. The data and null bitmap of column i are put into
+	 * buffers[2 * i] and buffers[2 * i + 1] as direct buffers in native byte order, which are valid until
+	 * the next fetch. The length of buffers must be at least twice the number of columns.
+	 *
+	 * @return the number of rows in the block, or a negative error code
+	 */
+	public int fetchBlock(long resultSet, ByteBuffer[] buffers) {
+		int numOfRows = this.fetchBlockImp(this.taos, resultSet, buffers);
+		if (numOfRows > 0) {
+			for (ByteBuffer buffer : buffers) {
+				if (buffer != null) {
+					buffer.order(ByteOrder.nativeOrder());
+				}
+			}
+		}
+
+		return numOfRows;
+	}
+
+	private native int fetchBlockImp(long connection, long resultSet, ByteBuffer[] buffers);
+
 	/**
 	 * Execute close operation from C to release connection pointer by JNI
 	 * 
@@ -27,6 +27,7 @@ extern "C" {
 #define TAOS_RES void
 #define TAOS_SUB void
 #define TAOS_STREAM void
+#define TAOS_STMT void
 
 #define TSDB_DATA_TYPE_NULL       0
 #define TSDB_DATA_TYPE_BOOL       1     // 1 bytes
@@ -55,6 +56,31 @@ typedef struct taosField {
   char  type;
 } TAOS_FIELD;
 
+/*
+ * one column of a result block, data holds the values of all rows in a block with fixed width of bytes.
+ * The values of nchar column are in UCS-4 encoding. Bit i of nullBitmap is set if the value of row i is null.
+ * Both pointers are valid until the next fetch or the result is freed.
+ */
+typedef struct taosColumn {
+  char           type;
+  short          bytes;
+  void *         data;
+  unsigned char *nullBitmap;
+} TAOS_COLUMN;
+
+/*
+ * values of one parameter for a batch of rows. buffer holds the values of all rows with a fixed width of buffer_length,
+ * which may be 0 for fixed length types. For binary and nchar parameters, length gives the actual length of each value,
+ * and the nchar values are in the client charset. Row i is null if is_null is not NULL and is_null[i] is not 0.
+ */
+typedef struct taosBind {
+  int   buffer_type;
+  void *buffer;
+  int   buffer_length;
+  int * length;
+  char *is_null;
+} TAOS_BIND;
+
 void taos_init();
 int taos_options(TSDB_OPTION option, const void *arg, ...);
 TAOS *taos_connect(char *ip, char *user, char *pass, char *db, int port);
@@ -73,8 +99,30 @@ int taos_print_row(char *str, TAOS_ROW row, TAOS_FIELD *fields, int num_fields);
 void taos_stop_query(TAOS_RES *res);
 
 int taos_fetch_block(TAOS_RES *res, TAOS_ROW *rows);
+int taos_fetch_columns(TAOS_RES *res, TAOS_COLUMN **columns);
 int taos_validate_sql(TAOS *taos, char *sql);
 
+// retrieve the meta of tables, separated by comma, in one request
+int taos_load_table_info(TAOS *taos, const char *tableNameList);
+
+TAOS_STMT *taos_stmt_init(TAOS *taos);
+int taos_stmt_prepare(TAOS_STMT *stmt, char *sql);
+int taos_stmt_num_params(TAOS_STMT *stmt);
+int taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind, int numOfRows);
+int taos_stmt_add_batch(TAOS_STMT *stmt);
+int taos_stmt_execute(TAOS_STMT *stmt);
+/*
+ * execute several prepared insert statements in one round, the rows of all statements are merged by vgroup and sent
+ * to vnodes concurrently. The result of each statement is available through taos_stmt_errno/taos_stmt_affected_rows,
+ * and the first error is returned.
+ */
+int taos_stmt_execute_batch(TAOS_STMT **stmts, int numOfStmts);
+TAOS_RES *taos_stmt_use_result(TAOS_STMT *stmt);
+int taos_stmt_affected_rows(TAOS_STMT *stmt);
+int taos_stmt_errno(TAOS_STMT *stmt);
+char *taos_stmt_errstr(TAOS_STMT *stmt);
+int taos_stmt_close(TAOS_STMT *stmt);
+
 // TAOS_RES   *taos_list_tables(TAOS *mysql, const char *wild);
 // TAOS_RES   *taos_list_dbs(TAOS *mysql, const char *wild);
 
@@ -83,10 +131,24 @@ char *taos_get_client_info();
 char *taos_errstr(TAOS *taos);
 int taos_errno(TAOS *taos);
 
+/*
+ * the vgroups failed in the last insertion of res, which involves more than one vgroup. The vgid and error code
+ * of at most size vgroups are copied, and the number of failed vgroups is returned.
+ */
+int taos_failed_vgroups(TAOS_RES *res, int *vgid, int *code, int size);
+
 void taos_query_a(TAOS *taos, char *sqlstr, void (*fp)(void *param, TAOS_RES *, int code), void *param);
 void taos_fetch_rows_a(TAOS_RES *res, void (*fp)(void *param, TAOS_RES *, int numOfRows), void *param);
 void taos_fetch_row_a(TAOS_RES *res, void (*fp)(void *param, TAOS_RES *, TAOS_ROW row), void *param);
 
+/*
+ * the rows of buffered insert are flushed to vnodes in batch, when the buffered rows exceed insertBufSize, or
+ * insertBufTime elapses, or taos_flush_insert is called. fp is invoked with the number of inserted rows or the
+ * negative error code after flushed. taos_flush_insert should not be called in fp.
+ */
+int taos_insert_buffered(TAOS *taos, char *sqlstr, void (*fp)(void *param, TAOS_RES *, int code), void *param);
+int taos_flush_insert(TAOS *taos);
+
 TAOS_SUB *taos_subscribe(char *host, char *user, char *pass, char *db, char *table, int64_t time, int mseconds);
 TAOS_ROW taos_consume(TAOS_SUB *tsub);
 void taos_unsubscribe(TAOS_SUB *tsub);
@@ -225,6 +225,12 @@ extern "C" {
 #define TSDB_MSG_TYPE_ALTER_TABLE_RSP  82
 #define TSDB_MSG_TYPE_ALTER_DB         83
 #define TSDB_MSG_TYPE_ALTER_DB_RSP     84
+#define TSDB_MSG_TYPE_MULTI_METERINFO  85
+#define TSDB_MSG_TYPE_MULTI_METERINFO_RSP 86
+#define TSDB_MSG_TYPE_MULTI_CREATE_TABLE  87
+#define TSDB_MSG_TYPE_MULTI_CREATE_TABLE_RSP 88
+#define TSDB_MSG_TYPE_MULTI_CREATE        89  // from mgmt to vnode, create a batch of meters in one vnode
+#define TSDB_MSG_TYPE_MULTI_CREATE_RSP    90
 
 #define TSDB_MSG_TYPE_HEARTBEAT        91
 #define TSDB_MSG_TYPE_HEARTBEAT_RSP    92
@@ -235,7 +241,9 @@ extern "C" {
 
 #define TSDB_MSG_TYPE_ALTER_ACCT       97
 #define TSDB_MSG_TYPE_ALTER_ACCT_RSP   98
-#define TSDB_MSG_TYPE_MAX              99
+#define TSDB_MSG_TYPE_SUBSCRIBE        99
+#define TSDB_MSG_TYPE_SUBSCRIBE_RSP    100
+#define TSDB_MSG_TYPE_MAX              101
 
 // IE type
 #define TSDB_IE_TYPE_SEC               1
@@ -245,6 +253,7 @@ extern "C" {
 #define TSDB_IE_TYPE_NEW_VERSION       5
 #define TSDB_IE_TYPE_DNODE_EXT         6
 #define TSDB_IE_TYPE_DNODE_STATE       7
+#define TSDB_IE_TYPE_METRIC_META       8  // metric meta compressed per vnode, see SMetricMetaRsp
 
 // mgmt table
 enum _mgmt_table {
@@ -399,11 +408,21 @@ typedef struct {
   uint64_t lastCreate;
   short    numOfColumns;
   short    sqlLen;  // SQL string is after schema
-  char     reserved[16];
+  uint64_t metricUid;  // uid of the metric for meters created from metric, otherwise 0
+  uint32_t tagSig;     // signature of the tag schema of metric
+  int16_t  tagLen;     // tag values are after SQL string, replicated to vnode for tag filter
+  char     reserved[2];
   int32_t  sversion;
   SMColumn schema[];
 } SCreateMsg;
 
+/* SCreateMsg of each meter follows, all meters belong to the same vnode */
+typedef struct {
+  short   vnode;
+  int32_t numOfMeters;
+  char    meters[];
+} SMultiCreateMsg;
+
 typedef struct {
   char  db[TSDB_DB_NAME_LEN];
   short ignoreNotExists;
@@ -427,6 +446,18 @@ typedef struct {
   SSchema schema[];
 } SCreateTableMsg;
 
+/* SCreateTableMsg of each table follows, STagData is after it if the table is created from super table */
+typedef struct {
+  int32_t numOfTables;
+  char    tables[];
+} SMultiCreateTableMsg;
+
+/* the tables before the failed one are created or already exist, code is the error of the failed one */
+typedef struct {
+  int32_t code;
+  int32_t numOfCreated;
+} SMultiCreateTableRsp;
+
 typedef struct {
   char meterId[TSDB_METER_ID_LEN];
   char igNotExists;
@@ -627,10 +658,26 @@ typedef struct {
   int32_t colNameLen;
   int64_t colNameList;
 
+  int32_t  tagFilterLen;  // length of tag filter, the meters are selected by vnode if it is not 0
+  uint64_t pTagFilter;    // STagFilterMsg, it is after the default value array
+
   int64_t          pSqlFuncExprs;
   SColumnFilterMsg colList[];
 } SQueryMeterMsg;
 
+/*
+ * the tag condition of metric query evaluated by vnode on the tag values replicated in meter objects,
+ * data: SSchema[numOfTags] of metric, int16_t tagCols[numOfTagsCols] of SQueryMeterMsg, condition string
+ */
+typedef struct {
+  uint64_t metricUid;
+  uint32_t tagSig;     // signature of the tag schema, to detect the stale tag values in vnode
+  int16_t  numOfTags;  // number of tags of metric
+  int16_t  reserved;
+  int32_t  condLen;    // length of condition string, including the terminated char
+  char     data[];
+} STagFilterMsg;
+
 typedef struct {
   char     code;
   uint64_t qhandle;
@@ -648,6 +695,7 @@ typedef struct {
 typedef struct {
   uint64_t qhandle;
   char     free;
+  char     compressed;  // client accepts the compressed columnar result
 } SRetrieveMeterMsg;
 
 typedef struct {
@@ -655,9 +703,35 @@ typedef struct {
   int16_t precision;
   int64_t offset;  // updated offset value for multi-vnode projection query
   int64_t useconds;
+  int8_t  compressed;  // each column is encoded as SRetrieveColHead + payload
   char    data[];
 } SRetrieveMeterRsp;
 
+/*
+ * rows inserted after the offset are pushed to the subscriber, if there is none, the request is held by vnode until
+ * rows arrive or waitTime elapses. The number of rows in response never exceeds the credit of the subscriber.
+ */
+typedef struct {
+  int16_t  vnode;
+  int32_t  sid;
+  uint64_t uid;
+  int64_t  offset;    // key of the last row consumed
+  int32_t  credit;    // maximum number of rows the subscriber can receive
+  int32_t  waitTime;  // in milliseconds
+} SSubscribeMsg;
+
+typedef struct {
+  int32_t numOfRows;
+  int16_t sversion;
+  int8_t  expired;  // rows after the offset are not kept for subscribers anymore, they shall be retrieved by query
+  char    data[];   // rows in the format of submit block
+} SSubscribeRsp;
+
+typedef struct {
+  int8_t  compType;  // 0: raw data, otherwise the data type whose codec is applied
+  int32_t len;       // length of payload following the head
+} SRetrieveColHead;
+
 typedef struct {
   uint32_t vnode;
   uint32_t vgId;
@@ -703,7 +777,8 @@ typedef struct {
   char loadLatest;  // load into mem or not
   char precision;   // time resoluation
 
-  char reserved[16];
+  int32_t rollupLevels[TSDB_MAX_ROLLUP_LEVELS];  // length of rollup buckets in seconds, 0 means no rollup
+  char    reserved[8];
 } SVnodeCfg, SCreateDbMsg, SDbCfg, SAlterDbMsg;
 
 // IMPORTANT: sizeof(SVnodeStatisticInfo) should not exceed
@@ -771,6 +846,15 @@ typedef struct {
   char  tags[];
 } SMeterInfoMsg;
 
+/*
+ * meter info of multiple meters, each SMeterInfoMsg is followed by STagData
+ * if createFlag is set, in which case the meter is created on demand
+ */
+typedef struct {
+  int32_t numOfMeters;
+  char    meters[];
+} SMultiMeterInfoMsg;
+
 typedef struct {
   char meterId[TSDB_METER_ID_LEN];
 
@@ -804,6 +888,27 @@ typedef struct {
   int32_t  list[]; /* offset of SVnodeSidList, compared to the SMetricMeta struct */
 } SMetricMeta;
 
+/*
+ * metric meta in the response message, followed by one SVnodeSidListRsp for each vnode.
+ * The sids of one vnode are sorted and compressed with delta encoding, the tags are laid out
+ * column by column and compressed with lz4.
+ */
+typedef struct {
+  int32_t  numOfMeters;
+  int32_t  numOfVnodes;
+  uint16_t tagLen;
+  int16_t  numOfTags;
+  int16_t  tagBytes[];  // length of each required tag
+} SMetricMetaRsp;
+
+typedef struct {
+  int32_t vnode;
+  int32_t numOfSids;
+  int32_t sidLen;  // length of compressed sids
+  int32_t tagLen;  // length of compressed tags, 0 if no tag is required
+  char    data[];
+} SVnodeSidListRsp;
+
 typedef struct SMeterMeta {
   int16_t numOfTags;
   int16_t precision;
@@ -828,6 +933,19 @@ typedef struct {
   char data[TSDB_MAX_TAGS_LEN];
 } STagData;
 
+/* SMeterMeta, schema and tags of the meter follow, metaLen is 0 if failed */
+typedef struct {
+  char    meterId[TSDB_METER_ID_LEN];
+  int32_t code;
+  int32_t metaLen;
+  char    meta[];
+} SMultiMeterMeta;
+
+typedef struct {
+  int32_t numOfMeters;
+  char    metas[];  // SMultiMeterMeta list
+} SMultiMeterMetaRsp;
+
 /*
  * sql: show tables like '%a_%'
  * payload is the query condition, e.g., '%a_%'
@@ -91,6 +91,17 @@ void tSQLBinaryExprTrv(tSQLBinaryExpr *pExprs, int32_t *val, int16_t *ids);
 
 bool tSQLElemFilterCallback(struct tSkipListNode *pNode, void *param);
 
+bool tSQLElemFilterOnTagValue(tQueryInfo *pCols, char *val);
+
+void tSQLListTraversePrepare(tQueryInfo *colInfo, struct SSchema *pSchema, int32_t numOfCols,
+                             struct SSchema *pOneColSchema, uint8_t optr, tVariant *val);
+
+/*
+ * query the skiplist which is keyed on the queried column with a relational operator,
+ * the LIKE operator is not supported. Return the number of nodes that satisfy the condition
+ */
+int32_t tSQLIndexQuery(struct tSkipList *pSkipList, tQueryInfo *colInfo, struct tSkipListNode ***pRes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,8 @@ extern "C" {
 #define MIN_BUFFER_SIZE (1 << 19)
 #define MAX_TMPFILE_PATH_LENGTH 512
 #define INITIAL_ALLOCATION_BUFFER_SIZE 64
+#define EXT_BUFFER_PREFETCH_PAGES 8  // number of pages read ahead during loading data from disk
+#define RADIX_SORT_MIN_ROWS 256      // radix sort is used for single integer order column if more rows than it
 
 // forward declare
 struct tTagSchema;
@@ -61,6 +63,11 @@ typedef struct tFlushoutData {
   tFlushoutInfo *pFlushoutInfo;
 } tFlushoutData;
 
+typedef struct tFilePageLoc {
+  int64_t offset;
+  int32_t length;
+} tFilePageLoc;
+
 typedef struct tFileMeta {
   uint32_t      nFileSize;  // in pages
   uint32_t      nPageSize;
@@ -118,6 +125,25 @@ typedef struct tExtMemBuffer {
   char  dataFilePath[MAX_TMPFILE_PATH_LENGTH];
   FILE *dataFile;
 
+  /*
+   * the flushed pages are kept in memory until the number of them exceeds nMaxResidentPages, then all of them are
+   * spilled to disk and the following flush operations write to disk directly. 0 means always flushing to disk.
+   */
+  int32_t          nMaxResidentPages;
+  int32_t          numOfResidentPages;
+  int32_t          nResidentAllocSize;
+  tFilePagesItem **pResidentPages;
+
+  /*
+   * the pages are compressed before written to disk, and the location of each page in data file is kept in
+   * pPageLoc since the size of compressed pages varies.
+   */
+  bool          compressed;
+  int32_t       numOfPagesInFile;
+  int32_t       nPageLocAllocSize;
+  tFilePageLoc *pPageLoc;
+  char *        pCompBuf;
+
   tColModel *pColModel;
 
   EXT_BUFFER_FLUSH_MODEL flushModel;
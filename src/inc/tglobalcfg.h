@@ -89,8 +89,17 @@ extern short tsCommitTime;  // seconds
 extern short tsCommitLog;
 extern short tsAsyncLog;
 extern short tsCompression;
+extern int   tsRetrieveCompress;
+extern int   tsInsertBufferSize;
+extern int   tsInsertBufferTime;
+extern int   tsTagFilterPushdown;
+extern int   tsLocalReduceBufSize;
+extern int   tsLocalReduceThreads;
+extern int   tsLocalReduceSpillComp;
 extern short tsDaysPerFile;
 extern int   tsDaysToKeep;
+extern int   tsRollupLevel1;
+extern int   tsRollupLevel2;
 extern int   tsReplications;
 
 extern int  tsNumOfMPeers;
@@ -138,6 +147,7 @@ extern int   tsHttpCacheSessions;
 extern int   tsHttpSessionExpire;
 extern int   tsHttpMaxThreads;
 extern int   tsHttpEnableCompress;
+extern int   tsHttpMaxParallelSql;
 extern int   tsTelegrafUseFieldNum;
 extern int   tsAdminRowLimit;
 
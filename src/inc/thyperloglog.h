@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_THYPERLOGLOG_H
+#define TDENGINE_THYPERLOGLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * the sketch has 2^precision registers of one byte, and the standard error of the estimated number of distinct
+ * values is about 1.04 / sqrt(2^precision): 1.6% for the default precision 12 with 4KB registers.
+ */
+#define HLL_MIN_PRECISION     4
+#define HLL_MAX_PRECISION     12
+#define HLL_DEFAULT_PRECISION 12
+
+/*
+ * the structure contains no pointer, so it is kept in the output buffer of the function directly, and merged with the
+ * results of other meters and vnodes by the maximum value of each register.
+ */
+typedef struct SHyperLogLog {
+  int32_t precision;
+  int32_t reserved;
+  int64_t numOfElems;  // number of added values, not the distinct ones
+  uint8_t registers[];
+} SHyperLogLog;
+
+/* the size of sketch in bytes */
+int32_t tHllSize(int32_t precision);
+
+void tHllInit(SHyperLogLog *pHll, int32_t precision);
+
+uint64_t tHllHashInt(uint64_t val);
+
+uint64_t tHllHashBytes(const void *key, int32_t len);
+
+void tHllAdd(SHyperLogLog *pHll, uint64_t hash);
+
+/* add the hash values of a block at once */
+void tHllAddBatch(SHyperLogLog *pHll, const uint64_t *hash, int32_t num);
+
+/* both sketches must be of the same precision */
+int32_t tHllMerge(SHyperLogLog *pHll, const SHyperLogLog *pInput);
+
+uint64_t tHllCount(const SHyperLogLog *pHll);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_THYPERLOGLOG_H
@@ -51,6 +51,8 @@ char *tsGetTagsValue(SMeterMeta *pMeta);
 
 bool tsMeterMetaIdentical(SMeterMeta *p1, SMeterMeta *p2);
 
+uint32_t tsGetTagSchemaSignature(struct SSchema *pTagSchema, int32_t numOfTags);
+
 void extractMeterName(char *meterId, char *name);
 
 void extractDBName(char *meterId, char *name);
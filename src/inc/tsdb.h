@@ -122,6 +122,11 @@ enum _syncstatus {
 #define TSDB_MAX_TAGS_LEN         512
 #define TSDB_MAX_TAGS             6
 
+#define TSDB_MAX_ROLLUP_LEVELS    2
+
+#define TSDB_MAX_METERS_IN_MULTI_META 1000  // max number of meters in one multi-meter-meta msg
+#define TSDB_MAX_TABLES_IN_MULTI_CREATE 1000  // max number of tables in one multi-create-table msg
+
 #define TSDB_AUTH_LEN             16
 #define TSDB_KEY_LEN              16
 #define TSDB_VERSION_LEN          12
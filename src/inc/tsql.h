@@ -30,6 +30,14 @@ extern "C" {
 #define TK_HEX     203
 #define TK_OCT     204
 
+/*
+ * the keywords of functions that are not in the grammar. The parser of util/src/sql.c is generated from sql.y by
+ * lemon, and its tables are not rebuilt with the source, so a keyword added to sql.y has no code in tsqldef.h.
+ * Such a keyword takes a code after the tokenizer-only tokens above, out of the range of the generated codes, and
+ * it is fed to the parser as an identifier. The function is recognized by the type of function name token.
+ */
+#define TK_HYPERLOGLOG (TK_OCT + 1)
+
 #define TSQL_SO_ASC  1
 #define TSQL_SO_DESC 0
 
@@ -40,6 +48,7 @@ extern "C" {
 
 #define TSQL_STABLE_QTYPE_COND 1
 #define TSQL_STABLE_QTYPE_SET  2
+#define TSQL_STABLE_QTYPE_VNODES 3  // only the vnodes of metric are required, tag condition is evaluated by vnode
 
 // token type
 enum {
@@ -69,6 +69,13 @@ extern "C" {
 #define TSDB_FUNC_BOTTOM_DST   33
 #define TSDB_FUNC_APERCT_DST   34
 #define TSDB_FUNC_INTERP       35
+#define TSDB_FUNC_STDDEV_DST   36
+#define TSDB_FUNC_HLL          37
+#define TSDB_FUNC_HLL_DST      38
+
+// the algorithm of apercentile, specified by the optional third parameter
+#define TSDB_APERCT_ALGO_HISTOGRAM 0
+#define TSDB_APERCT_ALGO_TDIGEST   1
 
 #define TSDB_FUNCSTATE_SO      0x1  // single output
 #define TSDB_FUNCSTATE_MO      0x2  // dynamic number of output, not multinumber of output e.g., TOP/BOTTOM
@@ -283,11 +290,19 @@ typedef struct SAvgRuntime {
   int8_t  valFlag;
 } SAvgRuntime;
 
+// the mean and the sum of squares of differences from the mean, merged by the parallel variance algorithm
+typedef struct SStddevRuntime {
+  double  mean;
+  double  m2;
+  int64_t num;
+  int8_t  valFlag;
+} SStddevRuntime;
+
 /* global sql function array */
-extern struct SQLAggFuncElem aAggs[36];
+extern struct SQLAggFuncElem aAggs[39];
 
 /* compatible check array list */
-extern int32_t funcCompatList[36];
+extern int32_t funcCompatList[39];
 
 void getStatistics(char *priData, char *data, int32_t size, int32_t numOfRow, int32_t type, int64_t *min, int64_t *max,
                    int64_t *sum, int64_t *wsum, int32_t *numOfNull);
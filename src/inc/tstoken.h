@@ -30,6 +30,9 @@ typedef struct SSQLToken {
 } SSQLToken;
 
 char *tscGetToken(char *string, char **token, int *tokenLen);
+
+// the same as tscGetToken, and the quote of the token is returned in quote, which is 0 if the token is not quoted
+char *tscGetQuotedToken(char *string, char **token, int *tokenLen, char *quote);
 char *tscGetTokenDelimiter(char *string, char **token, int *tokenLen, const char *delimiters);
 
 /**
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TTDIGEST_H
+#define TDENGINE_TTDIGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * the centroid of quantile q holds at most about 2 * pi * sqrt(q * (1 - q)) / TDIGEST_COMPRESSION of all points,
+ * so the rank error of the estimated quantile is less than half of it: 0.8% at the median, and much smaller at tails.
+ * The number of centroids is not more than TDIGEST_COMPRESSION + 2.
+ */
+#define TDIGEST_COMPRESSION   200
+#define TDIGEST_MAX_CENTROIDS (TDIGEST_COMPRESSION + 2)
+#define TDIGEST_BUFFER_SIZE   64  // points added one by one are buffered, and merged into centroids in batch
+#define TDIGEST_BATCH_SIZE    1024  // points added in batch are merged into centroids by this number at most
+
+typedef struct SCentroid {
+  double  mean;
+  int64_t weight;
+} SCentroid;
+
+/*
+ * t-digest in the merging variant, see:
+ * Ted Dunning, Otmar Ertl. Computing Extremely Accurate Quantiles Using t-Digests, arXiv:1902.04023, 2019
+ *
+ * the structure contains no pointer, so it is kept in the output buffer of the function directly, and copied to merge
+ * with the results of other meters and vnodes.
+ */
+typedef struct STDigest {
+  int64_t   totalWeight;  // number of points merged into centroids
+  double    min;
+  double    max;
+  int32_t   numOfCentroids;
+  int32_t   numOfBuffered;
+  SCentroid centroids[TDIGEST_MAX_CENTROIDS];
+  double    buffered[TDIGEST_BUFFER_SIZE];
+} STDigest;
+
+void tTDigestInit(STDigest *pDigest);
+
+int32_t tTDigestAdd(STDigest *pDigest, double val);
+
+/* the values are sorted in place, and merged into centroids by every TDIGEST_BATCH_SIZE values */
+int32_t tTDigestAddBatch(STDigest *pDigest, double *val, int32_t num);
+
+int32_t tTDigestMerge(STDigest *pDigest, STDigest *pInput);
+
+int64_t tTDigestSize(STDigest *pDigest);
+
+/* q is in the range of [0, 1] */
+double tTDigestQuantile(STDigest *pDigest, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TTDIGEST_H
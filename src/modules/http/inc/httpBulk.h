@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_HTTP_BULK_H
+#define TDENGINE_HTTP_BULK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "httpHandle.h"
+#include "taos.h"
+
+#define HTTP_BULK_QUEUE_SIZE 1000
+#define HTTP_BULK_DESC_SIZE  256
+
+/*
+ * rows of one table in a bulk insert request. The values of each parameter are kept in
+ * a typed array of binds[i], which is written into the submit block of the table directly.
+ */
+typedef struct {
+  char       name[TSDB_METER_NAME_LEN];
+  char *     sql;           // insert statement with parameter markers
+  int32_t    numOfParams;
+  int32_t    numOfRows;
+  TAOS_BIND *binds;
+  char *     buffer;        // values, lengths and null flags referenced by binds
+  TAOS_STMT *stmt;
+  int32_t    code;
+  int32_t    affectedRows;
+} HttpBulkTable;
+
+/*
+ * bulk insert request. The request body is decoded by the handler on the http thread, and
+ * then buildFp is invoked on the bulk thread to check the schema and build the tables, since
+ * the prepared statements run synchronously.
+ */
+typedef struct HttpBulk {
+  char           db[TSDB_DB_NAME_LEN];
+  void *         param;  // decoded request, released by freeFp
+  bool         (*buildFp)(struct HttpContext *pContext, struct HttpBulk *pBulk);
+  void         (*freeFp)(void *param);
+  int32_t        httpCode;  // error of http or taosd set by buildFp if failed
+  int32_t        taosCode;
+  char           desc[HTTP_BULK_DESC_SIZE];
+  HttpBulkTable *tables;
+  int32_t        numOfTables;
+  int32_t        maxTables;
+  int32_t        numOfRows;
+  int32_t        affectedRows;
+  int32_t        numOfFailed;
+} HttpBulk;
+
+bool httpInitBulk(int numOfThreads);
+void httpCleanUpBulk();
+
+HttpBulk *httpMallocBulk(struct HttpContext *pContext);
+void      httpFreeBulk(struct HttpContext *pContext);
+void      httpProcessBulkCmd(struct HttpContext *pContext);
+
+HttpBulkTable *httpAddBulkTable(HttpBulk *pBulk, char *name);
+bool           httpMallocBulkColumns(HttpBulkTable *pTable, int32_t numOfParams, int32_t numOfRows, int32_t *bytes,
+                                     int8_t *types);
+
+int32_t httpBulkExecSql(void *taos, char *sql, TAOS_STMT **ppStmt);
+
+#endif
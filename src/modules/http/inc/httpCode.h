@@ -107,6 +107,25 @@
 //tgf
 #define HTTP_TG_STABLE_NOT_EXIST     80
 
+//influxdb
+#define HTTP_INFLUX_DB_NOT_INPUT      81
+#define HTTP_INFLUX_DB_TOO_LONG       82
+#define HTTP_INFLUX_INVALID_PRECISION 83
+#define HTTP_INFLUX_LINES_NULL        84
+#define HTTP_INFLUX_INVALID_LINE      85
+#define HTTP_INFLUX_NAME_TOO_LONG     86
+#define HTTP_INFLUX_TAGS_SIZE_LONG    87
+#define HTTP_INFLUX_FIELDS_SIZE_LONG  88
+#define HTTP_INFLUX_INVALID_SCHEMA    89
+
+//rest bulk
+#define HTTP_BULK_DB_NOT_INPUT        90
+#define HTTP_BULK_DB_TOO_LONG         91
+#define HTTP_BULK_BODY_NULL           92
+#define HTTP_BULK_INVALID_VERSION     93
+#define HTTP_BULK_INVALID_BODY        94
+#define HTTP_BULK_INVALID_NAME        95
+
 extern char *httpMsg[];
 
 #endif
\ No newline at end of file
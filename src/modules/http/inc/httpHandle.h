@@ -29,6 +29,7 @@
 
 #define HTTP_MAX_CMD_SIZE           1024
 #define HTTP_MAX_BUFFER_SIZE        1024*1024
+#define HTTP_MAX_BULK_BODY_SIZE     1024*1024*16  //body of bulk request, raw or decompressed
 
 #define HTTP_LABEL_SIZE             8
 #define HTTP_MAX_EVENTS             10
@@ -55,6 +56,7 @@
 #define HTTP_REQTYPE_HEARTBEAT      2
 #define HTTP_REQTYPE_SINGLE_SQL     3
 #define HTTP_REQTYPE_MULTI_SQL      4
+#define HTTP_REQTYPE_BULK_INSERT    5
 
 #define HTTP_CLOSE_CONN             0
 #define HTTP_KEEP_CONN              1
@@ -75,8 +77,11 @@
 #define HTTP_COMPRESS_IDENTITY      0
 #define HTTP_COMPRESS_GZIP          2
 
+#define HTTP_GZIP_BUF_FULL         -5      //decompressed data is more than the output buffer
+
 struct HttpContext;
 struct HttpThread;
+struct HttpBulk;
 
 typedef struct {
   void *signature;
@@ -118,6 +123,13 @@ typedef struct {
   int8_t cmdReturnType;
   int8_t cmdState;
   int8_t tagNum;
+
+  // used by multi-cmd executed in parallel, the result is held until the results of previous cmds are written
+  struct HttpContext *pContext;
+  void *              result;
+  int32_t             retCode;  // affected rows, rows of the first block or negative error code
+  int32_t             elapsed;  // us from launched to the first block retrieved
+  int64_t             stime;
 } HttpSqlCmd;
 
 typedef struct {
@@ -125,6 +137,9 @@ typedef struct {
   int16_t     pos;
   int16_t     size;
   int16_t     maxSize;
+  int16_t     launched;  // number of cmds launched in parallel
+  int16_t     parallel;  // max number of cmds launched but not written, 0 if executed one by one
+  int32_t     writing;   // held by the thread writing the results of cmds in order
   int32_t     bufferPos;
   int32_t     bufferSize;
   char *      buffer;
@@ -133,6 +148,7 @@ typedef struct {
 typedef struct {
   char *module;
   bool (*decodeFp)(struct HttpContext *pContext);
+  bool (*bulkBodyFp)(struct HttpContext *pContext);  // body may exceed HTTP_BUFFER_SIZE, NULL if never
 } HttpDecodeMethod;
 
 typedef struct {
@@ -152,8 +168,9 @@ typedef struct {
 } HttpBuf;
 
 typedef struct {
-  char              buffer[HTTP_BUFFER_SIZE];
+  char             *buffer;              // fixedBuf, or malloced when the body of bulk request grows
   int               bufsize;
+  int               bufcap;
   char             *pLast;
   char             *pCur;
   HttpBuf           method;
@@ -161,6 +178,7 @@ typedef struct {
   HttpBuf           data;                // body content
   HttpBuf           token;               // auth token
   HttpDecodeMethod *pMethod;
+  char              fixedBuf[HTTP_BUFFER_SIZE];
 } HttpParser;
 
 typedef struct HttpContext {
@@ -188,6 +206,7 @@ typedef struct HttpContext {
   HttpSqlCmd          singleCmd;
   HttpSqlCmds        *multiCmds;
   JsonBuf            *jsonBuf;
+  struct HttpBulk    *bulk;
   HttpParser          parser;
   void               *readTimer;
   struct HttpThread  *pThread;
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_INFLUX_HANDLE_H
+#define TDENGINE_INFLUX_HANDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "http.h"
+#include "httpCode.h"
+#include "httpHandle.h"
+#include "httpResp.h"
+
+#define INFLUX_ROOT_URL_POS   0
+#define INFLUX_DB_URL_POS     1
+
+#define INFLUX_FIELD_PREFIX   "f_"
+#define INFLUX_TAG_PREFIX     "t_"
+#define INFLUX_BINARY_LEN     64   // minimal length of binary tags and columns created
+
+void influxInitHandle(HttpServer *pServer);
+
+bool influxProcessRequest(struct HttpContext *pContext);
+
+#endif
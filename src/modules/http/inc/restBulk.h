@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_REST_BULK_H
+#define TDENGINE_REST_BULK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "httpHandle.h"
+
+/*
+ * binary columnar body of POST /rest/bulk/<db>, all integers are little endian and unaligned
+ *
+ *   header:  char magic[4] = "TDBC", uint8 version = 1, uint8 reserved, uint16 numOfTables
+ *   table:   uint8 nameLen, name, uint8 stableLen, stable, uint8 numOfTags, tag[numOfTags],
+ *            uint16 numOfColumns, uint32 numOfRows, column[numOfColumns]
+ *   tag:     uint8 type, uint16 len, value[len]; type 0 is null
+ *   column:  uint8 nameLen, name, uint8 type, uint8 flags,
+ *            [int8 isNull[numOfRows] if flags & REST_BULK_HAS_NULL],
+ *            value[numOfRows] of fixed size types, or
+ *            uint16 len[numOfRows] followed by the concatenated values of binary and nchar
+ *
+ * If stableLen is 0 the table must exist, otherwise it is created from the stable with the tags if not
+ * exists. If the nameLen of columns are 0, the values of all the columns of table are given in order,
+ * otherwise the first column is the timestamp. The body may be compressed by gzip.
+ */
+#define REST_BULK_MAGIC     "TDBC"
+#define REST_BULK_VERSION   1
+#define REST_BULK_HAS_NULL  0x1
+
+#define REST_BULK_DB_URL_POS 2
+
+bool restProcessBulkRequest(struct HttpContext *pContext);
+
+#endif
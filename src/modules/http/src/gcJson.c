@@ -46,7 +46,7 @@ void gcCleanQueryJson(HttpContext *pContext) {
   httpWriteJsonBufEnd(jsonBuf);
 }
 
-void gcWriteTargetStartJson(JsonBuf *jsonBuf, char *refId, char *target) {
+void gcWriteTargetStartJson(JsonBuf *jsonBuf, char *refId, char *target, int elapsed) {
   if (strlen(target) == 0) {
     target = refId;
   }
@@ -59,6 +59,9 @@ void gcWriteTargetStartJson(JsonBuf *jsonBuf, char *refId, char *target) {
   httpJsonPair(jsonBuf, "refId", 5, refId, (int)strlen(refId));
   httpJsonPair(jsonBuf, "target", 6, target, (int)strlen(target));
 
+  // microseconds the query of target taken, until the first rows retrieved
+  httpJsonPairIntVal(jsonBuf, "elapsed", 7, elapsed);
+
   // data begin
   httpJsonPairHead(jsonBuf, "datapoints", 10);
 
@@ -115,7 +118,7 @@ bool gcBuildQueryJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
   char *targetBuffer = httpGetCmdsString(pContext, cmd->timestamp);
 
   if (groupFields == -1 && cmd->numOfRows == 0) {
-    gcWriteTargetStartJson(jsonBuf, refIdBuffer, aliasBuffer);
+    gcWriteTargetStartJson(jsonBuf, refIdBuffer, aliasBuffer, cmd->elapsed);
     cmd->numOfRows += numOfRows;
   }
 
@@ -169,7 +172,7 @@ bool gcBuildQueryJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
         }
 
         // start new target
-        gcWriteTargetStartJson(jsonBuf, refIdBuffer, target);
+        gcWriteTargetStartJson(jsonBuf, refIdBuffer, target, cmd->elapsed);
         strncpy(targetBuffer, target, HTTP_GC_TARGET_SIZE);
       }
     }  // end of group by
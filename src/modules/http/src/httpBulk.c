@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "http.h"
+#include "httpBulk.h"
+#include "httpCode.h"
+#include "httpHandle.h"
+#include "httpJson.h"
+#include "httpResp.h"
+#include "taosmsg.h"
+#include "tsched.h"
+#include "ttime.h"
+
+/*
+ * bulk insert
+ *
+ * The rows of a bulk request are bound to the prepared insert statement of each table as typed
+ * arrays, and the statements of all tables are executed in one round by taos_stmt_execute_batch,
+ * so the values are written into the submit blocks directly without being formatted into sql.
+ * The prepared statements are synchronous, they run on the bulk threads instead of http threads.
+ */
+static void *httpBulkQhandle = NULL;
+
+bool httpInitBulk(int numOfThreads) {
+  if (httpBulkQhandle == NULL) {
+    httpBulkQhandle = taosInitScheduler(HTTP_BULK_QUEUE_SIZE, numOfThreads, "httpBulk");
+  }
+
+  if (httpBulkQhandle == NULL) {
+    httpError("failed to init http bulk scheduler");
+    return false;
+  }
+
+  return true;
+}
+
+void httpCleanUpBulk() {
+  if (httpBulkQhandle != NULL) {
+    taosCleanUpScheduler(httpBulkQhandle);
+    httpBulkQhandle = NULL;
+  }
+}
+
+HttpBulk *httpMallocBulk(HttpContext *pContext) {
+  httpFreeBulk(pContext);
+
+  pContext->bulk = (HttpBulk *)calloc(1, sizeof(HttpBulk));
+  return pContext->bulk;
+}
+
+void httpFreeBulk(HttpContext *pContext) {
+  HttpBulk *pBulk = pContext->bulk;
+  if (pBulk == NULL) return;
+
+  for (int32_t i = 0; i < pBulk->numOfTables; ++i) {
+    HttpBulkTable *pTable = &pBulk->tables[i];
+    if (pTable->stmt != NULL) {
+      taos_stmt_close(pTable->stmt);
+    }
+    free(pTable->sql);
+    free(pTable->binds);
+    free(pTable->buffer);
+  }
+  free(pBulk->tables);
+
+  if (pBulk->freeFp != NULL && pBulk->param != NULL) {
+    (*pBulk->freeFp)(pBulk->param);
+  }
+
+  free(pBulk);
+  pContext->bulk = NULL;
+}
+
+HttpBulkTable *httpAddBulkTable(HttpBulk *pBulk, char *name) {
+  if (pBulk->numOfTables >= pBulk->maxTables) {
+    int32_t        maxTables = (pBulk->maxTables == 0) ? 16 : pBulk->maxTables * 2;
+    HttpBulkTable *tables = realloc(pBulk->tables, (size_t)maxTables * sizeof(HttpBulkTable));
+    if (tables == NULL) {
+      return NULL;
+    }
+
+    pBulk->tables = tables;
+    pBulk->maxTables = maxTables;
+  }
+
+  HttpBulkTable *pTable = &pBulk->tables[pBulk->numOfTables++];
+  memset(pTable, 0, sizeof(HttpBulkTable));
+  strncpy(pTable->name, name, TSDB_METER_NAME_LEN - 1);
+
+  return pTable;
+}
+
+/*
+ * allocate the binds of numOfParams parameters for numOfRows rows. The values, lengths and null flags of all
+ * parameters are kept in one buffer, the values of parameter i has a fixed width of bytes[i].
+ */
+bool httpMallocBulkColumns(HttpBulkTable *pTable, int32_t numOfParams, int32_t numOfRows, int32_t *bytes,
+                           int8_t *types) {
+  size_t size = 0;
+  for (int32_t i = 0; i < numOfParams; ++i) {
+    size += (size_t)numOfRows * (bytes[i] + sizeof(int) + sizeof(char));
+  }
+
+  pTable->binds = calloc((size_t)numOfParams, sizeof(TAOS_BIND));
+  pTable->buffer = calloc(1, size);
+  if (pTable->binds == NULL || pTable->buffer == NULL) {
+    return false;
+  }
+
+  char *buffer = pTable->buffer;
+  for (int32_t i = 0; i < numOfParams; ++i) {
+    TAOS_BIND *pBind = &pTable->binds[i];
+    pBind->buffer_type = types[i];
+    pBind->buffer_length = bytes[i];
+    pBind->buffer = buffer;
+    buffer += (size_t)numOfRows * bytes[i];
+
+    pBind->length = (int *)buffer;
+    buffer += (size_t)numOfRows * sizeof(int);
+
+    pBind->is_null = buffer;
+    buffer += (size_t)numOfRows * sizeof(char);
+  }
+
+  pTable->numOfParams = numOfParams;
+  pTable->numOfRows = numOfRows;
+  return true;
+}
+
+/*
+ * execute the sql on its own sql object, since the connection of session is shared by the requests of the
+ * same user. If ppStmt is not NULL, the statement is returned for fetching the result, and closed by caller.
+ */
+int32_t httpBulkExecSql(void *taos, char *sql, TAOS_STMT **ppStmt) {
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  if (stmt == NULL) {
+    return TSDB_CODE_CLI_OUT_OF_MEMORY;
+  }
+
+  int32_t code = taos_stmt_prepare(stmt, sql);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = taos_stmt_execute(stmt);
+  }
+
+  httpTrace("bulk sql:%s, code:%d", sql, code);
+
+  if (code == TSDB_CODE_SUCCESS && ppStmt != NULL) {
+    *ppStmt = stmt;
+  } else {
+    taos_stmt_close(stmt);
+  }
+
+  return code;
+}
+
+static void httpBulkInsert(HttpContext *pContext, HttpBulk *pBulk) {
+  TAOS_STMT **stmts = calloc((size_t)pBulk->numOfTables + 1, sizeof(TAOS_STMT *));
+  int32_t     numOfStmts = 0;
+
+  for (int32_t i = 0; i < pBulk->numOfTables; ++i) {
+    HttpBulkTable *pTable = &pBulk->tables[i];
+    pBulk->numOfRows += pTable->numOfRows;
+
+    if (pTable->code != TSDB_CODE_SUCCESS || pTable->numOfRows <= 0) {
+      continue;
+    }
+
+    if (stmts == NULL) {
+      pTable->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+      continue;
+    }
+
+    pTable->stmt = taos_stmt_init(pContext->session->taos);
+    if (pTable->stmt == NULL) {
+      pTable->code = TSDB_CODE_CLI_OUT_OF_MEMORY;
+      continue;
+    }
+
+    int32_t code = taos_stmt_prepare(pTable->stmt, pTable->sql);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = taos_stmt_bind_param(pTable->stmt, pTable->binds, pTable->numOfRows);
+    }
+    if (code == TSDB_CODE_SUCCESS) {
+      code = taos_stmt_add_batch(pTable->stmt);
+    }
+
+    if (code != TSDB_CODE_SUCCESS) {
+      httpError("context:%p, fd:%d, ip:%s, user:%s, table:%s, failed to bind rows, code:%d, reason:%s", pContext,
+                pContext->fd, pContext->ipstr, pContext->user, pTable->name, code, taos_stmt_errstr(pTable->stmt));
+      pTable->code = code;
+      continue;
+    }
+
+    stmts[numOfStmts++] = pTable->stmt;
+  }
+
+  if (numOfStmts > 0) {
+    taos_stmt_execute_batch(stmts, numOfStmts);
+  }
+
+  for (int32_t i = 0; i < pBulk->numOfTables; ++i) {
+    HttpBulkTable *pTable = &pBulk->tables[i];
+    if (pTable->code == TSDB_CODE_SUCCESS && pTable->stmt != NULL) {
+      pTable->code = taos_stmt_errno(pTable->stmt);
+      pTable->affectedRows = taos_stmt_affected_rows(pTable->stmt);
+    }
+
+    if (pTable->code == TSDB_CODE_SUCCESS) {
+      pBulk->affectedRows += pTable->affectedRows;
+    } else {
+      pBulk->numOfFailed++;
+    }
+  }
+
+  free(stmts);
+}
+
+static void httpBuildBulkTableJson(JsonBuf *jsonBuf, void *param) {
+  HttpBulkTable *pTable = (HttpBulkTable *)param;
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPair(jsonBuf, "table", 5, pTable->name, (int)strlen(pTable->name));
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairIntVal(jsonBuf, "rows", 4, pTable->numOfRows);
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairIntVal(jsonBuf, "affected_rows", 13, pTable->affectedRows);
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairStatus(jsonBuf, pTable->code);
+}
+
+static void httpBuildBulkTablesJson(JsonBuf *jsonBuf, void *param) {
+  HttpBulk *pBulk = (HttpBulk *)param;
+
+  for (int32_t i = 0; i < pBulk->numOfTables; ++i) {
+    httpJsonItemToken(jsonBuf);
+    httpJsonObject(jsonBuf, httpBuildBulkTableJson, &pBulk->tables[i]);
+  }
+}
+
+static void httpWriteBulkJson(HttpContext *pContext, HttpBulk *pBulk) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  httpInitJsonBuf(jsonBuf, pContext);
+  httpWriteJsonBufHead(jsonBuf);
+
+  httpJsonToken(jsonBuf, JsonObjStt);
+
+  if (pBulk->numOfFailed == 0) {
+    httpJsonPair(jsonBuf, "status", 6, "succ", 4);
+  } else {
+    httpJsonPair(jsonBuf, "status", 6, "partial", 7);
+  }
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairIntVal(jsonBuf, "rows", 4, pBulk->numOfRows);
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairIntVal(jsonBuf, "affected_rows", 13, pBulk->affectedRows);
+
+  httpJsonItemToken(jsonBuf);
+  httpJsonPairArray(jsonBuf, "tables", 6, httpBuildBulkTablesJson, pBulk);
+
+  httpJsonToken(jsonBuf, JsonObjEnd);
+
+  httpWriteJsonBufEnd(jsonBuf);
+}
+
+static void httpProcessBulkTask(SSchedMsg *pMsg) {
+  HttpContext *pContext = (HttpContext *)pMsg->ahandle;
+  HttpBulk *   pBulk = pContext->bulk;
+  int64_t      st = taosGetTimestampUs();
+
+  if (!(*pBulk->buildFp)(pContext, pBulk)) {
+    int32_t httpCode = pBulk->httpCode;
+    int32_t taosCode = pBulk->taosCode;
+    char    desc[HTTP_BULK_DESC_SIZE] = {0};
+    strcpy(desc, pBulk->desc);
+
+    // the response closes the context, so the request is released before it
+    httpFreeBulk(pContext);
+
+    if (taosCode != TSDB_CODE_SUCCESS) {
+      httpSendTaosdErrorResp(pContext, taosCode);
+    } else {
+      httpSendErrorRespWithDesc(pContext, httpCode, (desc[0] != 0) ? desc : NULL);
+    }
+    return;
+  }
+
+  httpBulkInsert(pContext, pBulk);
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, bulk insert, db:%s, tables:%d, rows:%d, affected rows:%d, "
+            "failed tables:%d, elapsed:%" PRId64 "us",
+            pContext, pContext->fd, pContext->ipstr, pContext->user, pBulk->db, pBulk->numOfTables, pBulk->numOfRows,
+            pBulk->affectedRows, pBulk->numOfFailed, taosGetTimestampUs() - st);
+
+  httpWriteBulkJson(pContext, pBulk);
+  httpFreeBulk(pContext);
+  httpCloseContextByApp(pContext);
+}
+
+void httpProcessBulkCmd(HttpContext *pContext) {
+  if (pContext->bulk == NULL || pContext->bulk->buildFp == NULL) {
+    httpSendErrorResp(pContext, HTTP_NO_MSG_INPUT);
+    return;
+  }
+
+  SSchedMsg schedMsg = {0};
+  schedMsg.fp = httpProcessBulkTask;
+  schedMsg.ahandle = pContext;
+
+  if (httpBulkQhandle == NULL || taosScheduleTask(httpBulkQhandle, &schedMsg) != 0) {
+    httpFreeBulk(pContext);
+    httpSendErrorResp(pContext, HTTP_NO_ENOUGH_SESSIONS);
+  }
+}
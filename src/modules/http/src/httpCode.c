@@ -100,6 +100,25 @@ char* httpMsg[] = {
     "tag value can not more than 64",        // 77
     "value not find",
     "value type should be boolean, number or string",
-    "stable not exist",
+    "stable not exist",                      // 80
+
+    // influxdb
+    "database name can not be null",          // 81
+    "database name too long",
+    "precision should be ns, u, ms or s",     // 83
+    "no line in request body",
+    "invalid line protocol",                  // 85
+    "measurement, tag or field name too long",
+    "tags size can not more than 6",          // 87
+    "fields size can not more than 255",
+    "schema of stable is not compatible",     // 89
+
+    // rest bulk
+    "database name can not be null",          // 90
+    "database name too long",
+    "no data in request body",                // 92
+    "invalid bulk format or version",
+    "invalid bulk body",                      // 94
+    "invalid table, stable or column name",
 
 };
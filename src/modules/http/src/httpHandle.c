@@ -263,11 +263,14 @@ bool httpParseChunkedBody(HttpContext* pContext, HttpParser* pParser, bool test)
       pRet += size;
     }
 
+    // the size of next chunk is not read yet, it is not the last chunk of size 0
+    if (pSize >= pEnd || strstr(pSize, "\r\n") == NULL) return false;
     size = strtoul(pSize, NULL, 16);
   }
 
   if (!test) {
     *pRet = '\0';
+    pParser->data.len = (int32_t)(pRet - pParser->data.pos);
   }
 
   return true;
@@ -275,40 +278,49 @@ bool httpParseChunkedBody(HttpContext* pContext, HttpParser* pParser, bool test)
 
 bool httpReadChunkedBody(HttpContext* pContext, HttpParser* pParser) {
   bool parsedOk = httpParseChunkedBody(pContext, pParser, true);
-  if (parsedOk) {
-    httpParseChunkedBody(pContext, pParser, false);
-    return HTTP_CHECK_BODY_SUCCESS;
-  } else {
+  if (!parsedOk) {
     httpTrace("context:%p, fd:%d, ip:%s, chunked body not finished, continue read", pContext, pContext->fd,
               pContext->ipstr);
     if (!httpReadDataImp(pContext)) {
       httpError("context:%p, fd:%d, ip:%s, read chunked request error", pContext, pContext->fd, pContext->ipstr);
       return HTTP_CHECK_BODY_ERROR;
-    } else {
+    }
+
+    // the body may be finished by this read, and no more event comes then
+    if (!httpParseChunkedBody(pContext, pParser, true)) {
       return HTTP_CHECK_BODY_CONTINUE;
     }
   }
+
+  httpParseChunkedBody(pContext, pParser, false);
+  return HTTP_CHECK_BODY_SUCCESS;
 }
 
 int httpReadUnChunkedBody(HttpContext* pContext, HttpParser* pParser) {
   int dataReadLen = pParser->bufsize - (int)(pParser->data.pos - pParser->buffer);
-  if (dataReadLen > pParser->data.len) {
-    httpError("context:%p, fd:%d, ip:%s, un-chunked body length invalid, dataReadLen:%d > pContext->data.len:%d",
-              pContext, pContext->fd, pContext->ipstr, dataReadLen, pParser->data.len);
-    httpSendErrorResp(pContext, HTTP_PARSE_BODY_ERROR);
-    return HTTP_CHECK_BODY_ERROR;
-  } else if (dataReadLen < pParser->data.len) {
+  if (dataReadLen < pParser->data.len) {
     httpTrace("context:%p, fd:%d, ip:%s, un-chunked body not finished, dataReadLen:%d < pContext->data.len:%d, continue read",
               pContext, pContext->fd, pContext->ipstr, dataReadLen, pParser->data.len);
     if (!httpReadDataImp(pContext)) {
       httpError("context:%p, fd:%d, ip:%s, read chunked request error", pContext, pContext->fd, pContext->ipstr);
       return HTTP_CHECK_BODY_ERROR;
-    } else {
+    }
+
+    // the body may be finished by this read, and no more event comes then
+    dataReadLen = pParser->bufsize - (int)(pParser->data.pos - pParser->buffer);
+    if (dataReadLen < pParser->data.len) {
       return HTTP_CHECK_BODY_CONTINUE;
     }
-  } else {
-    return HTTP_CHECK_BODY_SUCCESS;
   }
+
+  if (dataReadLen > pParser->data.len) {
+    httpError("context:%p, fd:%d, ip:%s, un-chunked body length invalid, dataReadLen:%d > pContext->data.len:%d",
+              pContext, pContext->fd, pContext->ipstr, dataReadLen, pParser->data.len);
+    httpSendErrorResp(pContext, HTTP_PARSE_BODY_ERROR);
+    return HTTP_CHECK_BODY_ERROR;
+  }
+
+  return HTTP_CHECK_BODY_SUCCESS;
 }
 
 bool httpParseRequest(HttpContext* pContext) {
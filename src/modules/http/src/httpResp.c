@@ -165,6 +165,23 @@ void httpSendErrorRespWithDesc(HttpContext *pContext, int errNo, char *desc) {
     // grafana
     case HTTP_GC_QUERY_NULL:
     case HTTP_GC_QUERY_SIZE:
+    // influxdb
+    case HTTP_INFLUX_DB_NOT_INPUT:
+    case HTTP_INFLUX_DB_TOO_LONG:
+    case HTTP_INFLUX_INVALID_PRECISION:
+    case HTTP_INFLUX_LINES_NULL:
+    case HTTP_INFLUX_INVALID_LINE:
+    case HTTP_INFLUX_NAME_TOO_LONG:
+    case HTTP_INFLUX_TAGS_SIZE_LONG:
+    case HTTP_INFLUX_FIELDS_SIZE_LONG:
+    case HTTP_INFLUX_INVALID_SCHEMA:
+    // rest bulk
+    case HTTP_BULK_DB_NOT_INPUT:
+    case HTTP_BULK_DB_TOO_LONG:
+    case HTTP_BULK_BODY_NULL:
+    case HTTP_BULK_INVALID_VERSION:
+    case HTTP_BULK_INVALID_BODY:
+    case HTTP_BULK_INVALID_NAME:
       httpCode = 400;
       httpCodeStr = "Bad Request";
       break;
@@ -40,6 +40,7 @@
 #include "ttimer.h"
 
 #include "http.h"
+#include "httpBulk.h"
 #include "httpCode.h"
 #include "httpHandle.h"
 #include "httpResp.h"
@@ -94,6 +95,72 @@ void httpCleanUpContextTimer(HttpContext *pContext) {
   }
 }
 
+static void httpFreeParserBuffer(HttpParser *pParser) {
+  if (pParser->buffer != NULL && pParser->buffer != pParser->fixedBuf) {
+    free(pParser->buffer);
+  }
+  pParser->buffer = NULL;
+}
+
+// the parsed head and the body read are moved to the new buffer, the positions in them are rebased
+static bool httpResizeParserBuffer(HttpContext *pContext, int capacity) {
+  HttpParser *pParser = &pContext->parser;
+  if (capacity <= pParser->bufcap) return true;
+
+  char *buffer = (pParser->buffer == pParser->fixedBuf) ? malloc((size_t)capacity)
+                                                        : realloc(pParser->buffer, (size_t)capacity);
+  if (buffer == NULL) {
+    httpError("context:%p, fd:%d, ip:%s, failed to grow request buffer to %d", pContext, pContext->fd,
+              pContext->ipstr, capacity);
+    return false;
+  }
+
+  char *old = pParser->buffer;
+  if (old == pParser->fixedBuf) {
+    memcpy(buffer, old, (size_t)pParser->bufsize + 1);
+  }
+
+#define HTTP_REBASE(p) if ((p) != NULL) (p) = buffer + ((p) - old)
+  HTTP_REBASE(pParser->pLast);
+  HTTP_REBASE(pParser->pCur);
+  HTTP_REBASE(pParser->method.pos);
+  HTTP_REBASE(pParser->data.pos);
+  HTTP_REBASE(pParser->token.pos);
+  for (int i = 0; i < HTTP_MAX_URL; ++i) {
+    HTTP_REBASE(pParser->path[i].pos);
+  }
+#undef HTTP_REBASE
+
+  httpTrace("context:%p, fd:%d, ip:%s, request buffer grows from %d to %d", pContext, pContext->fd, pContext->ipstr,
+            pParser->bufcap, capacity);
+  pParser->buffer = buffer;
+  pParser->bufcap = capacity;
+  return true;
+}
+
+// only the body of bulk request grows beyond HTTP_BUFFER_SIZE, after the head is parsed, up to
+// HTTP_MAX_BULK_BODY_SIZE. The whole body is reserved at once if its length is known
+static bool httpGrowParserBuffer(HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
+  if (!pContext->parsed || pParser->pMethod == NULL || pParser->pMethod->bulkBodyFp == NULL ||
+      !(*pParser->pMethod->bulkBodyFp)(pContext)) {
+    return false;
+  }
+
+  int headLen = (int)(pParser->data.pos - pParser->buffer);
+  int maxCap = headLen + HTTP_MAX_BULK_BODY_SIZE + HTTP_STEP_SIZE + 1;
+  int capacity = pParser->bufcap * 2;
+  if (pContext->httpChunked == HTTP_UNCUNKED) {
+    if (pParser->data.len <= 0 || pParser->data.len > HTTP_MAX_BULK_BODY_SIZE) return false;
+    capacity = headLen + pParser->data.len + HTTP_STEP_SIZE + 1;
+  } else if (capacity > maxCap) {
+    capacity = maxCap;
+  }
+
+  if (capacity <= pParser->bufcap) return false;
+  return httpResizeParserBuffer(pContext, capacity);
+}
+
 void httpCleanUpContext(HttpThread *pThread, HttpContext *pContext) {
   void *sigature = __sync_val_compare_and_swap_64(&pContext->signature, pContext->signature, 0);
   if (sigature == NULL) {
@@ -146,6 +213,8 @@ void httpCleanUpContext(HttpThread *pThread, HttpContext *pContext) {
   // avoid double free
   httpFreeJsonBuf(pContext);
   httpFreeMultiCmds(pContext);
+  httpFreeBulk(pContext);
+  httpFreeParserBuffer(&pContext->parser);
   httpFreeContext(pThread->pServer, pContext);
 }
 
@@ -165,7 +234,10 @@ bool httpInitContext(HttpContext *pContext) {
   memset(&pContext->singleCmd, 0, sizeof(HttpSqlCmd));
 
   HttpParser *pParser = &pContext->parser;
+  httpFreeParserBuffer(pParser);
   memset(pParser, 0, sizeof(HttpParser));
+  pParser->buffer = pParser->fixedBuf;
+  pParser->bufcap = HTTP_BUFFER_SIZE;
   pParser->pCur = pParser->pLast = pParser->buffer;
 
   httpTrace("context:%p, fd:%d, ip:%s, thread:%s, accessTimes:%d, parsed:%d",
@@ -265,7 +337,20 @@ void httpReadDirtyData(int fd) {
 bool httpReadDataImp(HttpContext *pContext) {
   HttpParser *pParser = &pContext->parser;
 
-  while (pParser->bufsize <= (HTTP_BUFFER_SIZE - HTTP_STEP_SIZE)) {
+  while (1) {
+    if (pParser->bufsize >= (pParser->bufcap - HTTP_STEP_SIZE)) {
+      // the head is parsed first, the buffer may grow for the rest of body in the next read
+      if (!pContext->parsed) break;
+
+      if (!httpGrowParserBuffer(pContext)) {
+        httpReadDirtyData(pContext->fd);
+        httpError("context:%p, fd:%d, ip:%s, thread:%s, request big than:%d",
+                  pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, pParser->bufcap);
+        httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
+        return false;
+      }
+    }
+
     int nread = (int)taosReadSocket(pContext->fd, pParser->buffer + pParser->bufsize, HTTP_STEP_SIZE);
     if (nread >= 0 && nread < HTTP_STEP_SIZE) {
       pParser->bufsize += nread;
@@ -283,14 +368,6 @@ bool httpReadDataImp(HttpContext *pContext) {
     } else {
       pParser->bufsize += nread;
     }
-
-    if (pParser->bufsize >= (HTTP_BUFFER_SIZE - HTTP_STEP_SIZE)) {
-      httpReadDirtyData(pContext->fd);
-      httpError("context:%p, fd:%d, ip:%s, thread:%s, request big than:%d",
-                pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, HTTP_BUFFER_SIZE);
-      httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
-      return false;
-    }
   }
 
   pParser->buffer[pParser->bufsize] = 0;
@@ -301,29 +378,52 @@ bool httpReadDataImp(HttpContext *pContext) {
 }
 
 bool httpDecompressData(HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
   if (pContext->contentEncoding != HTTP_COMPRESS_GZIP) {
-    httpDump("context:%p, fd:%d, ip:%s, content:%s", pContext, pContext->fd, pContext->ipstr, pContext->parser.data.pos);
+    httpDump("context:%p, fd:%d, ip:%s, content:%s", pContext, pContext->fd, pContext->ipstr, pParser->data.pos);
     return true;
   }
 
-  char   *decompressBuf = calloc(HTTP_DECOMPRESS_BUF_SIZE, 1);
+  // the body of bulk request is decompressed up to HTTP_MAX_BULK_BODY_SIZE, the output buffer is doubled
+  // while it is full, the others are limited to the rest of fixed buffer
+  int     headLen = (int)(pParser->data.pos - pParser->buffer);
+  int32_t maxLen = HTTP_BUFFER_SIZE - headLen - 1;
   int32_t decompressBufLen = HTTP_DECOMPRESS_BUF_SIZE;
-  size_t  bufsize = sizeof(pContext->parser.buffer) - (pContext->parser.data.pos - pContext->parser.buffer) - 1;
-  if (decompressBufLen > (int)bufsize) {
-    decompressBufLen = (int)bufsize;
+  if (pParser->pMethod->bulkBodyFp != NULL && (*pParser->pMethod->bulkBodyFp)(pContext)) {
+    maxLen = HTTP_MAX_BULK_BODY_SIZE;
+    while (decompressBufLen < pParser->data.len * 4 && decompressBufLen < maxLen) decompressBufLen *= 2;
+  }
+  if (decompressBufLen > maxLen) {
+    decompressBufLen = maxLen;
   }
 
-  int ret = httpGzipDeCompress(pContext->parser.data.pos, pContext->parser.data.len, decompressBuf, &decompressBufLen);
+  char *decompressBuf = NULL;
+  int   ret = -1;
+  while (decompressBufLen > 0) {
+    char *buf = realloc(decompressBuf, (size_t)decompressBufLen);
+    if (buf == NULL) break;
+    decompressBuf = buf;
+
+    int32_t len = decompressBufLen;
+    ret = httpGzipDeCompress(pParser->data.pos, pParser->data.len, decompressBuf, &len);
+    if (ret != HTTP_GZIP_BUF_FULL || decompressBufLen >= maxLen) {
+      decompressBufLen = len;
+      break;
+    }
+
+    decompressBufLen = (decompressBufLen > maxLen / 2) ? maxLen : decompressBufLen * 2;
+  }
 
-  if (ret == 0) {
-    memcpy(pContext->parser.data.pos, decompressBuf, decompressBufLen);
-    pContext->parser.data.pos[decompressBufLen] = 0;
+  if (ret == 0 && httpResizeParserBuffer(pContext, headLen + decompressBufLen + 1)) {
+    memcpy(pParser->data.pos, decompressBuf, (size_t)decompressBufLen);
+    pParser->data.pos[decompressBufLen] = 0;
     httpDump("context:%p, fd:%d, ip:%s, rawSize:%d, decompressSize:%d, content:%s",
-              pContext, pContext->fd, pContext->ipstr, pContext->parser.data.len, decompressBufLen,  decompressBuf);
-    pContext->parser.data.len = decompressBufLen;
+              pContext, pContext->fd, pContext->ipstr, pParser->data.len, decompressBufLen, pParser->data.pos);
+    pParser->data.len = decompressBufLen;
   } else {
     httpError("context:%p, fd:%d, ip:%s, failed to decompress data, rawSize:%d, error:%d",
-              pContext, pContext->fd, pContext->ipstr, pContext->parser.data.len, ret);
+              pContext, pContext->fd, pContext->ipstr, pParser->data.len, ret);
+    ret = -1;
   }
 
   free(decompressBuf);
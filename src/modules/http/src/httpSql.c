@@ -14,16 +14,20 @@
  */
 
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "http.h"
+#include "httpBulk.h"
 #include "httpCode.h"
 #include "httpHandle.h"
 #include "httpResp.h"
 #include "taos.h"
+#include "tglobalcfg.h"
 #include "tsclient.h"
+#include "ttime.h"
 
 void *taos_connect_a(char *ip, char *user, char *pass, char *db, int port, void (*fp)(void *, TAOS_RES *, int),
                      void *param, void **taos);
@@ -41,6 +45,10 @@ void httpProcessMultiSqlRetrieveCallBack(void *param, TAOS_RES *result, int numO
 
   bool isContinue = false;
 
+  if (singleCmd->elapsed == 0) {
+    singleCmd->elapsed = (int32_t)(taosGetTimestampUs() - singleCmd->stime);
+  }
+
   if (numOfRows > 0) {
     if (singleCmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->buildQueryJsonFp) {
       isContinue = (encode->buildQueryJsonFp)(pContext, singleCmd, result, numOfRows);
@@ -53,8 +61,9 @@ void httpProcessMultiSqlRetrieveCallBack(void *param, TAOS_RES *result, int numO
               pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, numOfRows, sql);
     taos_fetch_rows_a(result, httpProcessMultiSqlRetrieveCallBack, param);
   } else {
-    httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, stop retrieve, numOfRows:%d, sql:%s",
-              pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, numOfRows, sql);
+    httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, stop retrieve, numOfRows:%d, elapsed:%dus, sql:%s",
+              pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, numOfRows,
+              singleCmd->elapsed, sql);
 
     if (numOfRows < 0) {
       httpError("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, retrieve failed code:%d, sql:%s",
@@ -87,6 +96,10 @@ void httpProcessMultiSqlCallBack(void *param, TAOS_RES *result, int code) {
     return;
   }
 
+  if (code < 0 || result == NULL) {
+    singleCmd->elapsed = (int32_t)(taosGetTimestampUs() - singleCmd->stime);
+  }
+
   if (code < 0) {
     if (encode->checkFinishedFp != NULL && !encode->checkFinishedFp(pContext, singleCmd, code >= 0 ? 0 : -code)) {
       singleCmd->code = -code;
@@ -110,8 +123,9 @@ void httpProcessMultiSqlCallBack(void *param, TAOS_RES *result, int code) {
   if (result == NULL) {
     // not select or show commands
     int affectRows = code;
-    httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, affect rows:%d, sql:%s",
-              pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, affectRows, sql);
+    httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, affect rows:%d, elapsed:%dus, sql:%s",
+              pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, affectRows,
+              singleCmd->elapsed, sql);
 
     singleCmd->code = 0;
 
@@ -160,6 +174,8 @@ void httpProcessMultiSql(HttpContext *pContext) {
   }
 
   HttpSqlCmd *cmd = multiCmds->cmds + multiCmds->pos;
+  cmd->stime = taosGetTimestampUs();
+  cmd->elapsed = 0;
 
   char *sql = httpGetCmdsString(pContext, cmd->sql);
   httpDump("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, start query, sql:%s", pContext, pContext->fd,
@@ -167,6 +183,228 @@ void httpProcessMultiSql(HttpContext *pContext) {
   taos_query_a(pContext->session->taos, sql, httpProcessMultiSqlCallBack, (void *)pContext);
 }
 
+/*
+ * The cmds of a multi-sql request are executed concurrently if they are independent of each other, that is, the
+ * encode method neither checks the result of a cmd nor jumps to another one, such as the targets of grafana.
+ *
+ * At most multiCmds->parallel cmds are launched but not written. Each cmd holds its result after the first block is
+ * retrieved, and the results are written into the json buffer in the original order by the thread which holds
+ * multiCmds->writing. The cmds are launched by the writer only, after the results of previous cmds are written.
+ */
+static void httpWriteParallelSql(HttpContext *pContext);
+
+static bool httpIsParallelSql(HttpContext *pContext) {
+  HttpSqlCmds *     multiCmds = pContext->multiCmds;
+  HttpEncodeMethod *encode = pContext->encodeMethod;
+
+  return tsHttpMaxParallelSql > 1 && multiCmds->size - multiCmds->pos > 1 && encode->checkFinishedFp == NULL &&
+         encode->setNextCmdFp == NULL;
+}
+
+static void httpProcessParallelSqlFinished(HttpSqlCmd *cmd, void *result, int32_t code, int32_t retCode) {
+  HttpContext *pContext = cmd->pContext;
+  if (pContext == NULL || pContext->signature != pContext) return;
+
+  HttpSqlCmds *multiCmds = pContext->multiCmds;
+
+  cmd->result = result;
+  cmd->code = code;
+  cmd->retCode = retCode;
+  cmd->elapsed = (int32_t)(taosGetTimestampUs() - cmd->stime);
+
+  // the result is set before the state, and the state before the writer being checked
+  __sync_synchronize();
+  cmd->cmdState = HTTP_CMD_STATE_RUN_FINISHED;
+
+  if (__sync_bool_compare_and_swap(&multiCmds->writing, 0, 1)) {
+    httpWriteParallelSql(pContext);
+  }
+}
+
+static void httpProcessParallelSqlRetrieveCallBack(void *param, TAOS_RES *result, int numOfRows) {
+  HttpSqlCmd *cmd = (HttpSqlCmd *)param;
+  httpProcessParallelSqlFinished(cmd, result, TSDB_CODE_SUCCESS, numOfRows);
+}
+
+static void httpProcessParallelSqlCallBack(void *param, TAOS_RES *result, int code) {
+  HttpSqlCmd * cmd = (HttpSqlCmd *)param;
+  HttpContext *pContext = cmd->pContext;
+  if (pContext == NULL || pContext->signature != pContext) return;
+
+  if (-code == TSDB_CODE_ACTION_IN_PROGRESS) {
+    httpWarn("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, code:%d:inprogress, sql:%s", pContext, pContext->fd,
+             pContext->ipstr, pContext->user, (int)(cmd - pContext->multiCmds->cmds), -code,
+             httpGetCmdsString(pContext, cmd->sql));
+    return;
+  }
+
+  if (code >= 0 && result != NULL) {
+    // the first block is retrieved in parallel as well, the following ones are retrieved when written
+    taos_fetch_rows_a(result, httpProcessParallelSqlRetrieveCallBack, cmd);
+  } else if (code < 0) {
+    httpProcessParallelSqlFinished(cmd, result, -code, 0);
+  } else {
+    httpProcessParallelSqlFinished(cmd, NULL, TSDB_CODE_SUCCESS, code);
+  }
+}
+
+static void httpLaunchParallelSql(HttpContext *pContext, HttpSqlCmd *cmd) {
+  cmd->pContext = pContext;
+  cmd->result = NULL;
+  cmd->code = TSDB_CODE_SUCCESS;
+  cmd->retCode = 0;
+  cmd->elapsed = 0;
+  cmd->cmdState = HTTP_CMD_STATE_NOT_RUN_YET;
+  cmd->stime = taosGetTimestampUs();
+
+  char *sql = httpGetCmdsString(pContext, cmd->sql);
+  httpDump("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, start parallel query, sql:%s", pContext, pContext->fd,
+           pContext->ipstr, pContext->user, (int)(cmd - pContext->multiCmds->cmds), sql);
+  taos_query_a(pContext->session->taos, sql, httpProcessParallelSqlCallBack, (void *)cmd);
+}
+
+/*
+ * write the rows retrieved, return false if more rows are being retrieved, and the writing continues in
+ * httpWriteParallelSqlRetrieveCallBack
+ */
+static void httpWriteParallelSqlRetrieveCallBack(void *param, TAOS_RES *result, int numOfRows);
+
+static bool httpWriteParallelSqlRows(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result, int numOfRows) {
+  HttpSqlCmds *     multiCmds = pContext->multiCmds;
+  HttpEncodeMethod *encode = pContext->encodeMethod;
+
+  bool isContinue = false;
+  if (numOfRows > 0 && cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->buildQueryJsonFp) {
+    isContinue = (encode->buildQueryJsonFp)(pContext, cmd, result, numOfRows);
+  }
+
+  if (isContinue) {
+    taos_fetch_rows_a(result, httpWriteParallelSqlRetrieveCallBack, cmd);
+    return false;
+  }
+
+  if (numOfRows < 0) {
+    httpError("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, retrieve failed code:%d, sql:%s", pContext,
+              pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, -numOfRows,
+              httpGetCmdsString(pContext, cmd->sql));
+  } else {
+    taos_free_result(result);
+  }
+
+  if (cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->stopJsonFp) {
+    (encode->stopJsonFp)(pContext, cmd);
+  }
+
+  return true;
+}
+
+static void httpWriteParallelSqlRetrieveCallBack(void *param, TAOS_RES *result, int numOfRows) {
+  HttpSqlCmd * cmd = (HttpSqlCmd *)param;
+  HttpContext *pContext = cmd->pContext;
+  if (pContext == NULL || pContext->signature != pContext) return;
+
+  if (httpWriteParallelSqlRows(pContext, cmd, result, numOfRows)) {
+    pContext->multiCmds->pos++;
+    httpWriteParallelSql(pContext);
+  }
+}
+
+// return false if the rows of cmd are still being written
+static bool httpWriteParallelSqlResult(HttpContext *pContext, HttpSqlCmd *cmd) {
+  HttpSqlCmds *     multiCmds = pContext->multiCmds;
+  HttpEncodeMethod *encode = pContext->encodeMethod;
+  char *            sql = httpGetCmdsString(pContext, cmd->sql);
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, code:%d, rows:%d, elapsed:%dus, wait:%" PRId64
+            "us, sql:%s",
+            pContext, pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, cmd->code, cmd->retCode,
+            cmd->elapsed, taosGetTimestampUs() - cmd->stime - cmd->elapsed, sql);
+
+  if (cmd->code != TSDB_CODE_SUCCESS) {
+    httpError("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, error code:%d, sql:%s", pContext, pContext->fd,
+              pContext->ipstr, pContext->user, multiCmds->pos, cmd->code, sql);
+
+    if (cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN) {
+      if (encode->startJsonFp) (encode->startJsonFp)(pContext, cmd, cmd->result);
+      if (encode->stopJsonFp) (encode->stopJsonFp)(pContext, cmd);
+    }
+    return true;
+  }
+
+  if (cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->startJsonFp) {
+    (encode->startJsonFp)(pContext, cmd, cmd->result);
+  }
+
+  if (cmd->result != NULL) {
+    return httpWriteParallelSqlRows(pContext, cmd, cmd->result, cmd->retCode);
+  }
+
+  // not select or show commands
+  if (cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->buildAffectRowJsonFp) {
+    (encode->buildAffectRowJsonFp)(pContext, cmd, cmd->retCode);
+  }
+
+  if (cmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->stopJsonFp) {
+    (encode->stopJsonFp)(pContext, cmd);
+  }
+
+  return true;
+}
+
+// called by the thread holding multiCmds->writing
+static void httpWriteParallelSql(HttpContext *pContext) {
+  HttpSqlCmds *     multiCmds = pContext->multiCmds;
+  HttpEncodeMethod *encode = pContext->encodeMethod;
+
+  while (true) {
+    while (multiCmds->launched < multiCmds->size && multiCmds->launched - multiCmds->pos < multiCmds->parallel) {
+      HttpSqlCmd *cmd = multiCmds->cmds + multiCmds->launched;
+      multiCmds->launched++;
+      httpLaunchParallelSql(pContext, cmd);
+    }
+
+    if (multiCmds->pos >= multiCmds->size) {
+      httpTrace("context:%p, fd:%d, ip:%s, user:%s, process pos:%d, size:%d, stop parallel mulit-querys", pContext,
+                pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, multiCmds->size);
+      if (encode->cleanJsonFp) {
+        (encode->cleanJsonFp)(pContext);
+      }
+      httpCloseContextByApp(pContext);
+      return;
+    }
+
+    HttpSqlCmd *cmd = multiCmds->cmds + multiCmds->pos;
+    if (cmd->cmdState != HTTP_CMD_STATE_RUN_FINISHED) {
+      // the cmd may be finished before the writer released, then it is written by this thread again if possible
+      __sync_bool_compare_and_swap(&multiCmds->writing, 1, 0);
+      if (cmd->cmdState != HTTP_CMD_STATE_RUN_FINISHED || !__sync_bool_compare_and_swap(&multiCmds->writing, 0, 1)) {
+        return;
+      }
+      continue;
+    }
+
+    if (!httpWriteParallelSqlResult(pContext, cmd)) {
+      return;
+    }
+
+    multiCmds->pos++;
+  }
+}
+
+static void httpProcessParallelSql(HttpContext *pContext) {
+  HttpSqlCmds *multiCmds = pContext->multiCmds;
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, start parallel multi-querys pos:%d, size:%d, parallel:%d", pContext,
+            pContext->fd, pContext->ipstr, pContext->user, multiCmds->pos, multiCmds->size, tsHttpMaxParallelSql);
+
+  // the first cmds are launched by the writer as well, so no result is written before all of them launched
+  multiCmds->parallel = (int16_t)tsHttpMaxParallelSql;
+  multiCmds->launched = multiCmds->pos;
+  multiCmds->writing = 1;
+
+  httpWriteParallelSql(pContext);
+}
+
 void httpProcessMultiSqlCmd(HttpContext *pContext) {
   if (pContext == NULL || pContext->signature != pContext) return;
 
@@ -183,7 +421,12 @@ void httpProcessMultiSqlCmd(HttpContext *pContext) {
     (encode->initJsonFp)(pContext);
   }
 
-  httpProcessMultiSql(pContext);
+  if (httpIsParallelSql(pContext)) {
+    httpProcessParallelSql(pContext);
+  } else {
+    multiCmds->parallel = 0;
+    httpProcessMultiSql(pContext);
+  }
 }
 
 void httpProcessSingleSqlRetrieveCallBack(void *param, TAOS_RES *result, int numOfRows) {
@@ -335,6 +578,9 @@ void httpExecCmd(HttpContext *pContext) {
     case HTTP_REQTYPE_HEARTBEAT:
       httpProcessHeartBeatCmd(pContext);
       break;
+    case HTTP_REQTYPE_BULK_INSERT:
+      httpProcessBulkCmd(pContext);
+      break;
     case HTTP_REQTYPE_OTHERS:
       httpCloseContextByApp(pContext);
       break;
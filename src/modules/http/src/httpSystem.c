@@ -29,7 +29,9 @@
 #include "ttimer.h"
 
 #include "gcHandle.h"
+#include "httpBulk.h"
 #include "httpHandle.h"
+#include "influxHandle.h"
 #include "restHandle.h"
 #include "tgHandle.h"
 
@@ -51,9 +53,14 @@ int httpInitSystem() {
 
   pthread_mutex_init(&httpServer->serverMutex, NULL);
 
+  if (!httpInitBulk(tsHttpMaxThreads)) {
+    return -1;
+  }
+
   restInitHandle(httpServer);
   gcInitHandle(httpServer);
   tgInitHandle(httpServer);
+  influxInitHandle(httpServer);
 
   return 0;
 }
@@ -119,6 +126,7 @@ void httpCleanUpSystem() {
   }
 
   httpCleanUpConnect(httpServer);
+  httpCleanUpBulk();
   httpRemoveAllSessions(httpServer);
 
   if (httpServer->pContextPool != NULL) {
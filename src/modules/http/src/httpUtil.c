@@ -378,7 +378,8 @@ int httpGzipDeCompress(char *srcData, int32_t nSrcData, char *destData, int32_t
   }
 
   while (gzipStream.total_out < *nDestData && gzipStream.total_in < nSrcData) {
-    gzipStream.avail_in = gzipStream.avail_out = nSrcData;  //1
+    gzipStream.avail_in = (uInt)(nSrcData - gzipStream.total_in);
+    gzipStream.avail_out = (uInt)(*nDestData - gzipStream.total_out);
     if ((err = inflate(&gzipStream, Z_NO_FLUSH)) == Z_STREAM_END) {
       break;
     }
@@ -397,6 +398,10 @@ int httpGzipDeCompress(char *srcData, int32_t nSrcData, char *destData, int32_t
   if (inflateEnd(&gzipStream) != Z_OK) {
     return -4;
   }
+
+  if (err != Z_STREAM_END && gzipStream.total_out >= *nDestData) {
+    return HTTP_GZIP_BUF_FULL;
+  }
   *nDestData = gzipStream.total_out;
 
   return 0;
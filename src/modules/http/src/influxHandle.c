@@ -0,0 +1,1194 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "httpBulk.h"
+#include "influxHandle.h"
+#include "taosmsg.h"
+#include "tmd5.h"
+#include "tsdb.h"
+#include "ttime.h"
+#include "ttypes.h"
+
+/*
+ * influxdb line protocol, one point in each line:
+ *
+ *   measurement[,tag=value...] field=value[,field=value...] [timestamp]
+ *
+ * POST /influxdb/<db>[?precision=ns|u|ms|s]
+ * POST /influxdb/write?db=<db>[&precision=ns|u|ms|s]
+ *
+ * The measurement is written into the stable of the same name, each series of measurement and tags is a table
+ * created from the stable, and the fields are the columns prefixed by "f_", tags are prefixed by "t_". The stable
+ * is created, or altered with the columns and tags not exist, according to the request.
+ *
+ * The body, up to HTTP_MAX_BULK_BODY_SIZE, is parsed in one pass without copy, the escaped characters are
+ * unescaped and the names and values are terminated in place. The rows of each table are bound to its prepared
+ * statement as typed arrays, and written into the submit blocks directly without sql, see httpBulk.c.
+ */
+
+static bool influxIsBulkRequest(struct HttpContext *pContext) { return true; }
+static HttpDecodeMethod influxDecodeMethod = {"influxdb", influxProcessRequest, influxIsBulkRequest};
+
+typedef struct {
+  char *  key;
+  char *  value;  // unescaped string, or token of number and boolean
+  int32_t len;
+  int8_t  type;   // TSDB_DATA_TYPE_BIGINT, DOUBLE, BOOL or BINARY, tags are always BINARY
+  int16_t column; // index of tag or field in stable
+  union {
+    int64_t i;
+    double  d;
+  } v;
+} InfluxPair;
+
+typedef struct {
+  int32_t stable;
+  int32_t pairs;  // index of the first tag, followed by fields
+  int16_t numOfTags;
+  int16_t numOfFields;
+  bool    hasTime;
+  int64_t timestamp;
+  int32_t next;   // next line of the same series
+} InfluxLine;
+
+typedef struct {
+  char *  key;                      // name in request
+  char    name[TSDB_COL_NAME_LEN];  // name of column or tag, with prefix
+  int8_t  type;                     // type of values in request
+  int16_t len;                      // max length of values in request
+  int8_t  colType;                  // type in stable, -1 if not exist
+  int16_t colBytes;
+  int16_t param;                    // index of parameter in the table being built, -1 if not bound
+} InfluxColumn;
+
+typedef struct {
+  char *        measurement;
+  char          name[TSDB_METER_NAME_LEN];
+  InfluxColumn  tags[TSDB_MAX_TAGS];
+  int16_t       numOfTags;
+  InfluxColumn *fields;
+  int16_t       numOfFields;
+  int32_t       maxFields;
+  int16_t       numOfDbTags;            // tags of the stable in db
+  int16_t       dbTags[TSDB_MAX_TAGS];  // index in tags of each tag in db, -1 if not in request
+  int8_t        dbTagTypes[TSDB_MAX_TAGS];
+} InfluxStable;
+
+typedef struct {
+  int32_t  stable;
+  int32_t  first;
+  int32_t  last;
+  int32_t  numOfRows;
+  uint64_t hash;
+  char     table[TSDB_METER_NAME_LEN];
+} InfluxSeries;
+
+typedef struct {
+  int64_t       unit;  // nanoseconds of timestamp unit in request
+  InfluxLine *  lines;
+  int32_t       numOfLines;
+  int32_t       maxLines;
+  InfluxPair *  pairs;
+  int32_t       numOfPairs;
+  int32_t       maxPairs;
+  InfluxStable *stables;
+  int32_t       numOfStables;
+  int32_t       maxStables;
+  InfluxSeries *series;
+  int32_t       numOfSeries;
+  int32_t       maxSeries;
+  int32_t *     slots;  // open addressing hash of series, index + 1 of series in each slot
+  int32_t       numOfSlots;
+} InfluxRequest;
+
+void influxInitHandle(HttpServer *pServer) { httpAddMethod(pServer, &influxDecodeMethod); }
+
+static void influxFreeRequest(void *param) {
+  InfluxRequest *pReq = (InfluxRequest *)param;
+
+  for (int32_t i = 0; i < pReq->numOfStables; ++i) {
+    free(pReq->stables[i].fields);
+  }
+
+  free(pReq->lines);
+  free(pReq->pairs);
+  free(pReq->stables);
+  free(pReq->series);
+  free(pReq->slots);
+  free(pReq);
+}
+
+static bool influxReserve(void **array, int32_t *maxSize, int32_t size, size_t elemSize) {
+  if (size < *maxSize) return true;
+
+  int32_t newSize = (*maxSize == 0) ? 64 : *maxSize * 2;
+  void *  tmp = realloc(*array, (size_t)newSize * elemSize);
+  if (tmp == NULL) return false;
+
+  *array = tmp;
+  *maxSize = newSize;
+  return true;
+}
+
+/*
+ * names are converted into the identifiers of TDengine, the characters other than letters,
+ * digits and underscore are replaced by underscore
+ */
+static bool influxSetName(char *dst, const char *prefix, const char *src, int32_t maxLen) {
+  int32_t len = (int32_t)strlen(prefix);
+  if (len + (int32_t)strlen(src) >= maxLen) return false;
+
+  strcpy(dst, prefix);
+  for (const char *p = src; *p != 0; ++p) {
+    char c = *p;
+    if (c >= 'A' && c <= 'Z') {
+      c = (char)(c | 0x20);
+    } else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) {
+      c = '_';
+    }
+    dst[len++] = c;
+  }
+  dst[len] = 0;
+
+  // identifier can not start with digit
+  if (prefix[0] == 0 && dst[0] >= '0' && dst[0] <= '9') {
+    if (len + 2 >= maxLen) return false;
+    memmove(dst + 2, dst, (size_t)len + 1);
+    dst[0] = 'm';
+    dst[1] = '_';
+  }
+
+  return true;
+}
+
+/*
+ * read a token until one of the delimiters. The escaped characters are unescaped in place, and the
+ * token is terminated in the body. Returns the delimiter, or 0 at the end of line.
+ */
+static char influxReadToken(char **pCur, char *end, const char *delims, char **token, int32_t *len) {
+  char *r = *pCur;
+  char *w = *pCur;
+  *token = r;
+
+  while (r < end) {
+    char c = *r;
+    if (c == '\\' && r + 1 < end && (r[1] == ',' || r[1] == '=' || r[1] == ' ' || r[1] == '"' || r[1] == '\\')) {
+      *w++ = r[1];
+      r += 2;
+      continue;
+    }
+
+    if (c != 0 && strchr(delims, c) != NULL) break;
+
+    *w++ = c;
+    r++;
+  }
+
+  char delim = (r < end) ? *r : (char)0;
+  *len = (int32_t)(w - *token);
+  *w = 0;
+  *pCur = (r < end) ? r + 1 : end;
+
+  return delim;
+}
+
+static bool influxReadString(char **pCur, char *end, char **token, int32_t *len) {
+  char *r = *pCur + 1;
+  char *w = r;
+  *token = r;
+
+  while (r < end) {
+    if (*r == '\\' && r + 1 < end && (r[1] == '"' || r[1] == '\\')) {
+      *w++ = r[1];
+      r += 2;
+      continue;
+    }
+
+    if (*r == '"') break;
+    *w++ = *r++;
+  }
+
+  if (r >= end) return false;
+
+  *len = (int32_t)(w - *token);
+  *w = 0;
+  *pCur = r + 1;
+  return true;
+}
+
+static bool influxParseValue(InfluxPair *pPair) {
+  char *  v = pPair->value;
+  int32_t len = pPair->len;
+  char *  endptr = NULL;
+
+  if (strcmp(v, "t") == 0 || strcmp(v, "T") == 0 || strcmp(v, "true") == 0 || strcmp(v, "True") == 0 ||
+      strcmp(v, "TRUE") == 0) {
+    pPair->type = TSDB_DATA_TYPE_BOOL;
+    pPair->v.i = 1;
+    return true;
+  }
+
+  if (strcmp(v, "f") == 0 || strcmp(v, "F") == 0 || strcmp(v, "false") == 0 || strcmp(v, "False") == 0 ||
+      strcmp(v, "FALSE") == 0) {
+    pPair->type = TSDB_DATA_TYPE_BOOL;
+    pPair->v.i = 0;
+    return true;
+  }
+
+  // integer with suffix i, and unsigned integer with suffix u which is kept in bigint
+  if (len > 1 && (v[len - 1] == 'i' || v[len - 1] == 'u')) {
+    char suffix = v[len - 1];
+    v[len - 1] = 0;
+
+    errno = 0;
+    if (suffix == 'i') {
+      pPair->v.i = strtoll(v, &endptr, 10);
+    } else {
+      uint64_t u = strtoull(v, &endptr, 10);
+      if (u > INT64_MAX || v[0] == '-') return false;
+      pPair->v.i = (int64_t)u;
+    }
+
+    if (errno != 0 || *endptr != 0) return false;
+
+    pPair->type = TSDB_DATA_TYPE_BIGINT;
+    pPair->len = len - 1;
+    return true;
+  }
+
+  errno = 0;
+  pPair->v.d = strtod(v, &endptr);
+  if (errno != 0 || *endptr != 0 || endptr == v) return false;
+
+  pPair->type = TSDB_DATA_TYPE_DOUBLE;
+  return true;
+}
+
+static int8_t influxMergeType(int8_t type1, int8_t type2) {
+  if (type1 == type2) return type1;
+  if (type1 == TSDB_DATA_TYPE_BINARY || type2 == TSDB_DATA_TYPE_BINARY) return TSDB_DATA_TYPE_BINARY;
+  if (type1 == TSDB_DATA_TYPE_DOUBLE || type2 == TSDB_DATA_TYPE_DOUBLE) return TSDB_DATA_TYPE_DOUBLE;
+  return TSDB_DATA_TYPE_BIGINT;
+}
+
+static int32_t influxGetStable(InfluxRequest *pReq, char *measurement, int32_t hint) {
+  if (hint >= 0 && strcmp(pReq->stables[hint].measurement, measurement) == 0) {
+    return hint;
+  }
+
+  for (int32_t i = 0; i < pReq->numOfStables; ++i) {
+    if (strcmp(pReq->stables[i].measurement, measurement) == 0) return i;
+  }
+
+  if (!influxReserve((void **)&pReq->stables, &pReq->maxStables, pReq->numOfStables, sizeof(InfluxStable))) {
+    return -1;
+  }
+
+  InfluxStable *pStable = &pReq->stables[pReq->numOfStables];
+  memset(pStable, 0, sizeof(InfluxStable));
+  pStable->measurement = measurement;
+  if (!influxSetName(pStable->name, "", measurement, TSDB_METER_NAME_LEN)) {
+    return -2;
+  }
+
+  return pReq->numOfStables++;
+}
+
+static int32_t influxGetColumn(InfluxColumn *columns, int16_t numOfColumns, InfluxPair *pPair, int32_t hint) {
+  if (hint < numOfColumns && strcmp(columns[hint].key, pPair->key) == 0) {
+    return hint;
+  }
+
+  for (int32_t i = 0; i < numOfColumns; ++i) {
+    if (strcmp(columns[i].key, pPair->key) == 0) return i;
+  }
+
+  return -1;
+}
+
+/*
+ * add the tag or field into stable if not exists yet. The keys which are converted into the same name
+ * are mapped to the same column.
+ */
+static int32_t influxAddColumn(InfluxColumn *columns, int16_t *numOfColumns, const char *prefix, InfluxPair *pPair,
+                               int32_t hint) {
+  int32_t index = influxGetColumn(columns, *numOfColumns, pPair, hint);
+
+  if (index < 0) {
+    char name[TSDB_COL_NAME_LEN];
+    if (!influxSetName(name, prefix, pPair->key, TSDB_COL_NAME_LEN)) {
+      return -2;
+    }
+
+    for (int32_t i = 0; i < *numOfColumns && index < 0; ++i) {
+      if (strcmp(columns[i].name, name) == 0) index = i;
+    }
+
+    if (index < 0) {
+      index = (*numOfColumns)++;
+      InfluxColumn *pColumn = &columns[index];
+      memset(pColumn, 0, sizeof(InfluxColumn));
+      pColumn->key = pPair->key;
+      pColumn->type = pPair->type;
+      pColumn->colType = -1;
+      strcpy(pColumn->name, name);
+    }
+  }
+
+  InfluxColumn *pColumn = &columns[index];
+  pColumn->type = influxMergeType(pColumn->type, pPair->type);
+  if (pPair->len > pColumn->len) {
+    pColumn->len = (int16_t)pPair->len;
+  }
+
+  pPair->column = (int16_t)index;
+  return index;
+}
+
+static uint64_t influxHash(uint64_t hash, const char *str) {
+  for (const char *p = str; *p != 0; ++p) {
+    hash ^= (uint8_t)*p;
+    hash *= 1099511628211ULL;
+  }
+
+  hash ^= 0xff;
+  hash *= 1099511628211ULL;
+  return hash;
+}
+
+static bool influxSameSeries(InfluxRequest *pReq, InfluxSeries *pSeries, InfluxLine *pLine) {
+  InfluxLine *pFirst = &pReq->lines[pSeries->first];
+  if (pFirst->stable != pLine->stable || pFirst->numOfTags != pLine->numOfTags) return false;
+
+  for (int32_t i = 0; i < pLine->numOfTags; ++i) {
+    InfluxPair *p1 = &pReq->pairs[pFirst->pairs + i];
+    InfluxPair *p2 = &pReq->pairs[pLine->pairs + i];
+    if (strcmp(p1->key, p2->key) != 0 || strcmp(p1->value, p2->value) != 0) return false;
+  }
+
+  return true;
+}
+
+static bool influxRehashSeries(InfluxRequest *pReq) {
+  int32_t  numOfSlots = (pReq->numOfSlots == 0) ? 256 : pReq->numOfSlots * 2;
+  int32_t *slots = calloc((size_t)numOfSlots, sizeof(int32_t));
+  if (slots == NULL) return false;
+
+  for (int32_t i = 0; i < pReq->numOfSeries; ++i) {
+    uint32_t slot = (uint32_t)pReq->series[i].hash & (uint32_t)(numOfSlots - 1);
+    while (slots[slot] != 0) {
+      slot = (slot + 1) & (uint32_t)(numOfSlots - 1);
+    }
+    slots[slot] = i + 1;
+  }
+
+  free(pReq->slots);
+  pReq->slots = slots;
+  pReq->numOfSlots = numOfSlots;
+  return true;
+}
+
+/*
+ * table name of series is the stable name followed by the md5 of the series key, which is the measurement
+ * and the sorted tags, so the points of the same series are always written into the same table
+ */
+static void influxSetTableName(InfluxRequest *pReq, InfluxSeries *pSeries, InfluxLine *pLine) {
+  InfluxStable *pStable = &pReq->stables[pLine->stable];
+
+  MD5_CTX context;
+  MD5Init(&context);
+  MD5Update(&context, (uint8_t *)pStable->measurement, (uint32_t)strlen(pStable->measurement));
+  for (int32_t i = 0; i < pLine->numOfTags; ++i) {
+    InfluxPair *pPair = &pReq->pairs[pLine->pairs + i];
+    MD5Update(&context, (uint8_t *)",", 1);
+    MD5Update(&context, (uint8_t *)pPair->key, (uint32_t)strlen(pPair->key));
+    MD5Update(&context, (uint8_t *)"=", 1);
+    MD5Update(&context, (uint8_t *)pPair->value, (uint32_t)pPair->len);
+  }
+  MD5Final(&context);
+
+  char digest[33] = {0};
+  for (int32_t i = 0; i < 16; ++i) {
+    sprintf(digest + i * 2, "%02x", context.digest[i]);
+  }
+
+  if (strlen(pStable->name) + 1 + strlen(digest) < TSDB_METER_NAME_LEN) {
+    strcpy(pSeries->table, pStable->name);
+    strcat(pSeries->table, "_");
+    strcat(pSeries->table, digest);
+  } else {
+    pSeries->table[0] = 't';
+    strcpy(pSeries->table + 1, digest);
+  }
+}
+
+static bool influxAddToSeries(InfluxRequest *pReq, int32_t lineIndex) {
+  InfluxLine *pLine = &pReq->lines[lineIndex];
+
+  uint64_t hash = influxHash(14695981039346656037ULL, pReq->stables[pLine->stable].measurement);
+  for (int32_t i = 0; i < pLine->numOfTags; ++i) {
+    InfluxPair *pPair = &pReq->pairs[pLine->pairs + i];
+    hash = influxHash(influxHash(hash, pPair->key), pPair->value);
+  }
+
+  if (pReq->numOfSeries * 2 >= pReq->numOfSlots && !influxRehashSeries(pReq)) {
+    return false;
+  }
+
+  uint32_t mask = (uint32_t)(pReq->numOfSlots - 1);
+  uint32_t slot = (uint32_t)hash & mask;
+  while (pReq->slots[slot] != 0) {
+    InfluxSeries *pSeries = &pReq->series[pReq->slots[slot] - 1];
+    if (pSeries->hash == hash && influxSameSeries(pReq, pSeries, pLine)) {
+      pReq->lines[pSeries->last].next = lineIndex;
+      pSeries->last = lineIndex;
+      pSeries->numOfRows++;
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (!influxReserve((void **)&pReq->series, &pReq->maxSeries, pReq->numOfSeries, sizeof(InfluxSeries))) {
+    return false;
+  }
+
+  InfluxSeries *pSeries = &pReq->series[pReq->numOfSeries];
+  pSeries->stable = pLine->stable;
+  pSeries->first = lineIndex;
+  pSeries->last = lineIndex;
+  pSeries->numOfRows = 1;
+  pSeries->hash = hash;
+  influxSetTableName(pReq, pSeries, pLine);
+
+  pReq->slots[slot] = ++pReq->numOfSeries;
+  return true;
+}
+
+static InfluxPair *influxNewPair(InfluxRequest *pReq) {
+  if (!influxReserve((void **)&pReq->pairs, &pReq->maxPairs, pReq->numOfPairs, sizeof(InfluxPair))) {
+    return NULL;
+  }
+
+  InfluxPair *pPair = &pReq->pairs[pReq->numOfPairs++];
+  memset(pPair, 0, sizeof(InfluxPair));
+  return pPair;
+}
+
+/*
+ * parse one line terminated at end, returns the error code of http, and the reason in msg
+ */
+static int32_t influxParseLine(InfluxRequest *pReq, char *line, char *end, char *msg) {
+  char *  cur = line;
+  char *  token = NULL;
+  int32_t len = 0;
+
+  if (!influxReserve((void **)&pReq->lines, &pReq->maxLines, pReq->numOfLines, sizeof(InfluxLine))) {
+    return HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  int32_t     lineIndex = pReq->numOfLines;
+  InfluxLine *pLine = &pReq->lines[lineIndex];
+  memset(pLine, 0, sizeof(InfluxLine));
+  pLine->next = -1;
+  pLine->pairs = pReq->numOfPairs;
+
+  // measurement
+  char delim = influxReadToken(&cur, end, ", ", &token, &len);
+  if (len == 0) {
+    strcpy(msg, "measurement is empty");
+    return HTTP_INFLUX_INVALID_LINE;
+  }
+
+  int32_t hint = (lineIndex > 0) ? pReq->lines[lineIndex - 1].stable : -1;
+  pLine->stable = influxGetStable(pReq, token, hint);
+  if (pLine->stable == -1) return HTTP_NO_ENOUGH_MEMORY;
+  if (pLine->stable == -2) return HTTP_INFLUX_NAME_TOO_LONG;
+
+  // tags
+  while (delim == ',') {
+    InfluxPair *pPair = influxNewPair(pReq);
+    if (pPair == NULL) return HTTP_NO_ENOUGH_MEMORY;
+
+    delim = influxReadToken(&cur, end, "=", &pPair->key, &len);
+    if (delim != '=' || len == 0) {
+      strcpy(msg, "tag key is expected");
+      return HTTP_INFLUX_INVALID_LINE;
+    }
+
+    delim = influxReadToken(&cur, end, ", ", &pPair->value, &pPair->len);
+    if (pPair->len == 0) {
+      sprintf(msg, "value of tag %s is empty", pPair->key);
+      return HTTP_INFLUX_INVALID_LINE;
+    }
+
+    pPair->type = TSDB_DATA_TYPE_BINARY;
+    if (++pLine->numOfTags > TSDB_MAX_TAGS) {
+      return HTTP_INFLUX_TAGS_SIZE_LONG;
+    }
+  }
+
+  if (delim != ' ') {
+    strcpy(msg, "fields are expected");
+    return HTTP_INFLUX_INVALID_LINE;
+  }
+
+  // the tags are sorted by key, so the series key is unique
+  InfluxPair *tags = &pReq->pairs[pLine->pairs];
+  for (int32_t i = 1; i < pLine->numOfTags; ++i) {
+    InfluxPair tmp = tags[i];
+    int32_t    j = i - 1;
+    while (j >= 0 && strcmp(tags[j].key, tmp.key) > 0) {
+      tags[j + 1] = tags[j];
+      j--;
+    }
+    tags[j + 1] = tmp;
+  }
+
+  // fields
+  do {
+    InfluxPair *pPair = influxNewPair(pReq);
+    if (pPair == NULL) return HTTP_NO_ENOUGH_MEMORY;
+
+    delim = influxReadToken(&cur, end, "=", &pPair->key, &len);
+    if (delim != '=' || len == 0) {
+      strcpy(msg, "field key is expected");
+      return HTTP_INFLUX_INVALID_LINE;
+    }
+
+    if (cur < end && *cur == '"') {
+      if (!influxReadString(&cur, end, &pPair->value, &pPair->len)) {
+        sprintf(msg, "string value of field %s is not terminated", pPair->key);
+        return HTTP_INFLUX_INVALID_LINE;
+      }
+
+      delim = (cur < end) ? *cur++ : (char)0;
+      if (delim != ',' && delim != ' ' && delim != 0) {
+        sprintf(msg, "invalid character after field %s", pPair->key);
+        return HTTP_INFLUX_INVALID_LINE;
+      }
+      pPair->type = TSDB_DATA_TYPE_BINARY;
+    } else {
+      delim = influxReadToken(&cur, end, ", ", &pPair->value, &pPair->len);
+      if (pPair->len == 0 || !influxParseValue(pPair)) {
+        sprintf(msg, "invalid value of field %s", pPair->key);
+        return HTTP_INFLUX_INVALID_LINE;
+      }
+    }
+
+    if (++pLine->numOfFields >= TSDB_MAX_COLUMNS) {
+      return HTTP_INFLUX_FIELDS_SIZE_LONG;
+    }
+  } while (delim == ',');
+
+  // timestamp
+  while (cur < end && *cur == ' ') cur++;
+  if (cur < end) {
+    char *endptr = NULL;
+    errno = 0;
+    pLine->timestamp = strtoll(cur, &endptr, 10);
+    while (endptr < end && *endptr == ' ') endptr++;
+    if (errno != 0 || endptr == cur || endptr < end) {
+      strcpy(msg, "invalid timestamp");
+      return HTTP_INFLUX_INVALID_LINE;
+    }
+    pLine->hasTime = true;
+  }
+
+  // tags and fields of stable
+  InfluxStable *pStable = &pReq->stables[pLine->stable];
+  for (int32_t i = 0; i < pLine->numOfTags; ++i) {
+    int32_t index = influxAddColumn(pStable->tags, &pStable->numOfTags, INFLUX_TAG_PREFIX,
+                                    &pReq->pairs[pLine->pairs + i], i);
+    if (index == -2) return HTTP_INFLUX_NAME_TOO_LONG;
+    if (pStable->numOfTags > TSDB_MAX_TAGS) return HTTP_INFLUX_TAGS_SIZE_LONG;
+  }
+
+  for (int32_t i = 0; i < pLine->numOfFields; ++i) {
+    if (!influxReserve((void **)&pStable->fields, &pStable->maxFields, pStable->numOfFields,
+                       sizeof(InfluxColumn))) {
+      return HTTP_NO_ENOUGH_MEMORY;
+    }
+
+    int32_t index = influxAddColumn(pStable->fields, &pStable->numOfFields, INFLUX_FIELD_PREFIX,
+                                    &pReq->pairs[pLine->pairs + pLine->numOfTags + i], i);
+    if (index == -2) return HTTP_INFLUX_NAME_TOO_LONG;
+    if (pStable->numOfFields >= TSDB_MAX_COLUMNS) return HTTP_INFLUX_FIELDS_SIZE_LONG;
+  }
+
+  pReq->numOfLines++;
+  if (!influxAddToSeries(pReq, lineIndex)) {
+    return HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  return HTTP_SUCCESS;
+}
+
+static int32_t influxParseLines(InfluxRequest *pReq, char *data, int32_t dataLen, char *msg) {
+  char *  cur = data;
+  char *  end = data + dataLen;
+  int32_t lineNo = 0;
+
+  while (cur < end) {
+    char *eol = memchr(cur, '\n', (size_t)(end - cur));
+    if (eol == NULL) eol = end;
+    lineNo++;
+
+    char *lineEnd = eol;
+    if (lineEnd > cur && *(lineEnd - 1) == '\r') lineEnd--;
+    while (cur < lineEnd && (*cur == ' ' || *cur == '\t')) cur++;
+
+    // empty lines and comments are skipped
+    if (cur < lineEnd && *cur != '#') {
+      *lineEnd = 0;
+      char    reason[HTTP_BULK_DESC_SIZE / 2] = {0};
+      int32_t code = influxParseLine(pReq, cur, lineEnd, reason);
+      if (code != HTTP_SUCCESS) {
+        snprintf(msg, HTTP_BULK_DESC_SIZE, "%s at line %d%s%s", httpMsg[code], lineNo, (reason[0] != 0) ? ", " : "",
+                 reason);
+        return code;
+      }
+    }
+
+    cur = eol + 1;
+  }
+
+  return HTTP_SUCCESS;
+}
+
+static bool influxIsNumeric(char *value) {
+  char *endptr = NULL;
+  strtod(value, &endptr);
+  return endptr != value && *endptr == 0;
+}
+
+static int32_t influxCreateStable(void *taos, char *db, InfluxStable *pStable) {
+  size_t size = 128 + (size_t)(pStable->numOfFields + pStable->numOfTags) * (TSDB_COL_NAME_LEN + 24);
+  char * sql = malloc(size);
+  if (sql == NULL) return TSDB_CODE_CLI_OUT_OF_MEMORY;
+
+  int32_t len = sprintf(sql, "create table if not exists %s.%s(ts timestamp", db, pStable->name);
+  for (int32_t i = 0; i < pStable->numOfFields; ++i) {
+    InfluxColumn *pColumn = &pStable->fields[i];
+    if (pColumn->type == TSDB_DATA_TYPE_BINARY) {
+      len += sprintf(sql + len, ",%s binary(%d)", pColumn->name, MAX(pColumn->len, INFLUX_BINARY_LEN));
+    } else {
+      len += sprintf(sql + len, ",%s %s", pColumn->name, tDataTypeDesc[pColumn->type].aName);
+    }
+  }
+
+  if (pStable->numOfTags == 0) {
+    len += sprintf(sql + len, ") tags(%s binary(%d))", INFLUX_TAG_PREFIX "tag", INFLUX_BINARY_LEN);
+  } else {
+    len += sprintf(sql + len, ") tags(");
+    for (int32_t i = 0; i < pStable->numOfTags; ++i) {
+      InfluxColumn *pColumn = &pStable->tags[i];
+      len += sprintf(sql + len, "%s%s binary(%d)", (i == 0) ? "" : ",", pColumn->name,
+                     MAX(pColumn->len, INFLUX_BINARY_LEN));
+    }
+    len += sprintf(sql + len, ")");
+  }
+
+  int32_t code = httpBulkExecSql(taos, sql, NULL);
+  free(sql);
+  return code;
+}
+
+static int32_t influxDescribeStable(void *taos, char *db, InfluxStable *pStable, int32_t *precision) {
+  char       sql[TSDB_DB_NAME_LEN + TSDB_METER_NAME_LEN + 16];
+  TAOS_STMT *stmt = NULL;
+
+  sprintf(sql, "describe %s.%s", db, pStable->name);
+  int32_t code = httpBulkExecSql(taos, sql, &stmt);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  TAOS_RES *result = taos_stmt_use_result(stmt);
+  *precision = taos_result_precision(result);
+
+  for (int32_t i = 0; i < pStable->numOfTags; ++i) pStable->tags[i].colType = -1;
+  for (int32_t i = 0; i < pStable->numOfFields; ++i) pStable->fields[i].colType = -1;
+  pStable->numOfDbTags = 0;
+
+  TAOS_ROW row = NULL;
+  while ((row = taos_fetch_row(result)) != NULL) {
+    char *  name = (char *)row[0];
+    char *  typeName = (char *)row[1];
+    int32_t bytes = *(int32_t *)row[2];
+    bool    isTag = (row[3] != NULL && strncmp((char *)row[3], "tag", 3) == 0);
+
+    int8_t type = TSDB_DATA_TYPE_NULL;
+    for (int8_t t = TSDB_DATA_TYPE_BOOL; t <= TSDB_DATA_TYPE_NCHAR; ++t) {
+      if (strcasecmp(tDataTypeDesc[t].aName, typeName) == 0) type = t;
+    }
+
+    if (isTag) {
+      int32_t index = -1;
+      for (int32_t i = 0; i < pStable->numOfTags && index < 0; ++i) {
+        if (strcmp(pStable->tags[i].name, name) == 0) index = i;
+      }
+
+      if (index >= 0) {
+        pStable->tags[index].colType = type;
+        pStable->tags[index].colBytes = (int16_t)bytes;
+      }
+
+      pStable->dbTags[pStable->numOfDbTags] = (int16_t)index;
+      pStable->dbTagTypes[pStable->numOfDbTags] = type;
+      pStable->numOfDbTags++;
+    } else {
+      for (int32_t i = 0; i < pStable->numOfFields; ++i) {
+        if (strcmp(pStable->fields[i].name, name) == 0) {
+          pStable->fields[i].colType = type;
+          pStable->fields[i].colBytes = (int16_t)bytes;
+          break;
+        }
+      }
+    }
+  }
+
+  taos_stmt_close(stmt);
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * make sure the stable exists with all the tags and fields in request. The database and stable are created
+ * if not exist, and the columns and tags not exist are added into the stable.
+ */
+static bool influxCheckStable(HttpContext *pContext, HttpBulk *pBulk, InfluxStable *pStable, int32_t *precision) {
+  void *  taos = pContext->session->taos;
+  char    sql[TSDB_DB_NAME_LEN + TSDB_METER_NAME_LEN + TSDB_COL_NAME_LEN + 64];
+  int32_t code = influxDescribeStable(taos, pBulk->db, pStable, precision);
+
+  if (code == TSDB_CODE_INVALID_DB || code == TSDB_CODE_DB_NOT_SELECTED) {
+    sprintf(sql, "create database if not exists %s", pBulk->db);
+    code = httpBulkExecSql(taos, sql, NULL);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_INVALID_TABLE;
+    }
+  }
+
+  if (code == TSDB_CODE_INVALID_TABLE) {
+    code = influxCreateStable(taos, pBulk->db, pStable);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = influxDescribeStable(taos, pBulk->db, pStable, precision);
+    }
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    httpError("context:%p, fd:%d, ip:%s, user:%s, failed to check stable:%s.%s, code:%d", pContext, pContext->fd,
+              pContext->ipstr, pContext->user, pBulk->db, pStable->name, code);
+    pBulk->taosCode = code;
+    return false;
+  }
+
+  for (int32_t i = 0; i < pStable->numOfFields; ++i) {
+    InfluxColumn *pColumn = &pStable->fields[i];
+    if (pColumn->colType >= 0) continue;
+
+    if (pColumn->type == TSDB_DATA_TYPE_BINARY) {
+      pColumn->colBytes = (int16_t)MAX(pColumn->len, INFLUX_BINARY_LEN);
+      sprintf(sql, "alter table %s.%s add column %s binary(%d)", pBulk->db, pStable->name, pColumn->name,
+              pColumn->colBytes);
+    } else {
+      pColumn->colBytes = (int16_t)tDataTypeDesc[pColumn->type].nSize;
+      sprintf(sql, "alter table %s.%s add column %s %s", pBulk->db, pStable->name, pColumn->name,
+              tDataTypeDesc[pColumn->type].aName);
+    }
+
+    if ((code = httpBulkExecSql(taos, sql, NULL)) != TSDB_CODE_SUCCESS) {
+      pBulk->taosCode = code;
+      return false;
+    }
+    pColumn->colType = pColumn->type;
+  }
+
+  for (int32_t i = 0; i < pStable->numOfTags; ++i) {
+    InfluxColumn *pColumn = &pStable->tags[i];
+    if (pColumn->colType >= 0) continue;
+
+    if (pStable->numOfDbTags >= TSDB_MAX_TAGS) {
+      pBulk->httpCode = HTTP_INFLUX_TAGS_SIZE_LONG;
+      snprintf(pBulk->desc, HTTP_BULK_DESC_SIZE, "stable %s has no room for tag %s", pStable->name, pColumn->name);
+      return false;
+    }
+
+    pColumn->colBytes = (int16_t)MAX(pColumn->len, INFLUX_BINARY_LEN);
+    sprintf(sql, "alter table %s.%s add tag %s binary(%d)", pBulk->db, pStable->name, pColumn->name,
+            pColumn->colBytes);
+    if ((code = httpBulkExecSql(taos, sql, NULL)) != TSDB_CODE_SUCCESS) {
+      pBulk->taosCode = code;
+      return false;
+    }
+
+    pColumn->colType = TSDB_DATA_TYPE_BINARY;
+    pStable->dbTags[pStable->numOfDbTags] = (int16_t)i;
+    pStable->dbTagTypes[pStable->numOfDbTags] = TSDB_DATA_TYPE_BINARY;
+    pStable->numOfDbTags++;
+  }
+
+  return true;
+}
+
+/*
+ * convert the value in request into the type of column, returns false if it can not be converted,
+ * and null is written instead
+ */
+static bool influxSetValue(InfluxPair *pPair, int8_t colType, int32_t bytes, char *dst, int *length) {
+  if (colType == TSDB_DATA_TYPE_BINARY || colType == TSDB_DATA_TYPE_NCHAR) {
+    int32_t len = MIN(pPair->len, bytes);
+    memcpy(dst, pPair->value, (size_t)len);
+    *length = len;
+    return true;
+  }
+
+  if (pPair->type == TSDB_DATA_TYPE_BINARY) {
+    return false;
+  }
+
+  bool    isDouble = (pPair->type == TSDB_DATA_TYPE_DOUBLE);
+  double  d = isDouble ? pPair->v.d : (double)pPair->v.i;
+  int64_t i = pPair->v.i;
+
+  if (isDouble) {
+    if (!(d > (double)INT64_MIN && d < (double)INT64_MAX)) {
+      if (colType != TSDB_DATA_TYPE_FLOAT && colType != TSDB_DATA_TYPE_DOUBLE) return false;
+    } else {
+      i = (int64_t)d;
+    }
+  }
+
+  switch (colType) {
+    case TSDB_DATA_TYPE_BOOL:
+      *(int8_t *)dst = (int8_t)(isDouble ? (d != 0) : (i != 0));
+      return true;
+    case TSDB_DATA_TYPE_TINYINT:
+      if (i <= INT8_MIN || i > INT8_MAX) return false;
+      *(int8_t *)dst = (int8_t)i;
+      return true;
+    case TSDB_DATA_TYPE_SMALLINT:
+      if (i <= INT16_MIN || i > INT16_MAX) return false;
+      *(int16_t *)dst = (int16_t)i;
+      return true;
+    case TSDB_DATA_TYPE_INT:
+      if (i <= INT32_MIN || i > INT32_MAX) return false;
+      *(int32_t *)dst = (int32_t)i;
+      return true;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      if (i == INT64_MIN) return false;
+      *(int64_t *)dst = i;
+      return true;
+    case TSDB_DATA_TYPE_FLOAT:
+      *(float *)dst = (float)d;
+      return true;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *(double *)dst = d;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static int32_t influxPrintTagValue(char *dst, InfluxPair *pPair, int8_t type) {
+  if (pPair == NULL) {
+    return sprintf(dst, "NULL");
+  }
+
+  if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    // the quote in value is escaped by doubling it
+    int32_t len = 0;
+    dst[len++] = '\'';
+    for (int32_t i = 0; i < pPair->len; ++i) {
+      if (pPair->value[i] == '\'') dst[len++] = '\'';
+      dst[len++] = pPair->value[i];
+    }
+    dst[len++] = '\'';
+    dst[len] = 0;
+    return len;
+  }
+
+  if (type == TSDB_DATA_TYPE_BOOL) {
+    char c = pPair->value[0];
+    if (c == 't' || c == 'T') return sprintf(dst, "true");
+    if (c == 'f' || c == 'F') return sprintf(dst, "false");
+  }
+
+  if (influxIsNumeric(pPair->value)) {
+    return sprintf(dst, "%s", pPair->value);
+  }
+
+  return sprintf(dst, "NULL");
+}
+
+static int64_t influxConvertTime(int64_t ts, int64_t unit, int32_t precision) {
+  int64_t target = (precision == TSDB_TIME_PRECISION_MICRO) ? 1000L : 1000000L;
+  return (unit >= target) ? ts * (unit / target) : ts / (target / unit);
+}
+
+static bool influxBuildTable(HttpBulk *pBulk, InfluxRequest *pReq, InfluxSeries *pSeries, int32_t precision,
+                             int64_t now) {
+  InfluxStable *pStable = &pReq->stables[pSeries->stable];
+  InfluxLine *  pFirst = &pReq->lines[pSeries->first];
+
+  HttpBulkTable *pTable = httpAddBulkTable(pBulk, pSeries->table);
+  if (pTable == NULL) return false;
+
+  // the fields appear in the points of series are bound
+  int8_t  types[TSDB_MAX_COLUMNS];
+  int32_t bytes[TSDB_MAX_COLUMNS];
+  int16_t columns[TSDB_MAX_COLUMNS];
+  int32_t numOfParams = 1;
+
+  types[0] = TSDB_DATA_TYPE_TIMESTAMP;
+  bytes[0] = TSDB_KEYSIZE;
+  columns[0] = -1;
+
+  for (int32_t i = 0; i < pStable->numOfFields; ++i) {
+    pStable->fields[i].param = -1;
+  }
+
+  size_t sqlLen = 0;
+  for (int32_t line = pSeries->first; line >= 0; line = pReq->lines[line].next) {
+    InfluxLine *pLine = &pReq->lines[line];
+    for (int32_t i = 0; i < pLine->numOfFields; ++i) {
+      InfluxColumn *pColumn = &pStable->fields[pReq->pairs[pLine->pairs + pLine->numOfTags + i].column];
+      if (pColumn->param >= 0) continue;
+
+      pColumn->param = (int16_t)numOfParams;
+      columns[numOfParams] = (int16_t)(pColumn - pStable->fields);
+      types[numOfParams] = pColumn->colType;
+      if (pColumn->colType == TSDB_DATA_TYPE_BINARY || pColumn->colType == TSDB_DATA_TYPE_NCHAR) {
+        bytes[numOfParams] = MAX(pColumn->len, 1);
+      } else {
+        bytes[numOfParams] = tDataTypeDesc[pColumn->colType].nSize;
+      }
+      numOfParams++;
+    }
+  }
+
+  if (!httpMallocBulkColumns(pTable, numOfParams, pSeries->numOfRows, bytes, types)) {
+    return false;
+  }
+
+  for (int32_t p = 1; p < numOfParams; ++p) {
+    memset(pTable->binds[p].is_null, 1, (size_t)pSeries->numOfRows);
+  }
+
+  // insert into db.table using db.stable tags(...) (ts,...) values(?,...)
+  for (int32_t i = 0; i < pFirst->numOfTags; ++i) {
+    sqlLen += (size_t)pReq->pairs[pFirst->pairs + i].len * 2 + 4;
+  }
+  sqlLen += 128 + TSDB_DB_NAME_LEN * 2 + TSDB_METER_NAME_LEN * 2 + TSDB_MAX_TAGS * 8 +
+            (size_t)numOfParams * (TSDB_COL_NAME_LEN + 4);
+
+  pTable->sql = malloc(sqlLen);
+  if (pTable->sql == NULL) return false;
+
+  char *  sql = pTable->sql;
+  int32_t len = sprintf(sql, "insert into %s.%s using %s.%s tags(", pBulk->db, pSeries->table, pBulk->db,
+                        pStable->name);
+  for (int32_t t = 0; t < pStable->numOfDbTags; ++t) {
+    InfluxPair *pTag = NULL;
+    for (int32_t i = 0; i < pFirst->numOfTags && pStable->dbTags[t] >= 0; ++i) {
+      if (pReq->pairs[pFirst->pairs + i].column == pStable->dbTags[t]) {
+        pTag = &pReq->pairs[pFirst->pairs + i];
+        break;
+      }
+    }
+
+    if (t > 0) sql[len++] = ',';
+    len += influxPrintTagValue(sql + len, pTag, pStable->dbTagTypes[t]);
+  }
+
+  len += sprintf(sql + len, ") (ts");
+  for (int32_t p = 1; p < numOfParams; ++p) {
+    len += sprintf(sql + len, ",%s", pStable->fields[columns[p]].name);
+  }
+
+  len += sprintf(sql + len, ") values(?");
+  for (int32_t p = 1; p < numOfParams; ++p) {
+    len += sprintf(sql + len, ",?");
+  }
+  sprintf(sql + len, ")");
+
+  // values of points
+  int32_t row = 0;
+  for (int32_t line = pSeries->first; line >= 0; line = pReq->lines[line].next, ++row) {
+    InfluxLine *pLine = &pReq->lines[line];
+
+    int64_t ts = pLine->hasTime ? influxConvertTime(pLine->timestamp, pReq->unit, precision) : now;
+    *(int64_t *)((char *)pTable->binds[0].buffer + row * TSDB_KEYSIZE) = ts;
+
+    for (int32_t i = 0; i < pLine->numOfFields; ++i) {
+      InfluxPair *  pPair = &pReq->pairs[pLine->pairs + pLine->numOfTags + i];
+      InfluxColumn *pColumn = &pStable->fields[pPair->column];
+      TAOS_BIND *   pBind = &pTable->binds[pColumn->param];
+
+      char *dst = (char *)pBind->buffer + row * pBind->buffer_length;
+      int32_t maxLen = pBind->buffer_length;
+      if (pColumn->colType == TSDB_DATA_TYPE_BINARY) {
+        maxLen = MIN(maxLen, pColumn->colBytes);
+      }
+
+      if (influxSetValue(pPair, pColumn->colType, maxLen, dst, &pBind->length[row])) {
+        pBind->is_null[row] = 0;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool influxBuildTables(HttpContext *pContext, HttpBulk *pBulk) {
+  InfluxRequest *pReq = (InfluxRequest *)pBulk->param;
+  int32_t        precision = TSDB_TIME_PRECISION_MILLI;
+
+  for (int32_t i = 0; i < pReq->numOfStables; ++i) {
+    if (!influxCheckStable(pContext, pBulk, &pReq->stables[i], &precision)) {
+      return false;
+    }
+  }
+
+  // the points without timestamp are written at the time request received
+  int64_t now = taosGetTimestamp(precision);
+
+  for (int32_t i = 0; i < pReq->numOfSeries; ++i) {
+    if (!influxBuildTable(pBulk, pReq, &pReq->series[i], precision, now)) {
+      pBulk->httpCode = HTTP_NO_ENOUGH_MEMORY;
+      return false;
+    }
+  }
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, influxdb lines:%d, stables:%d, tables:%d", pContext, pContext->fd,
+            pContext->ipstr, pContext->user, pReq->numOfLines, pReq->numOfStables, pReq->numOfSeries);
+  return true;
+}
+
+/*
+ * the url is /influxdb/<db>?<params> or /influxdb/write?<params>, and the database is given by db=
+ */
+static bool influxParseUrl(HttpContext *pContext, HttpBulk *pBulk, InfluxRequest *pReq) {
+  HttpParser *pParser = &pContext->parser;
+  char *      path = pParser->path[INFLUX_DB_URL_POS].pos;
+  char *      db = NULL;
+
+  pReq->unit = 1;
+  if (pParser->path[INFLUX_DB_URL_POS].len <= 0) {
+    httpSendErrorResp(pContext, HTTP_INFLUX_DB_NOT_INPUT);
+    return false;
+  }
+
+  char *params = strchr(path, '?');
+  if (params != NULL) {
+    *params++ = 0;
+  }
+
+  if (strcmp(path, "write") != 0) {
+    db = path;
+  }
+
+  while (params != NULL && *params != 0) {
+    char *next = strchr(params, '&');
+    if (next != NULL) *next++ = 0;
+
+    if (strncmp(params, "db=", 3) == 0) {
+      db = params + 3;
+    } else if (strncmp(params, "precision=", 10) == 0) {
+      char *precision = params + 10;
+      if (strcmp(precision, "ns") == 0 || strcmp(precision, "n") == 0) {
+        pReq->unit = 1L;
+      } else if (strcmp(precision, "u") == 0 || strcmp(precision, "us") == 0) {
+        pReq->unit = 1000L;
+      } else if (strcmp(precision, "ms") == 0) {
+        pReq->unit = 1000000L;
+      } else if (strcmp(precision, "s") == 0) {
+        pReq->unit = 1000000000L;
+      } else {
+        httpSendErrorResp(pContext, HTTP_INFLUX_INVALID_PRECISION);
+        return false;
+      }
+    }
+
+    params = next;
+  }
+
+  if (db == NULL || db[0] == 0) {
+    httpSendErrorResp(pContext, HTTP_INFLUX_DB_NOT_INPUT);
+    return false;
+  }
+
+  if (strlen(db) >= TSDB_DB_NAME_LEN) {
+    httpSendErrorResp(pContext, HTTP_INFLUX_DB_TOO_LONG);
+    return false;
+  }
+
+  strcpy(pBulk->db, db);
+  return true;
+}
+
+bool influxProcessRequest(struct HttpContext *pContext) {
+  if (strlen(pContext->user) == 0 || strlen(pContext->pass) == 0) {
+    httpSendErrorResp(pContext, HTTP_PARSE_USR_ERROR);
+    return false;
+  }
+
+  HttpParser *pParser = &pContext->parser;
+  if (pParser->data.pos == NULL || pParser->data.len <= 0) {
+    httpSendErrorResp(pContext, HTTP_INFLUX_LINES_NULL);
+    return false;
+  }
+
+  HttpBulk *     pBulk = httpMallocBulk(pContext);
+  InfluxRequest *pReq = calloc(1, sizeof(InfluxRequest));
+  if (pBulk == NULL || pReq == NULL) {
+    free(pReq);
+    httpFreeBulk(pContext);
+    httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
+    return false;
+  }
+
+  pBulk->param = pReq;
+  pBulk->buildFp = influxBuildTables;
+  pBulk->freeFp = influxFreeRequest;
+
+  if (!influxParseUrl(pContext, pBulk, pReq)) {
+    httpFreeBulk(pContext);
+    return false;
+  }
+
+  char    msg[HTTP_BULK_DESC_SIZE] = {0};
+  int32_t code = influxParseLines(pReq, pParser->data.pos, pParser->data.len, msg);
+  if (code == HTTP_SUCCESS && pReq->numOfLines == 0) {
+    code = HTTP_INFLUX_LINES_NULL;
+  }
+
+  if (code != HTTP_SUCCESS) {
+    httpFreeBulk(pContext);
+    httpSendErrorRespWithDesc(pContext, code, (msg[0] != 0) ? msg : NULL);
+    return false;
+  }
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, db:%s, influxdb lines:%d parsed", pContext, pContext->fd,
+            pContext->ipstr, pContext->user, pBulk->db, pReq->numOfLines);
+
+  pContext->reqType = HTTP_REQTYPE_BULK_INSERT;
+  return true;
+}
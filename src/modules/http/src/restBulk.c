@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "httpBulk.h"
+#include "httpCode.h"
+#include "httpResp.h"
+#include "restBulk.h"
+#include "taosmsg.h"
+#include "ttypes.h"
+
+/*
+ * The columns of fixed size types in body are bound to the prepared statements without copy, only the
+ * binary and nchar columns are copied into the fixed width arrays required by the binds. The body is kept
+ * in the buffer of context until the response is sent.
+ */
+
+typedef struct {
+  char *  pos;
+  char *  end;
+  int32_t numOfTables;
+} RestBulkRequest;
+
+typedef struct {
+  char    name[TSDB_COL_NAME_LEN];
+  int8_t  type;
+  char *  isNull;
+  char *  values;
+  char *  lengths;  // uint16 array of binary and nchar, unaligned
+  int32_t maxLen;
+} RestBulkColumn;
+
+static bool restBulkRead(RestBulkRequest *pReq, void *dst, int32_t len) {
+  if (pReq->end - pReq->pos < len) return false;
+
+  memcpy(dst, pReq->pos, (size_t)len);
+  pReq->pos += len;
+  return true;
+}
+
+static char *restBulkSkip(RestBulkRequest *pReq, int64_t len) {
+  if (len < 0 || pReq->end - pReq->pos < len) return NULL;
+
+  char *pos = pReq->pos;
+  pReq->pos += len;
+  return pos;
+}
+
+/*
+ * names are put into sql, so only the identifiers are accepted
+ */
+static int32_t restBulkReadName(RestBulkRequest *pReq, char *name, int32_t maxLen) {
+  uint8_t len = 0;
+  if (!restBulkRead(pReq, &len, sizeof(len))) return HTTP_BULK_INVALID_BODY;
+  if (len >= maxLen) return HTTP_BULK_INVALID_NAME;
+  if (!restBulkRead(pReq, name, len)) return HTTP_BULK_INVALID_BODY;
+  name[len] = 0;
+
+  for (int32_t i = 0; i < len; ++i) {
+    char c = name[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+      return HTTP_BULK_INVALID_NAME;
+    }
+  }
+
+  return HTTP_SUCCESS;
+}
+
+static int32_t restBulkPrintTag(RestBulkRequest *pReq, char *dst) {
+  uint8_t  type = 0;
+  uint16_t len = 0;
+  if (!restBulkRead(pReq, &type, sizeof(type)) || !restBulkRead(pReq, &len, sizeof(len))) return -1;
+
+  char *value = restBulkSkip(pReq, len);
+  if (value == NULL) return -1;
+
+  int64_t i = 0;
+  double  d = 0;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_NULL:
+      return sprintf(dst, "NULL");
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      if (len != 1) return -1;
+      i = *(int8_t *)value;
+      return (type == TSDB_DATA_TYPE_BOOL) ? sprintf(dst, "%s", i ? "true" : "false") : sprintf(dst, "%" PRId64, i);
+    case TSDB_DATA_TYPE_SMALLINT:
+      if (len != sizeof(int16_t)) return -1;
+      i = *(int16_t *)value;
+      return sprintf(dst, "%" PRId64, i);
+    case TSDB_DATA_TYPE_INT:
+      if (len != sizeof(int32_t)) return -1;
+      i = *(int32_t *)value;
+      return sprintf(dst, "%" PRId64, i);
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      if (len != sizeof(int64_t)) return -1;
+      memcpy(&i, value, sizeof(i));
+      return sprintf(dst, "%" PRId64, i);
+    case TSDB_DATA_TYPE_FLOAT: {
+      float f = 0;
+      if (len != sizeof(float)) return -1;
+      memcpy(&f, value, sizeof(f));
+      return sprintf(dst, "%.9g", f);
+    }
+    case TSDB_DATA_TYPE_DOUBLE:
+      if (len != sizeof(double)) return -1;
+      memcpy(&d, value, sizeof(d));
+      return sprintf(dst, "%.17g", d);
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR: {
+      // the quote in value is escaped by doubling it, and the zero that ends the sql is replaced
+      int32_t size = 0;
+      dst[size++] = '\'';
+      for (int32_t k = 0; k < len; ++k) {
+        if (value[k] == '\'') dst[size++] = '\'';
+        dst[size++] = (value[k] == 0) ? '_' : value[k];
+      }
+      dst[size++] = '\'';
+      dst[size] = 0;
+      return size;
+    }
+    default:
+      return -1;
+  }
+}
+
+/*
+ * the tags are scanned before they are printed, the total length of values is at most TSDB_MAX_TAGS_LEN
+ */
+static int32_t restBulkGetTagsLen(RestBulkRequest *pReq, int32_t numOfTags) {
+  RestBulkRequest req = *pReq;
+  int32_t         tagsLen = 0;
+
+  for (int32_t i = 0; i < numOfTags; ++i) {
+    uint8_t  type = 0;
+    uint16_t len = 0;
+    if (!restBulkRead(&req, &type, sizeof(type)) || !restBulkRead(&req, &len, sizeof(len))) return -1;
+    if (restBulkSkip(&req, len) == NULL) return -1;
+
+    tagsLen += len;
+    if (tagsLen > TSDB_MAX_TAGS_LEN) return -1;
+  }
+
+  return tagsLen;
+}
+
+static int32_t restBulkReadColumn(RestBulkRequest *pReq, RestBulkColumn *pColumn, int32_t numOfRows) {
+  int32_t code = restBulkReadName(pReq, pColumn->name, TSDB_COL_NAME_LEN);
+  if (code != HTTP_SUCCESS) return code;
+
+  uint8_t type = 0;
+  uint8_t flags = 0;
+  if (!restBulkRead(pReq, &type, sizeof(type)) || !restBulkRead(pReq, &flags, sizeof(flags))) {
+    return HTTP_BULK_INVALID_BODY;
+  }
+
+  if (type <= TSDB_DATA_TYPE_NULL || type > TSDB_DATA_TYPE_NCHAR) return HTTP_BULK_INVALID_BODY;
+  pColumn->type = (int8_t)type;
+
+  pColumn->isNull = NULL;
+  if (flags & REST_BULK_HAS_NULL) {
+    pColumn->isNull = restBulkSkip(pReq, numOfRows);
+    if (pColumn->isNull == NULL) return HTTP_BULK_INVALID_BODY;
+  }
+
+  if (type != TSDB_DATA_TYPE_BINARY && type != TSDB_DATA_TYPE_NCHAR) {
+    pColumn->lengths = NULL;
+    pColumn->maxLen = tDataTypeDesc[type].nSize;
+    pColumn->values = restBulkSkip(pReq, (int64_t)numOfRows * pColumn->maxLen);
+    return (pColumn->values == NULL) ? HTTP_BULK_INVALID_BODY : HTTP_SUCCESS;
+  }
+
+  pColumn->lengths = restBulkSkip(pReq, (int64_t)numOfRows * sizeof(uint16_t));
+  if (pColumn->lengths == NULL) return HTTP_BULK_INVALID_BODY;
+
+  int64_t total = 0;
+  pColumn->maxLen = 1;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    uint16_t len = 0;
+    memcpy(&len, pColumn->lengths + i * sizeof(uint16_t), sizeof(len));
+    total += len;
+    if (len > pColumn->maxLen) pColumn->maxLen = len;
+  }
+
+  pColumn->values = restBulkSkip(pReq, total);
+  return (pColumn->values == NULL) ? HTTP_BULK_INVALID_BODY : HTTP_SUCCESS;
+}
+
+/*
+ * bind the columns of table, the binary and nchar values are copied into the buffer of table
+ */
+static bool restBulkBindColumns(HttpBulkTable *pTable, RestBulkColumn *columns, int32_t numOfColumns,
+                                int32_t numOfRows) {
+  size_t size = 0;
+  for (int32_t i = 0; i < numOfColumns; ++i) {
+    if (columns[i].lengths != NULL) {
+      size += (size_t)numOfRows * ((size_t)columns[i].maxLen + sizeof(int));
+    }
+  }
+
+  pTable->binds = calloc((size_t)numOfColumns, sizeof(TAOS_BIND));
+  pTable->buffer = (size > 0) ? malloc(size) : NULL;
+  if (pTable->binds == NULL || (size > 0 && pTable->buffer == NULL)) {
+    return false;
+  }
+
+  char *buffer = pTable->buffer;
+  for (int32_t i = 0; i < numOfColumns; ++i) {
+    RestBulkColumn *pColumn = &columns[i];
+    TAOS_BIND *     pBind = &pTable->binds[i];
+
+    pBind->buffer_type = pColumn->type;
+    pBind->buffer_length = pColumn->maxLen;
+    pBind->is_null = pColumn->isNull;
+
+    if (pColumn->lengths == NULL) {
+      pBind->buffer = pColumn->values;
+      continue;
+    }
+
+    pBind->buffer = buffer;
+    buffer += (size_t)numOfRows * pColumn->maxLen;
+    pBind->length = (int *)buffer;
+    buffer += (size_t)numOfRows * sizeof(int);
+
+    char *src = pColumn->values;
+    for (int32_t r = 0; r < numOfRows; ++r) {
+      uint16_t len = 0;
+      memcpy(&len, pColumn->lengths + r * sizeof(uint16_t), sizeof(len));
+      memcpy((char *)pBind->buffer + (size_t)r * pColumn->maxLen, src, len);
+      pBind->length[r] = len;
+      src += len;
+    }
+  }
+
+  pTable->numOfParams = numOfColumns;
+  pTable->numOfRows = numOfRows;
+  return true;
+}
+
+static int32_t restBulkBuildTable(HttpBulk *pBulk, RestBulkRequest *pReq, RestBulkColumn *columns) {
+  char name[TSDB_METER_NAME_LEN];
+  char stable[TSDB_METER_NAME_LEN];
+
+  int32_t code = restBulkReadName(pReq, name, TSDB_METER_NAME_LEN);
+  if (code == HTTP_SUCCESS) code = restBulkReadName(pReq, stable, TSDB_METER_NAME_LEN);
+  if (code != HTTP_SUCCESS) return code;
+  if (name[0] == 0) return HTTP_BULK_INVALID_NAME;
+
+  uint8_t numOfTags = 0;
+  if (!restBulkRead(pReq, &numOfTags, sizeof(numOfTags)) || numOfTags > TSDB_MAX_TAGS) {
+    return HTTP_BULK_INVALID_BODY;
+  }
+
+  // tags are printed into the sql, a binary or nchar value is at most doubled by its quotes, and others are
+  // printed in 32 bytes
+  char *tags = NULL;
+  if (numOfTags > 0) {
+    int32_t valueLen = restBulkGetTagsLen(pReq, numOfTags);
+    if (valueLen < 0) return HTTP_BULK_INVALID_BODY;
+
+    tags = malloc((size_t)valueLen * 2 + numOfTags * 32 + 1);
+    if (tags == NULL) return HTTP_NO_ENOUGH_MEMORY;
+  }
+
+  int32_t tagsLen = 0;
+  for (int32_t i = 0; i < numOfTags; ++i) {
+    if (i > 0) tags[tagsLen++] = ',';
+    int32_t len = restBulkPrintTag(pReq, tags + tagsLen);
+    if (len < 0) {
+      free(tags);
+      return HTTP_BULK_INVALID_BODY;
+    }
+    tagsLen += len;
+  }
+
+  uint16_t numOfColumns = 0;
+  uint32_t numOfRows = 0;
+  if (!restBulkRead(pReq, &numOfColumns, sizeof(numOfColumns)) || !restBulkRead(pReq, &numOfRows, sizeof(numOfRows)) ||
+      numOfColumns == 0 || numOfColumns > TSDB_MAX_COLUMNS || numOfRows == 0 || numOfRows > INT32_MAX) {
+    free(tags);
+    return HTTP_BULK_INVALID_BODY;
+  }
+
+  for (int32_t i = 0; i < numOfColumns && code == HTTP_SUCCESS; ++i) {
+    code = restBulkReadColumn(pReq, &columns[i], (int32_t)numOfRows);
+    if (code == HTTP_SUCCESS && (columns[i].name[0] == 0) != (columns[0].name[0] == 0)) {
+      code = HTTP_BULK_INVALID_NAME;
+    }
+  }
+
+  HttpBulkTable *pTable = (code == HTTP_SUCCESS) ? httpAddBulkTable(pBulk, name) : NULL;
+  if (code == HTTP_SUCCESS && pTable == NULL) code = HTTP_NO_ENOUGH_MEMORY;
+
+  // insert into db.name [using db.stable tags(...)] [(c1,c2,...)] values(?,?,...)
+  if (code == HTTP_SUCCESS) {
+    size_t size = 128 + TSDB_DB_NAME_LEN * 2 + TSDB_METER_NAME_LEN * 2 + (size_t)tagsLen +
+                  (size_t)numOfColumns * (TSDB_COL_NAME_LEN + 4);
+    pTable->sql = malloc(size);
+    if (pTable->sql == NULL || !restBulkBindColumns(pTable, columns, numOfColumns, (int32_t)numOfRows)) {
+      code = HTTP_NO_ENOUGH_MEMORY;
+    }
+  }
+
+  if (code != HTTP_SUCCESS) {
+    free(tags);
+    return code;
+  }
+
+  char *  sql = pTable->sql;
+  int32_t len = sprintf(sql, "insert into %s.%s", pBulk->db, name);
+  if (stable[0] != 0) {
+    len += sprintf(sql + len, " using %s.%s tags(%s)", pBulk->db, stable, (tags != NULL) ? tags : "");
+  }
+
+  if (columns[0].name[0] != 0) {
+    for (int32_t i = 0; i < numOfColumns; ++i) {
+      len += sprintf(sql + len, "%s%s", (i == 0) ? " (" : ",", columns[i].name);
+    }
+    len += sprintf(sql + len, ")");
+  }
+
+  len += sprintf(sql + len, " values(?");
+  for (int32_t i = 1; i < numOfColumns; ++i) {
+    len += sprintf(sql + len, ",?");
+  }
+  sprintf(sql + len, ")");
+
+  free(tags);
+  return HTTP_SUCCESS;
+}
+
+static bool restBulkBuildTables(HttpContext *pContext, HttpBulk *pBulk) {
+  RestBulkRequest *pReq = (RestBulkRequest *)pBulk->param;
+
+  RestBulkColumn *columns = malloc(TSDB_MAX_COLUMNS * sizeof(RestBulkColumn));
+  if (columns == NULL) {
+    pBulk->httpCode = HTTP_NO_ENOUGH_MEMORY;
+    return false;
+  }
+
+  for (int32_t i = 0; i < pReq->numOfTables; ++i) {
+    int32_t code = restBulkBuildTable(pBulk, pReq, columns);
+    if (code != HTTP_SUCCESS) {
+      pBulk->httpCode = code;
+      snprintf(pBulk->desc, HTTP_BULK_DESC_SIZE, "%s at table %d, offset %d", httpMsg[code], i + 1,
+               (int32_t)(pReq->pos - pContext->parser.data.pos));
+      free(columns);
+      return false;
+    }
+  }
+
+  free(columns);
+
+  if (pReq->pos != pReq->end) {
+    pBulk->httpCode = HTTP_BULK_INVALID_BODY;
+    snprintf(pBulk->desc, HTTP_BULK_DESC_SIZE, "%s, %d bytes left after %d tables", httpMsg[HTTP_BULK_INVALID_BODY],
+             (int32_t)(pReq->end - pReq->pos), pReq->numOfTables);
+    return false;
+  }
+
+  return true;
+}
+
+bool restProcessBulkRequest(struct HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
+  HttpBuf *   pDb = &pParser->path[REST_BULK_DB_URL_POS];
+
+  if (pDb->len <= 0) {
+    httpSendErrorResp(pContext, HTTP_BULK_DB_NOT_INPUT);
+    return false;
+  }
+
+  if (pDb->len >= TSDB_DB_NAME_LEN) {
+    httpSendErrorResp(pContext, HTTP_BULK_DB_TOO_LONG);
+    return false;
+  }
+
+  if (pParser->data.pos == NULL || pParser->data.len <= 0) {
+    httpSendErrorResp(pContext, HTTP_BULK_BODY_NULL);
+    return false;
+  }
+
+  RestBulkRequest req = {.pos = pParser->data.pos, .end = pParser->data.pos + pParser->data.len};
+  char            magic[4] = {0};
+  uint8_t         version = 0;
+  uint8_t         reserved = 0;
+  uint16_t        numOfTables = 0;
+
+  if (!restBulkRead(&req, magic, sizeof(magic)) || !restBulkRead(&req, &version, sizeof(version)) ||
+      !restBulkRead(&req, &reserved, sizeof(reserved)) || !restBulkRead(&req, &numOfTables, sizeof(numOfTables)) ||
+      memcmp(magic, REST_BULK_MAGIC, sizeof(magic)) != 0 || version != REST_BULK_VERSION) {
+    httpSendErrorResp(pContext, HTTP_BULK_INVALID_VERSION);
+    return false;
+  }
+
+  if (numOfTables == 0) {
+    httpSendErrorResp(pContext, HTTP_BULK_BODY_NULL);
+    return false;
+  }
+
+  HttpBulk *       pBulk = httpMallocBulk(pContext);
+  RestBulkRequest *pReq = malloc(sizeof(RestBulkRequest));
+  if (pBulk == NULL || pReq == NULL) {
+    free(pReq);
+    httpFreeBulk(pContext);
+    httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
+    return false;
+  }
+
+  *pReq = req;
+  pReq->numOfTables = numOfTables;
+
+  strcpy(pBulk->db, pDb->pos);
+  pBulk->param = pReq;
+  pBulk->buildFp = restBulkBuildTables;
+  pBulk->freeFp = free;
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, process restful bulk msg, db:%s, tables:%d, size:%d", pContext,
+            pContext->fd, pContext->ipstr, pContext->user, pBulk->db, numOfTables, pParser->data.len);
+
+  pContext->reqType = HTTP_REQTYPE_BULK_INSERT;
+  return true;
+}
@@ -13,11 +13,13 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "restBulk.h"
 #include "restHandle.h"
 #include "restJson.h"
 
-static HttpDecodeMethod restDecodeMethod = {"rest", restProcessRequest};
-static HttpDecodeMethod restDecodeMethod2 = {"restful", restProcessRequest};
+static bool restIsBulkRequest(struct HttpContext* pContext);
+static HttpDecodeMethod restDecodeMethod = {"rest", restProcessRequest, restIsBulkRequest};
+static HttpDecodeMethod restDecodeMethod2 = {"restful", restProcessRequest, restIsBulkRequest};
 static HttpEncodeMethod restEncodeSqlTimestampMethod = {
     restStartSqlJson, restStopSqlJson, restBuildSqlTimestampJson, restBuildSqlAffectRowsJson, NULL, NULL, NULL, NULL};
 static HttpEncodeMethod restEncodeSqlLocalTimeStringMethod = {
@@ -87,6 +89,11 @@ bool restProcessSqlRequest(HttpContext* pContext, int timestampFmt) {
   return true;
 }
 
+// the body of /rest/bulk is read and decompressed into a buffer growing beyond HTTP_BUFFER_SIZE
+static bool restIsBulkRequest(struct HttpContext* pContext) {
+  return httpUrlMatch(pContext, REST_ACTION_URL_POS, "bulk");
+}
+
 bool restProcessRequest(struct HttpContext* pContext) {
   if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "login")) {
     restGetUserFromUrl(pContext);
@@ -104,6 +111,8 @@ bool restProcessRequest(struct HttpContext* pContext) {
     return restProcessSqlRequest(pContext, REST_TIMESTAMP_FMT_TIMESTAMP);
   } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "sqlutc")) {
     return restProcessSqlRequest(pContext, REST_TIMESTAMP_FMT_UTC_STRING);
+  } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "bulk")) {
+    return restProcessBulkRequest(pContext);
   } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "login")) {
     return restProcessLoginRequest(pContext);
   } else {
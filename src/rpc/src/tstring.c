@@ -103,15 +103,14 @@ char *taosMsg[] = {"null",
                    "alter-stream-rsp",
                    "alter-table",
                    "alter-table-rsp",
-
-                   "",
-                   "",
-                   "",
-                   "",
-                   "",
-                   "",
-                   "",
-                   "",
+                   "alter-db",
+                   "alter-db-rsp",
+                   "multi-meter-info",  // 85
+                   "multi-meter-info-rsp",
+                   "multi-create-table",  // 87
+                   "multi-create-table-rsp",
+                   "multi-create",
+                   "multi-create-rsp",
 
                    "heart-beat",           // 91
                    "heart-beat-rsp",
@@ -121,6 +120,8 @@ char *taosMsg[] = {"null",
                    "grant-rsp",
                    "alter-acct",
                    "alter-acct-rsp",
+                   "subscribe",  // 99
+                   "subscribe-rsp",
                    "invalid"};
 
 char *tsError[] = {"success",
@@ -168,14 +168,56 @@ void sdbAddIntoUpdateList(SSdbTable *pTable, char type, char *row) {
   pTable->update[pTable->updatePos].row = row;
 }
 
-int sdbInitTableByFile(SSdbTable *pTable) {
+static void sdbRestoreRow(SSdbTable *pTable, SRowHead *rowHead, int64_t offset, int *numOfDels) {
   SRowMeta rowMeta;
-  int      numOfDels = 0;
-  int      bytes = 0;
-  int64_t  oldId = 0;
-  void *   pMetaRow = NULL;
-  int      total_size = 0;
-  int      real_size = 0;
+
+  // Check if the the object exists already
+  void *pMetaRow = sdbGetRow(pTable, rowHead->data);
+  if (pMetaRow == NULL) {  // New object
+    if (rowHead->id < 0) {
+      /* assert(0); */
+      sdbError("error sdb negative id: %d, sdb: %s, skip", rowHead->id, pTable->name);
+    } else {
+      rowMeta.id = rowHead->id;
+      // TODO: Get rid of the rowMeta.offset and rowSize
+      rowMeta.offset = offset;
+      rowMeta.rowSize = rowHead->rowSize;
+      rowMeta.row = (*(pTable->appTool))(SDB_TYPE_DECODE, NULL, rowHead->data, rowHead->rowSize, NULL);
+      (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, rowMeta.row, &rowMeta);
+      if (pTable->keyType == SDB_KEYTYPE_AUTO) pTable->autoIndex++;
+      pTable->numOfRows++;
+    }
+  } else {                  // already exists
+    if (rowHead->id < 0) {  // Delete the object
+      (*sdbDeleteIndexFp[pTable->keyType])(pTable->iHandle, rowHead->data);
+      (*(pTable->appTool))(SDB_TYPE_DESTROY, pMetaRow, NULL, 0, NULL);
+      pTable->numOfRows--;
+      (*numOfDels)++;
+    } else {  // Reset the object TODO: is it possible to merge reset and
+              // update ??
+      (*(pTable->appTool))(SDB_TYPE_RESET, pMetaRow, rowHead->data, rowHead->rowSize, NULL);
+    }
+    (*numOfDels)++;
+  }
+
+  if (pTable->id < abs(rowHead->id)) pTable->id = abs(rowHead->id);
+}
+
+/*
+ * rows are restored only after the end commit symbol following them is read, so the rows written by one commit,
+ * e.g. sdbBatchInsertRows, are restored entirely or dropped entirely
+ */
+int sdbInitTableByFile(SSdbTable *pTable) {
+  int       numOfDels = 0;
+  int       bytes = 0;
+  int64_t   oldId = 0;
+  int       total_size = 0;
+  int       real_size = 0;
+  int       numOfPending = 0;
+  int       maxPending = 0;
+  int64_t   pendingOffset = 0;
+  SRowHead **pPending = NULL;
+  int64_t * pPendingPos = NULL;
 
   oldId = pTable->id;
   if (sdbOpenSdbFile(pTable) < 0) return -1;
@@ -199,6 +241,18 @@ int sdbInitTableByFile(SSdbTable *pTable) {
 
     if (bytes == 0) break;
 
+    if (bytes >= sizeof(uint32_t) && (uint32_t)rowHead->delimiter == SDB_ENDCOMMIT) {
+      for (int i = 0; i < numOfPending; ++i) {
+        sdbRestoreRow(pTable, pPending[i], pPendingPos[i], &numOfDels);
+        tfree(pPending[i]);
+      }
+
+      numOfPending = 0;
+      pTable->size += sizeof(uint32_t);
+      lseek(pTable->fd, -(bytes - (int)sizeof(uint32_t)), SEEK_CUR);
+      continue;
+    }
+
     if (bytes < sizeof(SRowHead) || rowHead->delimiter != SDB_DELIMITER) {
       pTable->size++;
       lseek(pTable->fd, -(bytes - 1), SEEK_CUR);
@@ -229,38 +283,41 @@ int sdbInitTableByFile(SSdbTable *pTable) {
       continue;
     }
 
-    // Check if the the object exists already
-
-    pMetaRow = sdbGetRow(pTable, rowHead->data);
-    if (pMetaRow == NULL) {  // New object
-      if (rowHead->id < 0) {
-        /* assert(0); */
-        sdbError("error sdb negative id: %d, sdb: %s, skip", rowHead->id, pTable->name);
-      } else {
-        rowMeta.id = rowHead->id;
-        // TODO: Get rid of the rowMeta.offset and rowSize
-        rowMeta.offset = pTable->size;
-        rowMeta.rowSize = rowHead->rowSize;
-        rowMeta.row = (*(pTable->appTool))(SDB_TYPE_DECODE, NULL, rowHead->data, rowHead->rowSize, NULL);
-        (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, rowMeta.row, &rowMeta);
-        if (pTable->keyType == SDB_KEYTYPE_AUTO) pTable->autoIndex++;
-        pTable->numOfRows++;
-      }
-    } else {                  // already exists
-      if (rowHead->id < 0) {  // Delete the object
-        (*sdbDeleteIndexFp[pTable->keyType])(pTable->iHandle, rowHead->data);
-        (*(pTable->appTool))(SDB_TYPE_DESTROY, pMetaRow, NULL, 0, NULL);
-        pTable->numOfRows--;
-        numOfDels++;
-      } else {  // Reset the object TODO: is it possible to merge reset and
-                // update ??
-        (*(pTable->appTool))(SDB_TYPE_RESET, pMetaRow, rowHead->data, rowHead->rowSize, NULL);
+    // the row is kept until the end commit symbol is read
+    if (numOfPending >= maxPending) {
+      maxPending = (maxPending == 0) ? 16 : maxPending * 2;
+      SRowHead **tmp = (SRowHead **)realloc(pPending, sizeof(SRowHead *) * maxPending);
+      if (tmp != NULL) pPending = tmp;
+
+      int64_t *tmpPos = (int64_t *)realloc(pPendingPos, sizeof(int64_t) * maxPending);
+      if (tmpPos != NULL) pPendingPos = tmpPos;
+
+      if (tmp == NULL || tmpPos == NULL) {
+        sdbError("failed to allocate pending rows memory, sdb: %s", pTable->name);
+        goto sdb_exit1;
       }
-      numOfDels++;
     }
 
+    if ((pPending[numOfPending] = (SRowHead *)malloc(real_size)) == NULL) {
+      sdbError("failed to allocate pending rows memory, sdb: %s", pTable->name);
+      goto sdb_exit1;
+    }
+
+    if (numOfPending == 0) pendingOffset = pTable->size;
+    memcpy(pPending[numOfPending], rowHead, real_size);
+    pPendingPos[numOfPending++] = pTable->size;
+
     pTable->size += real_size;
-    if (pTable->id < abs(rowHead->id)) pTable->id = abs(rowHead->id);
+  }
+
+  // rows not sealed by end commit symbol are dropped, and the file is truncated before them
+  if (numOfPending > 0) {
+    sdbWarn("table:%s, %d rows not committed are dropped, fileSize:%ld", pTable->name, numOfPending, pendingOffset);
+    for (int i = 0; i < numOfPending; ++i) tfree(pPending[i]);
+
+    pTable->size = pendingOffset;
+    ftruncate(pTable->fd, pTable->size);
+    lseek(pTable->fd, 0, SEEK_END);
   }
 
   sdbVersion += (pTable->id - oldId);
@@ -269,10 +326,15 @@ int sdbInitTableByFile(SSdbTable *pTable) {
   pTable->numOfUpdates = 0;
   pTable->updatePos = 0;
 
+  tfree(pPending);
+  tfree(pPendingPos);
   tfree(rowHead);
   return 0;
 
 sdb_exit1:
+  for (int i = 0; i < numOfPending; ++i) tfree(pPending[i]);
+  tfree(pPending);
+  tfree(pPendingPos);
   tfree(rowHead);
   return -1;
 }
@@ -436,6 +498,112 @@ int64_t sdbInsertRow(void *handle, void *row, int rowSize) {
   return id;
 }
 
+/*
+ * insert a batch of created objects, all rows are appended to the file by one write and sealed by one end
+ * commit symbol, so that the batch is recovered entirely or dropped entirely by sdbInitTableByFile. The keys of
+ * rows shall be unique in the batch, and rows already existing in table make the whole batch rejected.
+ */
+int sdbBatchInsertRows(void *handle, void **rows, int numOfRows) {
+  SSdbTable *pTable = (SSdbTable *)handle;
+  SRowMeta   rowMeta;
+  int        total_size = 0;
+  int        real_size = 0;
+  int64_t    buf_size = 0;
+  int64_t    offset = 0;
+
+  if (pTable == NULL || rows == NULL || numOfRows <= 0) return -1;
+
+  if (pTable->keyType != SDB_KEYTYPE_AUTO) {
+    for (int i = 0; i < numOfRows; ++i) {
+      if (sdbGetRow(handle, rows[i])) return -1;
+    }
+  }
+
+  total_size = sizeof(SRowHead) + pTable->maxRowSize + sizeof(TSCKSUM);
+  SRowHead *rowHead = (SRowHead *)malloc(total_size);
+
+  buf_size = (int64_t)numOfRows * (sizeof(SRowHead) + sizeof(TSCKSUM) + 256);
+  char *buffer = (char *)malloc(buf_size);
+  if (rowHead == NULL || buffer == NULL) {
+    sdbError("failed to allocate batch insert memory, sdb: %s rows:%d", pTable->name, numOfRows);
+    tfree(rowHead);
+    tfree(buffer);
+    return -1;
+  }
+
+  pthread_mutex_lock(&pTable->mutex);
+
+  for (int i = 0; i < numOfRows; ++i) {
+    void *pObj = rows[i];
+    memset(rowHead, 0, total_size);
+
+    pTable->id++;
+    sdbVersion++;
+    if (pTable->keyType == SDB_KEYTYPE_AUTO) *((uint32_t *)pObj) = ++pTable->autoIndex;
+
+    (*(pTable->appTool))(SDB_TYPE_ENCODE, pObj, rowHead->data, pTable->maxRowSize, &(rowHead->rowSize));
+    assert(rowHead->rowSize > 0 && rowHead->rowSize <= pTable->maxRowSize);
+
+    real_size = sizeof(SRowHead) + rowHead->rowSize + sizeof(TSCKSUM);
+    rowHead->delimiter = SDB_DELIMITER;
+    rowHead->id = pTable->id;
+    taosCalcChecksumAppend(0, (uint8_t *)rowHead, real_size);
+
+    if (offset + real_size > buf_size) {
+      buf_size = (offset + real_size) * 2;
+      char *tmp = (char *)realloc(buffer, buf_size);
+      if (tmp == NULL) {
+        // nothing is written yet, the index is not updated either, only the id is consumed
+        sdbError("failed to allocate batch insert memory, sdb: %s rows:%d", pTable->name, numOfRows);
+        pthread_mutex_unlock(&pTable->mutex);
+        tfree(rowHead);
+        tfree(buffer);
+        return -1;
+      }
+      buffer = tmp;
+    }
+
+    memcpy(buffer + offset, rowHead, real_size);
+    offset += real_size;
+  }
+
+  // update in SDB layer after all rows are encoded successfully
+  int64_t size = pTable->size;
+  int64_t id = pTable->id - numOfRows;
+  for (int i = 0, pos = 0; i < numOfRows; ++i) {
+    SRowHead *pHead = (SRowHead *)(buffer + pos);
+
+    rowMeta.id = ++id;
+    rowMeta.offset = size + pos;
+    rowMeta.rowSize = pHead->rowSize;
+    rowMeta.row = rows[i];
+    (*sdbAddIndexFp[pTable->keyType])(pTable->iHandle, rows[i], &rowMeta);
+    sdbAddIntoUpdateList(pTable, SDB_TYPE_INSERT, rows[i]);
+
+    pos += sizeof(SRowHead) + pHead->rowSize + sizeof(TSCKSUM);
+  }
+
+  twrite(pTable->fd, buffer, offset);
+  pTable->size += offset;
+  sdbFinishCommit(pTable);
+
+  pTable->numOfRows += numOfRows;
+  sdbTrace("table:%s, %d records are inserted in batch, sdbVersion:%ld id:%ld numOfRows:%d fileSize:%ld", pTable->name,
+           numOfRows, sdbVersion, pTable->id, pTable->numOfRows, pTable->size);
+
+  tfree(rowHead);
+  tfree(buffer);
+
+  pthread_mutex_unlock(&pTable->mutex);
+
+  /* callback function to update the MGMT layer */
+  if (pTable->appTool) {
+    for (int i = 0; i < numOfRows; ++i) (*pTable->appTool)(SDB_TYPE_INSERT, rows[i], NULL, 0, NULL);
+  }
+
+  return numOfRows;
+}
+
 // row here can be object or null-terminated string
 int sdbDeleteRow(void *handle, void *row) {
   SSdbTable *pTable = (SSdbTable *)handle;
@@ -127,6 +127,8 @@ typedef struct _tab_obj {
 
   pthread_rwlock_t rwLock;
   tSkipList *      pSkipList;
+  void *           pTagIndex;    // for metric, inverted index of all tag columns
+  int32_t          tagIndexSlot; // for meter, slot in the tag index of its metric
   struct _tab_obj *pHead;  // for metric, a link list for all meters created
                            // according to this metric
   char *pTagData;          // TSDB_METER_ID_LEN(metric_name)+
@@ -272,6 +274,7 @@ extern SDnodeObj dnodeObj;
 int  mgmtInitDnodeInt();
 void mgmtCleanUpDnodeInt();
 int mgmtSendCreateMsgToVnode(STabObj *pMeter, int vnode);
+int mgmtSendMultiCreateMsgToVnode(STabObj **pMeters, int numOfMeters, int vnode);
 int mgmtSendRemoveMeterMsgToVnode(STabObj *pMeter, int vnode);
 int mgmtSendVPeersMsg(SVgObj *pVgroup, SDbObj *pDb);
 int mgmtSendFreeVnodeMsg(int vnode);
@@ -347,12 +350,14 @@ STabObj *mgmtGetMeter(char *meterId);
 STabObj *mgmtGetMeterInfo(char *src, char *tags[]);
 int mgmtRetrieveMetricMeta(void *thandle, char **pStart, STabObj *pMetric, SMetricMetaMsg *pInfo);
 int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate);
+int mgmtCreateMeters(SDbObj *pDb, SCreateTableMsg **pCreates, int numOfMeters, int *numOfCreated);
 int mgmtDropMeter(SDbObj *pDb, char *meterId, int ignore);
 int mgmtAlterMeter(SDbObj *pDb, SAlterTableMsg *pAlter);
 int mgmtGetMeterMeta(SMeterMeta *pMeta, SShowObj *pShow, SConnObj *pConn);
 int mgmtRetrieveMeters(SShowObj *pShow, char *data, int rows, SConnObj *pConn);
 void     mgmtCleanUpMeters();
 SSchema *mgmtGetMeterSchema(STabObj *pMeter);  // get schema for a meter
+int32_t  mgmtGetTagsLength(STabObj *pMetric, int32_t col);
 
 bool mgmtMeterCreateFromMetric(STabObj *pMeterObj);
 bool mgmtIsMetric(STabObj *pMeterObj);
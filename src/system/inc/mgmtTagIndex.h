@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_MGMTTAGINDEX_H
+#define TDENGINE_MGMTTAGINDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mgmt.h"
+#include "tast.h"
+
+/*
+ * inverted index of the tag columns of a metric. Each meter of the metric occupies one slot,
+ * and for each tag column, every distinct tag value is mapped to the set of slots that holds
+ * the value. The distinct values are kept in a skip list so range predicates are served as well.
+ * The index is created with the metric, and the caller must hold the write lock of the metric when
+ * updating it. If a meter fails to be added, the index is invalidated and the queries fall back to
+ * scan the meters until it is rebuilt.
+ */
+void mgmtCreateTagIndex(STabObj *pMetric);
+
+void mgmtAddMeterIntoTagIndex(STabObj *pMetric, STabObj *pMeter);
+
+void mgmtRemoveMeterFromTagIndex(STabObj *pMetric, STabObj *pMeter);
+
+/*
+ * rebuild the index from the meter list of the metric, called after the tag schema is changed
+ */
+void mgmtRebuildTagIndex(STabObj *pMetric);
+
+void mgmtDestroyTagIndex(STabObj *pMetric);
+
+/*
+ * evaluate the tag query expression as AND/OR operations of slot bitmaps, the result contains
+ * meter pointers. Return TSDB_CODE_OPS_NOT_SUPPORT if no index is available for this metric
+ */
+int32_t mgmtQueryTagIndex(STabObj *pMetric, tSQLBinaryExpr *pExpr, tQueryResultset *pRes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_MGMTTAGINDEX_H
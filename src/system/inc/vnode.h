@@ -116,6 +116,11 @@ typedef struct {
   int   numOfStreams;
   void *streamTimer;
 
+  // the streams computed incrementally in vnode, the results are written without the lock held
+  pthread_mutex_t incStreamMutex;
+  void *          pIncStreams;
+  void *          incStreamTimer;
+
   TSKEY           lastKeyOnFile;  // maximum key on the last file, is shall be xxxx99999
   int             fileId;
   int             badFileId;
@@ -158,6 +163,12 @@ typedef struct {
 
   TAOS *           dbConn;
   SMeterObjHeader *meterIndex;
+
+  // meters linked by metric for the tag filter of metric query, protected by vmutex
+  void *             pMetrics;       // SVnodeMetric array
+  int32_t            numOfMetrics;
+  int32_t            maxMetrics;
+  struct _meter_obj *pUnknownTags;  // meters of which the tag values are not replicated yet
 } SVnodeObj;
 
 typedef struct SColumn {
@@ -194,8 +205,35 @@ typedef struct _meter_obj {
   void *   pStream;
   void *   pCache;
   SColumn *schema;
+
+  // tag values of meter created from metric, replicated from mgmt and saved after SQL in meter obj file
+  uint64_t metricUid;
+  uint32_t tagSig;
+  int16_t  tagLen;  // -1: tag values are not replicated yet, e.g., meter obj restored from earlier version
+  char *   pTags;
+
+  // the meters of the same metric, or with tag values not replicated, are linked in vnode
+  struct _meter_obj *pPrevOfMetric;
+  struct _meter_obj *pNextOfMetric;
+
+  // the last row inserted in the format of submit msg, the sequence number is odd when the row is being updated
+  char *   pLastRow;
+  int32_t  lastRowSeq;
+
+  // the stream of this meter computed incrementally inside vnode, and the streams computed on the data of this meter
+  void *   pIncStream;
+  void *   pSrcStreams;
+
+  // the rows kept for subscribers since the meter is subscribed
+  void *   pSubLog;
 } SMeterObj;
 
+typedef struct {
+  uint64_t   uid;
+  int32_t    numOfMeters;
+  SMeterObj *pHead;
+} SVnodeMetric;
+
 typedef struct {
   char     type;
   char     pversion;  // protocol version
@@ -340,7 +378,7 @@ void *vnodeQueryInTimeRange(SMeterObj **pMeterObj, SSqlGroupbyExpr *pGroupbyExpr
                             SQueryMeterMsg *pQueryMsg, int *code);
 
 void *vnodeQueryOnMultiMeters(SMeterObj **pMeterObj, SSqlGroupbyExpr *pGroupbyExpr, SSqlFunctionExpr *pSqlExprs,
-                              SQueryMeterMsg *pQueryMsg, int *code);
+                              SQueryMeterMsg *pQueryMsg, bool emptyResult, int *code);
 
 // assistant/tool functions
 SSqlGroupbyExpr *vnodeCreateGroupbyExpr(SQueryMeterMsg *pQuery, int32_t *code);
@@ -352,15 +390,19 @@ bool vnodeIsValidVnodeCfg(SVnodeCfg *pCfg);
 
 int32_t vnodeGetResultSize(void *handle, int32_t *numOfRows);
 
+int32_t vnodeGetCompressedResultSize(void *handle, int32_t *numOfRows);
+
 int32_t vnodeCopyQueryResultToMsg(void *handle, char *data, int32_t numOfRows);
 
+int32_t vnodeCompressQueryResultToMsg(void *handle, char *data, int32_t numOfRows, int32_t *size);
+
 int64_t vnodeGetOffsetVal(void *thandle);
 
 bool vnodeHasRemainResults(void *handle);
 
 int vnodeRetrieveQueryResult(void *handle, int *pNum, char *argv[]);
 
-int vnodeSaveQueryResult(void *handle, char *data);
+int vnodeSaveQueryResult(void *handle, char *data, int8_t *compressed, int32_t *size);
 
 int vnodeRetrieveQueryInfo(void *handle, int *numOfRows, int *rowSize, int16_t *timePrec);
 
@@ -372,6 +414,14 @@ bool vnodeIsQInfoValid(void *param);
 
 int32_t vnodeConvertQueryMeterMsg(SQueryMeterMsg *pQuery);
 
+int32_t vnodeFilterMetersByTags(SQueryMeterMsg *pQueryMsg, bool *emptyResult);
+
+void vnodeAddMeterIntoMetric(SMeterObj *pObj);
+
+void vnodeRemoveMeterFromMetric(SMeterObj *pObj);
+
+void vnodeCleanUpMetricMeters(SVnodeObj *pVnode);
+
 void vnodeQueryData(SSchedMsg *pMsg);
 
 // meter API
@@ -381,18 +431,26 @@ void vnodeCloseMetersVnode(int vnode);
 
 int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec);
 
+int vnodeCreateMeterObjs(int vnode, SMeterObj **pNews, int numOfMeters, int32_t *pCode);
+
 int vnodeRemoveMeterObj(int vnode, int sid);
 
 int vnodeInsertPoints(SMeterObj *pObj, char *cont, int contLen, char source, void *, int sversion, int *numOfPoints, TSKEY now);
 
 int vnodeImportPoints(SMeterObj *pObj, char *cont, int contLen, char source, void *, int sversion, int *numOfPoints, TSKEY now);
 
+void vnodeUpdateLastRow(SMeterObj *pObj, char *pData);
+
+bool vnodeGetLastRow(SMeterObj *pObj, char *pRow);
+
 int vnodeInsertBufferedPoints(int vnode);
 
 int vnodeSaveAllMeterObjToFile(int vnode);
 
 int vnodeSaveMeterObjToFile(SMeterObj *pObj);
 
+int vnodeSaveMeterObjsToFile(int vnode, SMeterObj **pObjs, int numOfMeters);
+
 int vnodeSaveVnodeCfg(int vnode, SVnodeCfg *pCfg, SVPeerDesc *pDesc);
 
 int vnodeSaveVnodeInfo(int vnode);
@@ -455,8 +513,12 @@ int vnodeOpenCommitFiles(SVnodeObj *pVnode, int noTempLast);
 
 void vnodeCloseCommitFiles(SVnodeObj *pVnode);
 
+void vnodeGetHeadDataLname(char *headName, char *dataName, char *lastName, int vnode, int fileId);
+
 int vnodeReadLastBlockToMem(SMeterObj *pObj, SCompBlock *pBlock, SData *sdata[]);
 
+int vnodeRestoreLastRows(int vnode);
+
 // vnode API
 int vnodeInitPeer(int numOfThreads);
 
@@ -497,6 +559,15 @@ void vnodeCreateStream(SMeterObj *pObj);
 
 void vnodeRemoveStream(SMeterObj *pObj);
 
+void vnodeUpdateIncStreams(SMeterObj *pObj, char *pData, int numOfPoints, TSKEY prevLastKey);
+
+void vnodeDetachIncStreams(SMeterObj *pObj);
+
+// subscription API
+void vnodePushSubscribedRows(SMeterObj *pObj, char *pData, int numOfPoints);
+
+void vnodeFreeSubLog(SMeterObj *pObj);
+
 // shell API
 int vnodeInitShell();
 
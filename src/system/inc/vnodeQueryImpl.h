@@ -151,6 +151,7 @@ void doFinalizeResult(SQueryRuntimeEnv* pRuntimeEnv);
 int64_t getNumOfResult(SQueryRuntimeEnv* pRuntimeEnv);
 
 void forwardIntervalQueryRange(SMeterQuerySupportObj* pSupporter, SQueryRuntimeEnv* pRuntimeEnv);
+bool vnodeIntervalQueryFromRollup(SMeterQuerySupportObj* pSupporter);
 void forwardQueryStartPosition(SQueryRuntimeEnv* pRuntimeEnv);
 
 bool normalizedFirstQueryRange(bool dataInDisk, bool dataInCache, SMeterQuerySupportObj* pSupporter,
@@ -160,6 +161,8 @@ void pointInterpSupporterInit(SQuery* pQuery, SPointInterpoSupporter* pInterpoSu
 void pointInterpSupporterDestroy(SPointInterpoSupporter* pPointInterpSupport);
 void pointInterpSupporterSetData(SQInfo* pQInfo, SPointInterpoSupporter* pPointInterpSupport);
 
+bool vnodeLastRowQueryFromMeter(SMeterQuerySupportObj* pSupporter, SMeterObj* pMeterObj);
+
 int64_t loadRequiredBlockIntoMem(SQueryRuntimeEnv* pRuntimeEnv, SPositionInfo* position);
 void doCloseAllOpenedResults(SMeterQuerySupportObj* pSupporter);
 void disableFunctForSuppleScanAndSetSortOrder(SQueryRuntimeEnv* pRuntimeEnv, int32_t order);
@@ -101,6 +101,25 @@ typedef struct SQueryCostStatistics {
   int64_t tmpBufferInDisk;  // size of buffer for intermeidate result
 } SQueryCostStatistics;
 
+/*
+ * cursor on the rollup files of a meter, windows of interval query are computed from the aggregates of buckets
+ * instead of raw data blocks when the interval is a multiple of a rollup level of vnode
+ */
+typedef struct SRollupCursor {
+  int32_t level;         // index of rollup level used by query, -1 if rollups are not applicable
+  int64_t interval;      // length of bucket
+  int64_t coveredKey;    // data no later than this key are all aggregated in rollup files
+  int32_t fileId;        // file of the buckets in buffer
+  int32_t fd;
+  int64_t offset;        // offset of the bucket list of meter in rollup file
+  int32_t numOfBuckets;
+  int32_t bucketSize;
+  int32_t bufStart;      // index of the first bucket in buffer
+  int32_t bufRows;
+  char*   pBuf;
+  bool    rawPosInvalid; // windows are answered by rollups, the position in raw data needs to be set again
+} SRollupCursor;
+
 typedef struct RuntimeEnvironment {
   SPositionInfo startPos; /* the start position, used for secondary/third iteration */
   SPositionInfo endPos;   /* the last access position in query, served as the
@@ -148,6 +167,7 @@ typedef struct RuntimeEnvironment {
   SData**            pInterpoBuf;
 
   SQueryCostStatistics summary;
+  SRollupCursor        rollup;
 } SQueryRuntimeEnv;
 
 typedef struct SOutputRes {
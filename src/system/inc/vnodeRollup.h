@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_VNODEROLLUP_H
+#define TDENGINE_VNODEROLLUP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "vnode.h"
+
+struct SRollupCursor;
+
+/*
+ * a rollup file keeps the aggregates of fixed length time buckets for each meter in a data file,
+ * it has the same life cycle as the head/data/last files of the fileId.
+ *
+ * layout: file header | SRollupInfo[maxSessions] + TSCKSUM | (SRollupBucket[numOfBuckets] + TSCKSUM) of each meter
+ */
+typedef struct {
+  uint64_t uid;
+  int64_t  offset;        // offset of the bucket list
+  TSKEY    lastKey;       // the data of meter until this key are aggregated
+  int32_t  numOfBuckets;
+  int32_t  sversion;
+  int16_t  numOfCols;     // columns kept in each bucket, the primary timestamp column is excluded
+  int8_t   invalid;       // the rollup of meter can not be used, e.g., data imported into the file
+  char     reserved[5];
+} SRollupInfo;
+
+typedef struct {
+  int64_t sum;
+  int64_t max;
+  int64_t min;
+  int32_t numOfNullPoints;
+  int32_t reserved;
+} SRollupCol;
+
+typedef struct {
+  TSKEY      key;  // start key of the bucket
+  int32_t    numOfPoints;
+  int32_t    reserved;
+  SRollupCol cols[];
+} SRollupBucket;
+
+#define ROLLUP_BUCKET_SIZE(numOfCols) (sizeof(SRollupBucket) + (numOfCols) * sizeof(SRollupCol))
+
+void vnodeGetRollupName(char *name, int vnode, int fileId, int level);
+
+int vnodeCreateEmptyRollupFiles(int vnode, int fileId);
+
+void vnodeRemoveRollupFiles(int vnode, int fileId);
+
+/* called during committing, the rollups of a file are built along with its head file */
+void *vnodeInitRollupCommit(SVnodeObj *pVnode, int fileId, SMeterInfo *meterInfo);
+
+void vnodeRollupBlock(void *handle, SMeterObj *pObj, SData *data[], int points);
+
+int vnodeSaveRollups(void *handle);
+
+void vnodeCleanUpRollupCommit(void *handle);
+
+/* data is imported into the file, the rollup of meter in it is not consistent anymore */
+void vnodeInvalidateRollup(SMeterObj *pObj, int fileId);
+
+/* query side */
+int32_t vnodeInitRollupCursor(struct SRollupCursor *pCursor, SMeterObj *pObj, int64_t interval, TSKEY skey);
+
+int32_t vnodeGetRollupBucket(struct SRollupCursor *pCursor, SMeterObj *pObj, TSKEY key, SRollupBucket **pBucket);
+
+void vnodeCloseRollupCursor(struct SRollupCursor *pCursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_VNODEROLLUP_H
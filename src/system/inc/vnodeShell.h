@@ -32,8 +32,21 @@ typedef struct {
   int      numOfTotalPoints;  // track the total number of points imported
   void *   thandle;           // handle from TAOS layer
   void *   qhandle;
+
+  // the meter subscribed by this connection, and the subscribe request held until new rows arrive
+  void *   pSubLog;
+  void *   pNextSub;     // next connection subscribing the same meter
+  void *   pNextWaiter;  // next connection waiting for the same meter
+  void *   pSubTimer;
+  int64_t  subOffset;
+  int32_t  subCredit;
+  int8_t   subWaiting;
 } SShellObj;
 
+int vnodeProcessSubscribeRequest(char *pMsg, int msgLen, SShellObj *pShell);
+
+void vnodeCancelSubscribe(SShellObj *pShell);
+
 #ifdef __cplusplus
 }
 #endif
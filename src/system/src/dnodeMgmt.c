@@ -29,6 +29,7 @@
 
 int vnodeProcessVPeersMsg(char *msg);
 int vnodeProcessCreateMeterMsg(char *pMsg);
+int vnodeProcessMultiCreateMeterRequest(char *pMsg);
 int vnodeProcessFreeVnodeRequest(char *pMsg);
 int vnodeProcessVPeerCfgRsp(char *msg);
 int vnodeProcessMeterCfgRsp(char *msg);
@@ -56,6 +57,8 @@ void vnodeProcessMsgFromMgmt(SSchedMsg *sched) {
 
   if (msgType == TSDB_MSG_TYPE_CREATE) {
     vnodeProcessCreateMeterRequest(content);
+  } else if (msgType == TSDB_MSG_TYPE_MULTI_CREATE) {
+    vnodeProcessMultiCreateMeterRequest(content);
   } else if (msgType == TSDB_MSG_TYPE_VPEERS) {
     vnodeProcessVPeersMsg(content);
   } else if (msgType == TSDB_MSG_TYPE_VPEER_CFG_RSP) {
@@ -194,12 +197,16 @@ _over:
   return code;
 }
 
-int vnodeProcessCreateMeterMsg(char *pMsg) {
-  int         code;
+/*
+ * decode the create msg into a new meter object, the object is released if failed
+ */
+static int vnodeDecodeCreateMeterMsg(char *pMsg, SMeterObj **ppObj, SConnSec *pSec) {
+  int         code = TSDB_CODE_SUCCESS;
   SMeterObj * pObj = NULL;
-  SConnSec    connSec;
   SCreateMsg *pCreate = (SCreateMsg *)pMsg;
 
+  *ppObj = NULL;
+
   pCreate->vnode = htons(pCreate->vnode);
   pCreate->sid = htonl(pCreate->sid);
   pCreate->lastCreate = htobe64(pCreate->lastCreate);
@@ -279,13 +286,26 @@ int vnodeProcessCreateMeterMsg(char *pMsg) {
     goto _create_over;
   }
 
-  // security info shall be saved here
-  connSec.spi = pCreate->spi;
-  connSec.encrypt = pCreate->encrypt;
-  memcpy(connSec.secret, pCreate->secret, TSDB_KEY_LEN);
-  memcpy(connSec.cipheringKey, pCreate->cipheringKey, TSDB_KEY_LEN);
+  // tag values of meter created from metric are after SQL string
+  pObj->metricUid = htobe64(pCreate->metricUid);
+  pObj->tagSig = htonl(pCreate->tagSig);
+  pObj->tagLen = htons(pCreate->tagLen);
+  if (pObj->tagLen > 0) {
+    pObj->pTags = malloc(pObj->tagLen);
+    if (pObj->pTags == NULL) {
+      code = TSDB_CODE_NO_RESOURCE;
+      goto _create_over;
+    }
 
-  code = vnodeCreateMeterObj(pObj, &connSec);
+    memcpy(pObj->pTags, (char *)pCreate->schema + pCreate->numOfColumns * sizeof(SMColumn) + pCreate->sqlLen,
+           pObj->tagLen);
+  }
+
+  // security info shall be saved here
+  pSec->spi = pCreate->spi;
+  pSec->encrypt = pCreate->encrypt;
+  memcpy(pSec->secret, pCreate->secret, TSDB_KEY_LEN);
+  memcpy(pSec->cipheringKey, pCreate->cipheringKey, TSDB_KEY_LEN);
 
 _create_over:
   if (code != TSDB_CODE_SUCCESS) {
@@ -293,6 +313,112 @@ _create_over:
     tfree(pObj);
   }
 
+  *ppObj = pObj;
+  return code;
+}
+
+int vnodeProcessCreateMeterMsg(char *pMsg) {
+  SMeterObj *pObj = NULL;
+  SConnSec   connSec;
+
+  int code = vnodeDecodeCreateMeterMsg(pMsg, &pObj, &connSec);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  code = vnodeCreateMeterObj(pObj, &connSec);
+  if (code != TSDB_CODE_SUCCESS) {
+    SCreateMsg *pCreate = (SCreateMsg *)pMsg;
+    dTrace("vid:%d sid:%d id:%s, failed to create meterObj", pCreate->vnode, pCreate->sid, pCreate->meterId);
+    tfree(pObj->pTags);
+    tfree(pObj);
+  }
+
+  return code;
+}
+
+/*
+ * create all meters in the multi-create msg, the meter objects are saved into file in one batch
+ */
+int vnodeProcessMultiCreateMeterRequest(char *pMsg) {
+  SMultiCreateMsg *pMultiCreate = (SMultiCreateMsg *)pMsg;
+  SMeterObj **     pObjs = NULL;
+  int32_t *        pCode = NULL;
+  SConnSec         connSec;
+  int              code = TSDB_CODE_SUCCESS;
+  char *           pStart;
+
+  int vid = htons(pMultiCreate->vnode);
+  int numOfMeters = htonl(pMultiCreate->numOfMeters);
+
+  if (vid >= TSDB_MAX_VNODES || vid < 0) {
+    dError("vid:%d, vnode is out of range", vid);
+    code = TSDB_CODE_INVALID_SESSION_ID;
+    goto _over;
+  }
+
+  if (vnodeList[vid].cfg.maxSessions <= 0) {
+    dError("vid:%d, not activated", vid);
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+    goto _over;
+  }
+
+  if (vnodeList[vid].pCachePool == NULL) {
+    dError("vid:%d is not activated yet, meters in msg:%d", vid, numOfMeters);
+    vnodeSendVpeerCfgMsg(vid);
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+    goto _over;
+  }
+
+  if (numOfMeters <= 0) goto _over;
+
+  pObjs = (SMeterObj **)calloc(numOfMeters, sizeof(SMeterObj *));
+  pCode = (int32_t *)calloc(numOfMeters, sizeof(int32_t));
+  if (pObjs == NULL || pCode == NULL) {
+    code = TSDB_CODE_NO_RESOURCE;
+    goto _over;
+  }
+
+  int numOfObjs = 0;
+  pMsg = pMultiCreate->meters;
+
+  for (int i = 0; i < numOfMeters; ++i) {
+    SCreateMsg *pCreate = (SCreateMsg *)pMsg;
+
+    // the length of msg shall be calculated before it is decoded in place
+    pMsg += sizeof(SCreateMsg) + htons(pCreate->numOfColumns) * sizeof(SMColumn) + htons(pCreate->sqlLen) +
+            htons(pCreate->tagLen);
+
+    if (vnodeDecodeCreateMeterMsg((char *)pCreate, &pObjs[numOfObjs], &connSec) == TSDB_CODE_SUCCESS) {
+      numOfObjs++;
+    } else {
+      code = TSDB_CODE_OTHERS;
+    }
+  }
+
+  vnodeCreateMeterObjs(vid, pObjs, numOfObjs, pCode);
+
+  for (int i = 0; i < numOfObjs; ++i) {
+    if (pCode[i] != TSDB_CODE_SUCCESS) {
+      dTrace("vid:%d sid:%d id:%s, failed to create meterObj", vid, pObjs[i]->sid, pObjs[i]->meterId);
+      tfree(pObjs[i]->pTags);
+      tfree(pObjs[i]);
+    }
+  }
+
+_over:
+  tfree(pObjs);
+  tfree(pCode);
+
+  pStart = (char *)malloc(128);
+  if (pStart == NULL) return 0;
+
+  *pStart = TSDB_MSG_TYPE_MULTI_CREATE_RSP;
+  pMsg = pStart + 1;
+
+  *pMsg = code;
+  vnodeSendMsgToMgmt(pStart);
+
   return code;
 }
 
@@ -370,6 +496,7 @@ int vnodeProcessVPeerCfg(char *msg) {
   pCfg->commitTime = htonl(pCfg->commitTime);
   pCfg->blocksPerMeter = htons(pCfg->blocksPerMeter);
   pCfg->rowsInFileBlock = htonl(pCfg->rowsInFileBlock);
+  for (int i = 0; i < TSDB_MAX_ROLLUP_LEVELS; ++i) pCfg->rollupLevels[i] = htonl(pCfg->rollupLevels[i]);
 
   dTrace("vid:%d, vgroup:%d, vpeer cfg received, sessions:%d, current session:%d", vnode, pCfg->vgId, pCfg->maxSessions,
          vnodeList[vnode].cfg.maxSessions);
@@ -14,6 +14,7 @@
  */
 
 #include "mgmt.h"
+#include "mgmtTagIndex.h"
 #include <arpa/inet.h>
 #include "tschemautil.h"
 
@@ -199,6 +200,25 @@ int mgmtCheckDbParams(SCreateDbMsg *pCreate) {
     return TSDB_CODE_INVALID_OPTION;
   }
 
+  // rollup levels can not be given in sql, databases take the levels configured in mgmt when created
+  pCreate->rollupLevels[0] = tsRollupLevel1;
+  pCreate->rollupLevels[1] = tsRollupLevel2;
+  for (int i = 0; i < TSDB_MAX_ROLLUP_LEVELS; ++i) {
+    // a bucket shall not cross the boundary of data files, which span whole days
+    if (pCreate->rollupLevels[i] < 0 || (pCreate->rollupLevels[i] > 0 && 86400 % pCreate->rollupLevels[i] != 0)) {
+      mTrace("invalid db option rollup level%d: %d, it should divide one day in seconds", i + 1,
+             pCreate->rollupLevels[i]);
+      return TSDB_CODE_INVALID_OPTION;
+    }
+  }
+
+  if (pCreate->rollupLevels[0] > 0 && pCreate->rollupLevels[1] > 0 &&
+      (pCreate->rollupLevels[1] <= pCreate->rollupLevels[0] || pCreate->rollupLevels[1] % pCreate->rollupLevels[0] != 0)) {
+    mTrace("invalid db option rollup levels: %d,%d, level2 should be a multiple of level1", pCreate->rollupLevels[0],
+           pCreate->rollupLevels[1]);
+    return TSDB_CODE_INVALID_OPTION;
+  }
+
   if (pCreate->blocksPerMeter < 0) pCreate->blocksPerMeter = tsNumOfBlocksPerMeter;
   if (pCreate->blocksPerMeter > pCreate->cacheNumOfBlocks.totalBlocks * 3 / 4) {
     pCreate->blocksPerMeter = pCreate->cacheNumOfBlocks.totalBlocks * 3 / 4;
@@ -480,6 +500,8 @@ int mgmtRemoveMetricFromDb(SDbObj *pDb, STabObj *pMetric) {
   if (pMetric->pSkipList != NULL) {
     tSkipListDestroy(&pMetric->pSkipList);
   }
+
+  mgmtDestroyTagIndex(pMetric);
   return 0;
 }
 
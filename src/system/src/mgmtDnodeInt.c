@@ -15,11 +15,14 @@
 
 #define _DEFAULT_SOURCE
 #include <arpa/inet.h>
+#include <assert.h>
 #include <endian.h>
+#include <limits.h>
 
 #include "dnodeSystem.h"
 #include "mgmt.h"
 #include "tsched.h"
+#include "tschemautil.h"
 #include "tutil.h"
 #pragma GCC diagnostic ignored "-Wpointer-sign"
 
@@ -163,7 +166,7 @@ void mgmtProcessMsgFromVnode(SSchedMsg *sched) {
     mgmtProcessMeterCfgMsg(content);
   } else if (msgType == TSDB_MSG_TYPE_VPEER_CFG) {
     mgmtProcessVpeerCfgMsg(content);
-  } else if (msgType == TSDB_MSG_TYPE_CREATE_RSP) {
+  } else if (msgType == TSDB_MSG_TYPE_CREATE_RSP || msgType == TSDB_MSG_TYPE_MULTI_CREATE_RSP) {
     mgmtProcessCreateRsp(content);
   } else if (msgType == TSDB_MSG_TYPE_REMOVE_RSP) {
     // do nothing
@@ -220,6 +223,23 @@ char *mgmtBuildCreateMeterIe(STabObj *pMeter, char *pMsg, int vnode) {
     pMsg += len;
   }
 
+  // the tag values are replicated to vnode, so the tag condition of metric query can be evaluated by vnode
+  pCreateMeter->metricUid = 0;
+  pCreateMeter->tagSig = 0;
+  pCreateMeter->tagLen = 0;
+
+  if (mgmtMeterCreateFromMetric(pMeter)) {
+    STabObj *pMetric = mgmtGetMeter(pMeter->pTagData);
+    int32_t  tagLen = mgmtGetTagsLength(pMetric, INT_MAX);
+
+    pCreateMeter->metricUid = htobe64(pMetric->uid);
+    pCreateMeter->tagSig = htonl(tsGetTagSchemaSignature(pSchema + pMetric->numOfColumns, pMetric->numOfTags));
+    pCreateMeter->tagLen = htons(tagLen);
+
+    memcpy(pMsg, pMeter->pTagData + TSDB_METER_ID_LEN, tagLen);
+    pMsg += tagLen;
+  }
+
   return pMsg;
 }
 
@@ -238,6 +258,40 @@ int mgmtSendCreateMsgToVnode(STabObj *pMeter, int vnode) {
   return 0;
 }
 
+/*
+ * send the create msg of a batch of meters in one vnode by one msg
+ */
+int mgmtSendMultiCreateMsgToVnode(STabObj **pMeters, int numOfMeters, int vnode) {
+  SMultiCreateMsg *pMultiCreate;
+  char *           pMsg, *pStart;
+  int              size = 1 + sizeof(SMultiCreateMsg);
+
+  for (int i = 0; i < numOfMeters; ++i) {
+    size += sizeof(SCreateMsg) + pMeters[i]->numOfColumns * sizeof(SMColumn);
+    if (pMeters[i]->pSql) size += strlen(pMeters[i]->pSql) + 1;
+    if (mgmtMeterCreateFromMetric(pMeters[i])) size += mgmtGetTagsLength(mgmtGetMeter(pMeters[i]->pTagData), INT_MAX);
+  }
+
+  pStart = (char *)malloc(size);
+  if (pStart == NULL) return -1;
+
+  *pStart = TSDB_MSG_TYPE_MULTI_CREATE;
+  pMultiCreate = (SMultiCreateMsg *)(pStart + 1);
+  pMultiCreate->vnode = htons(vnode);
+  pMultiCreate->numOfMeters = htonl(numOfMeters);
+
+  pMsg = pMultiCreate->meters;
+  for (int i = 0; i < numOfMeters; ++i) {
+    pMsg = mgmtBuildCreateMeterIe(pMeters[i], pMsg, vnode);
+  }
+
+  assert(pMsg - pStart <= size);
+  mgmtSendMsgToDnode(pStart);
+  mTrace("vid:%d, send multi-create msg, meters:%d", vnode, numOfMeters);
+
+  return 0;
+}
+
 int mgmtSendRemoveMeterMsgToVnode(STabObj *pMeter, int vnode) {
   SRemoveMeterMsg *pRemove;
   char *           pMsg, *pStart;
@@ -299,6 +353,7 @@ char *mgmtBuildVpeersIe(char *pMsg, SVgObj *pVgroup, SDbObj *pDb) {
   pCfg->blocksPerMeter = htons(pCfg->blocksPerMeter);
   pCfg->replications = 1;
   pCfg->rowsInFileBlock = htonl(pCfg->rowsInFileBlock);
+  for (int i = 0; i < TSDB_MAX_ROLLUP_LEVELS; ++i) pCfg->rollupLevels[i] = htonl(pCfg->rollupLevels[i]);
 
   return pMsg;
 }
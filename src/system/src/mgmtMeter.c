@@ -19,9 +19,11 @@
 #include <stdint.h>
 
 #include "mgmt.h"
+#include "mgmtTagIndex.h"
 #include "taosmsg.h"
 #include "tast.h"
 #include "textbuffer.h"
+#include "shash.h"
 #include "tschemautil.h"
 #include "tscompression.h"
 #include "tskiplist.h"
@@ -35,6 +37,7 @@ extern int64_t sdbVersion;
   do {                           \
     tfree(pMeter->schema);       \
     tSkipListDestroy(&(pMeter->pSkipList));\
+    mgmtDestroyTagIndex(pMeter);           \
     tfree(pMeter);               \
   } while (0)
 
@@ -102,7 +105,7 @@ void mgmtMeterActionInit() {
   mgmtMeterActionFp[SDB_TYPE_DESTROY] = mgmtMeterActionDestroy;
 }
 
-static int32_t mgmtGetTagsLength(STabObj *pMetric, int32_t col) {  // length befor column col
+int32_t mgmtGetTagsLength(STabObj *pMetric, int32_t col) {  // length befor column col
   assert(mgmtIsMetric(pMetric) && col >= 0);
 
   int32_t len = 0;
@@ -229,6 +232,7 @@ void *mgmtMeterActionInsert(void *row, char *str, int size, int *ssize) {
     // insert a metric
     pMeter->pHead = NULL;
     pMeter->pSkipList = NULL;
+    mgmtCreateTagIndex(pMeter);
     pDb = mgmtGetDbByMeterId(pMeter->meterId);
     if (pDb) {
       mgmtAddMetricIntoDb(pDb, pMeter);
@@ -293,14 +297,19 @@ void *mgmtMeterActionUpdate(void *row, char *str, int size, int *ssize) {
   pMeter = (STabObj *)row;
   STabObj *pNew = (STabObj *)str;
 
-  if (pNew->isDirty) {
+  if (mgmtMeterCreateFromMetric(pMeter)) {
     pMetric = mgmtGetMeter(pMeter->pTagData);
-    removeMeterFromMetricIndex(pMetric, pMeter);
+  }
+
+  if (pMetric != NULL) {
+    if (pNew->isDirty) removeMeterFromMetricIndex(pMetric, pMeter);
+    mgmtRemoveMeterFromTagIndex(pMetric, pMeter);
   }
   mgmtMeterActionReset(pMeter, str, size, NULL);
   pMeter->pTagData = pMeter->schema;
-  if (pNew->isDirty) {
-    addMeterIntoMetricIndex(pMetric, pMeter);
+  if (pMetric != NULL) {
+    if (pNew->isDirty) addMeterIntoMetricIndex(pMetric, pMeter);
+    mgmtAddMeterIntoTagIndex(pMetric, pMeter);
     pMeter->isDirty = 0;
   }
 
@@ -423,6 +432,11 @@ void *mgmtMeterActionBatchUpdate(void *row, char *str, int size, int *ssize) {
 void *mgmtMeterActionAfterBatchUpdate(void *row, char *str, int size, int *ssize) {
   STabObj *pMetric = (STabObj *)row;
 
+  // the positions of tag values are changed, rebuild the tag index
+  if (mgmtIsMetric(pMetric)) {
+    mgmtRebuildTagIndex(pMetric);
+  }
+
   pthread_rwlock_unlock(&(pMetric->rwLock));
 
   return NULL;
@@ -511,17 +525,18 @@ int mgmtInitMeters() {
 
 STabObj *mgmtGetMeter(char *meterId) { return (STabObj *)sdbGetRow(meterSdb, meterId); }
 
-int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate) {
+/*
+ * build the meter object according to the create msg, the sid in vgroup is allocated for normal meter.
+ * ppMeter is set to NULL if the meter exists and igExists is set.
+ */
+static int mgmtBuildMeter(SDbObj *pDb, SCreateTableMsg *pCreate, STabObj **ppMeter, SVgObj **ppVgroup) {
   STabObj * pMeter = NULL;
   STabObj * pMetric = NULL;
   SVgObj *  pVgroup = NULL;
   int       size = 0;
 
-  int numOfTables = sdbGetNumOfRows(meterSdb);
-  if (numOfTables >= tsMaxTables) {
-    mWarn("numOfTables:%d, exceed tsMaxTables:%d", numOfTables, tsMaxTables);
-    return TSDB_CODE_TOO_MANY_TABLES;
-  }
+  *ppMeter = NULL;
+  *ppVgroup = NULL;
 
   // does table exist?
   pMeter = mgmtGetMeter(pCreate->meterId);
@@ -543,6 +558,7 @@ int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate) {
     char *pTagData = (char *)pCreate->schema;  // it is a tag key
     pMetric = mgmtGetMeter(pTagData);
     if (pMetric == NULL) {
+      mgmtDestroyMeter(pMeter);
       return TSDB_CODE_INVALID_TABLE;
     }
 
@@ -659,6 +675,27 @@ int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate) {
     pMeter->uid = (((uint64_t)pMeter->createdTime) << 16) + ((uint64_t)sdbVersion & ((1ul << 16) - 1ul));
   }
 
+  *ppMeter = pMeter;
+  *ppVgroup = pVgroup;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate) {
+  STabObj *pMeter = NULL;
+  SVgObj * pVgroup = NULL;
+
+  int numOfTables = sdbGetNumOfRows(meterSdb);
+  if (numOfTables >= tsMaxTables) {
+    mWarn("numOfTables:%d, exceed tsMaxTables:%d", numOfTables, tsMaxTables);
+    return TSDB_CODE_TOO_MANY_TABLES;
+  }
+
+  int code = mgmtBuildMeter(pDb, pCreate, &pMeter, &pVgroup);
+  if (code != TSDB_CODE_SUCCESS || pMeter == NULL) {
+    return code;
+  }
+
   if (sdbInsertRow(meterSdb, pMeter, 0) < 0) {
     return TSDB_CODE_SDB_ERROR;
   }
@@ -671,6 +708,109 @@ int mgmtCreateMeter(SDbObj *pDb, SCreateTableMsg *pCreate) {
   return 0;
 }
 
+/*
+ * create a batch of meters in one request. The meters are built one by one until the first failure, then the
+ * built ones are written into sdb in one batch, and one create msg carrying all meters of a vnode is sent to
+ * each vnode. The meters before the failed one are created or already exist, the number is set in numOfCreated.
+ * Metrics are not allowed, since their uid is not unique if they are created in the same sdb version.
+ */
+int mgmtCreateMeters(SDbObj *pDb, SCreateTableMsg **pCreates, int numOfMeters, int *numOfCreated) {
+  STabObj **pGroup = NULL;
+  int       code = TSDB_CODE_SUCCESS;
+  int       numOfBuilt = 0;
+  int       i = 0;
+
+  *numOfCreated = 0;
+  if (numOfMeters <= 0) return TSDB_CODE_SUCCESS;
+
+  STabObj **pMeters = (STabObj **)calloc(numOfMeters, sizeof(STabObj *));
+  SVgObj ** pVgroups = (SVgObj **)calloc(numOfMeters, sizeof(SVgObj *));
+  void *    pHash = taosInitStrHash(numOfMeters, sizeof(int32_t), taosHashString);
+
+  if (pMeters == NULL || pVgroups == NULL || pHash == NULL) {
+    code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+    goto _over;
+  }
+
+  int numOfTables = sdbGetNumOfRows(meterSdb);
+
+  for (i = 0; i < numOfMeters; ++i) {
+    SCreateTableMsg *pCreate = pCreates[i];
+
+    if (pCreate->numOfTags > 0) {
+      code = TSDB_CODE_OPS_NOT_SUPPORT;
+      break;
+    }
+
+    // the same meter may be specified more than once in one batch
+    if (taosGetStrHashData(pHash, pCreate->meterId) != NULL) {
+      if (pCreate->igExists) continue;
+
+      code = TSDB_CODE_TABLE_ALREADY_EXIST;
+      break;
+    }
+
+    if (numOfTables + numOfBuilt >= tsMaxTables) {
+      mWarn("numOfTables:%d, exceed tsMaxTables:%d", numOfTables + numOfBuilt, tsMaxTables);
+      code = TSDB_CODE_TOO_MANY_TABLES;
+      break;
+    }
+
+    code = mgmtBuildMeter(pDb, pCreate, &pMeters[numOfBuilt], &pVgroups[numOfBuilt]);
+    if (code != TSDB_CODE_SUCCESS) break;
+
+    if (pMeters[numOfBuilt] != NULL) {
+      taosAddStrHash(pHash, pCreate->meterId, (char *)&i);
+      numOfBuilt++;
+    }
+  }
+
+  *numOfCreated = i;
+  if (numOfBuilt == 0) goto _over;
+
+  if (sdbBatchInsertRows(meterSdb, (void **)pMeters, numOfBuilt) < 0) {
+    for (int j = 0; j < numOfBuilt; ++j) {
+      taosFreeId(pVgroups[j]->idPool, pMeters[j]->gid.sid);
+      mgmtDestroyMeter(pMeters[j]);
+    }
+
+    *numOfCreated = 0;
+    code = TSDB_CODE_SDB_ERROR;
+    goto _over;
+  }
+
+  mTrace("db:%s, %d meters are created in batch, meters in msg:%d code:%d", pDb->name, numOfBuilt, numOfMeters, code);
+
+  // group the meters by vgroup, and send one create msg to each vnode
+  pGroup = (STabObj **)malloc(numOfBuilt * sizeof(STabObj *));
+  for (int j = 0; j < numOfBuilt; ++j) {
+    SVgObj *pVgroup = pVgroups[j];
+    if (pVgroup == NULL) continue;
+
+    int num = 0;
+    for (int k = j; k < numOfBuilt; ++k) {
+      if (pVgroups[k] != pVgroup) continue;
+
+      if (pGroup == NULL) {  // no memory to group meters, send them one by one
+        mgmtSendCreateMsgToVnode(pMeters[k], pVgroup->vnodeGid[0].vnode);
+      } else {
+        pGroup[num++] = pMeters[k];
+      }
+      pVgroups[k] = NULL;
+    }
+
+    if (num > 0) mgmtSendMultiCreateMsgToVnode(pGroup, num, pVgroup->vnodeGid[0].vnode);
+  }
+
+_over:
+  tfree(pGroup);
+  tfree(pMeters);
+  tfree(pVgroups);
+  if (pHash != NULL) taosCleanUpStrHash(pHash);
+
+  return code;
+}
+
 int mgmtDropMeter(SDbObj *pDb, char *meterId, int ignore) {
   STabObj * pMeter;
   SVgObj *  pVgroup;
@@ -832,6 +972,7 @@ int mgmtAddMeterIntoMetric(STabObj *pMetric, STabObj *pMeter) {
   pMetric->numOfMeters++;
 
   addMeterIntoMetricIndex(pMetric, pMeter);
+  mgmtAddMeterIntoTagIndex(pMetric, pMeter);
 
   pthread_rwlock_unlock(&(pMetric->rwLock));
 
@@ -850,6 +991,7 @@ int mgmtRemoveMeterFromMetric(STabObj *pMetric, STabObj *pMeter) {
   pMetric->numOfMeters--;
 
   removeMeterFromMetricIndex(pMetric, pMeter);
+  mgmtRemoveMeterFromTagIndex(pMetric, pMeter);
 
   pthread_rwlock_unlock(&(pMetric->rwLock));
 
@@ -906,12 +1048,16 @@ static int32_t tabObjVGIDComparator(const void *pLeft, const void *pRight) {
   STabObj *p1 = *(STabObj **)pLeft;
   STabObj *p2 = *(STabObj **)pRight;
 
-  int32_t ret = p1->gid.vgId - p2->gid.vgId;
-  if (ret == 0) {
-    return ret;
-  } else {
-    return ret > 0 ? 1 : -1;
+  // meters of the same vnode are in ascending order of sid, which is required by the delta encoding of sids
+  if (p1->gid.vgId != p2->gid.vgId) {
+    return p1->gid.vgId > p2->gid.vgId ? 1 : -1;
+  }
+
+  if (p1->gid.sid == p2->gid.sid) {
+    return 0;
   }
+
+  return p1->gid.sid > p2->gid.sid ? 1 : -1;
 }
 
 /*
@@ -940,60 +1086,6 @@ SSchema *mgmtGetMeterSchema(STabObj *pMeter) {
   return (SSchema *)pMetric->schema;
 }
 
-/*
- * serialize SVnodeSidList to byte array
- */
-static char *mgmtBuildMetricMetaMsg(STabObj *pMeter, int32_t *ovgId, SVnodeSidList **pList, SMetricMeta *pMeta,
-                                    int32_t tagLen, int16_t numOfTags, int16_t *tagsId, int32_t maxNumOfMeters,
-                                    char *pMsg) {
-  if (pMeter->gid.vgId != *ovgId || ((*pList) != NULL && (*pList)->numOfSids >= maxNumOfMeters)) {
-    /*
-     * here we construct a new vnode group for 2 reasons
-     * 1. the query msg may be larger than 64k,
-     * 2. the following meters belong to different vnodes
-     */
-
-    (*pList) = (SVnodeSidList *)pMsg;
-    (*pList)->numOfSids = 0;
-    (*pList)->index = 0;
-    pMeta->numOfVnodes++;
-
-    SVgObj *pVgroup = mgmtGetVgroup(pMeter->gid.vgId);
-    (*pList)->vpeerDesc[0].vnode = pVgroup->vnodeGid[0].vnode;
-
-    pMsg += sizeof(SVnodeSidList);
-    (*ovgId) = pMeter->gid.vgId;
-  }
-  pMeta->numOfMeters++;
-  (*pList)->numOfSids++;
-
-  SMeterSidExtInfo *pSMeterTagInfo = (SMeterSidExtInfo *)pMsg;
-  pSMeterTagInfo->sid = pMeter->gid.sid;
-  pMsg += sizeof(SMeterSidExtInfo);
-
-  int32_t offset = 0;
-  for (int32_t j = 0; j < numOfTags; ++j) {
-    if (tagsId[j] == -1) {
-      char name[TSDB_METER_NAME_LEN] = {0};
-      extractMeterName(pMeter->meterId, name);
-
-      memcpy(pMsg + offset, name, TSDB_METER_NAME_LEN);
-      offset += TSDB_METER_NAME_LEN;
-    } else {
-      SSchema s = {0};
-      char *  tag = mgmtMeterGetTag(pMeter, tagsId[j], &s);
-
-      memcpy(pMsg + offset, tag, (size_t)s.bytes);
-      offset += s.bytes;
-    }
-  }
-
-  pMsg += offset;
-  assert(offset == tagLen);
-
-  return pMsg;
-}
-
 static STabObj *mgmtGetResultPayload(tQueryResultset *pRes, int32_t index) {
   if (index < 0 || index >= pRes->num) {
     return NULL;
@@ -1006,25 +1098,6 @@ static STabObj *mgmtGetResultPayload(tQueryResultset *pRes, int32_t index) {
   }
 }
 
-// get total number of vnodes in final result set
-static int32_t mgmtGetNumOfVnodesInResult(tQueryResultset *pResult) {
-  int32_t numOfVnodes = 0;
-  int32_t prevGid = -1;
-
-  for (int32_t i = 0; i < pResult->num; ++i) {
-    STabObj *pMeter = mgmtGetResultPayload(pResult, i);
-    if (prevGid == -1) {
-      prevGid = pMeter->gid.vgId;
-      numOfVnodes++;
-    } else if (prevGid != pMeter->gid.vgId) {
-      prevGid = pMeter->gid.vgId;
-      numOfVnodes++;
-    }
-  }
-
-  return numOfVnodes;
-}
-
 static void mgmtRetrieveMetersFromIDs(tQueryResultset *pRes, char *queryStr, char *origins, STabObj *pMetric) {
   char *  sep = ",";
   char *  pToken = NULL;
@@ -1163,73 +1236,14 @@ static char *getTagValueFromMeter(STabObj *pMeter, int32_t offset, void *param)
   }
 }
 
-// todo refactor
 bool tSQLElemFilterCallback(tSkipListNode *pNode, void *param) {
   tQueryInfo *pCols = (tQueryInfo *)param;
   STabObj *   pMeter = (STabObj *)pNode->pData;
 
-  char   name[TSDB_METER_NAME_LEN + 1] = {0};
-  char * val = getTagValueFromMeter(pMeter, pCols->offset, name);
-  int8_t type = (pCols->pSchema[pCols->colIdx].type);
-
-  int32_t ret = 0;
-  if (pCols->q.nType == TSDB_DATA_TYPE_BINARY || pCols->q.nType == TSDB_DATA_TYPE_NCHAR) {
-    ret = pCols->comparator(val, pCols->q.pz);
-  } else {
-    tVariant v = {0};
-    switch (type) {
-      case TSDB_DATA_TYPE_INT:
-        v.i64Key = *(int32_t *)val;
-        break;
-      case TSDB_DATA_TYPE_BIGINT:
-        v.i64Key = *(int64_t *)val;
-        break;
-      case TSDB_DATA_TYPE_TINYINT:
-        v.i64Key = *(int8_t *)val;
-        break;
-      case TSDB_DATA_TYPE_SMALLINT:
-        v.i64Key = *(int16_t *)val;
-        break;
-      case TSDB_DATA_TYPE_DOUBLE:
-        v.dKey = *(double *)val;
-        break;
-      case TSDB_DATA_TYPE_FLOAT:
-        v.dKey = *(float *)val;
-        break;
-      case TSDB_DATA_TYPE_BOOL:
-        v.i64Key = *(int8_t *)val;
-        break;
-    }
-    ret = pCols->comparator(&v.i64Key, &pCols->q.i64Key);
-  }
-
-  switch (pCols->optr) {
-    case TSDB_RELATION_EQUAL: {
-      return ret == 0;
-    }
-    case TSDB_RELATION_NOT_EQUAL: {
-      return ret != 0;
-    }
-    case TSDB_RELATION_LARGE_EQUAL: {
-      return ret >= 0;
-    }
-    case TSDB_RELATION_LARGE: {
-      return ret > 0;
-    }
-    case TSDB_RELATION_LESS_EQUAL: {
-      return ret <= 0;
-    }
-    case TSDB_RELATION_LESS: {
-      return ret < 0;
-    }
-    case TSDB_RELATION_LIKE: {
-      return ret == 0;
-    }
+  char name[TSDB_METER_NAME_LEN + 1] = {0};
+  char *val = getTagValueFromMeter(pMeter, pCols->offset, name);
 
-    default:
-      assert(false);
-  }
-  return true;
+  return tSQLElemFilterOnTagValue(pCols, val);
 }
 
 int mgmtRetrieveMetersFromMetric(STabObj *pMetric, SMetricMetaMsg *pInfo, tQueryResultset *pRes) {
@@ -1270,8 +1284,11 @@ int mgmtRetrieveMetersFromMetric(STabObj *pMetric, SMetricMetaMsg *pInfo, tQuery
         tfree(queryStr);
         return TSDB_CODE_OPS_NOT_SUPPORT;
       } else {
-        // query according to the binary expression
-        tSQLBinaryExprTraverse(pExpr, pMetric->pSkipList, pTagSchema, pMetric->numOfTags, tSQLElemFilterCallback, pRes);
+        // query according to the binary expression, evaluated on the tag index if it is available
+        if (mgmtQueryTagIndex(pMetric, pExpr, pRes) != TSDB_CODE_SUCCESS) {
+          tSQLBinaryExprTraverse(pExpr, pMetric->pSkipList, pTagSchema, pMetric->numOfTags, tSQLElemFilterCallback,
+                                 pRes);
+        }
         tSQLBinaryExprDestroy(&pExpr);
       }
     }
@@ -1286,87 +1303,271 @@ int mgmtRetrieveMetersFromMetric(STabObj *pMetric, SMetricMetaMsg *pInfo, tQuery
   return TSDB_CODE_SUCCESS;
 }
 
-static int32_t mgmtGetMetricMetaMsgSize(tQueryResultset *pResult, int32_t tagLength, int32_t maxMetersPerQuery) {
-  int32_t numOfVnodes = mgmtGetNumOfVnodesInResult(pResult);
+static int32_t mgmtEnsureMetricMetaBuf(char **pBuf, int32_t *capacity, int64_t required) {
+  if (required <= *capacity) {
+    return TSDB_CODE_SUCCESS;
+  }
 
-  int32_t size = (sizeof(SMeterSidExtInfo) + tagLength) * pResult->num +
-                 ((pResult->num / maxMetersPerQuery) + 1 + numOfVnodes) * sizeof(SVnodeSidList) + sizeof(SMetricMeta) +
-                 1024;
+  int64_t size = MAX(required, ((int64_t)(*capacity)) << 1);
+  if (size > INT32_MAX) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
 
-  return size;
+  char *p = realloc(*pBuf, (size_t)size);
+  if (p == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  *pBuf = p;
+  *capacity = (int32_t)size;
+  return TSDB_CODE_SUCCESS;
 }
 
-int mgmtRetrieveMetricMeta(void *thandle, char **pStart, STabObj *pMetric, SMetricMetaMsg *pMetricMetaMsg) {
-  SVnodeSidList *pList = NULL;
+static int32_t mgmtCompareMeterVgId(const void *p1, const void *p2) {
+  int32_t vgId1 = (*(STabObj **)p1)->gid.vgId;
+  int32_t vgId2 = (*(STabObj **)p2)->gid.vgId;
 
-  int32_t tagLen = mgmtGetReqTagsLength(pMetric, (int16_t *)pMetricMetaMsg->tagCols, pMetricMetaMsg->numOfTags);
+  return (vgId1 == vgId2) ? 0 : ((vgId1 < vgId2) ? -1 : 1);
+}
 
-  /*
-   * naive method: Do not limit the maximum number of meters in each
-   * vnode(subquery),
-   * split the result according to vnodes
-   * todo: split the number of vnodes to make sure each vnode has the same
-   * number of
-   * tables to query, while not break the upper limit of number of vnode queries
-   */
-  int32_t maxMetersPerVNodeInQuery = INT32_MAX;
+/*
+ * compress the sids and tags of meters in [start, end) of the result, which belong to the same vnode.
+ * The sids are in ascending order, so the delta encoding of integer compression works well on them.
+ */
+static int32_t mgmtBuildVnodeSidList(STabObj *pMetric, tQueryResultset *pRes, int32_t start, int32_t end,
+                                     SMetricMetaMsg *pInfo, int16_t *tagBytes, int32_t tagLen, char **pBuf,
+                                     int32_t *capacity, int32_t *len) {
+  int32_t numOfSids = end - start;
+  int32_t sidBound = numOfSids * (int32_t)sizeof(int64_t) + 128;
+  int32_t tagBound = (tagLen > 0) ? numOfSids * tagLen + (numOfSids * tagLen) / 255 + 128 : 0;
+
+  int32_t code = mgmtEnsureMetricMetaBuf(pBuf, capacity,
+                                         (int64_t)*len + sizeof(SVnodeSidListRsp) + sidBound + tagBound);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  char *pRaw = malloc(MAX((size_t)numOfSids * sizeof(int32_t), (size_t)numOfSids * tagLen));
+  char *pTemp = malloc((size_t)sidBound);
+  if (pRaw == NULL || pTemp == NULL) {
+    tfree(pRaw);
+    tfree(pTemp);
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  STabObj *pMeter = mgmtGetResultPayload(pRes, start);
+  SVgObj * pVgroup = mgmtGetVgroup(pMeter->gid.vgId);
+
+  SVnodeSidListRsp *pList = (SVnodeSidListRsp *)(*pBuf + *len);
+  pList->vnode = htonl(pVgroup->vnodeGid[0].vnode);
+  pList->numOfSids = htonl(numOfSids);
+
+  int32_t *sids = (int32_t *)pRaw;
+  for (int32_t i = 0; i < numOfSids; ++i) {
+    sids[i] = mgmtGetResultPayload(pRes, start + i)->gid.sid;
+  }
+
+  int32_t sidLen = tsCompressInt(pRaw, numOfSids * sizeof(int32_t), numOfSids, pList->data, sidBound,
+                                 TWO_STAGE_COMP, pTemp, sidBound);
+
+  // tags are laid out column by column, values of the same tag compress better
+  int32_t compTagLen = 0;
+  if (tagLen > 0) {
+    char *p = pRaw;
+    for (int32_t j = 0; j < pInfo->numOfTags; ++j) {
+      int32_t offset = (pInfo->tagCols[j] == -1) ? -1 : mgmtGetTagsLength(pMetric, pInfo->tagCols[j]);
+
+      for (int32_t i = 0; i < numOfSids; ++i, p += tagBytes[j]) {
+        pMeter = mgmtGetResultPayload(pRes, start + i);
+        if (offset == -1) {
+          char name[TSDB_METER_NAME_LEN] = {0};
+          extractMeterName(pMeter->meterId, name);
+          memcpy(p, name, TSDB_METER_NAME_LEN);
+        } else {
+          memcpy(p, pMeter->pTagData + TSDB_METER_ID_LEN + offset, (size_t)tagBytes[j]);
+        }
+      }
+    }
 
-  int ovgId = -1;
+    assert(p - pRaw == numOfSids * tagLen);
+    compTagLen = tsCompressString(pRaw, numOfSids * tagLen, numOfSids, pList->data + sidLen, tagBound,
+                                  ONE_STAGE_COMP, NULL, 0);
+  }
 
-  tQueryResultset result = {0};
-  int             ret = mgmtRetrieveMetersFromMetric(pMetric, pMetricMetaMsg, &result);
+  pList->sidLen = htonl(sidLen);
+  pList->tagLen = htonl(compTagLen);
+  *len += sizeof(SVnodeSidListRsp) + sidLen + compTagLen;
+
+  free(pRaw);
+  free(pTemp);
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the response is built vnode by vnode, only the sids and tags of one vnode are kept uncompressed
+ * at the same time. The blocks of all vnodes are still sent in one response, since the client
+ * launches the sub-queries after the whole metric meta is cached, see tscProcessMetricMetaRsp
+ */
+static int32_t mgmtBuildMetricMetaRsp(STabObj *pMetric, SMetricMetaMsg *pInfo, tQueryResultset *pRes,
+                                      int32_t tagLen, char **pBuf, int32_t *len) {
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+  int32_t  capacity = sizeof(SMetricMetaRsp) + sizeof(int16_t) * pInfo->numOfTags + 1024;
 
-  int rspMsgSize = 512;
-  if (ret == TSDB_CODE_SUCCESS) {
-    rspMsgSize = mgmtGetMetricMetaMsgSize(&result, tagLen, maxMetersPerVNodeInQuery);
+  *pBuf = malloc((size_t)capacity);
+  if (*pBuf == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
   }
 
-  *pStart = taosBuildRspMsgWithSize(thandle, TSDB_MSG_TYPE_METRIC_META_RSP, rspMsgSize);
-  if (*pStart == NULL) return 0;
+  int16_t tagBytes[TSDB_MAX_TAGS + 1] = {0};
 
-  char *    pMsg = (*pStart);
-  STaosRsp *pRsp = (STaosRsp *)pMsg;
+  SMetricMetaRsp *pMeta = (SMetricMetaRsp *)(*pBuf);
+  for (int32_t j = 0; j < pInfo->numOfTags; ++j) {
+    tagBytes[j] = (pInfo->tagCols[j] == -1) ? TSDB_METER_NAME_LEN : pTagSchema[pInfo->tagCols[j]].bytes;
+    pMeta->tagBytes[j] = htons(tagBytes[j]);
+  }
 
-  pRsp->code = ret;
-  pMsg += sizeof(STaosRsp);
-  *pMsg = TSDB_IE_TYPE_META;
-  pMsg++;
+  *len = sizeof(SMetricMetaRsp) + sizeof(int16_t) * pInfo->numOfTags;
 
-  if (ret != TSDB_CODE_SUCCESS) {
-    return pMsg - (*pStart);  // one bit in payload
+  int32_t numOfVnodes = 0;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  for (int32_t start = 0, end = 0; start < pRes->num && code == TSDB_CODE_SUCCESS; start = end) {
+    int32_t vgId = mgmtGetResultPayload(pRes, start)->gid.vgId;
+    for (end = start + 1; end < pRes->num && mgmtGetResultPayload(pRes, end)->gid.vgId == vgId; ++end) {
+    }
+
+    code = mgmtBuildVnodeSidList(pMetric, pRes, start, end, pInfo, tagBytes, tagLen, pBuf, &capacity, len);
+    numOfVnodes++;
   }
 
-  SMetricMeta *pMeta = (SMetricMeta *)pMsg;
+  if (code != TSDB_CODE_SUCCESS) {
+    tfree(*pBuf);
+    return code;
+  }
 
-  pMeta->numOfMeters = 0;
-  pMeta->numOfVnodes = 0;
+  pMeta = (SMetricMetaRsp *)(*pBuf);
+  pMeta->numOfMeters = htonl((int32_t)pRes->num);
+  pMeta->numOfVnodes = htonl(numOfVnodes);
   pMeta->tagLen = htons((uint16_t)tagLen);
+  pMeta->numOfTags = htons(pInfo->numOfTags);
+
+  return TSDB_CODE_SUCCESS;
+}
 
-  pMsg = (char *)pMeta + sizeof(SMetricMeta);
+/*
+ * the tag condition is evaluated by vnodes, only the vnodes of metric are returned without sids and tags
+ */
+static int32_t mgmtBuildMetricVnodesRsp(STabObj *pMetric, SMetricMetaMsg *pInfo, int32_t tagLen, char **pBuf,
+                                        int32_t *len) {
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+
+  pthread_rwlock_rdlock(&(pMetric->rwLock));
+
+  int32_t   numOfMeters = 0;
+  STabObj **pMeters = (STabObj **)malloc(sizeof(STabObj *) * (pMetric->numOfMeters + 1));
+  if (pMeters == NULL) {
+    pthread_rwlock_unlock(&(pMetric->rwLock));
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  for (STabObj *pMeter = pMetric->pHead; pMeter != NULL && numOfMeters <= pMetric->numOfMeters; pMeter = pMeter->next) {
+    pMeters[numOfMeters++] = pMeter;
+  }
 
-  // char* start = pMsg;
-  for (int32_t i = 0; i < result.num; ++i) {
-    STabObj *pMeter = mgmtGetResultPayload(&result, i);
+  pthread_rwlock_unlock(&(pMetric->rwLock));
+
+  qsort(pMeters, (size_t)numOfMeters, POINTER_BYTES, mgmtCompareMeterVgId);
+
+  int32_t capacity = sizeof(SMetricMetaRsp) + sizeof(int16_t) * pInfo->numOfTags + sizeof(SVnodeSidListRsp) * numOfMeters;
+  *pBuf = malloc((size_t)capacity);
+  if (*pBuf == NULL) {
+    free(pMeters);
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
 
-#ifdef _DEBUG_VIEW
-    mTrace("vgid: %d, sid: %d", pMeter->gid.vgId, pMeter->gid.sid);
-#endif
-    pMsg = mgmtBuildMetricMetaMsg(pMeter, &ovgId, &pList, pMeta, tagLen, pMetricMetaMsg->numOfTags,
-                                  pMetricMetaMsg->tagCols, maxMetersPerVNodeInQuery, pMsg);
+  SMetricMetaRsp *pMeta = (SMetricMetaRsp *)(*pBuf);
+  for (int32_t j = 0; j < pInfo->numOfTags; ++j) {
+    int16_t bytes = (pInfo->tagCols[j] == -1) ? TSDB_METER_NAME_LEN : pTagSchema[pInfo->tagCols[j]].bytes;
+    pMeta->tagBytes[j] = htons(bytes);
   }
 
-  // char* output = malloc(pMsg - (*pStart));
-  //  int32_t len = tsCompressString(start, pMsg - start, 0, output, 2, NULL);
+  *len = sizeof(SMetricMetaRsp) + sizeof(int16_t) * pInfo->numOfTags;
+
+  int32_t numOfVnodes = 0;
+  for (int32_t start = 0, end = 0; start < numOfMeters; start = end) {
+    for (end = start + 1; end < numOfMeters && pMeters[end]->gid.vgId == pMeters[start]->gid.vgId; ++end) {
+    }
 
-  int32_t msgLen = pMsg - (*pStart);
-  mTrace("metric:%s metric-meta tables:%d, vnode:%d, msg size %d", pMetric->meterId, pMeta->numOfMeters,
-         pMeta->numOfVnodes, msgLen);
+    SVgObj *pVgroup = mgmtGetVgroup(pMeters[start]->gid.vgId);
+    if (pVgroup == NULL) continue;
 
-  pMeta->numOfMeters = htonl(pMeta->numOfMeters);
-  pMeta->numOfVnodes = htonl(pMeta->numOfVnodes);
+    SVnodeSidListRsp *pList = (SVnodeSidListRsp *)(*pBuf + *len);
+    pList->vnode = htonl(pVgroup->vnodeGid[0].vnode);
+    pList->numOfSids = 0;
+    pList->sidLen = 0;
+    pList->tagLen = 0;
+
+    *len += sizeof(SVnodeSidListRsp);
+    numOfVnodes++;
+  }
+
+  pMeta->numOfMeters = htonl(numOfMeters);
+  pMeta->numOfVnodes = htonl(numOfVnodes);
+  pMeta->tagLen = htons((uint16_t)tagLen);
+  pMeta->numOfTags = htons(pInfo->numOfTags);
+
+  free(pMeters);
+  return TSDB_CODE_SUCCESS;
+}
+
+int mgmtRetrieveMetricMeta(void *thandle, char **pStart, STabObj *pMetric, SMetricMetaMsg *pMetricMetaMsg) {
+  int32_t tagLen = mgmtGetReqTagsLength(pMetric, (int16_t *)pMetricMetaMsg->tagCols, pMetricMetaMsg->numOfTags);
+
+  tQueryResultset result = {0};
+  char *          pBody = NULL;
+  int32_t         bodyLen = 0;
+  int             ret = TSDB_CODE_SUCCESS;
+
+  if (pMetricMetaMsg->type == TSQL_STABLE_QTYPE_VNODES) {
+    ret = mgmtBuildMetricVnodesRsp(pMetric, pMetricMetaMsg, tagLen, &pBody, &bodyLen);
+  } else {
+    ret = mgmtRetrieveMetersFromMetric(pMetric, pMetricMetaMsg, &result);
+    if (ret == TSDB_CODE_SUCCESS) {
+      ret = mgmtBuildMetricMetaRsp(pMetric, pMetricMetaMsg, &result, tagLen, &pBody, &bodyLen);
+    }
+  }
 
   tfree(result.pRes);
-  return msgLen;
+
+  int rspMsgSize = 512 + bodyLen;
+
+  *pStart = taosBuildRspMsgWithSize(thandle, TSDB_MSG_TYPE_METRIC_META_RSP, rspMsgSize);
+  if (*pStart == NULL) {
+    tfree(pBody);
+    return 0;
+  }
+
+  char *    pMsg = (*pStart);
+  STaosRsp *pRsp = (STaosRsp *)pMsg;
+
+  pRsp->code = ret;
+  pMsg += sizeof(STaosRsp);
+  *pMsg = TSDB_IE_TYPE_METRIC_META;
+  pMsg++;
+
+  if (ret != TSDB_CODE_SUCCESS) {
+    return pMsg - (*pStart);  // one bit in payload
+  }
+
+  memcpy(pMsg, pBody, (size_t)bodyLen);
+  pMsg += bodyLen;
+
+  SMetricMetaRsp *pMeta = (SMetricMetaRsp *)pBody;
+  mTrace("metric:%s metric-meta tables:%d, vnode:%d, msg size %d", pMetric->meterId, htonl(pMeta->numOfMeters),
+         htonl(pMeta->numOfVnodes), (int32_t)(pMsg - (*pStart)));
+
+  tfree(pBody);
+  return pMsg - (*pStart);
 }
 
 int mgmtRetrieveMeters(SShowObj *pShow, char *data, int rows, SConnObj *pConn) {
@@ -1613,10 +1814,12 @@ int32_t mgmtMeterModifyTagValueByCol(STabObj *pMeter, int col, const char *nCont
     pMeter->isDirty = 1;
     removeMeterFromMetricIndex(pMetric, pMeter);
   }
+  mgmtRemoveMeterFromTagIndex(pMetric, pMeter);
   memcpy(pMeter->pTagData + mgmtGetTagsLength(pMetric, col) + TSDB_METER_ID_LEN, nContent, schema->bytes);
   if (col == 0) {
     addMeterIntoMetricIndex(pMetric, pMeter);
   }
+  mgmtAddMeterIntoTagIndex(pMetric, pMeter);
 
   // Encode the string
   int   size = sizeof(STabObj) + TSDB_MAX_BYTES_PER_ROW + 1;
@@ -1640,6 +1843,13 @@ int32_t mgmtMeterModifyTagValueByCol(STabObj *pMeter, int col, const char *nCont
   }
 
   mTrace("Succeed to modify tag column %d of table %s", col, pMeter->meterId);
+
+  // refresh the tag values replicated in vnode
+  SVgObj *pVgroup = mgmtGetVgroup(pMeter->gid.vgId);
+  if (pVgroup != NULL) {
+    mgmtSendCreateMsgToVnode(pMeter, pVgroup->vnodeGid[0].vnode);
+  }
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -1656,6 +1866,43 @@ int32_t mgmtMeterModifyTagValueByName(STabObj *pMeter, char *tagName, char *nCon
   return mgmtMeterModifyTagValueByCol(pMeter, col, nContent);
 }
 
+/*
+ * the tag values replicated in vnodes are refreshed after the tag schema of metric is changed,
+ * the create msgs of meters in the same vgroup are sent in one batch
+ */
+static void mgmtSendMetricTagsToVnodes(STabObj *pMetric) {
+  pthread_rwlock_rdlock(&(pMetric->rwLock));
+
+  int32_t   numOfMeters = 0;
+  STabObj **pMeters = (STabObj **)malloc(sizeof(STabObj *) * (pMetric->numOfMeters + 1));
+  if (pMeters == NULL) {
+    pthread_rwlock_unlock(&(pMetric->rwLock));
+    mError("metric:%s, failed to allocate memory to refresh tags in vnodes", pMetric->meterId);
+    return;
+  }
+
+  for (STabObj *pMeter = pMetric->pHead; pMeter != NULL && numOfMeters <= pMetric->numOfMeters; pMeter = pMeter->next) {
+    pMeters[numOfMeters++] = pMeter;
+  }
+
+  pthread_rwlock_unlock(&(pMetric->rwLock));
+
+  qsort(pMeters, (size_t)numOfMeters, POINTER_BYTES, mgmtCompareMeterVgId);
+
+  for (int32_t start = 0, end = 0; start < numOfMeters; start = end) {
+    SVgObj *pVgroup = mgmtGetVgroup(pMeters[start]->gid.vgId);
+    for (end = start + 1; end < numOfMeters && pMeters[end]->gid.vgId == pMeters[start]->gid.vgId; ++end) {
+    }
+
+    if (pVgroup != NULL) {
+      mgmtSendMultiCreateMsgToVnode(pMeters + start, end - start, pVgroup->vnodeGid[0].vnode);
+    }
+  }
+
+  mTrace("metric:%s, tags of %d meters are refreshed in vnodes", pMetric->meterId, numOfMeters);
+  free(pMeters);
+}
+
 int32_t mgmtMeterAddTags(STabObj *pMetric, SSchema schema[], int ntags) {
   if (pMetric == NULL || (!mgmtIsMetric(pMetric))) return TSDB_CODE_INVALID_TABLE;
 
@@ -1694,6 +1941,7 @@ int32_t mgmtMeterAddTags(STabObj *pMetric, SSchema schema[], int ntags) {
   }
 
   mTrace("Succeed to add tag column %s to table %s", schema[0].name, pMetric->meterId);
+  mgmtSendMetricTagsToVnodes(pMetric);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -1722,6 +1970,7 @@ int32_t mgmtMeterDropTagByCol(STabObj *pMetric, int col) {
   }
 
   mTrace("Succeed to drop tag column: %d from table: %s", col, pMetric->meterId);
+  mgmtSendMetricTagsToVnodes(pMetric);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -139,39 +139,18 @@ bool mgmtCheckMeterMetaMsgType(char *pMsg) {
   return addIntoTranQueue;
 }
 
-int mgmtProcessMeterMetaMsg(char *pMsg, int msgLen, SConnObj *pConn) {
-  SMeterInfoMsg *pInfo = (SMeterInfoMsg *)pMsg;
-  STabObj *      pMeterObj = NULL;
-  SVgObj *       pVgroup = NULL;
-  SMeterMeta *   pMeta = NULL;
-  SSchema *      pSchema = NULL;
-  STaosRsp *     pRsp = NULL;
-  char *         pStart = NULL;
-
-  pInfo->createFlag = htons(pInfo->createFlag);
-
-  int size = sizeof(STaosHeader) + sizeof(STaosRsp) + sizeof(SMeterMeta) + sizeof(SSchema) * TSDB_MAX_COLUMNS +
-             sizeof(SSchema) * TSDB_MAX_TAGS + TSDB_MAX_TAGS_LEN + TSDB_EXTRA_PAYLOAD_SIZE;
-
-  if (pConn->pDb == NULL || (pConn->pDb != NULL && pConn->pDb->dropStatus != TSDB_DB_STATUS_READY)) {
-    // todo handle failed to allocate msg buffer
-    if ((pStart = mgmtAllocMsg(pConn, size, &pMsg, &pRsp)) == NULL) {
-      return 0;
-    }
-
-    pRsp->code = TSDB_CODE_INVALID_DB;
-    pMsg++;
-
-    goto _exit_code;
-  }
-
-  pMeterObj = mgmtGetMeter(pInfo->meterId);
+/*
+ * get the meter object, the meter is created from super table on demand if it does not exist and
+ * the createFlag is set. The tags of SMeterInfoMsg are in the format of STagData.
+ */
+static int32_t mgmtGetMeterForMetaMsg(SConnObj *pConn, SMeterInfoMsg *pInfo, STabObj **pMeterObj) {
+  *pMeterObj = mgmtGetMeter(pInfo->meterId);
 
   // on demand create table from super table if meter does not exists
-  if (pMeterObj == NULL && pInfo->createFlag == 1) {
+  if (*pMeterObj == NULL && pInfo->createFlag == 1) {
     SCreateTableMsg *pCreateMsg = calloc(1, sizeof(SCreateTableMsg) + sizeof(STagData));
     if (pCreateMsg == NULL) {
-      return 0;
+      return TSDB_CODE_SERV_OUT_OF_MEMORY;
     }
 
     memcpy(pCreateMsg->schema, pInfo->tags, sizeof(STagData));
@@ -187,28 +166,128 @@ int mgmtProcessMeterMetaMsg(char *pMsg, int msgLen, SConnObj *pConn) {
     tfree(pCreateMsg);
 
     if (code != TSDB_CODE_SUCCESS) {
-      if ((pStart = mgmtAllocMsg(pConn, size, &pMsg, &pRsp)) == NULL) {
-        return 0;
+      return code;
+    }
+
+    *pMeterObj = mgmtGetMeter(pInfo->meterId);
+  }
+
+  if (*pMeterObj == NULL) {
+    return (pConn->pDb != NULL) ? TSDB_CODE_INVALID_TABLE : TSDB_CODE_DB_NOT_SELECTED;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/* the max length of meter meta, schema and tags of a meter in meter info response */
+static int32_t mgmtGetMeterMetaSize(STabObj *pMeterObj) {
+  STabObj *pSchemaObj = pMeterObj;
+  if (mgmtMeterCreateFromMetric(pMeterObj)) {
+    pSchemaObj = mgmtGetMeter(pMeterObj->pTagData);
+  }
+
+  int32_t numOfTotalCols = (pSchemaObj == NULL) ? 0 : pSchemaObj->numOfTags + pSchemaObj->numOfColumns;
+  return sizeof(SMeterMeta) + numOfTotalCols * sizeof(SSchema) + TSDB_MAX_TAGS_LEN;
+}
+
+/*
+ * set the meter meta, schema and tag values of a meter into pMsg in network byte order.
+ * The length of output is returned by *len, even if the vgroup of the meter does not exist.
+ */
+static int32_t mgmtSetMeterMeta(char *pMsg, STabObj *pMeterObj, SDbObj *pDb, int32_t *len) {
+  char *      pStart = pMsg;
+  SMeterMeta *pMeta = (SMeterMeta *)pMsg;
+  SSchema *   pSchema = NULL;
+  int32_t     code = TSDB_CODE_SUCCESS;
+
+  pMeta->uid = htobe64(pMeterObj->uid);
+  pMeta->sid = htonl(pMeterObj->gid.sid);
+  pMeta->vgid = htonl(pMeterObj->gid.vgId);
+  pMeta->sversion = htonl(pMeterObj->sversion);
+
+  pMeta->precision = htons(pDb->cfg.precision);
+
+  pMeta->numOfTags = htons(pMeterObj->numOfTags);
+  pMeta->numOfColumns = htons(pMeterObj->numOfColumns);
+  pMeta->meterType = htons(pMeterObj->meterType);
+
+  pMsg += sizeof(SMeterMeta);
+  pSchema = (SSchema *)pMsg;  // schema locates at the end of SMeterMeta struct
+
+  if (mgmtMeterCreateFromMetric(pMeterObj)) {
+    assert(pMeterObj->numOfTags == 0);
+
+    STabObj *pMetric = mgmtGetMeter(pMeterObj->pTagData);
+    uint32_t numOfTotalCols = (uint32_t)pMetric->numOfTags + pMetric->numOfColumns;
+
+    pMeta->numOfTags = htons(pMetric->numOfTags);  // update the numOfTags info
+    mgmtSetSchemaFromMeters(pSchema, pMetric, numOfTotalCols);
+    pMsg += numOfTotalCols * sizeof(SSchema);
+
+    // for meters created from metric, we need the metric tag schema to parse the tag data
+    int32_t tagsLen = mgmtSetMeterTagValue(pMsg, pMetric, pMeterObj);
+
+    pMsg += tagsLen;
+  } else {
+    /*
+     * for metrics, or meters that are not created from metric, set the schema directly
+     * for meters created from metric, we use the schema of metric instead
+     */
+    uint32_t numOfTotalCols = (uint32_t)pMeterObj->numOfTags + pMeterObj->numOfColumns;
+    mgmtSetSchemaFromMeters(pSchema, pMeterObj, numOfTotalCols);
+    pMsg += numOfTotalCols * sizeof(SSchema);
+  }
+
+  if (mgmtIsNormalMeter(pMeterObj)) {
+    SVgObj *pVgroup = mgmtGetVgroup(pMeterObj->gid.vgId);
+    if (pVgroup == NULL) {
+      code = TSDB_CODE_INVALID_TABLE;
+    } else {
+      for (int i = 0; i < TSDB_VNODES_SUPPORT; ++i) {
+        pMeta->vpeerDesc[i].ip = pVgroup->vnodeGid[i].publicIp;
+        pMeta->vpeerDesc[i].vnode = htonl(pVgroup->vnodeGid[i].vnode);
       }
+    }
+  }
+
+  *len = (int32_t)(pMsg - pStart);
+  return code;
+}
+
+int mgmtProcessMeterMetaMsg(char *pMsg, int msgLen, SConnObj *pConn) {
+  SMeterInfoMsg *pInfo = (SMeterInfoMsg *)pMsg;
+  STabObj *      pMeterObj = NULL;
+  STaosRsp *     pRsp = NULL;
+  char *         pStart = NULL;
 
-      pRsp->code = code;
-      pMsg++;
+  pInfo->createFlag = htons(pInfo->createFlag);
+
+  int size = sizeof(STaosHeader) + sizeof(STaosRsp) + sizeof(SMeterMeta) + sizeof(SSchema) * TSDB_MAX_COLUMNS +
+             sizeof(SSchema) * TSDB_MAX_TAGS + TSDB_MAX_TAGS_LEN + TSDB_EXTRA_PAYLOAD_SIZE;
 
-      goto _exit_code;
+  if (pConn->pDb == NULL || (pConn->pDb != NULL && pConn->pDb->dropStatus != TSDB_DB_STATUS_READY)) {
+    // todo handle failed to allocate msg buffer
+    if ((pStart = mgmtAllocMsg(pConn, size, &pMsg, &pRsp)) == NULL) {
+      return 0;
     }
 
-    pMeterObj = mgmtGetMeter(pInfo->meterId);
+    pRsp->code = TSDB_CODE_INVALID_DB;
+    pMsg++;
+
+    goto _exit_code;
+  }
+
+  int32_t code = mgmtGetMeterForMetaMsg(pConn, pInfo, &pMeterObj);
+  if (code == TSDB_CODE_SERV_OUT_OF_MEMORY) {
+    return 0;
   }
 
   if ((pStart = mgmtAllocMsg(pConn, size, &pMsg, &pRsp)) == NULL) {
     return 0;
   }
 
-  if (pMeterObj == NULL) {
-    if (pConn->pDb)
-      pRsp->code = TSDB_CODE_INVALID_TABLE;
-    else
-      pRsp->code = TSDB_CODE_DB_NOT_SELECTED;
+  if (code != TSDB_CODE_SUCCESS) {
+    pRsp->code = code;
     pMsg++;
   } else {
     mTrace("%s, uid:%lld meter meta is retrieved", pInfo->meterId, pMeterObj->uid);
@@ -217,61 +296,163 @@ int mgmtProcessMeterMetaMsg(char *pMsg, int msgLen, SConnObj *pConn) {
     *pMsg = TSDB_IE_TYPE_META;
     pMsg++;
 
-    pMeta = (SMeterMeta *)pMsg;
-    pMeta->uid = htobe64(pMeterObj->uid);
-    pMeta->sid = htonl(pMeterObj->gid.sid);
-    pMeta->vgid = htonl(pMeterObj->gid.vgId);
-    pMeta->sversion = htonl(pMeterObj->sversion);
+    int32_t len = 0;
+    pRsp->code = mgmtSetMeterMeta(pMsg, pMeterObj, pConn->pDb, &len);
+    pMsg += len;
+  }
 
-    pMeta->precision = htons(pConn->pDb->cfg.precision);
+_exit_code:
+  msgLen = pMsg - pStart;
 
-    pMeta->numOfTags = htons(pMeterObj->numOfTags);
-    pMeta->numOfColumns = htons(pMeterObj->numOfColumns);
-    pMeta->meterType = htons(pMeterObj->meterType);
+  taosSendMsgToPeer(pConn->thandle, pStart, msgLen);
 
-    pMsg += sizeof(SMeterMeta);
-    pSchema = (SSchema *)pMsg;  // schema locates at the end of SMeterMeta struct
+  return msgLen;
+}
+
+/**
+ * check if any meter in the multi-meter-meta msg needs to be created on demand, in which case the msg is
+ * added into tranQueue.
+ */
+bool mgmtCheckMultiMeterMetaMsgType(char *pMsg) {
+  SMultiMeterInfoMsg *pInfo = (SMultiMeterInfoMsg *)pMsg;
+  int32_t             numOfMeters = htonl(pInfo->numOfMeters);
+
+  // invalid msg is rejected in mgmtProcessMultiMeterMetaMsg
+  if (numOfMeters <= 0 || numOfMeters > TSDB_MAX_METERS_IN_MULTI_META) {
+    return false;
+  }
 
-    if (mgmtMeterCreateFromMetric(pMeterObj)) {
-      assert(pMeterObj->numOfTags == 0);
+  pMsg = pInfo->meters;
+  for (int32_t i = 0; i < numOfMeters; ++i) {
+    SMeterInfoMsg *pMeterInfo = (SMeterInfoMsg *)pMsg;
+    int16_t        autoCreate = htons(pMeterInfo->createFlag);
 
-      STabObj *pMetric = mgmtGetMeter(pMeterObj->pTagData);
-      uint32_t numOfTotalCols = (uint32_t)pMetric->numOfTags + pMetric->numOfColumns;
+    if (autoCreate == 1 && mgmtGetMeter(pMeterInfo->meterId) == NULL) {
+      mTrace("meter:%s auto created task added, meters in msg:%d", pMeterInfo->meterId, numOfMeters);
+      return true;
+    }
 
-      pMeta->numOfTags = htons(pMetric->numOfTags);  // update the numOfTags info
-      mgmtSetSchemaFromMeters(pSchema, pMetric, numOfTotalCols);
-      pMsg += numOfTotalCols * sizeof(SSchema);
+    pMsg += sizeof(SMeterInfoMsg) + ((autoCreate != 0) ? sizeof(STagData) : 0);
+  }
 
-      // for meters created from metric, we need the metric tag schema to parse the tag data
-      int32_t tagsLen = mgmtSetMeterTagValue(pMsg, pMetric, pMeterObj);
+  return false;
+}
 
-      pMsg += tagsLen;
-    } else {
-      /*
-       * for metrics, or meters that are not created from metric, set the schema directly
-       * for meters created from metric, we use the schema of metric instead
-       */
-      uint32_t numOfTotalCols = (uint32_t)pMeterObj->numOfTags + pMeterObj->numOfColumns;
-      mgmtSetSchemaFromMeters(pSchema, pMeterObj, numOfTotalCols);
-      pMsg += numOfTotalCols * sizeof(SSchema);
+/*
+ * retrieve the meter meta of a list of meters in one request. The failure of one meter does not
+ * affect the others, the error code of each meter is set in SMultiMeterMeta.
+ */
+int mgmtProcessMultiMeterMetaMsg(char *pMsg, int msgLen, SConnObj *pConn) {
+  SMultiMeterInfoMsg *pInfo = (SMultiMeterInfoMsg *)pMsg;
+  STaosRsp *          pRsp = NULL;
+  char *              pStart = NULL;
+
+  int32_t numOfMeters = htonl(pInfo->numOfMeters);
+  int32_t size = sizeof(STaosHeader) + sizeof(STaosRsp) + 1 + sizeof(SMultiMeterMetaRsp) + TSDB_EXTRA_PAYLOAD_SIZE;
+
+  if (pConn->pDb == NULL || pConn->pDb->dropStatus != TSDB_DB_STATUS_READY || numOfMeters <= 0 ||
+      numOfMeters > TSDB_MAX_METERS_IN_MULTI_META) {
+    pStart = taosBuildRspMsgWithSize(pConn->thandle, TSDB_MSG_TYPE_MULTI_METERINFO_RSP, size);
+    if (pStart == NULL) return 0;
+
+    pMsg = pStart;
+    pRsp = (STaosRsp *)pMsg;
+    pRsp->code = (pConn->pDb == NULL || pConn->pDb->dropStatus != TSDB_DB_STATUS_READY) ? TSDB_CODE_INVALID_DB
+                                                                                        : TSDB_CODE_INVALID_MSG_LEN;
+    pMsg++;
+
+    msgLen = pMsg - pStart;
+    taosSendMsgToPeer(pConn->thandle, pStart, msgLen);
+    return msgLen;
+  }
+
+  STabObj **pMeterObjs = calloc(numOfMeters, sizeof(STabObj *));
+  int32_t * pCode = calloc(numOfMeters, sizeof(int32_t));
+  char **   pMeterIds = calloc(numOfMeters, sizeof(char *));
+
+  if (pMeterObjs == NULL || pCode == NULL || pMeterIds == NULL) {
+    tfree(pMeterObjs);
+    tfree(pCode);
+    tfree(pMeterIds);
+    return 0;
+  }
+
+  // retrieve or create all meters first, to get the exact size of response msg
+  char *pInfoMsg = pInfo->meters;
+  char *pEnd = (char *)pInfo + msgLen;
+
+  for (int32_t i = 0; i < numOfMeters; ++i) {
+    SMeterInfoMsg *pMeterInfo = (SMeterInfoMsg *)pInfoMsg;
+    if (pInfoMsg + sizeof(SMeterInfoMsg) > pEnd) {
+      pCode[i] = TSDB_CODE_INVALID_MSG_LEN;
+      continue;
     }
 
-    if (mgmtIsNormalMeter(pMeterObj)) {
-      pVgroup = mgmtGetVgroup(pMeterObj->gid.vgId);
-      if (pVgroup == NULL) {
-        pRsp->code = TSDB_CODE_INVALID_TABLE;
-        goto _exit_code;
-      }
-      for (int i = 0; i < TSDB_VNODES_SUPPORT; ++i) {
-        pMeta->vpeerDesc[i].ip = pVgroup->vnodeGid[i].publicIp;
-        pMeta->vpeerDesc[i].vnode = htonl(pVgroup->vnodeGid[i].vnode);
-      }
+    pMeterInfo->createFlag = htons(pMeterInfo->createFlag);
+    pInfoMsg += sizeof(SMeterInfoMsg) + ((pMeterInfo->createFlag != 0) ? sizeof(STagData) : 0);
+
+    pMeterIds[i] = pMeterInfo->meterId;
+    if (pInfoMsg > pEnd) {
+      pCode[i] = TSDB_CODE_INVALID_MSG_LEN;
+      continue;
+    }
+
+    pCode[i] = mgmtGetMeterForMetaMsg(pConn, pMeterInfo, &pMeterObjs[i]);
+    if (pCode[i] == TSDB_CODE_SUCCESS) {
+      size += mgmtGetMeterMetaSize(pMeterObjs[i]);
     }
   }
 
-_exit_code:
-  msgLen = pMsg - pStart;
+  size += numOfMeters * sizeof(SMultiMeterMeta);
 
+  if ((pStart = taosBuildRspMsgWithSize(pConn->thandle, TSDB_MSG_TYPE_MULTI_METERINFO_RSP, size)) == NULL) {
+    tfree(pMeterObjs);
+    tfree(pCode);
+    tfree(pMeterIds);
+    return 0;
+  }
+
+  pMsg = pStart;
+  pRsp = (STaosRsp *)pMsg;
+  pRsp->code = 0;
+  pMsg += sizeof(STaosRsp);
+  *pMsg = TSDB_IE_TYPE_META;
+  pMsg++;
+
+  SMultiMeterMetaRsp *pMetaRsp = (SMultiMeterMetaRsp *)pMsg;
+  pMetaRsp->numOfMeters = htonl(numOfMeters);
+  pMsg += sizeof(SMultiMeterMetaRsp);
+
+  int32_t numOfFailed = 0;
+  for (int32_t i = 0; i < numOfMeters; ++i) {
+    SMultiMeterMeta *pMeterMeta = (SMultiMeterMeta *)pMsg;
+    memset(pMeterMeta->meterId, 0, TSDB_METER_ID_LEN);
+    if (pMeterIds[i] != NULL) {
+      strncpy(pMeterMeta->meterId, pMeterIds[i], TSDB_METER_ID_LEN - 1);
+    }
+
+    int32_t len = 0;
+    if (pCode[i] == TSDB_CODE_SUCCESS) {
+      pCode[i] = mgmtSetMeterMeta(pMeterMeta->meta, pMeterObjs[i], pConn->pDb, &len);
+    }
+
+    if (pCode[i] != TSDB_CODE_SUCCESS) {
+      len = 0;
+      numOfFailed++;
+    }
+
+    pMeterMeta->code = htonl(pCode[i]);
+    pMeterMeta->metaLen = htonl(len);
+    pMsg += sizeof(SMultiMeterMeta) + len;
+  }
+
+  mTrace("meter meta of %d meters are retrieved in one msg, failed:%d", numOfMeters, numOfFailed);
+
+  tfree(pMeterObjs);
+  tfree(pCode);
+  tfree(pMeterIds);
+
+  msgLen = pMsg - pStart;
   taosSendMsgToPeer(pConn->thandle, pStart, msgLen);
 
   return msgLen;
@@ -672,6 +853,7 @@ int mgmtProcessRetrieveMsg(char *pMsg, int msgLen, SConnObj *pConn) {
 
     pRsp->numOfRows = htonl(rowsRead);
     pRsp->precision = htonl(TSDB_TIME_PRECISION_MILLI);  // millisecond time precision
+    pRsp->compressed = 0;
     pMsg += size;
   }
 
@@ -726,6 +908,90 @@ int mgmtProcessCreateTableMsg(char *pMsg, int msgLen, SConnObj *pConn) {
   return 0;
 }
 
+/*
+ * create a batch of tables in one request, the tables are created in order until the first failure. The code of
+ * the failed table and the number of tables before it are returned in SMultiCreateTableRsp.
+ */
+int mgmtProcessMultiCreateTableMsg(char *pMsg, int msgLen, SConnObj *pConn) {
+  SMultiCreateTableMsg *pMultiCreate = (SMultiCreateTableMsg *)pMsg;
+  SCreateTableMsg **    pCreates = NULL;
+  int                   numOfCreated = 0;
+  int                   code = TSDB_CODE_SUCCESS;
+
+  int32_t numOfTables = htonl(pMultiCreate->numOfTables);
+
+  if (!pConn->writeAuth) {
+    code = TSDB_CODE_NO_RIGHTS;
+  } else if (pConn->pDb == NULL) {
+    code = TSDB_CODE_DB_NOT_SELECTED;
+  } else if (numOfTables <= 0 || numOfTables > TSDB_MAX_TABLES_IN_MULTI_CREATE) {
+    code = TSDB_CODE_INVALID_MSG_LEN;
+  } else if ((pCreates = (SCreateTableMsg **)calloc(numOfTables, sizeof(SCreateTableMsg *))) == NULL) {
+    code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+  } else {
+    char *pEnd = pMsg + msgLen;
+    pMsg = pMultiCreate->tables;
+
+    for (int32_t i = 0; i < numOfTables; ++i) {
+      SCreateTableMsg *pCreate = (SCreateTableMsg *)pMsg;
+      if (pMsg + sizeof(SCreateTableMsg) > pEnd) {
+        code = TSDB_CODE_INVALID_MSG_LEN;
+        break;
+      }
+
+      pCreate->numOfColumns = htons(pCreate->numOfColumns);
+      pCreate->numOfTags = htons(pCreate->numOfTags);
+      pCreate->sqlLen = htons(pCreate->sqlLen);
+
+      int32_t numOfCols = pCreate->numOfColumns + pCreate->numOfTags;
+      if (numOfCols == 0) {
+        pMsg += sizeof(SCreateTableMsg) + sizeof(STagData);
+      } else {
+        pMsg += sizeof(SCreateTableMsg) + numOfCols * sizeof(SSchema) + pCreate->sqlLen;
+      }
+
+      if (pMsg > pEnd) {
+        code = TSDB_CODE_INVALID_MSG_LEN;
+        break;
+      }
+
+      SSchema *pSchema = pCreate->schema;
+      for (int32_t j = 0; j < numOfCols; ++j) {
+        pSchema->bytes = htons(pSchema->bytes);
+        pSchema->colId = j;
+        pSchema++;
+      }
+
+      pCreates[i] = pCreate;
+    }
+
+    if (code == TSDB_CODE_SUCCESS) {
+      code = mgmtCreateMeters(pConn->pDb, pCreates, numOfTables, &numOfCreated);
+      mTrace("%d tables in multi-create msg, %d are created by %s, code:%d", numOfTables, numOfCreated,
+             pConn->pUser->user, code);
+    }
+  }
+
+  tfree(pCreates);
+
+  int   size = sizeof(STaosHeader) + sizeof(STaosRsp) + sizeof(SMultiCreateTableRsp) + TSDB_EXTRA_PAYLOAD_SIZE;
+  char *pStart = taosBuildRspMsgWithSize(pConn->thandle, TSDB_MSG_TYPE_MULTI_CREATE_TABLE_RSP, size);
+  if (pStart == NULL) return 0;
+
+  // the error of tables is returned in rsp body, in which the number of created tables is also carried
+  STaosRsp *pRsp = (STaosRsp *)pStart;
+  pRsp->code = 0;
+
+  SMultiCreateTableRsp *pCreateRsp = (SMultiCreateTableRsp *)pRsp->more;
+  pCreateRsp->code = htonl(code);
+  pCreateRsp->numOfCreated = htonl(numOfCreated);
+
+  msgLen = sizeof(STaosRsp) + sizeof(SMultiCreateTableRsp);
+  taosSendMsgToPeer(pConn->thandle, pStart, msgLen);
+
+  return msgLen;
+}
+
 int mgmtProcessDropTableMsg(char *pMsg, int msgLen, SConnObj *pConn) {
   SDropTableMsg *pDrop = (SDropTableMsg *)pMsg;
   int            code;
@@ -969,6 +1235,7 @@ void *mgmtProcessMsgFromShell(char *msg, void *ahandle, void *thandle) {
 
       // read-only request can be executed concurrently
       if ((pMsg->msgType == TSDB_MSG_TYPE_METERINFO && (!mgmtCheckMeterMetaMsgType(cont))) ||
+          (pMsg->msgType == TSDB_MSG_TYPE_MULTI_METERINFO && (!mgmtCheckMultiMeterMetaMsgType(cont))) ||
           pMsg->msgType == TSDB_MSG_TYPE_METRIC_META || pMsg->msgType == TSDB_MSG_TYPE_RETRIEVE ||
           pMsg->msgType == TSDB_MSG_TYPE_SHOW) {
         (*mgmtProcessShellMsg[pMsg->msgType])(cont, contLen, pConn);
@@ -1003,6 +1270,7 @@ void *mgmtProcessMsgFromShell(char *msg, void *ahandle, void *thandle) {
 
 void mgmtInitProcessShellMsg() {
   mgmtProcessShellMsg[TSDB_MSG_TYPE_METERINFO] = mgmtProcessMeterMetaMsg;
+  mgmtProcessShellMsg[TSDB_MSG_TYPE_MULTI_METERINFO] = mgmtProcessMultiMeterMetaMsg;
   mgmtProcessShellMsg[TSDB_MSG_TYPE_METRIC_META] = mgmtProcessMetricMetaMsg;
   mgmtProcessShellMsg[TSDB_MSG_TYPE_CREATE_DB] = mgmtProcessCreateDbMsg;
   mgmtProcessShellMsg[TSDB_MSG_TYPE_ALTER_DB] = mgmtProcessAlterDbMsg;
@@ -1012,6 +1280,7 @@ void mgmtInitProcessShellMsg() {
   mgmtProcessShellMsg[TSDB_MSG_TYPE_DROP_USER] = mgmtProcessDropUserMsg;
 
   mgmtProcessShellMsg[TSDB_MSG_TYPE_CREATE_TABLE] = mgmtProcessCreateTableMsg;
+  mgmtProcessShellMsg[TSDB_MSG_TYPE_MULTI_CREATE_TABLE] = mgmtProcessMultiCreateTableMsg;
   mgmtProcessShellMsg[TSDB_MSG_TYPE_DROP_TABLE] = mgmtProcessDropTableMsg;
   mgmtProcessShellMsg[TSDB_MSG_TYPE_ALTER_TABLE] = mgmtProcessAlterTableMsg;
 
@@ -0,0 +1,755 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include <assert.h>
+
+#include "mgmt.h"
+#include "mgmtTagIndex.h"
+#include "tschemautil.h"
+#include "tskiplist.h"
+#include "tsql.h"
+
+#define TAG_INDEX_WORD_BITS 64
+#define TAG_INDEX_MIN_SLOTS 256
+
+#define TAG_INDEX_WORDS(bits) (((bits) + TAG_INDEX_WORD_BITS - 1) / TAG_INDEX_WORD_BITS)
+#define TAG_INDEX_SET_BIT(b, i) ((b)[(i) / TAG_INDEX_WORD_BITS] |= (1ULL << ((i) % TAG_INDEX_WORD_BITS)))
+#define TAG_INDEX_CLR_BIT(b, i) ((b)[(i) / TAG_INDEX_WORD_BITS] &= ~(1ULL << ((i) % TAG_INDEX_WORD_BITS)))
+#define TAG_INDEX_GET_BIT(b, i) (((b)[(i) / TAG_INDEX_WORD_BITS] >> ((i) % TAG_INDEX_WORD_BITS)) & 1ULL)
+
+/*
+ * slots of one tag value. A value shared by few meters keeps a sorted slot array, which takes
+ * 32 bits per meter. Once the array is larger than a bitmap over all slots, the value switches
+ * to the bitmap, and switches back when it becomes sparse again.
+ */
+typedef struct STagPosting {
+  int32_t   num;       // number of slots
+  int32_t   capacity;  // capacity of pSlots, or number of words in pBits
+  int32_t * pSlots;    // sorted slots, for sparse values
+  uint64_t *pBits;     // slot bitmap, for dense values
+} STagPosting;
+
+typedef struct STagIndex {
+  pthread_rwlock_t lock;
+  int32_t          numOfTags;
+  tSkipList **     pValueList;  // distinct values of each tag column, node data is STagPosting
+  char **         pColumns;    // columnar copy of tag values, value of a slot is at pColumns[col] + slot * bytes
+  STabObj **       pSlots;      // slot -> meter
+  uint64_t *       pLive;       // bitmap of occupied slots
+  int32_t          numOfSlots;  // high water mark of used slots
+  int32_t          maxSlots;
+  int32_t *        pFreeSlots;
+  int32_t          numOfFree;
+  bool             invalid;  // some meter failed to be added, queries fall back to scan until rebuilt
+} STagIndex;
+
+static void tagPostingToBitmap(STagPosting *pPosting, int32_t maxSlots) {
+  int32_t   nWords = TAG_INDEX_WORDS(maxSlots);
+  uint64_t *pBits = calloc(nWords, sizeof(uint64_t));
+  if (pBits == NULL) return;
+
+  for (int32_t i = 0; i < pPosting->num; ++i) {
+    TAG_INDEX_SET_BIT(pBits, pPosting->pSlots[i]);
+  }
+
+  tfree(pPosting->pSlots);
+  pPosting->pBits = pBits;
+  pPosting->capacity = nWords;
+}
+
+static void tagPostingToArray(STagPosting *pPosting) {
+  int32_t *pSlots = malloc(sizeof(int32_t) * (pPosting->num + 1));
+  if (pSlots == NULL) return;
+
+  int32_t num = 0;
+  for (int32_t i = 0; i < pPosting->capacity; ++i) {
+    uint64_t w = pPosting->pBits[i];
+    while (w != 0) {
+      pSlots[num++] = i * TAG_INDEX_WORD_BITS + __builtin_ctzll(w);
+      w &= (w - 1);
+    }
+  }
+
+  assert(num == pPosting->num);
+  tfree(pPosting->pBits);
+  pPosting->pSlots = pSlots;
+  pPosting->capacity = pPosting->num + 1;
+}
+
+// position of the first element not less than slot
+static int32_t tagPostingLowerBound(STagPosting *pPosting, int32_t slot) {
+  int32_t s = 0, e = pPosting->num;
+  while (s < e) {
+    int32_t mid = s + ((e - s) >> 1);
+    if (pPosting->pSlots[mid] < slot) {
+      s = mid + 1;
+    } else {
+      e = mid;
+    }
+  }
+
+  return s;
+}
+
+static int32_t tagPostingAdd(STagPosting *pPosting, int32_t slot, int32_t maxSlots) {
+  if (pPosting->pBits != NULL) {
+    if (slot >= pPosting->capacity * TAG_INDEX_WORD_BITS) {
+      int32_t   nWords = TAG_INDEX_WORDS(maxSlots);
+      uint64_t *pBits = realloc(pPosting->pBits, nWords * sizeof(uint64_t));
+      if (pBits == NULL) return -1;
+
+      memset(pBits + pPosting->capacity, 0, (nWords - pPosting->capacity) * sizeof(uint64_t));
+      pPosting->pBits = pBits;
+      pPosting->capacity = nWords;
+    }
+
+    if (!TAG_INDEX_GET_BIT(pPosting->pBits, slot)) {
+      TAG_INDEX_SET_BIT(pPosting->pBits, slot);
+      pPosting->num++;
+    }
+    return 0;
+  }
+
+  int32_t pos = tagPostingLowerBound(pPosting, slot);
+  if (pos < pPosting->num && pPosting->pSlots[pos] == slot) {
+    return 0;
+  }
+
+  if (pPosting->num >= pPosting->capacity) {
+    int32_t  capacity = (pPosting->capacity == 0) ? 4 : (pPosting->capacity << 1);
+    int32_t *pSlots = realloc(pPosting->pSlots, sizeof(int32_t) * capacity);
+    if (pSlots == NULL) return -1;
+
+    pPosting->pSlots = pSlots;
+    pPosting->capacity = capacity;
+  }
+
+  memmove(pPosting->pSlots + pos + 1, pPosting->pSlots + pos, sizeof(int32_t) * (pPosting->num - pos));
+  pPosting->pSlots[pos] = slot;
+  pPosting->num++;
+
+  // the array costs 32 bits per slot, which is larger than a bitmap of all slots now
+  if (pPosting->num > TAG_INDEX_WORD_BITS && pPosting->num * 32 > maxSlots) {
+    tagPostingToBitmap(pPosting, maxSlots);
+  }
+
+  return 0;
+}
+
+static void tagPostingRemove(STagPosting *pPosting, int32_t slot) {
+  if (pPosting->pBits != NULL) {
+    if (slot < pPosting->capacity * TAG_INDEX_WORD_BITS && TAG_INDEX_GET_BIT(pPosting->pBits, slot)) {
+      TAG_INDEX_CLR_BIT(pPosting->pBits, slot);
+      pPosting->num--;
+    }
+
+    if (pPosting->num * 64 < pPosting->capacity * TAG_INDEX_WORD_BITS) {
+      tagPostingToArray(pPosting);
+    }
+    return;
+  }
+
+  int32_t pos = tagPostingLowerBound(pPosting, slot);
+  if (pos < pPosting->num && pPosting->pSlots[pos] == slot) {
+    memmove(pPosting->pSlots + pos, pPosting->pSlots + pos + 1, sizeof(int32_t) * (pPosting->num - pos - 1));
+    pPosting->num--;
+  }
+}
+
+static void tagPostingOr(STagPosting *pPosting, uint64_t *pBits, int32_t nWords) {
+  if (pPosting->pBits != NULL) {
+    int32_t n = MIN(nWords, pPosting->capacity);
+    for (int32_t i = 0; i < n; ++i) {
+      pBits[i] |= pPosting->pBits[i];
+    }
+  } else {
+    for (int32_t i = 0; i < pPosting->num; ++i) {
+      TAG_INDEX_SET_BIT(pBits, pPosting->pSlots[i]);
+    }
+  }
+}
+
+static void tagPostingDestroy(STagPosting *pPosting) {
+  if (pPosting == NULL) return;
+
+  tfree(pPosting->pSlots);
+  tfree(pPosting->pBits);
+  free(pPosting);
+}
+
+static void tagIndexClear(STagIndex *pIndex) {
+  for (int32_t i = 0; i < pIndex->numOfTags; ++i) {
+    tSkipList *pList = pIndex->pValueList[i];
+    if (pList == NULL) continue;
+
+    tSkipListNode *pNode = pList->pHead.pForward[0];
+    while (pNode != NULL) {
+      tagPostingDestroy((STagPosting *)pNode->pData);
+      pNode->pData = NULL;
+      pNode = pNode->pForward[0];
+    }
+
+    tSkipListDestroy(&pIndex->pValueList[i]);
+  }
+
+  for (int32_t i = 0; pIndex->pColumns != NULL && i < pIndex->numOfTags; ++i) {
+    tfree(pIndex->pColumns[i]);
+  }
+
+  tfree(pIndex->pValueList);
+  tfree(pIndex->pColumns);
+  tfree(pIndex->pSlots);
+  tfree(pIndex->pLive);
+  tfree(pIndex->pFreeSlots);
+
+  pIndex->numOfTags = 0;
+  pIndex->numOfSlots = 0;
+  pIndex->maxSlots = 0;
+  pIndex->numOfFree = 0;
+}
+
+static int32_t tagIndexInit(STagIndex *pIndex, STabObj *pMetric) {
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+
+  pIndex->numOfTags = pMetric->numOfTags;
+  pIndex->pValueList = calloc(pMetric->numOfTags, POINTER_BYTES);
+  pIndex->pColumns = calloc(pMetric->numOfTags, POINTER_BYTES);
+  if (pIndex->pValueList == NULL || pIndex->pColumns == NULL) {
+    tagIndexClear(pIndex);
+    return -1;
+  }
+
+  for (int32_t i = 0; i < pMetric->numOfTags; ++i) {
+    tSkipListCreate(&pIndex->pValueList[i], MAX_SKIP_LIST_LEVEL, pTagSchema[i].type, pTagSchema[i].bytes,
+                    tSkipListDefaultCompare);
+    if (pIndex->pValueList[i] == NULL) {
+      tagIndexClear(pIndex);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int32_t tagIndexAllocSlot(STagIndex *pIndex, SSchema *pTagSchema) {
+  if (pIndex->numOfFree > 0) {
+    return pIndex->pFreeSlots[--pIndex->numOfFree];
+  }
+
+  if (pIndex->numOfSlots >= pIndex->maxSlots) {
+    int32_t maxSlots = (pIndex->maxSlots == 0) ? TAG_INDEX_MIN_SLOTS : (pIndex->maxSlots << 1);
+
+    STabObj **pSlots = realloc(pIndex->pSlots, POINTER_BYTES * maxSlots);
+    if (pSlots == NULL) return -1;
+    pIndex->pSlots = pSlots;
+
+    int32_t *pFree = realloc(pIndex->pFreeSlots, sizeof(int32_t) * maxSlots);
+    if (pFree == NULL) return -1;
+    pIndex->pFreeSlots = pFree;
+
+    uint64_t *pLive = realloc(pIndex->pLive, TAG_INDEX_WORDS(maxSlots) * sizeof(uint64_t));
+    if (pLive == NULL) return -1;
+
+    int32_t nWords = TAG_INDEX_WORDS(pIndex->maxSlots);
+    memset(pLive + nWords, 0, (TAG_INDEX_WORDS(maxSlots) - nWords) * sizeof(uint64_t));
+    pIndex->pLive = pLive;
+
+    for (int32_t i = 0; i < pIndex->numOfTags; ++i) {
+      char *pCol = realloc(pIndex->pColumns[i], (size_t)maxSlots * pTagSchema[i].bytes);
+      if (pCol == NULL) return -1;
+
+      memset(pCol + (size_t)pIndex->maxSlots * pTagSchema[i].bytes, 0,
+             (size_t)(maxSlots - pIndex->maxSlots) * pTagSchema[i].bytes);
+      pIndex->pColumns[i] = pCol;
+    }
+
+    pIndex->maxSlots = maxSlots;
+  }
+
+  return pIndex->numOfSlots++;
+}
+
+/*
+ * each distinct value owns exactly one node. The value is looked up before put, since tSkipListPut does not
+ * detect the identical key, and a duplicated node would hide the slots of the other one.
+ */
+static STagPosting *tagIndexGetPosting(tSkipList *pList, char *val, SSchema *pSchema, bool create) {
+  tSkipListKey   key = tSkipListCreateKey(pSchema->type, val, pSchema->bytes);
+  tSkipListNode *pNode = tSkipListGetOne(pList, &key);
+
+  if (pNode == NULL && create) {
+    STagPosting *pPosting = calloc(1, sizeof(STagPosting));
+    if (pPosting != NULL && (pNode = tSkipListPut(pList, pPosting, &key, 1)) == NULL) {
+      free(pPosting);
+    }
+  }
+
+  tSkipListDestroyKey(&key);
+  return (pNode == NULL) ? NULL : (STagPosting *)pNode->pData;
+}
+
+static void tagIndexRemoveEmptyValue(tSkipList *pList, char *val, SSchema *pSchema) {
+  tSkipListKey   key = tSkipListCreateKey(pSchema->type, val, pSchema->bytes);
+  tSkipListNode *pNode = tSkipListGetOne(pList, &key);
+
+  if (pNode != NULL && pNode->pData != NULL && ((STagPosting *)pNode->pData)->num == 0) {
+    tagPostingDestroy((STagPosting *)pNode->pData);
+    tSkipListRemoveNode(pList, pNode);
+  }
+
+  tSkipListDestroyKey(&key);
+}
+
+static int32_t tagIndexAddMeter(STagIndex *pIndex, STabObj *pMetric, STabObj *pMeter) {
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+  char *   tags = pMeter->pTagData + TSDB_METER_ID_LEN;
+
+  int32_t slot = tagIndexAllocSlot(pIndex, pTagSchema);
+  if (slot < 0) {
+    mError("metric:%s, failed to alloc tag index slot for meter:%s", pMetric->meterId, pMeter->meterId);
+    return -1;
+  }
+
+  pIndex->pSlots[slot] = pMeter;
+  TAG_INDEX_SET_BIT(pIndex->pLive, slot);
+  pMeter->tagIndexSlot = slot;
+
+  for (int32_t i = 0, offset = 0; i < pIndex->numOfTags; offset += pTagSchema[i++].bytes) {
+    memcpy(pIndex->pColumns[i] + (size_t)slot * pTagSchema[i].bytes, tags + offset, pTagSchema[i].bytes);
+
+    STagPosting *pPosting = tagIndexGetPosting(pIndex->pValueList[i], tags + offset, &pTagSchema[i], true);
+    if (pPosting == NULL || tagPostingAdd(pPosting, slot, pIndex->maxSlots) != 0) {
+      mError("metric:%s, failed to add meter:%s into tag index", pMetric->meterId, pMeter->meterId);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void tagIndexRemoveMeter(STagIndex *pIndex, STabObj *pMetric, STabObj *pMeter) {
+  int32_t slot = pMeter->tagIndexSlot;
+  if (slot < 0 || slot >= pIndex->numOfSlots || pIndex->pSlots[slot] != pMeter) {
+    return;
+  }
+
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+  char *   tags = pMeter->pTagData + TSDB_METER_ID_LEN;
+
+  for (int32_t i = 0, offset = 0; i < pIndex->numOfTags; offset += pTagSchema[i++].bytes) {
+    STagPosting *pPosting = tagIndexGetPosting(pIndex->pValueList[i], tags + offset, &pTagSchema[i], false);
+    if (pPosting == NULL) continue;
+
+    tagPostingRemove(pPosting, slot);
+    if (pPosting->num == 0) {
+      tagIndexRemoveEmptyValue(pIndex->pValueList[i], tags + offset, &pTagSchema[i]);
+    }
+  }
+
+  pIndex->pSlots[slot] = NULL;
+  TAG_INDEX_CLR_BIT(pIndex->pLive, slot);
+  pIndex->pFreeSlots[pIndex->numOfFree++] = slot;
+  pMeter->tagIndexSlot = -1;
+}
+
+void mgmtCreateTagIndex(STabObj *pMetric) {
+  STagIndex *pIndex = calloc(1, sizeof(STagIndex));
+  if (pIndex == NULL) {
+    mError("metric:%s, failed to create tag index, meters are scanned by queries", pMetric->meterId);
+  } else {
+    pthread_rwlock_init(&pIndex->lock, NULL);
+  }
+
+  pMetric->pTagIndex = pIndex;
+}
+
+void mgmtAddMeterIntoTagIndex(STabObj *pMetric, STabObj *pMeter) {
+  STagIndex *pIndex = (STagIndex *)pMetric->pTagIndex;
+  if (pIndex == NULL) return;
+
+  pthread_rwlock_wrlock(&pIndex->lock);
+
+  // the index missing any meter is dropped, and the queries fall back to scan the meters until it is rebuilt
+  if (!pIndex->invalid) {
+    if ((pIndex->pValueList == NULL && tagIndexInit(pIndex, pMetric) != 0) ||
+        tagIndexAddMeter(pIndex, pMetric, pMeter) != 0) {
+      mError("metric:%s, tag index is invalidated", pMetric->meterId);
+      tagIndexClear(pIndex);
+      pIndex->invalid = true;
+    }
+  }
+
+  pthread_rwlock_unlock(&pIndex->lock);
+}
+
+void mgmtRemoveMeterFromTagIndex(STabObj *pMetric, STabObj *pMeter) {
+  STagIndex *pIndex = (STagIndex *)pMetric->pTagIndex;
+  if (pIndex == NULL) return;
+
+  pthread_rwlock_wrlock(&pIndex->lock);
+  if (pIndex->pValueList != NULL) {
+    tagIndexRemoveMeter(pIndex, pMetric, pMeter);
+  }
+  pthread_rwlock_unlock(&pIndex->lock);
+}
+
+void mgmtRebuildTagIndex(STabObj *pMetric) {
+  STagIndex *pIndex = (STagIndex *)pMetric->pTagIndex;
+  if (pIndex == NULL) return;
+
+  pthread_rwlock_wrlock(&pIndex->lock);
+
+  tagIndexClear(pIndex);
+  pIndex->invalid = false;
+
+  if (pMetric->pHead != NULL) {
+    if (tagIndexInit(pIndex, pMetric) != 0) {
+      pIndex->invalid = true;
+    }
+
+    for (STabObj *pMeter = pMetric->pHead; !pIndex->invalid && pMeter != NULL; pMeter = pMeter->next) {
+      pIndex->invalid = (tagIndexAddMeter(pIndex, pMetric, pMeter) != 0);
+    }
+
+    if (pIndex->invalid) {
+      mError("metric:%s, failed to rebuild tag index", pMetric->meterId);
+      tagIndexClear(pIndex);
+    }
+  }
+
+  pthread_rwlock_unlock(&pIndex->lock);
+
+  mTrace("metric:%s, tag index is rebuilt, numOfTags:%d numOfMeters:%d", pMetric->meterId, pMetric->numOfTags,
+         pMetric->numOfMeters);
+}
+
+void mgmtDestroyTagIndex(STabObj *pMetric) {
+  STagIndex *pIndex = (STagIndex *)pMetric->pTagIndex;
+  if (pIndex == NULL) return;
+
+  pthread_rwlock_wrlock(&pIndex->lock);
+  tagIndexClear(pIndex);
+  pthread_rwlock_unlock(&pIndex->lock);
+
+  pthread_rwlock_destroy(&pIndex->lock);
+  free(pIndex);
+  pMetric->pTagIndex = NULL;
+}
+
+/*
+ * kernels that compare one tag column against a constant. Each word of the candidate bitmap covers
+ * 64 consecutive slots, the comparison of the slots in a word is done without branches so that the
+ * compiler is able to vectorize the loop, and the words without any candidate are skipped.
+ */
+#define TAG_KERNEL_LOOP(T, VT, OP)                                               \
+  do {                                                                           \
+    const T *p = (const T *)pCol;                                                \
+    for (int32_t i = 0; i < nWords; ++i) {                                       \
+      if (pCand[i] == 0) {                                                       \
+        pOut[i] = 0;                                                             \
+        continue;                                                                \
+      }                                                                          \
+      const T *pw = p + i * TAG_INDEX_WORD_BITS;                                 \
+      uint64_t m = 0;                                                            \
+      for (int32_t j = 0; j < TAG_INDEX_WORD_BITS; ++j) {                        \
+        m |= ((uint64_t)((VT)pw[j] OP v)) << j;                                  \
+      }                                                                          \
+      pOut[i] = m & pCand[i];                                                    \
+    }                                                                            \
+  } while (0)
+
+#define DEFINE_TAG_KERNEL(name, T, VT)                                                                           \
+  static void name(const char *pCol, VT v, uint8_t optr, uint64_t *pCand, uint64_t *pOut, int32_t nWords) {    \
+    switch (optr) {                                                                                              \
+      case TSDB_RELATION_EQUAL:                                                                                  \
+        TAG_KERNEL_LOOP(T, VT, ==);                                                                              \
+        break;                                                                                                   \
+      case TSDB_RELATION_NOT_EQUAL:                                                                              \
+        TAG_KERNEL_LOOP(T, VT, !=);                                                                              \
+        break;                                                                                                   \
+      case TSDB_RELATION_LARGE:                                                                                  \
+        TAG_KERNEL_LOOP(T, VT, >);                                                                               \
+        break;                                                                                                   \
+      case TSDB_RELATION_LARGE_EQUAL:                                                                            \
+        TAG_KERNEL_LOOP(T, VT, >=);                                                                              \
+        break;                                                                                                   \
+      case TSDB_RELATION_LESS:                                                                                   \
+        TAG_KERNEL_LOOP(T, VT, <);                                                                               \
+        break;                                                                                                   \
+      case TSDB_RELATION_LESS_EQUAL:                                                                             \
+        TAG_KERNEL_LOOP(T, VT, <=);                                                                              \
+        break;                                                                                                   \
+      default:                                                                                                   \
+        memset(pOut, 0, nWords * sizeof(uint64_t));                                                              \
+    }                                                                                                            \
+  }
+
+DEFINE_TAG_KERNEL(tagKernelTinyInt, int8_t, int64_t)
+DEFINE_TAG_KERNEL(tagKernelSmallInt, int16_t, int64_t)
+DEFINE_TAG_KERNEL(tagKernelInt, int32_t, int64_t)
+DEFINE_TAG_KERNEL(tagKernelBigInt, int64_t, int64_t)
+DEFINE_TAG_KERNEL(tagKernelTinyIntD, int8_t, double)
+DEFINE_TAG_KERNEL(tagKernelSmallIntD, int16_t, double)
+DEFINE_TAG_KERNEL(tagKernelIntD, int32_t, double)
+DEFINE_TAG_KERNEL(tagKernelBigIntD, int64_t, double)
+DEFINE_TAG_KERNEL(tagKernelFloat, float, double)
+DEFINE_TAG_KERNEL(tagKernelDouble, double, double)
+
+/*
+ * scan the columnar tag values of the candidate slots. Return false if the filter can not be
+ * evaluated on the column store
+ */
+static bool tagColumnScan(STagIndex *pIndex, SSchema *pSchema, tQueryInfo *pInfo, uint64_t *pCand, uint64_t *pOut,
+                          int32_t nWords) {
+  const char *pCol = pIndex->pColumns[pInfo->colIdx];
+  uint8_t     optr = pInfo->optr;
+  bool        isInt = (pInfo->q.nType >= TSDB_DATA_TYPE_BOOL && pInfo->q.nType <= TSDB_DATA_TYPE_BIGINT);
+  double      dv = isInt ? (double)pInfo->q.i64Key : pInfo->q.dKey;
+
+  switch (pSchema->type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+      isInt ? tagKernelTinyInt(pCol, pInfo->q.i64Key, optr, pCand, pOut, nWords)
+            : tagKernelTinyIntD(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_SMALLINT:
+      isInt ? tagKernelSmallInt(pCol, pInfo->q.i64Key, optr, pCand, pOut, nWords)
+            : tagKernelSmallIntD(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_INT:
+      isInt ? tagKernelInt(pCol, pInfo->q.i64Key, optr, pCand, pOut, nWords)
+            : tagKernelIntD(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_BIGINT:
+      isInt ? tagKernelBigInt(pCol, pInfo->q.i64Key, optr, pCand, pOut, nWords)
+            : tagKernelBigIntD(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_FLOAT:
+      tagKernelFloat(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_DOUBLE:
+      tagKernelDouble(pCol, dv, optr, pCand, pOut, nWords);
+      return true;
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR: {
+      if (pInfo->q.nType != pSchema->type) return false;
+
+      memset(pOut, 0, nWords * sizeof(uint64_t));
+      for (int32_t i = 0; i < nWords; ++i) {
+        uint64_t w = pCand[i];
+        while (w != 0) {
+          int32_t slot = i * TAG_INDEX_WORD_BITS + __builtin_ctzll(w);
+          w &= (w - 1);
+
+          int32_t ret = pInfo->comparator(pCol + (size_t)slot * pSchema->bytes, pInfo->q.pz);
+          bool    qualified = false;
+          switch (optr) {
+            case TSDB_RELATION_EQUAL:
+            case TSDB_RELATION_LIKE:
+              qualified = (ret == 0);
+              break;
+            case TSDB_RELATION_NOT_EQUAL:
+              qualified = (ret != 0);
+              break;
+            case TSDB_RELATION_LARGE:
+              qualified = (ret > 0);
+              break;
+            case TSDB_RELATION_LARGE_EQUAL:
+              qualified = (ret >= 0);
+              break;
+            case TSDB_RELATION_LESS:
+              qualified = (ret < 0);
+              break;
+            case TSDB_RELATION_LESS_EQUAL:
+              qualified = (ret <= 0);
+              break;
+          }
+
+          if (qualified) {
+            TAG_INDEX_SET_BIT(pOut, slot);
+          }
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+static bool tagIsExprNode(tSQLBinaryExpr *pExpr) {
+  return pExpr->pLeft->nodeType == TSQL_NODE_EXPR || pExpr->pRight->nodeType == TSQL_NODE_EXPR;
+}
+
+/*
+ * the tbname and LIKE filters have no index, they are evaluated by scanning the candidate meters
+ */
+static bool tagIndexCanServe(tSQLBinaryExpr *pExpr) {
+  if (tagIsExprNode(pExpr)) {
+    return true;
+  }
+
+  return pExpr->nSQLBinaryOptr != TSDB_RELATION_LIKE && pExpr->nSQLBinaryOptr != TSDB_RELATION_NOT_EQUAL &&
+         strcasecmp(pExpr->pLeft->pSchema->name, TSQL_TBNAME_L) != 0;
+}
+
+/*
+ * a leaf is served by the inverted index when it filters all meters, e.g., the first operand of AND
+ * operation. Otherwise, the column store is scanned for the remaining candidates, which avoids
+ * the union of the slot sets of many tag values.
+ */
+static void tagIndexFilterLeaf(STagIndex *pIndex, tSQLBinaryExpr *pExpr, SSchema *pTagSchema, uint64_t *pCand,
+                               uint64_t *pOut, int32_t nWords) {
+  tQueryInfo info = {0};
+  tSQLListTraversePrepare(&info, pTagSchema, pIndex->numOfTags, pExpr->pLeft->pSchema, pExpr->nSQLBinaryOptr,
+                          pExpr->pRight->pVal);
+
+  bool hasCol = (info.colIdx >= 0 && info.colIdx < pIndex->numOfTags);
+  bool useIndex = hasCol && tagIndexCanServe(pExpr) &&
+                  (pCand == pIndex->pLive || info.optr == TSDB_RELATION_EQUAL);
+
+  if (useIndex) {
+    tSkipListNode **pNodes = NULL;
+    int32_t         num = tSQLIndexQuery(pIndex->pValueList[info.colIdx], &info, &pNodes);
+
+    memset(pOut, 0, nWords * sizeof(uint64_t));
+    for (int32_t i = 0; i < num; ++i) {
+      tagPostingOr((STagPosting *)pNodes[i]->pData, pOut, nWords);
+    }
+
+    for (int32_t i = 0; i < nWords; ++i) {
+      pOut[i] &= pCand[i];
+    }
+
+    tfree(pNodes);
+  } else if (!hasCol || !tagColumnScan(pIndex, &pTagSchema[info.colIdx], &info, pCand, pOut, nWords)) {
+    tSkipListNode node = {0};
+
+    memset(pOut, 0, nWords * sizeof(uint64_t));
+    for (int32_t i = 0; i < nWords; ++i) {
+      uint64_t w = pCand[i];
+      while (w != 0) {
+        int32_t slot = i * TAG_INDEX_WORD_BITS + __builtin_ctzll(w);
+        w &= (w - 1);
+
+        node.pData = (char *)pIndex->pSlots[slot];
+        if (tSQLElemFilterCallback(&node, &info)) {
+          TAG_INDEX_SET_BIT(pOut, slot);
+        }
+      }
+    }
+  }
+
+  tVariantDestroy(&info.q);
+}
+
+/*
+ * the result is always a subset of the candidate bitmap, so the filter without index
+ * on one side of an AND operation only checks the meters that pass the other side
+ */
+static int32_t tagIndexEvalExpr(STagIndex *pIndex, tSQLBinaryExpr *pExpr, SSchema *pTagSchema, uint64_t *pCand,
+                                uint64_t *pOut, int32_t nWords) {
+  tSQLSyntaxNode *pLeft = pExpr->pLeft;
+  tSQLSyntaxNode *pRight = pExpr->pRight;
+
+  if (!tagIsExprNode(pExpr)) {
+    assert(pLeft->nodeType == TSQL_NODE_COL && pRight->nodeType == TSQL_NODE_VALUE);
+    tagIndexFilterLeaf(pIndex, pExpr, pTagSchema, pCand, pOut, nWords);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  tSQLBinaryExpr *pFirst = pLeft->pExpr;
+  tSQLBinaryExpr *pSec = pRight->pExpr;
+
+  uint64_t *pTemp = malloc(nWords * sizeof(uint64_t));
+  if (pTemp == NULL) {
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pExpr->nSQLBinaryOptr == TSDB_RELATION_AND) {
+    if (!tagIndexCanServe(pFirst) && tagIndexCanServe(pSec)) {
+      pFirst = pRight->pExpr;
+      pSec = pLeft->pExpr;
+    }
+
+    code = tagIndexEvalExpr(pIndex, pFirst, pTagSchema, pCand, pTemp, nWords);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = tagIndexEvalExpr(pIndex, pSec, pTagSchema, pTemp, pOut, nWords);
+    }
+  } else if (pExpr->nSQLBinaryOptr == TSDB_RELATION_OR) {
+    code = tagIndexEvalExpr(pIndex, pFirst, pTagSchema, pCand, pOut, nWords);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = tagIndexEvalExpr(pIndex, pSec, pTagSchema, pCand, pTemp, nWords);
+    }
+
+    for (int32_t i = 0; code == TSDB_CODE_SUCCESS && i < nWords; ++i) {
+      pOut[i] |= pTemp[i];
+    }
+  } else {
+    code = TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  free(pTemp);
+  return code;
+}
+
+int32_t mgmtQueryTagIndex(STabObj *pMetric, tSQLBinaryExpr *pExpr, tQueryResultset *pRes) {
+  STagIndex *pIndex = (STagIndex *)pMetric->pTagIndex;
+  if (pIndex == NULL) {
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  pthread_rwlock_rdlock(&pIndex->lock);
+
+  if (pIndex->invalid || pIndex->pValueList == NULL || pIndex->numOfTags != pMetric->numOfTags) {
+    pthread_rwlock_unlock(&pIndex->lock);
+    return TSDB_CODE_OPS_NOT_SUPPORT;
+  }
+
+  SSchema *pTagSchema = (SSchema *)(pMetric->schema + pMetric->numOfColumns * sizeof(SSchema));
+  int32_t  nWords = TAG_INDEX_WORDS(pIndex->numOfSlots);
+  uint64_t *pOut = calloc(nWords + 1, sizeof(uint64_t));
+
+  int32_t code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+  if (pOut != NULL) {
+    code = tagIndexEvalExpr(pIndex, pExpr, pTagSchema, pIndex->pLive, pOut, nWords);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    int64_t num = 0;
+    for (int32_t i = 0; i < nWords; ++i) {
+      num += __builtin_popcountll(pOut[i]);
+    }
+
+    pRes->nodeType = TAST_NODE_TYPE_METER_PTR;
+    pRes->num = 0;
+    pRes->pRes = malloc(POINTER_BYTES * (num + 1));
+
+    for (int32_t i = 0; pRes->pRes != NULL && i < nWords; ++i) {
+      uint64_t w = pOut[i];
+      while (w != 0) {
+        pRes->pRes[pRes->num++] = pIndex->pSlots[i * TAG_INDEX_WORD_BITS + __builtin_ctzll(w)];
+        w &= (w - 1);
+      }
+    }
+  }
+
+  pthread_rwlock_unlock(&pIndex->lock);
+
+  tfree(pOut);
+  return code;
+}
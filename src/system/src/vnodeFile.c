@@ -27,6 +27,7 @@
 #include "tutil.h"
 #include "vnode.h"
 #include "vnodeFile.h"
+#include "vnodeRollup.h"
 #include "vnodeUtil.h"
 
 #define FILE_QUERY_NEW_BLOCK -5  // a special negative number
@@ -172,6 +173,9 @@ int vnodeCreateEmptyCompFile(int vnode, int fileId) {
   vnodeCreateFileHeaderFd(tfd);
   close(tfd);
 
+  // the data committed into the file are not aggregated if rollup files fail to be created, no need to abort
+  vnodeCreateEmptyRollupFiles(vnode, fileId);
+
   return 0;
 }
 
@@ -379,6 +383,7 @@ void vnodeRemoveFile(int vnode, int fileId) {
   remove(dHeadName);
   remove(dDataName);
   remove(dLastName);
+  vnodeRemoveRollupFiles(vnode, fileId);
 
   dTrace("vid:%d fileId:%d on disk: %s is removed, numOfFiles:%d maxFiles:%d", vnode, fileId, tsDirectory,
          pVnode->numOfFiles, pVnode->maxFiles);
@@ -469,6 +474,7 @@ void *vnodeCommitMultiToFile(SVnodeObj *pVnode, int ssid, int esid) {
   TSCKSUM          chksum;
   SVnodeHeadInfo   headInfo;
   uint8_t *        pOldCompBlocks;
+  void *           pRollup = NULL;
 
   dPrint("vid:%d, committing to file, firstKey:%ld lastKey:%ld ssid:%d esid:%d", vnode, pVnode->firstKey,
          pVnode->lastKey, ssid, esid);
@@ -613,6 +619,9 @@ _again:
       }
     }
   }
+
+  pRollup = vnodeInitRollupCommit(pVnode, pVnode->commitFileId, meterInfo);
+
   // Loop To write data to fileId
   for (sid = ssid; sid <= esid; ++sid) {
     pObj = (SMeterObj *)(pVnode->meterList[sid]);
@@ -711,6 +720,7 @@ _again:
       headInfo.totalStorage += ((pointsRead - pointsReadLast) * pObj->bytesPerPoint);
       pCompBlock->last = 1;
       if (vnodeWriteBlockToFile(pObj, pCompBlock, data, cdata, pointsRead) < 0) goto _over;
+      vnodeRollupBlock(pRollup, pObj, data, pointsRead);
       if (pCompBlock->keyLast > pObj->lastKeyOnFile) pObj->lastKeyOnFile = pCompBlock->keyLast;
       pMeter->last = pCompBlock->last;
 
@@ -837,6 +847,12 @@ _again:
 
   tfree(pOldCompBlocks);
   dTrace("vid:%d, finish writing the new header file:%s", vnode, pVnode->nfn);
+
+  // rollups are saved before the head file, the rows committed again after a crash are skipped by rollups
+  vnodeSaveRollups(pRollup);
+  vnodeCleanUpRollupCommit(pRollup);
+  pRollup = NULL;
+
   vnodeCloseCommitFiles(pVnode);
 
   for (sid = ssid; sid <= esid; ++sid) {
@@ -864,6 +880,7 @@ _over:
   memset(&(vnodeList[vnode].commitThread), 0, sizeof(vnodeList[vnode].commitThread));
   tfree(buffer);
   tfree(pOldCompBlocks);
+  vnodeCleanUpRollupCommit(pRollup);
 
   dPrint("vid:%d, committing is over", vnode);
 
@@ -1159,6 +1176,154 @@ int vnodeReadLastBlockToMem(SMeterObj *pObj, SCompBlock *pBlock, SData *sdata[])
   return code;
 }
 
+/*
+ * read the last point of a block into pRow in the format of submit msg, the columns absent in block are set null.
+ */
+static int vnodeReadLastRowInBlock(SMeterObj *pObj, int fd, SCompBlock *pBlock, char *pRow) {
+  SField *pFields = NULL;
+  char *  buffer = NULL;
+  int     bufferSize = 0;
+  int     code = 0;
+
+  int   dataSize = pObj->maxBytes * pBlock->numOfPoints + EXTRA_BYTES;
+  char *data = malloc(dataSize);
+  char *temp = malloc(pObj->bytesPerPoint * (pBlock->numOfPoints + 1));
+  if (pBlock->algorithm == TWO_STAGE_COMP) {
+    bufferSize = dataSize;
+    buffer = (char *)calloc(1, bufferSize);
+  }
+
+  // the last row is not cached if memory is not enough
+  if (data == NULL || temp == NULL || (bufferSize > 0 && buffer == NULL)) {
+    dError("vid:%d sid:%d id:%s, failed to allocate memory to read last row", pObj->vnode, pObj->sid, pObj->meterId);
+    tfree(buffer);
+    tfree(temp);
+    tfree(data);
+    return -1;
+  }
+
+  // read the SField of block first
+  code = vnodeReadColumnToMem(fd, pBlock, &pFields, 0, NULL, 0, NULL, buffer, bufferSize);
+
+  int offset = 0;
+  for (int i = 0, col = 0; i < pObj->numOfColumns && code == 0; ++i) {
+    SColumn *pSchema = pObj->schema + i;
+
+    while (col < pBlock->numOfCols && pFields[col].colId < pSchema->colId) ++col;
+
+    if (col < pBlock->numOfCols && pFields[col].colId == pSchema->colId && pFields[col].bytes == pSchema->bytes) {
+      code = vnodeReadColumnToMem(fd, pBlock, &pFields, col, data, dataSize, temp, buffer, bufferSize);
+      memcpy(pRow + offset, data + (pBlock->numOfPoints - 1) * pSchema->bytes, pSchema->bytes);
+    } else {
+      setNull(pRow + offset, pSchema->type, pSchema->bytes);
+    }
+
+    offset += pSchema->bytes;
+  }
+
+  tfree(pFields);
+  tfree(buffer);
+  tfree(temp);
+  tfree(data);
+  return code;
+}
+
+/*
+ * rebuild the last row of meters from the last block of the file where their lastKeyOnFile resides. Each head file
+ * is read once for all meters. The rows in commit log are kept later when they are restored by insertion.
+ */
+int vnodeRestoreLastRows(int vnode) {
+  char         headName[TSDB_FILENAME_LEN];
+  char         dataName[TSDB_FILENAME_LEN];
+  char         lastName[TSDB_FILENAME_LEN];
+  SCompInfo    compInfo;
+  TSCKSUM      chksum;
+  SVnodeObj *  pVnode = vnodeList + vnode;
+  SVnodeCfg *  pCfg = &pVnode->cfg;
+  SCompBlock * pBlocks = NULL;
+  int          maxBlocks = 0;
+  int          numOfRows = 0;
+  char         row[TSDB_MAX_BYTES_PER_ROW];
+
+  if (pVnode->meterList == NULL || pVnode->numOfFiles <= 0) return 0;
+
+  int          tmsize = sizeof(SCompHeader) * pCfg->maxSessions + sizeof(TSCKSUM);
+  SCompHeader *pHeader = (SCompHeader *)malloc(tmsize);
+  if (pHeader == NULL) return -1;
+
+  for (int fileId = pVnode->fileId; fileId > pVnode->fileId - pVnode->numOfFiles; --fileId) {
+    int hfd = -1, dfd = -1, lfd = -1;
+
+    vnodeGetHeadDataLname(headName, dataName, lastName, vnode, fileId);
+    hfd = open(headName, O_RDONLY);
+    dfd = open(dataName, O_RDONLY);
+    lfd = open(lastName, O_RDONLY);
+
+    if (hfd < 0 || dfd < 0 || lfd < 0) {
+      dTrace("vid:%d fileId:%d, failed to open files to restore last rows", vnode, fileId);
+      goto _next;
+    }
+
+    lseek(hfd, TSDB_FILE_HEADER_LEN, SEEK_SET);
+    if (read(hfd, pHeader, tmsize) != tmsize || !taosCheckChecksumWhole((uint8_t *)pHeader, tmsize)) {
+      dError("vid:%d fileId:%d, comp header is broken, last rows are not restored", vnode, fileId);
+      goto _next;
+    }
+
+    for (int sid = 0; sid < pCfg->maxSessions; ++sid) {
+      SMeterObj *pObj = pVnode->meterList[sid];
+      if (pObj == NULL || pObj->pLastRow != NULL || pObj->lastKeyOnFile <= 0) continue;
+      if (pObj->lastKeyOnFile / pCfg->daysPerFile / tsMsPerDay[pCfg->precision] != fileId) continue;
+      if (pHeader[sid].compInfoOffset == 0) continue;
+
+      lseek(hfd, pHeader[sid].compInfoOffset, SEEK_SET);
+      if (read(hfd, &compInfo, sizeof(SCompInfo)) != sizeof(SCompInfo) ||
+          !taosCheckChecksumWhole((uint8_t *)(&compInfo), sizeof(SCompInfo))) {
+        dError("vid:%d sid:%d id:%s, fileId:%d compInfo is broken", vnode, sid, pObj->meterId, fileId);
+        continue;
+      }
+
+      if (compInfo.uid != pObj->uid || compInfo.numOfBlocks <= 0) continue;
+
+      if (compInfo.numOfBlocks > maxBlocks) {
+        SCompBlock *pNew = realloc(pBlocks, compInfo.numOfBlocks * sizeof(SCompBlock));
+        if (pNew == NULL) continue;
+        pBlocks = pNew;
+        maxBlocks = compInfo.numOfBlocks;
+      }
+
+      int size = compInfo.numOfBlocks * sizeof(SCompBlock);
+      if (read(hfd, pBlocks, size) != size || read(hfd, &chksum, sizeof(TSCKSUM)) != sizeof(TSCKSUM) ||
+          chksum != taosCalcChecksum(0, (uint8_t *)pBlocks, size)) {
+        dError("vid:%d sid:%d id:%s, fileId:%d comp blocks are broken", vnode, sid, pObj->meterId, fileId);
+        continue;
+      }
+
+      SCompBlock *pBlock = pBlocks + compInfo.numOfBlocks - 1;
+      if (pBlock->keyLast != pObj->lastKeyOnFile || pBlock->numOfPoints <= 0) continue;
+
+      if (vnodeReadLastRowInBlock(pObj, pBlock->last ? lfd : dfd, pBlock, row) < 0) {
+        dError("vid:%d sid:%d id:%s, fileId:%d failed to read last row", vnode, sid, pObj->meterId, fileId);
+        continue;
+      }
+
+      vnodeUpdateLastRow(pObj, row);
+      numOfRows++;
+    }
+
+  _next:
+    tclose(hfd);
+    tclose(dfd);
+    tclose(lfd);
+  }
+
+  tfree(pBlocks);
+  tfree(pHeader);
+
+  dTrace("vid:%d, last rows of %d meters are restored from files", vnode, numOfRows);
+  return numOfRows;
+}
+
 int vnodeWriteBlockToFile(SMeterObj *pObj, SCompBlock *pCompBlock, SData *data[], SData *cdata[], int points) {
   SVnodeObj *pVnode = &vnodeList[pObj->vnode];
   SVnodeCfg *pCfg = &pVnode->cfg;
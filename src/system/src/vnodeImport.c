@@ -22,6 +22,7 @@
 #include "ttimer.h"
 #include "vnode.h"
 #include "vnodeMgmt.h"
+#include "vnodeRollup.h"
 #include "vnodeShell.h"
 #include "vnodeShell.h"
 #include "vnodeUtil.h"
@@ -187,6 +188,7 @@ int vnodeOpenFileForImport(SImportInfo *pImport, char *payload, SHeadInfo *pHinf
 
     pVnode->commitFirstKey = firstKey;
     if (vnodeOpenCommitFiles(pVnode, pObj->sid) < 0) return -1;
+    vnodeInvalidateRollup(pObj, pVnode->commitFileId);
 
     fstat(pVnode->hfd, &filestat);
     pHinfo->hfdSize = filestat.st_size;
@@ -45,10 +45,16 @@ void vnodeFreeMeterObj(SMeterObj *pObj) {
 
   vnodeFreeCacheInfo(pObj);
   if (vnodeList[pObj->vnode].meterList != NULL) {
+    pthread_mutex_lock(&vnodeList[pObj->vnode].vmutex);
+    vnodeRemoveMeterFromMetric(pObj);
     vnodeList[pObj->vnode].meterList[pObj->sid] = NULL;
+    pthread_mutex_unlock(&vnodeList[pObj->vnode].vmutex);
   }
 
   memset(pObj->meterId, 0, tListLen(pObj->meterId));
+  tfree(pObj->pTags);
+  tfree(pObj->pLastRow);
+  vnodeFreeSubLog(pObj);
   tfree(pObj);
 }
 
@@ -121,31 +127,43 @@ FILE *vnodeOpenMeterObjFile(int vnode) {
   return fp;
 }
 
-int vnodeSaveMeterObjToFile(SMeterObj *pObj) {
+/*
+ * meter obj on file: SMeterObj before reserved, schema, SQL, metricUid, tagSig, tagLen, tag values and checksum
+ */
+static int64_t vnodeEncodeMeterObj(SMeterObj *pObj, char *buffer) {
+  char *  p = buffer;
+  int16_t tagLen = (pObj->tagLen > 0) ? pObj->tagLen : 0;
+
+  memcpy(p, pObj, offsetof(SMeterObj, reserved));
+  p += offsetof(SMeterObj, reserved);
+  memcpy(p, pObj->schema, pObj->numOfColumns * sizeof(SColumn));
+  p += pObj->numOfColumns * sizeof(SColumn);
+  memcpy(p, pObj->pSql, pObj->sqlLen);
+  p += pObj->sqlLen;
+
+  memcpy(p, &pObj->metricUid, sizeof(pObj->metricUid));
+  p += sizeof(pObj->metricUid);
+  memcpy(p, &pObj->tagSig, sizeof(pObj->tagSig));
+  p += sizeof(pObj->tagSig);
+  memcpy(p, &pObj->tagLen, sizeof(pObj->tagLen));
+  p += sizeof(pObj->tagLen);
+  memcpy(p, pObj->pTags, tagLen);
+  p += tagLen;
+
+  int64_t length = (p - buffer) + sizeof(TSCKSUM);
+  taosCalcChecksumAppend(0, (uint8_t *)buffer, length);
+
+  return length;
+}
+
+static void vnodeWriteMeterObjToFile(FILE *fp, SMeterObj *pObj, char *buffer) {
   int64_t    offset, length, new_length, new_offset;
-  FILE *     fp;
   SVnodeObj *pVnode = &vnodeList[pObj->vnode];
-  char *     buffer = NULL;
-
-  fp = vnodeOpenMeterObjFile(pObj->vnode);
-  if (fp == NULL) return -1;
-
-  buffer = (char *)malloc(tsMeterSizeOnFile);
-  if (buffer == NULL) {
-    dError("Failed to allocate memory while saving meter object to file, meterId", pObj->meterId);
-    fclose(fp);
-    return -1;
-  }
 
   offset = pVnode->meterIndex[pObj->sid].offset;
   length = pVnode->meterIndex[pObj->sid].length;
 
-  new_length = offsetof(SMeterObj, reserved) + pObj->numOfColumns * sizeof(SColumn) + pObj->sqlLen + sizeof(TSCKSUM);
-
-  memcpy(buffer, pObj, offsetof(SMeterObj, reserved));
-  memcpy(buffer + offsetof(SMeterObj, reserved), pObj->schema, pObj->numOfColumns * sizeof(SColumn));
-  memcpy(buffer + offsetof(SMeterObj, reserved) + pObj->numOfColumns * sizeof(SColumn), pObj->pSql, pObj->sqlLen);
-  taosCalcChecksumAppend(0, (uint8_t *)buffer, new_length);
+  new_length = vnodeEncodeMeterObj(pObj, buffer);
 
   if (offset == 0 || length < new_length) {  // New, append to file end
     fseek(fp, 0, SEEK_END);
@@ -171,6 +189,24 @@ int vnodeSaveMeterObjToFile(SMeterObj *pObj) {
   // update checksum
   // fseek(fp, TSDB_FILE_HEADER_LEN+sizeof(SMeterObjHeader)*(pVnode->cfg.maxSessions), SEEK_SET);
   // fwrite(((char *)(pVnode->meterIndex) + sizeof(SMeterObjHeader)*(pVnode->cfg.maxSessions)), sizeof(TSCKSUM), 1, fp);
+}
+
+int vnodeSaveMeterObjToFile(SMeterObj *pObj) {
+  FILE *     fp;
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+  char *     buffer = NULL;
+
+  fp = vnodeOpenMeterObjFile(pObj->vnode);
+  if (fp == NULL) return -1;
+
+  buffer = (char *)malloc(tsMeterSizeOnFile);
+  if (buffer == NULL) {
+    dError("Failed to allocate memory while saving meter object to file, meterId", pObj->meterId);
+    fclose(fp);
+    return -1;
+  }
+
+  vnodeWriteMeterObjToFile(fp, pObj, buffer);
 
   tfree(buffer);
 
@@ -182,6 +218,40 @@ int vnodeSaveMeterObjToFile(SMeterObj *pObj) {
   return 0;
 }
 
+/*
+ * save a batch of meter objects of one vnode, the file is opened and the header is updated only once
+ */
+int vnodeSaveMeterObjsToFile(int vnode, SMeterObj **pObjs, int numOfMeters) {
+  FILE *     fp;
+  SVnodeObj *pVnode = &vnodeList[vnode];
+  char *     buffer = NULL;
+
+  if (numOfMeters <= 0) return 0;
+
+  fp = vnodeOpenMeterObjFile(vnode);
+  if (fp == NULL) return -1;
+
+  buffer = (char *)malloc(tsMeterSizeOnFile);
+  if (buffer == NULL) {
+    dError("vid:%d, failed to allocate memory while saving %d meter objects to file", vnode, numOfMeters);
+    fclose(fp);
+    return -1;
+  }
+
+  for (int i = 0; i < numOfMeters; ++i) {
+    assert(pObjs[i]->vnode == vnode);
+    vnodeWriteMeterObjToFile(fp, pObjs[i], buffer);
+  }
+
+  tfree(buffer);
+
+  vnodeUpdateVnodeStatistic(fp, pVnode);
+  vnodeUpdateVnodeFileHeader(fp, pVnode);
+  fclose(fp);
+
+  return 0;
+}
+
 int vnodeSaveAllMeterObjToFile(int vnode) {
   int64_t    offset, length, new_length, new_offset;
   FILE *     fp;
@@ -205,12 +275,7 @@ int vnodeSaveAllMeterObjToFile(int vnode) {
     offset = pVnode->meterIndex[sid].offset;
     length = pVnode->meterIndex[sid].length;
 
-    new_length = offsetof(SMeterObj, reserved) + pObj->numOfColumns * sizeof(SColumn) + pObj->sqlLen + sizeof(TSCKSUM);
-
-    memcpy(buffer, pObj, offsetof(SMeterObj, reserved));
-    memcpy(buffer + offsetof(SMeterObj, reserved), pObj->schema, pObj->numOfColumns * sizeof(SColumn));
-    memcpy(buffer + offsetof(SMeterObj, reserved) + pObj->numOfColumns * sizeof(SColumn), pObj->pSql, pObj->sqlLen);
-    taosCalcChecksumAppend(0, (uint8_t *)buffer, new_length);
+    new_length = vnodeEncodeMeterObj(pObj, buffer);
 
     if (offset == 0 || length > new_length) {  // New, append to file end
       new_offset = fseek(fp, 0, SEEK_END);
@@ -325,6 +390,51 @@ int vnodeRestoreMeterObj(char *buffer, int64_t length) {
            pSavedObj->sqlLen);
   pObj->pSql = (char *)pObj + sizeof(SMeterObj);
 
+  // the tag values are absent in meter obj saved by earlier version, they are replicated from mgmt later
+  char *  pTagBlock = buffer + offsetof(SMeterObj, reserved) + sizeof(SColumn) * pSavedObj->numOfColumns + pSavedObj->sqlLen;
+  int64_t tagBlockLen = length - (pTagBlock - buffer);
+
+  pObj->metricUid = 0;
+  pObj->tagSig = 0;
+  pObj->tagLen = -1;
+  pObj->pTags = NULL;
+  pObj->pLastRow = NULL;
+  pObj->lastRowSeq = 0;
+  pObj->pIncStream = NULL;
+  pObj->pSrcStreams = NULL;
+  pObj->pSubLog = NULL;
+
+  int64_t tagHeadLen = sizeof(pObj->metricUid) + sizeof(pObj->tagSig) + sizeof(pObj->tagLen);
+  if (tagBlockLen >= tagHeadLen) {
+    memcpy(&pObj->metricUid, pTagBlock, sizeof(pObj->metricUid));
+    pTagBlock += sizeof(pObj->metricUid);
+    memcpy(&pObj->tagSig, pTagBlock, sizeof(pObj->tagSig));
+    pTagBlock += sizeof(pObj->tagSig);
+    memcpy(&pObj->tagLen, pTagBlock, sizeof(pObj->tagLen));
+    pTagBlock += sizeof(pObj->tagLen);
+
+    if (pObj->tagLen > tagBlockLen - tagHeadLen || pObj->tagLen > TSDB_MAX_TAGS_LEN) {
+      dError("vid:%d sid:%d id:%s, invalid tag length:%d, tags are replicated from mgmt later", pObj->vnode,
+             pObj->sid, pObj->meterId, pObj->tagLen);
+      pObj->tagLen = -1;
+    } else if (pObj->tagLen > 0) {
+      pObj->pTags = malloc(pObj->tagLen);
+      if (pObj->pTags == NULL) {
+        pObj->tagLen = -1;
+      } else {
+        memcpy(pObj->pTags, pTagBlock, pObj->tagLen);
+      }
+    } else if (pObj->tagLen == 0) {
+      pObj->metricUid = 0;  // normal table
+    }
+
+    if (pObj->tagLen < 0) {
+      pObj->tagLen = -1;
+    }
+  }
+
+  vnodeAddMeterIntoMetric(pObj);
+
   pObj->lastKey = pObj->lastKeyOnFile;
   if (pObj->lastKey > vnodeList[pObj->vnode].lastKey) vnodeList[pObj->vnode].lastKey = pObj->lastKey;
 
@@ -363,7 +473,8 @@ int vnodeOpenMetersVnode(int vnode) {
 
   fseek(fp, TSDB_FILE_HEADER_LEN, SEEK_SET);
 
-  tsMeterSizeOnFile = sizeof(SMeterObj) + TSDB_MAX_COLUMNS * sizeof(SColumn) + TSDB_MAX_SAVED_SQL_LEN + sizeof(TSCKSUM);
+  tsMeterSizeOnFile = sizeof(SMeterObj) + TSDB_MAX_COLUMNS * sizeof(SColumn) + TSDB_MAX_SAVED_SQL_LEN +
+                      TSDB_MAX_TAGS_LEN + sizeof(TSCKSUM);
 
   int size = sizeof(SMeterObj *) * pVnode->cfg.maxSessions;
   pVnode->meterList = (void *)malloc(size);
@@ -418,16 +529,51 @@ void vnodeCloseMetersVnode(int vnode) {
       if (pObj == NULL) continue;
       vnodeFreeCacheInfo(pObj);
       tfree(pObj->schema);
+      tfree(pObj->pTags);
+      tfree(pObj->pLastRow);
+      vnodeFreeSubLog(pObj);
       tfree(pObj);
     }
 
     tfree(pVnode->meterList);
   }
 
+  vnodeCleanUpMetricMeters(pVnode);
+
   pVnode->meterList = NULL;
 }
 
-int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec) {
+/*
+ * the tag values are replaced in place, since they are only accessed by the tag filter of query with vmutex locked.
+ * Return true if the tag values are changed.
+ */
+static bool vnodeUpdateMeterTags(SMeterObj *pObj, SMeterObj *pNew) {
+  if (pObj->metricUid == pNew->metricUid && pObj->tagSig == pNew->tagSig && pObj->tagLen == pNew->tagLen &&
+      (pObj->tagLen <= 0 || memcmp(pObj->pTags, pNew->pTags, pObj->tagLen) == 0)) {
+    return false;
+  }
+
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+  char *     pTags = pObj->pTags;
+
+  pthread_mutex_lock(&pVnode->vmutex);
+  vnodeRemoveMeterFromMetric(pObj);
+  pObj->metricUid = pNew->metricUid;
+  pObj->tagSig = pNew->tagSig;
+  pObj->tagLen = pNew->tagLen;
+  pObj->pTags = pNew->pTags;
+  vnodeAddMeterIntoMetric(pObj);
+  pthread_mutex_unlock(&pVnode->vmutex);
+
+  pNew->pTags = NULL;
+  tfree(pTags);
+
+  dTrace("vid:%d sid:%d id:%s, tags are updated, metric uid:%ld tagLen:%d", pObj->vnode, pObj->sid, pObj->meterId,
+         pObj->metricUid, pObj->tagLen);
+  return true;
+}
+
+static int vnodeDoCreateMeterObj(SMeterObj *pNew, bool save, bool *tagsUpdated) {
   SMeterObj *pObj;
   int        code;
 
@@ -435,6 +581,10 @@ int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec) {
   code = TSDB_CODE_SUCCESS;
 
   if (pObj && pObj->uid == pNew->uid) {
+    *tagsUpdated = vnodeUpdateMeterTags(pObj, pNew);
+    if (*tagsUpdated && save) vnodeSaveMeterObjToFile(pObj);
+    tfree(pNew->pTags);
+
     if (pObj->sversion == pNew->sversion) {
       dTrace("vid:%d sid:%d id:%s sversion:%d, identical meterObj, ignore create", pNew->vnode, pNew->sid,
              pNew->meterId, pNew->sversion);
@@ -455,10 +605,13 @@ int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec) {
   if (pNew->pCache == NULL) {
     code = TSDB_CODE_NO_RESOURCE;
   } else {
+    pthread_mutex_lock(&vnodeList[pNew->vnode].vmutex);
     vnodeList[pNew->vnode].meterList[pNew->sid] = pNew;
+    vnodeAddMeterIntoMetric(pNew);
+    pthread_mutex_unlock(&vnodeList[pNew->vnode].vmutex);
     pNew->state = TSDB_METER_STATE_READY;
     if (pNew->timeStamp > vnodeList[pNew->vnode].lastCreate) vnodeList[pNew->vnode].lastCreate = pNew->timeStamp;
-    vnodeSaveMeterObjToFile(pNew);
+    if (save) vnodeSaveMeterObjToFile(pNew);
     // vnodeCreateMeterMgmt(pNew, pSec);
     vnodeCreateStream(pNew);
     dTrace("vid:%d sid:%d id:%s, meterObj is created, uid:%ld", pNew->vnode, pNew->sid, pNew->meterId, pNew->uid);
@@ -467,6 +620,43 @@ int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec) {
   return code;
 }
 
+int vnodeCreateMeterObj(SMeterObj *pNew, SConnSec *pSec) {
+  bool tagsUpdated = false;
+  return vnodeDoCreateMeterObj(pNew, true, &tagsUpdated);
+}
+
+/*
+ * create a batch of meter objects in one vnode, the new objects are saved into file together. The code of each
+ * object is set in pCode, the object shall be released by caller if it is not TSDB_CODE_SUCCESS.
+ */
+int vnodeCreateMeterObjs(int vnode, SMeterObj **pNews, int numOfMeters, int32_t *pCode) {
+  SMeterObj **pCreated = (SMeterObj **)malloc(numOfMeters * sizeof(SMeterObj *));
+  int         numOfCreated = 0;
+
+  for (int i = 0; i < numOfMeters; ++i) {
+    bool tagsUpdated = false;
+    pCode[i] = vnodeDoCreateMeterObj(pNews[i], pCreated == NULL, &tagsUpdated);
+
+    // the schema of existing meter may be updated, only the meters installed here and the existing meters
+    // with tag values updated are saved
+    if (pCreated == NULL) continue;
+
+    if (pCode[i] == TSDB_CODE_SUCCESS && vnodeList[vnode].meterList[pNews[i]->sid] == pNews[i]) {
+      pCreated[numOfCreated++] = pNews[i];
+    } else if (tagsUpdated) {
+      pCreated[numOfCreated++] = vnodeList[vnode].meterList[pNews[i]->sid];
+    }
+  }
+
+  if (pCreated != NULL) {
+    vnodeSaveMeterObjsToFile(vnode, pCreated, numOfCreated);
+    free(pCreated);
+  }
+
+  dTrace("vid:%d, %d meterObjs are created in batch, meters in msg:%d", vnode, numOfCreated, numOfMeters);
+  return numOfCreated;
+}
+
 int vnodeRemoveMeterObj(int vnode, int sid) {
   SMeterObj *pObj;
 
@@ -499,6 +689,7 @@ int vnodeRemoveMeterObj(int vnode, int sid) {
   vnodeList[vnode].lastRemove = pObj->timeStamp;
 
   vnodeRemoveStream(pObj);
+  vnodeDetachIncStreams(pObj);
   vnodeSaveMeterObjToFile(pObj);
   vnodeFreeMeterObj(pObj);
 
@@ -573,6 +764,8 @@ int vnodeInsertPoints(SMeterObj *pObj, char *cont, int contLen, char source, voi
   code = 0;
 
   TSKEY firstKey = *((TSKEY *)pData);
+  TSKEY prevLastKey = pObj->lastKey;
+  char *pLastRow = NULL;
   int firstId = firstKey/pVnode->cfg.daysPerFile/tsMsPerDay[pVnode->cfg.precision];
   int lastId  = (*(TSKEY *)(pData + pObj->bytesPerPoint * (numOfPoints - 1)))/pVnode->cfg.daysPerFile/tsMsPerDay[pVnode->cfg.precision];
   if ((firstId <= cfile - pVnode->maxFiles) || (firstId > cfile + 1) || (lastId <= cfile - pVnode->maxFiles) || (lastId > cfile + 1)) {
@@ -609,9 +802,19 @@ int vnodeInsertPoints(SMeterObj *pObj, char *cont, int contLen, char source, voi
     }
 
     pObj->lastKey = *((TSKEY *)pData);
+    pLastRow = pData;
     pData += pObj->bytesPerPoint;
     points++;
   }
+
+  if (pLastRow != NULL) {
+    vnodeUpdateLastRow(pObj, pLastRow);
+    if (pObj->pSrcStreams != NULL) vnodeUpdateIncStreams(pObj, pSubmit->payLoad, numOfPoints, prevLastKey);
+
+    // the lastKey shall be visible before the ring is checked, see vnodeGetSubLog
+    __sync_synchronize();
+    if (pObj->pSubLog != NULL) vnodePushSubscribedRows(pObj, pSubmit->payLoad, numOfPoints);
+  }
   __sync_fetch_and_add(&(pVnode->vnodeStatistic.pointsWritten), points * (pObj->numOfColumns - 1));
   __sync_fetch_and_add(&(pVnode->vnodeStatistic.totalStorage), points * pObj->bytesPerPoint);
 
@@ -634,6 +837,52 @@ _over:
   return code;
 }
 
+/*
+ * the last row is only updated by insertion, which is exclusive for one meter, and it is read by queries without
+ * lock. The sequence number is increased before and after the update, so the reader retries if it is odd or changed.
+ */
+void vnodeUpdateLastRow(SMeterObj *pObj, char *pData) {
+  if (pObj->pLastRow == NULL) {
+    char *pRow = malloc(pObj->bytesPerPoint);
+    if (pRow == NULL) return;
+
+    memcpy(pRow, pData, pObj->bytesPerPoint);
+    __sync_synchronize();
+    pObj->pLastRow = pRow;
+    return;
+  }
+
+  __sync_fetch_and_add(&pObj->lastRowSeq, 1);
+  memcpy(pObj->pLastRow, pData, pObj->bytesPerPoint);
+  __sync_fetch_and_add(&pObj->lastRowSeq, 1);
+}
+
+/*
+ * copy the last row of meter into pRow. Return false if it is not kept, or it is not the latest one since the
+ * insertion is in progress, or it has been removed from data files already.
+ */
+bool vnodeGetLastRow(SMeterObj *pObj, char *pRow) {
+  while (1) {
+    int32_t seq = __sync_fetch_and_add(&pObj->lastRowSeq, 0);
+    char *  pLastRow = pObj->pLastRow;
+
+    if (pLastRow == NULL) return false;
+    if (seq & 1) continue;
+
+    memcpy(pRow, pLastRow, pObj->bytesPerPoint);
+    if (__sync_fetch_and_add(&pObj->lastRowSeq, 0) == seq) break;
+  }
+
+  TSKEY key = *(TSKEY *)pRow;
+  if (key != pObj->lastKey) return false;
+
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+  int        fileId = key / pVnode->cfg.daysPerFile / tsMsPerDay[pVnode->cfg.precision];
+  if (key <= pObj->lastKeyOnFile && fileId <= pVnode->fileId - pVnode->numOfFiles) return false;
+
+  return true;
+}
+
 void vnodeProcessUpdateSchemaTimer(void *param, void *tmrId) {
   SMeterObj * pObj = (SMeterObj *)param;
   if (pObj->vnode >= TSDB_MAX_VNODES) return;
@@ -742,6 +991,10 @@ void vnodeUpdateMeter(void *param, void *tmrId) {
   tfree(pObj->schema);
   pObj->schema = pNew->schema;
 
+  // the last row is in the format of old schema, it is kept again by the next insertion
+  tfree(pObj->pLastRow);
+  vnodeFreeSubLog(pObj);
+
   vnodeFreeCacheInfo(pObj);
   pObj->pCache = vnodeAllocateCacheInfo(pObj);
 
@@ -40,6 +40,7 @@
 #include "vnodeDataFilterFunc.h"
 #include "vnodeFile.h"
 #include "vnodeQueryImpl.h"
+#include "vnodeRollup.h"
 
 static int32_t copyDataFromMMapBuffer(int fd, SQInfo *pQInfo, SQueryFileInfo *pQueryFile, char *buf, uint64_t offset,
                                       int32_t size);
@@ -1553,6 +1554,10 @@ static int32_t setupQueryRuntimeEnv(SMeterObj *pMeterObj, SQuery *pQuery, SQuery
   pRuntimeEnv->pMeterObj = pMeterObj;
   pRuntimeEnv->pQuery = pQuery;
 
+  pRuntimeEnv->rollup.level = -1;
+  pRuntimeEnv->rollup.fd = -1;
+  pRuntimeEnv->rollup.fileId = -1;
+
   //todo free all allocated resource
   pRuntimeEnv->go = (bool *)malloc(sizeof(bool) * pQuery->numOfOutputCols);
   if (pRuntimeEnv->go == NULL) {
@@ -1693,6 +1698,7 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
   }
 
   tfree(pRuntimeEnv->unzipBuffer);
+  vnodeCloseRollupCursor(&pRuntimeEnv->rollup);
 
   if (pRuntimeEnv->pQuery && (!PRIMARY_TSCOL_LOADED(pRuntimeEnv->pQuery))) {
     tfree(pRuntimeEnv->primaryColBuffer);
@@ -2296,6 +2302,87 @@ static bool getNeighborPoints(SMeterQuerySupportObj *pSupporter, SMeterObj *pMet
   return true;
 }
 
+static void getOneRowFromLastRow(SQueryRuntimeEnv *pRuntimeEnv, SMeterObj *pMeterObj, char *pRow, char **dst) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  for (int32_t i = 0; i < pQuery->numOfCols; ++i) {
+    int32_t colIdx = pQuery->colList[i].colIdx;
+    int32_t colId = pQuery->colList[i].data.colId;
+
+    SColumnFilterMsg *pCols = &pQuery->colList[i].data;
+    if (colIdx < 0 || colIdx >= pMeterObj->numOfColumns || pMeterObj->schema[colIdx].colId != colId) {
+      setNull(dst[i], pCols->type, pCols->bytes);
+      continue;
+    }
+
+    int32_t offset = 0;
+    for (int32_t j = 0; j < colIdx; ++j) {
+      offset += pMeterObj->schema[j].bytes;
+    }
+
+    memcpy(dst[i], pRow + offset, pCols->bytes);
+  }
+}
+
+/*
+ * the last_row query on one meter is answered by the last row kept in meter obj, neither cache blocks nor data files
+ * are accessed. Return false if the last row is not available, and the query goes on as usual.
+ */
+bool vnodeLastRowQueryFromMeter(SMeterQuerySupportObj *pSupporter, SMeterObj *pMeterObj) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pSupporter->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+  SQLFunctionCtx *  pCtx = pRuntimeEnv->pCtx;
+
+  if (pQuery->numOfFilterCols > 0) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutputCols; ++i) {
+    int32_t functionId = pQuery->pSelectExpr[i].pBase.functionId;
+    if (functionId != TSDB_FUNC_LAST_ROW && functionId != TSDB_FUNC_LAST_ROW_DST && functionId != TSDB_FUNC_TS &&
+        functionId != TSDB_FUNC_TS_DUMMY && functionId != TSDB_FUNC_TAG) {
+      return false;
+    }
+  }
+
+  char row[TSDB_MAX_BYTES_PER_ROW];
+  if (!vnodeGetLastRow(pMeterObj, row)) {
+    return false;
+  }
+
+  TSKEY key = *(TSKEY *)row;
+
+  pQuery->skey = key;
+  pQuery->ekey = key;
+  pQuery->lastKey = key;
+  pSupporter->rawSKey = key;
+  pSupporter->rawEKey = key;
+
+  SPointInterpoSupporter interpInfo = {0};
+  pointInterpSupporterInit(pQuery, &interpInfo);
+
+  getOneRowFromLastRow(pRuntimeEnv, pMeterObj, row, interpInfo.pNextPoint);
+  pointInterpSupporterSetData((SQInfo *)GET_QINFO_ADDR(pQuery), &interpInfo);
+
+  pQuery->pos = 0;
+  for (int32_t k = 0; k < pQuery->numOfOutputCols; ++k) {
+    SColIndexEx *pCol = &pQuery->pSelectExpr[k].pBase.colInfo;
+    int32_t      functionId = pQuery->pSelectExpr[k].pBase.functionId;
+    char *       pData = pCol->isTag ? NULL : interpInfo.pNextPoint[pCol->colIdxInBuf];
+
+    setExecParams(pQuery, &pCtx[k], key, pData, (char *)&key, 1, functionId, NULL, false, pRuntimeEnv->blockStatus,
+                  NULL, MASTER_SCAN);
+    aAggs[functionId].xFunction(&pCtx[k]);
+  }
+
+  pointInterpSupporterDestroy(&interpInfo);
+  setQueryStatus(pQuery, QUERY_COMPLETED);
+
+  dTrace("QInfo:%p vid:%d sid:%d id:%s, last_row query is answered by last row of meter, key:%lld",
+         GET_QINFO_ADDR(pQuery), pMeterObj->vnode, pMeterObj->sid, pMeterObj->meterId, key);
+  return true;
+}
+
 static bool doGetQueryPos(TSKEY key, SMeterQuerySupportObj *pSupporter, SPointInterpoSupporter *pPointInterpSupporter) {
   SQueryRuntimeEnv *pRuntimeEnv = &pSupporter->runtimeEnv;
   SQuery *          pQuery = pRuntimeEnv->pQuery;
@@ -3185,6 +3272,152 @@ static void allocMemForInterpo(SMeterQuerySupportObj *pSupporter, SQuery *pQuery
   }
 }
 
+/*
+ * interval query on single table reads the aggregates of buckets in rollup files instead of raw data blocks,
+ * if only the functions that are able to work on the pre-aggregated values of data block are involved
+ */
+static void setupRollupCursor(SQueryRuntimeEnv *pRuntimeEnv) {
+  SQuery *pQuery = pRuntimeEnv->pQuery;
+
+  if (pQuery->nAggTimeInterval == 0 || !QUERY_IS_ASC_QUERY(pQuery) || pQuery->numOfFilterCols > 0) {
+    return;
+  }
+
+  for (int32_t i = 0; i < pQuery->numOfOutputCols; ++i) {
+    SSqlFuncExprMsg *pBase = &pQuery->pSelectExpr[i].pBase;
+    if (pBase->colInfo.isTag) {
+      return;
+    }
+
+    switch (pBase->functionId) {
+      case TSDB_FUNC_TS:
+      case TSDB_FUNC_COUNT:
+      case TSDB_FUNC_SUM:
+      case TSDB_FUNC_AVG:
+      case TSDB_FUNC_MIN:
+      case TSDB_FUNC_MAX:
+        break;
+      case TSDB_FUNC_SPREAD:  // the range of timestamp in bucket is not kept
+        if (pBase->colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          return;
+        }
+        break;
+      default:
+        return;
+    }
+  }
+
+  vnodeInitRollupCursor(&pRuntimeEnv->rollup, pRuntimeEnv->pMeterObj, pQuery->nAggTimeInterval, pQuery->skey);
+}
+
+/*
+ * set the position of raw data scan to the first data not earlier than key, which is invalid after windows are
+ * answered by rollups.
+ */
+static bool repositionRawQueryRange(SMeterQuerySupportObj *pSupporter, TSKEY key) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pSupporter->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+
+  bool dataInDisk = true;
+  bool dataInCache = true;
+
+  pRuntimeEnv->rollup.rawPosInvalid = false;
+
+  // the compblock info may be reloaded with all SFields freed, so the block in buffer must be loaded again
+  vnodeInitDataBlockInfo(&pRuntimeEnv->loadBlockInfo);
+
+  pQuery->skey = key;
+  pQuery->ekey = pSupporter->rawEKey;
+  pQuery->lastKey = key;
+
+  vnodeCheckIfDataExists(pRuntimeEnv, pRuntimeEnv->pMeterObj, &dataInDisk, &dataInCache);
+  if (!(dataInDisk || dataInCache) || !normalizedFirstQueryRange(dataInDisk, dataInCache, pSupporter, NULL)) {
+    return false;
+  }
+
+  pQuery->lastKey = pQuery->skey;
+  return true;
+}
+
+bool vnodeIntervalQueryFromRollup(SMeterQuerySupportObj *pSupporter) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pSupporter->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+  SMeterObj *       pMeterObj = pRuntimeEnv->pMeterObj;
+  SRollupCursor *   pCursor = &pRuntimeEnv->rollup;
+
+  // the window consists of whole buckets, and all data in it are aggregated
+  if (pCursor->level >= 0 && pQuery->skey % pCursor->interval == 0 && (pQuery->ekey + 1) % pCursor->interval == 0 &&
+      pQuery->ekey <= pCursor->coveredKey) {
+    int8_t blockStatus = 0;
+    SET_FILE_BLOCK_FLAG(blockStatus);
+    SET_DATA_BLOCK_NOT_LOADED(blockStatus);
+
+    TSKEY ts = taosGetIntervalStartTimestamp(pQuery->skey, pQuery->nAggTimeInterval, pQuery->intervalTimeUnit);
+    TSKEY key = pQuery->skey;
+
+    while (1) {
+      SRollupBucket *pBucket = NULL;
+      int32_t        ret = vnodeGetRollupBucket(pCursor, pMeterObj, key, &pBucket);
+      if (ret < 0) {
+        dError("QInfo:%p vid:%d sid:%d id:%s, failed to read rollups, query on raw data", GET_QINFO_ADDR(pQuery),
+               pMeterObj->vnode, pMeterObj->sid, pMeterObj->meterId);
+        pCursor->level = -1;
+        initCtxOutputBuf(pRuntimeEnv);
+        break;
+      }
+
+      if (ret == 0 || pBucket->key > pQuery->ekey) {
+        pQuery->lastKey = pQuery->ekey + 1;
+        pCursor->rawPosInvalid = true;
+        setQueryStatus(pQuery, QUERY_COMPLETED);
+        return true;
+      }
+
+      for (int32_t k = 0; k < pQuery->numOfOutputCols; ++k) {
+        int32_t functionId = pQuery->pSelectExpr[k].pBase.functionId;
+        int16_t colId = pQuery->pSelectExpr[k].pBase.colInfo.colId;
+
+        SField  field = {0};
+        SField *pField = NULL;
+
+        if (colId != PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          int32_t j = 1;
+          while (j < pMeterObj->numOfColumns && pMeterObj->schema[j].colId != colId) {
+            j++;
+          }
+
+          // the column is not in the schema of rollups, all data are null
+          if (j == pMeterObj->numOfColumns) {
+            continue;
+          }
+
+          SRollupCol *pCol = &pBucket->cols[j - 1];
+          field.colId = colId;
+          field.sum = pCol->sum;
+          field.max = pCol->max;
+          field.min = pCol->min;
+          field.numOfNullPoints = pCol->numOfNullPoints;
+          pField = &field;
+        }
+
+        setExecParams(pQuery, &pRuntimeEnv->pCtx[k], ts, NULL, (char *)&pBucket->key, pBucket->numOfPoints,
+                      functionId, pField, (pField != NULL && field.numOfNullPoints > 0), blockStatus, NULL,
+                      MASTER_SCAN);
+        aAggs[functionId].xFunction(&pRuntimeEnv->pCtx[k]);
+      }
+
+      key = pBucket->key + 1;
+    }
+  }
+
+  if (pCursor->rawPosInvalid && !repositionRawQueryRange(pSupporter, pQuery->skey)) {
+    setQueryStatus(pQuery, QUERY_COMPLETED | QUERY_NO_DATA_TO_CHECK);
+    return true;
+  }
+
+  return false;
+}
+
 int32_t vnodeQuerySingleMeterPrepare(SQInfo *pQInfo, SMeterObj *pMeterObj, SMeterQuerySupportObj *pSupporter) {
   SQuery *pQuery = &pQInfo->query;
 
@@ -3235,6 +3468,25 @@ int32_t vnodeQuerySingleMeterPrepare(SQInfo *pQInfo, SMeterObj *pMeterObj, SMete
     return ret;
   }
 
+  // the last row kept in meter obj is the result of last_row query, no need to open files or scan cache blocks
+  if (isFirstLastRowQuery(pQuery) && vnodeLastRowQueryFromMeter(pSupporter, pMeterObj)) {
+    pSupporter->numOfMeters = 1;
+    doFinalizeResult(&pSupporter->runtimeEnv);
+
+    // the offset and limit are applied the same as the scan, the result is empty if the row is skipped
+    pQuery->pointsRead = getNumOfResult(&pSupporter->runtimeEnv);
+    doSkipResults(&pSupporter->runtimeEnv);
+    doRevisedResultsByLimit(pQInfo);
+    moveDescOrderResultsToFront(&pSupporter->runtimeEnv);
+
+    // the query is set over in the next round, when the result is retrieved
+    pQInfo->pointsRead = pQuery->pointsRead;
+    pQInfo->over = (pQuery->pointsRead == 0) ? 1 : 0;
+    sem_post(&pQInfo->dataReady);
+
+    return TSDB_CODE_SUCCESS;
+  }
+
   vnodeOpenAllFiles(pQInfo, pMeterObj->vnode);
 
   // in case of last_row query, we set the query timestamp to pMeterObj->lastKey;
@@ -3286,6 +3538,8 @@ int32_t vnodeQuerySingleMeterPrepare(SQInfo *pQInfo, SMeterObj *pMeterObj, SMete
 
   // the pQuery->skey is changed during normalizedFirstQueryRange, so set the newest lastkey value
   pQuery->lastKey = pQuery->skey;
+
+  setupRollupCursor(&pSupporter->runtimeEnv);
   return TSDB_CODE_SUCCESS;
 }
 
@@ -4029,6 +4283,11 @@ static void printBinaryData(int32_t functionId, char *data, int32_t srcDataType)
     }
   } else if (functionId == TSDB_FUNC_AVG_DST) {
     printf("%lf,%d\t", *(double *)data, *(int32_t *)(data + sizeof(double)));
+  } else if (functionId == TSDB_FUNC_STDDEV_DST) {
+    printf("%lf,%lf,%ld\t", *(double *)data, *(double *)(data + sizeof(double)),
+           *(int64_t *)(data + sizeof(double) * 2));
+  } else if (functionId == TSDB_FUNC_HLL_DST) {
+    printf("%d,%ld\t", *(int32_t *)data, *(int64_t *)(data + sizeof(int64_t)));
   } else if (functionId == TSDB_FUNC_SPREAD_DST) {
     printf("%lf,%lf\t", *(double *)data, *(double *)(data + sizeof(double)));
   } else if (functionId == TSDB_FUNC_WAVG_DST) {
@@ -4773,6 +5032,32 @@ int64_t getNumOfResult(SQueryRuntimeEnv *pRuntimeEnv) {
   return maxOutput;
 }
 
+/*
+ * the previous window is answered by rollups, the next window is decided by the next bucket, or by the raw data
+ * if no more buckets are available
+ */
+static void forwardIntervalQueryRangeByRollup(SMeterQuerySupportObj *pSupporter) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pSupporter->runtimeEnv;
+  SQuery *          pQuery = pRuntimeEnv->pQuery;
+  SRollupBucket *   pBucket = NULL;
+
+  if (vnodeGetRollupBucket(&pRuntimeEnv->rollup, pRuntimeEnv->pMeterObj, pQuery->skey, &pBucket) > 0) {
+    if (pBucket->key > pSupporter->rawEKey) {
+      setQueryStatus(pQuery, QUERY_COMPLETED);
+    } else if (pBucket->key > pQuery->ekey) {
+      getAlignedIntervalQueryRange(pQuery, pBucket->key, pSupporter->rawSKey, pSupporter->rawEKey);
+    }
+
+    return;
+  }
+
+  // the remain data are not aggregated in rollups
+  pRuntimeEnv->rollup.level = -1;
+  if (!repositionRawQueryRange(pSupporter, pQuery->skey)) {
+    setQueryStatus(pQuery, QUERY_COMPLETED);
+  }
+}
+
 /*
  * forward the query range for next interval query
  */
@@ -4807,6 +5092,11 @@ void forwardIntervalQueryRange(SMeterQuerySupportObj *pSupporter, SQueryRuntimeE
   /* ensure the search in cache will return right position */
   pQuery->lastKey = pQuery->skey;
 
+  if (pRuntimeEnv->rollup.rawPosInvalid) {
+    forwardIntervalQueryRangeByRollup(pSupporter);
+    return;
+  }
+
   TSKEY nextTimestamp = loadRequiredBlockIntoMem(pRuntimeEnv, &pRuntimeEnv->nextPos);
   if ((nextTimestamp > pSupporter->rawEKey && QUERY_IS_ASC_QUERY(pQuery)) ||
       (nextTimestamp < pSupporter->rawEKey && !QUERY_IS_ASC_QUERY(pQuery)) ||
@@ -6084,6 +6374,12 @@ int32_t vnodeGetResultSize(void *thandle, int32_t *numOfRows) {
   return pQInfo->query.rowSize * (*numOfRows);
 }
 
+// the upper bound of the compressed result, columns that can not be compressed are sent in raw format
+int32_t vnodeGetCompressedResultSize(void *thandle, int32_t *numOfRows) {
+  SQInfo *pQInfo = (SQInfo *)thandle;
+  return vnodeGetResultSize(thandle, numOfRows) + pQInfo->query.numOfOutputCols * sizeof(SRetrieveColHead);
+}
+
 int64_t vnodeGetOffsetVal(void *thandle) {
   SQInfo *pQInfo = (SQInfo *)thandle;
   return pQInfo->query.limit.offset;
@@ -6191,6 +6487,78 @@ int32_t vnodeCopyQueryResultToMsg(void *handle, char *data, int32_t numOfRows) {
   return numOfRows;
 }
 
+/**
+ * compress each output column with the codec of its data type, the column is sent in raw format
+ * if the compressed size is not smaller than the original one.
+ *
+ * @param handle
+ * @param data
+ * @param numOfRows the number of rows that are not returned in current retrieve
+ * @param size      the actual size of compressed result in data
+ * @return
+ */
+int32_t vnodeCompressQueryResultToMsg(void *handle, char *data, int32_t numOfRows, int32_t *size) {
+  SQInfo *pQInfo = (SQInfo *)handle;
+
+  SMeterObj *pObj = pQInfo->pObj;
+  SQuery *   pQuery = &pQInfo->query;
+
+  assert(pQuery->pSelectExpr != NULL && pQuery->numOfOutputCols > 0);
+
+  int32_t tnumOfRows = vnodeList[pObj->vnode].cfg.rowsInFileBlock;
+  int32_t maxBytes = 0;
+
+  for (int32_t col = 0; col < pQuery->numOfOutputCols; ++col) {
+    maxBytes = MAX(maxBytes, pQuery->pSelectExpr[col].resBytes);
+  }
+
+  // the first stage output of codecs may be slightly larger than the input
+  int32_t bufSize = maxBytes * numOfRows * 2 + EXTRA_BYTES;
+  char *  pBuffer = malloc(bufSize * 2);
+  if (pBuffer == NULL) {
+    *size = 0;
+    return -1;
+  }
+
+  char *pOutput = pBuffer + bufSize;
+  char *pData = data;
+
+  for (int32_t col = 0; col < pQuery->numOfOutputCols; ++col) {
+    int16_t type = pQuery->pSelectExpr[col].resType;
+    int32_t bytes = pQuery->pSelectExpr[col].resBytes;
+    int32_t rawLen = bytes * numOfRows;
+    char *  pSrc = pQuery->sdata[col]->data + bytes * tnumOfRows * pQInfo->bufIndex;
+
+    // binary/nchar columns and intermediate results in special format are compressed as string
+    if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR || type < TSDB_DATA_TYPE_BOOL ||
+        type > TSDB_DATA_TYPE_NCHAR || bytes != tDataTypeDesc[type].nSize) {
+      type = TSDB_DATA_TYPE_BINARY;
+    }
+
+    int32_t len = (*pCompFunc[type])(pSrc, rawLen, numOfRows, pOutput, bufSize, TWO_STAGE_COMP, pBuffer, bufSize);
+
+    SRetrieveColHead *pHead = (SRetrieveColHead *)pData;
+    pData += sizeof(SRetrieveColHead);
+
+    if (len > 0 && len < rawLen) {
+      pHead->compType = (int8_t)type;
+      pHead->len = htonl(len);
+      memcpy(pData, pOutput, len);
+      pData += len;
+    } else {
+      pHead->compType = 0;
+      pHead->len = htonl(rawLen);
+      memcpy(pData, pSrc, rawLen);
+      pData += rawLen;
+    }
+  }
+
+  free(pBuffer);
+
+  *size = pData - data;
+  return numOfRows;
+}
+
 int32_t vnodeQueryResultInterpolate(SQInfo *pQInfo, tFilePage **pDst, tFilePage **pDataSrc, int32_t numOfRows,
                                     int32_t *numOfInterpo) {
   SMeterQuerySupportObj *pSupporter = pQInfo->pMeterQuerySupporter;
@@ -425,28 +425,32 @@ static int64_t doCheckMetersInGroup(SQInfo *pQInfo, int32_t index, int32_t start
     return 0;
   }
 
+  // the result of last_row query is produced from the last row kept in meter obj if it is available
+  if (!isFirstLastRowQuery(pQuery) || !vnodeLastRowQueryFromMeter(pSupporter, pRuntimeEnv->pMeterObj)) {
 #if DEFAULT_IO_ENGINE == IO_ENGINE_MMAP
-  for (int32_t i = 0; i < pRuntimeEnv->numOfFiles; ++i) {
-    resetMMapWindow(&pRuntimeEnv->pHeaderFiles[i]);
-  }
+    for (int32_t i = 0; i < pRuntimeEnv->numOfFiles; ++i) {
+      resetMMapWindow(&pRuntimeEnv->pHeaderFiles[i]);
+    }
 #endif
-  SPointInterpoSupporter pointInterpSupporter = {0};
-  pointInterpSupporterInit(pQuery, &pointInterpSupporter);
+    SPointInterpoSupporter pointInterpSupporter = {0};
+    pointInterpSupporterInit(pQuery, &pointInterpSupporter);
+
+    if (!normalizedFirstQueryRange(dataInDisk, dataInCache, pSupporter, &pointInterpSupporter)) {
+      pointInterpSupporterDestroy(&pointInterpSupporter);
+      return 0;
+    }
 
-  if (!normalizedFirstQueryRange(dataInDisk, dataInCache, pSupporter, &pointInterpSupporter)) {
+    /*
+     * here we set the value for before and after the specified time into the
+     * parameter for
+     * interpolation query
+     */
+    pointInterpSupporterSetData(pQInfo, &pointInterpSupporter);
     pointInterpSupporterDestroy(&pointInterpSupporter);
-    return 0;
-  }
 
-  /*
-   * here we set the value for before and after the specified time into the
-   * parameter for
-   * interpolation query
-   */
-  pointInterpSupporterSetData(pQInfo, &pointInterpSupporter);
-  pointInterpSupporterDestroy(&pointInterpSupporter);
+    vnodeScanAllData(pRuntimeEnv);
+  }
 
-  vnodeScanAllData(pRuntimeEnv);
   doFinalizeResult(pRuntimeEnv);
 
   int64_t numOfRes = getNumOfResult(pRuntimeEnv);
@@ -886,7 +890,10 @@ static void vnodeSingleMeterIntervalMainLooper(SMeterQuerySupportObj *pSupporter
            (pQuery->skey >= pQuery->ekey && !QUERY_IS_ASC_QUERY(pQuery)));
 
     initCtxOutputBuf(pRuntimeEnv);
-    vnodeScanAllData(pRuntimeEnv);
+    if (!vnodeIntervalQueryFromRollup(pSupporter)) {
+      vnodeScanAllData(pRuntimeEnv);
+    }
+
     if (isQueryKilled(pQuery)) {
       return;
     }
@@ -206,8 +206,6 @@ static SQInfo *vnodeAllocateQInfoCommon(SQueryMeterMsg *pQueryMsg, SMeterObj *pM
         if (((functId == TSDB_FUNC_FIRST_DST || functId == TSDB_FUNC_FIRST) && pQuery->order.order == TSQL_SO_DESC) ||
             ((functId == TSDB_FUNC_LAST_DST || functId == TSDB_FUNC_LAST) && pQuery->order.order == TSQL_SO_ASC)) {
           pQuery->colList[k].req[1] = 1;
-        } else if (functId == TSDB_FUNC_STDDEV) {
-          pQuery->colList[k].req[1] = 1;
         }
         break;
       }
@@ -630,7 +628,8 @@ void *vnodeQueryInTimeRange(SMeterObj **pMetersObj, SSqlGroupbyExpr *pGroupbyExp
       goto _error;
     }
 
-    if (pQInfo->over == 1) {
+    // the query is over, or the result of last_row query is ready already, no need to schedule
+    if (pQInfo->over == 1 || pQInfo->pointsRead > 0) {
       return pQInfo;
     }
 
@@ -661,7 +660,7 @@ _error:
  * query on multi-meters
  */
 void *vnodeQueryOnMultiMeters(SMeterObj **pMetersObj, SSqlGroupbyExpr *pGroupbyExpr, SSqlFunctionExpr *pSqlExprs,
-                              SQueryMeterMsg *pQueryMsg, int32_t *code) {
+                              SQueryMeterMsg *pQueryMsg, bool emptyResult, int32_t *code) {
   SQInfo *pQInfo;
   SQuery *pQuery;
 
@@ -735,6 +734,14 @@ void *vnodeQueryOnMultiMeters(SMeterObj **pMetersObj, SSqlGroupbyExpr *pGroupbyE
 
   pQInfo->pMeterQuerySupporter = pSupporter;
 
+  // no meter is selected by the tag filter, the queried meter only provides the schema of the empty result
+  if (emptyResult) {
+    dTrace("QInfo:%p no meter is qualified by tag filter, empty result", pQInfo);
+    sem_post(&pQInfo->dataReady);
+    pQInfo->over = 1;
+    return pQInfo;
+  }
+
   if (((*code) = vnodeMultiMeterQueryPrepare(pQInfo, pQuery)) != TSDB_CODE_SUCCESS) {
     goto _error;
   }
@@ -800,13 +807,23 @@ int vnodeRetrieveQueryInfo(void *handle, int *numOfRows, int *rowSize, int16_t *
 }
 
 // vnodeRetrieveQueryInfo must be called first
-int vnodeSaveQueryResult(void *handle, char *data) {
+int vnodeSaveQueryResult(void *handle, char *data, int8_t *compressed, int32_t *size) {
   SQInfo *pQInfo = (SQInfo *)handle;
 
   // the remained number of retrieved rows, not the interpolated result
   int numOfRows = pQInfo->pointsRead - pQInfo->pointsReturned;
 
-  int32_t numOfFinal = vnodeCopyQueryResultToMsg(pQInfo, data, numOfRows);
+  int32_t numOfFinal = -1;
+  if (*compressed) {
+    numOfFinal = vnodeCompressQueryResultToMsg(pQInfo, data, numOfRows, size);
+  }
+
+  // fall back to raw format if compression is not required or failed
+  if (numOfFinal < 0) {
+    *compressed = 0;
+    numOfFinal = vnodeCopyQueryResultToMsg(pQInfo, data, numOfRows);
+    *size = vnodeGetResultSize(pQInfo, &numOfFinal);
+  }
   pQInfo->pointsReturned += numOfFinal;  //(pQInfo->pointsRead + pQInfo->pointsInterpo);
 
   dTrace("QInfo:%p %d are returned, totalReturned:%d totalRead:%d", pQInfo, numOfFinal, pQInfo->pointsReturned,
@@ -868,7 +885,8 @@ static int32_t validateQueryMeterMsg(SQueryMeterMsg *pQueryMsg) {
     return -1;
   }
 
-  if (pQueryMsg->numOfSids <= 0) {
+  // the meters are selected by vnode if tag filter exists
+  if (pQueryMsg->numOfSids < 0 || (pQueryMsg->numOfSids == 0 && pQueryMsg->tagFilterLen <= 0)) {
     dError("qmsg:%p illegal value of numOfSids %ld", pQueryMsg, pQueryMsg->numOfSids);
     return -1;
   }
@@ -919,6 +937,7 @@ int32_t vnodeConvertQueryMeterMsg(SQueryMeterMsg *pQueryMsg) {
 
   pQueryMsg->limit = htobe64(pQueryMsg->limit);
   pQueryMsg->offset = htobe64(pQueryMsg->offset);
+  pQueryMsg->tagFilterLen = htonl(pQueryMsg->tagFilterLen);
 
   // query msg safety check
   if (validateQueryMeterMsg(pQueryMsg) != 0) {
@@ -1009,19 +1028,23 @@ int32_t vnodeConvertQueryMeterMsg(SQueryMeterMsg *pQueryMsg) {
     pMsg += pQueryMsg->colNameLen;
   }
 
-  pSids = (SMeterSidExtInfo **)calloc(pQueryMsg->numOfSids, sizeof(SMeterSidExtInfo *));
-  pQueryMsg->pSidExtInfo = (uint64_t)pSids;
+  if (pQueryMsg->numOfSids > 0) {
+    pSids = (SMeterSidExtInfo **)calloc(pQueryMsg->numOfSids, sizeof(SMeterSidExtInfo *));
+    pQueryMsg->pSidExtInfo = (uint64_t)pSids;
 
-  pSids[0] = (SMeterSidExtInfo *)pMsg;
-  pSids[0]->sid = htonl(pSids[0]->sid);
+    pSids[0] = (SMeterSidExtInfo *)pMsg;
+    pSids[0]->sid = htonl(pSids[0]->sid);
 
-  for (int32_t j = 1; j < pQueryMsg->numOfSids; ++j) {
-    pSids[j] = (SMeterSidExtInfo *)((char *)pSids[j - 1] + sizeof(SMeterSidExtInfo) + pQueryMsg->tagLength);
-    pSids[j]->sid = htonl(pSids[j]->sid);
-  }
+    for (int32_t j = 1; j < pQueryMsg->numOfSids; ++j) {
+      pSids[j] = (SMeterSidExtInfo *)((char *)pSids[j - 1] + sizeof(SMeterSidExtInfo) + pQueryMsg->tagLength);
+      pSids[j]->sid = htonl(pSids[j]->sid);
+    }
 
-  pMsg = (char *)pSids[pQueryMsg->numOfSids - 1];
-  pMsg += sizeof(SMeterSidExtInfo) + pQueryMsg->tagLength;
+    pMsg = (char *)pSids[pQueryMsg->numOfSids - 1];
+    pMsg += sizeof(SMeterSidExtInfo) + pQueryMsg->tagLength;
+  } else {
+    pQueryMsg->pSidExtInfo = 0;
+  }
 
   if (pQueryMsg->numOfGroupbyCols > 0 || pQueryMsg->numOfTagsCols > 0) {  // group by tag columns
     pQueryMsg->pTagSchema = (uint64_t)pMsg;
@@ -1050,6 +1073,33 @@ int32_t vnodeConvertQueryMeterMsg(SQueryMeterMsg *pQueryMsg) {
     for (int32_t i = 0; i < pQueryMsg->numOfOutputCols; ++i) {
       v[i] = htobe64(v[i]);
     }
+
+    pMsg += sizeof(int64_t) * pQueryMsg->numOfOutputCols;
+  }
+
+  if (pQueryMsg->tagFilterLen > 0) {
+    STagFilterMsg *pFilter = (STagFilterMsg *)pMsg;
+    pQueryMsg->pTagFilter = (uint64_t)pFilter;
+
+    pFilter->metricUid = htobe64(pFilter->metricUid);
+    pFilter->tagSig = htonl(pFilter->tagSig);
+    pFilter->numOfTags = htons(pFilter->numOfTags);
+    pFilter->condLen = htonl(pFilter->condLen);
+
+    if (pFilter->numOfTags <= 0 || pFilter->numOfTags > TSDB_MAX_TAGS || pFilter->condLen < 0 ||
+        pQueryMsg->tagFilterLen != sizeof(STagFilterMsg) + sizeof(SSchema) * pFilter->numOfTags +
+                                       sizeof(int16_t) * pQueryMsg->numOfTagsCols + pFilter->condLen) {
+      dError("qmsg:%p illegal tag filter, numOfTags:%d, condLen:%d, length:%d", pQueryMsg, pFilter->numOfTags,
+             pFilter->condLen, pQueryMsg->tagFilterLen);
+      return TSDB_CODE_INVALID_QUERY_MSG;
+    }
+
+    int16_t *tagCols = (int16_t *)(pFilter->data + sizeof(SSchema) * pFilter->numOfTags);
+    for (int32_t i = 0; i < pQueryMsg->numOfTagsCols; ++i) {
+      tagCols[i] = htons(tagCols[i]);
+    }
+  } else {
+    pQueryMsg->pTagFilter = 0;
   }
 
   dTrace("qmsg:%p query on %d meter(s), qrange:%lld-%lld, numOfGroupbyTagCols:%d, numOfTagCols:%d, timestamp order:%d, "
@@ -0,0 +1,757 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <float.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "textbuffer.h"
+#include "tinterpolation.h"
+#include "tsqlfunction.h"
+#include "vnode.h"
+#include "vnodeFile.h"
+#include "vnodeRead.h"
+#include "vnodeRollup.h"
+#include "vnodeUtil.h"
+
+#define ROLLUP_BUF_BUCKETS 256  // buckets loaded into memory at one time
+
+typedef struct {
+  SRollupInfo info;             // entry to be saved into the new rollup file
+  int64_t     oldOffset;        // buckets aggregated in previous commits
+  int32_t     oldNumOfBuckets;
+  int32_t     numOfBuckets;     // buckets aggregated in this round of commit
+  int32_t     capacity;
+  char *      pBuckets;
+} SRollupMeter;
+
+typedef struct {
+  int64_t       interval;
+  int           fd;  // rollup file written by previous commit
+  SRollupMeter *meters;
+} SRollupLevel;
+
+typedef struct {
+  SVnodeObj *  pVnode;
+  SMeterInfo * meterInfo;
+  int32_t      fileId;
+  SRollupLevel levels[TSDB_MAX_ROLLUP_LEVELS];
+} SRollupCommit;
+
+/*
+ * buckets are aggregated in the rollup file of each data file, so a level shall divide one day, the unit of file
+ * span, to keep any bucket in one file. The levels of databases created before the check are ignored.
+ */
+static int64_t vnodeGetRollupInterval(SVnodeCfg *pCfg, int level) {
+  if (pCfg->rollupLevels[level] <= 0 || 86400 % pCfg->rollupLevels[level] != 0) return 0;
+  return (int64_t)pCfg->rollupLevels[level] * (tsMsPerDay[(uint8_t)pCfg->precision] / 86400);
+}
+
+static TSKEY vnodeGetBucketKey(TSKEY key, int64_t interval) { return key - ((key % interval) + interval) % interval; }
+
+static int vnodeGetRollupIndexSize(SVnodeCfg *pCfg) {
+  return sizeof(SRollupInfo) * pCfg->maxSessions + sizeof(TSCKSUM);
+}
+
+void vnodeGetRollupName(char *name, int vnode, int fileId, int level) {
+  sprintf(name, "%s/vnode%d/db/v%df%d.r%d", tsDirectory, vnode, vnode, fileId, level);
+}
+
+static int vnodeReadRollupIndex(int fd, SRollupInfo *pIndex, int size) {
+  if (pread(fd, pIndex, size, TSDB_FILE_HEADER_LEN) != size) return -1;
+  if (!taosCheckChecksumWhole((uint8_t *)pIndex, size)) return -1;
+
+  return 0;
+}
+
+int vnodeCreateEmptyRollupFiles(int vnode, int fileId) {
+  SVnodeCfg *pCfg = &vnodeList[vnode].cfg;
+  char       name[TSDB_FILENAME_LEN];
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    if (vnodeGetRollupInterval(pCfg, level) <= 0) continue;
+
+    vnodeGetRollupName(name, vnode, fileId, level);
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU | S_IRWXG | S_IRWXO);
+    if (fd < 0) {
+      dError("vid:%d, failed to create rollup file:%s, reason:%s", vnode, name, strerror(errno));
+      return -1;
+    }
+
+    vnodeCreateFileHeaderFd(fd);
+    int   size = vnodeGetRollupIndexSize(pCfg);
+    char *temp = calloc(1, size);
+    taosCalcChecksumAppend(0, (uint8_t *)temp, size);
+
+    lseek(fd, TSDB_FILE_HEADER_LEN, SEEK_SET);
+    twrite(fd, temp, size);
+    free(temp);
+    close(fd);
+  }
+
+  return 0;
+}
+
+void vnodeRemoveRollupFiles(int vnode, int fileId) {
+  char name[TSDB_FILENAME_LEN];
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    vnodeGetRollupName(name, vnode, fileId, level);
+    remove(name);
+  }
+}
+
+static void vnodeInitRollupMeter(SRollupMeter *pMeter, SMeterObj *pObj, int8_t invalid) {
+  memset(&pMeter->info, 0, sizeof(SRollupInfo));
+  pMeter->info.uid = pObj->uid;
+  pMeter->info.sversion = pObj->sversion;
+  pMeter->info.numOfCols = pObj->numOfColumns - 1;
+  pMeter->info.lastKey = INT64_MIN;
+  pMeter->info.invalid = invalid;
+
+  pMeter->oldNumOfBuckets = 0;
+  pMeter->numOfBuckets = 0;
+}
+
+void vnodeCleanUpRollupCommit(void *handle) {
+  SRollupCommit *pCommit = (SRollupCommit *)handle;
+  if (pCommit == NULL) return;
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    SRollupLevel *pLevel = pCommit->levels + level;
+    if (pLevel->fd > 0) close(pLevel->fd);
+
+    if (pLevel->meters != NULL) {
+      for (int sid = 0; sid < pCommit->pVnode->cfg.maxSessions; ++sid) {
+        tfree(pLevel->meters[sid].pBuckets);
+      }
+      free(pLevel->meters);
+    }
+  }
+
+  free(pCommit);
+}
+
+void *vnodeInitRollupCommit(SVnodeObj *pVnode, int fileId, SMeterInfo *meterInfo) {
+  SVnodeCfg *    pCfg = &pVnode->cfg;
+  SRollupCommit *pCommit = NULL;
+  SRollupInfo *  pIndex = NULL;
+  char           name[TSDB_FILENAME_LEN];
+  int            size = vnodeGetRollupIndexSize(pCfg);
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    if (vnodeGetRollupInterval(pCfg, level) <= 0) continue;
+
+    if (pCommit == NULL) {
+      pCommit = (SRollupCommit *)calloc(1, sizeof(SRollupCommit));
+      pIndex = (SRollupInfo *)malloc(size);
+      if (pCommit == NULL || pIndex == NULL) goto _error;
+
+      pCommit->pVnode = pVnode;
+      pCommit->meterInfo = meterInfo;
+      pCommit->fileId = fileId;
+    }
+
+    SRollupLevel *pLevel = pCommit->levels + level;
+    pLevel->interval = vnodeGetRollupInterval(pCfg, level);
+    pLevel->meters = (SRollupMeter *)calloc(pCfg->maxSessions, sizeof(SRollupMeter));
+    if (pLevel->meters == NULL) goto _error;
+
+    // if the old rollup file is absent or broken, the data already in file are not aggregated
+    vnodeGetRollupName(name, pVnode->vnode, fileId, level);
+    pLevel->fd = open(name, O_RDONLY);
+    if (pLevel->fd < 0 || vnodeReadRollupIndex(pLevel->fd, pIndex, size) < 0) {
+      dWarn("vid:%d fileId:%d, rollup file:%s is absent or broken", pVnode->vnode, fileId, name);
+      memset(pIndex, 0, size);
+    }
+
+    for (int sid = 0; sid < pCfg->maxSessions; ++sid) {
+      SMeterObj *pObj = (SMeterObj *)(pVnode->meterList[sid]);
+      if (pObj == NULL || vnodeIsMeterState(pObj, TSDB_METER_STATE_DELETING)) continue;
+
+      SRollupMeter *pMeter = pLevel->meters + sid;
+      SRollupInfo * pOld = pIndex + sid;
+
+      if (pOld->uid == pObj->uid) {
+        pMeter->info = *pOld;
+        if (!pOld->invalid && pOld->sversion == pObj->sversion) {
+          pMeter->oldOffset = pOld->offset;
+          pMeter->oldNumOfBuckets = pOld->numOfBuckets;
+        } else {
+          pMeter->info.invalid = 1;
+        }
+      } else {
+        vnodeInitRollupMeter(pMeter, pObj, meterInfo[sid].oldNumOfBlocks > 0);
+      }
+    }
+  }
+
+  tfree(pIndex);
+  return pCommit;
+
+_error:
+  dError("vid:%d fileId:%d, no enough memory to build rollups", pVnode->vnode, fileId);
+  tfree(pIndex);
+  vnodeCleanUpRollupCommit(pCommit);
+  return NULL;
+}
+
+static void vnodeResetRollupCol(SRollupCol *pCol, int type) {
+  memset(pCol, 0, sizeof(SRollupCol));
+
+  if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    *(double *)&pCol->min = DBL_MAX;
+    *(double *)&pCol->max = -DBL_MAX;
+  } else if (type != TSDB_DATA_TYPE_BINARY && type != TSDB_DATA_TYPE_NCHAR) {
+    pCol->min = INT64_MAX;
+    pCol->max = INT64_MIN;
+  }
+}
+
+static void vnodeMergeRollupCol(SRollupCol *pDst, SRollupCol *pSrc, int type) {
+  pDst->numOfNullPoints += pSrc->numOfNullPoints;
+
+  if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
+    *(double *)&pDst->sum += *(double *)&pSrc->sum;
+    if (*(double *)&pSrc->min < *(double *)&pDst->min) pDst->min = pSrc->min;
+    if (*(double *)&pSrc->max > *(double *)&pDst->max) pDst->max = pSrc->max;
+  } else if (type != TSDB_DATA_TYPE_BINARY && type != TSDB_DATA_TYPE_NCHAR) {
+    pDst->sum += pSrc->sum;
+    if (pSrc->min < pDst->min) pDst->min = pSrc->min;
+    if (pSrc->max > pDst->max) pDst->max = pSrc->max;
+  }
+}
+
+static void vnodeMergeRollupBucket(SRollupBucket *pDst, SRollupBucket *pSrc, SMeterObj *pObj) {
+  pDst->numOfPoints += pSrc->numOfPoints;
+  for (int col = 1; col < pObj->numOfColumns; ++col) {
+    vnodeMergeRollupCol(pDst->cols + col - 1, pSrc->cols + col - 1, pObj->schema[col].type);
+  }
+}
+
+static SRollupBucket *vnodeGetCommitBucket(SRollupMeter *pMeter, SMeterObj *pObj, TSKEY key) {
+  int            bucketSize = ROLLUP_BUCKET_SIZE(pMeter->info.numOfCols);
+  SRollupBucket *pBucket = NULL;
+
+  if (pMeter->numOfBuckets > 0) {
+    pBucket = (SRollupBucket *)(pMeter->pBuckets + (pMeter->numOfBuckets - 1) * bucketSize);
+    if (pBucket->key == key) return pBucket;
+  }
+
+  if (pMeter->numOfBuckets >= pMeter->capacity) {
+    int   capacity = (pMeter->capacity == 0) ? 64 : pMeter->capacity * 2;
+    char *tmp = realloc(pMeter->pBuckets, (size_t)capacity * bucketSize);
+    if (tmp == NULL) return NULL;
+
+    pMeter->pBuckets = tmp;
+    pMeter->capacity = capacity;
+  }
+
+  pBucket = (SRollupBucket *)(pMeter->pBuckets + pMeter->numOfBuckets * bucketSize);
+  pBucket->key = key;
+  pBucket->numOfPoints = 0;
+  pBucket->reserved = 0;
+  for (int col = 1; col < pObj->numOfColumns; ++col) {
+    vnodeResetRollupCol(pBucket->cols + col - 1, pObj->schema[col].type);
+  }
+
+  pMeter->numOfBuckets++;
+  return pBucket;
+}
+
+void vnodeRollupBlock(void *handle, SMeterObj *pObj, SData *data[], int points) {
+  SRollupCommit *pCommit = (SRollupCommit *)handle;
+  if (pCommit == NULL || points <= 0) return;
+
+  TSKEY *keys = (TSKEY *)data[0]->data;
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    SRollupLevel *pLevel = pCommit->levels + level;
+    if (pLevel->meters == NULL) continue;
+
+    SRollupMeter *pMeter = pLevel->meters + pObj->sid;
+    if (pMeter->info.uid != pObj->uid) {
+      // meter is created after the commit starts
+      int8_t invalid = (pMeter->info.uid != 0 || pCommit->meterInfo[pObj->sid].oldNumOfBlocks > 0);
+      vnodeInitRollupMeter(pMeter, pObj, invalid);
+    }
+
+    if (pMeter->info.sversion != pObj->sversion) pMeter->info.invalid = 1;
+    if (pMeter->info.invalid) continue;
+
+    // rows no later than lastKey are aggregated already, e.g., the rows of last block merged into a new block
+    int start = 0;
+    while (start < points && keys[start] <= pMeter->info.lastKey) start++;
+
+    while (start < points) {
+      TSKEY key = vnodeGetBucketKey(keys[start], pLevel->interval);
+      int   end = start + 1;
+      while (end < points && keys[end] < key + pLevel->interval) end++;
+
+      SRollupBucket *pBucket = vnodeGetCommitBucket(pMeter, pObj, key);
+      if (pBucket == NULL) {
+        dError("vid:%d sid:%d id:%s, no enough memory for rollup, it is invalid in fileId:%d", pObj->vnode, pObj->sid,
+               pObj->meterId, pCommit->fileId);
+        pMeter->info.invalid = 1;
+        break;
+      }
+
+      pBucket->numOfPoints += (end - start);
+      for (int col = 1; col < pObj->numOfColumns; ++col) {
+        SRollupCol stat;
+        int64_t    wsum = 0;
+        int        bytes = pObj->schema[col].bytes;
+
+        memset(&stat, 0, sizeof(stat));
+        getStatistics((char *)(keys + start), data[col]->data + start * bytes, bytes, end - start,
+                      pObj->schema[col].type, &stat.min, &stat.max, &stat.sum, &wsum, &stat.numOfNullPoints);
+        vnodeMergeRollupCol(pBucket->cols + col - 1, &stat, pObj->schema[col].type);
+      }
+
+      start = end;
+    }
+
+    if (!pMeter->info.invalid) pMeter->info.lastKey = keys[points - 1];
+  }
+}
+
+/*
+ * copy the buckets in old rollup file and the buckets aggregated in this commit into the new file,
+ * return the number of buckets written, or -1 if the old buckets are broken
+ */
+static int vnodeWriteRollupBuckets(SRollupLevel *pLevel, SRollupMeter *pMeter, SMeterObj *pObj, int fd, char *buffer) {
+  int      bucketSize = ROLLUP_BUCKET_SIZE(pMeter->info.numOfCols);
+  int      numOfBuckets = 0;
+  int      merged = 0;
+  TSCKSUM  oldChksum = 0, chksum = 0, stored = 0;
+  int64_t  offset = pMeter->oldOffset;
+
+  for (int i = 0; i < pMeter->oldNumOfBuckets; i += ROLLUP_BUF_BUCKETS) {
+    int rows = MIN(ROLLUP_BUF_BUCKETS, pMeter->oldNumOfBuckets - i);
+    int len = rows * bucketSize;
+
+    if (pread(pLevel->fd, buffer, len, offset) != len) return -1;
+    oldChksum = taosCalcChecksum(oldChksum, (uint8_t *)buffer, len);
+    offset += len;
+
+    // the first bucket of this commit may be in the same bucket of the last old one
+    if (i + rows == pMeter->oldNumOfBuckets && pMeter->numOfBuckets > 0) {
+      SRollupBucket *pLast = (SRollupBucket *)(buffer + (rows - 1) * bucketSize);
+      SRollupBucket *pFirst = (SRollupBucket *)pMeter->pBuckets;
+      if (pLast->key == pFirst->key) {
+        vnodeMergeRollupBucket(pLast, pFirst, pObj);
+        merged = 1;
+      }
+    }
+
+    chksum = taosCalcChecksum(chksum, (uint8_t *)buffer, len);
+    if (twrite(fd, buffer, len) != len) return -1;
+    numOfBuckets += rows;
+  }
+
+  if (pMeter->oldNumOfBuckets > 0) {
+    if (pread(pLevel->fd, &stored, sizeof(TSCKSUM), offset) != sizeof(TSCKSUM) || stored != oldChksum) return -1;
+  }
+
+  if (pMeter->numOfBuckets > merged) {
+    int len = (pMeter->numOfBuckets - merged) * bucketSize;
+    chksum = taosCalcChecksum(chksum, (uint8_t *)(pMeter->pBuckets + merged * bucketSize), len);
+    if (twrite(fd, pMeter->pBuckets + merged * bucketSize, len) != len) return -1;
+    numOfBuckets += (pMeter->numOfBuckets - merged);
+  }
+
+  if (twrite(fd, &chksum, sizeof(TSCKSUM)) != sizeof(TSCKSUM)) return -1;
+
+  return numOfBuckets;
+}
+
+static int vnodeSaveRollupLevel(SRollupCommit *pCommit, int level) {
+  SVnodeObj *   pVnode = pCommit->pVnode;
+  SRollupLevel *pLevel = pCommit->levels + level;
+  char          name[TSDB_FILENAME_LEN];
+  char          tname[TSDB_FILENAME_LEN + 4];
+  int           size = vnodeGetRollupIndexSize(&pVnode->cfg);
+  char *        buffer = NULL;
+  SRollupInfo * pIndex = NULL;
+  int           fd = -1;
+
+  vnodeGetRollupName(name, pVnode->vnode, pCommit->fileId, level);
+  sprintf(tname, "%s.t", name);
+
+  pIndex = (SRollupInfo *)calloc(1, size);
+  buffer = malloc(ROLLUP_BUF_BUCKETS * ROLLUP_BUCKET_SIZE(TSDB_MAX_COLUMNS));
+  if (pIndex == NULL || buffer == NULL) goto _error;
+
+  fd = open(tname, O_RDWR | O_CREAT | O_TRUNC, S_IRWXU | S_IRWXG | S_IRWXO);
+  if (fd < 0) {
+    dError("vid:%d, failed to open rollup file:%s, reason:%s", pVnode->vnode, tname, strerror(errno));
+    goto _error;
+  }
+
+  vnodeCreateFileHeaderFd(fd);
+  int64_t offset = TSDB_FILE_HEADER_LEN + size;
+
+  for (int sid = 0; sid < pVnode->cfg.maxSessions; ++sid) {
+    SMeterObj *pObj = (SMeterObj *)(pVnode->meterList[sid]);
+    if (pObj == NULL) continue;
+
+    SRollupMeter *pMeter = pLevel->meters + sid;
+    if (pMeter->info.uid != pObj->uid) continue;
+
+    SRollupInfo *pInfo = pIndex + sid;
+    *pInfo = pMeter->info;
+    pInfo->offset = offset;
+    pInfo->numOfBuckets = 0;
+    if (pInfo->invalid) continue;
+
+    lseek(fd, offset, SEEK_SET);
+    int numOfBuckets = vnodeWriteRollupBuckets(pLevel, pMeter, pObj, fd, buffer);
+    if (numOfBuckets < 0) {
+      dError("vid:%d sid:%d id:%s, failed to write rollup of fileId:%d, it is invalid", pVnode->vnode, sid,
+             pObj->meterId, pCommit->fileId);
+      pInfo->invalid = 1;
+      continue;
+    }
+
+    pInfo->numOfBuckets = numOfBuckets;
+    offset += (int64_t)numOfBuckets * ROLLUP_BUCKET_SIZE(pInfo->numOfCols) + sizeof(TSCKSUM);
+  }
+
+  taosCalcChecksumAppend(0, (uint8_t *)pIndex, size);
+  if (pwrite(fd, pIndex, size, TSDB_FILE_HEADER_LEN) != size || ftruncate(fd, offset) != 0) {
+    dError("vid:%d, failed to write rollup file:%s, reason:%s", pVnode->vnode, tname, strerror(errno));
+    goto _error;
+  }
+
+  close(fd);
+  tfree(buffer);
+  tfree(pIndex);
+
+  if (rename(tname, name) < 0) {
+    dError("vid:%d, failed to rename:%s, reason:%s", pVnode->vnode, tname, strerror(errno));
+    remove(tname);
+    return -1;
+  }
+
+  return 0;
+
+_error:
+  if (fd >= 0) close(fd);
+  remove(tname);
+  tfree(buffer);
+  tfree(pIndex);
+  return -1;
+}
+
+int vnodeSaveRollups(void *handle) {
+  SRollupCommit *pCommit = (SRollupCommit *)handle;
+  int            code = 0;
+  char           name[TSDB_FILENAME_LEN];
+
+  if (pCommit == NULL) return 0;
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    if (pCommit->levels[level].meters == NULL) continue;
+
+    if (vnodeSaveRollupLevel(pCommit, level) < 0) {
+      // the old rollup lacks the data committed now, remove it and all meters in file are not rolled up anymore
+      vnodeGetRollupName(name, pCommit->pVnode->vnode, pCommit->fileId, level);
+      remove(name);
+      code = -1;
+    }
+  }
+
+  dTrace("vid:%d fileId:%d, rollups are saved, code:%d", pCommit->pVnode->vnode, pCommit->fileId, code);
+  return code;
+}
+
+void vnodeInvalidateRollup(SMeterObj *pObj, int fileId) {
+  SVnodeCfg *pCfg = &vnodeList[pObj->vnode].cfg;
+  char       name[TSDB_FILENAME_LEN];
+  int        size = vnodeGetRollupIndexSize(pCfg);
+
+  for (int level = 0; level < TSDB_MAX_ROLLUP_LEVELS; ++level) {
+    if (vnodeGetRollupInterval(pCfg, level) <= 0) continue;
+
+    vnodeGetRollupName(name, pObj->vnode, fileId, level);
+    int fd = open(name, O_RDWR);
+    if (fd < 0) continue;
+
+    SRollupInfo *pIndex = (SRollupInfo *)malloc(size);
+    if (pIndex == NULL || vnodeReadRollupIndex(fd, pIndex, size) < 0) {
+      close(fd);
+      tfree(pIndex);
+      remove(name);
+      continue;
+    }
+
+    SRollupInfo *pInfo = pIndex + pObj->sid;
+    if (pInfo->uid != pObj->uid || !pInfo->invalid) {
+      pInfo->uid = pObj->uid;
+      pInfo->sversion = pObj->sversion;
+      pInfo->numOfCols = pObj->numOfColumns - 1;
+      pInfo->numOfBuckets = 0;
+      pInfo->invalid = 1;
+
+      taosCalcChecksumAppend(0, (uint8_t *)pIndex, size);
+      if (pwrite(fd, pIndex, size, TSDB_FILE_HEADER_LEN) != size) {
+        close(fd);
+        remove(name);
+        free(pIndex);
+        continue;
+      }
+    }
+
+    dTrace("vid:%d sid:%d id:%s, rollup of fileId:%d is invalid since data are imported", pObj->vnode, pObj->sid,
+           pObj->meterId, fileId);
+    close(fd);
+    free(pIndex);
+  }
+}
+
+static int32_t vnodeReadRollupInfo(SMeterObj *pObj, int32_t fileId, int32_t level, SRollupInfo *pInfo) {
+  SVnodeCfg *pCfg = &vnodeList[pObj->vnode].cfg;
+  char       name[TSDB_FILENAME_LEN];
+  int        size = vnodeGetRollupIndexSize(pCfg);
+  int32_t    code = -1;
+
+  vnodeGetRollupName(name, pObj->vnode, fileId, level);
+  int fd = open(name, O_RDONLY);
+  if (fd < 0) return -1;
+
+  SRollupInfo *pIndex = (SRollupInfo *)malloc(size);
+  if (pIndex != NULL && vnodeReadRollupIndex(fd, pIndex, size) == 0) {
+    *pInfo = pIndex[pObj->sid];
+    code = 0;
+  }
+
+  tfree(pIndex);
+  close(fd);
+  return code;
+}
+
+static bool vnodeHasDataInFile(SMeterObj *pObj, int32_t fileId) {
+  char        name[TSDB_FILENAME_LEN];
+  SCompHeader compHeader = {0};
+  SCompInfo   compInfo = {0};
+
+  vnodeGetHeadDataLname(name, NULL, NULL, pObj->vnode, fileId);
+  int fd = open(name, O_RDONLY);
+  if (fd < 0) return false;
+
+  bool ret = false;
+  if (pread(fd, &compHeader, sizeof(SCompHeader), TSDB_FILE_HEADER_LEN + pObj->sid * sizeof(SCompHeader)) ==
+      sizeof(SCompHeader)) {
+    if (compHeader.compInfoOffset == 0) {
+      ret = false;
+    } else if (pread(fd, &compInfo, sizeof(SCompInfo), compHeader.compInfoOffset) != sizeof(SCompInfo)) {
+      ret = true;
+    } else {
+      ret = (compInfo.uid == pObj->uid && compInfo.numOfBlocks > 0);
+    }
+  } else {
+    ret = true;
+  }
+
+  close(fd);
+  return ret;
+}
+
+int32_t vnodeInitRollupCursor(SRollupCursor *pCursor, SMeterObj *pObj, int64_t interval, TSKEY skey) {
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+  SVnodeCfg *pCfg = &pVnode->cfg;
+
+  vnodeCloseRollupCursor(pCursor);
+
+  // the largest level that the interval is a multiple of
+  for (int32_t level = TSDB_MAX_ROLLUP_LEVELS - 1; level >= 0; --level) {
+    int64_t len = vnodeGetRollupInterval(pCfg, level);
+    if (len > 0 && interval % len == 0) {
+      pCursor->level = level;
+      pCursor->interval = len;
+      break;
+    }
+  }
+
+  if (pCursor->level < 0 || pVnode->numOfFiles <= 0) {
+    pCursor->level = -1;
+    return -1;
+  }
+
+  /*
+   * data are aggregated into rollups continuously from the file of skey, until a file in which the rollup of meter
+   * is absent or invalid, the data after that are not covered.
+   */
+  int64_t pointsPerFile = tsMsPerDay[(uint8_t)pCfg->precision] * pCfg->daysPerFile;
+  int32_t fileId = pVnode->fileId - pVnode->numOfFiles + 1;
+  if (skey / pointsPerFile > fileId) fileId = skey / pointsPerFile;
+
+  TSKEY coveredKey = INT64_MIN;
+  for (; fileId <= pVnode->fileId; ++fileId) {
+    SRollupInfo info = {0};
+    if (vnodeReadRollupInfo(pObj, fileId, pCursor->level, &info) < 0 || info.uid != pObj->uid) {
+      if (vnodeHasDataInFile(pObj, fileId)) break;
+      continue;
+    }
+
+    if (info.invalid || info.sversion != pObj->sversion) break;
+    if (info.lastKey > coveredKey) coveredKey = info.lastKey;
+  }
+
+  if (coveredKey == INT64_MIN) {
+    pCursor->level = -1;
+    return -1;
+  }
+
+  pCursor->coveredKey = coveredKey;
+  dTrace("vid:%d sid:%d id:%s, rollup level:%d interval:%lld is used, data until %lld are covered", pObj->vnode,
+         pObj->sid, pObj->meterId, pCursor->level, pCursor->interval, coveredKey);
+
+  return pCursor->level;
+}
+
+static int32_t vnodeOpenRollupOfFile(SRollupCursor *pCursor, SMeterObj *pObj, int32_t fileId) {
+  char        name[TSDB_FILENAME_LEN];
+  SRollupInfo info = {0};
+
+  tclose(pCursor->fd);
+  pCursor->fileId = fileId;
+  pCursor->numOfBuckets = 0;
+  pCursor->bufStart = 0;
+  pCursor->bufRows = 0;
+
+  if (vnodeReadRollupInfo(pObj, fileId, pCursor->level, &info) < 0 || info.uid != pObj->uid) {
+    // no data in the file, otherwise the coverage stops before it
+    return 0;
+  }
+
+  if (info.invalid || info.sversion != pObj->sversion) return -1;
+
+  vnodeGetRollupName(name, pObj->vnode, fileId, pCursor->level);
+  pCursor->fd = open(name, O_RDONLY);
+  if (pCursor->fd < 0) return -1;
+
+  pCursor->offset = info.offset;
+  pCursor->numOfBuckets = info.numOfBuckets;
+  pCursor->bucketSize = ROLLUP_BUCKET_SIZE(info.numOfCols);
+
+  if (pCursor->pBuf == NULL) {
+    pCursor->pBuf = malloc(ROLLUP_BUF_BUCKETS * ROLLUP_BUCKET_SIZE(TSDB_MAX_COLUMNS));
+    if (pCursor->pBuf == NULL) return -1;
+  }
+
+  return 0;
+}
+
+static int32_t vnodeLoadRollupBuckets(SRollupCursor *pCursor, int32_t start) {
+  int32_t rows = MIN(ROLLUP_BUF_BUCKETS, pCursor->numOfBuckets - start);
+  int32_t len = rows * pCursor->bucketSize;
+
+  if (pread(pCursor->fd, pCursor->pBuf, len, pCursor->offset + (int64_t)start * pCursor->bucketSize) != len) {
+    pCursor->bufRows = 0;
+    return -1;
+  }
+
+  pCursor->bufStart = start;
+  pCursor->bufRows = rows;
+  return 0;
+}
+
+#define ROLLUP_BUF_BUCKET(c, i) ((SRollupBucket *)((c)->pBuf + (i) * (c)->bucketSize))
+
+/* the position of first bucket whose key is not less than the key in current file */
+static int32_t vnodeSearchRollupBucket(SRollupCursor *pCursor, TSKEY key) {
+  int32_t lo = 0, hi = pCursor->numOfBuckets;
+
+  if (pCursor->bufRows > 0 && key <= ROLLUP_BUF_BUCKET(pCursor, pCursor->bufRows - 1)->key &&
+      (pCursor->bufStart == 0 || key >= ROLLUP_BUF_BUCKET(pCursor, 0)->key)) {
+    lo = 0;
+    hi = pCursor->bufRows - 1;
+    while (lo < hi) {
+      int32_t mid = (lo + hi) >> 1;
+      if (ROLLUP_BUF_BUCKET(pCursor, mid)->key < key) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+
+    return pCursor->bufStart + lo;
+  }
+
+  while (lo < hi) {
+    int32_t mid = (lo + hi) >> 1;
+    TSKEY   midKey = 0;
+    if (pread(pCursor->fd, &midKey, sizeof(TSKEY), pCursor->offset + (int64_t)mid * pCursor->bucketSize) !=
+        sizeof(TSKEY)) {
+      return -1;
+    }
+
+    if (midKey < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo < pCursor->numOfBuckets && vnodeLoadRollupBuckets(pCursor, lo) < 0) return -1;
+  return lo;
+}
+
+int32_t vnodeGetRollupBucket(SRollupCursor *pCursor, SMeterObj *pObj, TSKEY key, SRollupBucket **pBucket) {
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+  SVnodeCfg *pCfg = &pVnode->cfg;
+  int64_t    pointsPerFile = tsMsPerDay[(uint8_t)pCfg->precision] * pCfg->daysPerFile;
+
+  *pBucket = NULL;
+  if (key > pCursor->coveredKey) return 0;
+
+  int32_t fileId = (int32_t)(key / pointsPerFile);
+  if (pCursor->fileId > fileId) fileId = pCursor->fileId;
+
+  for (; fileId <= pVnode->fileId; ++fileId) {
+    if (pCursor->fileId != fileId) {
+      if (vnodeOpenRollupOfFile(pCursor, pObj, fileId) < 0) return -1;
+    }
+
+    if (pCursor->numOfBuckets == 0) continue;
+
+    int32_t pos = vnodeSearchRollupBucket(pCursor, key);
+    if (pos < 0) return -1;
+    if (pos >= pCursor->numOfBuckets) continue;
+
+    SRollupBucket *pCur = ROLLUP_BUF_BUCKET(pCursor, pos - pCursor->bufStart);
+    if (pCur->key > pCursor->coveredKey) return 0;
+
+    *pBucket = pCur;
+    return 1;
+  }
+
+  return 0;
+}
+
+void vnodeCloseRollupCursor(SRollupCursor *pCursor) {
+  tclose(pCursor->fd);
+  tfree(pCursor->pBuf);
+
+  pCursor->level = -1;
+  pCursor->fd = -1;
+  pCursor->fileId = -1;
+  pCursor->numOfBuckets = 0;
+  pCursor->bufRows = 0;
+  pCursor->rawPosInvalid = false;
+}
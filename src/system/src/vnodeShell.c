@@ -53,6 +53,7 @@ void *vnodeProcessMsgFromShell(char *msg, void *ahandle, void *thandle) {
 
   if (msg == NULL) {
     if (pObj) {
+      vnodeCancelSubscribe(pObj);
       pObj->thandle = NULL;
       dTrace("QInfo:%p %s free qhandle", pObj->qhandle, __FUNCTION__);
       vnodeFreeQInfoInQueue(pObj->qhandle);
@@ -97,6 +98,8 @@ void *vnodeProcessMsgFromShell(char *msg, void *ahandle, void *thandle) {
     vnodeProcessRetrieveRequest((char *)pMsg->content, pMsg->msgLen - sizeof(SIntMsg), pObj);
   } else if (pMsg->msgType == TSDB_MSG_TYPE_SUBMIT) {
     vnodeProcessShellSubmitRequest((char *)pMsg->content, pMsg->msgLen - sizeof(SIntMsg), pObj);
+  } else if (pMsg->msgType == TSDB_MSG_TYPE_SUBSCRIBE) {
+    vnodeProcessSubscribeRequest((char *)pMsg->content, pMsg->msgLen - sizeof(SIntMsg), pObj);
   } else {
     dError("%s is not processed", taosMsg[pMsg->msgType]);
   }
@@ -242,17 +245,13 @@ int vnodeProcessQueryRequest(char *pMsg, int msgLen, SShellObj *pObj) {
   SSqlFunctionExpr * pExprs = NULL;
   SSqlGroupbyExpr *  pGroupbyExpr = NULL;
   SMeterObj **       pMeterObjList = NULL;
+  bool               emptyResult = false;
 
   pQueryMsg = (SQueryMeterMsg *)pMsg;
   if ((code = vnodeConvertQueryMeterMsg(pQueryMsg)) != TSDB_CODE_SUCCESS) {
     goto _query_over;
   }
 
-  if (pQueryMsg->numOfSids <= 0) {
-    code = TSDB_CODE_INVALID_QUERY_MSG;
-    goto _query_over;
-  }
-
   if (pQueryMsg->vnode >= TSDB_MAX_VNODES || pQueryMsg->vnode < 0) {
     dTrace("qmsg:%p,vid:%d is out of range", pQueryMsg, pQueryMsg->vnode);
     code = TSDB_CODE_INVALID_SESSION_ID;
@@ -273,15 +272,25 @@ int vnodeProcessQueryRequest(char *pMsg, int msgLen, SShellObj *pObj) {
     goto _query_over;
   }
 
-  if (pQueryMsg->pSidExtInfo == 0) {
-    dTrace("qmsg:%p,SQueryMeterMsg wrong format", pQueryMsg);
+  if (pVnode->meterList == NULL) {
+    dError("qmsg:%p,vid:%d has been closed", pQueryMsg, pQueryMsg->vnode);
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+    goto _query_over;
+  }
+
+  // the meters of metric query are selected by the tag condition in vnode
+  if (pQueryMsg->tagFilterLen > 0 && (code = vnodeFilterMetersByTags(pQueryMsg, &emptyResult)) != TSDB_CODE_SUCCESS) {
+    goto _query_over;
+  }
+
+  if (pQueryMsg->numOfSids <= 0) {
     code = TSDB_CODE_INVALID_QUERY_MSG;
     goto _query_over;
   }
 
-  if (pVnode->meterList == NULL) {
-    dError("qmsg:%p,vid:%d has been closed", pQueryMsg, pQueryMsg->vnode);
-    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+  if (pQueryMsg->pSidExtInfo == 0) {
+    dTrace("qmsg:%p,SQueryMeterMsg wrong format", pQueryMsg);
+    code = TSDB_CODE_INVALID_QUERY_MSG;
     goto _query_over;
   }
 
@@ -331,7 +340,7 @@ int vnodeProcessQueryRequest(char *pMsg, int msgLen, SShellObj *pObj) {
   }
 
   if (pQueryMsg->metricQuery) {
-    pObj->qhandle = vnodeQueryOnMultiMeters(pMeterObjList, pGroupbyExpr, pExprs, pQueryMsg, &code);
+    pObj->qhandle = vnodeQueryOnMultiMeters(pMeterObjList, pGroupbyExpr, pExprs, pQueryMsg, emptyResult, &code);
   } else {
     assert(pGroupbyExpr == NULL);
     pObj->qhandle = vnodeQueryInTimeRange(pMeterObjList, pGroupbyExpr, pExprs, pQueryMsg, &code);
@@ -361,6 +370,7 @@ void vnodeExecuteRetrieveReq(SSchedMsg *pSched) {
   SRetrieveMeterRsp *pRsp;
   int                numOfRows = 0, rowSize = 0, size = 0;
   int16_t            timePrec = TSDB_TIME_PRECISION_MILLI;
+  int8_t             compressed = 0;
 
   char *pStart;
 
@@ -381,7 +391,12 @@ void vnodeExecuteRetrieveReq(SSchedMsg *pSched) {
   }
 
   if (code == TSDB_CODE_SUCCESS) {
-    size = vnodeGetResultSize((void *)(pRetrieve->qhandle), &numOfRows);
+    compressed = pRetrieve->compressed;
+    if (compressed) {
+      size = vnodeGetCompressedResultSize((void *)(pRetrieve->qhandle), &numOfRows);
+    } else {
+      size = vnodeGetResultSize((void *)(pRetrieve->qhandle), &numOfRows);
+    }
   }
 
   pStart = taosBuildRspMsgWithSize(pObj->thandle, TSDB_MSG_TYPE_RETRIEVE_RSP, size + 100);
@@ -406,9 +421,12 @@ void vnodeExecuteRetrieveReq(SSchedMsg *pSched) {
   pMsg = pRsp->data;
 
   if (numOfRows > 0 && code == TSDB_CODE_SUCCESS) {
-    vnodeSaveQueryResult((void *)(pRetrieve->qhandle), pRsp->data);
+    vnodeSaveQueryResult((void *)(pRetrieve->qhandle), pRsp->data, &compressed, &size);
+  } else {
+    compressed = 0;
   }
 
+  pRsp->compressed = compressed;
   pMsg += size;
   msgLen = pMsg - pStart;
 
@@ -429,7 +447,8 @@ _exit:
 int vnodeProcessRetrieveRequest(char *pMsg, int msgLen, SShellObj *pObj) {
   SSchedMsg schedMsg;
 
-  char *msg = malloc(msgLen);
+  // the compressed flag is absent in the message from clients of earlier versions
+  char *msg = calloc(1, MAX(msgLen, sizeof(SRetrieveMeterMsg)));
   memcpy(msg, pMsg, msgLen);
   schedMsg.msg = msg;
   schedMsg.ahandle = pObj;
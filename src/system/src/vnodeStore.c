@@ -51,12 +51,16 @@ int vnodeInitStoreVnode(int vnode) {
 
   if (vnodeInitFile(vnode) < 0) return -1;
 
+  // the last rows in files are restored before data in commit log
+  vnodeRestoreLastRows(vnode);
+
   if (vnodeInitCommit(vnode) < 0) {
     dError("vid:%d, commit init failed.", pVnode->vnode);
     return -1;
   }
 
   pthread_mutex_init(&(pVnode->vmutex), NULL);
+  pthread_mutex_init(&(pVnode->incStreamMutex), NULL);
   dTrace("vid:%d, storage initialized, version:%ld fileId:%d numOfFiles:%d", vnode, pVnode->version, pVnode->fileId,
          pVnode->numOfFiles);
 
@@ -131,6 +135,7 @@ int vnodeCloseVnode(int vnode) {
   vnodeCleanUpCommit(vnode);
 
   pthread_mutex_destroy(&(vnodeList[vnode].vmutex));
+  pthread_mutex_destroy(&(vnodeList[vnode].incStreamMutex));
 
   if (tsMaxVnode == vnode) tsMaxVnode = vnode - 1;
 
@@ -14,30 +14,22 @@
  */
 
 #include "taosmsg.h"
+#include "tsql.h"
+#include "ttime.h"
 #include "vnode.h"
 #include "vnodeUtil.h"
 
 /* static TAOS *dbConn = NULL; */
 void vnodeCloseStreamCallback(void *param);
 
-void vnodeProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
-  SMeterObj *pObj = (SMeterObj *)param;
-  dTrace("vid:%d sid:%d id:%s, stream result is ready", pObj->vnode, pObj->sid, pObj->meterId);
-
-  // construct data
-  int32_t     contLen = pObj->bytesPerPoint;
-  char *      pTemp = calloc(1, sizeof(SSubmitMsg) + pObj->bytesPerPoint + sizeof(SVMsgHeader));
-  SSubmitMsg *pMsg = (SSubmitMsg *)(pTemp + sizeof(SVMsgHeader));
-
-  pMsg->numOfRows = htons(1);
-
+static void vnodeBuildStreamRow(SMeterObj *pObj, TAOS_ROW row, char *pRow) {
   char ncharBuf[TSDB_MAX_BYTES_PER_ROW] = {0};
 
   int32_t offset = 0;
   for (int32_t i = 0; i < pObj->numOfColumns; ++i) {
     char *dst = row[i];
     if (dst == NULL) {
-      setNull(pMsg->payLoad + offset, pObj->schema[i].type, pObj->schema[i].bytes);
+      setNull(pRow + offset, pObj->schema[i].type, pObj->schema[i].bytes);
     } else {
       // here, we need to transfer nchar(utf8) to unicode(ucs-4)
       if (pObj->schema[i].type == TSDB_DATA_TYPE_NCHAR) {
@@ -45,11 +37,24 @@ void vnodeProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
         dst = ncharBuf;
       }
 
-      memcpy(pMsg->payLoad + offset, dst, pObj->schema[i].bytes);
+      memcpy(pRow + offset, dst, pObj->schema[i].bytes);
     }
 
     offset += pObj->schema[i].bytes;
   }
+}
+
+void vnodeProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
+  SMeterObj *pObj = (SMeterObj *)param;
+  dTrace("vid:%d sid:%d id:%s, stream result is ready", pObj->vnode, pObj->sid, pObj->meterId);
+
+  // construct data
+  int32_t     contLen = pObj->bytesPerPoint;
+  char *      pTemp = calloc(1, sizeof(SSubmitMsg) + pObj->bytesPerPoint + sizeof(SVMsgHeader));
+  SSubmitMsg *pMsg = (SSubmitMsg *)(pTemp + sizeof(SVMsgHeader));
+
+  pMsg->numOfRows = htons(1);
+  vnodeBuildStreamRow(pObj, row, pMsg->payLoad);
 
   contLen += sizeof(SSubmitMsg);
 
@@ -75,6 +80,1000 @@ static void vnodeGetDBFromMeterId(SMeterObj *pObj, char *db) {
   memcpy(db, st + 1, end - (st + 1));
 }
 
+/*
+ * stream of "select aggregates from table interval(x)" on a table in the same vnode is computed incrementally:
+ * rows are aggregated into the state of current window when they are inserted, the window is closed when data of
+ * later windows arrive or the clock passes it, and results are written into the stream table in batch by a timer.
+ * Since vnode does not know the column names, they are bound by describing the table through the connection to
+ * system itself, and the windows earlier than the data of table at that time are computed by one query. Other
+ * streams are computed by the client stream through the connection.
+ */
+#define TSDB_INC_STREAM_TIMER 1000  // ms
+
+enum {
+  TSDB_INC_STREAM_INIT,     // column names are not bound yet
+  TSDB_INC_STREAM_BINDING,  // describing the table
+  TSDB_INC_STREAM_CATCHUP_WAITING,
+  TSDB_INC_STREAM_CATCHUP_RUNNING,
+  TSDB_INC_STREAM_READY,
+};
+
+typedef struct {
+  int16_t functionId;
+  int16_t colId;
+  int16_t colIdx;  // index of column in source schema, -1 if the column is dropped
+  char    colName[TSDB_COL_NAME_LEN];  // empty for count(*)
+  int16_t type;
+  int16_t bytes;
+  int32_t offset;  // offset of column in source row
+  int64_t numOfPoints;
+  int64_t isum;
+  int64_t imin;
+  int64_t imax;
+  double  dsum;
+  double  dmin;
+  double  dmax;
+  char *  pFirst;
+  char *  pLast;
+} SIncStreamExpr;
+
+typedef struct SIncStream {
+  int                vnode;
+  SMeterObj *        pObj;  // stream table
+  SMeterObj *        pSrc;  // table the stream is computed on
+  int32_t            srcSversion;
+  int64_t            interval;
+  int64_t            delay;  // window is closed by the clock after the delay, if no later data arrive
+  TSKEY              skey;   // start key of current window
+  int64_t            numOfPoints;
+  int8_t             state;
+  int8_t             dropped;
+  TSKEY              catchupKey;  // windows before it are computed by query
+  int64_t            retryTime;
+  char *             sql;
+  int32_t            fromPos;  // position of the table name in sql
+  int32_t            fromLen;
+  char *             catchupSql;
+  char *             pRows;  // results not written yet
+  int32_t            numOfRows;
+  int32_t            maxRows;
+  char *             pCatchupRows;
+  int32_t            numOfCatchupRows;
+  int32_t            maxCatchupRows;
+  struct SIncStream *srcNext;  // next stream computed on the same table
+  struct SIncStream *next;
+  int32_t            numOfExprs;
+  SIncStreamExpr     exprs[];
+} SIncStream;
+
+static void vnodeProcessIncStreamTimer(void *param, void *tmrId);
+
+static int32_t vnodeGetIncStreamFunc(uint32_t optr) {
+  switch (optr) {
+    case TK_COUNT:
+      return TSDB_FUNC_COUNT;
+    case TK_SUM:
+      return TSDB_FUNC_SUM;
+    case TK_AVG:
+      return TSDB_FUNC_AVG;
+    case TK_MIN:
+      return TSDB_FUNC_MIN;
+    case TK_MAX:
+      return TSDB_FUNC_MAX;
+    case TK_FIRST:
+      return TSDB_FUNC_FIRST;
+    case TK_LAST:
+      return TSDB_FUNC_LAST;
+    case TK_SPREAD:
+      return TSDB_FUNC_SPREAD;
+    default:
+      return -1;
+  }
+}
+
+static bool vnodeIsFloatType(int16_t type) { return type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE; }
+
+static int16_t vnodeGetIncStreamResType(int32_t functionId, int16_t type) {
+  switch (functionId) {
+    case TSDB_FUNC_COUNT:
+      return TSDB_DATA_TYPE_BIGINT;
+    case TSDB_FUNC_SUM:
+      return vnodeIsFloatType(type) ? TSDB_DATA_TYPE_DOUBLE : TSDB_DATA_TYPE_BIGINT;
+    case TSDB_FUNC_AVG:
+    case TSDB_FUNC_SPREAD:
+      return TSDB_DATA_TYPE_DOUBLE;
+    default:
+      return type;
+  }
+}
+
+static SMeterObj *vnodeGetIncStreamSource(SMeterObj *pObj, SSQLToken *pFrom) {
+  SVnodeObj *pVnode = vnodeList + pObj->vnode;
+  char       meterId[TSDB_METER_ID_LEN] = {0};
+
+  // the db of stream table is used if it is not specified, meter id is in the form of acct.db.meter
+  char *acct = strstr(pObj->meterId, ".");
+  char *db = (acct == NULL) ? NULL : strstr(acct + 1, ".");
+  if (db == NULL || pFrom->n <= 0 || pFrom->n >= TSDB_METER_ID_LEN) return NULL;
+
+  if (memchr(pFrom->z, '.', pFrom->n) != NULL) {
+    snprintf(meterId, TSDB_METER_ID_LEN, "%.*s%.*s", (int)(acct + 1 - pObj->meterId), pObj->meterId, pFrom->n,
+             pFrom->z);
+  } else {
+    snprintf(meterId, TSDB_METER_ID_LEN, "%.*s%.*s", (int)(db + 1 - pObj->meterId), pObj->meterId, pFrom->n, pFrom->z);
+  }
+
+  for (int sid = 0; sid < pVnode->cfg.maxSessions; ++sid) {
+    SMeterObj *pSrc = pVnode->meterList[sid];
+    if (pSrc != NULL && pSrc != pObj && strcasecmp(pSrc->meterId, meterId) == 0 &&
+        !vnodeIsMeterState(pSrc, TSDB_METER_STATE_DELETING)) {
+      return pSrc;
+    }
+  }
+
+  return NULL;
+}
+
+// the columns of source table are located by id, since the schema may be changed
+static void vnodeResolveIncStreamColumns(SIncStream *pStream) {
+  SMeterObj *pSrc = pStream->pSrc;
+
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    SIncStreamExpr *pExpr = &pStream->exprs[i];
+    int32_t         offset = 0;
+
+    pExpr->colIdx = -1;
+    for (int32_t j = 0; j < pSrc->numOfColumns; ++j) {
+      if (pSrc->schema[j].colId == pExpr->colId && pSrc->schema[j].type == pExpr->type &&
+          pSrc->schema[j].bytes == pExpr->bytes) {
+        pExpr->colIdx = j;
+        pExpr->offset = offset;
+        break;
+      }
+
+      offset += pSrc->schema[j].bytes;
+    }
+  }
+
+  pStream->srcSversion = pSrc->sversion;
+}
+
+static void vnodeFreeIncStream(SIncStream *pStream) {
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    tfree(pStream->exprs[i].pFirst);
+    tfree(pStream->exprs[i].pLast);
+  }
+
+  tfree(pStream->sql);
+  tfree(pStream->catchupSql);
+  tfree(pStream->pRows);
+  tfree(pStream->pCatchupRows);
+  free(pStream);
+}
+
+static SIncStream *vnodeCreateIncStream(SMeterObj *pObj) {
+  SVnodeObj * pVnode = vnodeList + pObj->vnode;
+  SIncStream *pStream = NULL;
+  SSqlInfo    info = {0};
+  bool        valid = false;
+
+  char *sql = calloc(1, pObj->sqlLen + 1);
+  if (sql == NULL) return NULL;
+  memcpy(sql, pObj->pSql, pObj->sqlLen);
+
+  tSQLParse(&info, sql);
+
+  SQuerySQL *pQuerySql = info.pQueryInfo;
+  if (!info.validSql || info.sqlType != TSQL_QUERY_METER || pQuerySql->pSelection == NULL ||
+      pQuerySql->pWhere != NULL || pQuerySql->pGroupby != NULL || pQuerySql->pSortOrder != NULL ||
+      pQuerySql->fillType != NULL || pQuerySql->limit.limit != -1 || pQuerySql->interval.n <= 0) {
+    goto _over;
+  }
+
+  // intervals of day or longer are aligned to the time zone by query
+  char unit = pQuerySql->interval.z[pQuerySql->interval.n - 1];
+  if (unit != 'a' && unit != 's' && unit != 'm' && unit != 'h') goto _over;
+
+  int64_t interval = 0;
+  int64_t sliding = 0;
+  if (getTimestampInUsFromStr(pQuerySql->interval.z, pQuerySql->interval.n, &interval) != TSDB_CODE_SUCCESS) {
+    goto _over;
+  }
+
+  if (pQuerySql->sliding.n > 0) {
+    if (getTimestampInUsFromStr(pQuerySql->sliding.z, pQuerySql->sliding.n, &sliding) != TSDB_CODE_SUCCESS ||
+        sliding != interval) {
+      goto _over;
+    }
+  }
+
+  if (pVnode->cfg.precision == TSDB_TIME_PRECISION_MILLI) interval /= 1000;
+  if (interval <= 0) goto _over;
+
+  SMeterObj *pSrc = vnodeGetIncStreamSource(pObj, &pQuerySql->from);
+  if (pSrc == NULL) goto _over;
+
+  // the first column of stream table is the start key of window, followed by the result of each expression
+  int32_t numOfExprs = pQuerySql->pSelection->nExpr;
+  if (numOfExprs + 1 != pObj->numOfColumns) goto _over;
+
+  pStream = calloc(1, sizeof(SIncStream) + numOfExprs * sizeof(SIncStreamExpr));
+  if (pStream == NULL) goto _over;
+
+  pStream->numOfExprs = numOfExprs;
+  for (int32_t i = 0; i < numOfExprs; ++i) {
+    tSQLExpr *      pNode = pQuerySql->pSelection->a[i].pNode;
+    SIncStreamExpr *pExpr = &pStream->exprs[i];
+
+    pExpr->functionId = vnodeGetIncStreamFunc(pNode->nSQLOptr);
+    if (pExpr->functionId < 0) goto _over;
+
+    // count(*) counts the primary timestamp column
+    if (pNode->pParam != NULL && pNode->pParam->nExpr > 0) {
+      tSQLExpr *pParam = pNode->pParam->a[0].pNode;
+      if (pNode->pParam->nExpr != 1 || pParam == NULL) goto _over;
+
+      if (pParam->nSQLOptr == TK_ALL) {
+        if (pExpr->functionId != TSDB_FUNC_COUNT) goto _over;
+      } else if (pParam->nSQLOptr == TK_ID && pParam->colInfo.n > 0 && pParam->colInfo.n < TSDB_COL_NAME_LEN) {
+        strncpy(pExpr->colName, pParam->colInfo.z, pParam->colInfo.n);
+      } else {
+        goto _over;
+      }
+    } else if (pExpr->functionId != TSDB_FUNC_COUNT) {
+      goto _over;
+    }
+  }
+
+  pStream->vnode = pObj->vnode;
+  pStream->pObj = pObj;
+  pStream->pSrc = pSrc;
+  pStream->interval = interval;
+  pStream->state = TSDB_INC_STREAM_INIT;
+  pStream->fromPos = (int32_t)(pQuerySql->from.z - sql);
+  pStream->fromLen = pQuerySql->from.n;
+
+  int64_t maxDelay =
+      (pVnode->cfg.precision == TSDB_TIME_PRECISION_MICRO) ? tsMaxStreamComputDelay * 1000L : tsMaxStreamComputDelay;
+  pStream->delay = (interval / 10 < maxDelay) ? interval / 10 : maxDelay;
+
+  pStream->sql = sql;
+  sql = NULL;
+  valid = true;
+
+_over:
+  SQLInfoDestroy(&info);
+  tfree(sql);
+
+  if (!valid && pStream != NULL) {
+    vnodeFreeIncStream(pStream);
+    pStream = NULL;
+  }
+
+  return pStream;
+}
+
+/*
+ * the columns are bound by the result of describing the source table, whose rows are in the order of its schema.
+ * Return false if the stream can not be computed incrementally.
+ */
+static bool vnodeBindIncStream(SIncStream *pStream, TAOS_RES *tres) {
+  SMeterObj *pObj = pStream->pObj;
+  SMeterObj *pSrc = pStream->pSrc;
+  char       tsName[TSDB_COL_NAME_LEN] = {0};
+  TAOS_ROW   row;
+  int32_t    numOfCols = 0;
+
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    pStream->exprs[i].colIdx = (pStream->exprs[i].colName[0] == 0) ? PRIMARYKEY_TIMESTAMP_COL_INDEX : -1;
+  }
+
+  /*
+   * the tags of a table created from super table are listed after the columns, with the tag values in the note
+   * column, which is empty for columns. If the first tag is an empty string, the column count does not match and
+   * the stream is computed by query instead.
+   */
+  int32_t noteIdx = (taos_num_fields(tres) > 3) ? 3 : -1;
+  bool    isTag = false;
+
+  while ((row = taos_fetch_row(tres)) != NULL) {
+    if (row[0] == NULL) return false;
+
+    if (noteIdx >= 0 && row[noteIdx] != NULL && ((char *)row[noteIdx])[0] != 0) isTag = true;
+    if (isTag) continue;
+
+    if (numOfCols == 0) strncpy(tsName, row[0], TSDB_COL_NAME_LEN - 1);
+    for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+      if (strcasecmp(pStream->exprs[i].colName, row[0]) == 0) pStream->exprs[i].colIdx = numOfCols;
+    }
+
+    numOfCols++;
+  }
+
+  // the schema is changed since the table is described
+  if (numOfCols != pSrc->numOfColumns) return false;
+
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    SIncStreamExpr *pExpr = &pStream->exprs[i];
+    if (pExpr->colIdx < 0) return false;
+
+    SColumn *pCol = &pSrc->schema[pExpr->colIdx];
+    if (pExpr->functionId != TSDB_FUNC_COUNT && pExpr->functionId != TSDB_FUNC_FIRST &&
+        pExpr->functionId != TSDB_FUNC_LAST &&
+        (pCol->type < TSDB_DATA_TYPE_TINYINT || pCol->type > TSDB_DATA_TYPE_DOUBLE)) {
+      return false;
+    }
+
+    // the stream table is created by the result of query, check it anyway
+    SColumn *pRes = &pObj->schema[i + 1];
+    if (pRes->type != vnodeGetIncStreamResType(pExpr->functionId, pCol->type)) return false;
+    if (pRes->type == pCol->type && pRes->bytes != pCol->bytes) return false;
+
+    pExpr->colId = pCol->colId;
+    pExpr->type = pCol->type;
+    pExpr->bytes = pCol->bytes;
+
+    if (pExpr->functionId == TSDB_FUNC_FIRST || pExpr->functionId == TSDB_FUNC_LAST) {
+      pExpr->pFirst = malloc(pCol->bytes);
+      pExpr->pLast = malloc(pCol->bytes);
+      if (pExpr->pFirst == NULL || pExpr->pLast == NULL) return false;
+    }
+  }
+
+  vnodeResolveIncStreamColumns(pStream);
+
+  /*
+   * the first window is the one after the last result, or the one before current time if there is no result yet,
+   * the same as the client stream. Rows inserted later than the table's last key are aggregated incrementally,
+   * the windows before are computed by query.
+   */
+  int64_t interval = pStream->interval;
+  TSKEY   skey = (pObj->lastKey > 0) ? (pObj->lastKey / interval + 1) * interval
+                                   : (taosGetTimestamp(vnodeList[pObj->vnode].cfg.precision) / interval - 1) * interval;
+
+  pStream->skey = skey;
+  pStream->state = TSDB_INC_STREAM_READY;
+
+  if (pSrc->lastKey > 0 && (pSrc->lastKey / interval + 1) * interval > skey) {
+    pStream->skey = (pSrc->lastKey / interval + 1) * interval;
+    pStream->catchupKey = pStream->skey;
+    pStream->state = TSDB_INC_STREAM_CATCHUP_WAITING;
+
+    int32_t len = (int32_t)strlen(pStream->sql) + TSDB_COL_NAME_LEN * 2 + 64;
+    pStream->catchupSql = malloc(len);
+    if (pStream->catchupSql == NULL) return false;
+
+    int32_t pos = pStream->fromPos + pStream->fromLen;
+    snprintf(pStream->catchupSql, len, "%.*s where %s >= %ld and %s < %ld%s", pos, pStream->sql, tsName, skey, tsName,
+             pStream->catchupKey, pStream->sql + pos);
+  }
+
+  return true;
+}
+
+static bool vnodeOpenIncStream(SMeterObj *pObj) {
+  SVnodeObj *pVnode = vnodeList + pObj->vnode;
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  SIncStream *pStream = vnodeCreateIncStream(pObj);
+  if (pStream == NULL) {
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+    return false;
+  }
+
+  pStream->srcNext = pStream->pSrc->pSrcStreams;
+  pStream->pSrc->pSrcStreams = pStream;
+  pStream->next = pVnode->pIncStreams;
+  pVnode->pIncStreams = pStream;
+
+  pObj->pIncStream = pStream;
+  pVnode->numOfStreams++;
+
+  if (pVnode->incStreamTimer == NULL) {
+    taosTmrReset(vnodeProcessIncStreamTimer, TSDB_INC_STREAM_TIMER, pVnode, vnodeTmrCtrl, &pVnode->incStreamTimer);
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+  dTrace("vid:%d sid:%d id:%s, stream is computed incrementally on %s, sql:%s", pObj->vnode, pObj->sid, pObj->meterId,
+         pStream->pSrc->meterId, pObj->pSql);
+  return true;
+}
+
+static bool vnodeIncStreamNeedConn(SMeterObj *pObj) {
+  SVnodeObj *pVnode = vnodeList + pObj->vnode;
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+  SIncStream *pStream = (SIncStream *)pObj->pIncStream;
+  bool        need = (pStream != NULL && pStream->state != TSDB_INC_STREAM_READY);
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+  return need;
+}
+
+static void vnodeDecStreams(int vnode) {
+  SVnodeObj *pVnode = vnodeList + vnode;
+
+  pVnode->numOfStreams--;
+  if (pVnode->numOfStreams == 0 && pVnode->dbConn != NULL) {
+    taos_close(pVnode->dbConn);
+    pVnode->dbConn = NULL;
+  }
+}
+
+static void vnodeCloseIncStream(SMeterObj *pObj) {
+  SVnodeObj *  pVnode = vnodeList + pObj->vnode;
+  SIncStream * pStream = (SIncStream *)pObj->pIncStream;
+  SIncStream **pp = NULL;
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  for (pp = (SIncStream **)&pVnode->pIncStreams; *pp != NULL; pp = &(*pp)->next) {
+    if (*pp == pStream) {
+      *pp = pStream->next;
+      break;
+    }
+  }
+
+  if (pStream->pSrc != NULL) {
+    for (pp = (SIncStream **)&pStream->pSrc->pSrcStreams; *pp != NULL; pp = &(*pp)->srcNext) {
+      if (*pp == pStream) {
+        *pp = pStream->srcNext;
+        break;
+      }
+    }
+  }
+
+  pObj->pIncStream = NULL;
+
+  // the stream is released when the query returns
+  if (pStream->state == TSDB_INC_STREAM_BINDING || pStream->state == TSDB_INC_STREAM_CATCHUP_RUNNING) {
+    pStream->dropped = 1;
+    pStream->pObj = NULL;
+    pStream->pSrc = NULL;
+  } else {
+    vnodeFreeIncStream(pStream);
+    pVnode->numOfStreams--;
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+  dTrace("vid:%d sid:%d id:%s, incremental stream is closed", pObj->vnode, pObj->sid, pObj->meterId);
+}
+
+void vnodeDetachIncStreams(SMeterObj *pObj) {
+  if (pObj->pSrcStreams == NULL) return;
+
+  SVnodeObj *pVnode = vnodeList + pObj->vnode;
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  for (SIncStream *pStream = pObj->pSrcStreams; pStream != NULL; pStream = pStream->srcNext) {
+    pStream->pSrc = NULL;
+  }
+
+  pObj->pSrcStreams = NULL;
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+}
+
+static char *vnodeAllocIncStreamRow(char **pRows, int32_t *numOfRows, int32_t *maxRows, int32_t bytesPerPoint) {
+  if (*numOfRows >= *maxRows) {
+    int32_t newSize = (*maxRows == 0) ? 16 : (*maxRows) << 1;
+    char *  tmp = realloc(*pRows, (size_t)newSize * bytesPerPoint);
+    if (tmp == NULL) return NULL;
+
+    *pRows = tmp;
+    *maxRows = newSize;
+  }
+
+  return *pRows + (size_t)(*numOfRows)++ * bytesPerPoint;
+}
+
+static void vnodeGetIncStreamValue(char *val, int16_t type, int64_t *i64, double *dv) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      *i64 = *(int8_t *)val;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *i64 = *(int16_t *)val;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *i64 = *(int32_t *)val;
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      *i64 = *(int64_t *)val;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      *dv = *(float *)val;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *dv = *(double *)val;
+      break;
+    default:
+      break;
+  }
+}
+
+static void vnodeSetIncStreamValue(char *dst, int16_t type, int64_t i64, double dv) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      *(int8_t *)dst = (int8_t)i64;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *(int16_t *)dst = (int16_t)i64;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *(int32_t *)dst = (int32_t)i64;
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      *(int64_t *)dst = i64;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      *(float *)dst = (float)dv;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *(double *)dst = dv;
+      break;
+    default:
+      break;
+  }
+}
+
+static void vnodeAccumulateIncStream(SIncStream *pStream, char *pRow) {
+  pStream->numOfPoints++;
+
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    SIncStreamExpr *pExpr = &pStream->exprs[i];
+    if (pExpr->colIdx < 0) continue;
+
+    char *val = pRow + pExpr->offset;
+    if (isNull(val, pExpr->type)) continue;
+
+    switch (pExpr->functionId) {
+      case TSDB_FUNC_COUNT:
+        break;
+      case TSDB_FUNC_FIRST:
+        if (pExpr->numOfPoints == 0) memcpy(pExpr->pFirst, val, pExpr->bytes);
+        break;
+      case TSDB_FUNC_LAST:
+        memcpy(pExpr->pLast, val, pExpr->bytes);
+        break;
+      default: {
+        int64_t i64 = 0;
+        double  dv = 0;
+        vnodeGetIncStreamValue(val, pExpr->type, &i64, &dv);
+
+        pExpr->isum += i64;
+        pExpr->dsum += dv;
+        if (pExpr->numOfPoints == 0 || i64 < pExpr->imin) pExpr->imin = i64;
+        if (pExpr->numOfPoints == 0 || i64 > pExpr->imax) pExpr->imax = i64;
+        if (pExpr->numOfPoints == 0 || dv < pExpr->dmin) pExpr->dmin = dv;
+        if (pExpr->numOfPoints == 0 || dv > pExpr->dmax) pExpr->dmax = dv;
+      }
+    }
+
+    pExpr->numOfPoints++;
+  }
+}
+
+static void vnodeSetIncStreamResult(SIncStreamExpr *pExpr, char *dst, SColumn *pSchema) {
+  if (pExpr->functionId == TSDB_FUNC_COUNT) {
+    *(int64_t *)dst = pExpr->numOfPoints;
+    return;
+  }
+
+  if (pExpr->numOfPoints == 0) {
+    setNull(dst, pSchema->type, pSchema->bytes);
+    return;
+  }
+
+  bool isFloat = vnodeIsFloatType(pExpr->type);
+
+  switch (pExpr->functionId) {
+    case TSDB_FUNC_SUM:
+      vnodeSetIncStreamValue(dst, pSchema->type, pExpr->isum, pExpr->dsum);
+      break;
+    case TSDB_FUNC_AVG:
+      *(double *)dst = (isFloat ? pExpr->dsum : (double)pExpr->isum) / pExpr->numOfPoints;
+      break;
+    case TSDB_FUNC_SPREAD:
+      *(double *)dst = isFloat ? pExpr->dmax - pExpr->dmin : (double)(pExpr->imax - pExpr->imin);
+      break;
+    case TSDB_FUNC_MIN:
+      vnodeSetIncStreamValue(dst, pSchema->type, pExpr->imin, pExpr->dmin);
+      break;
+    case TSDB_FUNC_MAX:
+      vnodeSetIncStreamValue(dst, pSchema->type, pExpr->imax, pExpr->dmax);
+      break;
+    case TSDB_FUNC_FIRST:
+      memcpy(dst, pExpr->pFirst, pExpr->bytes);
+      break;
+    case TSDB_FUNC_LAST:
+      memcpy(dst, pExpr->pLast, pExpr->bytes);
+      break;
+    default:
+      break;
+  }
+}
+
+static void vnodeCloseIncStreamWindow(SIncStream *pStream) {
+  SMeterObj *pObj = pStream->pObj;
+
+  if (pStream->numOfPoints > 0) {
+    char *pRow = vnodeAllocIncStreamRow(&pStream->pRows, &pStream->numOfRows, &pStream->maxRows, pObj->bytesPerPoint);
+    if (pRow == NULL) {
+      dError("vid:%d sid:%d id:%s, failed to allocate memory, result of window:%ld is lost", pObj->vnode, pObj->sid,
+             pObj->meterId, pStream->skey);
+    } else {
+      *(TSKEY *)pRow = pStream->skey;
+
+      int32_t offset = pObj->schema[PRIMARYKEY_TIMESTAMP_COL_INDEX].bytes;
+      for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+        vnodeSetIncStreamResult(&pStream->exprs[i], pRow + offset, &pObj->schema[i + 1]);
+        offset += pObj->schema[i + 1].bytes;
+      }
+    }
+  }
+
+  pStream->numOfPoints = 0;
+  for (int32_t i = 0; i < pStream->numOfExprs; ++i) {
+    SIncStreamExpr *pExpr = &pStream->exprs[i];
+    pExpr->numOfPoints = 0;
+    pExpr->isum = 0;
+    pExpr->dsum = 0;
+  }
+}
+
+void vnodeUpdateIncStreams(SMeterObj *pObj, char *pData, int numOfPoints, TSKEY prevLastKey) {
+  SVnodeObj *pVnode = vnodeList + pObj->vnode;
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  for (SIncStream *pStream = pObj->pSrcStreams; pStream != NULL; pStream = pStream->srcNext) {
+    if (pStream->state < TSDB_INC_STREAM_CATCHUP_WAITING) continue;
+    if (pStream->srcSversion != pObj->sversion) vnodeResolveIncStreamColumns(pStream);
+
+    TSKEY key = prevLastKey;
+    char *pRow = pData;
+
+    for (int i = 0; i < numOfPoints; ++i, pRow += pObj->bytesPerPoint) {
+      TSKEY rowKey = *(TSKEY *)pRow;
+
+      // the same rule as insertion, rows not inserted are skipped
+      if (rowKey <= key || rowKey > pObj->lastKey) continue;
+      key = rowKey;
+
+      // the window is closed already
+      if (rowKey < pStream->skey) continue;
+
+      if (rowKey >= pStream->skey + pStream->interval) {
+        vnodeCloseIncStreamWindow(pStream);
+        pStream->skey = (rowKey / pStream->interval) * pStream->interval;
+      }
+
+      vnodeAccumulateIncStream(pStream, pRow);
+    }
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+}
+
+// the results are written without the lock held, the number of rows written is returned
+static int32_t vnodeFlushIncStream(SMeterObj *pObj, char *pRows, int32_t numOfRows) {
+  int32_t rows = 0;
+
+  while (rows < numOfRows) {
+    int32_t num = numOfRows - rows;
+    if (num > pObj->pointsPerBlock) num = pObj->pointsPerBlock;
+
+    int32_t contLen = sizeof(SSubmitMsg) + num * pObj->bytesPerPoint;
+    char *  pTemp = malloc(sizeof(SVMsgHeader) + contLen);
+    if (pTemp == NULL) break;
+
+    SSubmitMsg *pMsg = (SSubmitMsg *)(pTemp + sizeof(SVMsgHeader));
+    pMsg->numOfRows = htons(num);
+    memcpy(pMsg->payLoad, pRows + (size_t)rows * pObj->bytesPerPoint, (size_t)num * pObj->bytesPerPoint);
+
+    int32_t numOfPoints = 0;
+    int32_t code = vnodeInsertPoints(pObj, (char *)pMsg, contLen, TSDB_DATA_SOURCE_SHELL, NULL, pObj->sversion,
+                                     &numOfPoints, taosGetTimestamp(vnodeList[pObj->vnode].cfg.precision));
+    free(pTemp);
+
+    // try again in next round, e.g., the cache is full
+    if (code != TSDB_CODE_SUCCESS) {
+      dTrace("vid:%d sid:%d id:%s, failed to insert %d stream results, code:%d", pObj->vnode, pObj->sid,
+             pObj->meterId, num, code);
+      break;
+    }
+
+    rows += num;
+  }
+
+  if (rows > 0) {
+    dTrace("vid:%d sid:%d id:%s, %d stream results are written", pObj->vnode, pObj->sid, pObj->meterId, rows);
+  }
+
+  return rows;
+}
+
+static void vnodeFinishIncStreamCatchup(SIncStream *pStream, TAOS_RES *tres, int code) {
+  SVnodeObj *pVnode = vnodeList + pStream->vnode;
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  if (pStream->dropped) {
+    int vnode = pStream->vnode;
+    vnodeFreeIncStream(pStream);
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+    taos_free_result(tres);
+    vnodeDecStreams(vnode);
+    return;
+  }
+
+  SMeterObj *pObj = pStream->pObj;
+
+  if (code < 0) {
+    pStream->state = TSDB_INC_STREAM_CATCHUP_WAITING;
+    pStream->retryTime = taosGetTimestampMs() + tsStreamCompRetryDelay * 1000L;
+    pStream->numOfCatchupRows = 0;
+    dError("vid:%d sid:%d id:%s, failed to compute windows before:%ld, code:%d, retry later", pObj->vnode, pObj->sid,
+           pObj->meterId, pStream->catchupKey, code);
+  } else {
+    // results of the query are earlier than the windows computed incrementally
+    int32_t numOfRows = pStream->numOfCatchupRows;
+    for (int32_t i = 0; i < pStream->numOfRows; ++i) {
+      char *pRow = vnodeAllocIncStreamRow(&pStream->pCatchupRows, &numOfRows, &pStream->maxCatchupRows,
+                                          pObj->bytesPerPoint);
+      if (pRow == NULL) break;
+      memcpy(pRow, pStream->pRows + (size_t)i * pObj->bytesPerPoint, pObj->bytesPerPoint);
+    }
+
+    char *tmp = pStream->pRows;
+    pStream->pRows = pStream->pCatchupRows;
+    pStream->numOfRows = numOfRows;
+    pStream->maxRows = pStream->maxCatchupRows;
+
+    pStream->pCatchupRows = tmp;
+    pStream->numOfCatchupRows = 0;
+    pStream->maxCatchupRows = 0;
+    tfree(pStream->pCatchupRows);
+
+    pStream->state = TSDB_INC_STREAM_READY;
+    dTrace("vid:%d sid:%d id:%s, windows before:%ld are computed", pObj->vnode, pObj->sid, pObj->meterId,
+           pStream->catchupKey);
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+  taos_free_result(tres);
+}
+
+static void vnodeRetrieveIncStreamCatchup(void *param, TAOS_RES *tres, int numOfRows) {
+  SIncStream *pStream = (SIncStream *)param;
+  SVnodeObj * pVnode = vnodeList + pStream->vnode;
+
+  if (numOfRows <= 0) {
+    vnodeFinishIncStreamCatchup(pStream, tres, numOfRows);
+    return;
+  }
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    TAOS_ROW row = taos_fetch_row(tres);
+    if (row == NULL || pStream->dropped) continue;
+
+    SMeterObj *pObj = pStream->pObj;
+    char *pRow = vnodeAllocIncStreamRow(&pStream->pCatchupRows, &pStream->numOfCatchupRows,
+                                        &pStream->maxCatchupRows, pObj->bytesPerPoint);
+    if (pRow != NULL) vnodeBuildStreamRow(pObj, row, pRow);
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+  taos_fetch_rows_a(tres, vnodeRetrieveIncStreamCatchup, param);
+}
+
+static void vnodeProcessIncStreamCatchup(void *param, TAOS_RES *tres, int code) {
+  SIncStream *pStream = (SIncStream *)param;
+
+  if (code < 0 || (!pStream->dropped && taos_num_fields(tres) != pStream->pObj->numOfColumns)) {
+    vnodeFinishIncStreamCatchup(pStream, tres, (code < 0) ? code : -TSDB_CODE_INVALID_SQL);
+    return;
+  }
+
+  taos_fetch_rows_a(tres, vnodeRetrieveIncStreamCatchup, param);
+}
+
+static void vnodeRetrieveIncStreamDescribe(void *param, TAOS_RES *tres, int code) {
+  SIncStream *pStream = (SIncStream *)param;
+  SVnodeObj * pVnode = vnodeList + pStream->vnode;
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  if (pStream->dropped) {
+    int vnode = pStream->vnode;
+    vnodeFreeIncStream(pStream);
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+    taos_free_result(tres);
+    vnodeDecStreams(vnode);
+    return;
+  }
+
+  SMeterObj *pObj = pStream->pObj;
+
+  if (code < 0) {
+    pStream->state = TSDB_INC_STREAM_INIT;
+    pStream->retryTime = taosGetTimestampMs() + tsStreamCompRetryDelay * 1000L;
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+    dError("vid:%d sid:%d id:%s, failed to describe %s, code:%d, retry later", pObj->vnode, pObj->sid, pObj->meterId,
+           pStream->pSrc ? pStream->pSrc->meterId : "", code);
+    taos_free_result(tres);
+    return;
+  }
+
+  if (pStream->pSrc == NULL || vnodeBindIncStream(pStream, tres)) {
+    if (pStream->pSrc == NULL) pStream->state = TSDB_INC_STREAM_READY;
+    dTrace("vid:%d sid:%d id:%s, columns are bound, window:%ld, catch up until:%ld", pObj->vnode, pObj->sid,
+           pObj->meterId, pStream->skey, pStream->catchupKey);
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+    taos_free_result(tres);
+    return;
+  }
+
+  pStream->state = TSDB_INC_STREAM_INIT;
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+  taos_free_result(tres);
+
+  // computed by the client stream instead
+  dTrace("vid:%d sid:%d id:%s, stream can not be computed incrementally", pObj->vnode, pObj->sid, pObj->meterId);
+  vnodeCloseIncStream(pObj);
+
+  pObj->pStream = taos_open_stream(pVnode->dbConn, pObj->pSql, vnodeProcessStreamRes, pObj->lastKey, pObj,
+                                   vnodeCloseStreamCallback);
+  if (pObj->pStream) pVnode->numOfStreams++;
+}
+
+static void vnodeProcessIncStreamDescribe(void *param, TAOS_RES *tres, int code) {
+  if (code < 0) {
+    vnodeRetrieveIncStreamDescribe(param, tres, code);
+    return;
+  }
+
+  // all rows are returned by the first retrieval
+  taos_fetch_rows_a(tres, vnodeRetrieveIncStreamDescribe, param);
+}
+
+typedef struct {
+  SIncStream *pStream;
+  char *      sql;  // query launched for the stream
+  char        describe[TSDB_METER_ID_LEN + 16];
+  char *      pRows;  // results taken out of the stream to be written
+  int32_t     numOfRows;
+  int32_t     maxRows;
+} SIncStreamTask;
+
+/*
+ * the queries and the writing of results are done after the lock is released, since the writing may update the
+ * streams computed on the stream table, and the inserts into source tables shall not wait for them. The stream
+ * table is kept in insert state while its results are written, so the stream is not closed meanwhile.
+ */
+static void vnodeProcessIncStreamTimer(void *param, void *tmrId) {
+  SVnodeObj *     pVnode = (SVnodeObj *)param;
+  SIncStreamTask *pTasks = NULL;
+  int32_t         numOfTasks = 0;
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+
+  int32_t numOfStreams = 0;
+  for (SIncStream *pStream = pVnode->pIncStreams; pStream != NULL; pStream = pStream->next) numOfStreams++;
+
+  if (numOfStreams > 0) pTasks = calloc(numOfStreams, sizeof(SIncStreamTask));
+
+  for (SIncStream *pStream = pVnode->pIncStreams; pStream != NULL && pTasks != NULL; pStream = pStream->next) {
+    TSKEY now = taosGetTimestamp(pVnode->cfg.precision);
+
+    // no data of later windows arrive, the window is closed by the clock
+    if (pStream->numOfPoints > 0 && now >= pStream->skey + pStream->interval + pStream->delay) {
+      vnodeCloseIncStreamWindow(pStream);
+      pStream->skey += pStream->interval;
+    }
+
+    bool launch = false;
+    if (pStream->state == TSDB_INC_STREAM_INIT || pStream->state == TSDB_INC_STREAM_CATCHUP_WAITING) {
+      if (pStream->pSrc == NULL) {
+        pStream->state = TSDB_INC_STREAM_READY;  // the table is dropped, nothing to compute
+      } else if (taosGetTimestampMs() >= pStream->retryTime) {
+        // the windows are computed after the data of them arrive, or the clock passes them
+        launch = (pStream->state == TSDB_INC_STREAM_INIT || pStream->pSrc->lastKey >= pStream->catchupKey ||
+                  now >= pStream->catchupKey + pStream->delay);
+      }
+    }
+
+    SIncStreamTask *pTask = &pTasks[numOfTasks];
+
+    if (launch) {
+      if (pVnode->dbConn == NULL) {
+        if (pVnode->streamTimer == NULL) taosTmrReset(vnodeOpenStreams, 0, pVnode, vnodeTmrCtrl, &pVnode->streamTimer);
+      } else if (pStream->state == TSDB_INC_STREAM_INIT) {
+        snprintf(pTask->describe, sizeof(pTask->describe), "describe %.*s", pStream->fromLen,
+                 pStream->sql + pStream->fromPos);
+        pTask->sql = pTask->describe;
+        pStream->state = TSDB_INC_STREAM_BINDING;
+      } else {
+        pTask->sql = pStream->catchupSql;
+        pStream->state = TSDB_INC_STREAM_CATCHUP_RUNNING;
+      }
+    }
+
+    if (pStream->state == TSDB_INC_STREAM_READY && pStream->numOfRows > 0 &&
+        vnodeSetMeterState(pStream->pObj, TSDB_METER_STATE_INSERT) == TSDB_METER_STATE_READY) {
+      pTask->pRows = pStream->pRows;
+      pTask->numOfRows = pStream->numOfRows;
+      pTask->maxRows = pStream->maxRows;
+      pStream->pRows = NULL;
+      pStream->numOfRows = 0;
+      pStream->maxRows = 0;
+    }
+
+    if (pTask->sql != NULL || pTask->pRows != NULL) {
+      pTask->pStream = pStream;
+      numOfTasks++;
+    }
+  }
+
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+
+  for (int32_t i = 0; i < numOfTasks; ++i) {
+    SIncStreamTask *pTask = &pTasks[i];
+    SIncStream *    pStream = pTask->pStream;
+
+    if (pTask->sql != NULL) {
+      taos_query_a(pVnode->dbConn, pTask->sql,
+                   (pTask->sql == pTask->describe) ? vnodeProcessIncStreamDescribe : vnodeProcessIncStreamCatchup,
+                   pStream);
+    }
+
+    if (pTask->pRows == NULL) continue;
+
+    SMeterObj *pObj = pStream->pObj;
+    int32_t    rows = vnodeFlushIncStream(pObj, pTask->pRows, pTask->numOfRows);
+
+    // the rows not written are put before the results generated meanwhile
+    pthread_mutex_lock(&pVnode->incStreamMutex);
+
+    int32_t numOfRows = pTask->numOfRows - rows;
+    if (numOfRows > 0) {
+      memmove(pTask->pRows, pTask->pRows + (size_t)rows * pObj->bytesPerPoint, (size_t)numOfRows * pObj->bytesPerPoint);
+
+      for (int32_t j = 0; j < pStream->numOfRows; ++j) {
+        char *pRow = vnodeAllocIncStreamRow(&pTask->pRows, &numOfRows, &pTask->maxRows, pObj->bytesPerPoint);
+        if (pRow == NULL) break;
+        memcpy(pRow, pStream->pRows + (size_t)j * pObj->bytesPerPoint, pObj->bytesPerPoint);
+      }
+
+      tfree(pStream->pRows);
+      pStream->pRows = pTask->pRows;
+      pStream->numOfRows = numOfRows;
+      pStream->maxRows = pTask->maxRows;
+    } else {
+      free(pTask->pRows);
+    }
+
+    pthread_mutex_unlock(&pVnode->incStreamMutex);
+    vnodeClearMeterState(pObj, TSDB_METER_STATE_INSERT);
+  }
+
+  tfree(pTasks);
+
+  pthread_mutex_lock(&pVnode->incStreamMutex);
+  if (pVnode->pIncStreams != NULL) {
+    taosTmrReset(vnodeProcessIncStreamTimer, TSDB_INC_STREAM_TIMER, pVnode, vnodeTmrCtrl, &pVnode->incStreamTimer);
+  } else {
+    pVnode->incStreamTimer = NULL;
+  }
+  pthread_mutex_unlock(&pVnode->incStreamMutex);
+}
+
 void vnodeOpenStreams(void *param, void *tmrId) {
   SVnodeObj *pVnode = (SVnodeObj *)param;
   SMeterObj *pObj;
@@ -88,6 +1087,10 @@ void vnodeOpenStreams(void *param, void *tmrId) {
     pObj = pVnode->meterList[sid];
     if (pObj == NULL || pObj->sqlLen == 0 || vnodeIsMeterState(pObj, TSDB_METER_STATE_DELETING)) continue;
 
+    if (pObj->pStream != NULL) continue;
+    if (pObj->pIncStream == NULL && vnodeOpenIncStream(pObj) && !vnodeIncStreamNeedConn(pObj)) continue;
+    if (pObj->pIncStream != NULL && !vnodeIncStreamNeedConn(pObj)) continue;
+
     dTrace("vid:%d sid:%d id:%s, open stream:%s", pObj->vnode, sid, pObj->meterId, pObj->pSql);
 
     if (pVnode->dbConn == NULL) {
@@ -104,7 +1107,7 @@ void vnodeOpenStreams(void *param, void *tmrId) {
       return;
     }
 
-    if (pObj->pStream == NULL) {
+    if (pObj->pIncStream == NULL) {
       pObj->pStream = taos_open_stream(pVnode->dbConn, pObj->pSql, vnodeProcessStreamRes, pObj->lastKey, pObj,
                                        vnodeCloseStreamCallback);
       if (pObj->pStream) pVnode->numOfStreams++;
@@ -117,10 +1120,15 @@ void vnodeCreateStream(SMeterObj *pObj) {
 
   SVnodeObj *pVnode = vnodeList + pObj->vnode;
 
-  if (pObj->pStream) return;
+  if (pObj->pStream || pObj->pIncStream) return;
 
   dTrace("vid:%d sid:%d id:%s stream:%s is created", pObj->vnode, pObj->sid, pObj->meterId, pObj->pSql);
-  if (pVnode->dbConn == NULL) {
+  if (vnodeOpenIncStream(pObj)) {
+    // the query computing the earlier windows needs the connection
+    if (vnodeIncStreamNeedConn(pObj) && pVnode->dbConn == NULL && pVnode->streamTimer == NULL) {
+      taosTmrReset(vnodeOpenStreams, 1000, pVnode, vnodeTmrCtrl, &pVnode->streamTimer);
+    }
+  } else if (pVnode->dbConn == NULL) {
     if (pVnode->streamTimer == NULL) taosTmrReset(vnodeOpenStreams, 1000, pVnode, vnodeTmrCtrl, &pVnode->streamTimer);
   } else {
     pObj->pStream = taos_open_stream(pVnode->dbConn, pObj->pSql, vnodeProcessStreamRes, pObj->lastKey, pObj,
@@ -139,8 +1147,10 @@ void vnodeRemoveStream(SMeterObj *pObj) {
     pVnode->numOfStreams--;
   }
 
+  if (pObj->pIncStream) vnodeCloseIncStream(pObj);
+
   pObj->pStream = NULL;
-  if (pVnode->numOfStreams == 0) {
+  if (pVnode->numOfStreams == 0 && pVnode->dbConn != NULL) {
     taos_close(pVnode->dbConn);
     pVnode->dbConn = NULL;
   }
@@ -161,8 +1171,12 @@ void vnodeCloseStream(SVnodeObj *pVnode) {
       taos_close_stream(pObj->pStream);
       pVnode->numOfStreams--;
     }
+    if (pObj->pIncStream) vnodeCloseIncStream(pObj);
+    vnodeDetachIncStreams(pObj);
     pObj->pStream = NULL;
   }
+
+  taosTmrStopA(&pVnode->incStreamTimer);
 }
 
 // Callback function called from client
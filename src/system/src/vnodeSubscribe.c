@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <endian.h>
+
+#include "taosmsg.h"
+#include "trpc.h"
+#include "ttimer.h"
+#include "vnode.h"
+#include "vnodeShell.h"
+
+/*
+ * Once a meter is subscribed, the rows appended to it by the insert path are also kept in a ring buffer of the meter,
+ * so the subscribers are served from memory without any query. A subscribe request asks for the rows after its offset,
+ * at most credit rows are returned. If there is no new row, the request is held until rows arrive or the wait time
+ * elapses. The rows imported into the past are not pushed, since the offset only moves forward.
+ *
+ * The rows and the waiting requests of a ring are guarded by the mutex of the ring, which is the only lock taken by the
+ * insert path. vnodeSubMutex only guards which connections subscribe which ring, a lock of ring is always taken after
+ * it. The responses are built under the lock and sent after it is released. The rows are freed when the last connection
+ * subscribing the meter leaves, and kept again from the lastKey of meter when it is subscribed again.
+ */
+#define VNODE_SUB_LOG_SIZE   (256 * 1024)
+#define VNODE_SUB_RSP_BATCH  32
+
+typedef struct {
+  pthread_mutex_t mutex;
+  SMeterObj *     pObj;
+  TSKEY           baseKey;  // all rows after this key are kept in the ring
+  int32_t         maxRows;
+  int32_t         start;    // slot of the first row
+  int32_t         numOfRows;
+  int32_t         numOfSubs;
+  SShellObj *     pSubs;    // connections subscribing the meter, guarded by vnodeSubMutex
+  SShellObj *     pWaiters;
+  char *          rows;     // NULL if no connection subscribes the meter
+} SSubLog;
+
+typedef struct {
+  void *  thandle;
+  char *  pStart;
+  int32_t len;
+} SSubRsp;
+
+static pthread_mutex_t vnodeSubMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static char *vnodeGetSubRow(SSubLog *pLog, int32_t index) {
+  return pLog->rows + (size_t)((pLog->start + index) % pLog->maxRows) * pLog->pObj->bytesPerPoint;
+}
+
+/* index of the first row after the offset, rows in the ring are in ascending order of key */
+static int32_t vnodeSearchSubRow(SSubLog *pLog, TSKEY offset) {
+  int32_t low = 0, high = pLog->numOfRows;
+
+  while (low < high) {
+    int32_t mid = (low + high) >> 1;
+    if (*(TSKEY *)vnodeGetSubRow(pLog, mid) <= offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+/* the rows are copied into the response with the lock of ring held, the response is sent by vnodeSendSubscribeRsp */
+static void vnodeBuildSubscribeRsp(SShellObj *pShell, SSubLog *pLog, int code, TSKEY offset, int32_t credit,
+                                   SSubRsp *pSubRsp) {
+  SMeterObj *pObj = (pLog != NULL) ? pLog->pObj : NULL;
+  int32_t    numOfRows = 0;
+  int32_t    index = 0;
+  int8_t     expired = 0;
+
+  pSubRsp->thandle = pShell->thandle;
+  pSubRsp->pStart = NULL;
+  if (pSubRsp->thandle == NULL) return;
+
+  if (code == TSDB_CODE_SUCCESS) {
+    if (offset < pLog->baseKey) {
+      expired = 1;
+    } else {
+      index = vnodeSearchSubRow(pLog, offset);
+      numOfRows = MIN(pLog->numOfRows - index, credit);
+    }
+  }
+
+  int32_t size = sizeof(SSubscribeRsp) + ((pObj != NULL) ? numOfRows * pObj->bytesPerPoint : 0);
+  char *  pStart = taosBuildRspMsgWithSize(pSubRsp->thandle, TSDB_MSG_TYPE_SUBSCRIBE_RSP, size + 100);
+  if (pStart == NULL) return;
+
+  char *pMsg = pStart;
+  *pMsg = code;
+  pMsg++;
+
+  SSubscribeRsp *pRsp = (SSubscribeRsp *)pMsg;
+  pRsp->numOfRows = htonl(numOfRows);
+  pRsp->sversion = htons((pObj != NULL) ? pObj->sversion : 0);
+  pRsp->expired = expired;
+  pMsg = pRsp->data;
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    memcpy(pMsg, vnodeGetSubRow(pLog, index + i), pObj->bytesPerPoint);
+    pMsg += pObj->bytesPerPoint;
+  }
+
+  pSubRsp->pStart = pStart;
+  pSubRsp->len = (int32_t)(pMsg - pStart);
+}
+
+static void vnodeSendSubscribeRsp(SSubRsp *pSubRsp, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    if (pSubRsp[i].pStart != NULL) taosSendMsgToPeer(pSubRsp[i].thandle, pSubRsp[i].pStart, pSubRsp[i].len);
+  }
+}
+
+static void vnodeRemoveSubWaiter(SSubLog *pLog, SShellObj *pShell) {
+  if (!pShell->subWaiting) return;
+
+  SShellObj **ppShell = &pLog->pWaiters;
+  while (*ppShell != NULL && *ppShell != pShell) {
+    ppShell = (SShellObj **)&(*ppShell)->pNextWaiter;
+  }
+
+  if (*ppShell != NULL) *ppShell = pShell->pNextWaiter;
+
+  taosTmrStopA(&pShell->pSubTimer);
+  pShell->subWaiting = 0;
+  pShell->pNextWaiter = NULL;
+}
+
+/* the waiting requests are answered by at most max responses, the lock of ring is held */
+static int32_t vnodeTakeSubWaiters(SSubLog *pLog, SSubRsp *pSubRsp, int32_t max) {
+  int32_t num = 0;
+
+  while (pLog->pWaiters != NULL && num < max) {
+    SShellObj *pShell = pLog->pWaiters;
+    vnodeRemoveSubWaiter(pLog, pShell);
+    vnodeBuildSubscribeRsp(pShell, pLog, TSDB_CODE_SUCCESS, pShell->subOffset, pShell->subCredit, &pSubRsp[num++]);
+  }
+
+  return num;
+}
+
+static void vnodeProcessSubscribeTimer(void *param, void *tmrId) {
+  SShellObj *pShell = (SShellObj *)param;
+  SSubRsp    subRsp = {0};
+
+  pthread_mutex_lock(&vnodeSubMutex);
+
+  SSubLog *pLog = pShell->pSubLog;
+  if (pLog != NULL) {
+    pthread_mutex_lock(&pLog->mutex);
+
+    if (pShell->subWaiting && pShell->pSubTimer == tmrId) {
+      pShell->pSubTimer = NULL;
+      vnodeRemoveSubWaiter(pLog, pShell);
+
+      // nothing arrives in the wait time, an empty response is returned and the subscriber comes again
+      vnodeBuildSubscribeRsp(pShell, pLog, TSDB_CODE_SUCCESS, pShell->subOffset, pShell->subCredit, &subRsp);
+    }
+
+    pthread_mutex_unlock(&pLog->mutex);
+  }
+
+  pthread_mutex_unlock(&vnodeSubMutex);
+  vnodeSendSubscribeRsp(&subRsp, 1);
+}
+
+/* the connection does not subscribe the meter anymore, vnodeSubMutex is held */
+static void vnodeDetachSubscriber(SShellObj *pShell) {
+  SSubLog *pLog = pShell->pSubLog;
+  if (pLog == NULL) return;
+
+  SShellObj **ppShell = &pLog->pSubs;
+  while (*ppShell != NULL && *ppShell != pShell) {
+    ppShell = (SShellObj **)&(*ppShell)->pNextSub;
+  }
+
+  if (*ppShell != NULL) *ppShell = pShell->pNextSub;
+
+  pShell->pSubLog = NULL;
+  pShell->pNextSub = NULL;
+
+  pthread_mutex_lock(&pLog->mutex);
+
+  vnodeRemoveSubWaiter(pLog, pShell);
+  if (--pLog->numOfSubs == 0) {
+    SMeterObj *pObj = pLog->pObj;
+    dTrace("vid:%d sid:%d id:%s, no subscriber is left, rows kept are freed", pObj->vnode, pObj->sid, pObj->meterId);
+
+    tfree(pLog->rows);
+    pLog->start = 0;
+    pLog->numOfRows = 0;
+  }
+
+  pthread_mutex_unlock(&pLog->mutex);
+}
+
+/* the connection subscribes the meter, the rows are kept from now on if it is the first one, vnodeSubMutex is held */
+static SSubLog *vnodeAttachSubscriber(SMeterObj *pObj, SShellObj *pShell) {
+  SSubLog *pLog = pObj->pSubLog;
+  if (pLog != NULL && pShell->pSubLog == pLog) return pLog;
+
+  vnodeDetachSubscriber(pShell);
+
+  if (pLog == NULL) {
+    pLog = calloc(1, sizeof(SSubLog));
+    if (pLog == NULL) return NULL;
+
+    pthread_mutex_init(&pLog->mutex, NULL);
+    pLog->pObj = pObj;
+    pLog->maxRows = VNODE_SUB_LOG_SIZE / pObj->bytesPerPoint;
+    if (pLog->maxRows < pObj->pointsPerBlock) pLog->maxRows = pObj->pointsPerBlock;
+
+    // the ring is visible to the insert path before the base key is decided, so no row after the base key is missed
+    __sync_synchronize();
+    pObj->pSubLog = pLog;
+    __sync_synchronize();
+  }
+
+  pthread_mutex_lock(&pLog->mutex);
+
+  if (pLog->rows == NULL) {
+    pLog->rows = malloc((size_t)pLog->maxRows * pObj->bytesPerPoint);
+    if (pLog->rows == NULL) {
+      pthread_mutex_unlock(&pLog->mutex);
+      return NULL;
+    }
+
+    pLog->baseKey = pObj->lastKey;
+    dTrace("vid:%d sid:%d id:%s, meter is subscribed, rows after %ld are kept, maxRows:%d", pObj->vnode, pObj->sid,
+           pObj->meterId, pLog->baseKey, pLog->maxRows);
+  }
+
+  pLog->numOfSubs++;
+  pthread_mutex_unlock(&pLog->mutex);
+
+  pShell->pSubLog = pLog;
+  pShell->pNextSub = pLog->pSubs;
+  pLog->pSubs = pShell;
+
+  return pLog;
+}
+
+int vnodeProcessSubscribeRequest(char *pMsg, int msgLen, SShellObj *pShell) {
+  SSubscribeMsg *pSubMsg = (SSubscribeMsg *)pMsg;
+  SSubRsp        subRsp = {0};
+  int            code = TSDB_CODE_SUCCESS;
+  int32_t        vnode = -1, sid = -1, credit = 0;
+  TSKEY          offset = 0;
+
+  if (msgLen < sizeof(SSubscribeMsg)) {
+    code = TSDB_CODE_INVALID_MSG_LEN;
+    goto _sub_over;
+  }
+
+  vnode = htons(pSubMsg->vnode);
+  sid = htonl(pSubMsg->sid);
+  offset = htobe64(pSubMsg->offset);
+  credit = htonl(pSubMsg->credit);
+
+  uint64_t uid = htobe64(pSubMsg->uid);
+  int32_t  waitTime = htonl(pSubMsg->waitTime);
+
+  if (credit <= 0) {
+    code = TSDB_CODE_INVALID_MSG_LEN;
+    goto _sub_over;
+  }
+
+  if (vnode >= TSDB_MAX_VNODES || vnode < 0) {
+    code = TSDB_CODE_INVALID_SESSION_ID;
+    goto _sub_over;
+  }
+
+  SVnodeObj *pVnode = vnodeList + vnode;
+  if (pVnode->cfg.maxSessions == 0 || pVnode->meterList == NULL) {
+    vnodeSendVpeerCfgMsg(vnode);
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+    goto _sub_over;
+  }
+
+  if (!(pVnode->accessState & TSDB_VN_READ_ACCCESS)) {
+    code = TSDB_CODE_NO_READ_ACCESS;
+    goto _sub_over;
+  }
+
+  if (sid >= pVnode->cfg.maxSessions || sid <= 0) {
+    code = TSDB_CODE_INVALID_SESSION_ID;
+    goto _sub_over;
+  }
+
+  SMeterObj *pObj = pVnode->meterList[sid];
+  if (pObj == NULL || pObj->uid != uid || pObj->state >= TSDB_METER_STATE_DELETING) {
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+    goto _sub_over;
+  }
+
+  pthread_mutex_lock(&vnodeSubMutex);
+
+  SSubLog *pLog = vnodeAttachSubscriber(pObj, pShell);
+  if (pLog == NULL) {
+    pthread_mutex_unlock(&vnodeSubMutex);
+    code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+    goto _sub_over;
+  }
+
+  pthread_mutex_lock(&pLog->mutex);
+
+  // the previous request of this connection is not answered yet, it is replaced
+  vnodeRemoveSubWaiter(pLog, pShell);
+
+  if (offset < pLog->baseKey || vnodeSearchSubRow(pLog, offset) < pLog->numOfRows || waitTime <= 0) {
+    vnodeBuildSubscribeRsp(pShell, pLog, TSDB_CODE_SUCCESS, offset, credit, &subRsp);
+  } else {
+    pShell->subWaiting = 1;
+    pShell->subOffset = offset;
+    pShell->subCredit = credit;
+    pShell->pNextWaiter = pLog->pWaiters;
+    pLog->pWaiters = pShell;
+    taosTmrReset(vnodeProcessSubscribeTimer, waitTime, pShell, vnodeTmrCtrl, &pShell->pSubTimer);
+  }
+
+  pthread_mutex_unlock(&pLog->mutex);
+  pthread_mutex_unlock(&vnodeSubMutex);
+
+  vnodeSendSubscribeRsp(&subRsp, 1);
+  return msgLen;
+
+_sub_over:
+  dTrace("vid:%d sid:%d, subscribe request is rejected, code:%d", vnode, sid, code);
+  vnodeBuildSubscribeRsp(pShell, NULL, code, offset, credit, &subRsp);
+  vnodeSendSubscribeRsp(&subRsp, 1);
+  return msgLen;
+}
+
+/* the rows appended by the insert path are kept in ring, and pushed to the subscribers waiting for them */
+void vnodePushSubscribedRows(SMeterObj *pObj, char *pData, int numOfPoints) {
+  SSubLog *pLog = pObj->pSubLog;
+  SSubRsp  subRsp[VNODE_SUB_RSP_BATCH];
+
+  if (pLog == NULL) return;
+
+  pthread_mutex_lock(&pLog->mutex);
+
+  if (pLog->rows == NULL) {
+    pthread_mutex_unlock(&pLog->mutex);
+    return;
+  }
+
+  TSKEY lastKey = (pLog->numOfRows > 0) ? *(TSKEY *)vnodeGetSubRow(pLog, pLog->numOfRows - 1) : pLog->baseKey;
+
+  for (int i = 0; i < numOfPoints; ++i, pData += pObj->bytesPerPoint) {
+    TSKEY key = *(TSKEY *)pData;
+
+    // rows skipped by the insert path are not kept, the ones not inserted due to failure are beyond the lastKey
+    if (key <= lastKey || key > pObj->lastKey) continue;
+
+    if (pLog->numOfRows == pLog->maxRows) {
+      pLog->baseKey = *(TSKEY *)vnodeGetSubRow(pLog, 0);
+      pLog->start = (pLog->start + 1) % pLog->maxRows;
+      pLog->numOfRows--;
+    }
+
+    memcpy(vnodeGetSubRow(pLog, pLog->numOfRows), pData, pObj->bytesPerPoint);
+    pLog->numOfRows++;
+    lastKey = key;
+  }
+
+  while (1) {
+    int32_t num = vnodeTakeSubWaiters(pLog, subRsp, VNODE_SUB_RSP_BATCH);
+    pthread_mutex_unlock(&pLog->mutex);
+
+    vnodeSendSubscribeRsp(subRsp, num);
+    if (num < VNODE_SUB_RSP_BATCH) break;
+
+    pthread_mutex_lock(&pLog->mutex);
+  }
+}
+
+/* the connection is gone, the request held by vnode is dropped */
+void vnodeCancelSubscribe(SShellObj *pShell) {
+  pthread_mutex_lock(&vnodeSubMutex);
+  vnodeDetachSubscriber(pShell);
+  pthread_mutex_unlock(&vnodeSubMutex);
+}
+
+/*
+ * the rows kept are not valid anymore, e.g., meter is dropped or its schema is changed, the subscribers waiting are
+ * told to retrieve the rows by query. No row is pushed meanwhile, since the meter is not in insert state.
+ */
+void vnodeFreeSubLog(SMeterObj *pObj) {
+  pthread_mutex_lock(&vnodeSubMutex);
+
+  SSubLog *pLog = pObj->pSubLog;
+  if (pLog == NULL) {
+    pthread_mutex_unlock(&vnodeSubMutex);
+    return;
+  }
+
+  pObj->pSubLog = NULL;
+
+  pthread_mutex_lock(&pLog->mutex);
+
+  pLog->baseKey = INT64_MAX;
+
+  int32_t  num = 0;
+  SSubRsp *pSubRsp = (pLog->numOfSubs > 0) ? malloc(sizeof(SSubRsp) * pLog->numOfSubs) : NULL;
+  if (pSubRsp != NULL) num = vnodeTakeSubWaiters(pLog, pSubRsp, pLog->numOfSubs);
+
+  while (pLog->pSubs != NULL) {
+    SShellObj *pShell = pLog->pSubs;
+    pLog->pSubs = pShell->pNextSub;
+
+    vnodeRemoveSubWaiter(pLog, pShell);
+    pShell->pSubLog = NULL;
+    pShell->pNextSub = NULL;
+  }
+
+  pthread_mutex_unlock(&pLog->mutex);
+  pthread_mutex_unlock(&vnodeSubMutex);
+
+  vnodeSendSubscribeRsp(pSubRsp, num);
+
+  tfree(pSubRsp);
+  pthread_mutex_destroy(&pLog->mutex);
+  tfree(pLog->rows);
+  free(pLog);
+}
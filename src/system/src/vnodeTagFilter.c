@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "tast.h"
+#include "tschemautil.h"
+#include "tsql.h"
+#include "vnode.h"
+
+/*
+ * the tag condition of metric query is evaluated on the tag values replicated in meter objects, so the
+ * sids and tags of the queried meters are not retrieved from mgmt and transferred to vnode by client.
+ */
+typedef struct STagFilterNode {
+  uint8_t                optr;    // TSDB_RELATION_AND/TSDB_RELATION_OR for non-leaf node
+  struct STagFilterNode *pLeft;   // NULL for leaf node
+  struct STagFilterNode *pRight;
+  tQueryInfo             info;    // prepared query condition of leaf node
+} STagFilterNode;
+
+static void vnodeDestroyTagFilter(STagFilterNode *pNode) {
+  if (pNode == NULL) {
+    return;
+  }
+
+  vnodeDestroyTagFilter(pNode->pLeft);
+  vnodeDestroyTagFilter(pNode->pRight);
+
+  tVariantDestroy(&pNode->info.q);
+  free(pNode);
+}
+
+static STagFilterNode *vnodeBuildTagFilter(tSQLBinaryExpr *pExpr, SSchema *pTagSchema, int32_t numOfTags) {
+  STagFilterNode *pNode = calloc(1, sizeof(STagFilterNode));
+  if (pNode == NULL) {
+    return NULL;
+  }
+
+  pNode->optr = pExpr->nSQLBinaryOptr;
+
+  if (pExpr->pLeft->nodeType == TSQL_NODE_EXPR || pExpr->pRight->nodeType == TSQL_NODE_EXPR) {
+    if (pNode->optr != TSDB_RELATION_AND && pNode->optr != TSDB_RELATION_OR) {
+      free(pNode);
+      return NULL;
+    }
+
+    pNode->pLeft = vnodeBuildTagFilter(pExpr->pLeft->pExpr, pTagSchema, numOfTags);
+    pNode->pRight = vnodeBuildTagFilter(pExpr->pRight->pExpr, pTagSchema, numOfTags);
+    if (pNode->pLeft == NULL || pNode->pRight == NULL) {
+      vnodeDestroyTagFilter(pNode);
+      return NULL;
+    }
+
+    return pNode;
+  }
+
+  assert(pExpr->pLeft->nodeType == TSQL_NODE_COL && pExpr->pRight->nodeType == TSQL_NODE_VALUE);
+  tSQLListTraversePrepare(&pNode->info, pTagSchema, numOfTags, pExpr->pLeft->pSchema, pExpr->nSQLBinaryOptr,
+                          pExpr->pRight->pVal);
+
+  // the queried column is not a tag of metric
+  if (pNode->info.colIdx >= numOfTags) {
+    vnodeDestroyTagFilter(pNode);
+    return NULL;
+  }
+
+  return pNode;
+}
+
+static bool vnodeTagFilterEval(STagFilterNode *pNode, SMeterObj *pObj) {
+  if (pNode->pLeft != NULL) {
+    if (pNode->optr == TSDB_RELATION_AND) {
+      return vnodeTagFilterEval(pNode->pLeft, pObj) && vnodeTagFilterEval(pNode->pRight, pObj);
+    } else {
+      return vnodeTagFilterEval(pNode->pLeft, pObj) || vnodeTagFilterEval(pNode->pRight, pObj);
+    }
+  }
+
+  char  name[TSDB_METER_NAME_LEN + 1] = {0};
+  char *val = NULL;
+
+  if (pNode->info.offset == -1) {
+    extractMeterName(pObj->meterId, name);
+    val = name;
+  } else {
+    val = pObj->pTags + pNode->info.offset;
+  }
+
+  return tSQLElemFilterOnTagValue(&pNode->info, val);
+}
+
+static void vnodeCopyReqTags(SMeterObj *pObj, SMeterSidExtInfo *pInfo, SSchema *pTagSchema, int32_t numOfTags,
+                             int16_t *tagCols, int32_t numOfReqTags) {
+  char *pDst = pInfo->tags;
+
+  for (int32_t j = 0; j < numOfReqTags; ++j) {
+    if (tagCols[j] == -1) {
+      extractMeterName(pObj->meterId, pDst);
+      pDst += TSDB_METER_NAME_LEN;
+      continue;
+    }
+
+    int32_t offset = 0;
+    for (int32_t k = 0; k < tagCols[j]; ++k) {
+      offset += pTagSchema[k].bytes;
+    }
+
+    memcpy(pDst, pObj->pTags + offset, pTagSchema[tagCols[j]].bytes);
+    pDst += pTagSchema[tagCols[j]].bytes;
+  }
+}
+
+static SVnodeMetric *vnodeGetMetric(SVnodeObj *pVnode, uint64_t uid) {
+  SVnodeMetric *pMetrics = (SVnodeMetric *)pVnode->pMetrics;
+
+  for (int32_t i = 0; i < pVnode->numOfMetrics; ++i) {
+    if (pMetrics[i].uid == uid) {
+      return &pMetrics[i];
+    }
+  }
+
+  return NULL;
+}
+
+static SVnodeMetric *vnodeAddMetric(SVnodeObj *pVnode, uint64_t uid) {
+  if (pVnode->numOfMetrics >= pVnode->maxMetrics) {
+    int32_t       maxMetrics = (pVnode->maxMetrics > 0) ? pVnode->maxMetrics * 2 : 8;
+    SVnodeMetric *pMetrics = realloc(pVnode->pMetrics, sizeof(SVnodeMetric) * maxMetrics);
+    if (pMetrics == NULL) {
+      return NULL;
+    }
+
+    pVnode->pMetrics = pMetrics;
+    pVnode->maxMetrics = maxMetrics;
+  }
+
+  SVnodeMetric *pMetric = (SVnodeMetric *)pVnode->pMetrics + pVnode->numOfMetrics++;
+  pMetric->uid = uid;
+  pMetric->numOfMeters = 0;
+  pMetric->pHead = NULL;
+
+  return pMetric;
+}
+
+/*
+ * the meters of metric are linked by metric uid, so that the tag filter only visits the meters of queried metric.
+ * Normal tables are not linked, the meters with tag values not replicated are linked in another list. The caller
+ * shall lock vmutex if the vnode is open.
+ */
+void vnodeAddMeterIntoMetric(SMeterObj *pObj) {
+  SVnodeObj *pVnode = &vnodeList[pObj->vnode];
+
+  pObj->pPrevOfMetric = NULL;
+  pObj->pNextOfMetric = NULL;
+
+  if (pObj->tagLen < 0) {
+    pObj->pNextOfMetric = pVnode->pUnknownTags;
+    if (pVnode->pUnknownTags) pVnode->pUnknownTags->pPrevOfMetric = pObj;
+    pVnode->pUnknownTags = pObj;
+    return;
+  }
+
+  if (pObj->metricUid == 0) {
+    return;
+  }
+
+  SVnodeMetric *pMetric = vnodeGetMetric(pVnode, pObj->metricUid);
+  if (pMetric == NULL && (pMetric = vnodeAddMetric(pVnode, pObj->metricUid)) == NULL) {
+    dError("vid:%d sid:%d id:%s, no memory to link meter to metric:%ld", pObj->vnode, pObj->sid, pObj->meterId,
+           pObj->metricUid);
+    return;
+  }
+
+  pObj->pNextOfMetric = pMetric->pHead;
+  if (pMetric->pHead) pMetric->pHead->pPrevOfMetric = pObj;
+  pMetric->pHead = pObj;
+  pMetric->numOfMeters++;
+}
+
+void vnodeRemoveMeterFromMetric(SMeterObj *pObj) {
+  SVnodeObj *   pVnode = &vnodeList[pObj->vnode];
+  SVnodeMetric *pMetric = NULL;
+  SMeterObj **  ppHead = NULL;
+
+  if (pObj->tagLen < 0) {
+    ppHead = &pVnode->pUnknownTags;
+  } else if (pObj->metricUid != 0 && (pMetric = vnodeGetMetric(pVnode, pObj->metricUid)) != NULL) {
+    ppHead = &pMetric->pHead;
+  } else {
+    return;
+  }
+
+  if (pObj->pPrevOfMetric) {
+    pObj->pPrevOfMetric->pNextOfMetric = pObj->pNextOfMetric;
+  } else if (*ppHead == pObj) {
+    *ppHead = pObj->pNextOfMetric;
+  } else {
+    return;  // not linked, e.g., out of memory when it is added
+  }
+
+  if (pObj->pNextOfMetric) pObj->pNextOfMetric->pPrevOfMetric = pObj->pPrevOfMetric;
+  pObj->pPrevOfMetric = NULL;
+  pObj->pNextOfMetric = NULL;
+
+  if (pMetric != NULL && --pMetric->numOfMeters == 0) {
+    *pMetric = ((SVnodeMetric *)pVnode->pMetrics)[--pVnode->numOfMetrics];
+  }
+}
+
+void vnodeCleanUpMetricMeters(SVnodeObj *pVnode) {
+  tfree(pVnode->pMetrics);
+  pVnode->numOfMetrics = 0;
+  pVnode->maxMetrics = 0;
+  pVnode->pUnknownTags = NULL;
+}
+
+/*
+ * select the meters of metric in this vnode that satisfy the tag condition, and set the sid list of query msg.
+ * If no meter is qualified, one meter of the metric is still set to provide the schema of result, and emptyResult
+ * is set to skip the data scan.
+ */
+int32_t vnodeFilterMetersByTags(SQueryMeterMsg *pQueryMsg, bool *emptyResult) {
+  STagFilterMsg *pFilter = (STagFilterMsg *)pQueryMsg->pTagFilter;
+  SVnodeObj *    pVnode = &vnodeList[pQueryMsg->vnode];
+
+  // the first schema is for tbname, the query on tbname is located by index -1 of tag schema
+  SSchema  schema[TSDB_MAX_TAGS + 1] = {{0}};
+  SSchema *pTagSchema = &schema[1];
+
+  schema[0].type = TSDB_DATA_TYPE_BINARY;
+  schema[0].bytes = TSDB_METER_NAME_LEN;
+  schema[0].colId = -1;
+  strcpy(schema[0].name, TSQL_TBNAME_L);
+
+  memcpy(pTagSchema, pFilter->data, sizeof(SSchema) * pFilter->numOfTags);
+
+  int16_t *tagCols = (int16_t *)(pFilter->data + sizeof(SSchema) * pFilter->numOfTags);
+  char *   cond = (char *)(tagCols + pQueryMsg->numOfTagsCols);
+
+  int32_t tagLength = 0;
+  for (int32_t j = 0; j < pQueryMsg->numOfTagsCols; ++j) {
+    if (tagCols[j] < -1 || tagCols[j] >= pFilter->numOfTags) {
+      return TSDB_CODE_INVALID_QUERY_MSG;
+    }
+
+    tagLength += (tagCols[j] == -1) ? TSDB_METER_NAME_LEN : pTagSchema[tagCols[j]].bytes;
+  }
+
+  if (tagLength != pQueryMsg->tagLength) {
+    dError("qmsg:%p, tag length:%d is not matched with required tags:%d", pQueryMsg, pQueryMsg->tagLength, tagLength);
+    return TSDB_CODE_INVALID_QUERY_MSG;
+  }
+
+  if (pFilter->tagSig != tsGetTagSchemaSignature(pTagSchema, pFilter->numOfTags)) {
+    return TSDB_CODE_INVALID_QUERY_MSG;
+  }
+
+  STagFilterNode *pRoot = NULL;
+  if (pFilter->condLen > 1) {
+    tSQLBinaryExpr *pExpr = NULL;
+    tSQLBinaryExprFromString(&pExpr, pTagSchema, pFilter->numOfTags, cond, pFilter->condLen);
+    if (pExpr == NULL) {
+      dError("qmsg:%p, error in tag condition:%s", pQueryMsg, cond);
+      return TSDB_CODE_OPS_NOT_SUPPORT;
+    }
+
+    pRoot = vnodeBuildTagFilter(pExpr, pTagSchema, pFilter->numOfTags);
+    tSQLBinaryExprDestroy(&pExpr);
+
+    if (pRoot == NULL) {
+      dError("qmsg:%p, tag condition:%s is not supported", pQueryMsg, cond);
+      return TSDB_CODE_OPS_NOT_SUPPORT;
+    }
+  }
+
+  int32_t     code = TSDB_CODE_SUCCESS;
+  int32_t     numOfMatched = 0;
+  int32_t     numOfStale = 0;
+  SMeterObj * pTemplate = NULL;
+  SMeterObj **pMatched = NULL;
+
+  pthread_mutex_lock(&pVnode->vmutex);
+
+  // any meter restored from file of earlier version may belong to the metric, refresh the tag values from mgmt
+  for (SMeterObj *pObj = pVnode->pUnknownTags; pObj != NULL; pObj = pObj->pNextOfMetric) {
+    vnodeSendMeterCfgMsg(pObj->vnode, pObj->sid);
+    numOfStale++;
+  }
+
+  SVnodeMetric *pMetric = vnodeGetMetric(pVnode, pFilter->metricUid);
+  if (pMetric != NULL && (pMatched = malloc(sizeof(SMeterObj *) * pMetric->numOfMeters)) == NULL) {
+    pthread_mutex_unlock(&pVnode->vmutex);
+    vnodeDestroyTagFilter(pRoot);
+    return TSDB_CODE_SERV_OUT_OF_MEMORY;
+  }
+
+  for (SMeterObj *pObj = (pMetric != NULL) ? pMetric->pHead : NULL; pObj != NULL; pObj = pObj->pNextOfMetric) {
+    // the tag values are not in accordance with the tag schema of client, refresh them from mgmt
+    if (pObj->tagSig != pFilter->tagSig) {
+      vnodeSendMeterCfgMsg(pObj->vnode, pObj->sid);
+      numOfStale++;
+      continue;
+    }
+
+    pTemplate = pObj;
+    if (pRoot == NULL || vnodeTagFilterEval(pRoot, pObj)) {
+      pMatched[numOfMatched++] = pObj;
+    }
+  }
+
+  int32_t numOfSids = (numOfMatched > 0) ? numOfMatched : 1;
+  size_t  sidSize = sizeof(SMeterSidExtInfo) + tagLength;
+  char *  pBuf = NULL;
+
+  if (numOfStale > 0) {
+    code = TSDB_CODE_METRICMETA_EXPIRED;
+  } else if (pTemplate == NULL) {
+    code = TSDB_CODE_NOT_ACTIVE_SESSION;
+  } else if ((pBuf = calloc(1, (POINTER_BYTES + sidSize) * numOfSids)) == NULL) {
+    code = TSDB_CODE_SERV_OUT_OF_MEMORY;
+  } else {
+    SMeterSidExtInfo **pSids = (SMeterSidExtInfo **)pBuf;
+    char *             pStr = pBuf + POINTER_BYTES * numOfSids;
+
+    for (int32_t i = 0; i < numOfSids; ++i, pStr += sidSize) {
+      SMeterObj *pObj = (numOfMatched > 0) ? pMatched[i] : pTemplate;
+
+      pSids[i] = (SMeterSidExtInfo *)pStr;
+      pSids[i]->sid = pObj->sid;
+      vnodeCopyReqTags(pObj, pSids[i], pTagSchema, pFilter->numOfTags, tagCols, pQueryMsg->numOfTagsCols);
+    }
+  }
+
+  pthread_mutex_unlock(&pVnode->vmutex);
+
+  free(pMatched);
+  vnodeDestroyTagFilter(pRoot);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    dTrace("qmsg:%p vid:%d, failed to filter meters by tags, stale meters:%d, code:%d", pQueryMsg, pQueryMsg->vnode,
+           numOfStale, code);
+    return code;
+  }
+
+  pQueryMsg->numOfSids = numOfSids;
+  pQueryMsg->pSidExtInfo = (uint64_t)pBuf;
+  *emptyResult = (numOfMatched == 0);
+
+  dTrace("qmsg:%p vid:%d, %d meters are selected by tag filter", pQueryMsg, pQueryMsg->vnode, numOfMatched);
+  return TSDB_CODE_SUCCESS;
+}
@@ -277,6 +277,10 @@ SSqlFunctionExpr* vnodeCreateSqlFunctionExpr(SQueryMeterMsg* pQueryMsg, int32_t*
     }
 
     int32_t param = pExprs[i].pBase.arg[0].argValue.i64;
+    if (pExprs[i].pBase.functionId == TSDB_FUNC_APERCT_DST) {
+      param = (pExprs[i].pBase.numOfParams > 1) ? pExprs[i].pBase.arg[1].argValue.i64 : TSDB_APERCT_ALGO_HISTOGRAM;
+    }
+
     getResultInfo(type, bytes, pExprs[i].pBase.functionId, param, &pExprs[i].resType, &pExprs[i].resBytes);
 
     assert(pExprs[i].resType != 0 && pExprs[i].resBytes != 0);
@@ -27,6 +27,7 @@
 #include "os.h"
 #include "taos.h"
 #include "taosmsg.h"
+#include "tscompression.h"
 #include "textbuffer.h"
 #include "tlog.h"
 #include "tsql.h"
@@ -104,6 +105,15 @@ void tExtMemBufferDestroy(tExtMemBuffer **pMemBuffer) {
     tfree(pTmp);
   }
 
+  tfree((*pMemBuffer)->pPageLoc);
+  tfree((*pMemBuffer)->pCompBuf);
+
+  // release all flushed pages kept in memory
+  for (int32_t i = 0; i < (*pMemBuffer)->numOfResidentPages; ++i) {
+    tfree((*pMemBuffer)->pResidentPages[i]);
+  }
+  tfree((*pMemBuffer)->pResidentPages);
+
   // close temp file
   if ((*pMemBuffer)->dataFile != 0) {
     int32_t ret = fclose((*pMemBuffer)->dataFile);
@@ -270,28 +280,143 @@ static void tExtMemBufferClearFlushoutInfo(tExtMemBuffer *pMemBuffer) {
   memset(pFileMeta->flushoutData.pFlushoutInfo, 0, sizeof(tFlushoutInfo) * pFileMeta->flushoutData.nAllocSize);
 }
 
+/*
+ * append one page to data file, the page is compressed if required
+ */
+static bool tExtMemBufferWritePage(tExtMemBuffer *pMemBuffer, tFilePage *pPage) {
+  if (!pMemBuffer->compressed) {
+    pMemBuffer->numOfPagesInFile += 1;
+    return fwrite((char *)pPage, pMemBuffer->nPageSize, 1, pMemBuffer->dataFile) > 0;
+  }
+
+  if (pMemBuffer->numOfPagesInFile >= pMemBuffer->nPageLocAllocSize) {
+    int32_t newSize = (pMemBuffer->nPageLocAllocSize == 0) ? 64 : (pMemBuffer->nPageLocAllocSize << 1);
+
+    tFilePageLoc *tmp = (tFilePageLoc *)realloc(pMemBuffer->pPageLoc, sizeof(tFilePageLoc) * newSize);
+    if (tmp == NULL) {
+      pError("out of memory!\n");
+      return false;
+    }
+
+    pMemBuffer->pPageLoc = tmp;
+    pMemBuffer->nPageLocAllocSize = newSize;
+  }
+
+  // one more byte for the compression indicator
+  if (pMemBuffer->pCompBuf == NULL && (pMemBuffer->pCompBuf = malloc(pMemBuffer->nPageSize + 1)) == NULL) {
+    return false;
+  }
+
+  tFilePageLoc *pLoc = &pMemBuffer->pPageLoc[pMemBuffer->numOfPagesInFile];
+  if (pMemBuffer->numOfPagesInFile == 0) {
+    pLoc->offset = 0;
+  } else {
+    pLoc->offset = pLoc[-1].offset + pLoc[-1].length;
+  }
+
+  pLoc->length = tsCompressString((char *)pPage, pMemBuffer->nPageSize, 1, pMemBuffer->pCompBuf,
+                                  pMemBuffer->nPageSize + 1, ONE_STAGE_COMP, NULL, 0);
+  pMemBuffer->numOfPagesInFile += 1;
+
+  // the file position may be moved by the load operations
+  if (fseek(pMemBuffer->dataFile, pLoc->offset, SEEK_SET) != 0) {
+    return false;
+  }
+
+  return fwrite(pMemBuffer->pCompBuf, pLoc->length, 1, pMemBuffer->dataFile) > 0;
+}
+
+/*
+ * keep the in-memory pages as the flushed pages, the page id of each page is identical to its position in data file
+ */
+static bool tExtMemBufferKeepResident(tExtMemBuffer *pMemBuffer) {
+  int32_t numOfPages = pMemBuffer->numOfResidentPages + pMemBuffer->numOfPagesInMem;
+
+  if (numOfPages > pMemBuffer->nResidentAllocSize) {
+    int32_t newSize = pMemBuffer->nResidentAllocSize << 1;
+    if (newSize < numOfPages) {
+      newSize = numOfPages;
+    }
+
+    tFilePagesItem **tmp = (tFilePagesItem **)realloc(pMemBuffer->pResidentPages, POINTER_BYTES * newSize);
+    if (tmp == NULL) {
+      pError("out of memory!\n");
+      return false;
+    }
+
+    pMemBuffer->pResidentPages = tmp;
+    pMemBuffer->nResidentAllocSize = newSize;
+  }
+
+  tFilePagesItem *first = pMemBuffer->pHead;
+  while (first != NULL) {
+    pMemBuffer->pResidentPages[pMemBuffer->numOfResidentPages++] = first;
+
+    pMemBuffer->fileMeta.numOfElemsInFile += first->item.numOfElems;
+    pMemBuffer->fileMeta.nFileSize += 1;
+
+    tFilePagesItem *ptmp = first;
+    first = first->pNext;
+    ptmp->pNext = NULL;
+  }
+
+  tExtMemBufferUpdateFlushoutInfo(pMemBuffer);
+
+  pMemBuffer->numOfElemsInBuffer = 0;
+  pMemBuffer->numOfPagesInMem = 0;
+  pMemBuffer->pHead = NULL;
+  pMemBuffer->pTail = NULL;
+
+  return true;
+}
+
+/*
+ * write all flushed pages kept in memory to the head of data file, and release them
+ */
+static bool tExtMemBufferSpillResidentPages(tExtMemBuffer *pMemBuffer) {
+  bool ret = true;
+
+  for (int32_t i = 0; i < pMemBuffer->numOfResidentPages; ++i) {
+    if (!tExtMemBufferWritePage(pMemBuffer, &(pMemBuffer->pResidentPages[i]->item))) {
+      ret = false;
+    }
+
+    tfree(pMemBuffer->pResidentPages[i]);
+  }
+
+  pMemBuffer->numOfResidentPages = 0;
+  return ret;
+}
+
 bool tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   if (pMemBuffer->numOfAllElems == 0) {
     return true;
   }
 
+  if (pMemBuffer->numOfElemsInBuffer == 0) {
+    /* all data has been flushed, ignore flush operation */
+    return true;
+  }
+
   if (pMemBuffer->dataFile == NULL) {
+    if (pMemBuffer->numOfResidentPages + pMemBuffer->numOfPagesInMem <= pMemBuffer->nMaxResidentPages) {
+      return tExtMemBufferKeepResident(pMemBuffer);
+    }
+
     if ((pMemBuffer->dataFile = fopen(pMemBuffer->dataFilePath, "wb+")) == NULL) {
       return false;
     }
-  }
 
-  if (pMemBuffer->numOfElemsInBuffer == 0) {
-    /* all data has been flushed to disk, ignore flush operation */
-    return true;
+    if (!tExtMemBufferSpillResidentPages(pMemBuffer)) {
+      return false;
+    }
   }
 
   bool            ret = true;
   tFilePagesItem *first = pMemBuffer->pHead;
 
   while (first != NULL) {
-    size_t retVal = fwrite((char *)&(first->item), pMemBuffer->nPageSize, 1, pMemBuffer->dataFile);
-    if (retVal <= 0) {  // failed to write to buffer, may be not enough space
+    if (!tExtMemBufferWritePage(pMemBuffer, &(first->item))) {  // failed to write to buffer, may be not enough space
       ret = false;
     }
 
@@ -329,8 +454,14 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
     tfree(ptmp);
   }
 
+  for (int32_t i = 0; i < pMemBuffer->numOfResidentPages; ++i) {
+    tfree(pMemBuffer->pResidentPages[i]);
+  }
+  pMemBuffer->numOfResidentPages = 0;
+
   pMemBuffer->fileMeta.numOfElemsInFile = 0;
   pMemBuffer->fileMeta.nFileSize = 0;
+  pMemBuffer->numOfPagesInFile = 0;
 
   pMemBuffer->numOfElemsInBuffer = 0;
   pMemBuffer->numOfPagesInMem = 0;
@@ -345,6 +476,27 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
   }
 }
 
+/*
+ * advise kernel to read the pages in [startPageId, endPageId] of data file asynchronously, so the following page load
+ * operations of merge procedure will not wait for disk I/O.
+ */
+static void tExtMemBufferPrefetch(tExtMemBuffer *pMemBuffer, uint32_t startPageId, uint32_t endPageId) {
+#ifdef LINUX
+  int64_t offset = 0;
+  int64_t len = 0;
+
+  if (pMemBuffer->compressed) {
+    offset = pMemBuffer->pPageLoc[startPageId].offset;
+    len = pMemBuffer->pPageLoc[endPageId].offset + pMemBuffer->pPageLoc[endPageId].length - offset;
+  } else {
+    offset = (int64_t)startPageId * pMemBuffer->nPageSize;
+    len = (int64_t)(endPageId - startPageId + 1) * pMemBuffer->nPageSize;
+  }
+
+  posix_fadvise(fileno(pMemBuffer->dataFile), offset, len, POSIX_FADV_WILLNEED);
+#endif
+}
+
 bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int32_t flushoutId, int32_t pageIdx) {
   if (flushoutId < 0 || flushoutId > pMemBuffer->fileMeta.flushoutData.nLength) {
     return false;
@@ -355,10 +507,47 @@ bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int3
     return false;
   }
 
-  size_t ret = fseek(pMemBuffer->dataFile, (pInfo->startPageId + pageIdx) * pMemBuffer->nPageSize, SEEK_SET);
-  ret = fread(pFilePage, pMemBuffer->nPageSize, 1, pMemBuffer->dataFile);
+  if (pMemBuffer->dataFile == NULL) {  // all flushed pages are still in memory
+    uint32_t pageId = pInfo->startPageId + pageIdx;
+    if (pageId >= (uint32_t)pMemBuffer->numOfResidentPages) {
+      return false;
+    }
+
+    memcpy(pFilePage, &pMemBuffer->pResidentPages[pageId]->item, pMemBuffer->nPageSize);
+    return true;
+  }
+
+  uint32_t pageId = pInfo->startPageId + pageIdx;
+  if (pageId >= (uint32_t)pMemBuffer->numOfPagesInFile) {
+    return false;
+  }
+
+  // read ahead the following pages of this flush out when the first page of each prefetch window is loaded
+  if (pageIdx % EXT_BUFFER_PREFETCH_PAGES == 0 && pageIdx + 1 < (int32_t)pInfo->numOfPages) {
+    int32_t last = pageIdx + EXT_BUFFER_PREFETCH_PAGES;
+    if (last >= (int32_t)pInfo->numOfPages) {
+      last = pInfo->numOfPages - 1;
+    }
+
+    tExtMemBufferPrefetch(pMemBuffer, pageId + 1, pInfo->startPageId + last);
+  }
+
+  if (!pMemBuffer->compressed) {
+    size_t ret = fseek(pMemBuffer->dataFile, pageId * pMemBuffer->nPageSize, SEEK_SET);
+    ret = fread(pFilePage, pMemBuffer->nPageSize, 1, pMemBuffer->dataFile);
 
-  return (ret > 0);
+    return (ret > 0);
+  }
+
+  tFilePageLoc *pLoc = &pMemBuffer->pPageLoc[pageId];
+  if (fseek(pMemBuffer->dataFile, pLoc->offset, SEEK_SET) != 0 ||
+      fread(pMemBuffer->pCompBuf, pLoc->length, 1, pMemBuffer->dataFile) <= 0) {
+    return false;
+  }
+
+  int32_t len = tsDecompressString(pMemBuffer->pCompBuf, pLoc->length, 1, (char *)pFilePage, pMemBuffer->nPageSize,
+                                   ONE_STAGE_COMP, NULL, 0);
+  return (len == pMemBuffer->nPageSize);
 }
 
 bool tExtMemBufferIsAllDataInMem(tExtMemBuffer *pMemBuffer) { return (pMemBuffer->fileMeta.nFileSize == 0); }
@@ -1102,8 +1291,169 @@ static UNUSED_FUNC void tRowModelDisplay(tOrderDescriptor *pDescriptor, int32_t
 
 static int32_t qsort_call = 0;
 
+/*
+ * map the value of integer or timestamp column into an unsigned key with the same order, the sign bit is flipped
+ * so that negative values are ahead of positive values.
+ */
+static FORCE_INLINE uint64_t radixSortKey(char *val, int32_t bytes) {
+  switch (bytes) {
+    case 1:
+      return (uint8_t)(*(uint8_t *)val ^ 0x80u);
+    case 2:
+      return (uint16_t)(*(uint16_t *)val ^ 0x8000u);
+    case 4:
+      return (uint32_t)(*(uint32_t *)val ^ 0x80000000u);
+    default:
+      return *(uint64_t *)val ^ 0x8000000000000000ul;
+  }
+}
+
+/*
+ * LSD radix sort on the only order column of integer or timestamp type. The permutation of rows is computed once by
+ * sorting the keys, then all columns are gathered according to it, instead of swapping all columns for each exchange.
+ * Return false if the order descriptor is not applicable, and the generic comparison based sort is used instead.
+ */
+static bool tColDataRadixSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end,
+                              char *data, int32_t orderType) {
+  if (pDescriptor->orderIdx.numOfOrderedCols != 1) {
+    return false;
+  }
+
+  tColModel *pModel = pDescriptor->pSchema;
+  int32_t    colIdx = pDescriptor->orderIdx.pData[0];
+  int32_t    bytes = pModel->pFields[colIdx].bytes;
+  bool       desc = false;
+
+  // keep in accordance with compare_sa/compare_sd
+  switch (pModel->pFields[colIdx].type) {
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      desc = (colIdx == 0 && pDescriptor->tsOrder == TSQL_SO_DESC);
+      break;
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+    case TSDB_DATA_TYPE_SMALLINT:
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_BIGINT:
+      desc = (orderType == TSQL_SO_DESC);
+      break;
+    default:
+      return false;
+  }
+
+  int32_t numOfElems = end - start + 1;
+  int32_t maxBytes = 0;
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    if (pModel->pFields[i].bytes > maxBytes) {
+      maxBytes = pModel->pFields[i].bytes;
+    }
+  }
+
+  uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * numOfElems * 2);
+  int32_t * index = (int32_t *)malloc(sizeof(int32_t) * numOfElems * 2);
+  uint32_t *count = (uint32_t *)calloc(bytes * 256, sizeof(uint32_t));
+  char *    buf = (char *)malloc((size_t)maxBytes * numOfElems);
+
+  if (keys == NULL || index == NULL || count == NULL || buf == NULL) {
+    tfree(keys);
+    tfree(index);
+    tfree(count);
+    tfree(buf);
+    return false;
+  }
+
+  uint64_t mask = (bytes == sizeof(uint64_t)) ? UINT64_MAX : ((1ul << (bytes << 3)) - 1);
+  char *   pKeyCol = COLMODEL_GET_VAL(data, pModel, numOfRows, start, colIdx);
+
+  // build the histograms of all digits in one pass
+  for (int32_t i = 0; i < numOfElems; ++i) {
+    uint64_t k = radixSortKey(pKeyCol + i * bytes, bytes);
+    if (desc) {
+      k = (~k) & mask;
+    }
+
+    keys[i] = k;
+    index[i] = i;
+
+    for (int32_t j = 0; j < bytes; ++j) {
+      count[(j << 8) + ((k >> (j << 3)) & 0xFF)] += 1;
+    }
+  }
+
+  uint64_t *srcKeys = keys, *dstKeys = keys + numOfElems;
+  int32_t * srcIndex = index, *dstIndex = index + numOfElems;
+
+  for (int32_t j = 0; j < bytes; ++j) {
+    uint32_t *pCount = &count[j << 8];
+    int32_t   shift = j << 3;
+
+    // all keys have the same digit, nothing to do in this pass
+    if (pCount[(srcKeys[0] >> shift) & 0xFF] == (uint32_t)numOfElems) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (int32_t k = 0; k < 256; ++k) {
+      uint32_t c = pCount[k];
+      pCount[k] = offset;
+      offset += c;
+    }
+
+    for (int32_t i = 0; i < numOfElems; ++i) {
+      uint32_t pos = pCount[(srcKeys[i] >> shift) & 0xFF]++;
+      dstKeys[pos] = srcKeys[i];
+      dstIndex[pos] = srcIndex[i];
+    }
+
+    uint64_t *tKeys = srcKeys;
+    srcKeys = dstKeys;
+    dstKeys = tKeys;
+
+    int32_t *tIndex = srcIndex;
+    srcIndex = dstIndex;
+    dstIndex = tIndex;
+  }
+
+  // gather each column according to the permutation
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    int32_t colBytes = pModel->pFields[i].bytes;
+    char *  pCol = COLMODEL_GET_VAL(data, pModel, numOfRows, start, i);
+
+    switch (colBytes) {
+      case 1:
+        for (int32_t k = 0; k < numOfElems; ++k) ((int8_t *)buf)[k] = ((int8_t *)pCol)[srcIndex[k]];
+        break;
+      case 2:
+        for (int32_t k = 0; k < numOfElems; ++k) ((int16_t *)buf)[k] = ((int16_t *)pCol)[srcIndex[k]];
+        break;
+      case 4:
+        for (int32_t k = 0; k < numOfElems; ++k) ((int32_t *)buf)[k] = ((int32_t *)pCol)[srcIndex[k]];
+        break;
+      case 8:
+        for (int32_t k = 0; k < numOfElems; ++k) ((int64_t *)buf)[k] = ((int64_t *)pCol)[srcIndex[k]];
+        break;
+      default:
+        for (int32_t k = 0; k < numOfElems; ++k) {
+          memcpy(buf + k * colBytes, pCol + srcIndex[k] * colBytes, colBytes);
+        }
+    }
+
+    memcpy(pCol, buf, (size_t)colBytes * numOfElems);
+  }
+
+  tfree(keys);
+  tfree(index);
+  tfree(count);
+  tfree(buf);
+
+  return true;
+}
+
 void tColDataQSort(tOrderDescriptor *pDescriptor, int32_t numOfRows, int32_t start, int32_t end, char *data,
                    int32_t orderType) {
+  if (end - start + 1 >= RADIX_SORT_MIN_ROWS && tColDataRadixSort(pDescriptor, numOfRows, start, end, data, orderType)) {
+    return;
+  }
+
   // short array sort, incur another sort procedure instead of quick sort process
   __col_compar_fn_t compareFn = (orderType == TSQL_SO_ASC) ? compare_sa : compare_sd;
 
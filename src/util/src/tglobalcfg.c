@@ -85,8 +85,17 @@ short tsNumOfBlocksPerMeter = 100;
 short tsCommitTime = 3600;  // seconds
 short tsCommitLog = 1;
 short tsCompression = 2;
+int   tsRetrieveCompress = 0;  // compress the retrieved result between vnode and client
+int   tsInsertBufferSize = 1048576;  // flush the client insert buffer once the buffered rows exceed it
+int   tsInsertBufferTime = 100;      // ms, the maximum time of rows kept in the client insert buffer
+int   tsTagFilterPushdown = 0;       // evaluate the tag condition of metric query in vnodes
+int   tsLocalReduceBufSize = 64 * 1024 * 1024;  // results of metric query kept in memory before spilled to disk
+int   tsLocalReduceThreads = 0;                 // threads to merge the results of metric query, 0: number of cores
+int   tsLocalReduceSpillComp = 0;               // compress the results of metric query spilled to disk
 short tsDaysPerFile = 10;
 int   tsDaysToKeep = 3650;
+int   tsRollupLevel1 = 0;  // seconds, aggregates of each bucket are kept in rollup files at commit
+int   tsRollupLevel2 = 0;
 
 int  tsMaxShellConns = 2000;
 int  tsMaxUsers = 1000;
@@ -129,6 +138,7 @@ int tsHttpCacheSessions = 100;
 int tsHttpSessionExpire = 36000;
 int tsHttpMaxThreads = 2;
 int tsHttpEnableCompress = 0;
+int tsHttpMaxParallelSql = 4;  // statements of a multi-sql request executed concurrently
 int tsTelegrafUseFieldNum = 0;
 
 char tsMonitorDbName[] = "log";
@@ -481,12 +491,31 @@ void tsInitGlobalConfig() {
                      TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 0, 1, 0, TSDB_CFG_UTYPE_NONE);
   tsInitConfigOption(cfg++, "comp", &tsCompression, TSDB_CFG_VTYPE_SHORT,
                      TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 0, 2, 0, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "retrieveComp", &tsRetrieveCompress, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 0, 1, 0, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "insertBufSize", &tsInsertBufferSize, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 1024, 64 * 1024 * 1024, 0, TSDB_CFG_UTYPE_BYTE);
+  tsInitConfigOption(cfg++, "insertBufTime", &tsInsertBufferTime, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 1, 60000, 0, TSDB_CFG_UTYPE_MS);
+  tsInitConfigOption(cfg++, "tagFilterPushdown", &tsTagFilterPushdown, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 0, 1, 0, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "localReduceBufSize", &tsLocalReduceBufSize, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 0, 1024 * 1024 * 1024, 0,
+                     TSDB_CFG_UTYPE_BYTE);
+  tsInitConfigOption(cfg++, "localReduceThreads", &tsLocalReduceThreads, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 0, 64, 0, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "localReduceSpillComp", &tsLocalReduceSpillComp, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT, 0, 1, 0, TSDB_CFG_UTYPE_NONE);
 
   // database configs
   tsInitConfigOption(cfg++, "days", &tsDaysPerFile, TSDB_CFG_VTYPE_SHORT,
                      TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 1, 365, 0, TSDB_CFG_UTYPE_NONE);
   tsInitConfigOption(cfg++, "keep", &tsDaysToKeep, TSDB_CFG_VTYPE_INT,
                      TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 1, 365000, 0, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "rollupLevel1", &tsRollupLevel1, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 0, 86400, 0, TSDB_CFG_UTYPE_SECOND);
+  tsInitConfigOption(cfg++, "rollupLevel2", &tsRollupLevel2, TSDB_CFG_VTYPE_INT,
+                     TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW, 0, 86400, 0, TSDB_CFG_UTYPE_SECOND);
 
   // login configs
   tsInitConfigOption(cfg++, "defaultDB", tsDefaultDB, TSDB_CFG_VTYPE_STRING,
@@ -539,6 +568,8 @@ void tsInitGlobalConfig() {
                      10000000, 0, TSDB_CFG_UTYPE_NONE);
   tsInitConfigOption(cfg++, "httpEnableCompress", &tsHttpEnableCompress, TSDB_CFG_VTYPE_INT, TSDB_CFG_CTYPE_B_CONFIG, 0,
                      1, 1, TSDB_CFG_UTYPE_NONE);
+  tsInitConfigOption(cfg++, "httpMaxParallelSql", &tsHttpMaxParallelSql, TSDB_CFG_VTYPE_INT, TSDB_CFG_CTYPE_B_CONFIG, 1,
+                     64, 0, TSDB_CFG_UTYPE_NONE);
 
   // debug flag
   tsInitConfigOption(cfg++, "numOfLogLines", &tsNumOfLogLines, TSDB_CFG_VTYPE_INT,
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "thyperloglog.h"
+
+#define HLL_HASH_BITS 64
+
+int32_t tHllSize(int32_t precision) { return (int32_t)sizeof(SHyperLogLog) + (1 << precision); }
+
+void tHllInit(SHyperLogLog *pHll, int32_t precision) {
+  if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+    precision = HLL_DEFAULT_PRECISION;
+  }
+
+  memset(pHll, 0, tHllSize(precision));
+  pHll->precision = precision;
+}
+
+// the finalizer of MurmurHash3, all bits of input affect all bits of output
+uint64_t tHllHashInt(uint64_t val) {
+  val ^= val >> 33;
+  val *= 0xff51afd7ed558ccdULL;
+  val ^= val >> 33;
+  val *= 0xc4ceb9fe1a85ec53ULL;
+  val ^= val >> 33;
+  return val;
+}
+
+// MurmurHash64A
+uint64_t tHllHashBytes(const void *key, int32_t len) {
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int32_t  r = 47;
+
+  uint64_t       h = 0x5bd1e995ULL ^ (len * m);
+  const uint8_t *data = (const uint8_t *)key;
+  const uint8_t *end = data + (len / 8) * 8;
+
+  for (; data != end; data += 8) {
+    uint64_t k = 0;
+    memcpy(&k, data, sizeof(uint64_t));
+
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+
+    h ^= k;
+    h *= m;
+  }
+
+  switch (len & 7) {
+    case 7:
+      h ^= (uint64_t)data[6] << 48;
+      // fall through
+    case 6:
+      h ^= (uint64_t)data[5] << 40;
+      // fall through
+    case 5:
+      h ^= (uint64_t)data[4] << 32;
+      // fall through
+    case 4:
+      h ^= (uint64_t)data[3] << 24;
+      // fall through
+    case 3:
+      h ^= (uint64_t)data[2] << 16;
+      // fall through
+    case 2:
+      h ^= (uint64_t)data[1] << 8;
+      // fall through
+    case 1:
+      h ^= (uint64_t)data[0];
+      h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+/*
+ * the first precision bits of hash value are the index of register, and the register keeps the maximum position of
+ * the first 1-bit in the remain bits
+ */
+static inline void hllAddImpl(SHyperLogLog *pHll, uint64_t hash) {
+  int32_t  p = pHll->precision;
+  uint64_t index = hash >> (HLL_HASH_BITS - p);
+  uint64_t w = hash << p;
+
+  uint8_t rank = (w == 0) ? (uint8_t)(HLL_HASH_BITS - p + 1) : (uint8_t)(__builtin_clzll(w) + 1);
+  if (rank > pHll->registers[index]) {
+    pHll->registers[index] = rank;
+  }
+}
+
+void tHllAdd(SHyperLogLog *pHll, uint64_t hash) {
+  hllAddImpl(pHll, hash);
+  pHll->numOfElems += 1;
+}
+
+void tHllAddBatch(SHyperLogLog *pHll, const uint64_t *hash, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    hllAddImpl(pHll, hash[i]);
+  }
+
+  pHll->numOfElems += num;
+}
+
+int32_t tHllMerge(SHyperLogLog *pHll, const SHyperLogLog *pInput) {
+  if (pHll->precision != pInput->precision) {
+    return -1;
+  }
+
+  int32_t m = 1 << pHll->precision;
+  for (int32_t i = 0; i < m; ++i) {
+    if (pInput->registers[i] > pHll->registers[i]) {
+      pHll->registers[i] = pInput->registers[i];
+    }
+  }
+
+  pHll->numOfElems += pInput->numOfElems;
+  return 0;
+}
+
+static double hllSigma(double x) {
+  if (x == 1) {
+    return INFINITY;
+  }
+
+  double y = 1;
+  double z = x;
+  double prev = 0;
+  do {
+    x *= x;
+    prev = z;
+    z += x * y;
+    y += y;
+  } while (prev != z);
+
+  return z;
+}
+
+static double hllTau(double x) {
+  if (x == 0 || x == 1) {
+    return 0;
+  }
+
+  double y = 1;
+  double z = 1 - x;
+  double prev = 0;
+  do {
+    x = sqrt(x);
+    prev = z;
+    y *= 0.5;
+    z -= (1 - x) * (1 - x) * y;
+  } while (prev != z);
+
+  return z / 3;
+}
+
+/*
+ * the improved estimator without empirical bias correction, which is accurate for both small and large cardinality,
+ * see: Otmar Ertl. New cardinality estimation algorithms for HyperLogLog sketches, arXiv:1702.01284, 2017
+ */
+uint64_t tHllCount(const SHyperLogLog *pHll) {
+  int32_t p = pHll->precision;
+  int32_t q = HLL_HASH_BITS - p;
+  int32_t m = 1 << p;
+
+  int32_t histogram[HLL_HASH_BITS + 2] = {0};
+  for (int32_t i = 0; i < m; ++i) {
+    histogram[pHll->registers[i]]++;
+  }
+
+  double z = m * hllTau(1 - (double)histogram[q + 1] / m);
+  for (int32_t k = q; k >= 1; --k) {
+    z = 0.5 * (z + histogram[k]);
+  }
+
+  z += m * hllSigma((double)histogram[0] / m);
+  return (uint64_t)llround(0.5 / log(2) * m * m / z);
+}
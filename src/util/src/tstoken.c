@@ -64,6 +64,11 @@ static bool isDelimiter(char c) {
 
 char *tscGetToken(char *string, char **token, int *tokenLen) {
   char quote = 0;
+  return tscGetQuotedToken(string, token, tokenLen, &quote);
+}
+
+char *tscGetQuotedToken(char *string, char **token, int *tokenLen, char *pQuote) {
+  char quote = 0;
 
   while (*string != 0) {
     if (isDelimiter(*string)) {
@@ -78,6 +83,7 @@ char *tscGetToken(char *string, char **token, int *tokenLen) {
     string++;
   }
 
+  *pQuote = quote;
   *token = string;
   /* not in string, return token */
   if (quote == 0 && isOperator(*string)) {
@@ -99,6 +105,11 @@ char *tscGetToken(char *string, char **token, int *tokenLen) {
           shiftStr(string - 1, string);
           continue;
         } else if (*string == quote) {
+          // the doubled quote stands for the quote itself as in sql, it is kept in token, see tsParseOneColumnData
+          if (*(string + 1) == quote) {
+            string += 2;
+            continue;
+          }
           break;
         }
       }
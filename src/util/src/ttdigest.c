@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ttdigest.h"
+
+/*
+ * scale function k1: k(q) = delta / (2 * pi) * asin(2q - 1). Adjacent points are merged into one centroid as long as
+ * the centroid spans no more than 1 in k, so the centroids are small near both ends and large around the median.
+ */
+static double tdigestK(double q) {
+  if (q <= 0) {
+    return -TDIGEST_COMPRESSION / 4.0;
+  } else if (q >= 1) {
+    return TDIGEST_COMPRESSION / 4.0;
+  }
+
+  return TDIGEST_COMPRESSION / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static double tdigestQ(double k) {
+  if (k >= TDIGEST_COMPRESSION / 4.0) {
+    return 1;
+  }
+
+  return (sin(k * 2 * M_PI / TDIGEST_COMPRESSION) + 1) / 2;
+}
+
+static int32_t compareDouble(const void *p1, const void *p2) {
+  double v1 = *(const double *)p1;
+  double v2 = *(const double *)p2;
+
+  if (v1 == v2) {
+    return 0;
+  }
+
+  return (v1 < v2) ? -1 : 1;
+}
+
+/*
+ * merge the centroids of digest with the input centroids, both of them are sorted by mean value.
+ */
+static void tdigestCompress(STDigest *pDigest, SCentroid *pInput, int32_t num) {
+  SCentroid out[TDIGEST_MAX_CENTROIDS];
+  int32_t   numOfOut = 0;
+
+  int64_t total = pDigest->totalWeight;
+  for (int32_t i = 0; i < num; ++i) {
+    total += pInput[i].weight;
+  }
+
+  if (total == 0) {
+    return;
+  }
+
+  SCentroid *pCentroids = pDigest->centroids;
+  int32_t    i = 0;
+  int32_t    j = 0;
+
+  SCentroid cur = {0};
+  double    weightSoFar = 0;
+  double    qLimit = 0;
+
+  while (i < pDigest->numOfCentroids || j < num) {
+    SCentroid *pNext = NULL;
+    if (j >= num || (i < pDigest->numOfCentroids && pCentroids[i].mean <= pInput[j].mean)) {
+      pNext = &pCentroids[i++];
+    } else {
+      pNext = &pInput[j++];
+    }
+
+    if (cur.weight == 0) {
+      cur = *pNext;
+      qLimit = tdigestQ(tdigestK(0) + 1);
+      continue;
+    }
+
+    double q = (weightSoFar + cur.weight + pNext->weight) / total;
+
+    // the last slot is kept for the remain points, which never happens in theory
+    if (q <= qLimit || numOfOut == TDIGEST_MAX_CENTROIDS - 1) {
+      cur.weight += pNext->weight;
+      cur.mean += (pNext->mean - cur.mean) * pNext->weight / cur.weight;
+    } else {
+      out[numOfOut++] = cur;
+      weightSoFar += cur.weight;
+
+      qLimit = tdigestQ(tdigestK(weightSoFar / total) + 1);
+      cur = *pNext;
+    }
+  }
+
+  out[numOfOut++] = cur;
+
+  memcpy(pDigest->centroids, out, sizeof(SCentroid) * numOfOut);
+  pDigest->numOfCentroids = numOfOut;
+  pDigest->totalWeight = total;
+}
+
+static int32_t tdigestFlush(STDigest *pDigest) {
+  if (pDigest->numOfBuffered == 0) {
+    return 0;
+  }
+
+  SCentroid input[TDIGEST_BUFFER_SIZE];
+
+  qsort(pDigest->buffered, pDigest->numOfBuffered, sizeof(double), compareDouble);
+  for (int32_t i = 0; i < pDigest->numOfBuffered; ++i) {
+    input[i].mean = pDigest->buffered[i];
+    input[i].weight = 1;
+  }
+
+  tdigestCompress(pDigest, input, pDigest->numOfBuffered);
+  pDigest->numOfBuffered = 0;
+  return 0;
+}
+
+void tTDigestInit(STDigest *pDigest) {
+  memset(pDigest, 0, sizeof(STDigest));
+
+  pDigest->min = DBL_MAX;
+  pDigest->max = -DBL_MAX;
+}
+
+int32_t tTDigestAdd(STDigest *pDigest, double val) {
+  if (val < pDigest->min) {
+    pDigest->min = val;
+  }
+
+  if (val > pDigest->max) {
+    pDigest->max = val;
+  }
+
+  pDigest->buffered[pDigest->numOfBuffered++] = val;
+  if (pDigest->numOfBuffered == TDIGEST_BUFFER_SIZE) {
+    return tdigestFlush(pDigest);
+  }
+
+  return 0;
+}
+
+static void tdigestAddSorted(STDigest *pDigest, double *val, int32_t num) {
+  if (num + pDigest->numOfBuffered < TDIGEST_BUFFER_SIZE) {
+    for (int32_t i = 0; i < num; ++i) {
+      tTDigestAdd(pDigest, val[i]);
+    }
+
+    return;
+  }
+
+  SCentroid input[TDIGEST_BATCH_SIZE + TDIGEST_BUFFER_SIZE];
+  int32_t   total = num + pDigest->numOfBuffered;
+
+  qsort(val, num, sizeof(double), compareDouble);
+
+  // the buffered points are merged with the sorted values
+  qsort(pDigest->buffered, pDigest->numOfBuffered, sizeof(double), compareDouble);
+
+  int32_t i = 0, j = 0;
+  for (int32_t k = 0; k < total; ++k) {
+    if (j >= pDigest->numOfBuffered || (i < num && val[i] <= pDigest->buffered[j])) {
+      input[k].mean = val[i++];
+    } else {
+      input[k].mean = pDigest->buffered[j++];
+    }
+
+    input[k].weight = 1;
+  }
+
+  if (val[0] < pDigest->min) {
+    pDigest->min = val[0];
+  }
+
+  if (val[num - 1] > pDigest->max) {
+    pDigest->max = val[num - 1];
+  }
+
+  tdigestCompress(pDigest, input, total);
+  pDigest->numOfBuffered = 0;
+}
+
+int32_t tTDigestAddBatch(STDigest *pDigest, double *val, int32_t num) {
+  for (int32_t i = 0; i < num; i += TDIGEST_BATCH_SIZE) {
+    tdigestAddSorted(pDigest, val + i, (num - i < TDIGEST_BATCH_SIZE) ? (num - i) : TDIGEST_BATCH_SIZE);
+  }
+
+  return 0;
+}
+
+int32_t tTDigestMerge(STDigest *pDigest, STDigest *pInput) {
+  if (tTDigestSize(pInput) == 0) {
+    return 0;
+  }
+
+  tdigestFlush(pDigest);
+  tdigestFlush(pInput);
+
+  if (pInput->min < pDigest->min) {
+    pDigest->min = pInput->min;
+  }
+
+  if (pInput->max > pDigest->max) {
+    pDigest->max = pInput->max;
+  }
+
+  tdigestCompress(pDigest, pInput->centroids, pInput->numOfCentroids);
+  return 0;
+}
+
+int64_t tTDigestSize(STDigest *pDigest) { return pDigest->totalWeight + pDigest->numOfBuffered; }
+
+/*
+ * the points of a centroid are assumed to be uniformly distributed around its mean, so the quantile is interpolated
+ * between the means of adjacent centroids, and between the min/max value and the first/last centroid.
+ */
+double tTDigestQuantile(STDigest *pDigest, double q) {
+  tdigestFlush(pDigest);
+
+  SCentroid *c = pDigest->centroids;
+  int32_t    n = pDigest->numOfCentroids;
+  double     total = (double)pDigest->totalWeight;
+
+  if (n == 0) {
+    return 0;
+  } else if (n == 1 && c[0].weight == 1) {
+    return c[0].mean;
+  }
+
+  double index = q * total;
+  if (index < 1) {
+    return pDigest->min;
+  } else if (index > total - 1) {
+    return pDigest->max;
+  }
+
+  if (c[0].weight > 1 && index < c[0].weight / 2.0) {
+    return pDigest->min + (index - 1) / (c[0].weight / 2.0 - 1) * (c[0].mean - pDigest->min);
+  }
+
+  // same as the left tail, a centroid of weight 2 has no tail to interpolate, otherwise index of total - 1 gives 0 / 0
+  if (c[n - 1].weight > 1 && total - index < c[n - 1].weight / 2.0) {
+    return pDigest->max - (total - index - 1) / (c[n - 1].weight / 2.0 - 1) * (pDigest->max - c[n - 1].mean);
+  }
+
+  double weightSoFar = c[0].weight / 2.0;
+  for (int32_t i = 0; i < n - 1; ++i) {
+    double delta = (c[i].weight + c[i + 1].weight) / 2.0;
+    if (weightSoFar + delta <= index) {
+      weightSoFar += delta;
+      continue;
+    }
+
+    // a centroid of single point is not spread
+    double leftUnit = 0;
+    if (c[i].weight == 1) {
+      if (index - weightSoFar < 0.5) {
+        return c[i].mean;
+      }
+      leftUnit = 0.5;
+    }
+
+    double rightUnit = 0;
+    if (c[i + 1].weight == 1) {
+      if (weightSoFar + delta - index <= 0.5) {
+        return c[i + 1].mean;
+      }
+      rightUnit = 0.5;
+    }
+
+    double z1 = index - weightSoFar - leftUnit;
+    double z2 = weightSoFar + delta - index - rightUnit;
+    if (z1 + z2 <= 0) {
+      return c[i].mean;
+    }
+
+    return (c[i].mean * z2 + c[i + 1].mean * z1) / (z1 + z2);
+  }
+
+  return c[n - 1].mean;
+}
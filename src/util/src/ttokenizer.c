@@ -206,6 +206,7 @@ static SKeyword keywordTable[] = {
     {"WAVG",        TK_WAVG},
     {"INTERP",      TK_INTERP},
     {"LAST_ROW",    TK_LAST_ROW},
+    {"HYPERLOGLOG", TK_HYPERLOGLOG},
     {"SEMI",        TK_SEMI,},
     {"NONE",        TK_NONE,},
     {"PREV",        TK_PREV,},
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// compare the histogram and t-digest of apercentile in speed and accuracy. The data is split into partitions, each
+// of them is added block by block like a meter in vnode, and all partitions are merged into one like the merge of
+// results from vnodes. The rank error of estimated percentile is measured against the exactly sorted data. The
+// percentiles at both tails of t-digest are checked to be within [min, max] as well, the program fails otherwise.
+// to compile: gcc -I../../../src/inc -I../../../src/os/linux/inc -o apercbench apercbench.c -ltaos -lm
+// usage: apercbench [numOfPoints] [numOfPartitions]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "taos.h"
+#include "thistogram.h"
+#include "ttdigest.h"
+
+#define BLOCK_SIZE 4096
+
+static double percents[] = {0.1, 1, 10, 25, 50, 75, 90, 99, 99.9};
+
+#define NUM_OF_PERCENTS (sizeof(percents) / sizeof(percents[0]))
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static double uniform() { return (rand() + 1.0) / (RAND_MAX + 2.0); }
+
+static void generate(double *data, int32_t num, int32_t dist) {
+  srand(num);
+
+  for (int32_t i = 0; i < num; ++i) {
+    switch (dist) {
+      case 0:  // uniform
+        data[i] = uniform() * 1000;
+        break;
+      case 1:  // exponential
+        data[i] = -log(uniform()) * 100;
+        break;
+      default:  // lognormal, heavily skewed
+        data[i] = exp(sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform()) * 2);
+        break;
+    }
+  }
+}
+
+static int compareDouble(const void *p1, const void *p2) {
+  double v1 = *(const double *)p1;
+  double v2 = *(const double *)p2;
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
+// the fraction of points that are less than or equal to v
+static double rankOf(double *sorted, int32_t num, double v) {
+  int32_t s = 0, e = num;
+  while (s < e) {
+    int32_t m = s + (e - s) / 2;
+    if (sorted[m] <= v) {
+      s = m + 1;
+    } else {
+      e = m;
+    }
+  }
+
+  return (double)s / num;
+}
+
+static int64_t histogramEstimate(double *data, int32_t num, int32_t numOfPartitions, double *res) {
+  int64_t st = getTimeUs();
+
+  SHistogramInfo *pRes = NULL;
+  int32_t         partSize = num / numOfPartitions;
+
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    SHistogramInfo *pHisto = tHistogramCreate(MAX_HISTOGRAM_BIN);
+    for (int32_t j = i * partSize; j < (i + 1) * partSize; ++j) {
+      tHistogramAdd(&pHisto, data[j]);
+    }
+
+    if (pRes == NULL) {
+      pRes = pHisto;
+    } else {
+      SHistogramInfo *pMerged = tHistogramMerge(pRes, pHisto, MAX_HISTOGRAM_BIN);
+      tHistogramDestroy(&pRes);
+      tHistogramDestroy(&pHisto);
+      pRes = pMerged;
+    }
+  }
+
+  double *v = tHistogramUniform(pRes, percents, NUM_OF_PERCENTS);
+  memcpy(res, v, sizeof(double) * NUM_OF_PERCENTS);
+  free(v);
+
+  tHistogramDestroy(&pRes);
+  return getTimeUs() - st;
+}
+
+static int64_t tdigestEstimate(double *data, int32_t num, int32_t numOfPartitions, double *res) {
+  int64_t st = getTimeUs();
+
+  STDigest *pRes = malloc(sizeof(STDigest));
+  STDigest *pDigest = malloc(sizeof(STDigest));
+  double *  block = malloc(sizeof(double) * BLOCK_SIZE);
+  int32_t   partSize = num / numOfPartitions;
+
+  tTDigestInit(pRes);
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    tTDigestInit(pDigest);
+
+    for (int32_t j = i * partSize; j < (i + 1) * partSize; j += BLOCK_SIZE) {
+      int32_t size = ((i + 1) * partSize - j < BLOCK_SIZE) ? (i + 1) * partSize - j : BLOCK_SIZE;
+      memcpy(block, data + j, sizeof(double) * size);  // the values of block are sorted in place
+      tTDigestAddBatch(pDigest, block, size);
+    }
+
+    tTDigestMerge(pRes, pDigest);
+  }
+
+  for (int32_t i = 0; i < NUM_OF_PERCENTS; ++i) {
+    res[i] = tTDigestQuantile(pRes, percents[i] / 100);
+  }
+
+  free(block);
+  free(pDigest);
+  free(pRes);
+  return getTimeUs() - st;
+}
+
+// the quantiles next to min and max are checked for digests of every size, including the index of total - 1 that
+// falls on the last centroid of weight 2
+static int32_t tdigestCheckTails(int32_t maxNum) {
+  STDigest *pDigest = malloc(sizeof(STDigest));
+  double *  block = malloc(sizeof(double) * maxNum);
+  int32_t   failed = 0;
+
+  for (int32_t num = 1; num <= maxNum && !failed; num += (num < 2000) ? 1 : 997) {
+    for (int32_t i = 0; i < num; ++i) {
+      block[i] = i;
+    }
+
+    tTDigestInit(pDigest);
+    tTDigestAddBatch(pDigest, block, num);
+
+    double qs[] = {0, 1.0 / num, 0.5, (num - 1.0) / num, 0.99995, 1};
+    double prev = 0;
+    for (int32_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i) {
+      double v = tTDigestQuantile(pDigest, qs[i]);
+      if (isnan(v) || v < 0 || v > num - 1 || v < prev) {
+        printf("  t-digest of %d points, quantile %g: %g is out of range\n", num, qs[i], v);
+        failed = 1;
+        break;
+      }
+
+      prev = v;
+    }
+  }
+
+  free(block);
+  free(pDigest);
+  return failed;
+}
+
+static void report(const char *name, int64_t elapsed, int32_t num, double *sorted, double *res) {
+  printf("  %-10s %8.2f ms, %6.2f Mpoints/s, rank error(%%):", name, elapsed / 1000.0,
+         elapsed > 0 ? (double)num / elapsed : 0);
+
+  for (int32_t i = 0; i < NUM_OF_PERCENTS; ++i) {
+    printf(" %.3f", fabs(rankOf(sorted, num, res[i]) - percents[i] / 100) * 100);
+  }
+
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  int32_t num = (argc > 1) ? atoi(argv[1]) : 1000000;
+  int32_t numOfPartitions = (argc > 2) ? atoi(argv[2]) : 16;
+
+  num = num / numOfPartitions * numOfPartitions;
+
+  double *data = malloc(sizeof(double) * num);
+  double *sorted = malloc(sizeof(double) * num);
+  if (data == NULL || sorted == NULL) {
+    printf("failed to allocate memory for %d points\n", num);
+    return 1;
+  }
+
+  const char *dists[] = {"uniform", "exponential", "lognormal"};
+  double      res[NUM_OF_PERCENTS];
+
+  printf("%d points in %d partitions, percents:", num, numOfPartitions);
+  for (int32_t i = 0; i < NUM_OF_PERCENTS; ++i) {
+    printf(" %g", percents[i]);
+  }
+  printf("\n");
+
+  for (int32_t i = 0; i < sizeof(dists) / sizeof(dists[0]); ++i) {
+    generate(data, num, i);
+
+    memcpy(sorted, data, sizeof(double) * num);
+    qsort(sorted, num, sizeof(double), compareDouble);
+
+    printf("%s\n", dists[i]);
+
+    int64_t elapsed = histogramEstimate(data, num, numOfPartitions, res);
+    report("histogram", elapsed, num, sorted, res);
+
+    elapsed = tdigestEstimate(data, num, numOfPartitions, res);
+    report("t-digest", elapsed, num, sorted, res);
+  }
+
+  int32_t failed = tdigestCheckTails(20000);
+  printf("t-digest tails: %s\n", failed ? "failed" : "ok");
+
+  free(data);
+  free(sorted);
+  return failed;
+}
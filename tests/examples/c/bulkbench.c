@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// compare the throughput and payload of writing rows by the binary columnar body of /rest/bulk and by sql,
+// the body of bulk request may exceed 64KB, e.g. bulkbench 127.0.0.1 1 10 10000 writes 100000 rows in one request,
+// while sql is limited to 64KB and the rows of each table are split into several requests
+// to compile: gcc -o bulkbench bulkbench.c
+// usage: bulkbench server-ip [numOfRequests] [tablesPerRequest] [rowsPerTable]
+
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define HTTP_PORT 6020
+#define AUTH      "cm9vdDp0YW9zZGF0YQ=="  // root:taosdata
+
+#define MAX_BULK_BODY_SIZE (16 * 1024 * 1024)  // HTTP_MAX_BULK_BODY_SIZE of server
+#define SQL_ROWS           1000                // rows of a table in one sql, which is limited to 64KB
+
+// types of taos.h
+#define TYPE_NULL      0
+#define TYPE_INT       4
+#define TYPE_DOUBLE    7
+#define TYPE_BINARY    8
+#define TYPE_TIMESTAMP 9
+
+static char response[65536];
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int connectServer(char *ip) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(HTTP_PORT);
+  addr.sin_addr.s_addr = inet_addr(ip);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    printf("failed to connect to %s:%d\n", ip, HTTP_PORT);
+    exit(1);
+  }
+
+  return fd;
+}
+
+// send the request in one piece, and read the response, which is either chunked or with content length
+static void post(int fd, char *url, char *body, int len) {
+  static char *request = NULL;
+  static int   capacity = 0;
+  if (len + 256 > capacity) {
+    capacity = len + 256;
+    request = realloc(request, (size_t)capacity);
+  }
+
+  int size = sprintf(request,
+                 "POST %s HTTP/1.1\r\nHost: bench\r\nAuthorization: Basic %s\r\nContent-Length: %d\r\n\r\n", url,
+                 AUTH, len);
+  memcpy(request + size, body, (size_t)len);
+  size += len;
+
+  if (write(fd, request, (size_t)size) != size) {
+    printf("failed to send request\n");
+    exit(1);
+  }
+
+  size = 0;
+  while (size < (int)sizeof(response) - 1) {
+    int n = (int)read(fd, response + size, sizeof(response) - 1 - (size_t)size);
+    if (n <= 0) break;
+    size += n;
+    response[size] = 0;
+
+    char *data = strstr(response, "\r\n\r\n");
+    if (data == NULL) continue;
+    data += 4;
+
+    char *contentLen = strstr(response, "Content-Length:");
+    if (contentLen != NULL && contentLen < data) {
+      if (response + size - data >= atoi(contentLen + 15)) break;
+    } else if (strstr(data, "\r\n0\r\n\r\n") != NULL) {
+      break;
+    }
+  }
+
+  if (strstr(response, "\"status\":\"succ\"") == NULL) {
+    printf("request failed:%.512s\n", response);
+    exit(1);
+  }
+}
+
+static char *put(char *p, void *value, int len) {
+  memcpy(p, value, (size_t)len);
+  return p + len;
+}
+
+static char *putName(char *p, char *name) {
+  uint8_t len = (uint8_t)strlen(name);
+  p = put(p, &len, sizeof(len));
+  return put(p, name, len);
+}
+
+static char *putColumn(char *p, char *name, uint8_t type, uint8_t flags) {
+  p = putName(p, name);
+  p = put(p, &type, sizeof(type));
+  return put(p, &flags, sizeof(flags));
+}
+
+// tables t<id>, and s<id> written by sql, of stable st(ts timestamp, v double, n int, s binary(16)) tags(id int, loc binary(16))
+static int buildBulk(char *body, int request, int numOfTables, int rows, int64_t ts) {
+  char *   p = put(body, "TDBC", 4);
+  uint8_t  version = 1;
+  uint8_t  reserved = 0;
+  uint16_t tables = (uint16_t)numOfTables;
+  p = put(p, &version, 1);
+  p = put(p, &reserved, 1);
+  p = put(p, &tables, 2);
+
+  for (int t = 0; t < numOfTables; ++t) {
+    int32_t id = request * numOfTables + t;
+    char    name[32];
+    sprintf(name, "t%d", id);
+    p = putName(p, name);
+    p = putName(p, "st");
+
+    uint8_t  numOfTags = 2, type = TYPE_INT;
+    uint16_t len = sizeof(id);
+    p = put(p, &numOfTags, 1);
+    p = put(p, &type, 1);
+    p = put(p, &len, 2);
+    p = put(p, &id, len);
+
+    char loc[16];
+    type = TYPE_BINARY;
+    len = (uint16_t)sprintf(loc, "loc%d", id % 10);
+    p = put(p, &type, 1);
+    p = put(p, &len, 2);
+    p = put(p, loc, len);
+
+    uint16_t numOfColumns = 4;
+    uint32_t numOfRows = (uint32_t)rows;
+    p = put(p, &numOfColumns, 2);
+    p = put(p, &numOfRows, 4);
+
+    p = putColumn(p, "ts", TYPE_TIMESTAMP, 0);
+    for (int r = 0; r < rows; ++r) {
+      int64_t v = ts + r;
+      p = put(p, &v, sizeof(v));
+    }
+
+    p = putColumn(p, "v", TYPE_DOUBLE, 0);
+    for (int r = 0; r < rows; ++r) {
+      double v = r + 0.5;
+      p = put(p, &v, sizeof(v));
+    }
+
+    // every tenth value of n is null
+    p = putColumn(p, "n", TYPE_INT, 1);
+    for (int r = 0; r < rows; ++r) {
+      int8_t isNull = (r % 10 == 0);
+      p = put(p, &isNull, 1);
+    }
+    for (int r = 0; r < rows; ++r) {
+      int32_t v = r;
+      p = put(p, &v, sizeof(v));
+    }
+
+    p = putColumn(p, "s", TYPE_BINARY, 0);
+    char *lengths = p;
+    p += rows * sizeof(uint16_t);
+    for (int r = 0; r < rows; ++r) {
+      len = (uint16_t)sprintf(p, "s%d", r % 100);
+      memcpy(lengths + r * sizeof(uint16_t), &len, sizeof(len));
+      p += len;
+    }
+  }
+
+  return (int)(p - body);
+}
+
+// rows [start, end) of table s<id>
+static int buildSql(char *body, int id, int start, int end, int64_t ts) {
+  int len = sprintf(body, "insert into bulkbench.s%d using bulkbench.st tags(%d,'loc%d') values", id, id, id % 10);
+  for (int r = start; r < end; ++r) {
+    if (r % 10 == 0) {
+      len += sprintf(body + len, "(%ld,%d.5,NULL,'s%d')", ts + r, r, r % 100);
+    } else {
+      len += sprintf(body + len, "(%ld,%d.5,%d,'s%d')", ts + r, r, r, r % 100);
+    }
+  }
+
+  return len;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("usage: %s server-ip [numOfRequests] [tablesPerRequest] [rowsPerTable]\n", argv[0]);
+    return 0;
+  }
+
+  int numOfRequests = (argc > 2) ? atoi(argv[2]) : 100;
+  int numOfTables = (argc > 3) ? atoi(argv[3]) : 10;
+  int rows = (argc > 4) ? atoi(argv[4]) : 200;
+  if (numOfRequests <= 0 || numOfTables <= 0 || rows <= 0) {
+    printf("invalid number of requests:%d, tables:%d or rows:%d\n", numOfRequests, numOfTables, rows);
+    return 1;
+  }
+
+  // the body of bulk request is limited to 16MB
+  int64_t bodySize = (int64_t)numOfTables * rows * 50 + 65536;
+  if (bodySize > MAX_BULK_BODY_SIZE) {
+    printf("%d tables of %d rows exceed the limit of request body\n", numOfTables, rows);
+    return 1;
+  }
+
+  char *body = malloc((size_t)bodySize);
+  int   fd = connectServer(argv[1]);
+
+  char *sql = "create database if not exists bulkbench";
+  post(fd, "/rest/sql", sql, (int)strlen(sql));
+  sql = "create table if not exists bulkbench.st(ts timestamp, v double, n int, s binary(16)) "
+        "tags(id int, loc binary(16))";
+  post(fd, "/rest/sql", sql, (int)strlen(sql));
+
+  int64_t ts = 1500000000000L;
+  int64_t bulkBytes = 0;
+  int64_t st = getTimeUs();
+  for (int r = 0; r < numOfRequests; ++r, ts += rows) {
+    int len = buildBulk(body, r, numOfTables, rows, ts);
+    post(fd, "/rest/bulk/bulkbench", body, len);
+    bulkBytes += len;
+  }
+  int64_t bulkElapsed = getTimeUs() - st;
+
+  int64_t sqlBytes = 0;
+  int     sqlRequests = 0;
+  st = getTimeUs();
+  for (int r = 0; r < numOfRequests; ++r, ts += rows) {
+    for (int t = 0; t < numOfTables; ++t) {
+      for (int start = 0; start < rows; start += SQL_ROWS) {
+        int end = (start + SQL_ROWS < rows) ? start + SQL_ROWS : rows;
+        int len = buildSql(body, r * numOfTables + t, start, end, ts);
+        post(fd, "/rest/sql", body, len);
+        sqlBytes += len;
+        sqlRequests++;
+      }
+    }
+  }
+  int64_t sqlElapsed = getTimeUs() - st;
+
+  int64_t total = (int64_t)numOfRequests * numOfTables * rows;
+  printf("%ld rows of %d tables\n", total, numOfRequests * numOfTables);
+  printf("bulk: %.3f seconds, %.0f rows/second, %ld bytes in %d requests\n", (double)bulkElapsed / 1000000.0,
+         (double)total * 1000000.0 / (double)bulkElapsed, bulkBytes, numOfRequests);
+  printf("sql:  %.3f seconds, %.0f rows/second, %ld bytes in %d requests\n", (double)sqlElapsed / 1000000.0,
+         (double)total * 1000000.0 / (double)sqlElapsed, sqlBytes, sqlRequests);
+
+  close(fd);
+  free(body);
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// compare the throughput of creating child tables one by one and by multi-table create statement
+// to compile: gcc -o createbench createbench.c -ltaos
+// usage: createbench server-ip [numOfTables] [tablesPerStatement]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <taos.h>  // TAOS header file
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void execute(TAOS *taos, char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to execute:%.128s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+}
+
+static void prepare(TAOS *taos) {
+  taos_query(taos, "drop database createbench");
+  execute(taos, "create database createbench tables 10000");
+  execute(taos, "use createbench");
+  execute(taos, "create table st (ts timestamp, v int) tags(id int, loc binary(16))");
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("usage: %s server-ip [numOfTables] [tablesPerStatement]\n", argv[0]);
+    return 0;
+  }
+
+  int numOfTables = (argc > 2) ? atoi(argv[2]) : 10000;
+  int batch = (argc > 3) ? atoi(argv[3]) : 200;
+  if (numOfTables <= 0 || batch <= 0) {
+    printf("invalid number of tables:%d or tables per statement:%d\n", numOfTables, batch);
+    return 1;
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  char *sql = malloc(64 * batch + 64);
+
+  // one table per statement
+  prepare(taos);
+
+  int64_t st = getTimeUs();
+  for (int i = 0; i < numOfTables; ++i) {
+    sprintf(sql, "create table t%d using st tags(%d, 'loc%d')", i, i, i % 100);
+    execute(taos, sql);
+  }
+  int64_t single = getTimeUs() - st;
+
+  // a batch of tables per statement
+  prepare(taos);
+
+  st = getTimeUs();
+  for (int i = 0; i < numOfTables; i += batch) {
+    int len = sprintf(sql, "create table");
+    for (int j = i; j < i + batch && j < numOfTables; ++j) {
+      len += sprintf(sql + len, " t%d using st tags(%d, 'loc%d')", j, j, j % 100);
+    }
+
+    execute(taos, sql);
+    if (taos_affected_rows(taos) != ((i + batch < numOfTables) ? batch : numOfTables - i)) {
+      printf("only %d tables are created in statement from t%d\n", taos_affected_rows(taos), i);
+      exit(1);
+    }
+  }
+  int64_t multi = getTimeUs() - st;
+
+  printf("%d tables, one per statement:  %lld us, %.2f tables/sec\n", numOfTables, single,
+         numOfTables * 1000000.0 / single);
+  printf("%d tables, %d per statement: %lld us, %.2f tables/sec\n", numOfTables, batch, multi,
+         numOfTables * 1000000.0 / multi);
+
+  free(sql);
+  taos_close(taos);
+
+  return 0;
+}
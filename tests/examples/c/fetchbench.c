@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// compare the fetch throughput of taos_fetch_row and taos_fetch_columns
+// to compile: gcc -o fetchbench fetchbench.c -ltaos
+// usage: fetchbench server-ip "select * from db.tb" [rounds]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <taos.h>  // TAOS header file
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// touch every value like a connector does, nchar values are skipped since they are converted in taos_fetch_row
+static int64_t fetchByRow(TAOS *taos, char *sql, int64_t *checksum) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to query:%s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+
+  TAOS_RES *  result = taos_use_result(taos);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int         numOfFields = taos_num_fields(result);
+  int64_t     rows = 0;
+  TAOS_ROW    row;
+
+  while ((row = taos_fetch_row(result)) != NULL) {
+    for (int i = 0; i < numOfFields; ++i) {
+      if (row[i] != NULL && fields[i].type != TSDB_DATA_TYPE_NCHAR) {
+        *checksum += *(char *)row[i] + fields[i].bytes;
+      }
+    }
+    rows++;
+  }
+
+  taos_free_result(result);
+  return rows;
+}
+
+static int64_t fetchByColumn(TAOS *taos, char *sql, int64_t *checksum) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to query:%s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+
+  TAOS_RES *   result = taos_use_result(taos);
+  int          numOfFields = taos_num_fields(result);
+  int64_t      rows = 0;
+  TAOS_COLUMN *columns = NULL;
+  int          numOfRows = 0;
+
+  while ((numOfRows = taos_fetch_columns(result, &columns)) > 0) {
+    for (int i = 0; i < numOfFields; ++i) {
+      char *data = columns[i].data;
+      for (int j = 0; j < numOfRows; ++j) {
+        if ((columns[i].nullBitmap[j >> 3] & (1u << (j & 7u))) == 0 && columns[i].type != TSDB_DATA_TYPE_NCHAR) {
+          *checksum += *(data + j * columns[i].bytes) + columns[i].bytes;
+        }
+      }
+    }
+    rows += numOfRows;
+  }
+
+  taos_free_result(result);
+  return rows;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    printf("usage: %s server-ip sql [rounds]\n", argv[0]);
+    return 0;
+  }
+
+  int rounds = (argc > 3) ? atoi(argv[3]) : 5;
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  int64_t rowChecksum = 0, colChecksum = 0;
+  int64_t rowTime = 0, colTime = 0;
+  int64_t rows = 0;
+
+  for (int i = 0; i < rounds; ++i) {
+    int64_t st = getTimeUs();
+    rows = fetchByRow(taos, argv[2], &rowChecksum);
+    rowTime += getTimeUs() - st;
+
+    st = getTimeUs();
+    fetchByColumn(taos, argv[2], &colChecksum);
+    colTime += getTimeUs() - st;
+  }
+
+  if (rowChecksum != colChecksum) {
+    printf("checksum mismatch, row:%ld column:%ld\n", rowChecksum, colChecksum);
+  }
+
+  printf("rows:%ld rounds:%d\n", rows, rounds);
+  printf("taos_fetch_row     : %10.2f ms/round, %12.2f rows/s\n", rowTime / 1000.0 / rounds,
+         rowTime > 0 ? rows * rounds * 1000000.0 / rowTime : 0);
+  printf("taos_fetch_columns : %10.2f ms/round, %12.2f rows/s\n", colTime / 1000.0 / rounds,
+         colTime > 0 ? rows * rounds * 1000000.0 / colTime : 0);
+
+  taos_close(taos);
+  return 0;
+}
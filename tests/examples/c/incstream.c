@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// incremental stream example, two stream tables are created on the same table. The first one is computed
+// incrementally by the vnode as the rows are inserted, the second one has a filter that all rows satisfy, so it is
+// computed by query as before. The results of the windows written by both streams are compared. The source table is
+// created from a super table, so its tags are listed by describe as well.
+// to compile: gcc -o incstream incstream.c -ltaos
+// usage: incstream server-ip
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <taos.h>
+
+#define NUM_OF_ROWS  150
+#define ROW_INTERVAL 100000  // in us
+#define MAX_WINDOWS  256
+#define NUM_OF_COLS  4
+
+typedef struct {
+  int32_t numOfWindows;
+  int64_t keys[MAX_WINDOWS];
+  double  values[MAX_WINDOWS][NUM_OF_COLS];
+} SStreamResult;
+
+static void execute(TAOS *taos, char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to execute:%s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+}
+
+static double getValue(TAOS_FIELD *field, void *p) {
+  switch (field->type) {
+    case TSDB_DATA_TYPE_INT:
+      return *(int32_t *)p;
+    case TSDB_DATA_TYPE_BIGINT:
+      return (double)*(int64_t *)p;
+    default:
+      return *(double *)p;
+  }
+}
+
+static void query(TAOS *taos, char *sql, SStreamResult *pRes) {
+  execute(taos, sql);
+
+  TAOS_RES *  result = taos_use_result(taos);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  TAOS_ROW    row;
+
+  pRes->numOfWindows = 0;
+  while ((row = taos_fetch_row(result)) != NULL && pRes->numOfWindows < MAX_WINDOWS) {
+    pRes->keys[pRes->numOfWindows] = *(int64_t *)row[0];
+    for (int i = 0; i < NUM_OF_COLS; ++i) {
+      pRes->values[pRes->numOfWindows][i] = (row[i + 1] == NULL) ? NAN : getValue(&fields[i + 1], row[i + 1]);
+    }
+    pRes->numOfWindows++;
+  }
+
+  taos_free_result(result);
+}
+
+int main(int argc, char *argv[]) {
+  static SStreamResult inc, qry;
+
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database incstreamdemo");
+  execute(taos, "create database incstreamdemo");
+  execute(taos, "use incstreamdemo");
+  execute(taos, "create table st (ts timestamp, v int) tags (t1 int, t2 binary(8))");
+  execute(taos, "create table t using st tags (1, 'a')");
+  execute(taos, "create table s1 as select count(*), sum(v), min(v), max(v) from t interval(2s)");
+  execute(taos, "create table s2 as select count(*), sum(v), min(v), max(v) from t where v > -1000 interval(2s)");
+
+  // wait for the streams to be opened
+  sleep(5);
+
+  char sql[128];
+  for (int i = 0; i < NUM_OF_ROWS; ++i) {
+    sprintf(sql, "insert into t values (now, %d)", i % 37 - 10);
+    execute(taos, sql);
+    usleep(ROW_INTERVAL);
+  }
+
+  printf("%d rows are inserted, wait for the streams\n", NUM_OF_ROWS);
+  sleep(20);
+
+  query(taos, "select * from s1", &inc);
+  query(taos, "select * from s2", &qry);
+
+  // the streams may start from different windows, only the windows computed by both are compared
+  int failed = 0;
+  int common = 0;
+  for (int i = 0; i < inc.numOfWindows; ++i) {
+    int j = 0;
+    while (j < qry.numOfWindows && qry.keys[j] != inc.keys[i]) j++;
+    if (j == qry.numOfWindows) continue;
+
+    common++;
+    for (int k = 0; k < NUM_OF_COLS; ++k) {
+      if (fabs(inc.values[i][k] - qry.values[j][k]) > 1e-6 * (fabs(qry.values[j][k]) + 1)) {
+        printf("window:%ld col:%d incremental:%f query:%f\n", inc.keys[i], k, inc.values[i][k], qry.values[j][k]);
+        failed = 1;
+      }
+    }
+  }
+
+  printf("windows incremental:%d query:%d common:%d\n", inc.numOfWindows, qry.numOfWindows, common);
+  if (common < NUM_OF_ROWS * ROW_INTERVAL / 2000000 / 2) failed = 1;
+
+  taos_query(taos, "drop database incstreamdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
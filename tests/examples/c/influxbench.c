@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// compare the throughput of writing points by influxdb line protocol and by sql through the http port
+// to compile: gcc -o influxbench influxbench.c
+// usage: influxbench server-ip [numOfRequests] [linesPerRequest] [numOfSeries]
+
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define HTTP_PORT 6020
+#define AUTH      "cm9vdDp0YW9zZGF0YQ=="  // root:taosdata
+
+static char response[65536];
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int connectServer(char *ip) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(HTTP_PORT);
+  addr.sin_addr.s_addr = inet_addr(ip);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    printf("failed to connect to %s:%d\n", ip, HTTP_PORT);
+    exit(1);
+  }
+
+  return fd;
+}
+
+// send the request in one piece, and read the response, which is either chunked or with content length
+static void post(int fd, char *url, char *body, int len) {
+  static char request[65536 + 256];
+  int         size = sprintf(request,
+                     "POST %s HTTP/1.1\r\nHost: bench\r\nAuthorization: Basic %s\r\nContent-Length: %d\r\n\r\n", url,
+                     AUTH, len);
+  memcpy(request + size, body, (size_t)len);
+  size += len;
+
+  if (write(fd, request, (size_t)size) != size) {
+    printf("failed to send request\n");
+    exit(1);
+  }
+
+  size = 0;
+  while (size < (int)sizeof(response) - 1) {
+    int n = (int)read(fd, response + size, sizeof(response) - 1 - (size_t)size);
+    if (n <= 0) break;
+    size += n;
+    response[size] = 0;
+
+    char *data = strstr(response, "\r\n\r\n");
+    if (data == NULL) continue;
+    data += 4;
+
+    char *contentLen = strstr(response, "Content-Length:");
+    if (contentLen != NULL && contentLen < data) {
+      if (response + size - data >= atoi(contentLen + 15)) break;
+    } else if (strstr(data, "\r\n0\r\n\r\n") != NULL) {
+      break;
+    }
+  }
+
+  if (strstr(response, "\"status\":\"succ\"") == NULL) {
+    printf("request failed:%.512s\n", response);
+    exit(1);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("usage: %s server-ip [numOfRequests] [linesPerRequest] [numOfSeries]\n", argv[0]);
+    return 0;
+  }
+
+  int numOfRequests = (argc > 2) ? atoi(argv[2]) : 1000;
+  int lines = (argc > 3) ? atoi(argv[3]) : 500;
+  int numOfSeries = (argc > 4) ? atoi(argv[4]) : 100;
+  if (numOfRequests <= 0 || lines <= 0 || numOfSeries <= 0) {
+    printf("invalid number of requests:%d, lines:%d or series:%d\n", numOfRequests, lines, numOfSeries);
+    return 1;
+  }
+
+  // the body of http request is limited to 64KB
+  char *body = malloc(65536);
+  int   fd = connectServer(argv[1]);
+
+  char *sql = "create database if not exists influxbench";
+  post(fd, "/rest/sql", sql, (int)strlen(sql));
+  sql = "create table if not exists influxbench.cpu(ts timestamp, f_usage double, f_load bigint) "
+        "tags(t_host binary(64), t_region binary(64))";
+  post(fd, "/rest/sql", sql, (int)strlen(sql));
+
+  int64_t ts = 1500000000000L;
+  int64_t st = getTimeUs();
+  for (int r = 0; r < numOfRequests; ++r) {
+    int len = 0;
+    for (int i = 0; i < lines && len < 60000; ++i, ++ts) {
+      len += sprintf(body + len, "cpu,host=h%d,region=r%d usage=%d.5,load=%di %ld\n", i % numOfSeries,
+                     i % numOfSeries % 4, i, r, ts);
+    }
+    post(fd, "/influxdb/influxbench?precision=ms", body, len);
+  }
+  int64_t lpElapsed = getTimeUs() - st;
+
+  // the same points written by sql, the tables are created by the line protocol above
+  st = getTimeUs();
+  for (int r = 0; r < numOfRequests; ++r) {
+    int len = sprintf(body, "insert into");
+    for (int i = 0; i < lines && len < 60000; ++i, ++ts) {
+      len += sprintf(body + len, " influxbench.s%d using influxbench.cpu tags('h%d','r%d') values(%ld,%d.5,%d)",
+                     i % numOfSeries, i % numOfSeries, i % numOfSeries % 4, ts, i, r);
+    }
+    post(fd, "/rest/sql", body, len);
+  }
+  int64_t sqlElapsed = getTimeUs() - st;
+
+  int64_t rows = (int64_t)numOfRequests * lines;
+  printf("%ld points in %d requests of %d series\n", rows, numOfRequests, numOfSeries);
+  printf("line protocol: %.3f seconds, %.0f points/second\n", (double)lpElapsed / 1000000.0,
+         (double)rows * 1000000.0 / (double)lpElapsed);
+  printf("sql:           %.3f seconds, %.0f points/second\n", (double)sqlElapsed / 1000000.0,
+         (double)rows * 1000000.0 / (double)sqlElapsed);
+
+  close(fd);
+  free(body);
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// buffered insert example, the requests of a flush are reported per vgroup: one vgroup fails since its table is
+// dropped by another process, the requests of the other vgroup still succeed. The failed vgroup of a multi-vnode
+// insertion is retrieved by taos_failed_vgroups as well.
+// to compile: gcc -o insertbuf insertbuf.c -ltaos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <taos.h>
+
+#define NUM_OF_TABLES 5
+
+static int result[NUM_OF_TABLES];
+
+static void insertCallback(void *param, TAOS_RES *tres, int code) {
+  result[(long)param] = code;
+}
+
+static void dropTable(char *ip) {
+  TAOS *taos = taos_connect(ip, "root", "taosdata", "bufdemo", 0);
+  if (taos == NULL || taos_query(taos, "drop table t4") != 0 || taos_query(taos, "drop table t5") != 0) {
+    printf("failed to drop table, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_close(taos);
+  exit(0);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  // the table is dropped by another process, so the meta cached by this process becomes stale
+  int fd[2];
+  if (pipe(fd) != 0) {
+    printf("failed to create pipe\n");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    char c;
+    close(fd[1]);
+    if (read(fd[0], &c, 1) != 1) exit(1);
+    taos_init();
+    dropTable(argv[1]);
+  }
+
+  close(fd[0]);
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  // tables t0-t3 are created in the first vgroup, and t4, t5 in the second one, t5 is used after t4 fails
+  taos_query(taos, "drop database bufdemo");
+  if (taos_query(taos, "create database bufdemo tables 4") != 0) {
+    printf("failed to create database, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "use bufdemo");
+
+  char sql[256];
+  for (int i = 0; i <= NUM_OF_TABLES; ++i) {
+    sprintf(sql, "create table t%d (ts timestamp, speed int)", i);
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to create table, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+
+    sprintf(sql, "insert into t%d values(1500000000000, 1)", i);
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to insert, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+  }
+
+  int status = 0;
+  if (write(fd[1], "d", 1) != 1 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    printf("failed to drop table in another process\n");
+    exit(1);
+  }
+
+  for (long i = 0; i < NUM_OF_TABLES; ++i) {
+    sprintf(sql, "insert into t%ld values(1500000000001, 2)(1500000000002, 3)", i);
+    if (taos_insert_buffered(taos, sql, insertCallback, (void *)i) != 0) {
+      printf("failed to buffer insert, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+  }
+
+  int code = taos_flush_insert(taos);
+  printf("flushed, code:%d\n", code);
+
+  int failed = 0;
+  for (int i = 0; i < NUM_OF_TABLES; ++i) {
+    int expected = (i == NUM_OF_TABLES - 1) ? 0 : 2;
+    printf("t%d: %d\n", i, result[i]);
+    if ((expected > 0 && result[i] != expected) || (expected == 0 && result[i] >= 0)) {
+      printf("t%d: unexpected result:%d\n", i, result[i]);
+      failed = 1;
+    }
+  }
+
+  // the vgroup failed in a multi-vnode insertion is reported by taos_failed_vgroups
+  int vgid = 0, vcode = 0;
+  code = taos_query(taos, "insert into t0 values(1500000000003, 4) t5 values(1500000000003, 4)");
+  int numOfFailed = taos_failed_vgroups(taos_use_result(taos), &vgid, &vcode, 1);
+  printf("multi-vnode insertion, code:%d, failed vgroups:%d, vgid:%d, code:%d\n", code, numOfFailed, vgid, vcode);
+  if (code == 0 || numOfFailed != 1 || vcode != code) {
+    printf("unexpected result of multi-vnode insertion\n");
+    failed = 1;
+  }
+
+  taos_query(taos, "drop database bufdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
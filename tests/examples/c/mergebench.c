@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// measure the client-side merge time of a metric query with a large result, which is spilled to disk if the
+// localReduceBufSize of client configuration is small. Run it with different localReduceBufSize,
+// localReduceThreads and localReduceSpillComp in cfg-dir to compare.
+// to compile: gcc -o mergebench mergebench.c -ltaos
+// usage: mergebench server-ip cfg-dir [numOfTables] [rowsPerTable] [rounds]
+//        rowsPerTable 0 reuses the data generated by previous run
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <taos.h>  // TAOS header file
+
+#define ROWS_PER_INSERT 500
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void execute(TAOS *taos, char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to execute:%.128s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+}
+
+// the tables are spread over several vnodes, so the result is retrieved from and merged across vnodes
+static void prepare(TAOS *taos, int numOfTables, int rowsPerTable) {
+  char    sql[64 * ROWS_PER_INSERT];
+  int64_t start = 1600000000000L;
+
+  execute(taos, "drop database if exists mergebench");
+  execute(taos, "create database mergebench tables 10");
+  execute(taos, "create table mergebench.st (ts timestamp, v int) tags (t1 int, t2 binary(16))");
+
+  for (int i = 0; i < numOfTables; ++i) {
+    sprintf(sql, "create table mergebench.t%d using mergebench.st tags (%d, 'g%d')", i, i, i % 7);
+    execute(taos, sql);
+  }
+
+  for (int i = 0; i < numOfTables; ++i) {
+    for (int j = 0; j < rowsPerTable; j += ROWS_PER_INSERT) {
+      int len = sprintf(sql, "insert into mergebench.t%d values", i);
+      for (int k = j; k < j + ROWS_PER_INSERT && k < rowsPerTable; ++k) {
+        len += sprintf(sql + len, " (%ld, %d)", start + k * 1000L, (k * 7 + i) % 1000);
+      }
+
+      execute(taos, sql);
+    }
+  }
+}
+
+static int64_t query(TAOS *taos, char *sql, int64_t *checksum) {
+  execute(taos, sql);
+
+  TAOS_RES *result = taos_use_result(taos);
+  int64_t   rows = 0;
+  TAOS_ROW  row;
+
+  while ((row = taos_fetch_row(result)) != NULL) {
+    *checksum += *(int64_t *)row[1];
+    rows++;
+  }
+
+  taos_free_result(result);
+  return rows;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    printf("usage: %s server-ip cfg-dir [numOfTables] [rowsPerTable] [rounds]\n", argv[0]);
+    return 0;
+  }
+
+  int numOfTables = (argc > 3) ? atoi(argv[3]) : 100;
+  int rowsPerTable = (argc > 4) ? atoi(argv[4]) : 10000;
+  int rounds = (argc > 5) ? atoi(argv[5]) : 3;
+
+  taos_options(TSDB_OPTION_CONFIGDIR, argv[2]);
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  if (rowsPerTable > 0) {
+    int64_t st = getTimeUs();
+    prepare(taos, numOfTables, rowsPerTable);
+    printf("%d tables with %d rows each are generated in %.2f s\n", numOfTables, rowsPerTable,
+           (getTimeUs() - st) / 1000000.0);
+  }
+
+  // one result row for each table in each second, all of them are sorted and merged by client
+  char *sqls[] = {
+      "select count(*), sum(v) from mergebench.st interval(1s) group by t1",
+      "select count(*), max(v) from mergebench.st interval(1s) group by t2",
+  };
+
+  for (int i = 0; i < sizeof(sqls) / sizeof(sqls[0]); ++i) {
+    int64_t checksum = 0;
+    int64_t rows = 0;
+    int64_t elapsed = 0;
+
+    for (int j = 0; j < rounds; ++j) {
+      int64_t st = getTimeUs();
+      rows = query(taos, sqls[i], &checksum);
+      elapsed += getTimeUs() - st;
+    }
+
+    printf("%s\n  rows:%ld checksum:%ld, %10.2f ms/round, %12.2f rows/s\n", sqls[i], rows, checksum / rounds,
+           elapsed / 1000.0 / rounds, elapsed > 0 ? rows * rounds * 1000000.0 / elapsed : 0);
+  }
+
+  taos_close(taos);
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// prepared statement example, values are bound column by column for a batch of rows
+// to compile: gcc -o prepare prepare.c -ltaos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <taos.h>
+
+#define NUM_OF_ROWS 1000
+
+static int64_t getTimestampUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  int numOfBatches = (argc > 2) ? atoi(argv[2]) : 100;
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database demo");
+  if (taos_query(taos, "create database demo") != 0) {
+    printf("failed to create database, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "use demo");
+  if (taos_query(taos, "create table m1 (ts timestamp, speed int, name binary(16))") != 0) {
+    printf("failed to create table, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  if (taos_stmt_prepare(stmt, "insert into m1 values(?, ?, ?)") != 0) {
+    printf("failed to prepare insert, reason:%s\n", taos_stmt_errstr(stmt));
+    exit(1);
+  }
+
+  int64_t ts[NUM_OF_ROWS];
+  int     speed[NUM_OF_ROWS];
+  char    name[NUM_OF_ROWS][16];
+  int     length[NUM_OF_ROWS];
+  char    isNull[NUM_OF_ROWS] = {0};
+
+  TAOS_BIND bind[3] = {
+      {TSDB_DATA_TYPE_TIMESTAMP, ts, sizeof(int64_t), NULL, NULL},
+      {TSDB_DATA_TYPE_INT, speed, sizeof(int), NULL, isNull},
+      {TSDB_DATA_TYPE_BINARY, name, sizeof(name[0]), length, NULL},
+  };
+
+  int64_t start = 1500000000000L;
+  int64_t st = getTimestampUs();
+
+  for (int i = 0; i < numOfBatches; ++i) {
+    for (int j = 0; j < NUM_OF_ROWS; ++j) {
+      ts[j] = start++;
+      speed[j] = j;
+      isNull[j] = (j % 10 == 0);
+      length[j] = sprintf(name[j], "car%d", j);
+    }
+
+    if (taos_stmt_bind_param(stmt, bind, NUM_OF_ROWS) != 0 || taos_stmt_add_batch(stmt) != 0 ||
+        taos_stmt_execute(stmt) != 0) {
+      printf("failed to insert rows, reason:%s\n", taos_stmt_errstr(stmt));
+      exit(1);
+    }
+  }
+
+  int64_t et = getTimestampUs();
+  int64_t total = (int64_t)numOfBatches * NUM_OF_ROWS;
+  printf("%lld rows inserted in %lld us, %.2f rows/sec\n", total, et - st, total * 1000000.0 / (et - st));
+
+  // parameterized query
+  if (taos_stmt_prepare(stmt, "select count(*), avg(speed) from m1 where ts >= ? and name = ?") != 0) {
+    printf("failed to prepare query, reason:%s\n", taos_stmt_errstr(stmt));
+    exit(1);
+  }
+
+  int64_t   skey = 1500000000000L;
+  int       nameLen = 4;
+  TAOS_BIND param[2] = {
+      {TSDB_DATA_TYPE_TIMESTAMP, &skey, sizeof(int64_t), NULL, NULL},
+      {TSDB_DATA_TYPE_BINARY, "car1", 4, &nameLen, NULL},
+  };
+
+  if (taos_stmt_bind_param(stmt, param, 1) != 0 || taos_stmt_execute(stmt) != 0) {
+    printf("failed to query, reason:%s\n", taos_stmt_errstr(stmt));
+    exit(1);
+  }
+
+  TAOS_RES *  result = taos_stmt_use_result(stmt);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int         numOfFields = taos_num_fields(result);
+  TAOS_ROW    row;
+  char        temp[256];
+
+  while ((row = taos_fetch_row(result))) {
+    taos_print_row(temp, row, fields, numOfFields);
+    printf("%s\n", temp);
+  }
+
+  taos_free_result(result);
+  taos_stmt_close(stmt);
+  taos_close(taos);
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// rollup example, the interval query answered by rollups is compared with the same query on raw data, which is
+// forced by a column filter that all rows satisfy. The data span several files of one day, and some windows cross
+// the boundary of files. Rollups are kept only if rollupLevel1/rollupLevel2 are configured in server, e.g., 60 and
+// 3600, and they are built when the data are committed, so the example waits for the commit of database.
+// to compile: gcc -o rollupquery rollupquery.c -ltaos
+// usage: rollupquery server-ip
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <taos.h>
+
+#define MS_PER_DAY    86400000L
+#define ROW_INTERVAL  37000L
+#define ROWS_PER_SQL  200
+#define COMMIT_TIME   30
+#define MAX_WINDOWS   2048
+#define NUM_OF_COLS   5
+
+typedef struct {
+  int32_t numOfWindows;
+  int64_t keys[MAX_WINDOWS];
+  double  values[MAX_WINDOWS][NUM_OF_COLS];
+} SQueryResult;
+
+static void execute(TAOS *taos, char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to execute:%s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+}
+
+static double getValue(TAOS_FIELD *field, void *p) {
+  switch (field->type) {
+    case TSDB_DATA_TYPE_INT:
+      return *(int32_t *)p;
+    case TSDB_DATA_TYPE_BIGINT:
+      return (double)*(int64_t *)p;
+    default:
+      return *(double *)p;
+  }
+}
+
+static void query(TAOS *taos, char *sql, SQueryResult *pRes) {
+  execute(taos, sql);
+
+  TAOS_RES *  result = taos_use_result(taos);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  TAOS_ROW    row;
+
+  pRes->numOfWindows = 0;
+  while ((row = taos_fetch_row(result)) != NULL && pRes->numOfWindows < MAX_WINDOWS) {
+    pRes->keys[pRes->numOfWindows] = *(int64_t *)row[0];
+    for (int i = 0; i < NUM_OF_COLS; ++i) {
+      pRes->values[pRes->numOfWindows][i] = (row[i + 1] == NULL) ? NAN : getValue(&fields[i + 1], row[i + 1]);
+    }
+    pRes->numOfWindows++;
+  }
+
+  taos_free_result(result);
+}
+
+static int check(TAOS *taos, int64_t skey, int64_t ekey, char *interval) {
+  static SQueryResult rollup, raw;
+  char                sql[512];
+
+  sprintf(sql, "select count(*), sum(v), min(v), max(v), avg(f) from t where ts >= %ld and ts < %ld interval(%s)",
+          skey, ekey, interval);
+  query(taos, sql, &rollup);
+
+  // the query with column filter is always executed on raw data
+  sprintf(sql,
+          "select count(*), sum(v), min(v), max(v), avg(f) from t where ts >= %ld and ts < %ld and v > -1000 "
+          "interval(%s)",
+          skey, ekey, interval);
+  query(taos, sql, &raw);
+
+  int failed = (rollup.numOfWindows != raw.numOfWindows || rollup.numOfWindows == 0);
+  for (int i = 0; !failed && i < raw.numOfWindows; ++i) {
+    if (rollup.keys[i] != raw.keys[i]) {
+      failed = 1;
+      break;
+    }
+
+    for (int j = 0; j < NUM_OF_COLS; ++j) {
+      if (fabs(rollup.values[i][j] - raw.values[i][j]) > 1e-6 * (fabs(raw.values[i][j]) + 1)) {
+        printf("interval(%s) window:%ld col:%d rollup:%f raw:%f\n", interval, raw.keys[i], j, rollup.values[i][j],
+               raw.values[i][j]);
+        failed = 1;
+      }
+    }
+  }
+
+  printf("interval(%-4s) windows rollup:%-5d raw:%-5d %s\n", interval, rollup.numOfWindows, raw.numOfWindows,
+         failed ? "failed" : "ok");
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database rollupdemo");
+
+  char sql[ROWS_PER_SQL * 64 + 64];
+  sprintf(sql, "create database rollupdemo days 1 ctime %d", COMMIT_TIME);
+  execute(taos, sql);
+  execute(taos, "use rollupdemo");
+  execute(taos, "create table t (ts timestamp, v int, f double)");
+
+  // data start 6 hours before the boundary of files, and span 3 files
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  int64_t today = (int64_t)now.tv_sec * 1000 / MS_PER_DAY * MS_PER_DAY;
+  int64_t skey = today - 3 * MS_PER_DAY - 6 * 3600000L;
+  int64_t ekey = skey + 2 * MS_PER_DAY + 12 * 3600000L;
+
+  int64_t i = 0;
+  for (int64_t key = skey; key < ekey;) {
+    int len = sprintf(sql, "insert into t values");
+    for (int n = 0; n < ROWS_PER_SQL && key < ekey; ++n, ++i, key += ROW_INTERVAL) {
+      len += sprintf(sql + len, " (%ld, %ld, %f)", key, i % 1000 - 500, i * 0.5);
+    }
+    execute(taos, sql);
+  }
+
+  printf("%ld rows are inserted, wait for commit\n", i);
+  sleep(COMMIT_TIME * 2);
+
+  int failed = 0;
+  failed |= check(taos, skey, ekey, "2m");
+  failed |= check(taos, skey, ekey, "1h");
+  failed |= check(taos, skey, ekey, "7h");   // windows cross the boundary of files
+  failed |= check(taos, skey, ekey, "48h");  // each window is aggregated from the buckets of two files
+  failed |= check(taos, skey + 1000, ekey - 1000, "1h");
+
+  taos_query(taos, "drop database rollupdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// measure tColDataQSort on columnar pages sorted by timestamp. The radix sort applies to the single timestamp order
+// column, while ordering by (ts, v) is always handled by the comparison based sort with the same result, since the
+// timestamps are unique.
+// to compile: gcc -I../../../src/inc -I../../../src/os/linux/inc -o sortbench sortbench.c -ltaos
+// usage: sortbench [numOfRows] [rounds]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "taos.h"
+#include "textbuffer.h"
+#include "tsql.h"
+
+static int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// the timestamps are the shuffled sequence of [0, numOfRows), v and d are derived from ts to check the gathered rows
+static void generate(tColModel *pModel, tFilePage *pPage, int32_t numOfRows) {
+  int64_t *ts = (int64_t *)(pPage->data + pModel->colOffset[0] * numOfRows);
+  int32_t *v = (int32_t *)(pPage->data + pModel->colOffset[1] * numOfRows);
+  double * d = (double *)(pPage->data + pModel->colOffset[2] * numOfRows);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ts[i] = i;
+  }
+
+  srand(numOfRows);
+  for (int32_t i = numOfRows - 1; i > 0; --i) {
+    int32_t j = (int32_t)(((int64_t)rand() * RAND_MAX + rand()) % (i + 1));
+    int64_t t = ts[i];
+    ts[i] = ts[j];
+    ts[j] = t;
+  }
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    v[i] = (int32_t)(ts[i] % 1000);
+    d[i] = ts[i] * 0.5;
+  }
+
+  pPage->numOfElems = numOfRows;
+}
+
+static int32_t verify(tColModel *pModel, tFilePage *pPage, int32_t numOfRows, int32_t order) {
+  int64_t *ts = (int64_t *)(pPage->data + pModel->colOffset[0] * numOfRows);
+  int32_t *v = (int32_t *)(pPage->data + pModel->colOffset[1] * numOfRows);
+  double * d = (double *)(pPage->data + pModel->colOffset[2] * numOfRows);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int64_t expect = (order == TSQL_SO_ASC) ? i : (numOfRows - 1 - i);
+    if (ts[i] != expect || v[i] != (int32_t)(expect % 1000) || d[i] != expect * 0.5) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int64_t sort(tColModel *pModel, tFilePage *pPage, int32_t numOfRows, int32_t *orderIdx, int32_t numOfOrderCols,
+                    int32_t order) {
+  tOrderDescriptor *pDesc = tOrderDesCreate(orderIdx, numOfOrderCols, pModel, order);
+
+  generate(pModel, pPage, numOfRows);
+
+  int64_t st = getTimeUs();
+  tColDataQSort(pDesc, numOfRows, 0, numOfRows - 1, pPage->data, order);
+  int64_t elapsed = getTimeUs() - st;
+
+  if (verify(pModel, pPage, numOfRows, order) != 0) {
+    printf("data is not sorted correctly\n");
+    exit(1);
+  }
+
+  free(pDesc);  // the column model is shared
+  return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfRows = (argc > 1) ? atoi(argv[1]) : 10000000;
+  int32_t rounds = (argc > 2) ? atoi(argv[2]) : 3;
+
+  SSchema schema[3] = {{0}};
+  schema[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  schema[0].bytes = sizeof(int64_t);
+  schema[1].type = TSDB_DATA_TYPE_INT;
+  schema[1].bytes = sizeof(int32_t);
+  schema[2].type = TSDB_DATA_TYPE_DOUBLE;
+  schema[2].bytes = sizeof(double);
+
+  tColModel *pModel = tColModelCreate(schema, 3, numOfRows);
+  tFilePage *pPage = (tFilePage *)malloc(sizeof(tFilePage) + (size_t)numOfRows * 20);
+  if (pModel == NULL || pPage == NULL) {
+    printf("failed to allocate memory for %d rows\n", numOfRows);
+    return 1;
+  }
+
+  int32_t orderIdx[2] = {0, 1};
+  int32_t orders[2] = {TSQL_SO_ASC, TSQL_SO_DESC};
+
+  for (int32_t i = 0; i < 2; ++i) {
+    int64_t radixTime = 0, genericTime = 0;
+
+    for (int32_t j = 0; j < rounds; ++j) {
+      radixTime += sort(pModel, pPage, numOfRows, orderIdx, 1, orders[i]);
+      genericTime += sort(pModel, pPage, numOfRows, orderIdx, 2, orders[i]);
+    }
+
+    printf("%d rows, order by ts %s\n", numOfRows, orders[i] == TSQL_SO_ASC ? "asc" : "desc");
+    printf("  order by ts      : %10.2f ms/round\n", radixTime / 1000.0 / rounds);
+    printf("  order by (ts, v) : %10.2f ms/round\n", genericTime / 1000.0 / rounds);
+  }
+
+  tColModelDestroy(pModel);
+  free(pPage);
+  return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// batched prepared insert example, the statements of tables in two vgroups are executed in one round. One vgroup
+// fails since its table is dropped by another process, the result of each statement shall be the result of its own
+// vgroup.
+// to compile: gcc -o stmtbatch stmtbatch.c -ltaos
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <taos.h>
+
+#define NUM_OF_TABLES 5
+#define NUM_OF_ROWS   10
+
+static void dropTable(char *ip) {
+  TAOS *taos = taos_connect(ip, "root", "taosdata", "stmtdemo", 0);
+  if (taos == NULL || taos_query(taos, "drop table t4") != 0) {
+    printf("failed to drop table, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_close(taos);
+  exit(0);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  // the table is dropped by another process, so the meta cached by this process becomes stale
+  int fd[2];
+  if (pipe(fd) != 0) {
+    printf("failed to create pipe\n");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    char c;
+    close(fd[1]);
+    if (read(fd[0], &c, 1) != 1) exit(1);
+    taos_init();
+    dropTable(argv[1]);
+  }
+
+  close(fd[0]);
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  // tables t0-t3 are created in the first vgroup, and t4 in the second one
+  taos_query(taos, "drop database stmtdemo");
+  if (taos_query(taos, "create database stmtdemo tables 4") != 0) {
+    printf("failed to create database, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "use stmtdemo");
+
+  TAOS_STMT *stmts[NUM_OF_TABLES];
+  char       sql[128];
+  for (int i = 0; i < NUM_OF_TABLES; ++i) {
+    sprintf(sql, "create table t%d (ts timestamp, speed int)", i);
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to create table, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+
+    sprintf(sql, "insert into t%d values(?, ?)", i);
+    stmts[i] = taos_stmt_init(taos);
+    if (taos_stmt_prepare(stmts[i], sql) != 0) {
+      printf("failed to prepare insert, reason:%s\n", taos_stmt_errstr(stmts[i]));
+      exit(1);
+    }
+  }
+
+  int status = 0;
+  if (write(fd[1], "d", 1) != 1 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    printf("failed to drop table in another process\n");
+    exit(1);
+  }
+
+  int64_t   ts[NUM_OF_ROWS];
+  int       speed[NUM_OF_ROWS];
+  TAOS_BIND bind[2] = {
+      {TSDB_DATA_TYPE_TIMESTAMP, ts, sizeof(int64_t), NULL, NULL},
+      {TSDB_DATA_TYPE_INT, speed, sizeof(int), NULL, NULL},
+  };
+
+  for (int i = 0; i < NUM_OF_TABLES; ++i) {
+    for (int j = 0; j < NUM_OF_ROWS; ++j) {
+      ts[j] = 1500000000000L + j;
+      speed[j] = i * j;
+    }
+
+    if (taos_stmt_bind_param(stmts[i], bind, NUM_OF_ROWS) != 0 || taos_stmt_add_batch(stmts[i]) != 0) {
+      printf("failed to bind, reason:%s\n", taos_stmt_errstr(stmts[i]));
+      exit(1);
+    }
+  }
+
+  int code = taos_stmt_execute_batch(stmts, NUM_OF_TABLES);
+  printf("executed, code:%d\n", code);
+
+  int failed = (code == 0);
+  for (int i = 0; i < NUM_OF_TABLES; ++i) {
+    int errcode = taos_stmt_errno(stmts[i]);
+    int affected = taos_stmt_affected_rows(stmts[i]);
+    printf("t%d: code:%d, affected rows:%d\n", i, errcode, affected);
+
+    if ((i < NUM_OF_TABLES - 1 && (errcode != 0 || affected != NUM_OF_ROWS)) ||
+        (i == NUM_OF_TABLES - 1 && errcode == 0)) {
+      printf("t%d: unexpected result\n", i);
+      failed = 1;
+    }
+
+    taos_stmt_close(stmts[i]);
+  }
+
+  taos_query(taos, "drop database stmtdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// sliding window stream example, the result of each window is compared with the query on the whole window. The
+// first stream is computed by merging the panes of window, the second one with wavg queries the whole window. The
+// query on the whole window is split by the interval if the window is not aligned to it, and the split rows of later
+// windows are reported before the row of the aligned window itself, so only the last row of the aligned windows of
+// the second stream are compared.
+// to compile: gcc -o streampane streampane.c -ltaos
+// usage: streampane server-ip
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <taos.h>
+
+#define INTERVAL    4000
+#define NUM_OF_ROWS 120
+#define MAX_WINDOWS 256
+#define MAX_COLS    8
+
+typedef struct {
+  char *  funcs;
+  int64_t align;  // only the windows aligned to it are compared
+  int32_t numOfWindows;
+  int64_t keys[MAX_WINDOWS];
+  double  values[MAX_WINDOWS][MAX_COLS];
+  int32_t numOfCols;
+} SStreamResult;
+
+static double getValue(TAOS_FIELD *field, void *p) {
+  switch (field->type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      return *(int8_t *)p;
+    case TSDB_DATA_TYPE_SMALLINT:
+      return *(int16_t *)p;
+    case TSDB_DATA_TYPE_INT:
+      return *(int32_t *)p;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return (double)*(int64_t *)p;
+    case TSDB_DATA_TYPE_FLOAT:
+      return *(float *)p;
+    default:
+      return *(double *)p;
+  }
+}
+
+static void streamCallback(void *param, TAOS_RES *res, TAOS_ROW row) {
+  SStreamResult *pRes = param;
+  TAOS_FIELD *   fields = taos_fetch_fields(res);
+  int            numOfFields = taos_num_fields(res);
+
+  if (pRes->numOfWindows >= MAX_WINDOWS || numOfFields > MAX_COLS + 1) return;
+
+  // the row of a window replaces the earlier ones of the same key
+  int64_t key = *(int64_t *)row[0];
+  int32_t index = 0;
+  while (index < pRes->numOfWindows && pRes->keys[index] != key) index++;
+
+  pRes->numOfCols = numOfFields - 1;
+  pRes->keys[index] = key;
+  for (int i = 1; i < numOfFields; ++i) {
+    pRes->values[index][i - 1] = (row[i] == NULL) ? NAN : getValue(&fields[i], row[i]);
+  }
+
+  if (index == pRes->numOfWindows) pRes->numOfWindows++;
+}
+
+// each window of stream is queried as a whole, and the results are compared
+static int check(TAOS *taos, SStreamResult *pRes) {
+  char sql[256];
+  int  failed = 0;
+
+  int32_t numOfChecked = 0;
+
+  for (int32_t i = 0; i < pRes->numOfWindows; ++i) {
+    if (pRes->keys[i] % pRes->align != 0) continue;
+
+    numOfChecked++;
+    sprintf(sql, "select %s from t where ts >= %lld and ts < %lld", pRes->funcs, (long long)pRes->keys[i],
+            (long long)(pRes->keys[i] + INTERVAL));
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to query:%s, reason:%s\n", sql, taos_errstr(taos));
+      return 1;
+    }
+
+    TAOS_RES *  result = taos_use_result(taos);
+    TAOS_FIELD *fields = taos_fetch_fields(result);
+    TAOS_ROW    row = taos_fetch_row(result);
+
+    for (int32_t j = 0; row != NULL && j < pRes->numOfCols; ++j) {
+      double expected = (row[j] == NULL) ? NAN : getValue(&fields[j], row[j]);
+      double v = pRes->values[i][j];
+
+      if ((isnan(expected) != isnan(v)) || fabs(expected - v) > 1e-6 * (fabs(expected) + 1)) {
+        printf("window %lld, column %d of %s: expected:%f result:%f\n", (long long)pRes->keys[i], j, pRes->funcs,
+               expected, v);
+        failed = 1;
+      }
+    }
+
+    taos_free_result(result);
+  }
+
+  printf("%-72s %d windows %s\n", pRes->funcs, numOfChecked, failed ? "failed" : "ok");
+  return failed || numOfChecked == 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database panedemo");
+  if (taos_query(taos, "create database panedemo") != 0 || taos_query(taos, "use panedemo") != 0 ||
+      taos_query(taos, "create table t (ts timestamp, v int, f double)") != 0) {
+    printf("failed to create table, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  // the rows are written in the past with irregular intervals, so the stream catches up with them at once
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  int64_t start = ((int64_t)tv.tv_sec - 60) * 1000;
+
+  char sql[256];
+  for (int32_t i = 0; i < NUM_OF_ROWS; ++i) {
+    sprintf(sql, "insert into t values(%lld, %d, %f)", (long long)(start + i * 300 + (i * i) % 250), (i * i) % 97,
+            (i % 13) * 1.5);
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to insert, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+  }
+
+  SStreamResult panes = {.funcs = "count(*), sum(v), avg(v), min(v), max(f), spread(f), stddev(v), first(v)",
+                         .align = 1};
+  SStreamResult whole = {.funcs = "wavg(v), wavg(f), count(*)", .align = INTERVAL};
+
+  SStreamResult *pResults[] = {&panes, &whole};
+  TAOS_STREAM *  pStreams[2];
+
+  for (int32_t i = 0; i < 2; ++i) {
+    sprintf(sql, "select %s from t interval(4s) sliding(1s)", pResults[i]->funcs);
+    pStreams[i] = taos_open_stream(taos, sql, streamCallback, start, pResults[i], NULL);
+    if (pStreams[i] == NULL) {
+      printf("failed to open stream, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+  }
+
+  // the windows before now are computed one after another without waiting
+  int64_t last = start + NUM_OF_ROWS * 300;
+  for (int32_t i = 0; i < 300; ++i) {
+    if (panes.numOfWindows > 0 && whole.numOfWindows > 0 && panes.keys[panes.numOfWindows - 1] >= last &&
+        whole.keys[whole.numOfWindows - 1] >= last) {
+      break;
+    }
+
+    usleep(100000);
+  }
+
+  for (int32_t i = 0; i < 2; ++i) {
+    taos_close_stream(pStreams[i]);
+  }
+
+  int failed = check(taos, &panes) | check(taos, &whole);
+
+  taos_query(taos, "drop database panedemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
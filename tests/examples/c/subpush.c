@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// subscribe example, two subscribers of one table consume the rows pushed while they are inserted. After both
+// unsubscribe, a new subscriber consumes the rows inserted before and after it subscribes. Every subscriber shall
+// get all rows in order, the program fails otherwise.
+// to compile: gcc -o subpush subpush.c -ltaos -lpthread
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <taos.h>
+
+#define NUM_OF_ROWS 500
+
+typedef struct {
+  char *    ip;
+  TAOS_SUB *tsub;
+  int64_t   base;
+  int       from;  // index of the first row expected
+  int       num;
+  int       failed;
+} SConsumer;
+
+static TAOS *taos;
+
+static void insertRows(int64_t base, int from, int num) {
+  char sql[128];
+  for (int i = from; i < from + num; ++i) {
+    sprintf(sql, "insert into subdemo.t values(%lld, %d)", (long long)(base + i), i);
+    if (taos_query(taos, sql) != 0) {
+      printf("failed to insert, reason:%s\n", taos_errstr(taos));
+      exit(1);
+    }
+
+    if (i % 50 == 0) usleep(10000);
+  }
+}
+
+static void *consume(void *param) {
+  SConsumer *pConsumer = param;
+
+  for (int i = pConsumer->from; i < pConsumer->from + pConsumer->num; ++i) {
+    TAOS_ROW row = taos_consume(pConsumer->tsub);
+    if (row == NULL || *(int64_t *)row[0] != pConsumer->base + i || *(int32_t *)row[1] != i) {
+      printf("row %d is expected, result:%d\n", i, (row == NULL) ? -1 : *(int32_t *)row[1]);
+      pConsumer->failed = 1;
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+static TAOS_SUB *subscribe(char *ip, int64_t base) {
+  TAOS_SUB *tsub = taos_subscribe(ip, "root", "taosdata", "subdemo", "t", base - 1, 100);
+  if (tsub == NULL) {
+    printf("failed to subscribe\n");
+    exit(1);
+  }
+
+  return tsub;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  taos_init();
+
+  taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database subdemo");
+  if (taos_query(taos, "create database subdemo") != 0 ||
+      taos_query(taos, "create table subdemo.t (ts timestamp, v int)") != 0) {
+    printf("failed to create table, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  // the program is killed if any subscriber waits for the rows forever
+  alarm(120);
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  int64_t base = (int64_t)tv.tv_sec * 1000 - 3600 * 1000;
+
+  insertRows(base, 0, 1);
+
+  // two subscribers of the same meter are pushed while the rows are inserted
+  SConsumer consumers[2];
+  pthread_t threads[2];
+  for (int i = 0; i < 2; ++i) {
+    consumers[i] = (SConsumer){.ip = argv[1], .tsub = subscribe(argv[1], base), .base = base, .num = NUM_OF_ROWS};
+    pthread_create(&threads[i], NULL, consume, &consumers[i]);
+  }
+
+  insertRows(base, 1, NUM_OF_ROWS - 1);
+
+  int failed = 0;
+  for (int i = 0; i < 2; ++i) {
+    pthread_join(threads[i], NULL);
+    taos_unsubscribe(consumers[i].tsub);
+    failed |= consumers[i].failed;
+    printf("subscriber %d: %s\n", i, consumers[i].failed ? "failed" : "ok");
+  }
+
+  // the rows kept for the meter are freed since nobody subscribes it, the new subscriber starts over
+  insertRows(base, NUM_OF_ROWS, NUM_OF_ROWS);
+
+  SConsumer consumer = {.ip = argv[1], .tsub = subscribe(argv[1], base), .base = base, .num = NUM_OF_ROWS * 3};
+  pthread_t thread;
+  pthread_create(&thread, NULL, consume, &consumer);
+
+  insertRows(base, NUM_OF_ROWS * 2, NUM_OF_ROWS);
+
+  pthread_join(thread, NULL);
+  taos_unsubscribe(consumer.tsub);
+  failed |= consumer.failed;
+  printf("subscriber after all left: %s\n", consumer.failed ? "failed" : "ok");
+
+  taos_query(taos, "drop database subdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// tag index example, the meters filtered by tags are checked after meters are dropped, their slots are reused
+// by new meters, and their tag values are changed.
+// to compile: gcc -o tagindex tagindex.c -ltaos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <taos.h>
+
+static void execute(TAOS *taos, char *sql) {
+  if (taos_query(taos, sql) != 0) {
+    printf("failed to execute:%s, reason:%s\n", sql, taos_errstr(taos));
+    exit(1);
+  }
+}
+
+// the names of the meters qualified by cond are concatenated in order, and compared with expected
+static int check(TAOS *taos, char *cond, char *expected) {
+  char sql[256];
+  sprintf(sql, "select tbname from st where %s", cond);
+
+  // the qualified meters are cached by client, which is not refreshed when meters are dropped or altered
+  execute(taos, "reset query cache");
+  execute(taos, sql);
+
+  TAOS_RES *result = taos_use_result(taos);
+  char      names[256] = {0};
+  int       num = 0;
+
+  TAOS_ROW row;
+  while ((row = taos_fetch_row(result)) != NULL) {
+    num++;
+    strncat(names, (char *)row[0], 1);
+  }
+  taos_free_result(result);
+
+  // the meters are not returned in order
+  for (int i = 0; i < num; ++i) {
+    for (int j = i + 1; j < num; ++j) {
+      if (names[j] < names[i]) {
+        char c = names[i];
+        names[i] = names[j];
+        names[j] = c;
+      }
+    }
+  }
+
+  int failed = strcmp(names, expected) != 0;
+  printf("%-28s expected:%-6s result:%-6s %s\n", cond, expected, names, failed ? "failed" : "ok");
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("please input server-ip \n");
+    return 0;
+  }
+
+  taos_init();
+
+  TAOS *taos = taos_connect(argv[1], "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_query(taos, "drop database tagdemo");
+  execute(taos, "create database tagdemo");
+  execute(taos, "use tagdemo");
+  execute(taos, "create table st (ts timestamp, v int) tags (t int, n binary(8))");
+
+  // meters a, b, c share the same tag values, which are kept by one value in index
+  execute(taos, "create table a using st tags(1, 'x')");
+  execute(taos, "create table b using st tags(1, 'x')");
+  execute(taos, "create table c using st tags(1, 'y')");
+
+  int failed = 0;
+  failed |= check(taos, "t = 1", "abc");
+  failed |= check(taos, "n = 'x'", "ab");
+
+  // the slot of a is reused by d
+  execute(taos, "drop table a");
+  execute(taos, "create table d using st tags(2, 'y')");
+  failed |= check(taos, "t = 1", "bc");
+  failed |= check(taos, "t = 2", "d");
+  failed |= check(taos, "n = 'x'", "b");
+  failed |= check(taos, "n = 'y'", "cd");
+
+  // the tag value of b is changed
+  execute(taos, "alter table b set tag t = 3");
+  execute(taos, "alter table c set tag n = 'x'");
+  failed |= check(taos, "t = 1", "c");
+  failed |= check(taos, "t = 3", "b");
+  failed |= check(taos, "t >= 1", "bcd");
+  failed |= check(taos, "t = 1 and n = 'x'", "c");
+  failed |= check(taos, "t = 3 or n = 'y'", "bd");
+
+  taos_query(taos, "drop database tagdemo");
+  taos_close(taos);
+
+  printf(failed ? "failed\n" : "succeed\n");
+  return failed;
+}